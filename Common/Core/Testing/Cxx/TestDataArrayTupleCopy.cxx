@@ -0,0 +1,292 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataArrayTupleCopy.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test tuple copies between data arrays.
+// .SECTION Description
+// Check DeepCopy(), GetTuples() and InsertTuples() for arrays large enough
+// to be copied by several threads, for same-type and converting copies,
+// repeated destination ids and bit arrays.
+
+#include "vtkBitArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkSOADataArrayTemplate.h"
+#include "vtkSmartPointer.h"
+
+namespace
+{
+
+const vtkIdType NUMBER_OF_TUPLES = 200000;
+const int NUMBER_OF_COMPONENTS = 3;
+
+// Value of component c of tuple t in the source arrays.
+double SourceValue(vtkIdType t, int c)
+{
+  return static_cast<double>((t * 7 + c * 3) % 1001);
+}
+
+void FillSource(vtkDataArray *array)
+{
+  array->SetNumberOfComponents(NUMBER_OF_COMPONENTS);
+  array->SetNumberOfTuples(NUMBER_OF_TUPLES);
+  for (vtkIdType t = 0; t < NUMBER_OF_TUPLES; ++t)
+  {
+    for (int c = 0; c < NUMBER_OF_COMPONENTS; ++c)
+    {
+      array->SetComponent(t, c, SourceValue(t, c));
+    }
+  }
+}
+
+// Check that tuple dstIds[i] of dst holds tuple srcIds[i] of the source.
+bool CheckTuples(const char *name, vtkDataArray *dst, vtkIdList *dstIds,
+                 vtkIdList *srcIds)
+{
+  for (vtkIdType i = 0; i < srcIds->GetNumberOfIds(); ++i)
+  {
+    vtkIdType dstT = dstIds ? dstIds->GetId(i) : i;
+    for (int c = 0; c < dst->GetNumberOfComponents(); ++c)
+    {
+      if (dst->GetComponent(dstT, c) != SourceValue(srcIds->GetId(i), c))
+      {
+        cerr << name << ": wrong value for tuple " << dstT << " component "
+             << c << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestCopies(vtkDataArray *src, vtkDataArray *dst, const char *name)
+{
+  FillSource(src);
+
+  // Deep copy: every tuple, in order.
+  vtkNew<vtkIdList> allIds;
+  allIds->SetNumberOfIds(NUMBER_OF_TUPLES);
+  for (vtkIdType t = 0; t < NUMBER_OF_TUPLES; ++t)
+  {
+    allIds->SetId(t, t);
+  }
+  dst->DeepCopy(src);
+  if (dst->GetNumberOfTuples() != NUMBER_OF_TUPLES ||
+      !CheckTuples(name, dst, NULL, allIds.GetPointer()))
+  {
+    cerr << name << ": DeepCopy failed" << endl;
+    return false;
+  }
+
+  // Gather every other tuple, backwards.
+  vtkNew<vtkIdList> srcIds;
+  srcIds->SetNumberOfIds(NUMBER_OF_TUPLES / 2);
+  for (vtkIdType i = 0; i < NUMBER_OF_TUPLES / 2; ++i)
+  {
+    srcIds->SetId(i, NUMBER_OF_TUPLES - 1 - 2 * i);
+  }
+  dst->Initialize();
+  dst->SetNumberOfComponents(NUMBER_OF_COMPONENTS);
+  dst->SetNumberOfTuples(NUMBER_OF_TUPLES / 2);
+  src->GetTuples(srcIds.GetPointer(), dst);
+  if (!CheckTuples(name, dst, NULL, srcIds.GetPointer()))
+  {
+    cerr << name << ": GetTuples (id list) failed" << endl;
+    return false;
+  }
+
+  // Gather a range.
+  vtkNew<vtkIdList> rangeIds;
+  rangeIds->SetNumberOfIds(NUMBER_OF_TUPLES / 2);
+  for (vtkIdType i = 0; i < NUMBER_OF_TUPLES / 2; ++i)
+  {
+    rangeIds->SetId(i, NUMBER_OF_TUPLES / 4 + i);
+  }
+  src->GetTuples(NUMBER_OF_TUPLES / 4, 3 * NUMBER_OF_TUPLES / 4 - 1, dst);
+  if (!CheckTuples(name, dst, NULL, rangeIds.GetPointer()))
+  {
+    cerr << name << ": GetTuples (range) failed" << endl;
+    return false;
+  }
+
+  // The remaining copies require matching value types.
+  if (src->GetDataType() != dst->GetDataType())
+  {
+    return true;
+  }
+
+  // Scatter to increasing, sparse destination ids.
+  vtkNew<vtkIdList> dstIds;
+  dstIds->SetNumberOfIds(NUMBER_OF_TUPLES / 2);
+  for (vtkIdType i = 0; i < NUMBER_OF_TUPLES / 2; ++i)
+  {
+    dstIds->SetId(i, 3 * i + 1);
+  }
+  dst->Initialize();
+  dst->InsertTuples(dstIds.GetPointer(), srcIds.GetPointer(), src);
+  if (dst->GetNumberOfTuples() != 3 * (NUMBER_OF_TUPLES / 2) - 1 ||
+      !CheckTuples(name, dst, dstIds.GetPointer(), srcIds.GetPointer()))
+  {
+    cerr << name << ": InsertTuples (id lists) failed" << endl;
+    return false;
+  }
+
+  // Scatter with repeated destination ids: the last tuple written wins.
+  for (vtkIdType i = 0; i < NUMBER_OF_TUPLES / 2; ++i)
+  {
+    dstIds->SetId(i, i / 2);
+  }
+  dst->Initialize();
+  dst->InsertTuples(dstIds.GetPointer(), srcIds.GetPointer(), src);
+  vtkNew<vtkIdList> lastIds;
+  vtkNew<vtkIdList> lastDstIds;
+  for (vtkIdType i = 1; i < NUMBER_OF_TUPLES / 2; i += 2)
+  {
+    lastIds->InsertNextId(srcIds->GetId(i));
+    lastDstIds->InsertNextId(i / 2);
+  }
+  if (!CheckTuples(name, dst, lastDstIds.GetPointer(), lastIds.GetPointer()))
+  {
+    cerr << name << ": InsertTuples (repeated ids) failed" << endl;
+    return false;
+  }
+
+  // Insert a range after the existing tuples.
+  vtkIdType start = dst->GetNumberOfTuples();
+  dst->InsertTuples(start, NUMBER_OF_TUPLES / 2, NUMBER_OF_TUPLES / 4, src);
+  for (vtkIdType i = 0; i < NUMBER_OF_TUPLES / 2; ++i)
+  {
+    dstIds->SetId(i, start + i);
+  }
+  if (dst->GetNumberOfTuples() != start + NUMBER_OF_TUPLES / 2 ||
+      !CheckTuples(name, dst, dstIds.GetPointer(), rangeIds.GetPointer()))
+  {
+    cerr << name << ": InsertTuples (range) failed" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestBitArray()
+{
+  const vtkIdType numBits = 10 * NUMBER_OF_TUPLES;
+  vtkNew<vtkBitArray> src;
+  src->SetNumberOfTuples(numBits);
+  for (vtkIdType i = 0; i < numBits; ++i)
+  {
+    src->SetValue(i, (i % 3) == 0);
+  }
+
+  vtkNew<vtkIdList> srcIds;
+  vtkNew<vtkIdList> dstIds;
+  for (vtkIdType i = 0; i < numBits; i += 2)
+  {
+    srcIds->InsertNextId(i);
+    dstIds->InsertNextId(i / 2);
+  }
+  vtkNew<vtkBitArray> dst;
+  dst->InsertTuples(dstIds.GetPointer(), srcIds.GetPointer(),
+                    src.GetPointer());
+
+  vtkNew<vtkBitArray> copy;
+  copy->DeepCopy(src.GetPointer());
+  for (vtkIdType i = 0; i < numBits; ++i)
+  {
+    if (copy->GetValue(i) != src->GetValue(i) ||
+        (i % 2 == 0 && dst->GetValue(i / 2) != src->GetValue(i)))
+    {
+      cerr << "vtkBitArray: wrong bit " << i << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// 64-bit values above 2^53 do not survive a round trip through double, so
+// same-type copies between arrays vtkArrayDispatch does not know must stay
+// typed.
+bool TestExactInt64()
+{
+  typedef vtkSOADataArrayTemplate<vtkTypeInt64> vtkInt64SOAArray;
+  const vtkTypeInt64 base = static_cast<vtkTypeInt64>(1) << 60;
+  vtkNew<vtkInt64SOAArray> src;
+  src->SetNumberOfComponents(NUMBER_OF_COMPONENTS);
+  src->SetNumberOfTuples(NUMBER_OF_TUPLES);
+  for (vtkIdType t = 0; t < NUMBER_OF_TUPLES; ++t)
+  {
+    for (int c = 0; c < NUMBER_OF_COMPONENTS; ++c)
+    {
+      src->SetTypedComponent(t, c, base + t * NUMBER_OF_COMPONENTS + c);
+    }
+  }
+
+  vtkNew<vtkIdList> ids;
+  ids->SetNumberOfIds(NUMBER_OF_TUPLES);
+  for (vtkIdType t = 0; t < NUMBER_OF_TUPLES; ++t)
+  {
+    ids->SetId(t, t);
+  }
+  vtkNew<vtkInt64SOAArray> gathered;
+  gathered->SetNumberOfComponents(NUMBER_OF_COMPONENTS);
+  gathered->SetNumberOfTuples(NUMBER_OF_TUPLES);
+  src->GetTuples(ids.GetPointer(), gathered.GetPointer());
+  vtkNew<vtkInt64SOAArray> inserted;
+  inserted->SetNumberOfComponents(NUMBER_OF_COMPONENTS);
+  inserted->InsertTuples(ids.GetPointer(), ids.GetPointer(),
+                         src.GetPointer());
+
+  for (vtkIdType t = 0; t < NUMBER_OF_TUPLES; ++t)
+  {
+    for (int c = 0; c < NUMBER_OF_COMPONENTS; ++c)
+    {
+      vtkTypeInt64 expected = base + t * NUMBER_OF_COMPONENTS + c;
+      if (gathered->GetTypedComponent(t, c) != expected ||
+          inserted->GetTypedComponent(t, c) != expected)
+      {
+        cerr << "int64 SoA: value of tuple " << t << " component " << c
+             << " lost precision" << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestDataArrayTupleCopy(int, char *[])
+{
+  typedef vtkSOADataArrayTemplate<float> vtkFloatSOAArray;
+
+  bool res = true;
+  res = TestCopies(vtkSmartPointer<vtkFloatArray>::New(),
+                   vtkSmartPointer<vtkFloatArray>::New(),
+                   "float -> float") && res;
+  res = TestCopies(vtkSmartPointer<vtkIntArray>::New(),
+                   vtkSmartPointer<vtkDoubleArray>::New(),
+                   "int -> double") && res;
+  res = TestCopies(vtkSmartPointer<vtkFloatSOAArray>::New(),
+                   vtkSmartPointer<vtkFloatArray>::New(),
+                   "float SoA -> float") && res;
+  res = TestCopies(vtkSmartPointer<vtkFloatSOAArray>::New(),
+                   vtkSmartPointer<vtkFloatSOAArray>::New(),
+                   "float SoA -> float SoA") && res;
+  res = TestBitArray() && res;
+  res = TestExactInt64() && res;
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -302,8 +302,10 @@ void vtkAOSDataArrayTemplate<ValueTypeT>::InsertTuples(
   // First, check for the common case of typeid(source) == typeid(this). This
   // way we don't waste time redoing the other checks in the superclass, and
   // can avoid doing a dispatch for the most common usage of this method.
+  // Large copies are threaded by vtkDataArray when it knows the type.
   SelfType *other = vtkArrayDownCast<SelfType>(source);
-  if (!other)
+  if (!other || vtkDataArray::UseThreadedCopy(other, this,
+      n * this->NumberOfComponents))
   {
     // Let the superclass handle dispatch/fallback.
     this->Superclass::InsertTuples(dstStart, n, srcStart, source);
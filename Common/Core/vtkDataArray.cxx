@@ -34,6 +34,7 @@
 #include "vtkLookupTable.h"
 #include "vtkLongArray.h"
 #include "vtkMath.h"
+#include "vtkSMPTools.h"
 #include "vtkSOADataArrayTemplate.h" // For fast paths
 #include "vtkShortArray.h"
 #include "vtkSignedCharArray.h"
@@ -48,51 +49,143 @@
 namespace {
 
 //--------Copy tuples from src to dest------------------------------------------
-struct DeepCopyWorker
-{
-  // AoS --> AoS same-type specialization:
-  template <typename ValueType>
-  void operator()(vtkAOSDataArrayTemplate<ValueType> *src,
-                  vtkAOSDataArrayTemplate<ValueType> *dst)
+// Copies tuples [begin, end) of a tuple mapping from src to dst. The source
+// (destination) tuples are SrcIds[t] (DstIds[t]), or SrcStart + t
+// (DstStart + t) when the id array is NULL.
+template <typename SrcArrayT, typename DstArrayT>
+struct CopyTuplesFunctor
+{
+  SrcArrayT *Src;
+  DstArrayT *Dst;
+  const vtkIdType *SrcIds;
+  const vtkIdType *DstIds;
+  vtkIdType SrcStart;
+  vtkIdType DstStart;
+
+  CopyTuplesFunctor(SrcArrayT *src, DstArrayT *dst,
+                    const vtkIdType *srcIds, const vtkIdType *dstIds,
+                    vtkIdType srcStart, vtkIdType dstStart)
+    : Src(src), Dst(dst), SrcIds(srcIds), DstIds(dstIds),
+      SrcStart(srcStart), DstStart(dstStart)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
   {
-    std::copy(src->Begin(), src->End(), dst->Begin());
+    vtkDataArrayAccessor<SrcArrayT> s(this->Src);
+    vtkDataArrayAccessor<DstArrayT> d(this->Dst);
+
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DestType;
+
+    const int numComps = this->Src->GetNumberOfComponents();
+    for (vtkIdType t = begin; t < end; ++t)
+    {
+      vtkIdType srcT = this->SrcIds ? this->SrcIds[t] : this->SrcStart + t;
+      vtkIdType dstT = this->DstIds ? this->DstIds[t] : this->DstStart + t;
+      for (int c = 0; c < numComps; ++c)
+      {
+        d.Set(dstT, c, static_cast<DestType>(s.Get(srcT, c)));
+      }
+    }
   }
+};
 
-  // SoA --> SoA same-type specialization:
-  template <typename ValueType>
-  void operator()(vtkSOADataArrayTemplate<ValueType> *src,
-                  vtkSOADataArrayTemplate<ValueType> *dst)
+// AoS --> AoS same-type specialization: contiguous tuples are copied as one
+// block, gathered/scattered tuples one tuple at a time.
+template <typename ValueType>
+struct CopyTuplesFunctor<vtkAOSDataArrayTemplate<ValueType>,
+                         vtkAOSDataArrayTemplate<ValueType> >
+{
+  typedef vtkAOSDataArrayTemplate<ValueType> ArrayType;
+
+  ArrayType *Src;
+  ArrayType *Dst;
+  const vtkIdType *SrcIds;
+  const vtkIdType *DstIds;
+  vtkIdType SrcStart;
+  vtkIdType DstStart;
+
+  CopyTuplesFunctor(ArrayType *src, ArrayType *dst,
+                    const vtkIdType *srcIds, const vtkIdType *dstIds,
+                    vtkIdType srcStart, vtkIdType dstStart)
+    : Src(src), Dst(dst), SrcIds(srcIds), DstIds(dstIds),
+      SrcStart(srcStart), DstStart(dstStart)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
   {
-    vtkIdType numTuples = src->GetNumberOfTuples();
-    for (int comp; comp < src->GetNumberOfComponents(); ++comp)
+    const int numComps = this->Src->GetNumberOfComponents();
+    const ValueType *src = this->Src->GetPointer(0);
+    ValueType *dst = this->Dst->GetPointer(0);
+
+    if (!this->SrcIds && !this->DstIds)
     {
-      ValueType *srcBegin = src->GetComponentArrayPointer(comp);
-      ValueType *srcEnd = srcBegin + numTuples;
-      ValueType *dstBegin = dst->GetComponentArrayPointer(comp);
+      const ValueType *srcBegin = src + (this->SrcStart + begin) * numComps;
+      std::copy(srcBegin, srcBegin + (end - begin) * numComps,
+                dst + (this->DstStart + begin) * numComps);
+      return;
+    }
 
-      std::copy(srcBegin, srcEnd, dstBegin);
+    for (vtkIdType t = begin; t < end; ++t)
+    {
+      vtkIdType srcT = this->SrcIds ? this->SrcIds[t] : this->SrcStart + t;
+      vtkIdType dstT = this->DstIds ? this->DstIds[t] : this->DstStart + t;
+      const ValueType *srcTuple = src + srcT * numComps;
+      std::copy(srcTuple, srcTuple + numComps, dst + dstT * numComps);
     }
   }
+};
 
-  // Generic implementation:
-  template <typename Array1T, typename Array2T>
-  void operator()(Array1T *src, Array2T *dst)
-  {
-    vtkDataArrayAccessor<Array1T> s(src);
-    vtkDataArrayAccessor<Array2T> d(dst);
-
-    typedef typename vtkDataArrayAccessor<Array2T>::APIType DestType;
+// Copy NumTuples tuples from src to dst, see CopyTuplesFunctor for the tuple
+// mapping. Callers request threading for large copies whose destination
+// tuples are distinct and do not alias the source tuples.
+struct CopyTuplesWorker
+{
+  const vtkIdType *SrcIds;
+  const vtkIdType *DstIds;
+  vtkIdType SrcStart;
+  vtkIdType DstStart;
+  vtkIdType NumTuples;
+  bool Threaded;
 
-    vtkIdType tuples = src->GetNumberOfTuples();
-    int comps = src->GetNumberOfComponents();
+  CopyTuplesWorker(const vtkIdType *srcIds, vtkIdType srcStart,
+                   const vtkIdType *dstIds, vtkIdType dstStart,
+                   vtkIdType numTuples, bool threaded)
+    : SrcIds(srcIds), DstIds(dstIds), SrcStart(srcStart), DstStart(dstStart),
+      NumTuples(numTuples), Threaded(threaded)
+  {}
 
-    for (vtkIdType t = 0; t < tuples; ++t)
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT *src, DstArrayT *dst)
+  {
+    CopyTuplesFunctor<SrcArrayT, DstArrayT> functor(
+      src, dst, this->SrcIds, this->DstIds, this->SrcStart, this->DstStart);
+    if (this->Threaded)
     {
-      for (int c = 0; c < comps; ++c)
-      {
-        d.Set(t, c, static_cast<DestType>(s.Get(t, c)));
-      }
+      vtkSMPTools::For(0, this->NumTuples, functor);
     }
+    else
+    {
+      functor(0, this->NumTuples);
+    }
+  }
+
+  // Fallback for arrays unknown to the dispatcher. These go through the
+  // vtkDataArray API, which is not safe for concurrent writes (vtkBitArray
+  // packs several tuples per byte), so they are always copied serially.
+  void operator()(vtkDataArray *src, vtkDataArray *dst)
+  {
+    CopyTuplesFunctor<vtkDataArray, vtkDataArray> functor(
+      src, dst, this->SrcIds, this->DstIds, this->SrcStart, this->DstStart);
+    functor(0, this->NumTuples);
+  }
+};
+
+// Only used to find out whether vtkArrayDispatch knows a pair of arrays.
+struct DispatchableWorker
+{
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT *, DstArrayT *)
+  {
   }
 };
 
@@ -174,69 +267,6 @@ struct InterpolateTupleWorker
   }
 };
 
-//-----------------GetTuples (id list)------------------------------------------
-struct GetTuplesFromListWorker
-{
-  vtkIdList *Ids;
-
-  GetTuplesFromListWorker(vtkIdList *ids) : Ids(ids) {}
-
-  template <typename Array1T, typename Array2T>
-  void operator()(Array1T *src, Array2T *dst)
-  {
-    vtkDataArrayAccessor<Array1T> s(src);
-    vtkDataArrayAccessor<Array2T> d(dst);
-
-    typedef typename vtkDataArrayAccessor<Array2T>::APIType DestType;
-
-    int numComps = src->GetNumberOfComponents();
-    vtkIdType *srcTuple = this->Ids->GetPointer(0);
-    vtkIdType *srcTupleEnd = this->Ids->GetPointer(Ids->GetNumberOfIds());
-    vtkIdType dstTuple = 0;
-
-    while (srcTuple != srcTupleEnd)
-    {
-      for (int c = 0; c < numComps; ++c)
-      {
-        d.Set(dstTuple, c, static_cast<DestType>(s.Get(*srcTuple, c)));
-      }
-      ++srcTuple;
-      ++dstTuple;
-    }
-  }
-};
-
-//-----------------GetTuples (tuple range)--------------------------------------
-struct GetTuplesRangeWorker
-{
-  vtkIdType Start;
-  vtkIdType End; // Note that End is inclusive.
-
-  GetTuplesRangeWorker(vtkIdType start, vtkIdType end)
-    : Start(start), End(end)
-  {}
-
-  template <typename Array1T, typename Array2T>
-  void operator()(Array1T *src, Array2T *dst)
-  {
-    vtkDataArrayAccessor<Array1T> s(src);
-    vtkDataArrayAccessor<Array2T> d(dst);
-
-    typedef typename vtkDataArrayAccessor<Array2T>::APIType DestType;
-
-    int numComps = src->GetNumberOfComponents();
-    for (vtkIdType srcT = this->Start, dstT = 0;
-         srcT <= this->End;
-         ++srcT, ++dstT)
-    {
-      for (int c = 0; c < numComps; ++c)
-      {
-        d.Set(dstT, c, static_cast<DestType>(s.Get(srcT, c)));
-      }
-    }
-  }
-};
-
 //----------------SetTuple (from array)-----------------------------------------
 struct SetTupleArrayWorker
 {
@@ -263,78 +293,6 @@ struct SetTupleArrayWorker
   }
 };
 
-//----------------SetTuples (from array+vtkIdList)------------------------------
-struct SetTuplesIdListWorker
-{
-  vtkIdList *SrcTuples;
-  vtkIdList *DstTuples;
-
-  SetTuplesIdListWorker(vtkIdList *srcTuples, vtkIdList *dstTuples)
-    : SrcTuples(srcTuples), DstTuples(dstTuples)
-  {}
-
-  template <typename SrcArrayT, typename DstArrayT>
-  void operator()(SrcArrayT *src, DstArrayT *dst)
-  {
-    vtkDataArrayAccessor<SrcArrayT> s(src);
-    vtkDataArrayAccessor<DstArrayT> d(dst);
-
-    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DestType;
-
-    vtkIdType numTuples = this->SrcTuples->GetNumberOfIds();
-    int numComps = src->GetNumberOfComponents();
-    for (vtkIdType t = 0; t < numTuples; ++t)
-    {
-      vtkIdType srcT = this->SrcTuples->GetId(t);
-      vtkIdType dstT = this->DstTuples->GetId(t);
-      for (int c = 0; c < numComps; ++c)
-      {
-        d.Set(dstT, c, static_cast<DestType>(s.Get(srcT, c)));
-      }
-    }
-  }
-};
-
-//----------------SetTuples (from array+range)----------------------------------
-struct SetTuplesRangeWorker
-{
-  vtkIdType SrcStartTuple;
-  vtkIdType DstStartTuple;
-  vtkIdType NumTuples;
-
-  SetTuplesRangeWorker(vtkIdType srcStartTuple, vtkIdType dstStartTuple,
-                       vtkIdType numTuples)
-    : SrcStartTuple(srcStartTuple), DstStartTuple(dstStartTuple),
-      NumTuples(numTuples)
-  {}
-
-  // Generic implementation. We perform the obvious optimizations for AOS/SOA
-  // in the derived class implementations.
-  template <typename SrcArrayT, typename DstArrayT>
-  void operator()(SrcArrayT *src, DstArrayT *dst)
-  {
-    vtkDataArrayAccessor<SrcArrayT> s(src);
-    vtkDataArrayAccessor<DstArrayT> d(dst);
-
-    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DestType;
-
-    int numComps = src->GetNumberOfComponents();
-    vtkIdType srcT = this->SrcStartTuple;
-    vtkIdType srcTEnd = srcT + this->NumTuples;
-    vtkIdType dstT = this->DstStartTuple;
-
-    while (srcT < srcTEnd)
-    {
-      for (int c = 0; c < numComps; ++c)
-      {
-        d.Set(dstT, c, static_cast<DestType>(s.Get(srcT, c)));
-      }
-      ++srcT;
-      ++dstT;
-    }
-  }
-};
-
 template<typename InfoType, typename KeyType>
 bool hasValidKey(InfoType info, KeyType key,
                    vtkMTimeType mtime, double range[2] )
@@ -435,7 +393,8 @@ void vtkDataArray::DeepCopy(vtkDataArray *da)
     this->SetNumberOfComponents(numComps);
     this->SetNumberOfTuples(numTuples);
 
-    DeepCopyWorker worker;
+    CopyTuplesWorker worker(NULL, 0, NULL, 0, numTuples,
+      numTuples * numComps >= ThreadedCopyThreshold);
     if (!vtkArrayDispatch::Dispatch2::Execute(da, this, worker))
     {
       // If dispatch fails, use fallback:
@@ -540,6 +499,15 @@ vtkIdType vtkDataArray::InsertNextTuple(vtkIdType srcTupleIdx,
   return tupleIdx;
 }
 
+//----------------------------------------------------------------------------
+bool vtkDataArray::UseThreadedCopy(vtkDataArray *src, vtkDataArray *dst,
+                                   vtkIdType numValues)
+{
+  DispatchableWorker worker;
+  return numValues >= ThreadedCopyThreshold && src != dst &&
+    vtkArrayDispatch::Dispatch2SameValueType::Execute(src, dst, worker);
+}
+
 //----------------------------------------------------------------------------
 void vtkDataArray::InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
                                 vtkAbstractArray *src)
@@ -576,11 +544,16 @@ void vtkDataArray::InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
     return;
   }
 
+  // Scattering to increasing destination ids writes every tuple once, which
+  // allows threading the copy.
+  vtkIdType numTuples = dstIds->GetNumberOfIds();
   vtkIdType maxSrcTupleId = srcIds->GetId(0);
   vtkIdType maxDstTupleId = dstIds->GetId(0);
-  for (int i = 1; i < dstIds->GetNumberOfIds(); ++i)
+  bool increasing = true;
+  for (vtkIdType i = 1; i < numTuples; ++i)
   {
     maxSrcTupleId = std::max(maxSrcTupleId, srcIds->GetId(i));
+    increasing = increasing && dstIds->GetId(i) > maxDstTupleId;
     maxDstTupleId = std::max(maxDstTupleId, dstIds->GetId(i));
   }
 
@@ -604,7 +577,9 @@ void vtkDataArray::InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
 
   this->MaxId = std::max(this->MaxId, newSize - 1);
 
-  SetTuplesIdListWorker worker(srcIds, dstIds);
+  CopyTuplesWorker worker(srcIds->GetPointer(0), 0, dstIds->GetPointer(0), 0,
+    numTuples, increasing && srcDA != this &&
+    numTuples * this->NumberOfComponents >= ThreadedCopyThreshold);
   if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(srcDA, this, worker))
   {
     worker(srcDA, this);
@@ -663,7 +638,8 @@ void vtkDataArray::InsertTuples(vtkIdType dstStart, vtkIdType n,
 
   this->MaxId = std::max(this->MaxId, newSize - 1);
 
-  SetTuplesRangeWorker worker(srcStart, dstStart, n);
+  CopyTuplesWorker worker(NULL, srcStart, NULL, dstStart, n, srcDA != this &&
+    n * this->NumberOfComponents >= ThreadedCopyThreshold);
   if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(srcDA, this, worker))
   {
     worker(srcDA, this);
@@ -1366,7 +1342,10 @@ void vtkDataArray::GetTuples(vtkIdList *tupleIds, vtkAbstractArray *aa)
     return;
   }
 
-  GetTuplesFromListWorker worker(tupleIds);
+  vtkIdType numTuples = tupleIds->GetNumberOfIds();
+  CopyTuplesWorker worker(tupleIds->GetPointer(0), 0, NULL, 0, numTuples,
+    da != this &&
+    numTuples * this->NumberOfComponents >= ThreadedCopyThreshold);
   if (!vtkArrayDispatch::Dispatch2::Execute(this, da, worker))
   {
     // Use fallback if dispatch fails.
@@ -1392,7 +1371,11 @@ void vtkDataArray::GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray *aa)
     return;
   }
 
-  GetTuplesRangeWorker worker(p1, p2);
+  // p1-p2 are inclusive
+  vtkIdType numTuples = p2 - p1 + 1;
+  CopyTuplesWorker worker(NULL, p1, NULL, 0, numTuples,
+    da != this &&
+    numTuples * this->NumberOfComponents >= ThreadedCopyThreshold);
   if (!vtkArrayDispatch::Dispatch2::Execute(this, da, worker))
   {
     // Use fallback if dispatch fails.
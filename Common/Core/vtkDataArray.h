@@ -254,6 +254,8 @@ public:
   /**
    * Deep copy of data. Copies data from different data arrays even if
    * they are different types (using doubleing-point exchange).
+   * Large copies between arrays known to vtkArrayDispatch are split over
+   * threads with vtkSMPTools, as are GetTuples() and InsertTuples().
    */
   void DeepCopy(vtkAbstractArray *aa) VTK_OVERRIDE;
   virtual void DeepCopy(vtkDataArray *da);
@@ -569,6 +571,22 @@ protected:
   vtkDataArray();
   ~vtkDataArray() VTK_OVERRIDE;
 
+  /**
+   * Copies of tuples between arrays (DeepCopy(), GetTuples(),
+   * InsertTuples()) moving at least this many values are threaded.
+   */
+  enum { ThreadedCopyThreshold = 65536 };
+
+  /**
+   * Return true if the vtkDataArray implementations of GetTuples() and
+   * InsertTuples() thread a copy of numValues values from src to dst: the
+   * copy is large enough, the arrays are distinct and both are known to
+   * vtkArrayDispatch. Otherwise those implementations copy serially, so
+   * typed subclasses should keep using their own copy loop.
+   */
+  static bool UseThreadedCopy(vtkDataArray *src, vtkDataArray *dst,
+                              vtkIdType numValues);
+
   vtkLookupTable *LookupTable;
   double Range[2];
   double FiniteRange[2];
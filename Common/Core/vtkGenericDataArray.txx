@@ -539,8 +539,10 @@ void vtkGenericDataArray<DerivedT, ValueTypeT>::InsertTuples(
   // First, check for the common case of typeid(source) == typeid(this). This
   // way we don't waste time redoing the other checks in the superclass, and
   // can avoid doing a dispatch for the most common usage of this method.
+  // Large copies are threaded by the superclass when it knows the type.
   DerivedT *other = vtkArrayDownCast<DerivedT>(source);
-  if (!other)
+  if (!other || Superclass::UseThreadedCopy(other, this,
+      srcIds->GetNumberOfIds() * this->NumberOfComponents))
   {
     // Let the superclass handle dispatch/fallback.
     this->Superclass::InsertTuples(dstIds, srcIds, source);
@@ -696,8 +698,10 @@ void vtkGenericDataArray<DerivedT, ValueTypeT>::GetTuples(
   // First, check for the common case of typeid(source) == typeid(this). This
   // way we don't waste time redoing the other checks in the superclass, and
   // can avoid doing a dispatch for the most common usage of this method.
+  // Large copies are threaded by the superclass when it knows the type.
   DerivedT *other = vtkArrayDownCast<DerivedT>(output);
-  if (!other)
+  if (!other || Superclass::UseThreadedCopy(this, other,
+      tupleIds->GetNumberOfIds() * this->NumberOfComponents))
   {
     // Let the superclass handle dispatch/fallback.
     this->Superclass::GetTuples(tupleIds, output);
@@ -737,8 +741,10 @@ void vtkGenericDataArray<DerivedT, ValueTypeT>::GetTuples(
   // First, check for the common case of typeid(source) == typeid(this). This
   // way we don't waste time redoing the other checks in the superclass, and
   // can avoid doing a dispatch for the most common usage of this method.
+  // Large copies are threaded by the superclass when it knows the type.
   DerivedT *other = vtkArrayDownCast<DerivedT>(output);
-  if (!other)
+  if (!other || Superclass::UseThreadedCopy(this, other,
+      (p2 - p1 + 1) * this->NumberOfComponents))
   {
     // Let the superclass handle dispatch/fallback.
     this->Superclass::GetTuples(p1, p2, output);
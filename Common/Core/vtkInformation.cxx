@@ -206,6 +206,7 @@ void vtkInformation::Copy(vtkInformation* from, int deep)
   if(from)
   {
     typedef vtkInformationInternals::MapType MapType;
+    this->Internal->Map.reserve(from->Internal->Map.size());
     for(MapType::const_iterator i = from->Internal->Map.begin();
         i != from->Internal->Map.end(); ++i)
     {
@@ -27,12 +27,7 @@
 #include "vtkInformationKey.h"
 #include "vtkObjectBase.h"
 
-#define VTK_INFORMATION_USE_HASH_MAP
-#ifdef VTK_INFORMATION_USE_HASH_MAP
-# include <vtksys/hash_map.hxx>
-#else
-# include <map>
-#endif
+#include <utility>
 
 //----------------------------------------------------------------------------
 class vtkInformationInternals
@@ -40,23 +35,287 @@ class vtkInformationInternals
 public:
   typedef vtkInformationKey* KeyType;
   typedef vtkObjectBase* DataType;
-#ifdef VTK_INFORMATION_USE_HASH_MAP
-  struct HashFun
+
+  /**
+   * Compact map from information keys to their values. The (key, value)
+   * pairs are stored in one contiguous open-addressing table with linear
+   * probing. The table starts out inside the map itself, so the handful of
+   * keys typically stored in a vtkInformation requires no allocation beyond
+   * the vtkInformationInternals object. Erasing leaves a tombstone behind,
+   * so erasing does not move the other entries and does not invalidate
+   * iterators to them.
+   */
+  class MapType
   {
-    size_t operator()(KeyType key) const
+  public:
+    typedef std::pair<KeyType, DataType> value_type;
+
+    template <typename ValueType>
+    class IteratorType
+    {
+    public:
+      IteratorType() : Slot(0), End(0) {}
+      IteratorType(ValueType* slot, ValueType* end) : Slot(slot), End(end)
+      {
+        this->SkipUnused();
+      }
+      template <typename OtherType>
+      IteratorType(const IteratorType<OtherType>& other)
+        : Slot(other.Slot), End(other.End) {}
+
+      ValueType& operator*() const { return *this->Slot; }
+      ValueType* operator->() const { return this->Slot; }
+      IteratorType& operator++()
+      {
+        ++this->Slot;
+        this->SkipUnused();
+        return *this;
+      }
+      template <typename OtherType>
+      bool operator==(const IteratorType<OtherType>& other) const
+      {
+        return this->Slot == other.Slot;
+      }
+      template <typename OtherType>
+      bool operator!=(const IteratorType<OtherType>& other) const
+      {
+        return this->Slot != other.Slot;
+      }
+
+    private:
+      template <typename OtherType> friend class IteratorType;
+      friend class MapType;
+
+      void SkipUnused()
+      {
+        while (this->Slot != this->End && !MapType::IsUsed(this->Slot->first))
+        {
+          ++this->Slot;
+        }
+      }
+
+      ValueType* Slot;
+      ValueType* End;
+    };
+    typedef IteratorType<value_type> iterator;
+    typedef IteratorType<const value_type> const_iterator;
+
+    MapType() : Table(this->InlineTable), Capacity(InlineCapacity),
+                Size(0), Used(0)
+    {
+      this->ClearTable(this->Table, this->Capacity);
+    }
+
+    ~MapType()
+    {
+      if (this->Table != this->InlineTable)
+      {
+        delete [] this->Table;
+      }
+    }
+
+    iterator begin()
+    {
+      return iterator(this->Table, this->Table + this->Capacity);
+    }
+    iterator end()
+    {
+      return iterator(this->Table + this->Capacity,
+                      this->Table + this->Capacity);
+    }
+    const_iterator begin() const
+    {
+      return const_iterator(this->Table, this->Table + this->Capacity);
+    }
+    const_iterator end() const
+    {
+      return const_iterator(this->Table + this->Capacity,
+                            this->Table + this->Capacity);
+    }
+
+    size_t size() const { return this->Size; }
+    bool empty() const { return this->Size == 0; }
+
+    iterator find(KeyType key)
+    {
+      value_type* slot = this->Lookup(key);
+      if (slot->first == key)
+      {
+        return iterator(slot, this->Table + this->Capacity);
+      }
+      return this->end();
+    }
+    const_iterator find(KeyType key) const
+    {
+      value_type* slot = this->Lookup(key);
+      if (slot->first == key)
+      {
+        return const_iterator(slot, this->Table + this->Capacity);
+      }
+      return this->end();
+    }
+
+    /**
+     * Insert the entry unless its key is already present. Return an
+     * iterator to the entry with that key and whether it was inserted.
+     */
+    std::pair<iterator, bool> insert(const value_type& entry)
+    {
+      value_type* slot = this->Lookup(entry.first);
+      if (slot->first != entry.first)
+      {
+        // Keep at least one quarter of the table empty so that probe
+        // sequences stay short and always terminate.
+        if (4 * (this->Used + 1) > 3 * this->Capacity)
+        {
+          this->Rehash(this->Size + 1);
+          slot = this->Lookup(entry.first);
+        }
+        // Reuse the first tombstone of the probe sequence if there was one.
+        if (!slot->first)
+        {
+          ++this->Used;
+        }
+        *slot = entry;
+        ++this->Size;
+        return std::make_pair(iterator(slot, this->Table + this->Capacity),
+                              true);
+      }
+      return std::make_pair(iterator(slot, this->Table + this->Capacity),
+                            false);
+    }
+
+    void erase(iterator i)
+    {
+      i.Slot->first = Tombstone();
+      i.Slot->second = 0;
+      --this->Size;
+    }
+
+    /**
+     * Make room for at least n entries without further reallocation.
+     */
+    void reserve(size_t n)
+    {
+      if (4 * n > 3 * this->Capacity)
+      {
+        this->Rehash(n);
+      }
+    }
+
+  private:
+    MapType(const MapType&) VTK_DELETE_FUNCTION;
+    void operator=(const MapType&) VTK_DELETE_FUNCTION;
+
+    enum { InlineCapacity = 16 };
+
+    static KeyType Tombstone()
+    {
+      return reinterpret_cast<KeyType>(static_cast<size_t>(1));
+    }
+    static bool IsUsed(KeyType key)
+    {
+      return key && key != Tombstone();
+    }
+    static void ClearTable(value_type* table, size_t capacity)
+    {
+      for (size_t i = 0; i < capacity; ++i)
+      {
+        table[i].first = 0;
+        table[i].second = 0;
+      }
+    }
+
+    // Keys are long-lived objects so their addresses make good hashes once
+    // the (always zero) low bits have been shifted out and the remaining ones
+    // have been mixed into the high bits (Fibonacci hashing).
+    size_t Hash(KeyType key) const
+    {
+      size_t h = reinterpret_cast<size_t>(key) >> 4;
+      h *= static_cast<size_t>(0x9E3779B97F4A7C15ULL);
+      return (h >> (sizeof(size_t) * 4)) & (this->Capacity - 1);
+    }
+
+    // Return the slot holding key if present. Otherwise return the slot
+    // where key should be inserted: the first tombstone met while probing,
+    // or else the empty slot that terminated the probe sequence.
+    value_type* Lookup(KeyType key) const
+    {
+      size_t mask = this->Capacity - 1;
+      value_type* tombstone = 0;
+      for (size_t i = this->Hash(key);; i = (i + 1) & mask)
+      {
+        value_type* slot = this->Table + i;
+        if (slot->first == key)
+        {
+          return slot;
+        }
+        if (!slot->first)
+        {
+          return tombstone ? tombstone : slot;
+        }
+        if (!tombstone && slot->first == Tombstone())
+        {
+          tombstone = slot;
+        }
+      }
+    }
+
+    // Rebuild the table with room for n entries, dropping the tombstones.
+    // The table never shrinks, so when the entries still fit it is rebuilt
+    // at the same capacity, in place for the inline table.
+    void Rehash(size_t n)
+    {
+      size_t capacity = this->Capacity;
+      while (4 * n > 3 * capacity)
+      {
+        capacity *= 2;
+      }
+
+      value_type* oldTable = this->Table;
+      size_t oldCapacity = this->Capacity;
+      if (oldTable == this->InlineTable &&
+          capacity == static_cast<size_t>(InlineCapacity))
+      {
+        value_type saved[InlineCapacity];
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+          saved[i] = oldTable[i];
+        }
+        this->Reinsert(saved, oldCapacity, oldTable, capacity);
+        return;
+      }
+      this->Reinsert(oldTable, oldCapacity, new value_type[capacity], capacity);
+      if (oldTable != this->InlineTable)
+      {
+        delete [] oldTable;
+      }
+    }
+
+    void Reinsert(value_type* from, size_t fromCapacity,
+                  value_type* table, size_t capacity)
     {
-      return static_cast<size_t>(key - KeyType(0));
+      this->ClearTable(table, capacity);
+      this->Table = table;
+      this->Capacity = capacity;
+      this->Used = this->Size;
+      for (size_t i = 0; i < fromCapacity; ++i)
+      {
+        if (IsUsed(from[i].first))
+        {
+          *this->Lookup(from[i].first) = from[i];
+        }
+      }
     }
+
+    value_type* Table;
+    size_t Capacity; // always a power of two
+    size_t Size;     // number of entries
+    size_t Used;     // number of entries and tombstones
+    value_type InlineTable[InlineCapacity];
   };
-  typedef vtksys::hash_map<KeyType, DataType, HashFun> MapType;
-#else
-  typedef std::map<KeyType, DataType> MapType;
-#endif
-  MapType Map;
 
-#ifdef VTK_INFORMATION_USE_HASH_MAP
-  vtkInformationInternals(): Map(33) {}
-#endif
+  MapType Map;
 
   ~vtkInformationInternals()
   {
@@ -70,7 +329,5 @@ public:
   }
 };
 
-#undef VTK_INFORMATION_USE_HASH_MAP
-
 #endif
 // VTK-HeaderTest-Exclude: vtkInformationInternals.h
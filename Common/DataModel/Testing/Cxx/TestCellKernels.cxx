@@ -0,0 +1,208 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellKernels.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Check that vtkCellKernels locates points in distorted cells exactly like
+// vtkCell::EvaluatePosition, for float and double points, and that points
+// that are not stored contiguously are left to vtkCell.
+
+#include "vtkCell.h"
+#include "vtkCellKernels.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkSOADataArrayTemplate.h"
+#include "vtkSmartPointer.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+const double TOLERANCE = 1.e-10;
+
+bool Differ(const double *a, const double *b, int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    if (fabs(a[i] - b[i]) > TOLERANCE)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Rotate a point so that 2D cells do not lie in a coordinate plane.
+void Rotate(double p[3])
+{
+  const double ca = cos(0.3), sa = sin(0.3), cb = cos(0.7), sb = sin(0.7);
+  double y = ca * p[1] - sa * p[2];
+  double z = sa * p[1] + ca * p[2];
+  double x = cb * p[0] - sb * y;
+  p[1] = sb * p[0] + cb * y;
+  p[0] = x;
+  p[2] = z;
+}
+
+int TestCellType(int cellType, int dataType,
+                 vtkMinimalStandardRandomSequence *random)
+{
+  vtkSmartPointer<vtkCell> cell;
+  cell.TakeReference(vtkGenericCell::InstantiateCell(cellType));
+  const int numPts = cell->GetNumberOfPoints();
+  double *ref = cell->GetParametricCoords();
+
+  // The dataset points are shifted by one so that the cell point ids are
+  // actually used; the cell gets the coordinates read back from the points
+  // so that float rounding is the same for both evaluations.
+  vtkNew<vtkPoints> points;
+  points->SetDataType(dataType);
+  points->SetNumberOfPoints(numPts + 1);
+  points->SetPoint(0, 1.e3, 1.e3, 1.e3);
+  std::vector<vtkIdType> ptIds(numPts);
+  for (int i = 0; i < numPts; ++i)
+  {
+    double p[3];
+    for (int j = 0; j < 3; ++j)
+    {
+      random->Next();
+      p[j] = 2.0 * ref[3 * i + j] + 0.2 * (random->GetValue() - 0.5);
+    }
+    Rotate(p);
+    ptIds[i] = i + 1;
+    points->SetPoint(ptIds[i], p);
+    cell->GetPoints()->SetPoint(i, points->GetPoint(ptIds[i]));
+    cell->GetPointIds()->SetId(i, ptIds[i]);
+  }
+
+  std::vector<double> cellWeights(numPts), kernelWeights(numPts);
+  int numInside = 0;
+  for (int sample = 0; sample <= 200; ++sample)
+  {
+    // Sample around the cell, and once at the fifth point (apex of the
+    // pyramids).
+    double x[3], pc[3];
+    int subId = 0;
+    if (sample == 200)
+    {
+      points->GetPoint(ptIds[numPts > 4 ? 4 : numPts - 1], x);
+    }
+    else
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        random->Next();
+        pc[j] = 1.6 * random->GetValue() - 0.3;
+      }
+      cell->EvaluateLocation(subId, pc, x, &cellWeights[0]);
+      if (cell->GetCellDimension() == 2)
+      {
+        x[2] += 0.1 * (pc[2] - 0.5);
+      }
+    }
+
+    double cellPCoords[3], kernelPCoords[3], closest[3];
+    double cellDist2 = 0.0, kernelDist2 = 0.0;
+    int cellResult = cell->EvaluatePosition(x, closest, subId, cellPCoords,
+                                            cellDist2, &cellWeights[0]);
+    int kernelResult = vtkCellKernels::EvaluatePosition(cellType,
+      points.GetPointer(), &ptIds[0], x, kernelPCoords, kernelDist2,
+      &kernelWeights[0]);
+
+    if (cellResult != kernelResult)
+    {
+      cerr << cell->GetClassName() << ": EvaluatePosition returned "
+           << cellResult << " but the kernel returned " << kernelResult
+           << endl;
+      return 0;
+    }
+    if (cellResult == 1)
+    {
+      ++numInside;
+      if (Differ(cellPCoords, kernelPCoords, 3) ||
+          Differ(&cellWeights[0], &kernelWeights[0], numPts) ||
+          fabs(cellDist2 - kernelDist2) > TOLERANCE)
+      {
+        cerr << cell->GetClassName()
+             << ": kernel results differ for an inside point" << endl;
+        return 0;
+      }
+    }
+  }
+
+  if (numInside == 0)
+  {
+    cerr << cell->GetClassName() << ": no sample inside the cell" << endl;
+    return 0;
+  }
+  return 1;
+}
+
+} // end anon namespace
+
+int TestCellKernels(int, char *[])
+{
+  const int cellTypes[] = {
+    VTK_TRIANGLE, VTK_QUAD, VTK_TETRA, VTK_HEXAHEDRON, VTK_WEDGE,
+    VTK_PYRAMID, VTK_QUADRATIC_TETRA, VTK_QUADRATIC_HEXAHEDRON,
+    VTK_QUADRATIC_WEDGE, VTK_QUADRATIC_PYRAMID };
+  const int numCellTypes = sizeof(cellTypes) / sizeof(cellTypes[0]);
+
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+
+  int status = 1;
+  for (int i = 0; i < numCellTypes; ++i)
+  {
+    if (!vtkCellKernels::IsSupported(cellTypes[i]))
+    {
+      cerr << "Cell type " << cellTypes[i] << " is not supported" << endl;
+      status = 0;
+      continue;
+    }
+    status &= TestCellType(cellTypes[i], VTK_FLOAT, random.GetPointer());
+    status &= TestCellType(cellTypes[i], VTK_DOUBLE, random.GetPointer());
+  }
+
+  if (vtkCellKernels::IsSupported(VTK_POLYGON) ||
+      vtkCellKernels::IsSupported(VTK_VOXEL))
+  {
+    cerr << "Unexpected supported cell type" << endl;
+    status = 0;
+  }
+
+  vtkNew<vtkSOADataArrayTemplate<double> > soaCoords;
+  soaCoords->SetNumberOfComponents(3);
+  soaCoords->SetNumberOfTuples(3);
+  soaCoords->Fill(0.0);
+  vtkNew<vtkPoints> soaPoints;
+  soaPoints->SetData(soaCoords.GetPointer());
+  const vtkIdType triangle[3] = { 0, 1, 2 };
+  double x[3] = { 0.0, 0.0, 0.0 }, pcoords[3], dist2, weights[3];
+  if (vtkCellKernels::IsSupported(soaPoints.GetPointer()) ||
+      vtkCellKernels::EvaluatePosition(VTK_TRIANGLE, soaPoints.GetPointer(),
+                                       triangle, x, pcoords, dist2,
+                                       weights) != -1)
+  {
+    cerr << "Structure of arrays points should not be supported" << endl;
+    status = 0;
+  }
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
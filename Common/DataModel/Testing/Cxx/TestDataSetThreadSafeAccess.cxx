@@ -0,0 +1,224 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataSetThreadSafeAccess.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Exercise the const-safe read API of vtkDataSet from concurrent threads on
+// datasets that were never "primed" from a single thread, and make sure the
+// results match a serial traversal.
+
+#include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+// Per-cell results gathered by the parallel traversal.
+struct CellQueryResults
+{
+  std::vector<int> Types;
+  std::vector<vtkIdType> NumPoints;
+  std::vector<vtkIdType> NumNeighbors;
+  std::vector<double> Bounds;
+  std::vector<vtkIdType> Found;
+};
+
+class CellQueryFunctor
+{
+public:
+  vtkDataSet *Input;
+  CellQueryResults *Results;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocalObject<vtkIdList> PtIds;
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+
+  CellQueryFunctor(vtkDataSet *input, CellQueryResults *results) :
+    Input(input), Results(results) {}
+
+  void Initialize() {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell *cell = this->Cell.Local();
+    vtkIdList *ptIds = this->PtIds.Local();
+    vtkIdList *cellIds = this->CellIds.Local();
+    std::vector<double> weights(VTK_CELL_SIZE);
+    double pcoords[3], center[3], bounds[6];
+    int subId;
+
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Results->Types[cellId] = this->Input->GetCellType(cellId);
+
+      this->Input->GetCellPoints(cellId, ptIds);
+      this->Results->NumPoints[cellId] = ptIds->GetNumberOfIds();
+
+      this->Input->GetPointCells(ptIds->GetId(0), cellIds);
+      this->Results->NumNeighbors[cellId] = cellIds->GetNumberOfIds();
+
+      this->Input->GetCellBounds(cellId, bounds);
+      std::copy(bounds, bounds + 6, &this->Results->Bounds[6*cellId]);
+
+      // Locate the cell center; the containing cell must be this one.
+      this->Input->GetCell(cellId, cell);
+      for (int i = 0; i < 3; ++i)
+      {
+        center[i] = 0.5 * (bounds[2*i] + bounds[2*i+1]);
+      }
+      this->Results->Found[cellId] =
+        this->Input->FindCell(center, NULL, cell, -1, 1.e-6, subId, pcoords,
+                              &weights[0]);
+    }
+  }
+
+  void Reduce() {}
+};
+
+int CheckDataSet(vtkDataSet *serialInput, vtkDataSet *parallelInput,
+                 const char *name)
+{
+  vtkIdType numCells = serialInput->GetNumberOfCells();
+
+  CellQueryResults serial, parallel;
+  CellQueryResults *results[2] = { &serial, &parallel };
+  for (int i = 0; i < 2; ++i)
+  {
+    results[i]->Types.resize(numCells);
+    results[i]->NumPoints.resize(numCells);
+    results[i]->NumNeighbors.resize(numCells);
+    results[i]->Bounds.resize(6*numCells);
+    results[i]->Found.resize(numCells);
+  }
+
+  CellQueryFunctor serialFunctor(serialInput, &serial);
+  serialFunctor(0, numCells);
+
+  CellQueryFunctor parallelFunctor(parallelInput, &parallel);
+  vtkSMPTools::For(0, numCells, 1, parallelFunctor);
+
+  for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+  {
+    if (serial.Types[cellId] != parallel.Types[cellId] ||
+        serial.NumPoints[cellId] != parallel.NumPoints[cellId] ||
+        serial.NumNeighbors[cellId] != parallel.NumNeighbors[cellId] ||
+        serial.Found[cellId] != parallel.Found[cellId])
+    {
+      cerr << name << ": topological query mismatch for cell "
+           << cellId << endl;
+      return 0;
+    }
+    for (int i = 0; i < 6; ++i)
+    {
+      if (serial.Bounds[6*cellId+i] != parallel.Bounds[6*cellId+i])
+      {
+        cerr << name << ": bounds mismatch for cell " << cellId << endl;
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+} // end anon namespace
+
+int TestDataSetThreadSafeAccess(int, char *[])
+{
+  const int dim = 12;
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(dim, dim, dim);
+  image->SetSpacing(0.5, 0.5, 0.5);
+
+  // Build an unstructured grid and a polydata from the volume: every voxel
+  // becomes a hexahedron, and its bottom face a quad.
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(image->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType ptId = 0; ptId < image->GetNumberOfPoints(); ++ptId)
+  {
+    image->GetPoint(ptId, x);
+    points->SetPoint(ptId, x);
+  }
+
+  vtkNew<vtkCellArray> hexes;
+  vtkNew<vtkCellArray> quads;
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType cellId = 0; cellId < image->GetNumberOfCells(); ++cellId)
+  {
+    image->GetCellPoints(cellId, ptIds.GetPointer());
+    // voxel -> hexahedron ordering
+    vtkIdType hex[8] = { ptIds->GetId(0), ptIds->GetId(1), ptIds->GetId(3),
+                         ptIds->GetId(2), ptIds->GetId(4), ptIds->GetId(5),
+                         ptIds->GetId(7), ptIds->GetId(6) };
+    hexes->InsertNextCell(8, hex);
+    quads->InsertNextCell(4, hex);
+  }
+
+  // Two identical datasets of each type: one traversed serially, one
+  // concurrently, neither being primed beforehand.
+  vtkSmartPointer<vtkUnstructuredGrid> ugrid[2];
+  vtkSmartPointer<vtkPolyData> pdata[2];
+  for (int i = 0; i < 2; ++i)
+  {
+    ugrid[i] = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    ugrid[i]->SetPoints(points.GetPointer());
+    ugrid[i]->SetCells(VTK_HEXAHEDRON, hexes.GetPointer());
+
+    pdata[i] = vtkSmartPointer<vtkPolyData>::New();
+    pdata[i]->SetPoints(points.GetPointer());
+    pdata[i]->SetPolys(quads.GetPointer());
+  }
+
+  int status = 1;
+  status &= CheckDataSet(ugrid[0], ugrid[1], "vtkUnstructuredGrid");
+  status &= CheckDataSet(pdata[0], pdata[1], "vtkPolyData");
+  status &= CheckDataSet(image.GetPointer(), image.GetPointer(),
+                         "vtkImageData");
+
+  // Changing an attribute array makes the data sets newer than their point
+  // locators and cell bounds, so the queries above have to rebuild them, again
+  // from concurrent threads. Releasing the polydata cells must also be
+  // noticed by the concurrent readers.
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(points->GetNumberOfPoints());
+  scalars->FillComponent(0, 1.0);
+  for (int i = 0; i < 2; ++i)
+  {
+    ugrid[i]->GetPointData()->SetScalars(scalars.GetPointer());
+    pdata[i]->GetPointData()->SetScalars(scalars.GetPointer());
+    pdata[i]->DeleteCells();
+  }
+  status &= CheckDataSet(ugrid[0], ugrid[1], "modified vtkUnstructuredGrid");
+  status &= CheckDataSet(pdata[0], pdata[1], "modified vtkPolyData");
+
+  scalars->FillComponent(0, 2.0);
+  scalars->Modified();
+  status &= CheckDataSet(ugrid[0], ugrid[1],
+                         "vtkUnstructuredGrid with modified scalars");
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,607 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellKernels.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkCellKernels
+ * @brief   non-virtual point location in cells read from a point array
+ *
+ *
+ * vtkCellKernels is a set of header-only functions computing the parametric
+ * coordinates and interpolation weights of a point with respect to a cell,
+ * like vtkCell::EvaluatePosition() does. The difference is that the cell
+ * points are read directly from the coordinate array of a dataset through
+ * the cell point ids: no vtkCell / vtkGenericCell has to be filled, and the
+ * evaluation is specialized at compile time for each cell type and point
+ * type. This is meant for inner loops of probing, resampling and particle
+ * tracing algorithms that evaluate many positions.
+ *
+ * The supported cell types are VTK_TRIANGLE, VTK_QUAD, VTK_TETRA,
+ * VTK_HEXAHEDRON, VTK_WEDGE, VTK_PYRAMID, VTK_QUADRATIC_TETRA,
+ * VTK_QUADRATIC_HEXAHEDRON, VTK_QUADRATIC_WEDGE and VTK_QUADRATIC_PYRAMID
+ * (use IsSupported() to check). For those, the results are the ones of the
+ * corresponding vtkCell subclass: the same iterations, tolerances and
+ * special cases are used. Other cell types must go through vtkCell.
+ *
+ * The return value follows vtkCell::EvaluatePosition(): 1 if the point is
+ * inside the cell, 0 if it is outside and -1 if the evaluation failed
+ * (degenerate cell or no convergence). Unlike vtkCell, the closest point is
+ * not computed: dist2 is only set when the point is inside, to the squared
+ * distance between the point and its projection on 2D cells (0 for 3D cells).
+ * Callers needing the closest point of outside points should use vtkCell.
+ *
+ * @sa
+ * vtkCell vtkGenericCell
+*/
+
+#ifndef vtkCellKernels_h
+#define vtkCellKernels_h
+
+#include "vtkAOSDataArrayTemplate.h"
+#include "vtkCellType.h"
+#include "vtkHexahedron.h"
+#include "vtkMath.h"
+#include "vtkPlane.h"
+#include "vtkPoints.h"
+#include "vtkPyramid.h"
+#include "vtkQuad.h"
+#include "vtkQuadraticHexahedron.h"
+#include "vtkQuadraticPyramid.h"
+#include "vtkQuadraticTetra.h"
+#include "vtkQuadraticWedge.h"
+#include "vtkTetra.h"
+#include "vtkTriangle.h"
+#include "vtkWedge.h"
+
+#include <cmath>
+
+namespace vtkCellKernels
+{
+
+// Gather the coordinates of the cell points.
+template <typename T>
+inline void LoadPoints(const T *coords, const vtkIdType *ptIds, int numPts,
+                       double (*pts)[3])
+{
+  for (int i = 0; i < numPts; ++i)
+  {
+    const T *p = coords + 3 * ptIds[i];
+    pts[i][0] = static_cast<double>(p[0]);
+    pts[i][1] = static_cast<double>(p[1]);
+    pts[i][2] = static_cast<double>(p[2]);
+  }
+}
+
+// Newton inversion of the iso-parametric mapping of 3D cells, as done by
+// vtkHexahedron, vtkWedge, vtkPyramid and the quadratic 3D cells. Shape
+// provides the interpolation functions and the iteration parameters.
+template <class Shape>
+struct Newton3D
+{
+  enum { NumberOfPoints = Shape::NumberOfPoints };
+
+  template <typename T>
+  static int EvaluatePosition(const T *coords, const vtkIdType *ptIds,
+                              const double x[3], double pcoords[3],
+                              double &dist2, double *weights)
+  {
+    double pts[NumberOfPoints][3];
+    LoadPoints(coords, ptIds, NumberOfPoints, pts);
+
+    if (Shape::HasApex && AtApex(pts, x))
+    {
+      pcoords[0] = pcoords[1] = 0.0;
+      pcoords[2] = 1.0;
+      Shape::InterpolationFunctions(pcoords, weights);
+      dist2 = 0.0;
+      return 1;
+    }
+
+    double params[3];
+    double fcol[3], rcol[3], scol[3], tcol[3];
+    double derivs[3 * NumberOfPoints];
+
+    pcoords[0] = pcoords[1] = pcoords[2] = Shape::InitialPCoord();
+    params[0] = params[1] = params[2] = Shape::InitialParam();
+
+    bool converged = false;
+    for (int iteration = 0;
+         !converged && iteration < Shape::MaxIterations; ++iteration)
+    {
+      Shape::InterpolationFunctions(pcoords, weights);
+      Shape::InterpolationDerivs(pcoords, derivs);
+
+      for (int j = 0; j < 3; ++j)
+      {
+        fcol[j] = rcol[j] = scol[j] = tcol[j] = 0.0;
+      }
+      for (int i = 0; i < NumberOfPoints; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          fcol[j] += pts[i][j] * weights[i];
+          rcol[j] += pts[i][j] * derivs[i];
+          scol[j] += pts[i][j] * derivs[i + NumberOfPoints];
+          tcol[j] += pts[i][j] * derivs[i + 2 * NumberOfPoints];
+        }
+      }
+      for (int j = 0; j < 3; ++j)
+      {
+        fcol[j] -= x[j];
+      }
+
+      double d = vtkMath::Determinant3x3(rcol, scol, tcol);
+      if (fabs(d) < 1.e-20)
+      {
+        return -1;
+      }
+
+      const double step = Shape::StepScale();
+      pcoords[0] = params[0] -
+        step * vtkMath::Determinant3x3(fcol, scol, tcol) / d;
+      pcoords[1] = params[1] -
+        step * vtkMath::Determinant3x3(rcol, fcol, tcol) / d;
+      pcoords[2] = params[2] -
+        step * vtkMath::Determinant3x3(rcol, scol, fcol) / d;
+
+      if (fabs(pcoords[0] - params[0]) < Shape::Converged() &&
+          fabs(pcoords[1] - params[1]) < Shape::Converged() &&
+          fabs(pcoords[2] - params[2]) < Shape::Converged())
+      {
+        converged = true;
+      }
+      else if (fabs(pcoords[0]) > 1.e6 || fabs(pcoords[1]) > 1.e6 ||
+               fabs(pcoords[2]) > 1.e6)
+      {
+        return -1;
+      }
+      else
+      {
+        params[0] = pcoords[0];
+        params[1] = pcoords[1];
+        params[2] = pcoords[2];
+      }
+    }
+
+    if (!converged)
+    {
+      return -1;
+    }
+
+    Shape::InterpolationFunctions(pcoords, weights);
+
+    const double lower = -Shape::OutsideTolerance();
+    const double upper = 1.0 + Shape::OutsideTolerance();
+    if (pcoords[0] >= lower && pcoords[0] <= upper &&
+        pcoords[1] >= lower && pcoords[1] <= upper &&
+        pcoords[2] >= lower && pcoords[2] <= upper)
+    {
+      dist2 = 0.0;
+      return 1;
+    }
+    return 0;
+  }
+
+  // The pyramid classes check whether the point is at the apex before the
+  // inversion, which has trouble converging there.
+  static bool AtApex(double (*pts)[3], const double x[3])
+  {
+    double baseMidpoint[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 4; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        baseMidpoint[j] += pts[i][j];
+      }
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+      baseMidpoint[j] /= 4.;
+    }
+    double dist2 = vtkMath::Distance2BetweenPoints(pts[4], x);
+    double length2 = vtkMath::Distance2BetweenPoints(pts[4], baseMidpoint);
+    return dist2 == 0. || (length2 != 0. && dist2 / length2 < 1.e-6);
+  }
+};
+
+// Iteration parameters of the 3D cells, see the corresponding vtkCell. The
+// quadratic cells take half Newton steps.
+#define vtkCellKernelsShapeMacro(name, cellClass, numPts, maxIter, conv, \
+                                 tol, pcoord, param, step, apex)         \
+  struct name                                                             \
+  {                                                                       \
+    enum { NumberOfPoints = numPts, MaxIterations = maxIter,              \
+           HasApex = apex };                                              \
+    static double Converged() { return conv; }                            \
+    static double OutsideTolerance() { return tol; }                      \
+    static double InitialPCoord() { return pcoord; }                      \
+    static double InitialParam() { return param; }                        \
+    static double StepScale() { return step; }                            \
+    static void InterpolationFunctions(double pcoords[3], double *w)      \
+    {                                                                     \
+      cellClass::InterpolationFunctions(pcoords, w);                      \
+    }                                                                     \
+    static void InterpolationDerivs(double pcoords[3], double *d)         \
+    {                                                                     \
+      cellClass::InterpolationDerivs(pcoords, d);                         \
+    }                                                                     \
+  }
+
+vtkCellKernelsShapeMacro(HexahedronShape, vtkHexahedron,
+                         8, 10, 1.e-3, 1.e-6, 0.5, 0.5, 1.0, 0);
+vtkCellKernelsShapeMacro(WedgeShape, vtkWedge,
+                         6, 10, 1.e-3, 1.e-3, 0.5, 0.5, 1.0, 0);
+vtkCellKernelsShapeMacro(PyramidShape, vtkPyramid,
+                         5, 10, 1.e-3, 1.e-3, 0.5, 0.3333333, 1.0, 1);
+vtkCellKernelsShapeMacro(QuadraticTetraShape, vtkQuadraticTetra,
+                         10, 20, 1.e-4, 1.e-3, 0.25, 0.25, 0.5, 0);
+vtkCellKernelsShapeMacro(QuadraticHexahedronShape, vtkQuadraticHexahedron,
+                         20, 20, 1.e-4, 1.e-3, 0.5, 0.5, 0.5, 0);
+vtkCellKernelsShapeMacro(QuadraticWedgeShape, vtkQuadraticWedge,
+                         15, 10, 1.e-3, 1.e-3, 0.5, 0.5, 0.5, 0);
+vtkCellKernelsShapeMacro(QuadraticPyramidShape, vtkQuadraticPyramid,
+                         13, 10, 1.e-3, 1.e-3, 0.5, 0.5, 0.5, 1);
+
+#undef vtkCellKernelsShapeMacro
+
+// Kernel for each supported cell type.
+template <int CellType> struct Kernel;
+
+template <> struct Kernel<VTK_HEXAHEDRON> :
+  public Newton3D<HexahedronShape> {};
+template <> struct Kernel<VTK_WEDGE> :
+  public Newton3D<WedgeShape> {};
+template <> struct Kernel<VTK_PYRAMID> :
+  public Newton3D<PyramidShape> {};
+template <> struct Kernel<VTK_QUADRATIC_TETRA> :
+  public Newton3D<QuadraticTetraShape> {};
+template <> struct Kernel<VTK_QUADRATIC_HEXAHEDRON> :
+  public Newton3D<QuadraticHexahedronShape> {};
+template <> struct Kernel<VTK_QUADRATIC_WEDGE> :
+  public Newton3D<QuadraticWedgeShape> {};
+template <> struct Kernel<VTK_QUADRATIC_PYRAMID> :
+  public Newton3D<QuadraticPyramidShape> {};
+
+// Linear tetrahedron: direct solution, as in vtkTetra.
+template <> struct Kernel<VTK_TETRA>
+{
+  enum { NumberOfPoints = 4 };
+
+  template <typename T>
+  static int EvaluatePosition(const T *coords, const vtkIdType *ptIds,
+                              const double x[3], double pcoords[3],
+                              double &dist2, double *weights)
+  {
+    double pts[4][3];
+    LoadPoints(coords, ptIds, 4, pts);
+
+    double rhs[3], c1[3], c2[3], c3[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      rhs[i] = x[i] - pts[0][i];
+      c1[i] = pts[1][i] - pts[0][i];
+      c2[i] = pts[2][i] - pts[0][i];
+      c3[i] = pts[3][i] - pts[0][i];
+    }
+
+    pcoords[0] = pcoords[1] = pcoords[2] = 0.0;
+    double det = vtkMath::Determinant3x3(c1, c2, c3);
+    if (det == 0.0)
+    {
+      return -1;
+    }
+
+    pcoords[0] = vtkMath::Determinant3x3(rhs, c2, c3) / det;
+    pcoords[1] = vtkMath::Determinant3x3(c1, rhs, c3) / det;
+    pcoords[2] = vtkMath::Determinant3x3(c1, c2, rhs) / det;
+    double p4 = 1.0 - pcoords[0] - pcoords[1] - pcoords[2];
+
+    weights[0] = p4;
+    weights[1] = pcoords[0];
+    weights[2] = pcoords[1];
+    weights[3] = pcoords[2];
+
+    if (pcoords[0] >= -0.001 && pcoords[0] <= 1.001 &&
+        pcoords[1] >= -0.001 && pcoords[1] <= 1.001 &&
+        pcoords[2] >= -0.001 && pcoords[2] <= 1.001 &&
+        p4 >= -0.001 && p4 <= 1.001)
+    {
+      dist2 = 0.0;
+      return 1;
+    }
+    return 0;
+  }
+};
+
+// Linear triangle: projection on the triangle plane, as in vtkTriangle.
+template <> struct Kernel<VTK_TRIANGLE>
+{
+  enum { NumberOfPoints = 3 };
+
+  template <typename T>
+  static int EvaluatePosition(const T *coords, const vtkIdType *ptIds,
+                              const double x[3], double pcoords[3],
+                              double &dist2, double *weights)
+  {
+    double pts[3][3];
+    LoadPoints(coords, ptIds, 3, pts);
+    double *pt1 = pts[1], *pt2 = pts[2], *pt3 = pts[0];
+
+    pcoords[2] = 0.0;
+
+    double n[3], cp[3], xp[3] = { x[0], x[1], x[2] };
+    vtkTriangle::ComputeNormalDirection(pt1, pt2, pt3, n);
+    vtkPlane::GeneralizedProjectPoint(xp, pt1, n, cp);
+
+    // Solve in the two coordinates where the projection is the largest.
+    int idx = 0;
+    double maxComponent = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (fabs(n[i]) > maxComponent)
+      {
+        maxComponent = fabs(n[i]);
+        idx = i;
+      }
+    }
+    int indices[2];
+    for (int i = 0, j = 0; i < 3; ++i)
+    {
+      if (i != idx)
+      {
+        indices[j++] = i;
+      }
+    }
+
+    double rhs[2], c1[2], c2[2];
+    for (int i = 0; i < 2; ++i)
+    {
+      rhs[i] = cp[indices[i]] - pt3[indices[i]];
+      c1[i] = pt1[indices[i]] - pt3[indices[i]];
+      c2[i] = pt2[indices[i]] - pt3[indices[i]];
+    }
+
+    double det = vtkMath::Determinant2x2(c1, c2);
+    if (det == 0.0)
+    {
+      pcoords[0] = pcoords[1] = 0.0;
+      return -1;
+    }
+
+    pcoords[0] = vtkMath::Determinant2x2(rhs, c2) / det;
+    pcoords[1] = vtkMath::Determinant2x2(c1, rhs) / det;
+
+    weights[0] = 1 - (pcoords[0] + pcoords[1]);
+    weights[1] = pcoords[0];
+    weights[2] = pcoords[1];
+
+    if (weights[0] >= 0.0 && weights[0] <= 1.0 &&
+        weights[1] >= 0.0 && weights[1] <= 1.0 &&
+        weights[2] >= 0.0 && weights[2] <= 1.0)
+    {
+      dist2 = vtkMath::Distance2BetweenPoints(cp, x);
+      return 1;
+    }
+    return 0;
+  }
+};
+
+// Bilinear quadrilateral: Newton iterations in the quad plane, as in vtkQuad.
+template <> struct Kernel<VTK_QUAD>
+{
+  enum { NumberOfPoints = 4 };
+
+  template <typename T>
+  static int EvaluatePosition(const T *coords, const vtkIdType *ptIds,
+                              const double x[3], double pcoords[3],
+                              double &dist2, double *weights)
+  {
+    double pts[4][3];
+    LoadPoints(coords, ptIds, 4, pts);
+
+    pcoords[0] = pcoords[1] = 0.5;
+    pcoords[2] = 0.0;
+    double params[2] = { 0.5, 0.5 };
+
+    // If the first three points are co-linear, use the fourth one.
+    double n[3];
+    vtkTriangle::ComputeNormal(pts[0], pts[1], pts[2], n);
+    if (n[0] == 0.0 && n[1] == 0.0 && n[2] == 0.0)
+    {
+      vtkTriangle::ComputeNormal(pts[1], pts[2], pts[3], n);
+    }
+
+    double cp[3], xp[3] = { x[0], x[1], x[2] };
+    vtkPlane::ProjectPoint(xp, pts[0], n, cp);
+
+    int idx = 0;
+    double maxComponent = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (fabs(n[i]) > maxComponent)
+      {
+        maxComponent = fabs(n[i]);
+        idx = i;
+      }
+    }
+    int indices[2];
+    for (int i = 0, j = 0; i < 3; ++i)
+    {
+      if (i != idx)
+      {
+        indices[j++] = i;
+      }
+    }
+
+    double fcol[2], rcol[2], scol[2], derivs[8];
+    bool converged = false;
+    for (int iteration = 0; !converged && iteration < 20; ++iteration)
+    {
+      vtkQuad::InterpolationFunctions(pcoords, weights);
+      vtkQuad::InterpolationDerivs(pcoords, derivs);
+
+      fcol[0] = fcol[1] = rcol[0] = rcol[1] = scol[0] = scol[1] = 0.0;
+      for (int i = 0; i < 4; ++i)
+      {
+        for (int j = 0; j < 2; ++j)
+        {
+          fcol[j] += pts[i][indices[j]] * weights[i];
+          rcol[j] += pts[i][indices[j]] * derivs[i];
+          scol[j] += pts[i][indices[j]] * derivs[i + 4];
+        }
+      }
+      for (int j = 0; j < 2; ++j)
+      {
+        fcol[j] -= cp[indices[j]];
+      }
+
+      double det = vtkMath::Determinant2x2(rcol, scol);
+      if (det == 0.0)
+      {
+        return -1;
+      }
+
+      pcoords[0] = params[0] - vtkMath::Determinant2x2(fcol, scol) / det;
+      pcoords[1] = params[1] - vtkMath::Determinant2x2(rcol, fcol) / det;
+
+      if (fabs(pcoords[0] - params[0]) < 1.e-4 &&
+          fabs(pcoords[1] - params[1]) < 1.e-4)
+      {
+        converged = true;
+      }
+      else if (fabs(pcoords[0]) > 1.e6 || fabs(pcoords[1]) > 1.e6)
+      {
+        return -1;
+      }
+      else
+      {
+        params[0] = pcoords[0];
+        params[1] = pcoords[1];
+      }
+    }
+
+    if (!converged)
+    {
+      return -1;
+    }
+
+    vtkQuad::InterpolationFunctions(pcoords, weights);
+
+    if (pcoords[0] >= -0.001 && pcoords[0] <= 1.001 &&
+        pcoords[1] >= -0.001 && pcoords[1] <= 1.001)
+    {
+      dist2 = vtkMath::Distance2BetweenPoints(cp, x);
+      return 1;
+    }
+    return 0;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Return whether the cell type has a kernel.
+inline bool IsSupported(int cellType)
+{
+  switch (cellType)
+  {
+    case VTK_TRIANGLE:
+    case VTK_QUAD:
+    case VTK_TETRA:
+    case VTK_HEXAHEDRON:
+    case VTK_WEDGE:
+    case VTK_PYRAMID:
+    case VTK_QUADRATIC_TETRA:
+    case VTK_QUADRATIC_HEXAHEDRON:
+    case VTK_QUADRATIC_WEDGE:
+    case VTK_QUADRATIC_PYRAMID:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Return the coordinates of the points if they are stored contiguously as
+// values of type T (vtkAOSDataArrayTemplate<T>), NULL otherwise.
+template <typename T>
+inline const T *GetCoordinates(vtkPoints *points)
+{
+  vtkAOSDataArrayTemplate<T> *data = points ?
+    vtkArrayDownCast<vtkAOSDataArrayTemplate<T> >(points->GetData()) : NULL;
+  return data ? data->GetPointer(0) : NULL;
+}
+
+//----------------------------------------------------------------------------
+// Return whether the kernels can read the given points directly, i.e. they
+// are stored contiguously as float or double.
+inline bool IsSupported(vtkPoints *points)
+{
+  return GetCoordinates<float>(points) || GetCoordinates<double>(points);
+}
+
+//----------------------------------------------------------------------------
+// Evaluate the position x with respect to the cell of type cellType whose
+// point ids are ptIds, coords being the point coordinates (3 components per
+// point). Returns -1 for unsupported cell types.
+template <typename T>
+inline int EvaluatePosition(int cellType, const T *coords,
+                            const vtkIdType *ptIds, const double x[3],
+                            double pcoords[3], double &dist2,
+                            double *weights)
+{
+  switch (cellType)
+  {
+#define vtkCellKernelsCaseMacro(type)                                    \
+    case type:                                                           \
+      return Kernel<type>::EvaluatePosition(coords, ptIds, x, pcoords,   \
+                                            dist2, weights)
+    vtkCellKernelsCaseMacro(VTK_TRIANGLE);
+    vtkCellKernelsCaseMacro(VTK_QUAD);
+    vtkCellKernelsCaseMacro(VTK_TETRA);
+    vtkCellKernelsCaseMacro(VTK_HEXAHEDRON);
+    vtkCellKernelsCaseMacro(VTK_WEDGE);
+    vtkCellKernelsCaseMacro(VTK_PYRAMID);
+    vtkCellKernelsCaseMacro(VTK_QUADRATIC_TETRA);
+    vtkCellKernelsCaseMacro(VTK_QUADRATIC_HEXAHEDRON);
+    vtkCellKernelsCaseMacro(VTK_QUADRATIC_WEDGE);
+    vtkCellKernelsCaseMacro(VTK_QUADRATIC_PYRAMID);
+#undef vtkCellKernelsCaseMacro
+    default:
+      return -1;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Same as above, reading the coordinates from float or double points (see
+// IsSupported()). Returns -1 for other point types.
+inline int EvaluatePosition(int cellType, vtkPoints *points,
+                            const vtkIdType *ptIds, const double x[3],
+                            double pcoords[3], double &dist2,
+                            double *weights)
+{
+  if (const float *coords = GetCoordinates<float>(points))
+  {
+    return EvaluatePosition(cellType, coords, ptIds, x, pcoords, dist2,
+                            weights);
+  }
+  if (const double *coords = GetCoordinates<double>(points))
+  {
+    return EvaluatePosition(cellType, coords, ptIds, x, pcoords, dist2,
+                            weights);
+  }
+  return -1;
+}
+
+} // end namespace vtkCellKernels
+
+#endif
+// VTK-HeaderTest-Exclude: vtkCellKernels.h
@@ -19,17 +19,21 @@
 #include "vtkCellData.h"
 #include "vtkCellTypes.h"
 #include "vtkDataSetCellIterator.h"
-#include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
 #include "vtkPointData.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkSmartPointer.h"
 #include "vtkStructuredData.h"
 
 #include <cmath>
 
+// Serializes the lazy bounds computation performed by the thread-safe
+// GetBounds()/GetCenter()/GetLength() variants.
+static vtkSimpleCriticalSection vtkDataSetBoundsLock;
+
 
 //----------------------------------------------------------------------------
 // Constructor with default bounds (0,1, 0,1, 0,1).
@@ -197,10 +201,33 @@ double *vtkDataSet::GetBounds()
   return this->Bounds;
 }
 
+//----------------------------------------------------------------------------
+// Bring the cached bounds up to date. Only the first thread to notice stale
+// bounds computes them; the others wait and then read the result. The
+// published time is atomic, so a reader that finds it newer than the data
+// set also sees the Bounds written before it was stored.
+void vtkDataSet::ComputeBoundsSynchronized()
+{
+  if ( this->GetMTime() >= this->BoundsPublishedTime )
+  {
+    vtkDataSetBoundsLock.Lock();
+    if ( this->GetMTime() >= this->BoundsPublishedTime )
+    {
+      this->ComputeBounds();
+      // ComputeBounds() does not touch ComputeTime when there is nothing to
+      // bound (no points), so the time is taken here.
+      vtkTimeStamp published;
+      published.Modified();
+      this->BoundsPublishedTime = published.GetMTime();
+    }
+    vtkDataSetBoundsLock.Unlock();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkDataSet::GetBounds(double bounds[6])
 {
-  this->ComputeBounds();
+  this->ComputeBoundsSynchronized();
   for (int i=0; i<6; i++)
   {
     bounds[i] = this->Bounds[i];
@@ -222,7 +249,7 @@ double *vtkDataSet::GetCenter()
 //----------------------------------------------------------------------------
 void vtkDataSet::GetCenter(double center[3])
 {
-  this->ComputeBounds();
+  this->ComputeBoundsSynchronized();
   for (int i=0; i<3; i++)
   {
     center[i] = (this->Bounds[2*i+1] + this->Bounds[2*i]) / 2.0;
@@ -241,7 +268,7 @@ double vtkDataSet::GetLength()
   double diff, l=0.0;
   int i;
 
-  this->ComputeBounds();
+  this->ComputeBoundsSynchronized();
   for (i=0; i<3; i++)
   {
     diff = static_cast<double>(this->Bounds[2*i+1]) -
@@ -327,15 +354,37 @@ void vtkDataSet::GetCellTypes(vtkCellTypes *types)
 
 
 //----------------------------------------------------------------------------
-// Default implementation. This is very slow way to compute this information.
+// Default implementation. Only the cell's point ids and coordinates are
+// queried (no cell is constructed), so this is safe to call concurrently.
 // Subclasses should override this method for efficiency.
 void vtkDataSet::GetCellBounds(vtkIdType cellId, double bounds[6])
 {
-  vtkGenericCell *cell = vtkGenericCell::New();
+  vtkIdList *ptIds = vtkIdList::New();
+  double x[3];
+
+  this->GetCellPoints(cellId, ptIds);
+  vtkIdType numPts = ptIds->GetNumberOfIds();
+  if ( numPts <= 0 )
+  {
+    vtkMath::UninitializeBounds(bounds);
+    ptIds->Delete();
+    return;
+  }
 
-  this->GetCell(cellId, cell);
-  cell->GetBounds(bounds);
-  cell->Delete();
+  this->GetPoint(ptIds->GetId(0), x);
+  bounds[0] = bounds[1] = x[0];
+  bounds[2] = bounds[3] = x[1];
+  bounds[4] = bounds[5] = x[2];
+  for (vtkIdType i=1; i < numPts; i++)
+  {
+    this->GetPoint(ptIds->GetId(i), x);
+    for (int j=0; j < 3; j++)
+    {
+      bounds[2*j] = (x[j] < bounds[2*j] ? x[j] : bounds[2*j]);
+      bounds[2*j+1] = (x[j] > bounds[2*j+1] ? x[j] : bounds[2*j+1]);
+    }
+  }
+  ptIds->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -396,6 +445,7 @@ void vtkDataSet::InternalDataSetCopy(vtkDataSet *src)
   this->ScalarRange[1] = src->ScalarRange[1];
 
   this->ComputeTime = src->ComputeTime;
+  this->BoundsPublishedTime = 0;
   for (idx = 0; idx < 3; ++idx)
   {
     this->Bounds[2*idx] = src->Bounds[2*idx];
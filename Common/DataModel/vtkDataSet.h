@@ -31,6 +31,15 @@
  * (data at cells). Typically filters operate on point data, but some may
  * operate on cell data, both cell and point data, either one, or none.
  *
+ * Methods documented as "THREAD SAFE AS LONG AS THE DATASET IS NOT
+ * MODIFIED" form the const-safe read API: they may be invoked concurrently
+ * from any number of threads without first priming the dataset from a
+ * single thread (e.g., by calling GetCell(0)). Internal structures built on
+ * demand (cell types and locations, cell links, point locators, bounds) are
+ * constructed exactly once, by the first thread that needs them, while other
+ * threads wait. Per-thread scratch storage (a vtkGenericCell or vtkIdList)
+ * must be supplied by the caller. Subclasses must honor this contract.
+ *
  * @sa
  * vtkPointSet vtkStructuredPoints vtkStructuredGrid vtkUnstructuredGrid
  * vtkRectilinearGrid vtkPolyData vtkPointData vtkCellData
@@ -43,6 +52,8 @@
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkDataObject.h"
 
+#include "vtkAtomic.h" // For vtkAtomic
+
 class vtkCell;
 class vtkCellData;
 class vtkCellIterator;
@@ -95,8 +106,7 @@ public:
   /**
    * Copy point coordinates into user provided array x[3] for specified
    * point id.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetPoint(vtkIdType id, double x[3]);
 
@@ -120,8 +130,7 @@ public:
    * Get cell with cellId such that: 0 <= cellId < NumberOfCells.
    * This is a thread-safe alternative to the previous GetCell()
    * method.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetCell(vtkIdType cellId, vtkGenericCell *cell) = 0;
 
@@ -133,15 +142,13 @@ public:
    * that actually uses a GetCell() call.  This is to ensure the method
    * is available to all datasets.  Subclasses should override this method
    * to provide an efficient implementation.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetCellBounds(vtkIdType cellId, double bounds[6]);
 
   /**
    * Get type of cell with cellId such that: 0 <= cellId < NumberOfCells.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual int GetCellType(vtkIdType cellId) = 0;
 
@@ -151,22 +158,19 @@ public:
    * For example a dataset 5 triangles, 3 lines, and 100 hexahedra would
    * result a list of three entries, corresponding to the types VTK_TRIANGLE,
    * VTK_LINE, and VTK_HEXAHEDRON.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetCellTypes(vtkCellTypes *types);
 
   /**
    * Topological inquiry to get points defining cell.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetCellPoints(vtkIdType cellId, vtkIdList *ptIds) = 0;
 
   /**
    * Topological inquiry to get cells using point.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetPointCells(vtkIdType ptId, vtkIdList *cellIds) = 0;
 
@@ -174,8 +178,7 @@ public:
    * Topological inquiry to get all cells using list of points exclusive of
    * cell specified (e.g., cellId). Note that the list consists of only
    * cells that use ALL the points provided.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual void GetCellNeighbors(vtkIdType cellId, vtkIdList *ptIds,
                                 vtkIdList *cellIds);
@@ -185,8 +188,7 @@ public:
    * Locate the closest point to the global coordinate x. Return the
    * point id. If point id < 0; then no point found. (This may arise
    * when point is outside of dataset.)
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   vtkIdType FindPoint(double x, double y, double z)
   {
@@ -216,8 +218,7 @@ public:
    * This is a version of the above method that can be used with
    * multithreaded applications. A vtkGenericCell must be passed in
    * to be used in internal calls that might be made to GetCell()
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   virtual vtkIdType FindCell(double x[3], vtkCell *cell,
                              vtkGenericCell *gencell, vtkIdType cellId,
@@ -276,8 +277,7 @@ public:
   /**
    * Return a pointer to the geometry bounding box in the form
    * (xmin,xmax, ymin,ymax, zmin,zmax).
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   void GetBounds(double bounds[6]);
 
@@ -289,15 +289,13 @@ public:
 
   /**
    * Get the center of the bounding box.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   void GetCenter(double center[3]);
 
   /**
    * Return the length of the diagonal of the bounding box.
-   * THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-   * THE DATASET IS NOT MODIFIED
+   * THIS METHOD IS THREAD SAFE AS LONG AS THE DATASET IS NOT MODIFIED
    */
   double GetLength();
 
@@ -514,6 +512,18 @@ protected:
 
 private:
   void InternalDataSetCopy(vtkDataSet *src);
+
+  /**
+   * Invoke ComputeBounds() if the bounds are out of date, serializing the
+   * computation so that concurrent readers do not race on Bounds.
+   */
+  void ComputeBoundsSynchronized();
+
+  // ComputeTime of the bounds last brought up to date by
+  // ComputeBoundsSynchronized(). Readers compare against this instead of
+  // ComputeTime, which may be written by a concurrent computation.
+  vtkAtomic<vtkMTimeType> BoundsPublishedTime;
+
   /**
    * Called when point/cell data is modified
    * Updates caches to point/cell ghost arrays.
@@ -469,12 +469,15 @@ void vtkFieldData::Reset()
 // CopyStructure() creates).
 void vtkFieldData::GetField(vtkIdList *ptIds, vtkFieldData *f)
 {
-  int i, numIds=ptIds->GetNumberOfIds();
-
-  for (i=0; i < numIds; i++)
+  vtkIdType numIds = ptIds->GetNumberOfIds();
+  vtkIdList *dstIds = vtkIdList::New();
+  dstIds->SetNumberOfIds(numIds);
+  for (vtkIdType i = 0; i < numIds; i++)
   {
-    f->InsertTuple(i, ptIds->GetId(i), this);
+    dstIds->SetId(i, i);
   }
+  f->InsertTuples(dstIds, ptIds, this);
+  dstIds->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -860,6 +863,27 @@ void vtkFieldData::InsertTuple(const vtkIdType i, const vtkIdType j,
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkFieldData::InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
+                                vtkFieldData* source)
+{
+  for ( int k=0; k < this->GetNumberOfArrays(); k++ )
+  {
+    this->Data[k]->InsertTuples(dstIds, srcIds, source->GetAbstractArray(k));
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkFieldData::InsertTuples(vtkIdType dstStart, vtkIdType n,
+                                vtkIdType srcStart, vtkFieldData* source)
+{
+  for ( int k=0; k < this->GetNumberOfArrays(); k++ )
+  {
+    this->Data[k]->InsertTuples(dstStart, n, srcStart,
+                                source->GetAbstractArray(k));
+  }
+}
+
 //----------------------------------------------------------------------------
 // Insert the tuple value at the end of the tuple matrix. Range
 // checking is performed and memory is allocated as necessary.
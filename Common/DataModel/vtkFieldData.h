@@ -354,6 +354,22 @@ public:
    */
   vtkIdType InsertNextTuple(const vtkIdType j, vtkFieldData* source);
 
+  /**
+   * Copy the tuples indexed in srcIds from the source field data to the
+   * locations indexed by dstIds, for every array. Memory is allocated as
+   * necessary. Large copies are threaded (see vtkDataArray::InsertTuples()).
+   */
+  void InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds,
+                    vtkFieldData* source);
+
+  /**
+   * Copy n consecutive tuples starting at srcStart from the source field
+   * data to this one, starting at dstStart, for every array. Memory is
+   * allocated as necessary.
+   */
+  void InsertTuples(vtkIdType dstStart, vtkIdType n, vtkIdType srcStart,
+                    vtkFieldData* source);
+
 protected:
 
   vtkFieldData();
@@ -33,6 +33,7 @@
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 #include "vtkPolygon.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkTimerLog.h"
 #include "vtkVoxel.h"
 
@@ -957,6 +958,10 @@ private:
 
 vtkStandardNewMacro(vtkHyperOctree);
 
+// Serializes the on-demand construction of the cell links triggered by the
+// thread-safe query methods.
+static vtkSimpleCriticalSection vtkHyperOctreeLinksLock;
+
 //-----------------------------------------------------------------------------
 // Default constructor.
 vtkHyperOctree::vtkHyperOctree()
@@ -985,6 +990,7 @@ vtkHyperOctree::vtkHyperOctree()
   this->LeafCornerIds = 0;
 
   this->Links = 0;
+  this->LinksReady = 0;
 
   this->Voxel = vtkVoxel::New();
   this->Pixel = vtkPixel::New();
@@ -2365,10 +2371,7 @@ void vtkHyperOctree::GetPointCells(vtkIdType ptId, vtkIdList *cellIds)
   int numCells;
   int i;
 
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
   cellIds->Reset();
 
   numCells = this->Links->GetNcells(ptId);
@@ -2391,16 +2394,30 @@ void vtkHyperOctree::BuildLinks()
   this->Links->Delete();
 }
 
+//-----------------------------------------------------------------------------
+// LinksReady is atomic, so a reader that sees it set also sees the links
+// fully built.
+void vtkHyperOctree::BuildLinksIfNeeded()
+{
+  if ( !this->LinksReady )
+  {
+    vtkHyperOctreeLinksLock.Lock();
+    if ( !this->Links )
+    {
+      this->BuildLinks();
+    }
+    this->LinksReady = 1;
+    vtkHyperOctreeLinksLock.Unlock();
+  }
+}
+
 
 //-----------------------------------------------------------------------------
 // This is exactly the same as GetCellNeighbors in unstructured grid.
 void vtkHyperOctree::GetCellNeighbors(vtkIdType cellId, vtkIdList *ptIds,
                                            vtkIdList *cellIds)
 {
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
 
   cellIds->Reset();
 
@@ -3117,6 +3134,7 @@ void vtkHyperOctree::DeleteInternalArrays()
     this->Links->Delete();
     this->Links = 0;
   }
+  this->LinksReady = 0;
 }
 
 //=============================================================================
@@ -121,6 +121,7 @@
 
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkDataSet.h"
+#include "vtkAtomicTypes.h" // For vtkAtomicInt32
 
 class vtkHyperOctreeLightWeightCursor;
 class vtkHyperOctreeCursor;
@@ -601,6 +602,12 @@ protected:
   vtkCellLinks* Links;
   void BuildLinks();
 
+  // Build the cell links if they do not exist yet. Unlike BuildLinks(),
+  // this may be called concurrently: the first caller builds the links
+  // while the others wait for them. LinksReady is set once they are built.
+  void BuildLinksIfNeeded();
+  vtkAtomicInt32 LinksReady;
+
   vtkIdType RecursiveFindPoint(double x[3],
     vtkHyperOctreeLightWeightCursor* cursor,
     double *origin, double *size);
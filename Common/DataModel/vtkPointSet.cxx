@@ -21,6 +21,7 @@
 #include "vtkInformationVector.h"
 #include "vtkPointLocator.h"
 #include "vtkPointSetCellIterator.h"
+#include "vtkSimpleCriticalSection.h"
 
 #include "vtkSmartPointer.h"
 #define VTK_CREATE(type, name) \
@@ -28,6 +29,10 @@
 
 #include <set>
 
+// Serializes the on-demand (re)construction of the point locator used by
+// FindPoint() and FindCell().
+static vtkSimpleCriticalSection vtkPointSetLocatorLock;
+
 
 vtkCxxSetObjectMacro(vtkPointSet,Points,vtkPoints);
 
@@ -60,6 +65,7 @@ void vtkPointSet::CopyStructure(vtkDataSet *ds)
     if ( this->Locator )
     {
       this->Locator->Initialize();
+      this->LocatorBuildTime = 0;
     }
     this->SetPoints(ps->Points);
   }
@@ -85,6 +91,7 @@ void vtkPointSet::Initialize()
   if ( this->Locator )
   {
     this->Locator->Initialize();
+    this->LocatorBuildTime = 0;
   }
 }
 //----------------------------------------------------------------------------
@@ -132,20 +139,34 @@ vtkIdType vtkPointSet::FindPoint(double x[3])
     return -1;
   }
 
+  this->BuildLocatorIfNeeded();
+  return this->Locator->FindClosestPoint(x);
+}
+
+//----------------------------------------------------------------------------
+// Create and build the locator when missing or out of date. The locator
+// rebuilds itself whenever the data set (points or attributes) is newer than
+// its build time, so the same condition guards the lock-free path. The locator is built
+// by a single thread; concurrent callers wait until it is ready.
+void vtkPointSet::BuildLocatorIfNeeded()
+{
+  if ( this->GetMTime() < this->LocatorBuildTime )
+  {
+    return;
+  }
+
+  vtkPointSetLocatorLock.Lock();
   if ( !this->Locator )
   {
     this->Locator = vtkPointLocator::New();
     this->Locator->Register(this);
     this->Locator->Delete();
-    this->Locator->SetDataSet(this);
-  }
-
-  if ( this->Points->GetMTime() > this->Locator->GetMTime() )
-  {
-    this->Locator->SetDataSet(this);
   }
-
-  return this->Locator->FindClosestPoint(x);
+  // BuildLocator() returns right away when the locator is up to date.
+  this->Locator->SetDataSet(this);
+  this->Locator->BuildLocator();
+  this->LocatorBuildTime = this->Locator->GetBuildTime();
+  vtkPointSetLocatorLock.Unlock();
 }
 
 //the furthest the walk can be - prevents aimless wandering
@@ -255,20 +276,7 @@ vtkIdType vtkPointSet::FindCell(double x[3], vtkCell *cell,
     return -1;
   }
 
-  if ( !this->Locator )
-  {
-    this->Locator = vtkPointLocator::New();
-    this->Locator->Register(this);
-    this->Locator->Delete();
-    this->Locator->SetDataSet(this);
-    this->Locator->BuildLocator();
-  }
-
-  if ( this->Points->GetMTime() > this->Locator->GetBuildTime() )
-  {
-    this->Locator->SetDataSet(this);
-    this->Locator->BuildLocator();
-  }
+  this->BuildLocatorIfNeeded();
 
   std::set<vtkIdType> visitedCells;
   VTK_CREATE(vtkIdList, ptIds);
@@ -32,6 +32,7 @@
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkDataSet.h"
 
+#include "vtkAtomic.h" // For vtkAtomic
 #include "vtkPoints.h" // Needed for inline methods
 
 class vtkPointLocator;
@@ -154,6 +155,17 @@ private:
 
   void Cleanup();
 
+  /**
+   * Create and build the point locator if it is missing or stale. This may
+   * be called concurrently; the locator is built only once.
+   */
+  void BuildLocatorIfNeeded();
+
+  // Build time of the locator, published once the locator is complete.
+  // Readers compare against this instead of querying the locator, which may
+  // be rebuilt by a concurrent caller.
+  vtkAtomic<vtkMTimeType> LocatorBuildTime;
+
   vtkPointSet(const vtkPointSet&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPointSet&) VTK_DELETE_FUNCTION;
 };
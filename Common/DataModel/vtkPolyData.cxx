@@ -30,6 +30,7 @@
 #include "vtkPolyVertex.h"
 #include "vtkPolygon.h"
 #include "vtkQuad.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleStrip.h"
 #include "vtkVertex.h"
@@ -38,6 +39,10 @@
 
 vtkStandardNewMacro(vtkPolyData);
 
+// Serializes the on-demand construction of the Cells and Links structures
+// triggered by the thread-safe query methods.
+static vtkSimpleCriticalSection vtkPolyDataBuildLock;
+
 //----------------------------------------------------------------------------
 // Initialize static member.  This member is used to simplify traversal
 // of verts, lines, polygons, and triangle strips lists.  It basically
@@ -207,15 +212,14 @@ void vtkPolyData::CopyStructure(vtkDataSet *ds)
     this->Links->UnRegister(this);
     this->Links = NULL;
   }
+  this->CellsReady = 0;
+  this->LinksReady = 0;
 }
 
 //----------------------------------------------------------------------------
 int vtkPolyData::GetCellType(vtkIdType cellId)
 {
-  if ( !this->Cells )
-  {
-    this->BuildCells();
-  }
+  this->BuildCellsIfNeeded();
   return this->Cells->GetCellType(cellId);
 }
 
@@ -344,10 +348,7 @@ void vtkPolyData::GetCell(vtkIdType cellId, vtkGenericCell *cell)
   unsigned char   type;
   double           x[3];
 
-  if ( !this->Cells )
-  {
-    this->BuildCells();
-  }
+  this->BuildCellsIfNeeded();
 
   type = this->Cells->GetCellType(cellId);
   loc = this->Cells->GetCellLocation(cellId);
@@ -499,10 +500,7 @@ void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
   unsigned char type;
   double x[3];
 
-  if ( !this->Cells )
-  {
-    this->BuildCells();
-  }
+  this->BuildCellsIfNeeded();
 
   type = this->Cells->GetCellType(cellId);
   loc = this->Cells->GetCellLocation(cellId);
@@ -810,6 +808,8 @@ void vtkPolyData::Cleanup()
     this->Links->UnRegister(this);
     this->Links = NULL;
   }
+  this->CellsReady = 0;
+  this->LinksReady = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -916,6 +916,8 @@ void vtkPolyData::DeleteCells()
     this->Cells->UnRegister( this );
     this->Cells = NULL;
   }
+  this->CellsReady = 0;
+  this->LinksReady = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1046,13 +1048,33 @@ void vtkPolyData::BuildCells()
     }
   }
 
-  // set up the cell types data structure
-  this->Cells = vtkCellTypes::New();
-  this->Cells->SetCellTypes(nCells, types, locs);
-  this->Cells->Register(this);
-  this->Cells->Delete();
+  // set up the cell types data structure. It is fully populated before
+  // being published so that concurrent readers never observe a partial one.
+  vtkCellTypes *cells = vtkCellTypes::New();
+  cells->SetCellTypes(nCells, types, locs);
+  cells->Register(this);
+  cells->Delete();
   types->Delete();
   locs->Delete();
+  this->Cells = cells;
+}
+
+//----------------------------------------------------------------------------
+// The ready flags are atomic, so a reader that sees one set also sees the
+// structure it guards fully built. The pointers themselves are only read or
+// written under the lock until then.
+void vtkPolyData::BuildCellsIfNeeded()
+{
+  if ( !this->CellsReady )
+  {
+    vtkPolyDataBuildLock.Lock();
+    if ( !this->Cells )
+    {
+      this->BuildCells();
+    }
+    this->CellsReady = 1;
+    vtkPolyDataBuildLock.Unlock();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -1063,6 +1085,7 @@ void vtkPolyData::DeleteLinks()
     this->Links->UnRegister( this );
     this->Links = NULL;
   }
+  this->LinksReady = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1080,19 +1103,37 @@ void vtkPolyData::BuildLinks(int initialSize)
     this->BuildCells();
   }
 
-  this->Links = vtkCellLinks::New();
+  // Links are published only once complete (see BuildCells()).
+  vtkCellLinks *links = vtkCellLinks::New();
   if ( initialSize > 0 )
   {
-    this->Links->Allocate(initialSize);
+    links->Allocate(initialSize);
   }
   else
   {
-    this->Links->Allocate(this->GetNumberOfPoints());
+    links->Allocate(this->GetNumberOfPoints());
   }
-  this->Links->Register(this);
-  this->Links->Delete();
+  links->Register(this);
+  links->Delete();
 
-  this->Links->BuildLinks(this);
+  links->BuildLinks(this);
+  this->Links = links;
+}
+
+//----------------------------------------------------------------------------
+void vtkPolyData::BuildLinksIfNeeded()
+{
+  if ( !this->LinksReady )
+  {
+    vtkPolyDataBuildLock.Lock();
+    if ( !this->Links )
+    {
+      this->BuildLinks();
+    }
+    this->CellsReady = 1;
+    this->LinksReady = 1;
+    vtkPolyDataBuildLock.Unlock();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -1103,10 +1144,7 @@ void vtkPolyData::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
   vtkIdType *pts, npts;
 
   ptIds->Reset();
-  if ( this->Cells == NULL )
-  {
-    this->BuildCells();
-  }
+  this->BuildCellsIfNeeded();
 
   this->vtkPolyData::GetCellPoints(cellId, npts, pts);
   ptIds->InsertId (npts-1,pts[npts-1]);
@@ -1123,10 +1161,7 @@ void vtkPolyData::GetPointCells(vtkIdType ptId, vtkIdList *cellIds)
   vtkIdType numCells;
   vtkIdType i;
 
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
   cellIds->Reset();
 
   numCells = this->Links->GetNcells(ptId);
@@ -1635,10 +1670,7 @@ void vtkPolyData::GetCellNeighbors(vtkIdType cellId, vtkIdList *ptIds,
   vtkIdType i, j, numPts, cellNum;
   int allFound, oneFound;
 
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
 
   cellIds->Reset();
 
@@ -1822,6 +1854,8 @@ void vtkPolyData::ShallowCopy(vtkDataObject *dataObject)
     {
       this->Links->Register(this);
     }
+    this->CellsReady = 0;
+    this->LinksReady = 0;
   }
 
   // Do superclass
@@ -1861,21 +1895,12 @@ void vtkPolyData::DeepCopy(vtkDataObject *dataObject)
     this->SetStrips(ca);
     ca->Delete();
 
-    if ( this->Cells )
-    {
-      this->Cells->UnRegister(this);
-      this->Cells = NULL;
-    }
+    this->DeleteCells();
     if (polyData->Cells)
     {
       this->BuildCells();
     }
 
-    if ( this->Links )
-    {
-      this->Links->UnRegister(this);
-      this->Links = NULL;
-    }
     if (polyData->Links)
     {
       this->BuildLinks();
@@ -61,6 +61,7 @@
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkPointSet.h"
 
+#include "vtkAtomicTypes.h" // For vtkAtomicInt32
 #include "vtkCellTypes.h" // Needed for inline methods
 #include "vtkCellLinks.h" // Needed for inline methods
 #include "vtkCellArray.h" // Needed for inline methods
@@ -562,6 +563,22 @@ private:
 
   void Cleanup();
 
+  //@{
+  /**
+   * Build the cell and link structures if they do not exist yet. Unlike
+   * BuildCells() and BuildLinks(), these may be called concurrently: the
+   * first caller builds the structure while the others wait for it.
+   */
+  void BuildCellsIfNeeded();
+  void BuildLinksIfNeeded();
+  //@}
+
+  // Set once Cells/Links have been built by the methods above and cleared
+  // whenever those structures are released. Readers test these instead of
+  // the plain pointers, which may be written by a concurrent builder.
+  vtkAtomicInt32 CellsReady;
+  vtkAtomicInt32 LinksReady;
+
 private:
   vtkPolyData(const vtkPolyData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPolyData&) VTK_DELETE_FUNCTION;
@@ -236,7 +236,7 @@ BuildLinks(vtkPolyData *pd)
       npts = *cell++;
       for (i=0; i<npts; ++i)
       {
-        this->Offsets[CellId+(*cell++)]++;
+        this->Offsets[*cell++]++;
       }
     }
     CellId += numCells[j];
@@ -484,6 +484,10 @@ public:
                                          double inputDataLength, double& dist2);
   void FindClosestNPoints(int N, const double x[3], vtkIdList *result);
   void FindPointsWithinRadius(double R, const double x[3], vtkIdList *result);
+  vtkIdType FindSmallestIdWithinRadius(double R, const double x[3],
+                                       vtkIdType ptId,
+                                       const vtkIdType *keptMap=NULL);
+  void MergePoints(double tol, vtkIdType *mergeMap);
   void GenerateRepresentation(int vtkNotUsed(level), vtkPolyData *pd);
 
   // Internal methods
@@ -615,6 +619,32 @@ public:
       }//operator()
   };
 
+  // Map each point to the smallest point id within the tolerance
+  template <typename T>
+  class MergeClose
+  {
+    public:
+      BucketList<T> *BList;
+      double Tol;
+      vtkIdType *MergeMap;
+
+      MergeClose(BucketList<T> *blist, double tol, vtkIdType *mergeMap) :
+        BList(blist), Tol(tol), MergeMap(mergeMap)
+      {
+      }
+
+      void operator() (vtkIdType ptId, vtkIdType end)
+      {
+        double x[3];
+        for ( ; ptId < end; ++ptId )
+        {
+          this->BList->DataSet->GetPoint(ptId, x);
+          this->MergeMap[ptId] =
+            this->BList->FindSmallestIdWithinRadius(this->Tol, x, ptId);
+        }
+      }
+  };
+
   // Build the map and other structures to support locator operations
   void BuildLocator() VTK_OVERRIDE
   {
@@ -1108,6 +1138,84 @@ FindPointsWithinRadius(double R, const double x[3], vtkIdList *result)
   }//k-footprint
 }
 
+//-----------------------------------------------------------------------------
+// Same traversal as FindPointsWithinRadius(), returning the smallest point id
+// found (ptId if there is none smaller). When keptMap is given, only the
+// points i with keptMap[i] == i are considered.
+template <typename TIds> vtkIdType BucketList<TIds>::
+FindSmallestIdWithinRadius(double R, const double x[3], vtkIdType ptId,
+                           const vtkIdType *keptMap)
+{
+  double pt[3];
+  double R2 = R*R;
+  double xMin[3], xMax[3];
+  int i, j, k, ii, ijkMin[3], ijkMax[3];
+  vtkIdType smallest = ptId;
+
+  xMin[0] = x[0] - R;
+  xMin[1] = x[1] - R;
+  xMin[2] = x[2] - R;
+  xMax[0] = x[0] + R;
+  xMax[1] = x[1] + R;
+  xMax[2] = x[2] + R;
+  this->GetBucketIndices(xMin, ijkMin);
+  this->GetBucketIndices(xMax, ijkMax);
+
+  for ( k=ijkMin[2]; k <= ijkMax[2]; ++k)
+  {
+    for ( j=ijkMin[1]; j <= ijkMax[1]; ++j)
+    {
+      for ( i=ijkMin[0]; i <= ijkMax[0]; ++i)
+      {
+        vtkIdType cno = i + j*this->xD + k*this->xyD;
+        vtkIdType numIds = this->GetNumberOfIds(cno);
+        const LocatorTuple<TIds> *ids = this->GetIds(cno);
+        for (ii=0; ii < numIds; ii++)
+        {
+          vtkIdType id = ids[ii].PtId;
+          if ( id < smallest && (!keptMap || keptMap[id] == id) )
+          {
+            this->DataSet->GetPoint(id, pt);
+            if ( vtkMath::Distance2BetweenPoints(x,pt) <= R2 )
+            {
+              smallest = id;
+            }
+          }
+        }//for all points in bucket
+      }//i-footprint
+    }//j-footprint
+  }//k-footprint
+
+  return smallest;
+}
+
+//-----------------------------------------------------------------------------
+// Points are merged greedily in increasing id order, as incremental insertion
+// would do: a point is kept unless a kept point with a smaller id lies within
+// the tolerance, and then merges into the smallest such point. The neighbor
+// search runs in parallel and maps each point to the smallest id within the
+// tolerance. Points with no smaller neighbor are kept, as are points whose
+// smallest neighbor is kept (always the case with a zero tolerance). Only
+// the remaining points are resolved in the ordered pass, against the points
+// already kept.
+template <typename TIds> void BucketList<TIds>::
+MergePoints(double tol, vtkIdType *mergeMap)
+{
+  MergeClose<TIds> merger(this, tol, mergeMap);
+  vtkSMPTools::For(0, this->NumPts, merger);
+
+  double x[3];
+  for ( vtkIdType ptId=0; ptId < this->NumPts; ++ptId )
+  {
+    vtkIdType smallest = mergeMap[ptId];
+    if ( smallest != ptId && mergeMap[smallest] != smallest )
+    {
+      this->DataSet->GetPoint(ptId, x);
+      mergeMap[ptId] = this->FindSmallestIdWithinRadius(tol, x, ptId, mergeMap);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 // Internal method to find those buckets that are within distance specified
 // only those buckets outside of level radiuses of ijk are returned
@@ -1594,6 +1702,27 @@ FindPointsWithinRadius(double R, const double x[3], vtkIdList *result)
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkStaticPointLocator::MergePoints(double tol, vtkIdType *mergeMap)
+{
+  this->BuildLocator(); // will subdivide if modified; otherwise returns
+  if ( !this->Buckets )
+  {
+    return;
+  }
+
+  if ( this->LargeIds )
+  {
+    static_cast<BucketList<vtkIdType>*>(this->Buckets)->
+      MergePoints(tol,mergeMap);
+  }
+  else
+  {
+    static_cast<BucketList<int>*>(this->Buckets)->
+      MergePoints(tol,mergeMap);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkStaticPointLocator::
 GenerateRepresentation(int level, vtkPolyData *pd)
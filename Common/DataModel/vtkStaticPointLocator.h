@@ -144,6 +144,20 @@ public:
   void FindPointsWithinRadius(double R, const double x[3],
                               vtkIdList *result) VTK_OVERRIDE;
 
+  /**
+   * Merge points that lie within the tolerance tol of each other (tol = 0
+   * merges coincident points). On return, mergeMap[i] is the id of the point
+   * that point i merges into (mergeMap[i] == i for the points that are
+   * kept). Points are visited in increasing id order, as with incremental
+   * point insertion: a point is kept unless a kept point lies within tol,
+   * and then merges into the smallest such id. A point is thus never merged
+   * into a point farther than tol. The map must be allocated with the number
+   * of points of the dataset. The neighbor search runs in parallel with
+   * vtkSMPTools. The locator is built if needed, so this method is not
+   * thread safe.
+   */
+  void MergePoints(double tol, vtkIdType *mergeMap);
+
   //@{
   /**
    * See vtkLocator and vtkAbstractPointLocator interface documentation.
@@ -46,6 +46,7 @@
 #include "vtkQuadraticQuad.h"
 #include "vtkQuadraticTetra.h"
 #include "vtkQuadraticTriangle.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkTetra.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleStrip.h"
@@ -66,6 +67,10 @@
 
 vtkStandardNewMacro(vtkUnstructuredGrid);
 
+// Serializes the on-demand construction of the cell links triggered by the
+// thread-safe query methods.
+static vtkSimpleCriticalSection vtkUnstructuredGridLinksLock;
+
 vtkUnstructuredGrid::vtkUnstructuredGrid ()
 {
   this->Vertex = NULL;
@@ -360,6 +365,7 @@ void vtkUnstructuredGrid::CopyStructure(vtkDataSet *ds)
       {
         this->Links->Register(this);
       }
+      this->LinksReady = 0;
     }
 
     if (this->Types != ug->Types)
@@ -432,6 +438,7 @@ void vtkUnstructuredGrid::Cleanup()
     this->Links->UnRegister(this);
     this->Links = NULL;
   }
+  this->LinksReady = 0;
 
   if ( this->Types )
   {
@@ -1295,11 +1302,32 @@ void vtkUnstructuredGrid::BuildLinks()
     this->Links->UnRegister(this);
   }
 
-  this->Links = vtkCellLinks::New();
-  this->Links->Allocate(this->GetNumberOfPoints());
-  this->Links->Register(this);
-  this->Links->BuildLinks(this, this->Connectivity);
-  this->Links->Delete();
+  // The links are published only once complete so that concurrent readers
+  // never observe a partially built structure.
+  vtkCellLinks *links = vtkCellLinks::New();
+  links->Allocate(this->GetNumberOfPoints());
+  links->Register(this);
+  links->BuildLinks(this, this->Connectivity);
+  links->Delete();
+  this->Links = links;
+}
+
+//----------------------------------------------------------------------------
+// LinksReady is atomic, so a reader that sees it set also sees the links
+// fully built. The Links pointer itself is only read or written under the
+// lock until then.
+void vtkUnstructuredGrid::BuildLinksIfNeeded()
+{
+  if ( !this->LinksReady )
+  {
+    vtkUnstructuredGridLinksLock.Lock();
+    if ( !this->Links )
+    {
+      this->BuildLinks();
+    }
+    this->LinksReady = 1;
+    vtkUnstructuredGridLinksLock.Unlock();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -1392,10 +1420,7 @@ void vtkUnstructuredGrid::GetPointCells(vtkIdType ptId, vtkIdList *cellIds)
   int numCells;
   int i;
 
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
   cellIds->Reset();
 
   numCells = this->Links->GetNcells(ptId);
@@ -1602,6 +1627,7 @@ void vtkUnstructuredGrid::ShallowCopy(vtkDataObject *dataObject)
     {
       this->Links->Register(this);
     }
+    this->LinksReady = 0;
 
     if (this->Types)
     {
@@ -1689,6 +1715,7 @@ void vtkUnstructuredGrid::DeepCopy(vtkDataObject *dataObject)
       this->Links->UnRegister(this);
       this->Links = NULL;
     }
+    this->LinksReady = 0;
     if ( this->Types )
     {
       this->Types->UnRegister(this);
@@ -1777,10 +1804,7 @@ void vtkUnstructuredGrid::PrintSelf(ostream& os, vtkIndent indent)
 void vtkUnstructuredGrid::GetCellNeighbors(vtkIdType cellId, vtkIdList *ptIds,
                                            vtkIdList *cellIds)
 {
-  if ( ! this->Links )
-  {
-    this->BuildLinks();
-  }
+  this->BuildLinksIfNeeded();
 
   cellIds->Reset();
 
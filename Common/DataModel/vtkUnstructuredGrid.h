@@ -29,6 +29,7 @@
 
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkUnstructuredGridBase.h"
+#include "vtkAtomicTypes.h" // For vtkAtomicInt32
 
 class vtkCellArray;
 class vtkCellLinks;
@@ -413,6 +414,18 @@ private:
   void operator=(const vtkUnstructuredGrid&) VTK_DELETE_FUNCTION;
 
   void Cleanup();
+
+  /**
+   * Build the cell links if they do not exist yet. Unlike BuildLinks(), this
+   * may be called concurrently: the first caller builds the links while the
+   * others wait for them.
+   */
+  void BuildLinksIfNeeded();
+
+  // Set once Links has been built by BuildLinksIfNeeded() and cleared
+  // whenever the links are released. Readers test this instead of the plain
+  // pointer, which may be written by a concurrent builder.
+  vtkAtomicInt32 LinksReady;
 };
 
 #endif
@@ -0,0 +1,145 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestInformationTable.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the key storage of vtkInformation.
+// .SECTION Description
+// Check vtkInformation key storage under insertion/removal churn, and that
+// churn does not move a small table to the heap.
+
+#include "vtkInformation.h"
+#include "vtkInformationIntegerKey.h"
+#include "vtkInformationInternals.h"
+#include "vtkNew.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+// Insert and remove a few keys at a time, cycling through a larger set so
+// that each round leaves tombstones in new slots. The tombstones must be
+// flushed from the inline table instead of moving it to the heap: the
+// entries must stay inside the map object.
+bool TestInlineChurn()
+{
+  const int numKeys = 64;
+  const int numLive = 8;
+  std::vector<vtkInformationKey*> keys;
+  for (int k = 0; k < numKeys; ++k)
+  {
+    std::ostringstream name;
+    name << "INLINE_KEY_" << k;
+    keys.push_back(vtkInformationIntegerKey::MakeKey(
+      name.str().c_str(), "TestInformationTable"));
+  }
+
+  typedef vtkInformationInternals::MapType MapType;
+  MapType map;
+  const char* begin = reinterpret_cast<const char*>(&map);
+  const char* end = begin + sizeof(MapType);
+  for (int round = 0; round < 1000; ++round)
+  {
+    for (int k = 0; k < numLive; ++k)
+    {
+      map.insert(MapType::value_type(
+        keys[(k + numLive * round) % numKeys], 0));
+    }
+    const char* entry = reinterpret_cast<const char*>(&*map.begin());
+    if (map.size() != static_cast<size_t>(numLive) ||
+        entry < begin || entry >= end)
+    {
+      std::cerr << "Inline table left in round " << round << std::endl;
+      return false;
+    }
+    for (int k = 0; k < numLive; ++k)
+    {
+      map.erase(map.find(keys[(k + numLive * round) % numKeys]));
+    }
+  }
+  return map.empty();
+}
+
+// Insert and remove many keys in various orders and make sure every key
+// keeps its value.
+bool TestKeyChurn()
+{
+  const int numKeys = 200;
+  std::vector<vtkInformationIntegerKey*> keys;
+  for (int k = 0; k < numKeys; ++k)
+  {
+    std::ostringstream name;
+    name << "CHURN_KEY_" << k;
+    keys.push_back(vtkInformationIntegerKey::MakeKey(
+      name.str().c_str(), "TestInformationTable"));
+  }
+
+  vtkNew<vtkInformation> info;
+  for (int round = 0; round < 10; ++round)
+  {
+    for (int k = 0; k < numKeys; ++k)
+    {
+      info->Set(keys[k], k + round);
+    }
+    // Remove every other key, then check all of them.
+    for (int k = round % 2; k < numKeys; k += 2)
+    {
+      info->Remove(keys[k]);
+    }
+    for (int k = 0; k < numKeys; ++k)
+    {
+      bool removed = (k % 2) == (round % 2);
+      if (info->Has(keys[k]) == removed ||
+          (!removed && info->Get(keys[k]) != k + round))
+      {
+        std::cerr << "Wrong state for key " << k << " in round " << round
+                  << std::endl;
+        return false;
+      }
+    }
+    if (info->GetNumberOfKeys() != numKeys / 2)
+    {
+      std::cerr << "Wrong number of keys: " << info->GetNumberOfKeys()
+                << std::endl;
+      return false;
+    }
+
+    // Copies must hold the same keys and values.
+    vtkNew<vtkInformation> copy;
+    copy->Copy(info.GetPointer());
+    for (int k = 0; k < numKeys; ++k)
+    {
+      if (copy->Has(keys[k]) != info->Has(keys[k]) ||
+          copy->Get(keys[k]) != info->Get(keys[k]))
+      {
+        std::cerr << "Copy differs for key " << k << std::endl;
+        return false;
+      }
+    }
+  }
+  info->Clear();
+  return info->GetNumberOfKeys() == 0;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestInformationTable(int, char*[])
+{
+  if (!TestInlineChurn() || !TestKeyChurn())
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
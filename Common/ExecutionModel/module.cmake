@@ -5,6 +5,7 @@ vtk_module(vtkCommonExecutionModel
     vtkCommonMisc
   TEST_DEPENDS
     vtkTestingCore
+    vtkCommonSystem
     vtkFiltersCore
     vtkFiltersSources
     vtkIOCore
@@ -20,71 +20,304 @@
 
 #include "vtkAlgorithm.h"
 #include "vtkAlgorithmOutput.h"
+#include "vtkDataArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+
+#include <cstring>
+#include <list>
+#include <vector>
 
 vtkStandardNewMacro(vtkCachedStreamingDemandDrivenPipeline);
 
+//----------------------------------------------------------------------------
+// Helper functions for extents
+namespace {
+
+struct CacheExtent
+{
+  int Extent[6];
+};
+
+bool ExtentIsEmpty(const int extent[6])
+{
+  return (extent[0] > extent[1] ||
+          extent[2] > extent[3] ||
+          extent[4] > extent[5]);
+}
+
+bool ExtentContains(const int outer[6], const int inner[6])
+{
+  return (inner[0] >= outer[0] && inner[1] <= outer[1] &&
+          inner[2] >= outer[2] && inner[3] <= outer[3] &&
+          inner[4] >= outer[4] && inner[5] <= outer[5]);
+}
+
+// Compute the intersection of two extents, return false if empty
+bool ExtentIntersection(const int a[6], const int b[6], int c[6])
+{
+  for (int i = 0; i < 6; i += 2)
+  {
+    c[i] = (a[i] > b[i] ? a[i] : b[i]);
+    c[i+1] = (a[i+1] < b[i+1] ? a[i+1] : b[i+1]);
+  }
+  return !ExtentIsEmpty(c);
+}
+
+// Split the part of "extent" that is not in "hole" into at most six
+// extents, where "hole" must be contained within "extent"
+void SubtractExtent(const int extent[6], const int hole[6],
+                    std::vector<CacheExtent>& remainder)
+{
+  CacheExtent part;
+  memcpy(part.Extent, extent, sizeof(part.Extent));
+  for (int i = 0; i < 6; i += 2)
+  {
+    // the slab below the hole along this axis
+    if (part.Extent[i] < hole[i])
+    {
+      CacheExtent slab = part;
+      slab.Extent[i+1] = hole[i] - 1;
+      remainder.push_back(slab);
+    }
+    // the slab above the hole along this axis
+    if (part.Extent[i+1] > hole[i+1])
+    {
+      CacheExtent slab = part;
+      slab.Extent[i] = hole[i+1] + 1;
+      remainder.push_back(slab);
+    }
+    // the rest is restricted to the hole along this axis
+    part.Extent[i] = hole[i];
+    part.Extent[i+1] = hole[i+1];
+  }
+}
+
+// Copy a sub-extent between two arrays that hold different extents
+void CopyArrayExtent(vtkDataArray *src, const int srcExt[6],
+                     vtkDataArray *dst, const int dstExt[6],
+                     const int extent[6])
+{
+  vtkIdType nc = src->GetNumberOfComponents();
+  size_t rowSize = (extent[1] - extent[0] + 1)*nc*src->GetDataTypeSize();
+  vtkIdType srcIncY = srcExt[1] - srcExt[0] + 1;
+  vtkIdType srcIncZ = srcIncY*(srcExt[3] - srcExt[2] + 1);
+  vtkIdType dstIncY = dstExt[1] - dstExt[0] + 1;
+  vtkIdType dstIncZ = dstIncY*(dstExt[3] - dstExt[2] + 1);
+
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    for (int j = extent[2]; j <= extent[3]; j++)
+    {
+      vtkIdType srcId = (k - srcExt[4])*srcIncZ + (j - srcExt[2])*srcIncY +
+                        (extent[0] - srcExt[0]);
+      vtkIdType dstId = (k - dstExt[4])*dstIncZ + (j - dstExt[2])*dstIncY +
+                        (extent[0] - dstExt[0]);
+      memcpy(dst->GetVoidPointer(dstId*nc), src->GetVoidPointer(srcId*nc),
+             rowSize);
+    }
+  }
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+// The cached images, ordered from most recently used to least recently used
+class vtkCachedStreamingDemandDrivenPipelineInternals
+{
+public:
+  struct Entry
+  {
+    vtkSmartPointer<vtkImageData> Data;
+    int Extent[6];
+    vtkMTimeType Time;
+    bool HasTimeStep;
+    double TimeStep;
+    unsigned long Size;
+
+    bool MatchesTimeStep(bool hasTimeStep, double timeStep) const
+    {
+      return (this->HasTimeStep == hasTimeStep &&
+              (!hasTimeStep || this->TimeStep == timeStep));
+    }
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  // Assemble the scalars for the extent from the cached images, or return
+  // NULL if the cached images do not cover the extent.  The caller must
+  // delete the returned array.
+  vtkDataArray *Assemble(const int extent[6], bool hasTimeStep,
+                         double timeStep);
+
+  EntryList Entries;
+};
+
+//----------------------------------------------------------------------------
+vtkDataArray *vtkCachedStreamingDemandDrivenPipelineInternals::Assemble(
+  const int extent[6], bool hasTimeStep, double timeStep)
+{
+  // the parts of the extent that have not been found in the cache
+  std::vector<CacheExtent> uncovered(1);
+  memcpy(uncovered[0].Extent, extent, sizeof(uncovered[0].Extent));
+  std::vector<CacheExtent> remainder;
+
+  // the parts of the extent that will be copied from each cached image,
+  // where the most recently used images are searched first
+  std::vector<EntryList::iterator> sources;
+  std::vector<CacheExtent> pieces;
+  vtkDataArray *firstScalars = NULL;
+
+  for (EntryList::iterator it = this->Entries.begin();
+       it != this->Entries.end() && !uncovered.empty(); ++it)
+  {
+    vtkDataArray *scalars = it->Data->GetPointData()->GetScalars();
+    if (!it->MatchesTimeStep(hasTimeStep, timeStep) ||
+        scalars == NULL || scalars->GetDataType() == VTK_BIT)
+    {
+      continue;
+    }
+    if (firstScalars &&
+        (scalars->GetDataType() != firstScalars->GetDataType() ||
+         scalars->GetNumberOfComponents() !=
+           firstScalars->GetNumberOfComponents()))
+    {
+      continue;
+    }
+
+    remainder.clear();
+    for (size_t i = 0; i < uncovered.size(); i++)
+    {
+      CacheExtent piece;
+      if (ExtentIntersection(uncovered[i].Extent, it->Extent, piece.Extent))
+      {
+        firstScalars = (firstScalars ? firstScalars : scalars);
+        sources.push_back(it);
+        pieces.push_back(piece);
+        SubtractExtent(uncovered[i].Extent, piece.Extent, remainder);
+      }
+      else
+      {
+        remainder.push_back(uncovered[i]);
+      }
+    }
+    uncovered.swap(remainder);
+  }
+
+  if (!uncovered.empty() || firstScalars == NULL)
+  {
+    return NULL;
+  }
+
+  // copy the pieces into a new array
+  vtkDataArray *scalars = firstScalars->NewInstance();
+  scalars->SetName(firstScalars->GetName());
+  scalars->SetNumberOfComponents(firstScalars->GetNumberOfComponents());
+  scalars->SetNumberOfTuples(
+    static_cast<vtkIdType>(extent[1] - extent[0] + 1)*
+    (extent[3] - extent[2] + 1)*(extent[5] - extent[4] + 1));
+  for (size_t i = 0; i < pieces.size(); i++)
+  {
+    CopyArrayExtent(sources[i]->Data->GetPointData()->GetScalars(),
+                    sources[i]->Extent, scalars, extent, pieces[i].Extent);
+  }
+
+  // mark the cached images as used, keeping their relative order
+  for (size_t i = sources.size(); i > 0; --i)
+  {
+    this->Entries.splice(this->Entries.begin(), this->Entries, sources[i-1]);
+  }
+
+  return scalars;
+}
 
 //----------------------------------------------------------------------------
 vtkCachedStreamingDemandDrivenPipeline
 ::vtkCachedStreamingDemandDrivenPipeline()
 {
-  this->CacheSize = 0;
-  this->Data = NULL;
-  this->Times = NULL;
-
-  this->SetCacheSize(10);
+  this->CacheSize = 10;
+  this->CacheMemoryLimit = 0;
+  this->NumberOfCacheHits = 0;
+  this->NumberOfPartialCacheHits = 0;
+  this->NumberOfCacheMisses = 0;
+  this->NumberOfCacheEvictions = 0;
+  this->CacheInternal = new vtkCachedStreamingDemandDrivenPipelineInternals;
 }
 
 //----------------------------------------------------------------------------
 vtkCachedStreamingDemandDrivenPipeline
 ::~vtkCachedStreamingDemandDrivenPipeline()
 {
-  this->SetCacheSize(0);
+  delete this->CacheInternal;
 }
 
 //----------------------------------------------------------------------------
 void vtkCachedStreamingDemandDrivenPipeline::SetCacheSize(int size)
 {
-  int idx;
-
+  size = (size > 0 ? size : 0);
   if (size == this->CacheSize)
   {
     return;
   }
 
   this->Modified();
+  this->CacheSize = size;
+  this->PruneCache();
+}
 
-  // free the old data
-  for (idx = 0; idx < this->CacheSize; ++idx)
+//----------------------------------------------------------------------------
+void vtkCachedStreamingDemandDrivenPipeline::SetCacheMemoryLimit(
+  unsigned long limit)
+{
+  if (limit == this->CacheMemoryLimit)
   {
-    if (this->Data[idx])
-    {
-      this->Data[idx]->Delete();
-      this->Data[idx] = NULL;
-    }
+    return;
   }
-  delete [] this->Data;
-  this->Data = NULL;
-  delete [] this->Times;
-  this->Times = NULL;
 
-  this->CacheSize = size;
-  if (size == 0)
+  this->Modified();
+  this->CacheMemoryLimit = limit;
+  this->PruneCache();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkCachedStreamingDemandDrivenPipeline::GetCacheMemorySize()
+{
+  unsigned long size = 0;
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList::iterator it;
+  for (it = this->CacheInternal->Entries.begin();
+       it != this->CacheInternal->Entries.end(); ++it)
   {
-    return;
+    size += it->Size;
   }
+  return size;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedStreamingDemandDrivenPipeline::ResetCacheStatistics()
+{
+  this->NumberOfCacheHits = 0;
+  this->NumberOfPartialCacheHits = 0;
+  this->NumberOfCacheMisses = 0;
+  this->NumberOfCacheEvictions = 0;
+}
 
-  this->Data = new vtkDataObject* [size];
-  this->Times = new vtkMTimeType [size];
+//----------------------------------------------------------------------------
+void vtkCachedStreamingDemandDrivenPipeline::PruneCache()
+{
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList& entries =
+    this->CacheInternal->Entries;
+  unsigned long size = this->GetCacheMemorySize();
 
-  for (idx = 0; idx < size; ++idx)
+  while (!entries.empty() &&
+         (entries.size() > static_cast<size_t>(this->CacheSize) ||
+          (this->CacheMemoryLimit > 0 && size > this->CacheMemoryLimit)))
   {
-    this->Data[idx] = NULL;
-    this->Times[idx] = 0;
+    size -= entries.back().Size;
+    entries.pop_back();
+    this->NumberOfCacheEvictions++;
   }
 }
 
@@ -94,6 +327,13 @@ void vtkCachedStreamingDemandDrivenPipeline
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "CacheSize: " << this->CacheSize << "\n";
+  os << indent << "CacheMemoryLimit: " << this->CacheMemoryLimit << "\n";
+  os << indent << "NumberOfCacheHits: " << this->NumberOfCacheHits << "\n";
+  os << indent << "NumberOfPartialCacheHits: "
+     << this->NumberOfPartialCacheHits << "\n";
+  os << indent << "NumberOfCacheMisses: " << this->NumberOfCacheMisses << "\n";
+  os << indent << "NumberOfCacheEvictions: "
+     << this->NumberOfCacheEvictions << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -125,101 +365,81 @@ int vtkCachedStreamingDemandDrivenPipeline
   }
 
   // First look through the cached data to see if it is still valid.
-  int i;
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList& entries =
+    this->CacheInternal->Entries;
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList::iterator it;
   vtkMTimeType pmt = this->GetPipelineMTime();
-  for (i = 0; i < this->CacheSize; ++i)
+  for (it = entries.begin(); it != entries.end(); )
   {
-    if (this->Data[i] && this->Times[i] < pmt)
+    if (it->Time < pmt)
+    {
+      it = entries.erase(it);
+    }
+    else
     {
-      this->Data[i]->Delete();
-      this->Data[i] = NULL;
-      this->Times[i] = 0;
+      ++it;
     }
   }
 
   // We need to check the requested update extent.  Get the output
   // port information and data information.  We do not need to check
   // existence of values because it has already been verified by
-  // VerifyOutputInformation.
+  // VerifyOutputInformation.  Only structured extents are cached.
   vtkInformation* outInfo = outInfoVec->GetInformationObject(outputPort);
   vtkDataObject* dataObject = outInfo->Get(vtkDataObject::DATA_OBJECT());
   vtkInformation* dataInfo = dataObject->GetInformation();
-  if(dataInfo->Get(vtkDataObject::DATA_EXTENT_TYPE()) == VTK_PIECES_EXTENT)
+  vtkImageData *id = vtkImageData::SafeDownCast(dataObject);
+  if (id == NULL ||
+      dataInfo->Get(vtkDataObject::DATA_EXTENT_TYPE()) != VTK_3D_EXTENT)
   {
-    int updatePiece = outInfo->Get(UPDATE_PIECE_NUMBER());
-    int updateNumberOfPieces = outInfo->Get(UPDATE_NUMBER_OF_PIECES());
-    int updateGhostLevel = outInfo->Get(UPDATE_NUMBER_OF_GHOST_LEVELS());
+    return 1;
+  }
 
-    // check to see if any data in the cache fits this request
-    for (i = 0; i < this->CacheSize; ++i)
-    {
-      if (this->Data[i])
-      {
-        dataInfo = this->Data[i]->GetInformation();
-
-        // Check the unstructured extent.  If we do not have the requested
-        // piece, we need to execute.
-        int dataPiece = dataInfo->Get(vtkDataObject::DATA_PIECE_NUMBER());
-        int dataNumberOfPieces =
-          dataInfo->Get(vtkDataObject::DATA_NUMBER_OF_PIECES());
-        int dataGhostLevel =
-          dataInfo->Get(vtkDataObject::DATA_NUMBER_OF_GHOST_LEVELS());
-        if (dataInfo->Get(vtkDataObject::DATA_EXTENT_TYPE()) ==
-            VTK_PIECES_EXTENT && dataPiece == updatePiece &&
-            dataNumberOfPieces == updateNumberOfPieces &&
-            dataGhostLevel == updateGhostLevel)
-        {
-          // we have a matching data we must copy it to our output, but for
-          // now we don't support polydata
-          return 1;
-        }
-      }
-    }
+  int updateExtent[6];
+  outInfo->Get(UPDATE_EXTENT(), updateExtent);
+  if (ExtentIsEmpty(updateExtent))
+  {
+    return 1;
   }
-  else if (dataInfo->Get(vtkDataObject::DATA_EXTENT_TYPE()) == VTK_3D_EXTENT)
+
+  bool hasTimeStep = (outInfo->Has(UPDATE_TIME_STEP()) != 0);
+  double timeStep = (hasTimeStep ? outInfo->Get(UPDATE_TIME_STEP()) : 0.0);
+
+  // check to see if any data in the cache fits this request
+  for (it = entries.begin(); it != entries.end(); ++it)
   {
-    // Check the structured extent.  If the update extent is outside
-    // of the extent and not empty, we need to execute.
-    int dataExtent[6];
-    int updateExtent[6];
-    outInfo->Get(UPDATE_EXTENT(), updateExtent);
-
-    // check to see if any data in the cache fits this request
-    for (i = 0; i < this->CacheSize; ++i)
+    if (it->MatchesTimeStep(hasTimeStep, timeStep) &&
+        ExtentContains(it->Extent, updateExtent))
     {
-      if (this->Data[i])
-      {
-        dataInfo = this->Data[i]->GetInformation();
-        dataInfo->Get(vtkDataObject::DATA_EXTENT(), dataExtent);
-        if(dataInfo->Get(vtkDataObject::DATA_EXTENT_TYPE()) ==
-           VTK_3D_EXTENT &&
-           !(updateExtent[0] < dataExtent[0] ||
-             updateExtent[1] > dataExtent[1] ||
-             updateExtent[2] < dataExtent[2] ||
-             updateExtent[3] > dataExtent[3] ||
-             updateExtent[4] < dataExtent[4] ||
-             updateExtent[5] > dataExtent[5]) &&
-           (updateExtent[0] <= updateExtent[1] &&
-            updateExtent[2] <= updateExtent[3] &&
-            updateExtent[4] <= updateExtent[5]))
-        {
-          // we have a match
-          // Pass this data to output.
-          vtkImageData *id = vtkImageData::SafeDownCast(dataObject);
-          vtkImageData *id2 = vtkImageData::SafeDownCast(this->Data[i]);
-          if (id && id2)
-          {
-            id->SetExtent(dataExtent);
-            id->GetPointData()->PassData(id2->GetPointData());
-            // not sure if we need this
-            dataObject->DataHasBeenGenerated();
-            return 0;
-          }
-        }
-      }
+      // we have a match
+      // Pass this data to output.
+      id->SetExtent(it->Extent);
+      id->GetPointData()->PassData(it->Data->GetPointData());
+      // not sure if we need this
+      dataObject->DataHasBeenGenerated();
+      entries.splice(entries.begin(), entries, it);
+      this->NumberOfCacheHits++;
+      return 0;
     }
   }
 
+  // check to see if the request can be assembled from several cached images
+  vtkDataArray *scalars =
+    this->CacheInternal->Assemble(updateExtent, hasTimeStep, timeStep);
+  if (scalars)
+  {
+    vtkSmartPointer<vtkImageData> assembled =
+      vtkSmartPointer<vtkImageData>::New();
+    assembled->SetExtent(updateExtent);
+    assembled->GetPointData()->SetScalars(scalars);
+    scalars->Delete();
+    id->SetExtent(updateExtent);
+    id->GetPointData()->PassData(assembled->GetPointData());
+    dataObject->DataHasBeenGenerated();
+    this->NumberOfPartialCacheHits++;
+    return 0;
+  }
+
   // We do need to execute
   return 1;
 }
@@ -240,35 +460,10 @@ int vtkCachedStreamingDemandDrivenPipeline
 
   // first do the ususal thing
   int result = this->Superclass::ExecuteData(request, inInfoVec, outInfoVec);
-
-  // then save the newly generated data
-  vtkMTimeType bestTime = VTK_INT_MAX;
-  int bestIdx = 0;
-
-  // Save the image in cache.
-  // Find a spot to put the data.
-  for (int i = 0; i < this->CacheSize; ++i)
-  {
-    if (this->Data[i] == NULL)
-    {
-      bestIdx = i;
-      break;
-    }
-    if (this->Times[i] < bestTime)
-    {
-      bestIdx = i;
-      bestTime = this->Times[i];
-    }
-  }
+  this->NumberOfCacheMisses++;
 
   vtkInformation* outInfo = outInfoVec->GetInformationObject(0);
   vtkDataObject* dataObject = outInfo->Get(vtkDataObject::DATA_OBJECT());
-  if (this->Data[bestIdx] == NULL)
-  {
-    this->Data[bestIdx] = dataObject->NewInstance();
-  }
-  this->Data[bestIdx]->ReleaseData();
-
   vtkImageData *id = vtkImageData::SafeDownCast(dataObject);
   if (id)
   {
@@ -280,15 +475,43 @@ int vtkCachedStreamingDemandDrivenPipeline
     id->DataHasBeenGenerated();
   }
 
-  vtkImageData *id2 = vtkImageData::SafeDownCast(this->Data[bestIdx]);
-  if (id && id2)
+  // then save the newly generated data
+  vtkDataArray *scalars = (id ? id->GetPointData()->GetScalars() : NULL);
+  if (scalars == NULL || this->CacheSize == 0)
+  {
+    return result;
+  }
+
+  vtkCachedStreamingDemandDrivenPipelineInternals::Entry entry;
+  entry.Data = vtkSmartPointer<vtkImageData>::New();
+  entry.Data->SetExtent(id->GetExtent());
+  entry.Data->GetPointData()->SetScalars(scalars);
+  id->GetExtent(entry.Extent);
+  entry.Time = dataObject->GetUpdateTime();
+  entry.HasTimeStep = (outInfo->Has(UPDATE_TIME_STEP()) != 0);
+  entry.TimeStep = (entry.HasTimeStep ? outInfo->Get(UPDATE_TIME_STEP()) : 0.0);
+  entry.Size = scalars->GetActualMemorySize();
+
+  // discard cached images that are contained in the new image
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList& entries =
+    this->CacheInternal->Entries;
+  vtkCachedStreamingDemandDrivenPipelineInternals::EntryList::iterator it;
+  for (it = entries.begin(); it != entries.end(); )
   {
-    id2->SetExtent(id->GetExtent());
-    id2->GetPointData()->SetScalars(
-      id->GetPointData()->GetScalars());
+    if (it->MatchesTimeStep(entry.HasTimeStep, entry.TimeStep) &&
+        ExtentContains(entry.Extent, it->Extent))
+    {
+      it = entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
 
-  this->Times[bestIdx] = dataObject->GetUpdateTime();
+  // Save the image in cache as the most recently used image
+  entries.push_front(entry);
+  this->PruneCache();
 
   return result;
 }
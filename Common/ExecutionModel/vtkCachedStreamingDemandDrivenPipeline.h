@@ -14,8 +14,18 @@
 =========================================================================*/
 /**
  * @class   vtkCachedStreamingDemandDrivenPipeline
+ * @brief   Executive that keeps a cache of image data from previous updates
  *
- * vtkCachedStreamingDemandDrivenPipeline
+ * vtkCachedStreamingDemandDrivenPipeline keeps the image data generated by
+ * previous updates, and uses it to satisfy later requests without executing
+ * the algorithm.  Each cached image is keyed on its extent, the requested
+ * time step, and the time at which it was generated (it is discarded once
+ * the pipeline upstream is modified).  A request is satisfied either by a
+ * single cached image that contains the update extent, or by assembling the
+ * update extent from several cached images that cover it together.  When
+ * the number of cached images exceeds the CacheSize, or the memory used by
+ * the cache exceeds the CacheMemoryLimit, the least recently used images are
+ * discarded.  Only one-input, one-output image algorithms are supported.
 */
 
 #ifndef vtkCachedStreamingDemandDrivenPipeline_h
@@ -24,6 +34,7 @@
 #include "vtkCommonExecutionModelModule.h" // For export macro
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+class vtkCachedStreamingDemandDrivenPipelineInternals;
 class vtkInformationIntegerKey;
 class vtkInformationIntegerVectorKey;
 
@@ -45,6 +56,36 @@ public:
   vtkGetMacro(CacheSize, int);
   //@}
 
+  //@{
+  /**
+   * The maximum amount of memory, in kibibytes (1024 bytes), that can be
+   * used by the cached images.  The default is zero, which means that only
+   * the CacheSize limits the cache.
+   */
+  void SetCacheMemoryLimit(unsigned long limit);
+  vtkGetMacro(CacheMemoryLimit, unsigned long);
+  //@}
+
+  /**
+   * Get the memory, in kibibytes (1024 bytes), used by the cached images.
+   */
+  unsigned long GetCacheMemorySize();
+
+  //@{
+  /**
+   * Statistics for the cache.  A hit is a request that was satisfied by
+   * a single cached image, a partial hit is a request that was assembled
+   * from several cached images, and a miss is a request that required the
+   * algorithm to execute.  Evictions are the images that were discarded to
+   * keep the cache within its limits.
+   */
+  vtkGetMacro(NumberOfCacheHits, vtkIdType);
+  vtkGetMacro(NumberOfPartialCacheHits, vtkIdType);
+  vtkGetMacro(NumberOfCacheMisses, vtkIdType);
+  vtkGetMacro(NumberOfCacheEvictions, vtkIdType);
+  void ResetCacheStatistics();
+  //@}
+
 protected:
   vtkCachedStreamingDemandDrivenPipeline();
   ~vtkCachedStreamingDemandDrivenPipeline() VTK_OVERRIDE;
@@ -56,10 +97,21 @@ protected:
                           vtkInformationVector** inInfoVec,
                           vtkInformationVector* outInfoVec) VTK_OVERRIDE;
 
+  /**
+   * Discard the least recently used images until the cache is within
+   * its limits.
+   */
+  void PruneCache();
+
   int CacheSize;
+  unsigned long CacheMemoryLimit;
+
+  vtkIdType NumberOfCacheHits;
+  vtkIdType NumberOfPartialCacheHits;
+  vtkIdType NumberOfCacheMisses;
+  vtkIdType NumberOfCacheEvictions;
 
-  vtkDataObject **Data;
-  vtkMTimeType *Times;
+  vtkCachedStreamingDemandDrivenPipelineInternals *CacheInternal;
 
 private:
   vtkCachedStreamingDemandDrivenPipeline(const vtkCachedStreamingDemandDrivenPipeline&) VTK_DELETE_FUNCTION;
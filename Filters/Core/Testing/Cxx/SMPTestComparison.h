@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    SMPTestComparison.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Comparisons shared by the tests that check the threaded (EnableSMP)
+// execution of a filter against its serial execution. Each function prints
+// the first difference it finds to cerr.
+
+#ifndef SMPTestComparison_h
+#define SMPTestComparison_h
+
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetAttributes.h"
+
+#include <cmath>
+
+// Compare the type, size and values of two arrays. Values may differ by
+// tolerance relative to the values of b. Two missing arrays are the same.
+inline bool SameArrays(vtkDataArray *a, vtkDataArray *b, const char *name,
+                       double tolerance = 0.0)
+{
+  if (!a || !b)
+  {
+    if (a != b)
+    {
+      cerr << "Array " << name << " is missing in one of the outputs"
+           << endl;
+      return false;
+    }
+    return true;
+  }
+  if (a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+      a->GetDataType() != b->GetDataType())
+  {
+    cerr << "Array " << name << " differs in size or type" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a->GetNumberOfComponents(); ++c)
+    {
+      double va = a->GetComponent(i, c);
+      double vb = b->GetComponent(i, c);
+      if (fabs(va - vb) > tolerance * (1.0 + fabs(vb)))
+      {
+        cerr << "Array " << name << " differs at " << i << ": " << va
+             << " instead of " << vb << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Compare the arrays of two attributes by name, and the arrays that are set
+// as attributes (scalars, normals, ...).
+inline bool SameAttributes(vtkDataSetAttributes *a, vtkDataSetAttributes *b,
+                           double tolerance = 0.0)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    cerr << a->GetNumberOfArrays() << " arrays instead of "
+         << b->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int i = 0; i < b->GetNumberOfArrays(); ++i)
+  {
+    const char *name = b->GetArrayName(i);
+    vtkDataArray *arrayA = name ? a->GetArray(name) : a->GetArray(i);
+    if (!SameArrays(arrayA, b->GetArray(i), name ? name : "unnamed",
+                    tolerance))
+    {
+      return false;
+    }
+  }
+  for (int i = 0; i < vtkDataSetAttributes::NUM_ATTRIBUTES; ++i)
+  {
+    if ((a->GetAttribute(i) == NULL) != (b->GetAttribute(i) == NULL))
+    {
+      cerr << "Attribute " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compare the connectivity of two cell arrays.
+inline bool SameCells(vtkCellArray *a, vtkCellArray *b)
+{
+  if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      a->GetNumberOfConnectivityEntries() !=
+      b->GetNumberOfConnectivityEntries())
+  {
+    cerr << a->GetNumberOfCells() << " cells instead of "
+         << b->GetNumberOfCells() << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfConnectivityEntries(); ++i)
+  {
+    if (a->GetPointer()[i] != b->GetPointer()[i])
+    {
+      cerr << "Connectivity differs at " << i << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compare tuple idA of a with tuple idB of b.
+inline bool SameTuples(vtkDataArray *a, vtkIdType idA, vtkDataArray *b,
+                       vtkIdType idB)
+{
+  for (int c = 0; c < a->GetNumberOfComponents(); ++c)
+  {
+    if (a->GetComponent(idA, c) != b->GetComponent(idB, c))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,360 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellDataToPointDataSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkCellDataToPointData and
+// vtkPointDataToCellData.
+// .SECTION Description
+// Convert the point and cell attributes of image data, rectilinear grids,
+// structured grids (with and without blanking), polygonal data and
+// unstructured grids with and without EnableSMP. Both modes must produce
+// the same attributes, also for the arrays that vtkArrayDispatch does not
+// handle and with nearest neighbor interpolation.
+
+#include "vtkAppendFilter.h"
+#include "vtkBitArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellDataToPointData.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkInformationVector.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPointDataToCellData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSmartPointer.h"
+#include "vtkStringArray.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include "SMPTestComparison.h"
+
+// Interpolate the scalars from the nearest cell.
+class vtkNearestCellDataToPointData : public vtkCellDataToPointData
+{
+public:
+  static vtkNearestCellDataToPointData *New();
+  vtkTypeMacro(vtkNearestCellDataToPointData, vtkCellDataToPointData);
+
+protected:
+  int RequestData(vtkInformation *request, vtkInformationVector **inputVector,
+                  vtkInformationVector *outputVector) VTK_OVERRIDE
+  {
+    vtkDataSet::GetData(outputVector)->GetPointData()->SetCopyAttribute(
+      vtkDataSetAttributes::SCALARS, 2, vtkDataSetAttributes::INTERPOLATE);
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+  }
+};
+
+vtkStandardNewMacro(vtkNearestCellDataToPointData);
+
+namespace
+{
+
+// Fill the attributes with a float scalar, a double vector, an integer
+// label and unsigned char colors.
+void AddArrays(vtkDataSetAttributes *attributes, vtkIdType num,
+               bool labelScalars)
+{
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkIntArray> labels;
+  labels->SetName("Labels");
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetName("Colors");
+  colors->SetNumberOfComponents(3);
+  for (vtkIdType i = 0; i < num; ++i)
+  {
+    double t = static_cast<double>((i * 7919) % 1013) / 1013.0;
+    scalars->InsertNextValue(static_cast<float>(10.0 * t - 3.0));
+    vectors->InsertNextTuple3(t, 1.0 - 2.0 * t, t * t);
+    labels->InsertNextValue(static_cast<int>((i * 31) % 5) - 2);
+    colors->InsertNextTuple3((i * 13) % 256, (i * 101) % 256, 255 - i % 256);
+  }
+  if (labelScalars)
+  {
+    attributes->SetScalars(labels.GetPointer());
+    attributes->AddArray(scalars.GetPointer());
+  }
+  else
+  {
+    attributes->SetScalars(scalars.GetPointer());
+    attributes->AddArray(labels.GetPointer());
+  }
+  attributes->SetVectors(vectors.GetPointer());
+  attributes->AddArray(colors.GetPointer());
+}
+
+void AddArrays(vtkDataSet *ds, bool labelScalars)
+{
+  AddArrays(ds->GetPointData(), ds->GetNumberOfPoints(), labelScalars);
+  AddArrays(ds->GetCellData(), ds->GetNumberOfCells(), labelScalars);
+}
+
+vtkSmartPointer<vtkImageData> MakeImage(int nx, int ny, int nz)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(nx, ny, nz);
+  image->SetSpacing(0.5, 0.25, 1.0);
+  return image;
+}
+
+vtkSmartPointer<vtkRectilinearGrid> MakeRectilinearGrid(int n)
+{
+  vtkSmartPointer<vtkRectilinearGrid> grid =
+    vtkSmartPointer<vtkRectilinearGrid>::New();
+  grid->SetDimensions(n, n + 1, n + 2);
+  vtkNew<vtkDoubleArray> coords[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < n + i; ++j)
+    {
+      coords[i]->InsertNextValue(j * j * 0.1);
+    }
+  }
+  grid->SetXCoordinates(coords[0].GetPointer());
+  grid->SetYCoordinates(coords[1].GetPointer());
+  grid->SetZCoordinates(coords[2].GetPointer());
+  return grid;
+}
+
+vtkSmartPointer<vtkStructuredGrid> MakeStructuredGrid(int n, bool blank)
+{
+  vtkSmartPointer<vtkImageData> image = MakeImage(n, n + 2, n + 1);
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    image->GetPoint(i, x);
+    points->SetPoint(i, x[0] + 0.1 * x[1], x[1], x[2] + 0.05 * x[0]);
+  }
+  vtkSmartPointer<vtkStructuredGrid> grid =
+    vtkSmartPointer<vtkStructuredGrid>::New();
+  grid->SetDimensions(image->GetDimensions());
+  grid->SetPoints(points.GetPointer());
+  if (blank)
+  {
+    for (vtkIdType i = 0; i < grid->GetNumberOfCells(); i += 3)
+    {
+      grid->BlankCell(i);
+    }
+  }
+  return grid;
+}
+
+// A grid of quads, a polyline, a few vertices and one unused point.
+vtkSmartPointer<vtkPolyData> MakePolyData(int n)
+{
+  vtkNew<vtkPoints> points;
+  for (int j = 0; j < n; ++j)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      points->InsertNextPoint(i, j, 0.1 * ((i * j) % 3));
+    }
+  }
+  points->InsertNextPoint(-1.0, -1.0, -1.0);
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j < n - 1; ++j)
+  {
+    for (int i = 0; i < n - 1; ++i)
+    {
+      vtkIdType quad[4] = { j * n + i, j * n + i + 1, (j + 1) * n + i + 1,
+                            (j + 1) * n + i };
+      polys->InsertNextCell(4, quad);
+    }
+  }
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(n);
+  for (int i = 0; i < n; ++i)
+  {
+    lines->InsertCellPoint(i * n + i);
+  }
+  vtkNew<vtkCellArray> verts;
+  for (int i = 0; i < n; i += 4)
+  {
+    verts->InsertNextCell(1);
+    verts->InsertCellPoint(i);
+  }
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetVerts(verts.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+  polyData->SetPolys(polys.GetPointer());
+  return polyData;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> MakeUnstructuredGrid(vtkDataSet *input)
+{
+  vtkNew<vtkAppendFilter> append;
+  append->AddInputData(input);
+  append->Update();
+  return append->GetOutput();
+}
+
+bool SameStrings(vtkStringArray *a, vtkStringArray *b, const char *name)
+{
+  if (!a || !b || a->GetNumberOfValues() != b->GetNumberOfValues())
+  {
+    cerr << "Array " << name << " differs in size" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfValues(); ++i)
+  {
+    if (a->GetValue(i) != b->GetValue(i))
+    {
+      cerr << "Array " << name << " differs at " << i << ": "
+           << a->GetValue(i) << " instead of " << b->GetValue(i) << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+vtkSmartPointer<vtkDataSet> CellToPoint(vtkDataSet *input, bool pass,
+                                        bool smp)
+{
+  vtkNew<vtkCellDataToPointData> filter;
+  filter->SetInputData(input);
+  filter->SetPassCellData(pass);
+  filter->SetEnableSMP(smp);
+  filter->Update();
+  return filter->GetOutput();
+}
+
+vtkSmartPointer<vtkDataSet> PointToCell(vtkDataSet *input, bool pass,
+                                        bool categorical, bool smp)
+{
+  vtkNew<vtkPointDataToCellData> filter;
+  filter->SetInputData(input);
+  filter->SetPassPointData(pass);
+  filter->SetCategoricalData(categorical);
+  filter->SetEnableSMP(smp);
+  filter->Update();
+  return filter->GetOutput();
+}
+
+bool TestDataSet(vtkDataSet *input, const char *name)
+{
+  bool res = true;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    vtkSmartPointer<vtkDataSet> serial = CellToPoint(input, pass != 0, false);
+    vtkSmartPointer<vtkDataSet> threaded = CellToPoint(input, pass != 0, true);
+    if (!SameAttributes(threaded->GetPointData(), serial->GetPointData(), 1.0e-6) ||
+        !SameAttributes(threaded->GetCellData(), serial->GetCellData(), 1.0e-6))
+    {
+      cerr << "CellDataToPointData failed for " << name << endl;
+      res = false;
+    }
+    for (int categorical = 0; categorical < 2; ++categorical)
+    {
+      serial = PointToCell(input, pass != 0, categorical != 0, false);
+      threaded = PointToCell(input, pass != 0, categorical != 0, true);
+      if (!SameAttributes(threaded->GetPointData(), serial->GetPointData(), 1.0e-6) ||
+          !SameAttributes(threaded->GetCellData(), serial->GetCellData(), 1.0e-6))
+      {
+        cerr << "PointDataToCellData failed for " << name
+             << (categorical ? " (categorical)" : "") << endl;
+        res = false;
+      }
+    }
+  }
+  return res;
+}
+
+// Interpolate bit scalars, which depend on the order of the cells of a
+// point with nearest neighbor interpolation, and strings, which take the
+// value of the first cell of a point otherwise. vtkArrayDispatch handles
+// neither, so they take the vtkAbstractArray path of the threaded filter.
+bool TestUndispatchedArrays()
+{
+  vtkSmartPointer<vtkPolyData> input = MakePolyData(9);
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("Bits");
+  vtkNew<vtkStringArray> names;
+  names->SetName("Names");
+  for (vtkIdType i = 0; i < input->GetNumberOfCells(); ++i)
+  {
+    bits->InsertNextValue(static_cast<int>(i % 2));
+    vtkStdString name("cell");
+    name += static_cast<char>('a' + i % 26);
+    name += static_cast<char>('a' + i / 26);
+    names->InsertNextValue(name);
+  }
+  input->GetCellData()->SetScalars(bits.GetPointer());
+  input->GetCellData()->AddArray(names.GetPointer());
+
+  vtkSmartPointer<vtkDataSet> outputs[2];
+  for (int smp = 0; smp < 2; ++smp)
+  {
+    vtkNew<vtkNearestCellDataToPointData> filter;
+    filter->SetInputData(input);
+    filter->SetEnableSMP(smp != 0);
+    filter->Update();
+    outputs[smp] = filter->GetOutput();
+  }
+  vtkPointData *serial = outputs[0]->GetPointData();
+  vtkPointData *threaded = outputs[1]->GetPointData();
+  if (!SameArrays(threaded->GetArray("Bits"), serial->GetArray("Bits"),
+                  "Bits") ||
+      !SameStrings(
+        vtkArrayDownCast<vtkStringArray>(threaded->GetAbstractArray("Names")),
+        vtkArrayDownCast<vtkStringArray>(serial->GetAbstractArray("Names")),
+        "Names"))
+  {
+    cerr << "CellDataToPointData failed for undispatched arrays" << endl;
+    return false;
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestCellDataToPointDataSMP(int, char *[])
+{
+  bool res = true;
+  for (int labelScalars = 0; labelScalars < 2; ++labelScalars)
+  {
+    vtkSmartPointer<vtkDataSet> inputs[] = {
+      MakeImage(7, 6, 5), MakeImage(9, 8, 1), MakeImage(1, 1, 4),
+      MakeRectilinearGrid(5), MakeStructuredGrid(5, false),
+      MakeStructuredGrid(6, true), MakePolyData(9),
+      MakeUnstructuredGrid(MakeStructuredGrid(4, false)) };
+    const char *names[] = { "3D image", "2D image", "1D image",
+                            "rectilinear grid", "structured grid",
+                            "blanked structured grid", "polydata",
+                            "unstructured grid" };
+    for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(char *)); ++i)
+    {
+      AddArrays(inputs[i], labelScalars != 0);
+      res = TestDataSet(inputs[i], names[i]) && res;
+    }
+  }
+
+  res = TestUndispatchedArrays() && res;
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
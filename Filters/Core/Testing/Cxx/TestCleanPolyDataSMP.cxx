@@ -0,0 +1,253 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCleanPolyDataSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded point merging of vtkCleanPolyData.
+// .SECTION Description
+// Clean meshes with duplicate points with and without EnableSMP, for a zero
+// and a non-zero tolerance, and check that both modes produce the same
+// cells, points and point data. A finely sampled polyline checks that points
+// farther apart than the tolerance are not merged through a chain. Also check
+// the MergePoints modes of vtkAppendPolyData and vtkAppendFilter.
+
+#include "vtkAppendFilter.h"
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCleanPolyData.h"
+#include "vtkCubeSource.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkUnstructuredGrid.h"
+
+#include "SMPTestComparison.h"
+
+namespace
+{
+
+// An open sphere appended to a box whose faces do not share points, with a
+// polyline and vertices reusing some of the points. Points are moved by up
+// to jitter, and carry their id as point data.
+vtkSmartPointer<vtkPolyData> MakeMesh(int resolution, double jitter)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->SetEndTheta(300.0);
+  vtkNew<vtkCubeSource> cube;
+  cube->SetCenter(3.0, 0.0, 0.0);
+  vtkNew<vtkAppendPolyData> append;
+  append->AddInputConnection(cube->GetOutputPort());
+  append->AddInputConnection(sphere->GetOutputPort());
+  append->AddInputConnection(cube->GetOutputPort());
+  append->Update();
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->DeepCopy(append->GetOutput());
+  vtkIdType numPts = mesh->GetNumberOfPoints();
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("Ids");
+  ids->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    double x[3];
+    mesh->GetPoint(i, x);
+    x[0] += jitter * ((i * 37) % 11 - 5) / 5.0;
+    x[1] += jitter * ((i * 17) % 7 - 3) / 3.0;
+    mesh->GetPoints()->SetPoint(i, x);
+    ids->SetValue(i, i);
+  }
+  mesh->GetPointData()->AddArray(ids.GetPointer());
+
+  vtkNew<vtkCellArray> lines;
+  vtkIdType line[3] = { 0, numPts / 2, numPts - 1 };
+  lines->InsertNextCell(3, line);
+  mesh->SetLines(lines.GetPointer());
+  vtkNew<vtkCellArray> verts;
+  for (vtkIdType i = 0; i < numPts; i += 97)
+  {
+    verts->InsertNextCell(1, &i);
+  }
+  mesh->SetVerts(verts.GetPointer());
+  return mesh;
+}
+
+vtkSmartPointer<vtkPolyData> Clean(vtkPolyData *mesh, bool smp,
+                                   double tolerance)
+{
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputData(mesh);
+  clean->SetEnableSMP(smp);
+  clean->ToleranceIsAbsoluteOn();
+  clean->SetAbsoluteTolerance(tolerance);
+  clean->Update();
+  return clean->GetOutput();
+}
+
+bool SamePoints(vtkPolyData *a, vtkPolyData *b)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints())
+  {
+    return false;
+  }
+  vtkIdTypeArray *idsA = vtkIdTypeArray::SafeDownCast(
+    a->GetPointData()->GetArray("Ids"));
+  vtkIdTypeArray *idsB = vtkIdTypeArray::SafeDownCast(
+    b->GetPointData()->GetArray("Ids"));
+  if (!idsA || !idsB)
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+  {
+    double xA[3], xB[3];
+    a->GetPoint(i, xA);
+    b->GetPoint(i, xB);
+    if (xA[0] != xB[0] || xA[1] != xB[1] || xA[2] != xB[2] ||
+        idsA->GetValue(i) != idsB->GetValue(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestClean(double jitter, double tolerance)
+{
+  vtkSmartPointer<vtkPolyData> mesh = MakeMesh(16, jitter);
+  vtkSmartPointer<vtkPolyData> serial = Clean(mesh, false, tolerance);
+  vtkSmartPointer<vtkPolyData> threaded = Clean(mesh, true, tolerance);
+
+  if (threaded->GetNumberOfPoints() != serial->GetNumberOfPoints() ||
+      threaded->GetNumberOfPoints() >= mesh->GetNumberOfPoints())
+  {
+    cerr << "Tolerance " << tolerance << ": " << threaded->GetNumberOfPoints()
+         << " points instead of " << serial->GetNumberOfPoints() << endl;
+    return false;
+  }
+  if (!SameCells(serial->GetVerts(), threaded->GetVerts()) ||
+      !SameCells(serial->GetLines(), threaded->GetLines()) ||
+      !SameCells(serial->GetPolys(), threaded->GetPolys()))
+  {
+    cerr << "Tolerance " << tolerance << ": cells differ" << endl;
+    return false;
+  }
+
+  // Points are inserted in the same order in both modes, so each output
+  // point comes from the same input point.
+  if (!SamePoints(serial, threaded))
+  {
+    cerr << "Tolerance " << tolerance << ": points differ" << endl;
+    return false;
+  }
+  return true;
+}
+
+// A polyline sampled every 0.9 tolerance. Incremental insertion keeps every
+// other point; a transitive merge would collapse the line to a point.
+bool TestChain()
+{
+  const vtkIdType numPts = 101;
+  const double tolerance = 0.1;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("Ids");
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    points->InsertNextPoint(0.9 * tolerance * i, 0.0, 0.0);
+    ids->InsertNextValue(i);
+    lines->InsertCellPoint(i);
+  }
+  vtkNew<vtkPolyData> line;
+  line->SetPoints(points.GetPointer());
+  line->SetLines(lines.GetPointer());
+  line->GetPointData()->AddArray(ids.GetPointer());
+
+  vtkSmartPointer<vtkPolyData> serial =
+    Clean(line.GetPointer(), false, tolerance);
+  vtkSmartPointer<vtkPolyData> threaded =
+    Clean(line.GetPointer(), true, tolerance);
+  if (serial->GetNumberOfPoints() != (numPts + 1) / 2 ||
+      !SamePoints(serial, threaded) ||
+      !SameCells(serial->GetLines(), threaded->GetLines()))
+  {
+    cerr << "Polyline: " << threaded->GetNumberOfPoints()
+         << " points instead of " << serial->GetNumberOfPoints() << endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestAppend()
+{
+  // Two boxes whose 24 points merge into 8.
+  vtkNew<vtkCubeSource> cube;
+  vtkNew<vtkAppendPolyData> appendPolyData;
+  appendPolyData->AddInputConnection(cube->GetOutputPort());
+  appendPolyData->AddInputConnection(cube->GetOutputPort());
+  appendPolyData->MergePointsOn();
+  appendPolyData->Update();
+  vtkPolyData *polyData = appendPolyData->GetOutput();
+  if (polyData->GetNumberOfPoints() != 8 ||
+      polyData->GetNumberOfPolys() != 12 ||
+      polyData->GetPointData()->GetNormals()->GetNumberOfTuples() != 8)
+  {
+    cerr << "vtkAppendPolyData: wrong merged output" << endl;
+    return false;
+  }
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = polyData->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      if (pts[i] < 0 || pts[i] >= 8)
+      {
+        cerr << "vtkAppendPolyData: wrong point id " << pts[i] << endl;
+        return false;
+      }
+    }
+  }
+
+  vtkNew<vtkAppendFilter> appendFilter;
+  appendFilter->AddInputConnection(cube->GetOutputPort());
+  appendFilter->AddInputConnection(cube->GetOutputPort());
+  appendFilter->MergePointsOn();
+  appendFilter->Update();
+  if (appendFilter->GetOutput()->GetNumberOfPoints() != 8 ||
+      appendFilter->GetOutput()->GetNumberOfCells() != 12)
+  {
+    cerr << "vtkAppendFilter: wrong merged output" << endl;
+    return false;
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestCleanPolyDataSMP(int, char *[])
+{
+  bool res = TestClean(0.0, 0.0);
+  res = TestClean(1.e-5, 1.e-3) && res;
+  res = TestChain() && res;
+  res = TestAppend() && res;
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,366 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestConnectivityFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded labeling of vtkConnectivityFilter and
+// vtkPolyDataConnectivityFilter.
+// .SECTION Description
+// Extract the regions of a mesh made of many patches of quads, lines and
+// vertices with and without EnableSMP, in all the extraction modes, with
+// and without scalar connectivity. Both modes must find the same regions
+// and extract the same cells with the same points and attributes.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkConnectivityFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataConnectivityFilter.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include "SMPTestComparison.h"
+
+namespace
+{
+
+// A dim x dim grid of points holding quads with holes, which splits it in
+// many patches, vertices and lines between a few points, and an unused
+// point. Cells carry their index as cell data.
+vtkSmartPointer<vtkPolyData> MakeMesh(int dim)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  for (int j = 0; j < dim; ++j)
+  {
+    for (int i = 0; i < dim; ++i)
+    {
+      points->InsertNextPoint(i, j, 0.0);
+      scalars->InsertNextValue(((i * 13 + j * 7) % 10) / 10.0);
+    }
+  }
+  points->InsertNextPoint(-1.0, -1.0, 0.0);
+  scalars->InsertNextValue(0.5);
+
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j + 1 < dim; ++j)
+  {
+    for (int i = 0; i + 1 < dim; ++i)
+    {
+      vtkIdType p = j * dim + i;
+      if ((i * 31 + j * 17 + (i * j) % 3) % 4 != 0)
+      {
+        vtkIdType quad[4] = { p, p + 1, p + dim + 1, p + dim };
+        polys->InsertNextCell(4, quad);
+      }
+      else if ((i + j) % 3 == 0)
+      {
+        verts->InsertNextCell(1, &p);
+      }
+      else if ((i + 2 * j) % 5 == 0)
+      {
+        vtkIdType line[2] = { p, p + dim + 1 };
+        lines->InsertNextCell(2, line);
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(points.GetPointer());
+  mesh->SetVerts(verts.GetPointer());
+  mesh->SetLines(lines.GetPointer());
+  mesh->SetPolys(polys.GetPointer());
+  mesh->GetPointData()->SetScalars(scalars.GetPointer());
+
+  vtkNew<vtkIdTypeArray> cellIndex;
+  cellIndex->SetName("CellIndex");
+  cellIndex->SetNumberOfTuples(mesh->GetNumberOfCells());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); ++i)
+  {
+    cellIndex->SetValue(i, i);
+  }
+  mesh->GetCellData()->AddArray(cellIndex.GetPointer());
+  return mesh;
+}
+
+struct Mode
+{
+  int ExtractionMode;
+  bool ScalarConnectivity;
+  bool FullScalarConnectivity;
+};
+
+template <class TFilter>
+void Configure(TFilter *filter, const Mode &mode, bool smp)
+{
+  filter->SetEnableSMP(smp);
+  filter->SetExtractionMode(mode.ExtractionMode);
+  filter->SetScalarConnectivity(mode.ScalarConnectivity);
+  filter->SetScalarRange(0.25, 0.65);
+  filter->ColorRegionsOn();
+  filter->AddSeed(5);
+  filter->AddSeed(1234);
+  filter->AddSpecifiedRegion(1);
+  filter->AddSpecifiedRegion(7);
+  filter->AddSpecifiedRegion(100000);
+  filter->SetClosestPoint(20.3, 11.8, 0.0);
+}
+
+// Both outputs must hold the same cells in the same order, with the same
+// point coordinates and attributes. Point numbering may differ. The cell
+// region ids are compared only when all the cells are extracted, since the
+// serial vtkConnectivityFilter indexes them by input cell.
+bool SameOutputs(vtkDataSet *a, vtkDataSet *b, bool compareCellRegions)
+{
+  if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      a->GetNumberOfPoints() != b->GetNumberOfPoints())
+  {
+    cerr << a->GetNumberOfCells() << " cells and " << a->GetNumberOfPoints()
+         << " points instead of " << b->GetNumberOfCells() << " and "
+         << b->GetNumberOfPoints() << endl;
+    return false;
+  }
+  vtkDataArray *scalarsA = a->GetPointData()->GetArray("Scalars");
+  vtkDataArray *scalarsB = b->GetPointData()->GetArray("Scalars");
+  vtkDataArray *regionsA = a->GetPointData()->GetArray("RegionId");
+  vtkDataArray *regionsB = b->GetPointData()->GetArray("RegionId");
+  vtkDataArray *indexA = a->GetCellData()->GetArray("CellIndex");
+  vtkDataArray *indexB = b->GetCellData()->GetArray("CellIndex");
+  vtkDataArray *cellRegionsA = a->GetCellData()->GetArray("RegionId");
+  vtkDataArray *cellRegionsB = b->GetCellData()->GetArray("RegionId");
+  if (!scalarsA || !scalarsB || !regionsA || !regionsB || !indexA ||
+      !indexB)
+  {
+    cerr << "Missing attributes" << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> ptsA;
+  vtkNew<vtkIdList> ptsB;
+  for (vtkIdType cellId = 0; cellId < a->GetNumberOfCells(); ++cellId)
+  {
+    if (a->GetCellType(cellId) != b->GetCellType(cellId) ||
+        !SameTuples(indexA, cellId, indexB, cellId) ||
+        (compareCellRegions &&
+         (!cellRegionsA || !cellRegionsB ||
+          !SameTuples(cellRegionsA, cellId, cellRegionsB, cellId))))
+    {
+      cerr << "Cell " << cellId << " differs" << endl;
+      return false;
+    }
+    a->GetCellPoints(cellId, ptsA.GetPointer());
+    b->GetCellPoints(cellId, ptsB.GetPointer());
+    if (ptsA->GetNumberOfIds() != ptsB->GetNumberOfIds())
+    {
+      cerr << "Points of cell " << cellId << " differ" << endl;
+      return false;
+    }
+    for (vtkIdType i = 0; i < ptsA->GetNumberOfIds(); ++i)
+    {
+      vtkIdType idA = ptsA->GetId(i);
+      vtkIdType idB = ptsB->GetId(i);
+      double xA[3], xB[3];
+      a->GetPoint(idA, xA);
+      b->GetPoint(idB, xB);
+      if (xA[0] != xB[0] || xA[1] != xB[1] || xA[2] != xB[2] ||
+          !SameTuples(scalarsA, idA, scalarsB, idB) ||
+          !SameTuples(regionsA, idA, regionsB, idB))
+      {
+        cerr << "Point " << i << " of cell " << cellId << " differs" << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameRegionSizes(vtkIdTypeArray *a, vtkIdTypeArray *b)
+{
+  if (a->GetNumberOfTuples() != b->GetNumberOfTuples())
+  {
+    cerr << a->GetNumberOfTuples() << " regions instead of "
+         << b->GetNumberOfTuples() << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+  {
+    if (a->GetValue(i) != b->GetValue(i))
+    {
+      cerr << "Size of region " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestPolyData(vtkPolyData *mesh, const Mode &mode)
+{
+  vtkNew<vtkPolyDataConnectivityFilter> serial;
+  vtkNew<vtkPolyDataConnectivityFilter> threaded;
+  vtkPolyDataConnectivityFilter *filters[2] = { serial.GetPointer(),
+                                                threaded.GetPointer() };
+  for (int smp = 0; smp < 2; ++smp)
+  {
+    filters[smp]->SetInputData(mesh);
+    Configure(filters[smp], mode, smp != 0);
+    filters[smp]->SetFullScalarConnectivity(mode.FullScalarConnectivity);
+    filters[smp]->MarkVisitedPointIdsOn();
+    filters[smp]->Update();
+  }
+
+  vtkPolyData *outA = threaded->GetOutput();
+  vtkPolyData *outB = serial->GetOutput();
+  if (outB->GetNumberOfCells() == 0 ||
+      !SameRegionSizes(threaded->GetRegionSizes(), serial->GetRegionSizes()) ||
+      !SameOutputs(outA, outB, false))
+  {
+    return false;
+  }
+  if (outA->GetNumberOfVerts() != outB->GetNumberOfVerts() ||
+      outA->GetNumberOfLines() != outB->GetNumberOfLines() ||
+      outA->GetNumberOfPolys() != outB->GetNumberOfPolys())
+  {
+    cerr << "Cell arrays differ" << endl;
+    return false;
+  }
+
+  // The visited points are listed in order of first use.
+  vtkIdList *visitedA = threaded->GetVisitedPointIds();
+  vtkIdList *visitedB = serial->GetVisitedPointIds();
+  if (visitedA->GetNumberOfIds() != visitedB->GetNumberOfIds())
+  {
+    cerr << "Visited points differ" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < visitedA->GetNumberOfIds(); ++i)
+  {
+    double xA[3], xB[3];
+    outA->GetPoint(visitedA->GetId(i), xA);
+    outB->GetPoint(visitedB->GetId(i), xB);
+    if (xA[0] != xB[0] || xA[1] != xB[1])
+    {
+      cerr << "Visited point " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestDataSet(vtkDataSet *input, const Mode &mode)
+{
+  vtkNew<vtkConnectivityFilter> serial;
+  vtkNew<vtkConnectivityFilter> threaded;
+  vtkConnectivityFilter *filters[2] = { serial.GetPointer(),
+                                        threaded.GetPointer() };
+  for (int smp = 0; smp < 2; ++smp)
+  {
+    filters[smp]->SetInputData(input);
+    Configure(filters[smp], mode, smp != 0);
+    filters[smp]->Update();
+  }
+
+  if (threaded->GetNumberOfExtractedRegions() !=
+      serial->GetNumberOfExtractedRegions())
+  {
+    cerr << threaded->GetNumberOfExtractedRegions() << " regions instead of "
+         << serial->GetNumberOfExtractedRegions() << endl;
+    return false;
+  }
+  if (serial->GetOutput()->GetNumberOfCells() == 0 ||
+      !SameOutputs(threaded->GetOutput(), serial->GetOutput(),
+                   mode.ExtractionMode == VTK_EXTRACT_ALL_REGIONS))
+  {
+    return false;
+  }
+  if (mode.ExtractionMode != VTK_EXTRACT_SPECIFIED_REGIONS &&
+      mode.ExtractionMode != VTK_EXTRACT_LARGEST_REGION)
+  {
+    return true;
+  }
+
+  // The threaded filter labels each output cell with the region of its
+  // input cell, which the serial filter stores at the input cell id when
+  // all the regions are extracted.
+  vtkNew<vtkConnectivityFilter> all;
+  all->SetInputData(input);
+  Configure(all.GetPointer(), mode, false);
+  all->SetExtractionModeToAllRegions();
+  all->Update();
+  vtkDataSet *output = threaded->GetOutput();
+  vtkDataArray *index = output->GetCellData()->GetArray("CellIndex");
+  vtkDataArray *regions = output->GetCellData()->GetArray("RegionId");
+  vtkDataArray *expected =
+    all->GetOutput()->GetCellData()->GetArray("RegionId");
+  if (!regions || regions->GetNumberOfTuples() != output->GetNumberOfCells())
+  {
+    cerr << "The cell region ids are not given per output cell" << endl;
+    return false;
+  }
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+  {
+    vtkIdType inputId =
+      static_cast<vtkIdType>(index->GetComponent(cellId, 0));
+    if (regions->GetComponent(cellId, 0) !=
+        expected->GetComponent(inputId, 0))
+    {
+      cerr << "Region of output cell " << cellId << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestConnectivityFilterSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> mesh = MakeMesh(60);
+  vtkNew<vtkAppendFilter> append;
+  append->AddInputData(mesh);
+  append->Update();
+  vtkUnstructuredGrid *grid = append->GetOutput();
+
+  bool res = true;
+  for (int extractionMode = VTK_EXTRACT_POINT_SEEDED_REGIONS;
+       extractionMode <= VTK_EXTRACT_CLOSEST_POINT_REGION; ++extractionMode)
+  {
+    for (int scalarMode = 0; scalarMode < 3; ++scalarMode)
+    {
+      Mode mode = { extractionMode, scalarMode > 0, scalarMode > 1 };
+      if (!TestPolyData(mesh, mode))
+      {
+        cerr << "vtkPolyDataConnectivityFilter failed for extraction mode "
+             << extractionMode << ", scalar mode " << scalarMode << endl;
+        res = false;
+      }
+      if (scalarMode < 2 && !TestDataSet(grid, mode))
+      {
+        cerr << "vtkConnectivityFilter failed for extraction mode "
+             << extractionMode << ", scalar mode " << scalarMode << endl;
+        res = false;
+      }
+    }
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,304 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGlyph3DSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkGlyph3D and vtkTensorGlyph.
+// .SECTION Description
+// Glyph a cloud of points with and without EnableSMP for the scaling,
+// orientation, indexing and coloring modes of vtkGlyph3D and for the modes
+// of vtkTensorGlyph. Both modes must produce the same points, cells and
+// attributes. The instances generated by vtkGlyph3D must map the source
+// points to the glyphs.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkConeSource.h"
+#include "vtkDoubleArray.h"
+#include "vtkGlyph3D.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTensorGlyph.h"
+#include "vtkTransform.h"
+
+#include "SMPTestComparison.h"
+
+namespace
+{
+
+// Random points carrying scalars, vectors, normals, tensors and a field.
+vtkSmartPointer<vtkPolyData> MakeCloud(vtkIdType numPts)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> tensors;
+  tensors->SetName("Tensors");
+  tensors->SetNumberOfComponents(9);
+  vtkNew<vtkIntArray> field;
+  field->SetName("Field");
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    double r[9];
+    for (int j = 0; j < 9; ++j)
+    {
+      random->Next();
+      r[j] = random->GetValue();
+    }
+    points->InsertNextPoint(10.0 * r[0], 10.0 * r[1], 10.0 * r[2]);
+    // some points have no scale or a vector along x
+    scalars->InsertNextValue(i % 7 == 0 ? 0.0 : 2.0 * r[3] - 0.5);
+    if (i % 5 == 0)
+    {
+      vectors->InsertNextTuple3(r[4] - 0.5, 0.0, 0.0);
+    }
+    else
+    {
+      vectors->InsertNextTuple3(r[4] - 0.5, r[5] - 0.5, r[6] - 0.5);
+    }
+    normals->InsertNextTuple3(r[6], r[4], -r[5]);
+    double a = r[3], b = r[4] - 0.5, c = r[5] - 0.5;
+    tensors->InsertNextTuple9(1.0 + a, b, c, b, 0.5 - c, a * b, c, a * b,
+                              r[6] - 0.5);
+    field->InsertNextValue(static_cast<int>(i % 13));
+  }
+  vtkSmartPointer<vtkPolyData> cloud = vtkSmartPointer<vtkPolyData>::New();
+  cloud->SetPoints(points.GetPointer());
+  cloud->GetPointData()->SetScalars(scalars.GetPointer());
+  cloud->GetPointData()->SetVectors(vectors.GetPointer());
+  cloud->GetPointData()->SetNormals(normals.GetPointer());
+  cloud->GetPointData()->SetTensors(tensors.GetPointer());
+  cloud->GetPointData()->AddArray(field.GetPointer());
+  return cloud;
+}
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  return a->GetNumberOfPoints() > 0 &&
+    SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData(),
+               "Points", 1.0e-6) &&
+    SameCells(a->GetVerts(), b->GetVerts()) &&
+    SameCells(a->GetLines(), b->GetLines()) &&
+    SameCells(a->GetPolys(), b->GetPolys()) &&
+    SameCells(a->GetStrips(), b->GetStrips()) &&
+    SameAttributes(a->GetPointData(), b->GetPointData(), 1.0e-6) &&
+    SameAttributes(a->GetCellData(), b->GetCellData(), 1.0e-6);
+}
+
+struct GlyphMode
+{
+  const char *Name;
+  int ScaleMode;
+  int VectorMode;
+  int IndexMode;
+  int ColorMode;
+  bool Clamping;
+  bool Orient;
+  bool FillCellData;
+  bool GeneratePointIds;
+  bool SourceTransform;
+};
+
+const GlyphMode GlyphModes[] = {
+  { "default", VTK_SCALE_BY_SCALAR, VTK_USE_VECTOR, VTK_INDEXING_OFF,
+    VTK_COLOR_BY_SCALE, false, true, false, false, false },
+  { "vector scaling, cell data", VTK_SCALE_BY_VECTOR, VTK_USE_VECTOR,
+    VTK_INDEXING_OFF, VTK_COLOR_BY_VECTOR, false, true, true, true, false },
+  { "vector components, normals", VTK_SCALE_BY_VECTORCOMPONENTS,
+    VTK_USE_NORMAL, VTK_INDEXING_OFF, VTK_COLOR_BY_SCALAR, true, true, false,
+    false, true },
+  { "clamped, unoriented", VTK_SCALE_BY_SCALAR, VTK_USE_VECTOR,
+    VTK_INDEXING_OFF, VTK_COLOR_BY_SCALE, true, false, true, false, true },
+  { "no scaling, no rotation", VTK_DATA_SCALING_OFF,
+    VTK_VECTOR_ROTATION_OFF, VTK_INDEXING_OFF, VTK_COLOR_BY_SCALE, false,
+    true, false, true, false },
+  { "index by scalar", VTK_SCALE_BY_SCALAR, VTK_USE_VECTOR,
+    VTK_INDEXING_BY_SCALAR, VTK_COLOR_BY_SCALAR, true, true, false, true,
+    false },
+  { "index by vector", VTK_SCALE_BY_VECTOR, VTK_USE_VECTOR,
+    VTK_INDEXING_BY_VECTOR, VTK_COLOR_BY_VECTOR, false, true, false, false,
+    true }
+};
+
+vtkSmartPointer<vtkPolyData> Glyph(vtkPolyData *cloud, vtkPolyData **sources,
+                                   int numSources, const GlyphMode &mode,
+                                   bool smp, bool instances)
+{
+  vtkNew<vtkGlyph3D> glyph;
+  glyph->SetInputData(cloud);
+  for (int i = 0; i < numSources; ++i)
+  {
+    glyph->SetSourceData(i, sources[i]);
+  }
+  glyph->SetScaleMode(mode.ScaleMode);
+  glyph->SetVectorMode(mode.VectorMode);
+  glyph->SetIndexMode(mode.IndexMode);
+  glyph->SetColorMode(mode.ColorMode);
+  glyph->SetClamping(mode.Clamping);
+  glyph->SetRange(0.0, 1.0);
+  glyph->SetOrient(mode.Orient);
+  glyph->SetScaleFactor(0.5);
+  glyph->SetFillCellData(mode.FillCellData);
+  glyph->SetGeneratePointIds(mode.GeneratePointIds);
+  if (mode.SourceTransform)
+  {
+    vtkNew<vtkTransform> transform;
+    transform->RotateZ(30.0);
+    transform->Translate(0.5, 0.0, 0.0);
+    transform->Scale(1.0, 2.0, 1.0);
+    glyph->SetSourceTransform(transform.GetPointer());
+  }
+  glyph->SetEnableSMP(smp);
+  glyph->SetGenerateInstances(instances);
+  glyph->Update();
+  return glyph->GetOutput();
+}
+
+// Apply the instance transformations to the source points: the result must
+// be the points of the serial glyphs.
+bool CheckInstances(vtkPolyData *instances, vtkPolyData *glyphs,
+                    vtkPolyData **sources)
+{
+  vtkDataArray *transforms =
+    instances->GetPointData()->GetArray("GlyphTransform");
+  vtkDataArray *indices =
+    instances->GetPointData()->GetArray("GlyphSourceIndex");
+  if (!transforms || !indices || transforms->GetNumberOfComponents() != 16 ||
+      instances->GetNumberOfVerts() != instances->GetNumberOfPoints())
+  {
+    cerr << "Missing instance arrays" << endl;
+    return false;
+  }
+  vtkIdType glyphPtId = 0;
+  for (vtkIdType i = 0; i < instances->GetNumberOfPoints(); ++i)
+  {
+    double m[16];
+    transforms->GetTuple(i, m);
+    vtkPolyData *source = sources[static_cast<int>(indices->GetTuple1(i))];
+    for (vtkIdType j = 0; j < source->GetNumberOfPoints(); ++j, ++glyphPtId)
+    {
+      double p[3], x[3], expected[3];
+      source->GetPoint(j, p);
+      for (int k = 0; k < 3; ++k)
+      {
+        x[k] = m[4*k] * p[0] + m[4*k+1] * p[1] + m[4*k+2] * p[2] + m[4*k+3];
+      }
+      glyphs->GetPoint(glyphPtId, expected);
+      if (sqrt(vtkMath::Distance2BetweenPoints(x, expected)) > 1.0e-4)
+      {
+        cerr << "Instance " << i << " does not match its glyph" << endl;
+        return false;
+      }
+    }
+  }
+  if (glyphPtId != glyphs->GetNumberOfPoints())
+  {
+    cerr << "Instances and glyphs differ" << endl;
+    return false;
+  }
+  return true;
+}
+
+vtkSmartPointer<vtkPolyData> TensorGlyph(vtkPolyData *cloud,
+                                         vtkPolyData *source, int mode,
+                                         bool smp)
+{
+  vtkNew<vtkTensorGlyph> glyph;
+  glyph->SetInputData(cloud);
+  glyph->SetSourceData(source);
+  glyph->SetScaleFactor(0.3);
+  glyph->SetThreeGlyphs((mode & 1) != 0);
+  glyph->SetSymmetric((mode & 2) != 0);
+  glyph->SetExtractEigenvalues((mode & 4) == 0);
+  glyph->SetColorGlyphs((mode & 8) == 0);
+  glyph->SetColorMode((mode & 16) ? vtkTensorGlyph::COLOR_BY_EIGENVALUES :
+                      vtkTensorGlyph::COLOR_BY_SCALARS);
+  glyph->SetClampScaling((mode & 16) != 0);
+  glyph->SetMaxScaleFactor(0.2);
+  glyph->SetEnableSMP(smp);
+  glyph->Update();
+  return glyph->GetOutput();
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestGlyph3DSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> cloud = MakeCloud(500);
+
+  vtkNew<vtkPlaneSource> plane; // normals and texture coordinates
+  plane->SetResolution(2, 3);
+  plane->Update();
+  vtkNew<vtkConeSource> cone; // no normals
+  cone->Update();
+  vtkNew<vtkSphereSource> sphere;
+  sphere->Update();
+  vtkPolyData *sources[3] = { plane->GetOutput(), cone->GetOutput(),
+                              sphere->GetOutput() };
+
+  bool res = true;
+  int numModes = static_cast<int>(sizeof(GlyphModes) / sizeof(GlyphMode));
+  for (int i = 0; i < numModes; ++i)
+  {
+    const GlyphMode &mode = GlyphModes[i];
+    int numSources = mode.IndexMode == VTK_INDEXING_OFF ? 1 : 3;
+    vtkPolyData **modeSources = sources + (i % 2 && numSources == 1 ? 2 : 0);
+    vtkSmartPointer<vtkPolyData> serial =
+      Glyph(cloud, modeSources, numSources, mode, false, false);
+    vtkSmartPointer<vtkPolyData> threaded =
+      Glyph(cloud, modeSources, numSources, mode, true, false);
+    if (!SameOutputs(threaded, serial))
+    {
+      cerr << "Glyph3D failed in mode " << mode.Name << endl;
+      res = false;
+    }
+    vtkSmartPointer<vtkPolyData> instances =
+      Glyph(cloud, modeSources, numSources, mode, false, true);
+    if (!CheckInstances(instances, serial, modeSources))
+    {
+      cerr << "Glyph3D instances failed in mode " << mode.Name << endl;
+      res = false;
+    }
+  }
+
+  for (int mode = 0; mode < 32; ++mode)
+  {
+    vtkSmartPointer<vtkPolyData> serial =
+      TensorGlyph(cloud, sphere->GetOutput(), mode, false);
+    vtkSmartPointer<vtkPolyData> threaded =
+      TensorGlyph(cloud, sphere->GetOutput(), mode, true);
+    if (!SameOutputs(threaded, serial))
+    {
+      cerr << "TensorGlyph failed in mode " << mode << endl;
+      res = false;
+    }
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataNormalsSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkPolyDataNormals.
+// .SECTION Description
+// Check that vtkPolyDataNormals produces the same points, polygons and
+// normals with EnableSMP on as without, on meshes with sharp edges,
+// inconsistently ordered polygons, several components and a non-manifold
+// edge.
+
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCleanPolyData.h"
+#include "vtkCubeSource.h"
+#include "vtkDataArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTriangleFilter.h"
+
+#include "SMPTestComparison.h"
+
+namespace
+{
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  return SameCells(a->GetPolys(), b->GetPolys()) &&
+         SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData(),
+                    "Points") &&
+         SameArrays(a->GetPointData()->GetNormals(),
+                    b->GetPointData()->GetNormals(), "Point normals") &&
+         SameArrays(a->GetCellData()->GetNormals(),
+                    b->GetCellData()->GetNormals(), "Cell normals");
+}
+
+// A closed box with sharp edges and shared points, a sphere, and a fin
+// sharing an edge of the box. Every third polygon is reversed.
+vtkSmartPointer<vtkPolyData> MakeMesh(int resolution)
+{
+  vtkNew<vtkCubeSource> cube;
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputConnection(cube->GetOutputPort());
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputConnection(triangles->GetOutputPort());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetCenter(3.0, 0.0, 0.0);
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+
+  vtkNew<vtkAppendPolyData> append;
+  append->AddInputConnection(clean->GetOutputPort());
+  append->AddInputConnection(sphere->GetOutputPort());
+  append->Update();
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->DeepCopy(append->GetOutput());
+
+  // The fin uses the first edge of the first box triangle.
+  vtkIdType npts, *pts;
+  mesh->GetPolys()->InitTraversal();
+  mesh->GetPolys()->GetNextCell(npts, pts);
+  vtkIdType fin[3] = { pts[0], pts[1], 0 };
+  fin[2] = mesh->GetPoints()->InsertNextPoint(-2.0, -2.0, -2.0);
+  mesh->GetPolys()->InsertNextCell(3, fin);
+
+  mesh->BuildCells();
+  for (vtkIdType cellId = 0; cellId < mesh->GetNumberOfCells(); cellId += 3)
+  {
+    mesh->ReverseCell(cellId);
+  }
+  return mesh;
+}
+
+vtkSmartPointer<vtkPolyData> RunNormals(vtkPolyData *mesh, bool smp,
+                                        bool splitting, bool consistency,
+                                        bool flip, bool nonManifold)
+{
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(mesh);
+  normals->SetEnableSMP(smp);
+  normals->SetSplitting(splitting);
+  normals->SetConsistency(consistency);
+  normals->SetFlipNormals(flip);
+  normals->SetNonManifoldTraversal(nonManifold);
+  normals->ComputeCellNormalsOn();
+  normals->Update();
+  return normals->GetOutput();
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestPolyDataNormalsSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> mesh = MakeMesh(16);
+
+  bool res = true;
+  for (int mode = 0; mode < 16; ++mode)
+  {
+    bool splitting = (mode & 1) != 0;
+    bool consistency = (mode & 2) != 0;
+    bool flip = (mode & 4) != 0;
+    bool nonManifold = (mode & 8) != 0;
+    vtkSmartPointer<vtkPolyData> serial =
+      RunNormals(mesh, false, splitting, consistency, flip, nonManifold);
+    vtkSmartPointer<vtkPolyData> threaded =
+      RunNormals(mesh, true, splitting, consistency, flip, nonManifold);
+    if (!SameOutputs(serial, threaded))
+    {
+      cerr << "Outputs differ with splitting " << splitting
+           << ", consistency " << consistency << ", flip " << flip
+           << ", non-manifold traversal " << nonManifold << endl;
+      res = false;
+    }
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
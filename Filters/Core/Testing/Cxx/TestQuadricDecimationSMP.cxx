@@ -0,0 +1,158 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestQuadricDecimationSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkQuadricDecimation.
+// .SECTION Description
+// Decimate an open sphere carrying scalars with EnableSMP on, with and
+// without the attribute error metric and volume preservation. The target
+// reduction must be reached and the output must stay close to the sphere and
+// be reproducible.
+
+#include "vtkCellArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkQuadricDecimation.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+
+#include "SMPTestComparison.h"
+
+#include <algorithm>
+
+namespace
+{
+
+vtkSmartPointer<vtkPolyData> MakeMesh(int resolution)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->SetEndTheta(300.0);
+  sphere->Update();
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->DeepCopy(sphere->GetOutput());
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetNumberOfTuples(mesh->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    mesh->GetPoint(i, x);
+    scalars->SetValue(i, static_cast<float>(x[2]));
+  }
+  mesh->GetPointData()->SetScalars(scalars.GetPointer());
+  return mesh;
+}
+
+vtkSmartPointer<vtkPolyData> Decimate(vtkPolyData *mesh, bool smp,
+                                      bool attributes, bool volume,
+                                      double *reduction = NULL)
+{
+  vtkNew<vtkQuadricDecimation> decimate;
+  decimate->SetInputData(mesh);
+  decimate->SetEnableSMP(smp);
+  decimate->SetTargetReduction(0.75);
+  decimate->SetAttributeErrorMetric(attributes);
+  decimate->SetVolumePreservation(volume);
+  decimate->Update();
+  if (reduction)
+  {
+    *reduction = decimate->GetActualReduction();
+  }
+  return decimate->GetOutput();
+}
+
+// Largest distance of the points used by the triangles to the sphere.
+double SphereError(vtkPolyData *output)
+{
+  double error = 0.0;
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = output->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      double x[3];
+      output->GetPoint(pts[i], x);
+      error = std::max(error, fabs(vtkMath::Norm(x) - 0.5));
+    }
+  }
+  return error;
+}
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  return SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData(),
+                    "Points") &&
+         SameCells(a->GetPolys(), b->GetPolys());
+}
+
+bool TestDecimation(bool attributes, bool volume)
+{
+  vtkSmartPointer<vtkPolyData> mesh = MakeMesh(64);
+  double reduction;
+  vtkSmartPointer<vtkPolyData> serial =
+    Decimate(mesh, false, attributes, volume);
+  vtkSmartPointer<vtkPolyData> threaded =
+    Decimate(mesh, true, attributes, volume, &reduction);
+
+  if (reduction < 0.75 ||
+      threaded->GetNumberOfPolys() > mesh->GetNumberOfPolys() / 4 + 1)
+  {
+    cerr << "Reduction of " << reduction << " with "
+         << threaded->GetNumberOfPolys() << " triangles left" << endl;
+    return false;
+  }
+
+  double serialError = SphereError(serial);
+  double threadedError = SphereError(threaded);
+  if (threadedError > 2.0 * serialError + 1.e-3)
+  {
+    cerr << "Error of " << threadedError << " instead of " << serialError
+         << endl;
+    return false;
+  }
+
+  if (!SameOutputs(threaded, Decimate(mesh, true, attributes, volume)))
+  {
+    cerr << "The threaded decimation is not reproducible" << endl;
+    return false;
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestQuadricDecimationSMP(int, char *[])
+{
+  bool res = true;
+  for (int mode = 0; mode < 4; ++mode)
+  {
+    bool attributes = (mode & 1) != 0;
+    bool volume = (mode & 2) != 0;
+    if (!TestDecimation(attributes, volume))
+    {
+      cerr << "Failed with attribute error metric " << attributes
+           << ", volume preservation " << volume << endl;
+      res = false;
+    }
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
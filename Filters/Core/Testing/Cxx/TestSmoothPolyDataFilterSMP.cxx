@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSmoothPolyDataFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded smoothing iterations of vtkSmoothPolyDataFilter.
+// .SECTION Description
+// Smooth a noisy mesh with boundaries, sharp edges and a polyline with and
+// without EnableSMP. Points must end up close to the serial result and fixed
+// points must not move.
+
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCleanPolyData.h"
+#include "vtkCubeSource.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSmoothPolyDataFilter.h"
+#include "vtkSphereSource.h"
+#include "vtkTriangleFilter.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// A noisy open sphere, a box with sharp edges, and a polyline whose end
+// points are fixed.
+vtkSmartPointer<vtkPolyData> MakeMesh(int resolution, int pointType)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->SetEndTheta(300.0);
+  vtkNew<vtkCubeSource> cube;
+  cube->SetCenter(3.0, 0.0, 0.0);
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputConnection(cube->GetOutputPort());
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputConnection(triangles->GetOutputPort());
+  vtkNew<vtkAppendPolyData> append;
+  append->AddInputConnection(sphere->GetOutputPort());
+  append->AddInputConnection(clean->GetOutputPort());
+  append->Update();
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->DeepCopy(append->GetOutput());
+  vtkNew<vtkPoints> points;
+  points->SetDataType(pointType);
+  points->SetNumberOfPoints(mesh->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    mesh->GetPoint(i, x);
+    x[0] += 0.002 * ((i * 37) % 11 - 5);
+    x[1] += 0.002 * ((i * 17) % 7 - 3);
+    points->SetPoint(i, x);
+  }
+  mesh->SetPoints(points.GetPointer());
+
+  vtkNew<vtkCellArray> lines;
+  vtkIdType line[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    line[i] = points->InsertNextPoint(-2.0 + i, 2.0 + 0.1 * (i % 2), 0.0);
+  }
+  lines->InsertNextCell(4, line);
+  mesh->SetLines(lines.GetPointer());
+  return mesh;
+}
+
+vtkSmartPointer<vtkPolyData> Smooth(vtkPolyData *mesh, bool smp,
+                                    bool featureEdges)
+{
+  vtkNew<vtkSmoothPolyDataFilter> smooth;
+  smooth->SetInputData(mesh);
+  smooth->SetEnableSMP(smp);
+  smooth->SetFeatureEdgeSmoothing(featureEdges);
+  smooth->SetNumberOfIterations(50);
+  smooth->SetRelaxationFactor(0.1);
+  smooth->Update();
+  return smooth->GetOutput();
+}
+
+bool TestSmoothing(int pointType)
+{
+  vtkSmartPointer<vtkPolyData> mesh = MakeMesh(32, pointType);
+  vtkIdType lineEnd = mesh->GetNumberOfPoints() - 1;
+
+  for (int featureEdges = 0; featureEdges < 2; ++featureEdges)
+  {
+    vtkSmartPointer<vtkPolyData> serial = Smooth(mesh, false, featureEdges);
+    vtkSmartPointer<vtkPolyData> threaded = Smooth(mesh, true, featureEdges);
+    if (threaded->GetPoints()->GetDataType() != pointType)
+    {
+      cerr << "Wrong output point type" << endl;
+      return false;
+    }
+
+    // Both iterations converge to the same surface: the difference must be
+    // small compared to the motion of the points.
+    double maxMotion = 0.0, maxDifference = 0.0;
+    for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); ++i)
+    {
+      double x[3], xSerial[3], xThreaded[3];
+      mesh->GetPoint(i, x);
+      serial->GetPoint(i, xSerial);
+      threaded->GetPoint(i, xThreaded);
+      maxMotion = std::max(maxMotion,
+        sqrt(vtkMath::Distance2BetweenPoints(x, xSerial)));
+      maxDifference = std::max(maxDifference,
+        sqrt(vtkMath::Distance2BetweenPoints(xSerial, xThreaded)));
+    }
+    if (maxMotion == 0.0 || maxDifference > 0.1 * maxMotion)
+    {
+      cerr << "Threaded smoothing differs by " << maxDifference
+           << " for a motion of " << maxMotion << endl;
+      return false;
+    }
+
+    // The end points of the polyline are fixed.
+    double x[3], xThreaded[3];
+    mesh->GetPoint(lineEnd, x);
+    threaded->GetPoint(lineEnd, xThreaded);
+    if (vtkMath::Distance2BetweenPoints(x, xThreaded) != 0.0)
+    {
+      cerr << "A fixed point moved" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestSmoothPolyDataFilterSMP(int, char *[])
+{
+  bool res = TestSmoothing(VTK_FLOAT);
+  res = TestSmoothing(VTK_DOUBLE) && res;
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,253 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThresholdSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkThreshold.
+// .SECTION Description
+// Threshold an image and an unstructured grid holding a polyhedron and an
+// empty cell with and without EnableSMP, on point and cell scalars, for all
+// component modes and with AllScalars and UseContinuousCellRange. Both modes
+// must extract the same cells with the same points and attributes.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkThreshold.h"
+#include "vtkUnstructuredGrid.h"
+
+#include "SMPTestComparison.h"
+
+namespace
+{
+
+// An image whose points carry 3-component scalars and whose cells carry
+// 1-component scalars.
+vtkSmartPointer<vtkImageData> MakeImage(int dim)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dim, dim + 1, dim + 2);
+  image->SetSpacing(1.0 / dim, 1.0 / dim, 1.0 / dim);
+
+  vtkNew<vtkDoubleArray> pointScalars;
+  pointScalars->SetName("PointScalars");
+  pointScalars->SetNumberOfComponents(3);
+  pointScalars->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    image->GetPoint(i, x);
+    pointScalars->SetTuple3(i, x[0], x[1] * x[2], 1.0 - x[2]);
+  }
+  image->GetPointData()->AddArray(pointScalars.GetPointer());
+
+  vtkNew<vtkDoubleArray> cellScalars;
+  cellScalars->SetName("CellScalars");
+  cellScalars->SetNumberOfTuples(image->GetNumberOfCells());
+  for (vtkIdType i = 0; i < image->GetNumberOfCells(); ++i)
+  {
+    cellScalars->SetValue(i, static_cast<double>((i * 7) % 11) / 10.0);
+  }
+  image->GetCellData()->AddArray(cellScalars.GetPointer());
+  return image;
+}
+
+// The image as an unstructured grid, followed by a cube polyhedron and an
+// empty cell.
+vtkSmartPointer<vtkUnstructuredGrid> MakeGrid(vtkImageData *image)
+{
+  vtkNew<vtkAppendFilter> append;
+  append->AddInputData(image);
+  append->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->DeepCopy(append->GetOutput());
+
+  vtkDoubleArray *pointScalars = vtkDoubleArray::SafeDownCast(
+    grid->GetPointData()->GetArray("PointScalars"));
+  vtkIdType cubePts[8];
+  for (int i = 0; i < 8; ++i)
+  {
+    cubePts[i] = grid->GetPoints()->InsertNextPoint(
+      2.0 + (i & 1), 2.0 + ((i >> 1) & 1), 2.0 + ((i >> 2) & 1));
+    pointScalars->InsertNextTuple3(0.5, 0.5, 0.5);
+  }
+  vtkIdType faces[30] = {
+    4, cubePts[0], cubePts[2], cubePts[3], cubePts[1],
+    4, cubePts[4], cubePts[5], cubePts[7], cubePts[6],
+    4, cubePts[0], cubePts[1], cubePts[5], cubePts[4],
+    4, cubePts[2], cubePts[6], cubePts[7], cubePts[3],
+    4, cubePts[0], cubePts[4], cubePts[6], cubePts[2],
+    4, cubePts[1], cubePts[3], cubePts[7], cubePts[5] };
+  grid->InsertNextCell(VTK_POLYHEDRON, 8, cubePts, 6, faces);
+  grid->InsertNextCell(VTK_EMPTY_CELL, 0, cubePts);
+
+  vtkDoubleArray *cellScalars = vtkDoubleArray::SafeDownCast(
+    grid->GetCellData()->GetArray("CellScalars"));
+  cellScalars->InsertNextValue(0.5);
+  cellScalars->InsertNextValue(0.5);
+  return grid;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> Threshold(vtkDataSet *input, bool smp,
+                                               bool cellScalars,
+                                               int componentMode,
+                                               bool allScalars,
+                                               bool continuousRange)
+{
+  vtkNew<vtkThreshold> threshold;
+  threshold->SetInputData(input);
+  threshold->SetEnableSMP(smp);
+  if (cellScalars)
+  {
+    threshold->SetInputArrayToProcess(
+      0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_CELLS, "CellScalars");
+  }
+  else
+  {
+    threshold->SetInputArrayToProcess(
+      0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "PointScalars");
+  }
+  threshold->SetComponentMode(componentMode);
+  threshold->SetSelectedComponent(1);
+  threshold->SetAllScalars(allScalars);
+  threshold->SetUseContinuousCellRange(continuousRange);
+  threshold->ThresholdBetween(0.3, 0.6);
+  threshold->Update();
+  return threshold->GetOutput();
+}
+
+// Both outputs must hold the same cells in the same order, with the same
+// point coordinates and attributes. Point numbering may differ.
+bool SameOutputs(vtkUnstructuredGrid *a, vtkUnstructuredGrid *b)
+{
+  if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      a->GetNumberOfPoints() != b->GetNumberOfPoints())
+  {
+    cerr << a->GetNumberOfCells() << " cells and " << a->GetNumberOfPoints()
+         << " points instead of " << b->GetNumberOfCells() << " and "
+         << b->GetNumberOfPoints() << endl;
+    return false;
+  }
+  vtkDataArray *pdA = a->GetPointData()->GetArray("PointScalars");
+  vtkDataArray *pdB = b->GetPointData()->GetArray("PointScalars");
+  vtkDataArray *cdA = a->GetCellData()->GetArray("CellScalars");
+  vtkDataArray *cdB = b->GetCellData()->GetArray("CellScalars");
+  if (!pdA || !pdB || !cdA || !cdB)
+  {
+    cerr << "Missing attributes" << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> ptsA;
+  vtkNew<vtkIdList> ptsB;
+  for (vtkIdType cellId = 0; cellId < a->GetNumberOfCells(); ++cellId)
+  {
+    if (a->GetCellType(cellId) != b->GetCellType(cellId) ||
+        !SameTuples(cdA, cellId, cdB, cellId))
+    {
+      cerr << "Cell " << cellId << " differs" << endl;
+      return false;
+    }
+    // The face stream of polyhedra holds the point ids of their faces.
+    a->GetFaceStream(cellId, ptsA.GetPointer());
+    b->GetFaceStream(cellId, ptsB.GetPointer());
+    bool polyhedron = a->GetCellType(cellId) == VTK_POLYHEDRON;
+    if (ptsA->GetNumberOfIds() != ptsB->GetNumberOfIds())
+    {
+      cerr << "Points of cell " << cellId << " differ" << endl;
+      return false;
+    }
+    vtkIdType nextCount = polyhedron ? 1 : ptsA->GetNumberOfIds();
+    for (vtkIdType i = polyhedron ? 1 : 0; i < ptsA->GetNumberOfIds(); ++i)
+    {
+      vtkIdType idA = ptsA->GetId(i);
+      vtkIdType idB = ptsB->GetId(i);
+      if (i == nextCount)
+      {
+        // number of points of the next face
+        if (idA != idB)
+        {
+          cerr << "Faces of cell " << cellId << " differ" << endl;
+          return false;
+        }
+        nextCount += idA + 1;
+        continue;
+      }
+      if (!SameTuples(a->GetPoints()->GetData(), idA,
+                      b->GetPoints()->GetData(), idB) ||
+          !SameTuples(pdA, idA, pdB, idB))
+      {
+        cerr << "Point " << i << " of cell " << cellId << " differs" << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestThreshold(vtkDataSet *input)
+{
+  bool res = true;
+  for (int mode = 0; mode < 24; ++mode)
+  {
+    bool cellScalars = (mode & 1) != 0;
+    bool allScalars = (mode & 2) != 0;
+    bool continuousRange = (mode & 4) != 0;
+    int componentMode = mode / 8;
+    vtkSmartPointer<vtkUnstructuredGrid> serial = Threshold(
+      input, false, cellScalars, componentMode, allScalars, continuousRange);
+    vtkSmartPointer<vtkUnstructuredGrid> threaded = Threshold(
+      input, true, cellScalars, componentMode, allScalars, continuousRange);
+    if (serial->GetNumberOfCells() == 0 || !SameOutputs(threaded, serial))
+    {
+      cerr << "Failed for " << input->GetClassName() << " with cell scalars "
+           << cellScalars << ", component mode " << componentMode
+           << ", all scalars " << allScalars << ", continuous cell range "
+           << continuousRange << endl;
+      res = false;
+    }
+  }
+  return res;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestThresholdSMP(int, char *[])
+{
+  vtkSmartPointer<vtkImageData> image = MakeImage(12);
+  vtkSmartPointer<vtkUnstructuredGrid> grid = MakeGrid(image);
+
+  bool res = TestThreshold(image);
+  res = TestThreshold(grid) && res;
+
+  // The polyhedron must be extracted with its faces.
+  vtkSmartPointer<vtkUnstructuredGrid> output = Threshold(
+    grid, true, true, VTK_COMPONENT_MODE_USE_SELECTED, true, false);
+  vtkIdType last = output->GetNumberOfCells() - 1;
+  if (last < 0 || output->GetCellType(last) != VTK_POLYHEDRON ||
+      !output->GetFaces())
+  {
+    cerr << "The polyhedron was not extracted" << endl;
+    res = false;
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,19 +14,19 @@
 =========================================================================*/
 #include "vtkAppendFilter.h"
 
-#include "vtkBoundingBox.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkDataSetCollection.h"
 #include "vtkExecutive.h"
-#include "vtkIncrementalOctreePointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPolyData.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticPointLocator.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
@@ -215,27 +215,46 @@ int vtkAppendFilter::RequestData(
 
   // For optionally merging duplicate points
   vtkIdType* globalIndices = new vtkIdType[totalNumPts];
-  vtkSmartPointer<vtkIncrementalOctreePointLocator> ptInserter;
   if (reallyMergePoints)
   {
-    vtkBoundingBox outputBB;
-
+    // Gather all the points and merge the coincident ones. Each point maps
+    // to the smallest id among the points coincident with it, so numbering
+    // the kept points in increasing order numbers them in order of first
+    // appearance.
+    vtkNew<vtkPoints> allPts;
+    allPts->SetDataTypeToDouble();
+    allPts->SetNumberOfPoints(totalNumPts);
+    vtkIdType offset = 0;
     for (int inputIndex = 0; inputIndex < numInputs; ++inputIndex)
     {
       vtkDataSet* dataSet = inputs->GetItem(inputIndex);
-
-      // Union of bounding boxes
-      double localBox[6];
-      dataSet->GetBounds(localBox);
-      outputBB.AddBounds(localBox);
+      vtkIdType dataSetNumPts = dataSet->GetNumberOfPoints();
+      for (vtkIdType ptId = 0; ptId < dataSetNumPts; ++ptId)
+      {
+        allPts->SetPoint(ptId + offset, dataSet->GetPoint(ptId));
+      }
+      offset += dataSetNumPts;
     }
 
-    double outputBounds[6];
-    outputBB.GetBounds(outputBounds);
+    vtkNew<vtkPolyData> cloud;
+    cloud->SetPoints(allPts.GetPointer());
+    vtkNew<vtkStaticPointLocator> locator;
+    locator->SetDataSet(cloud.GetPointer());
+    locator->MergePoints(0.0, globalIndices);
 
-    ptInserter = vtkSmartPointer<vtkIncrementalOctreePointLocator>::New();
-    ptInserter->SetTolerance(0.0);
-    ptInserter->InitPointInsertion(newPts, outputBounds);
+    vtkIdType numMergedPts = 0;
+    for (vtkIdType ptId = 0; ptId < totalNumPts; ++ptId)
+    {
+      if (globalIndices[ptId] == ptId)
+      {
+        globalIndices[ptId] = numMergedPts++;
+        newPts->InsertNextPoint(allPts->GetPoint(ptId));
+      }
+      else
+      {
+        globalIndices[ptId] = globalIndices[globalIndices[ptId]];
+      }
+    }
   }
 
   // append the blocks / pieces in terms of the geoemetry and topology
@@ -251,14 +270,7 @@ int vtkAppendFilter::RequestData(
     // copy points
     for (vtkIdType ptId = 0; ptId < dataSetNumPts && !abort; ++ptId)
     {
-      if (reallyMergePoints)
-      {
-        vtkIdType globalPtId = 0;
-        ptInserter->InsertUniquePoint(dataSet->GetPoint(ptId), globalPtId);
-        globalIndices[ptId + ptOffset] = globalPtId;
-        // The point inserter puts the point into newPts, so we don't have to do that here.
-      }
-      else
+      if (!reallyMergePoints)
       {
         globalIndices[ptId + ptOffset] = ptId + ptOffset;
         newPts->SetPoint(ptId + ptOffset, dataSet->GetPoint(ptId));
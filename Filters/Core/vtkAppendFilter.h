@@ -53,9 +53,9 @@ public:
 
   //@{
   /**
-   * Get if the filter should merge coincidental points
-   * Note: The filter will only merge points if the ghost cell array doesn't exist
-   * Defaults to Off
+   * Get if the filter should merge coincidental points.
+   * Note: The filter will only merge points if the ghost cell array doesn't exist.
+   * Defaults to Off.
    */
   vtkGetMacro(MergePoints,int);
   //@}
@@ -63,8 +63,10 @@ public:
   //@{
   /**
    * Set the filter to merge coincidental points.
-   * Note: The filter will only merge points if the ghost cell array doesn't exist
-   * Defaults to Off
+   * Note: The filter will only merge points if the ghost cell array doesn't exist.
+   * The points are merged in parallel with vtkStaticPointLocator::MergePoints()
+   * and keep their order of first appearance.
+   * Defaults to Off.
    */
   vtkSetMacro(MergePoints,int);
   //@}
@@ -25,12 +25,15 @@
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkIdList.h"
 #include "vtkPolyData.h"
+#include "vtkStaticPointLocator.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTrivialProducer.h"
 
 #include <cassert>
 #include <cstdlib>
+#include <vector>
 
 vtkStandardNewMacro(vtkAppendPolyData);
 
@@ -40,6 +43,7 @@ vtkAppendPolyData::vtkAppendPolyData()
   this->ParallelStreaming = 0;
   this->UserManagedInputs = 0;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->MergePoints = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -566,6 +570,11 @@ int vtkAppendPolyData::ExecuteAppend(vtkPolyData* output,
   }
   newStrips->Delete();
 
+  if (this->MergePoints)
+  {
+    this->MergeCoincidentPoints(output);
+  }
+
   // When all optimizations are complete, this squeeze will be unnecessary.
   // (But it does not seem to cost much.)
   output->Squeeze();
@@ -688,6 +697,91 @@ void vtkAppendPolyData::PrintSelf(ostream& os, vtkIndent indent)
   os << "UserManagedInputs:" << (this->UserManagedInputs?"On":"Off") << endl;
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << endl;
+  os << indent << "MergePoints: " << (this->MergePoints?"On":"Off") << endl;
+}
+
+//----------------------------------------------------------------------------
+// Each point maps to the smallest id among the points coincident with it,
+// so numbering the kept points in increasing order keeps their order of
+// first appearance.
+void vtkAppendPolyData::MergeCoincidentPoints(vtkPolyData *output)
+{
+  vtkPoints *points = output->GetPoints();
+  vtkIdType numPts = output->GetNumberOfPoints();
+  if (!points || numPts < 1)
+  {
+    return;
+  }
+
+  std::vector<vtkIdType> pointMap(numPts);
+  vtkStaticPointLocator *locator = vtkStaticPointLocator::New();
+  locator->SetDataSet(output);
+  locator->MergePoints(0.0, &pointMap[0]);
+  locator->Delete();
+
+  vtkIdList *keptIds = vtkIdList::New();
+  for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+  {
+    if (pointMap[ptId] == ptId)
+    {
+      pointMap[ptId] = keptIds->InsertNextId(ptId);
+    }
+    else
+    {
+      pointMap[ptId] = pointMap[pointMap[ptId]];
+    }
+  }
+  vtkIdType numKept = keptIds->GetNumberOfIds();
+  if (numKept == numPts)
+  {
+    keptIds->Delete();
+    return;
+  }
+
+  vtkPoints *newPts = points->NewInstance();
+  newPts->SetDataType(points->GetDataType());
+  newPts->SetNumberOfPoints(numKept);
+  points->GetData()->GetTuples(keptIds, newPts->GetData());
+
+  vtkIdList *newIds = vtkIdList::New();
+  newIds->SetNumberOfIds(numKept);
+  for (vtkIdType id = 0; id < numKept; ++id)
+  {
+    newIds->SetId(id, id);
+  }
+  vtkPointData *outputPD = output->GetPointData();
+  vtkPointData *newPD = vtkPointData::New();
+  newPD->CopyAllocate(outputPD, numKept);
+  newPD->CopyData(outputPD, keptIds, newIds);
+  outputPD->ShallowCopy(newPD);
+  newPD->Delete();
+  newIds->Delete();
+  keptIds->Delete();
+
+  output->SetPoints(newPts);
+  newPts->Delete();
+
+  // Renumber the connectivity in place.
+  vtkCellArray *cellArrays[4] =
+    { output->GetVerts(), output->GetLines(), output->GetPolys(),
+      output->GetStrips() };
+  for (int i = 0; i < 4; ++i)
+  {
+    if (!cellArrays[i])
+    {
+      continue;
+    }
+    vtkIdType *pCells = cellArrays[i]->GetPointer();
+    vtkIdType *pEnd = pCells + cellArrays[i]->GetNumberOfConnectivityEntries();
+    while (pCells < pEnd)
+    {
+      vtkIdType npts = *pCells++;
+      for (vtkIdType j = 0; j < npts; ++j, ++pCells)
+      {
+        *pCells = pointMap[*pCells];
+      }
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
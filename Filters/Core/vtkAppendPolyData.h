@@ -115,6 +115,20 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the merging of coincident points once the inputs are
+   * appended. The points are merged in parallel with
+   * vtkStaticPointLocator::MergePoints() and keep their order of first
+   * appearance; the point data of a merged point comes from its first
+   * occurrence. Cells are only renumbered, so cells made degenerate by the
+   * merging are kept (see vtkCleanPolyData). Off by default.
+   */
+  vtkSetMacro(MergePoints, int);
+  vtkGetMacro(MergePoints, int);
+  vtkBooleanMacro(MergePoints, int);
+  //@}
+
   int ExecuteAppend(vtkPolyData* output,
     vtkPolyData* inputs[], int numInputs);
 
@@ -125,6 +139,7 @@ protected:
   // Flag for selecting parallel streaming behavior
   int ParallelStreaming;
   int OutputPointsPrecision;
+  int MergePoints;
 
   // Usual data generation method
   int RequestData(vtkInformation *,
@@ -141,6 +156,9 @@ protected:
   vtkIdType *AppendCells(vtkIdType *pDest, vtkCellArray *src,
                          vtkIdType offset);
 
+  // Merge the coincident points of the appended output.
+  void MergeCoincidentPoints(vtkPolyData *output);
+
  private:
   // hide the superclass' AddInput() from the user and the compiler
   void AddInputData(vtkDataObject *)
@@ -14,22 +14,31 @@
 =========================================================================*/
 #include "vtkCellDataToPointData.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinks.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnsignedIntArray.h"
 #include "vtkUnstructuredGrid.h"
 
 #include <algorithm>
 #include <functional>
+#include <vector>
 
 #define VTK_MAX_CELLS_PER_POINT 4096
 
@@ -40,6 +49,7 @@ vtkStandardNewMacro(vtkCellDataToPointData);
 vtkCellDataToPointData::vtkCellDataToPointData()
 {
   this->PassCellData = 0;
+  this->EnableSMP = false;
 }
 
 //----------------------------------------------------------------------------
@@ -84,7 +94,11 @@ int vtkCellDataToPointData::RequestData(
 
   // Do the interpolation, taking care of masked cells if needed.
   vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input);
-  if (sGrid && sGrid->HasAnyBlankCells())
+  if (this->EnableSMP && this->InterpolatePointDataSMP(input, output))
+  {
+    // done
+  }
+  else if (sGrid && sGrid->HasAnyBlankCells())
   {
     this->interpolatePointDataWithMask(sGrid, output);
   }
@@ -109,6 +123,7 @@ void vtkCellDataToPointData::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Pass Cell Data: " << (this->PassCellData ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -156,6 +171,59 @@ namespace
       }
     }
   }
+
+  template <typename T>
+  struct SpreadCellValues
+  {
+    vtkStaticCellLinks *Links;
+    const T *Src;
+    T *Dst;
+    vtkIdType NumComps;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      const vtkIdType ncomps = this->NumComps;
+      for (vtkIdType pid = begin; pid < end; ++pid)
+      {
+        T *dst = this->Dst + pid*ncomps;
+        std::fill_n(dst, ncomps, T(0));
+
+        // static links list the cells of a point in decreasing id order:
+        // accumulate backwards, in the order of the serial traversal
+        const vtkIdType *cells = this->Links->GetCells(pid);
+        vtkIdType ncells = this->Links->GetNumberOfCells(pid);
+        for (vtkIdType i = ncells - 1; i >= 0; --i)
+        {
+          const T *src = this->Src + cells[i]*ncomps;
+          std::transform(src, src+ncomps, dst, dst, std::plus<T>());
+        }
+
+        // average
+        if (unsigned int const denum = static_cast<unsigned int>(ncells))
+        {
+          T const tdenum = static_cast<T>(denum);
+          for (vtkIdType c = 0; c < ncomps; ++c)
+          {
+            dst[c] = static_cast<T>(dst[c] / tdenum);
+          }
+        }
+      }
+    }
+  };
+
+  // Threaded version of __spread() gathering the cell values of each point
+  // through static links.
+  template <typename T>
+  void SpreadSMP(vtkStaticCellLinks *links, vtkDataArray *srcarray,
+                 vtkDataArray *dstarray, vtkIdType npoints, vtkIdType ncomps)
+  {
+    SpreadCellValues<T> spread;
+    spread.Links = links;
+    spread.Src = static_cast<T const*>(srcarray->GetVoidPointer(0));
+    spread.Dst = static_cast<T*>(dstarray->GetVoidPointer(0));
+    spread.NumComps = ncomps;
+    vtkSMPTools::For(0, npoints, spread);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -177,20 +245,30 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
     return 1;
   }
 
-  // count the number of cells associated with each point
+  // count the number of cells associated with each point, or build the
+  // static links gathering the cells of each point when threaded
   vtkSmartPointer<vtkUnsignedIntArray> num
     = vtkSmartPointer<vtkUnsignedIntArray>::New();
-  num->SetNumberOfComponents(1);
-  num->SetNumberOfTuples(npoints);
-  std::fill_n(num->GetPointer(0), npoints, 0u);
-  vtkNew<vtkIdList> pids;
-  for (vtkIdType cid = 0; cid < ncells; ++cid)
+  vtkSmartPointer<vtkStaticCellLinks> links;
+  if (this->EnableSMP)
   {
-    src->GetCellPoints(cid, pids.GetPointer());
-    for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+    links = vtkSmartPointer<vtkStaticCellLinks>::New();
+    links->BuildLinks(src);
+  }
+  else
+  {
+    num->SetNumberOfComponents(1);
+    num->SetNumberOfTuples(npoints);
+    std::fill_n(num->GetPointer(0), npoints, 0u);
+    vtkNew<vtkIdList> pids;
+    for (vtkIdType cid = 0; cid < ncells; ++cid)
     {
-      vtkIdType const pid = pids->GetId(i);
-      num->SetValue(pid, num->GetValue(pid)+1);
+      src->GetCellPoints(cid, pids.GetPointer());
+      for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+      {
+        vtkIdType const pid = pids->GetId(i);
+        num->SetValue(pid, num->GetValue(pid)+1);
+      }
     }
   }
 
@@ -254,6 +332,15 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
     dstarray->SetNumberOfTuples(npoints);
 
     vtkIdType const ncomps = srcarray->GetNumberOfComponents();
+    if (links)
+    {
+      switch (srcarray->GetDataType())
+      {
+        vtkTemplateMacro
+          (SpreadSMP<VTK_TT>(links,srcarray,dstarray,npoints,ncomps));
+      }
+      continue;
+    }
     switch (srcarray->GetDataType())
     {
       vtkTemplateMacro
@@ -370,3 +457,321 @@ void vtkCellDataToPointData::interpolatePointDataWithMask(
   }
 }
 
+
+//----------------------------------------------------------------------------
+namespace
+{
+// Cells using a point of an image, rectilinear or structured grid, found
+// from the structured coordinates of the point in the same order as
+// vtkStructuredData::GetPointCells(). Masked cells of a structured grid are
+// skipped.
+class StructuredPointCells
+{
+public:
+  static const bool DecreasingIds = false;
+
+  StructuredPointCells(int dims[3], vtkStructuredGrid *maskedGrid)
+    : MaskedGrid(maskedGrid)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      this->Dims[i] = dims[i];
+      this->CellDims[i] = dims[i] > 1 ? dims[i] - 1 : 1;
+    }
+  }
+
+  vtkIdType GetCells(vtkIdType ptId, const vtkIdType *&cells,
+                     vtkIdType buffer[8]) const
+  {
+    static const int offset[8][3] = {{-1,0,0}, {-1,-1,0}, {-1,-1,-1},
+                                     {-1,0,-1}, {0,0,0}, {0,-1,0},
+                                     {0,-1,-1}, {0,0,-1}};
+    vtkIdType ptLoc[3];
+    ptLoc[0] = ptId % this->Dims[0];
+    ptLoc[1] = (ptId / this->Dims[0]) % this->Dims[1];
+    ptLoc[2] = ptId / (static_cast<vtkIdType>(this->Dims[0])*this->Dims[1]);
+
+    vtkIdType numCells = 0;
+    for (int j = 0; j < 8; ++j)
+    {
+      vtkIdType cellLoc[3];
+      int i;
+      for (i = 0; i < 3; ++i)
+      {
+        cellLoc[i] = ptLoc[i] + offset[j][i];
+        if (cellLoc[i] < 0 || cellLoc[i] >= this->CellDims[i])
+        {
+          break;
+        }
+      }
+      if (i >= 3)
+      {
+        vtkIdType cellId = cellLoc[0] + cellLoc[1]*this->CellDims[0] +
+          cellLoc[2]*this->CellDims[0]*this->CellDims[1];
+        if (!this->MaskedGrid || this->MaskedGrid->IsCellVisible(cellId))
+        {
+          buffer[numCells++] = cellId;
+        }
+      }
+    }
+    cells = buffer;
+    return numCells;
+  }
+
+private:
+  int Dims[3];
+  vtkIdType CellDims[3];
+  vtkStructuredGrid *MaskedGrid;
+};
+
+// Cells using a point of polydata, from static links. The links list the
+// cells in decreasing id order.
+class LinkedPointCells
+{
+public:
+  static const bool DecreasingIds = true;
+
+  explicit LinkedPointCells(vtkStaticCellLinks *links) : Links(links) {}
+
+  vtkIdType GetCells(vtkIdType ptId, const vtkIdType *&cells,
+                     vtkIdType *vtkNotUsed(buffer)) const
+  {
+    cells = this->Links->GetCells(ptId);
+    return this->Links->GetNumberOfCells(ptId);
+  }
+
+private:
+  vtkStaticCellLinks *Links;
+};
+
+// Average the tuples of the cells using each point, with the same weights
+// and rounding as vtkDataSetAttributes::InterpolatePoint(). The cells are
+// visited in increasing id order, and attributes interpolated by nearest
+// neighbor take the tuple of the last cell, as InterpolatePoint() does for
+// equal weights.
+template <typename TopologyT, typename SrcArrayT, typename DstArrayT>
+struct AverageCellTuples
+{
+  const TopologyT *Topology;
+  SrcArrayT *Src;
+  DstArrayT *Dst;
+  bool Nearest;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DstType;
+    vtkDataArrayAccessor<SrcArrayT> s(this->Src);
+    vtkDataArrayAccessor<DstArrayT> d(this->Dst);
+    const int numComps = this->Dst->GetNumberOfComponents();
+    vtkIdType buffer[8];
+    const vtkIdType *cells;
+
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      vtkIdType numCells = this->Topology->GetCells(ptId, cells, buffer);
+      if (numCells < 1 || numCells >= VTK_MAX_CELLS_PER_POINT)
+      {
+        for (int c = 0; c < numComps; ++c)
+        {
+          d.Set(ptId, c, static_cast<DstType>(0));
+        }
+      }
+      else if (this->Nearest)
+      {
+        vtkIdType last = cells[TopologyT::DecreasingIds ? 0 : numCells - 1];
+        for (int c = 0; c < numComps; ++c)
+        {
+          d.Set(ptId, c, static_cast<DstType>(s.Get(last, c)));
+        }
+      }
+      else
+      {
+        double weight = 1.0 / numCells;
+        for (int c = 0; c < numComps; ++c)
+        {
+          double val = 0.;
+          for (vtkIdType i = 0; i < numCells; ++i)
+          {
+            vtkIdType cellId =
+              cells[TopologyT::DecreasingIds ? numCells - 1 - i : i];
+            val += weight * static_cast<double>(s.Get(cellId, c));
+          }
+          DstType valT;
+          vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+          d.Set(ptId, c, valT);
+        }
+      }
+    }
+  }
+};
+
+template <typename TopologyT>
+struct AverageCellTuplesWorker
+{
+  const TopologyT *Topology;
+  vtkIdType NumberOfPoints;
+  bool Nearest;
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT *src, DstArrayT *dst)
+  {
+    AverageCellTuples<TopologyT, SrcArrayT, DstArrayT> average;
+    average.Topology = this->Topology;
+    average.Src = src;
+    average.Dst = dst;
+    average.Nearest = this->Nearest;
+    vtkSMPTools::For(0, this->NumberOfPoints, average);
+  }
+};
+
+// Interpolate the arrays of interpPD, allocated by InterpolateAllocate(),
+// from the matching arrays of inCD.
+template <typename TopologyT>
+bool AverageCellData(const TopologyT &topology, vtkCellData *inCD,
+                     vtkPointData *interpPD, vtkIdType numPts)
+{
+  AverageCellTuplesWorker<TopologyT> worker;
+  worker.Topology = &topology;
+  worker.NumberOfPoints = numPts;
+
+  vtkNew<vtkIdList> cellIds;
+  std::vector<double> weights;
+  for (int i = 0; i < interpPD->GetNumberOfArrays(); ++i)
+  {
+    vtkAbstractArray *dstArray = interpPD->GetAbstractArray(i);
+    int attribute = interpPD->IsArrayAnAttribute(i);
+    vtkAbstractArray *srcArray = dstArray->GetName() ?
+      inCD->GetAbstractArray(dstArray->GetName()) :
+      (attribute >= 0 ? inCD->GetAbstractAttribute(attribute) : NULL);
+    if (!srcArray)
+    {
+      return false;
+    }
+    dstArray->SetNumberOfTuples(numPts);
+    worker.Nearest = attribute >= 0 && interpPD->GetCopyAttribute(
+      attribute, vtkDataSetAttributes::INTERPOLATE) == 2;
+
+    vtkDataArray *src = vtkArrayDownCast<vtkDataArray>(srcArray);
+    vtkDataArray *dst = vtkArrayDownCast<vtkDataArray>(dstArray);
+    if (src && dst &&
+        vtkArrayDispatch::Dispatch2SameValueType::Execute(src, dst, worker))
+    {
+      continue;
+    }
+
+    // Other arrays, such as bit and string arrays, go through the serial
+    // vtkAbstractArray API. NullPoint() leaves the arrays that are not data
+    // arrays alone, so these are grown by insertion as in the serial filter.
+    if (!dst)
+    {
+      dstArray->SetNumberOfTuples(0);
+    }
+    std::vector<double> nullTuple(dstArray->GetNumberOfComponents(), 0.0);
+    vtkIdType buffer[8];
+    const vtkIdType *cells;
+    for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+    {
+      vtkIdType numCells = topology.GetCells(ptId, cells, buffer);
+      if (numCells < 1 || numCells >= VTK_MAX_CELLS_PER_POINT)
+      {
+        if (dst)
+        {
+          dst->SetTuple(ptId, &nullTuple[0]);
+        }
+        continue;
+      }
+      if (worker.Nearest)
+      {
+        dstArray->InsertTuple(
+          ptId, cells[TopologyT::DecreasingIds ? 0 : numCells - 1], srcArray);
+        continue;
+      }
+      cellIds->SetNumberOfIds(numCells);
+      if (TopologyT::DecreasingIds)
+      {
+        std::reverse_copy(cells, cells + numCells, cellIds->GetPointer(0));
+      }
+      else
+      {
+        std::copy(cells, cells + numCells, cellIds->GetPointer(0));
+      }
+      weights.assign(numCells, 1.0 / numCells);
+      dstArray->InterpolateTuple(ptId, cellIds.GetPointer(), srcArray,
+                                 &weights[0]);
+    }
+  }
+  return true;
+}
+}
+
+//----------------------------------------------------------------------------
+bool vtkCellDataToPointData::InterpolatePointDataSMP(vtkDataSet *input,
+                                                     vtkDataSet *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkCellData *inCD = input->GetCellData();
+  vtkPointData *outPD = output->GetPointData();
+
+  // Allocate the interpolated arrays apart from the output, with the same
+  // copy flags, so that they can be matched with the input arrays.
+  vtkNew<vtkPointData> interpPD;
+  for (int i = 0; i < vtkDataSetAttributes::NUM_ATTRIBUTES; ++i)
+  {
+    interpPD->SetCopyAttribute(
+      i, outPD->GetCopyAttribute(i, vtkDataSetAttributes::INTERPOLATE),
+      vtkDataSetAttributes::INTERPOLATE);
+  }
+  interpPD->CopyGlobalIdsOff();
+  interpPD->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
+  interpPD->InterpolateAllocate(inCD, numPts);
+
+  bool interpolated = false;
+  int dims[3];
+  if (vtkImageData *image = vtkImageData::SafeDownCast(input))
+  {
+    image->GetDimensions(dims);
+    StructuredPointCells topology(dims, NULL);
+    interpolated = AverageCellData(topology, inCD, interpPD.GetPointer(),
+                                   numPts);
+  }
+  else if (vtkRectilinearGrid *rGrid = vtkRectilinearGrid::SafeDownCast(input))
+  {
+    rGrid->GetDimensions(dims);
+    StructuredPointCells topology(dims, NULL);
+    interpolated = AverageCellData(topology, inCD, interpPD.GetPointer(),
+                                   numPts);
+  }
+  else if (vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input))
+  {
+    sGrid->GetDimensions(dims);
+    StructuredPointCells topology(
+      dims, sGrid->HasAnyBlankCells() ? sGrid : NULL);
+    interpolated = AverageCellData(topology, inCD, interpPD.GetPointer(),
+                                   numPts);
+  }
+  else if (vtkPolyData::SafeDownCast(input))
+  {
+    vtkNew<vtkStaticCellLinks> links;
+    links->BuildLinks(input);
+    LinkedPointCells topology(links.GetPointer());
+    interpolated = AverageCellData(topology, inCD, interpPD.GetPointer(),
+                                   numPts);
+  }
+  if (!interpolated)
+  {
+    return false;
+  }
+
+  // Add the arrays to the output as InterpolateAllocate() would have.
+  for (int i = 0; i < interpPD->GetNumberOfArrays(); ++i)
+  {
+    int idx = outPD->AddArray(interpPD->GetAbstractArray(i));
+    int attribute = interpPD->IsArrayAnAttribute(i);
+    if (attribute >= 0)
+    {
+      outPD->SetActiveAttribute(idx, attribute);
+    }
+  }
+  this->UpdateProgress(1.0);
+  return true;
+}
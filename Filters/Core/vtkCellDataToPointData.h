@@ -58,6 +58,20 @@ public:
   vtkBooleanMacro(PassCellData,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. Points are processed
+   * concurrently with vtkSMPTools and every data array is averaged by a
+   * kernel specialized for its type. Images, rectilinear and structured
+   * grids find the cells using a point from its structured coordinates;
+   * polydata and unstructured grids use vtkStaticCellLinks. The output is
+   * the same as the serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkCellDataToPointData();
   ~vtkCellDataToPointData() VTK_OVERRIDE {}
@@ -76,7 +90,13 @@ protected:
   void interpolatePointDataWithMask(vtkStructuredGrid *input,
                                     vtkDataSet *output);
 
+  // Threaded counterpart of interpolatePointData() and
+  // interpolatePointDataWithMask(). Returns false, leaving the output
+  // untouched, if the dataset type or some cell array is not supported.
+  bool InterpolatePointDataSMP(vtkDataSet *input, vtkDataSet *output);
+
   int PassCellData;
+  bool EnableSMP;
 private:
   vtkCellDataToPointData(const vtkCellDataToPointData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCellDataToPointData&) VTK_DELETE_FUNCTION;
@@ -0,0 +1,446 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellRegionLabeler.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellRegionLabeler.h"
+
+#include "vtkAtomicTypes.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkIdList.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSimpleCriticalSection.h"
+#include "vtkStaticCellLinks.h"
+#include "vtkUnionFind.h"
+
+#include <vector>
+
+vtkStandardNewMacro(vtkCellRegionLabeler);
+
+namespace
+{
+
+struct InitializeClaims
+{
+  vtkAtomicIdType *Claims;
+  vtkIdType Value;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      this->Claims[i].store(this->Value);
+    }
+  }
+};
+
+// The scalars are compared in single precision, as in the serial traversal
+// of the connectivity filters.
+struct MarkScalarConnected
+{
+  vtkDataSet *Input;
+  vtkDataArray *Scalars;
+  const double *ScalarRange;
+  bool FullRange;
+  unsigned char *Connectable;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  MarkScalarConnected(vtkDataSet *input, vtkDataArray *scalars,
+                      const double *scalarRange, bool fullRange,
+                      unsigned char *connectable)
+    : Input(input), Scalars(scalars), ScalarRange(scalarRange),
+      FullRange(fullRange), Connectable(connectable)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Input->GetCellPoints(cellId, cellPts);
+      double range[2] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+      for (vtkIdType i = 0; i < cellPts->GetNumberOfIds(); ++i)
+      {
+        double s = static_cast<float>(
+          this->Scalars->GetComponent(cellPts->GetId(i), 0));
+        range[0] = (s < range[0] ? s : range[0]);
+        range[1] = (s > range[1] ? s : range[1]);
+      }
+      if (this->FullRange)
+      {
+        this->Connectable[cellId] = (range[0] >= this->ScalarRange[0] &&
+                                     range[1] <= this->ScalarRange[1]);
+      }
+      else
+      {
+        this->Connectable[cellId] = (range[1] >= this->ScalarRange[0] &&
+                                     range[0] <= this->ScalarRange[1]);
+      }
+    }
+  }
+};
+
+// Join the connectable cells using each point to the first of them.
+struct HookPoints
+{
+  vtkStaticCellLinks *Links;
+  const unsigned char *Connectable;
+  vtkUnionFind *Sets;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      const vtkIdType *cells = this->Links->GetCells(ptId);
+      vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+      vtkIdType first = -1;
+      for (vtkIdType i = 0; i < ncells; ++i)
+      {
+        if (this->Connectable && !this->Connectable[cells[i]])
+        {
+          continue;
+        }
+        if (first < 0)
+        {
+          first = cells[i];
+        }
+        else
+        {
+          this->Sets->Union(first, cells[i]);
+        }
+      }
+    }
+  }
+};
+
+struct FlattenRoots
+{
+  vtkUnionFind *Sets;
+  vtkIdType *Roots;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Roots[cellId] = this->Sets->Find(cellId);
+    }
+  }
+};
+
+// A cell that is not connectable starts its own region, which takes the
+// sets of connectable neighbors that no earlier cell has reached. Record
+// for each set the smallest such cell. Claims only decrease, so they are
+// checked without locking first.
+struct ClaimSets
+{
+  vtkDataSet *Input;
+  vtkStaticCellLinks *Links;
+  const unsigned char *Connectable;
+  const vtkIdType *Roots;
+  vtkAtomicIdType *Claims;
+  vtkSimpleCriticalSection Lock;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  ClaimSets(vtkDataSet *input, vtkStaticCellLinks *links,
+            const unsigned char *connectable, const vtkIdType *roots,
+            vtkAtomicIdType *claims)
+    : Input(input), Links(links), Connectable(connectable), Roots(roots),
+      Claims(claims)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      if (this->Connectable[cellId])
+      {
+        continue;
+      }
+      this->Input->GetCellPoints(cellId, cellPts);
+      for (vtkIdType j = 0; j < cellPts->GetNumberOfIds(); ++j)
+      {
+        vtkIdType ptId = cellPts->GetId(j);
+        const vtkIdType *cells = this->Links->GetCells(ptId);
+        vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+        for (vtkIdType i = 0; i < ncells; ++i)
+        {
+          vtkIdType root = this->Roots[cells[i]];
+          if (this->Connectable[cells[i]] && cellId < root &&
+              cellId < this->Claims[root].load())
+          {
+            this->Lock.Lock();
+            if (cellId < this->Claims[root].load())
+            {
+              this->Claims[root].store(cellId);
+            }
+            this->Lock.Unlock();
+          }
+        }
+      }
+    }
+  }
+};
+
+struct AssignRegions
+{
+  const unsigned char *Connectable;
+  const vtkIdType *Roots;
+  const vtkAtomicIdType *Claims;
+  const vtkIdType *SeedRegions;
+  vtkIdType *RegionIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType seed = this->Roots[cellId];
+      if (this->Connectable && this->Connectable[cellId] &&
+          this->Claims[seed].load() < seed)
+      {
+        seed = this->Claims[seed].load();
+      }
+      this->RegionIds[cellId] = this->SeedRegions[seed];
+    }
+  }
+};
+
+struct MarkSeededRegion
+{
+  const unsigned char *Connectable;
+  const vtkIdType *Roots;
+  const unsigned char *Seeds;
+  const unsigned char *ReachedSets;
+  vtkIdType *RegionIds;
+  vtkSMPThreadLocal<vtkIdType> NumberOfCells;
+
+  MarkSeededRegion(const unsigned char *connectable, const vtkIdType *roots,
+                   const unsigned char *seeds,
+                   const unsigned char *reachedSets, vtkIdType *regionIds)
+    : Connectable(connectable), Roots(roots), Seeds(seeds),
+      ReachedSets(reachedSets), RegionIds(regionIds), NumberOfCells(0)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType &numCells = this->NumberOfCells.Local();
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      bool reached = this->Seeds[cellId] ||
+        ((!this->Connectable || this->Connectable[cellId]) &&
+         this->ReachedSets[this->Roots[cellId]]);
+      this->RegionIds[cellId] = reached ? 0 : -1;
+      numCells += reached;
+    }
+  }
+};
+
+struct LabelPointsWorker
+{
+  vtkStaticCellLinks *Links;
+  const vtkIdType *RegionIds;
+  vtkIdType *PointRegionIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      const vtkIdType *cells = this->Links->GetCells(ptId);
+      vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+      vtkIdType region = -1;
+      for (vtkIdType i = 0; i < ncells; ++i)
+      {
+        vtkIdType cellRegion = this->RegionIds[cells[i]];
+        if (cellRegion >= 0 && (region < 0 || cellRegion < region))
+        {
+          region = cellRegion;
+        }
+      }
+      this->PointRegionIds[ptId] = region;
+    }
+  }
+};
+
+} // end anon namespace
+
+//----------------------------------------------------------------------------
+vtkCellRegionLabeler::vtkCellRegionLabeler()
+{
+  this->Input = NULL;
+  this->Links = vtkStaticCellLinks::New();
+}
+
+//----------------------------------------------------------------------------
+vtkCellRegionLabeler::~vtkCellRegionLabeler()
+{
+  this->Links->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkCellRegionLabeler::Initialize(vtkDataSet *input)
+{
+  this->Input = input;
+  this->Links->Initialize();
+  this->Links->BuildLinks(input);
+
+  // The first access builds the cells of polydata and must not be threaded.
+  if (input->GetNumberOfCells() > 0)
+  {
+    vtkIdList *cellPts = vtkIdList::New();
+    input->GetCellPoints(0, cellPts);
+    cellPts->Delete();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellRegionLabeler::MarkScalarConnectedCells(
+  vtkDataArray *scalars, const double scalarRange[2], bool fullRange,
+  unsigned char *connectable)
+{
+  MarkScalarConnected mark(this->Input, scalars, scalarRange, fullRange,
+                           connectable);
+  vtkSMPTools::For(0, this->Input->GetNumberOfCells(), mark);
+}
+
+//----------------------------------------------------------------------------
+void vtkCellRegionLabeler::JoinCells(const unsigned char *connectable,
+                                     vtkIdType *roots)
+{
+  vtkIdType numCells = this->Input->GetNumberOfCells();
+  vtkUnionFind sets(numCells);
+  HookPoints hook = { this->Links, connectable, &sets };
+  vtkSMPTools::For(0, this->Input->GetNumberOfPoints(), hook);
+
+  FlattenRoots flatten = { &sets, roots };
+  vtkSMPTools::For(0, numCells, flatten);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellRegionLabeler::LabelAllRegions(
+  const unsigned char *connectable, vtkIdType *regionIds)
+{
+  vtkIdType numCells = this->Input->GetNumberOfCells();
+  if (numCells < 1)
+  {
+    return 0;
+  }
+  std::vector<vtkIdType> roots(numCells);
+  this->JoinCells(connectable, &roots[0]);
+
+  std::vector<vtkAtomicIdType> claims(connectable ? numCells : 1);
+  if (connectable)
+  {
+    InitializeClaims init = { &claims[0], numCells };
+    vtkSMPTools::For(0, numCells, init);
+    ClaimSets claim(this->Input, this->Links, connectable, &roots[0],
+                    &claims[0]);
+    vtkSMPTools::For(0, numCells, claim);
+  }
+
+  // Number the cells that start a region, in increasing order.
+  std::vector<vtkIdType> seedRegions(numCells, -1);
+  vtkIdType numRegions = 0;
+  for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+  {
+    if (!connectable ? roots[cellId] == cellId :
+        (!connectable[cellId] ||
+         (roots[cellId] == cellId && claims[cellId].load() > cellId)))
+    {
+      seedRegions[cellId] = numRegions++;
+    }
+  }
+
+  AssignRegions assign = { connectable, &roots[0], &claims[0],
+                           &seedRegions[0], regionIds };
+  vtkSMPTools::For(0, numCells, assign);
+  return numRegions;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellRegionLabeler::LabelSeededRegion(
+  const unsigned char *connectable, vtkIdList *seedCells,
+  vtkIdType *regionIds)
+{
+  vtkIdType numCells = this->Input->GetNumberOfCells();
+  if (numCells < 1)
+  {
+    return 0;
+  }
+  std::vector<vtkIdType> roots(numCells);
+  this->JoinCells(connectable, &roots[0]);
+
+  // The region holds the seeds and the sets of connectable cells that
+  // contain a seed or use one of its points.
+  std::vector<unsigned char> seeds(numCells, 0);
+  std::vector<unsigned char> reachedSets(numCells, 0);
+  vtkIdList *cellPts = vtkIdList::New();
+  for (vtkIdType i = 0; i < seedCells->GetNumberOfIds(); ++i)
+  {
+    vtkIdType seed = seedCells->GetId(i);
+    if (seed < 0 || seed >= numCells)
+    {
+      continue;
+    }
+    seeds[seed] = 1;
+    this->Input->GetCellPoints(seed, cellPts);
+    for (vtkIdType j = 0; j < cellPts->GetNumberOfIds(); ++j)
+    {
+      vtkIdType ptId = cellPts->GetId(j);
+      const vtkIdType *cells = this->Links->GetCells(ptId);
+      vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+      for (vtkIdType k = 0; k < ncells; ++k)
+      {
+        if (!connectable || connectable[cells[k]])
+        {
+          reachedSets[roots[cells[k]]] = 1;
+        }
+      }
+    }
+  }
+  cellPts->Delete();
+
+  MarkSeededRegion mark(connectable, &roots[0], &seeds[0], &reachedSets[0],
+                        regionIds);
+  vtkSMPTools::For(0, numCells, mark);
+
+  vtkIdType numReached = 0;
+  vtkSMPThreadLocal<vtkIdType>::iterator count;
+  for (count = mark.NumberOfCells.begin(); count != mark.NumberOfCells.end();
+       ++count)
+  {
+    numReached += *count;
+  }
+  return numReached;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellRegionLabeler::LabelPoints(const vtkIdType *regionIds,
+                                       vtkIdType *pointRegionIds)
+{
+  LabelPointsWorker label = { this->Links, regionIds, pointRegionIds };
+  vtkSMPTools::For(0, this->Input->GetNumberOfPoints(), label);
+}
+
+//----------------------------------------------------------------------------
+void vtkCellRegionLabeler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Input: " << static_cast<void *>(this->Input) << "\n";
+}
@@ -0,0 +1,116 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellRegionLabeler.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkCellRegionLabeler
+ * @brief   label the connected regions of the cells of a dataset in parallel
+ *
+ * vtkCellRegionLabeler is a helper object for the connectivity filters
+ * (vtkConnectivityFilter, vtkPolyDataConnectivityFilter). Cells are
+ * connected through their shared points. It builds static cell links, joins
+ * the cells with a union-find that threads hook concurrently (path halving
+ * on lookups, roots linked in a critical section), and numbers the regions
+ * deterministically.
+ *
+ * Cells may be flagged as not connectable (e.g., when their scalars fail a
+ * scalar connectivity criterion). As in the wave propagation of the
+ * connectivity filters, such a cell can only start a region: the regions
+ * grow from it into its connectable neighbors, never through it. The
+ * regions, and their numbering in order of the cell that starts them, are
+ * the same as the ones of a serial traversal of the cells in increasing
+ * order.
+ *
+ * @sa
+ * vtkConnectivityFilter vtkPolyDataConnectivityFilter vtkStaticCellLinks
+*/
+
+#ifndef vtkCellRegionLabeler_h
+#define vtkCellRegionLabeler_h
+
+#include "vtkFiltersCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class vtkDataArray;
+class vtkDataSet;
+class vtkIdList;
+class vtkStaticCellLinks;
+
+class VTKFILTERSCORE_EXPORT vtkCellRegionLabeler : public vtkObject
+{
+public:
+  static vtkCellRegionLabeler *New();
+  vtkTypeMacro(vtkCellRegionLabeler,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Build the cell links of the dataset to label. This must be called
+   * before the other methods; the dataset must not change afterwards.
+   */
+  void Initialize(vtkDataSet *input);
+
+  /**
+   * Flag the cells that meet the scalar connectivity criterion of the
+   * connectivity filters: the range of the point scalars (first component)
+   * of the cell overlaps scalarRange or, if fullRange is set, lies within
+   * it. connectable must hold one entry per cell.
+   */
+  void MarkScalarConnectedCells(vtkDataArray *scalars,
+                                const double scalarRange[2], bool fullRange,
+                                unsigned char *connectable);
+
+  /**
+   * Label all the cells. connectable holds one flag per cell, or is NULL
+   * when all cells are connectable. On return, regionIds[cellId] holds the
+   * region of each cell; regions are numbered in increasing order of the
+   * cell that starts them. Returns the number of regions.
+   */
+  vtkIdType LabelAllRegions(const unsigned char *connectable,
+                            vtkIdType *regionIds);
+
+  /**
+   * Label the single region grown from the given seed cells: regionIds is
+   * set to 0 for the cells reached and to -1 for the others. Seeds out of
+   * range are ignored. Returns the number of cells reached.
+   */
+  vtkIdType LabelSeededRegion(const unsigned char *connectable,
+                              vtkIdList *seedCells, vtkIdType *regionIds);
+
+  /**
+   * Set pointRegionIds[ptId] to the smallest region of the labeled cells
+   * using the point, or to -1 if no labeled cell uses it.
+   */
+  void LabelPoints(const vtkIdType *regionIds, vtkIdType *pointRegionIds);
+
+  /**
+   * Get the links built by Initialize().
+   */
+  vtkStaticCellLinks *GetLinks() { return this->Links; }
+
+protected:
+  vtkCellRegionLabeler();
+  ~vtkCellRegionLabeler() VTK_OVERRIDE;
+
+  // Join the connectable cells sharing a point, and return the root (the
+  // smallest cell id) of the set of each cell in roots.
+  void JoinCells(const unsigned char *connectable, vtkIdType *roots);
+
+  vtkDataSet *Input;
+  vtkStaticCellLinks *Links;
+
+private:
+  vtkCellRegionLabeler(const vtkCellRegionLabeler&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkCellRegionLabeler&) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -0,0 +1,442 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellSubsetExtractor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellSubsetExtractor.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+vtkStandardNewMacro(vtkCellSubsetExtractor);
+
+namespace
+{
+
+// Number of mask entries counted by one task of the prefix sums.
+const vtkIdType VTK_SUBSET_BLOCK_SIZE = 65536;
+
+// Count the non-zero mask entries of each block.
+struct CountMarked
+{
+  const unsigned char *Mask;
+  vtkIdType Size;
+  vtkIdType *Counts;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType block = begin; block < end; ++block)
+    {
+      vtkIdType first = block * VTK_SUBSET_BLOCK_SIZE;
+      vtkIdType last = std::min(first + VTK_SUBSET_BLOCK_SIZE, this->Size);
+      vtkIdType count = 0;
+      for (vtkIdType i = first; i < last; ++i)
+      {
+        count += (this->Mask[i] != 0);
+      }
+      this->Counts[block] = count;
+    }
+  }
+};
+
+// Write the indices of the non-zero entries of each block from its offset.
+struct FillMarked
+{
+  const unsigned char *Mask;
+  vtkIdType Size;
+  const vtkIdType *Offsets;
+  vtkIdType *Ids;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType block = begin; block < end; ++block)
+    {
+      vtkIdType first = block * VTK_SUBSET_BLOCK_SIZE;
+      vtkIdType last = std::min(first + VTK_SUBSET_BLOCK_SIZE, this->Size);
+      vtkIdType *ids = this->Ids + this->Offsets[block];
+      for (vtkIdType i = first; i < last; ++i)
+      {
+        if (this->Mask[i])
+        {
+          *ids++ = i;
+        }
+      }
+    }
+  }
+};
+
+// Thread safe access to the point ids of the cells of a dataset, without
+// copies for the cell arrays of unstructured grids and polydata.
+class CellPoints
+{
+public:
+  CellPoints(vtkDataSet *input) : Input(input)
+  {
+    this->Grid = vtkUnstructuredGrid::SafeDownCast(input);
+    this->PolyData = vtkPolyData::SafeDownCast(input);
+  }
+
+  vtkIdType Get(vtkIdType cellId, vtkIdList *ids, const vtkIdType *&pts)
+  {
+    vtkIdType npts;
+    vtkIdType *cellPts;
+    if (this->Grid)
+    {
+      this->Grid->GetCellPoints(cellId, npts, cellPts);
+    }
+    else if (this->PolyData)
+    {
+      this->PolyData->GetCellPoints(cellId, npts, cellPts);
+    }
+    else
+    {
+      this->Input->GetCellPoints(cellId, ids);
+      npts = ids->GetNumberOfIds();
+      cellPts = ids->GetPointer(0);
+    }
+    pts = cellPts;
+    return npts;
+  }
+
+private:
+  vtkDataSet *Input;
+  vtkUnstructuredGrid *Grid;
+  vtkPolyData *PolyData;
+};
+
+// Size of the connectivity of each extracted cell, count included.
+struct CountConnectivity
+{
+  CellPoints Cells;
+  const vtkIdType *CellIds;
+  vtkIdType *Sizes;
+  vtkSMPThreadLocalObject<vtkIdList> Ids;
+
+  CountConnectivity(vtkDataSet *input, const vtkIdType *cellIds,
+                    vtkIdType *sizes)
+    : Cells(input), CellIds(cellIds), Sizes(sizes)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *ids = this->Ids.Local();
+    const vtkIdType *pts;
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      this->Sizes[i] = this->Cells.Get(this->CellIds[i], ids, pts) + 1;
+    }
+  }
+};
+
+// Write the renumbered connectivity, the types and the locations of the
+// extracted cells.
+struct FillConnectivity
+{
+  vtkDataSet *Input;
+  CellPoints Cells;
+  const vtkIdType *CellIds;
+  const vtkIdType *Locations;
+  const vtkIdType *PointMap;
+  vtkIdType *Connectivity;
+  unsigned char *Types;
+  vtkSMPThreadLocalObject<vtkIdList> Ids;
+
+  FillConnectivity(vtkDataSet *input, const vtkIdType *cellIds,
+                   const vtkIdType *locations, const vtkIdType *pointMap,
+                   vtkIdType *connectivity, unsigned char *types)
+    : Input(input), Cells(input), CellIds(cellIds), Locations(locations),
+      PointMap(pointMap), Connectivity(connectivity), Types(types)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *ids = this->Ids.Local();
+    const vtkIdType *pts;
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkIdType cellId = this->CellIds[i];
+      vtkIdType npts = this->Cells.Get(cellId, ids, pts);
+      vtkIdType *conn = this->Connectivity + this->Locations[i];
+      *conn++ = npts;
+      for (vtkIdType j = 0; j < npts; ++j)
+      {
+        conn[j] = this->PointMap[pts[j]];
+      }
+      this->Types[i] =
+        static_cast<unsigned char>(this->Input->GetCellType(cellId));
+    }
+  }
+};
+
+// Copy the coordinates of the extracted points of a dataset without
+// explicit points.
+struct GatherPoints
+{
+  vtkDataSet *Input;
+  const vtkIdType *PointIds;
+  vtkPoints *Points;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      this->Input->GetPoint(this->PointIds[i], x);
+      this->Points->SetPoint(i, x);
+    }
+  }
+};
+
+// Fill ids with 0, 1, ... n-1.
+void MakeRange(vtkIdList *ids, vtkIdType n)
+{
+  ids->SetNumberOfIds(n);
+  vtkIdType *ptr = ids->GetPointer(0);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    ptr[i] = i;
+  }
+}
+
+} // end anon namespace
+
+//----------------------------------------------------------------------------
+vtkCellSubsetExtractor::vtkCellSubsetExtractor()
+{
+  this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+}
+
+//----------------------------------------------------------------------------
+vtkCellSubsetExtractor::~vtkCellSubsetExtractor()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkCellSubsetExtractor::CompactMask(const unsigned char *mask,
+                                         vtkIdType size, vtkIdList *ids)
+{
+  vtkIdType numBlocks =
+    (size + VTK_SUBSET_BLOCK_SIZE - 1) / VTK_SUBSET_BLOCK_SIZE;
+  std::vector<vtkIdType> offsets(numBlocks + 1, 0);
+
+  CountMarked count = { mask, size, &offsets[0] + 1 };
+  vtkSMPTools::For(0, numBlocks, count);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  ids->SetNumberOfIds(offsets[numBlocks]);
+  if (offsets[numBlocks] > 0)
+  {
+    FillMarked fill = { mask, size, &offsets[0], ids->GetPointer(0) };
+    vtkSMPTools::For(0, numBlocks, fill);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellSubsetExtractor::ExtractMarkedCells(
+  vtkDataSet *input, const unsigned char *cellMask,
+  const unsigned char *pointMask, vtkUnstructuredGrid *output)
+{
+  vtkIdType numInPts = input->GetNumberOfPoints();
+  vtkIdType numInCells = input->GetNumberOfCells();
+  vtkUnstructuredGrid *grid = vtkUnstructuredGrid::SafeDownCast(input);
+  vtkPointSet *pointSet = vtkPointSet::SafeDownCast(input);
+
+  output->Initialize();
+
+  // Compact the extracted cells.
+  vtkNew<vtkIdList> cellIds;
+  CompactMask(cellMask, numInCells, cellIds.GetPointer());
+  vtkIdType numCells = cellIds->GetNumberOfIds();
+
+  // The first access builds the cells of polydata and must not be threaded.
+  vtkNew<vtkIdList> ids;
+  if (numCells > 0)
+  {
+    input->GetCellType(0);
+    input->GetCellPoints(0, ids.GetPointer());
+  }
+  if (numInPts > 0)
+  {
+    double x[3];
+    input->GetPoint(0, x);
+  }
+
+  // Mark the used points. Cells share points, so this pass stays serial to
+  // avoid concurrent writes to the same flags.
+  std::vector<unsigned char> usedPoints(numInPts, 0);
+  if (pointMask && numInPts > 0)
+  {
+    std::copy(pointMask, pointMask + numInPts, usedPoints.begin());
+  }
+  CellPoints cells(input);
+  const vtkIdType *pts;
+  for (vtkIdType i = 0; i < numCells; ++i)
+  {
+    vtkIdType npts = cells.Get(cellIds->GetId(i), ids.GetPointer(), pts);
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      usedPoints[pts[j]] = 1;
+    }
+  }
+
+  // Compact the used points and renumber them.
+  vtkNew<vtkIdList> pointIds;
+  CompactMask(numInPts > 0 ? &usedPoints[0] : NULL, numInPts,
+              pointIds.GetPointer());
+  vtkIdType numPts = pointIds->GetNumberOfIds();
+  std::vector<vtkIdType> pointMap(numInPts, -1);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    pointMap[pointIds->GetId(i)] = i;
+  }
+
+  // Gather the points.
+  vtkNew<vtkPoints> newPts;
+  if (this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    if (pointSet && pointSet->GetPoints())
+    {
+      newPts->SetDataType(pointSet->GetPoints()->GetDataType());
+    }
+    else
+    {
+      newPts->SetDataType(VTK_FLOAT);
+    }
+  }
+  else if (this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_FLOAT);
+  }
+  else if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_DOUBLE);
+  }
+  newPts->SetNumberOfPoints(numPts);
+  if (numPts > 0)
+  {
+    if (pointSet && pointSet->GetPoints())
+    {
+      pointSet->GetPoints()->GetData()->GetTuples(pointIds.GetPointer(),
+                                                  newPts->GetData());
+    }
+    else
+    {
+      GatherPoints gather = { input, pointIds->GetPointer(0),
+                              newPts.GetPointer() };
+      vtkSMPTools::For(0, numPts, gather);
+    }
+  }
+  output->SetPoints(newPts.GetPointer());
+
+  // Gather the point and cell data.
+  vtkPointData *outPD = output->GetPointData();
+  vtkCellData *outCD = output->GetCellData();
+  vtkNew<vtkIdList> range;
+  outPD->CopyGlobalIdsOn();
+  outPD->CopyAllocate(input->GetPointData(), numPts);
+  MakeRange(range.GetPointer(), numPts);
+  outPD->CopyData(input->GetPointData(), pointIds.GetPointer(),
+                  range.GetPointer());
+  outCD->CopyGlobalIdsOn();
+  outCD->CopyAllocate(input->GetCellData(), numCells);
+  MakeRange(range.GetPointer(), numCells);
+  outCD->CopyData(input->GetCellData(), cellIds.GetPointer(),
+                  range.GetPointer());
+
+  // Polyhedra carry face streams that the cell array does not hold.
+  if (grid && grid->GetFaces())
+  {
+    output->Allocate(numCells);
+    for (vtkIdType i = 0; i < numCells; ++i)
+    {
+      vtkIdType cellId = cellIds->GetId(i);
+      int cellType = grid->GetCellType(cellId);
+      if (cellType == VTK_POLYHEDRON)
+      {
+        grid->GetFaceStream(cellId, ids.GetPointer());
+        vtkUnstructuredGrid::ConvertFaceStreamPointIds(ids.GetPointer(),
+                                                       &pointMap[0]);
+      }
+      else
+      {
+        grid->GetCellPoints(cellId, ids.GetPointer());
+        for (vtkIdType j = 0; j < ids->GetNumberOfIds(); ++j)
+        {
+          ids->SetId(j, pointMap[ids->GetId(j)]);
+        }
+      }
+      output->InsertNextCell(cellType, ids.GetPointer());
+    }
+    return numCells;
+  }
+
+  // Prefix sum of the cell sizes, then parallel gather of the connectivity.
+  vtkNew<vtkIdTypeArray> locations;
+  locations->SetNumberOfValues(numCells + 1);
+  vtkIdType *locs = locations->GetPointer(0);
+  locs[0] = 0;
+  if (numCells > 0)
+  {
+    CountConnectivity countConn(input, cellIds->GetPointer(0), locs + 1);
+    vtkSMPTools::For(0, numCells, countConn);
+  }
+  std::partial_sum(locs, locs + numCells + 1, locs);
+
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(locs[numCells]);
+  vtkNew<vtkUnsignedCharArray> types;
+  types->SetNumberOfValues(numCells);
+  if (numCells > 0)
+  {
+    FillConnectivity fillConn(input, cellIds->GetPointer(0), locs,
+                              numInPts > 0 ? &pointMap[0] : NULL,
+                              connectivity->GetPointer(0),
+                              types->GetPointer(0));
+    vtkSMPTools::For(0, numCells, fillConn);
+  }
+  locations->SetNumberOfValues(numCells);
+
+  vtkNew<vtkCellArray> cellArray;
+  cellArray->SetCells(numCells, connectivity.GetPointer());
+  output->SetCells(types.GetPointer(), locations.GetPointer(),
+                   cellArray.GetPointer());
+
+  return numCells;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellSubsetExtractor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Output Points Precision: " << this->OutputPointsPrecision
+     << "\n";
+}
@@ -0,0 +1,95 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellSubsetExtractor.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkCellSubsetExtractor
+ * @brief   copy a subset of the cells of a dataset into an unstructured grid
+ *
+ * vtkCellSubsetExtractor is a helper object for the filters that subset a
+ * vtkDataSet into a vtkUnstructuredGrid (vtkThreshold, vtkExtractCells,
+ * vtkExtractGeometry). Given one flag per input cell, it compacts the
+ * flagged cells and the points they use with parallel prefix sums, then
+ * gathers the points, the connectivity and the point and cell data with
+ * vtkSMPTools. Cells and points keep their relative input order, so the
+ * output does not depend on the number of threads.
+ *
+ * @warning
+ * The cells are read with the thread safe accessors of vtkDataSet
+ * (GetCellPoints(), GetCellType() and GetPoint()). Polyhedra are copied
+ * serially with their face streams.
+ *
+ * @sa
+ * vtkThreshold vtkExtractCells vtkExtractGeometry vtkSMPTools
+*/
+
+#ifndef vtkCellSubsetExtractor_h
+#define vtkCellSubsetExtractor_h
+
+#include "vtkFiltersCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class vtkDataSet;
+class vtkIdList;
+class vtkUnstructuredGrid;
+
+class VTKFILTERSCORE_EXPORT vtkCellSubsetExtractor : public vtkObject
+{
+public:
+  static vtkCellSubsetExtractor *New();
+  vtkTypeMacro(vtkCellSubsetExtractor,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Set/get the desired precision for the output points. See the
+   * documentation for the vtkAlgorithm::DesiredOutputPrecision enum for an
+   * explanation of the available precision settings. The default keeps the
+   * precision of the input points, or uses float for implicit points.
+   */
+  vtkSetMacro(OutputPointsPrecision,int);
+  vtkGetMacro(OutputPointsPrecision,int);
+  //@}
+
+  /**
+   * Replace the content of output by the cells of input whose entry in
+   * cellMask (one entry per input cell) is non-zero, the points they use,
+   * and the point and cell data of both. If pointMask is not NULL, the
+   * points whose entry is non-zero are copied as well even when no
+   * extracted cell uses them. Global ids are copied. Returns the number of
+   * extracted cells.
+   */
+  vtkIdType ExtractMarkedCells(vtkDataSet *input,
+                               const unsigned char *cellMask,
+                               const unsigned char *pointMask,
+                               vtkUnstructuredGrid *output);
+
+  /**
+   * Fill ids with the indices of the non-zero entries of mask, in
+   * increasing order, using a parallel prefix sum over blocks of the mask.
+   */
+  static void CompactMask(const unsigned char *mask, vtkIdType size,
+                          vtkIdList *ids);
+
+protected:
+  vtkCellSubsetExtractor();
+  ~vtkCellSubsetExtractor() VTK_OVERRIDE;
+
+  int OutputPointsPrecision;
+
+private:
+  vtkCellSubsetExtractor(const vtkCellSubsetExtractor&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkCellSubsetExtractor&) VTK_DELETE_FUNCTION;
+};
+
+#endif
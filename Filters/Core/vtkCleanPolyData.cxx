@@ -22,9 +22,14 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticPointLocator.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkIncrementalPointLocator.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkCleanPolyData);
 
 //---------------------------------------------------------------------------
@@ -46,6 +51,7 @@ vtkCleanPolyData::vtkCleanPolyData()
   this->Locator = NULL;
   this->PieceInvariant = 1;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = false;
 }
 
 //--------------------------------------------------------------------------
@@ -73,6 +79,104 @@ void vtkCleanPolyData::OperateOnBounds(double in[6], double out[6])
   out[5] = in[5];
 }
 
+namespace
+{
+
+// Apply OperateOnPoint() to the used points, in parallel.
+class vtkCleanPolyDataMapPoints
+{
+public:
+  vtkCleanPolyData *Self;
+  vtkPoints *InPts;
+  const vtkIdType *UsedIds;
+  double *Mapped;
+
+  vtkCleanPolyDataMapPoints(vtkCleanPolyData *self, vtkPoints *inPts,
+                            const vtkIdType *usedIds, double *mapped) :
+    Self(self), InPts(inPts), UsedIds(usedIds), Mapped(mapped)
+  {
+  }
+
+  void operator()(vtkIdType id, vtkIdType end)
+  {
+    double x[3];
+    for ( ; id < end; ++id )
+    {
+      this->InPts->GetPoint(this->UsedIds[id], x);
+      this->Self->OperateOnPoint(x, this->Mapped + 3*id);
+    }
+  }
+};
+
+// Append the points used by the cells of a cell array to usedIds, in the
+// order of their first use.
+void vtkCleanPolyDataAddUsed(vtkCellArray *cells, std::vector<char> &used,
+                             std::vector<vtkIdType> &usedIds)
+{
+  vtkIdType npts = 0;
+  vtkIdType *pts = 0;
+  for ( cells->InitTraversal(); cells->GetNextCell(npts,pts); )
+  {
+    for ( vtkIdType i=0; i < npts; ++i )
+    {
+      if ( !used[pts[i]] )
+      {
+        used[pts[i]] = 1;
+        usedIds.push_back(pts[i]);
+      }
+    }
+  }
+}
+
+}
+
+//--------------------------------------------------------------------------
+// Map each used input point to the used point it merges into, or to -1 if
+// it is not used. The mapped points are binned and sorted by a
+// vtkStaticPointLocator, which merges them greedily in the order the cells
+// use them, the order in which the serial filter inserts them.
+void vtkCleanPolyData::MergePointsSMP(vtkPolyData *input, double tol,
+                                      vtkIdType *mergeMap)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  std::vector<char> used(numPts, 0);
+  std::vector<vtkIdType> usedIds;
+  vtkCleanPolyDataAddUsed(input->GetVerts(), used, usedIds);
+  vtkCleanPolyDataAddUsed(input->GetLines(), used, usedIds);
+  vtkCleanPolyDataAddUsed(input->GetPolys(), used, usedIds);
+  vtkCleanPolyDataAddUsed(input->GetStrips(), used, usedIds);
+
+  std::fill_n(mergeMap, numPts, -1);
+  vtkIdType numUsed = static_cast<vtkIdType>(usedIds.size());
+  if ( numUsed == 0 )
+  {
+    return;
+  }
+
+  vtkPoints *mapped = vtkPoints::New(VTK_DOUBLE);
+  mapped->SetNumberOfPoints(numUsed);
+  vtkCleanPolyDataMapPoints mapper(this, input->GetPoints(), &usedIds[0],
+    static_cast<double*>(mapped->GetVoidPointer(0)));
+  vtkSMPTools::For(0, numUsed, mapper);
+
+  vtkPolyData *cloud = vtkPolyData::New();
+  cloud->SetPoints(mapped);
+  mapped->Delete();
+  vtkStaticPointLocator *locator = vtkStaticPointLocator::New();
+  locator->SetDataSet(cloud);
+  locator->BuildLocator();
+
+  std::vector<vtkIdType> merged(numUsed);
+  locator->MergePoints(tol, &merged[0]);
+  for ( vtkIdType id=0; id < numUsed; ++id )
+  {
+    mergeMap[usedIds[id]] = usedIds[merged[id]];
+  }
+
+  locator->Delete();
+  cloud->Delete();
+}
+
 //--------------------------------------------------------------------------
 int vtkCleanPolyData::RequestUpdateExtent(
   vtkInformation *vtkNotUsed(request),
@@ -168,7 +272,8 @@ int vtkCleanPolyData::RequestData(
   vtkIdType *pts = 0;
   double x[3];
   double newx[3];
-  vtkIdType *pointMap=0; //used if no merging
+  vtkIdType *pointMap=0; //used if no merging or threaded merging
+  vtkIdType *mergeMap=0; //used if threaded merging
 
   vtkCellArray *inVerts  = input->GetVerts(),  *newVerts  = NULL;
   vtkCellArray *inLines  = input->GetLines(),  *newLines  = NULL;
@@ -180,7 +285,7 @@ int vtkCleanPolyData::RequestData(
 
   // We must be careful to 'operate' on the bounds of the locator so
   // that all inserted points lie inside it
-  if ( this->PointMerging )
+  if ( this->PointMerging && !this->EnableSMP )
   {
     this->CreateDefaultLocator(input);
     if (this->ToleranceIsAbsolute)
@@ -203,6 +308,13 @@ int vtkCleanPolyData::RequestData(
     {
       pointMap[i] = -1; //initialize unused
     }
+    if ( this->PointMerging )
+    {
+      mergeMap = new vtkIdType [numPts];
+      this->MergePointsSMP(input, this->ToleranceIsAbsolute ?
+        this->AbsoluteTolerance : this->Tolerance*input->GetLength(),
+        mergeMap);
+    }
   }
 
   vtkPointData *outputPD = output->GetPointData();
@@ -237,20 +349,26 @@ int vtkCleanPolyData::RequestData(
     {
       for ( numNewPts=0, i=0; i < npts; i++ )
       {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( pointMap )
         {
-          if ( (ptId=pointMap[pts[i]]) == -1 )
+          vtkIdType inId = ( mergeMap ? mergeMap[pts[i]] : pts[i] );
+          if ( (ptId=pointMap[inId]) == -1 )
           {
-            pointMap[pts[i]] = ptId = numUsedPts++;
+            inPts->GetPoint(inId,x);
+            this->OperateOnPoint(x, newx);
+            pointMap[inId] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
-            outputPD->CopyData(inputPD,pts[i],ptId);
+            outputPD->CopyData(inputPD,inId,ptId);
           }
         }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) )
+        else
         {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) )
+          {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+          }
         }
         updatedPts[numNewPts++] = ptId;
       }//for all points of vertex cell
@@ -282,20 +400,26 @@ int vtkCleanPolyData::RequestData(
     {
       for ( numNewPts=0, i=0; i<npts; i++ )
       {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( pointMap )
         {
-          if ( (ptId=pointMap[pts[i]]) == -1 )
+          vtkIdType inId = ( mergeMap ? mergeMap[pts[i]] : pts[i] );
+          if ( (ptId=pointMap[inId]) == -1 )
           {
-            pointMap[pts[i]] = ptId = numUsedPts++;
+            inPts->GetPoint(inId,x);
+            this->OperateOnPoint(x, newx);
+            pointMap[inId] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
-            outputPD->CopyData(inputPD,pts[i],ptId);
+            outputPD->CopyData(inputPD,inId,ptId);
           }
         }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) )
+        else
         {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) )
+          {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+          }
         }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] )
         {
@@ -348,20 +472,26 @@ int vtkCleanPolyData::RequestData(
     {
       for ( numNewPts=0, i=0; i<npts; i++ )
       {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( pointMap )
         {
-          if ( (ptId=pointMap[pts[i]]) == -1 )
+          vtkIdType inId = ( mergeMap ? mergeMap[pts[i]] : pts[i] );
+          if ( (ptId=pointMap[inId]) == -1 )
           {
-            pointMap[pts[i]] = ptId = numUsedPts++;
+            inPts->GetPoint(inId,x);
+            this->OperateOnPoint(x, newx);
+            pointMap[inId] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
-            outputPD->CopyData(inputPD,pts[i],ptId);
+            outputPD->CopyData(inputPD,inId,ptId);
           }
         }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) )
+        else
         {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) )
+          {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+          }
         }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] )
         {
@@ -434,20 +564,26 @@ int vtkCleanPolyData::RequestData(
     {
       for ( numNewPts=0, i=0; i < npts; i++ )
       {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( pointMap )
         {
-          if ( (ptId=pointMap[pts[i]]) == -1 )
+          vtkIdType inId = ( mergeMap ? mergeMap[pts[i]] : pts[i] );
+          if ( (ptId=pointMap[inId]) == -1 )
           {
-            pointMap[pts[i]] = ptId = numUsedPts++;
+            inPts->GetPoint(inId,x);
+            this->OperateOnPoint(x, newx);
+            pointMap[inId] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
-            outputPD->CopyData(inputPD,pts[i],ptId);
+            outputPD->CopyData(inputPD,inId,ptId);
           }
         }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) )
+        else
         {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) )
+          {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+          }
         }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] )
         {
@@ -525,7 +661,7 @@ int vtkCleanPolyData::RequestData(
   // Update ourselves and release memory
   //
   delete [] updatedPts;
-  if ( this->PointMerging )
+  if ( !pointMap )
   {
     this->Locator->Initialize(); //release memory.
   }
@@ -533,6 +669,7 @@ int vtkCleanPolyData::RequestData(
   {
     newPts->SetNumberOfPoints(numUsedPts);
     delete [] pointMap;
+    delete [] mergeMap;
   }
 
   // Now transfer all CellData from Lines/Polys/Strips into final
@@ -675,6 +812,8 @@ void vtkCleanPolyData::PrintSelf(ostream& os, vtkIndent indent)
      << (this->PieceInvariant ? "On\n" : "Off\n");
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << "\n";
+  os << indent << "Enable SMP: "
+     << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
 //--------------------------------------------------------------------------
@@ -197,6 +197,24 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded point merging. When on, the Locator is not
+   * used: the points are binned and sorted by a vtkStaticPointLocator and
+   * their neighbors within the tolerance are searched in parallel. Points
+   * are then merged in the order the cells use them, as the serial filter
+   * inserts them, so each point merges into an earlier kept point within
+   * the tolerance and never into a farther one. The output matches the
+   * serial one, except that a point within the tolerance of several kept
+   * points merges into the one used first, where the Locator returns the
+   * first one it finds. OperateOnPoint() must be thread safe. Off by
+   * default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkCleanPolyData();
  ~vtkCleanPolyData() VTK_OVERRIDE;
@@ -216,6 +234,11 @@ protected:
 
   int PieceInvariant;
   int OutputPointsPrecision;
+  bool EnableSMP;
+
+  // Threaded point merging used when EnableSMP is on
+  void MergePointsSMP(vtkPolyData *input, double tol, vtkIdType *mergeMap);
+
 private:
   vtkCleanPolyData(const vtkCleanPolyData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCleanPolyData&) VTK_DELETE_FUNCTION;
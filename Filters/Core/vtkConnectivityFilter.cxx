@@ -16,21 +16,67 @@
 
 #include "vtkCell.h"
 #include "vtkCellData.h"
+#include "vtkCellRegionLabeler.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkDataSet.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinks.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkIdTypeArray.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkConnectivityFilter);
 
+namespace
+{
+
+// Flag the entities whose label is set and, if a table of the labels to
+// select is given, selected.
+struct MaskLabels
+{
+  const vtkIdType *Labels;
+  const unsigned char *Selected;
+  unsigned char *Mask;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkIdType label = this->Labels[i];
+      this->Mask[i] = (label >= 0 && (!this->Selected || this->Selected[label]));
+    }
+  }
+};
+
+vtkIdTypeArray *GatherLabels(const unsigned char *mask, vtkIdType size,
+                             const vtkIdType *labels)
+{
+  vtkNew<vtkIdList> ids;
+  vtkCellSubsetExtractor::CompactMask(mask, size, ids.GetPointer());
+  vtkIdTypeArray *gathered = vtkIdTypeArray::New();
+  gathered->SetName("RegionId");
+  gathered->SetNumberOfTuples(ids->GetNumberOfIds());
+  for (vtkIdType i = 0; i < ids->GetNumberOfIds(); ++i)
+  {
+    gathered->SetValue(i, labels[ids->GetId(i)]);
+  }
+  return gathered;
+}
+
+} // end anon namespace
+
 // Construct with default extraction mode to extract largest regions.
 vtkConnectivityFilter::vtkConnectivityFilter()
 {
@@ -57,6 +103,7 @@ vtkConnectivityFilter::vtkConnectivityFilter()
   this->NewCellScalars = 0;
 
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = false;
 }
 
 vtkConnectivityFilter::~vtkConnectivityFilter()
@@ -101,7 +148,6 @@ int vtkConnectivityFilter::RequestData(
     vtkDebugMacro(<<"No data to connect!");
     return 1;
   }
-  output->Allocate(numCells,numCells);
 
   // See whether to consider scalar connectivity
   //
@@ -118,6 +164,12 @@ int vtkConnectivityFilter::RequestData(
     }
   }
 
+  if ( this->EnableSMP )
+  {
+    return this->ExecuteSMP(input, output);
+  }
+  output->Allocate(numCells,numCells);
+
   // Initialize.  Keep track of points and cells visited.
   //
   this->RegionSizes->Reset();
@@ -524,6 +576,162 @@ void vtkConnectivityFilter::TraverseAndMark (vtkDataSet *input)
   return;
 }
 
+// Label the regions with a parallel union-find, then extract the selected
+// cells and the points of all the labeled cells, as the serial traversal
+// does.
+int vtkConnectivityFilter::ExecuteSMP(vtkDataSet *input,
+                                      vtkUnstructuredGrid *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+
+  vtkNew<vtkCellRegionLabeler> labeler;
+  labeler->Initialize(input);
+  vtkStaticCellLinks *links = labeler->GetLinks();
+  this->UpdateProgress(0.1);
+
+  std::vector<unsigned char> connectable;
+  if ( this->InScalars )
+  {
+    connectable.resize(numCells);
+    labeler->MarkScalarConnectedCells(this->InScalars, this->ScalarRange,
+                                      false, &connectable[0]);
+  }
+  const unsigned char *conn = connectable.empty() ? NULL : &connectable[0];
+
+  std::vector<vtkIdType> regionIds(numCells);
+  std::vector<unsigned char> selected;
+  this->RegionSizes->Reset();
+  if ( this->ExtractionMode != VTK_EXTRACT_POINT_SEEDED_REGIONS &&
+       this->ExtractionMode != VTK_EXTRACT_CELL_SEEDED_REGIONS &&
+       this->ExtractionMode != VTK_EXTRACT_CLOSEST_POINT_REGION )
+  {
+    vtkIdType numRegions = labeler->LabelAllRegions(conn, &regionIds[0]);
+    this->RegionSizes->SetNumberOfValues(numRegions);
+    vtkIdType *sizes = this->RegionSizes->GetPointer(0);
+    std::fill_n(sizes, numRegions, 0);
+    for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+      sizes[regionIds[cellId]]++;
+    }
+
+    if ( this->ExtractionMode == VTK_EXTRACT_SPECIFIED_REGIONS )
+    {
+      selected.resize(numRegions, 0);
+      for (vtkIdType i = 0; i < this->SpecifiedRegionIds->GetNumberOfIds(); i++)
+      {
+        vtkIdType regionId = this->SpecifiedRegionIds->GetId(i);
+        if ( regionId >= 0 && regionId < numRegions )
+        {
+          selected[regionId] = 1;
+        }
+      }
+    }
+    else if ( this->ExtractionMode == VTK_EXTRACT_LARGEST_REGION )
+    {
+      // The first of the largest regions, as in the serial traversal.
+      vtkIdType largestRegionId = 0;
+      for (vtkIdType regionId = 1; regionId < numRegions; regionId++)
+      {
+        if ( sizes[regionId] > sizes[largestRegionId] )
+        {
+          largestRegionId = regionId;
+        }
+      }
+      selected.resize(numRegions, 0);
+      selected[largestRegionId] = 1;
+    }
+  }
+  else // regions have been seeded, everything considered in same region
+  {
+    vtkNew<vtkIdList> seedCells;
+    if ( this->ExtractionMode == VTK_EXTRACT_CELL_SEEDED_REGIONS )
+    {
+      seedCells->DeepCopy(this->Seeds);
+    }
+    else
+    {
+      vtkNew<vtkIdList> seedPts;
+      if ( this->ExtractionMode == VTK_EXTRACT_POINT_SEEDED_REGIONS )
+      {
+        seedPts->DeepCopy(this->Seeds);
+      }
+      else
+      { //loop over points, find closest one
+        double minDist2 = VTK_DOUBLE_MAX, dist2, x[3];
+        vtkIdType minId = 0;
+        for (vtkIdType i = 0; i < numPts; i++)
+        {
+          input->GetPoint(i,x);
+          dist2 = vtkMath::Distance2BetweenPoints(x,this->ClosestPoint);
+          if ( dist2 < minDist2 )
+          {
+            minId = i;
+            minDist2 = dist2;
+          }
+        }
+        seedPts->InsertNextId(minId);
+      }
+      for (vtkIdType i = 0; i < seedPts->GetNumberOfIds(); i++)
+      {
+        vtkIdType ptId = seedPts->GetId(i);
+        if ( ptId >= 0 && ptId < numPts )
+        {
+          const vtkIdType *cells = links->GetCells(ptId);
+          vtkIdType ncells = links->GetNumberOfCells(ptId);
+          for (vtkIdType j = 0; j < ncells; j++)
+          {
+            seedCells->InsertNextId(cells[j]);
+          }
+        }
+      }
+    }
+    this->RegionSizes->InsertValue(
+      0, labeler->LabelSeededRegion(conn, seedCells.GetPointer(),
+                                    &regionIds[0]));
+  }
+  this->UpdateProgress(0.6);
+
+  // All the points of the labeled cells are extracted, even the ones of the
+  // regions that are not.
+  std::vector<vtkIdType> pointRegionIds(numPts);
+  labeler->LabelPoints(&regionIds[0], &pointRegionIds[0]);
+  std::vector<unsigned char> cellMask(numCells);
+  std::vector<unsigned char> pointMask(numPts);
+  MaskLabels maskCells = { &regionIds[0],
+                           selected.empty() ? NULL : &selected[0],
+                           &cellMask[0] };
+  vtkSMPTools::For(0, numCells, maskCells);
+  MaskLabels maskPoints = { &pointRegionIds[0], NULL, &pointMask[0] };
+  vtkSMPTools::For(0, numPts, maskPoints);
+
+  vtkNew<vtkCellSubsetExtractor> extractor;
+  extractor->SetOutputPointsPrecision(this->OutputPointsPrecision);
+  extractor->ExtractMarkedCells(input, &cellMask[0], &pointMask[0], output);
+
+  // if coloring regions; send down new scalar data
+  if ( this->ColorRegions )
+  {
+    vtkIdTypeArray *newScalars =
+      GatherLabels(&pointMask[0], numPts, &pointRegionIds[0]);
+    int idx = output->GetPointData()->AddArray(newScalars);
+    output->GetPointData()->SetActiveAttribute(idx,
+                                               vtkDataSetAttributes::SCALARS);
+    newScalars->Delete();
+    vtkIdTypeArray *newCellScalars =
+      GatherLabels(&cellMask[0], numCells, &regionIds[0]);
+    idx = output->GetCellData()->AddArray(newCellScalars);
+    output->GetCellData()->SetActiveAttribute(idx,
+                                              vtkDataSetAttributes::SCALARS);
+    newCellScalars->Delete();
+  }
+
+  vtkDebugMacro (<< "Extracted " << this->GetNumberOfExtractedRegions()
+                 << " region(s) and " << output->GetNumberOfCells()
+                 << " cells");
+  return 1;
+}
+
 // Obtain the number of connected regions.
 int vtkConnectivityFilter::GetNumberOfExtractedRegions()
 {
@@ -597,5 +805,6 @@ void vtkConnectivityFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Scalar Range: (" << range[0] << ", " << range[1] << ")\n";
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
@@ -43,8 +43,15 @@
  * structure. These voxels can then be contoured or processed by other
  * visualization filters.
  *
+ * The regions can be labeled with vtkSMPTools (see EnableSMP), using a
+ * parallel union-find over static cell links. The regions, their numbering
+ * and RegionSizes are the same as the serial traversal's, but the output
+ * points keep the input order and the cell "RegionId" array holds the
+ * region of each output cell, while the serial traversal indexes it by
+ * input cell.
+ *
  * @sa
- * vtkPolyDataConnectivityFilter
+ * vtkPolyDataConnectivityFilter vtkCellRegionLabeler
 */
 
 #ifndef vtkConnectivityFilter_h
@@ -181,6 +188,22 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded labeling of the regions. Cells are joined with
+   * a parallel union-find over static cell links, regions are numbered in
+   * order of their first cell, and the output is gathered with vtkSMPTools.
+   * The same cells are extracted in the same order as with the serial wave
+   * propagation, but the output points keep the input order instead of the
+   * traversal order. When ColorRegions is on, the cell "RegionId" array has
+   * one value per output cell (the serial traversal fills it by input cell
+   * id). Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkConnectivityFilter();
   ~vtkConnectivityFilter() VTK_OVERRIDE;
@@ -203,6 +226,11 @@ protected:
 
   void TraverseAndMark(vtkDataSet *input);
 
+  // Threaded counterpart of RequestData(), once the input is checked.
+  int ExecuteSMP(vtkDataSet *input, vtkUnstructuredGrid *output);
+
+  bool EnableSMP;
+
 private:
   // used to support algorithm execution
   vtkFloatArray *CellScalars;
@@ -14,18 +14,24 @@
 =========================================================================*/
 #include "vtkGlyph3D.h"
 
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
@@ -33,6 +39,8 @@
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkGlyph3D);
 vtkCxxSetObjectMacro(vtkGlyph3D, SourceTransform, vtkTransform);
 
@@ -59,6 +67,8 @@ vtkGlyph3D::vtkGlyph3D()
   this->SetNumberOfInputPorts(2);
   this->FillCellData = 0;
   this->SourceTransform = 0;
+  this->EnableSMP = false;
+  this->GenerateInstances = false;
 
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
@@ -107,6 +117,148 @@ int vtkGlyph3D::RequestData(
   return this->Execute(input, inputVector[1], output)? 1 : 0;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+// The per point glyph parameters, shared by the serial loop and the glyph
+// passes.
+struct GlyphSettings
+{
+  vtkDataArray *SScalars;
+  vtkDataArray *Vectors; // NULL unless the glyphs have vectors
+  int ScaleMode;
+  int IndexMode;
+  int Clamping;
+  int Scaling;
+  int Orient;
+  double Range[2];
+  double Den;
+  double ScaleFactor;
+  int NumberOfSources;
+
+  void Initialize(vtkGlyph3D *self, vtkDataArray *sScalars,
+                  vtkDataArray *vectors, vtkDataArray *normals)
+  {
+    this->SScalars = sScalars;
+    this->Vectors = NULL;
+    if (self->GetVectorMode() == VTK_USE_VECTOR)
+    {
+      this->Vectors = vectors;
+    }
+    else if (self->GetVectorMode() == VTK_USE_NORMAL)
+    {
+      this->Vectors = normals;
+    }
+    this->ScaleMode = self->GetScaleMode();
+    this->IndexMode = self->GetIndexMode();
+    this->Clamping = self->GetClamping();
+    this->Scaling = self->GetScaling();
+    this->Orient = self->GetOrient();
+    self->GetRange(this->Range);
+    this->Den = this->Range[1] - this->Range[0];
+    if (this->Den == 0.0)
+    {
+      this->Den = 1.0;
+    }
+    this->ScaleFactor = self->GetScaleFactor();
+    this->NumberOfSources = self->GetNumberOfInputConnections(1);
+  }
+
+  // Compute the data scale (clamped, before the scale factor) and vector of
+  // a point, and return the index of its source.
+  int Evaluate(vtkIdType ptId, double scale[3], double v[3],
+               double &vMag) const
+  {
+    double s = 0.0;
+    scale[0] = scale[1] = scale[2] = 1.0;
+    v[0] = v[1] = v[2] = 0.0;
+    vMag = 0.0;
+    if (this->SScalars)
+    {
+      s = this->SScalars->GetComponent(ptId, 0);
+      if (this->ScaleMode == VTK_SCALE_BY_SCALAR ||
+          this->ScaleMode == VTK_DATA_SCALING_OFF)
+      {
+        scale[0] = scale[1] = scale[2] = s;
+      }
+    }
+    if (this->Vectors)
+    {
+      this->Vectors->GetTuple(ptId, v);
+      vMag = vtkMath::Norm(v);
+      if (this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS)
+      {
+        scale[0] = v[0];
+        scale[1] = v[1];
+        scale[2] = v[2];
+      }
+      else if (this->ScaleMode == VTK_SCALE_BY_VECTOR)
+      {
+        scale[0] = scale[1] = scale[2] = vMag;
+      }
+    }
+    if (this->Clamping)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        scale[i] = (scale[i] < this->Range[0] ? this->Range[0] :
+                    (scale[i] > this->Range[1] ? this->Range[1] : scale[i]));
+        scale[i] = (scale[i] - this->Range[0]) / this->Den;
+      }
+    }
+    if (this->IndexMode == VTK_INDEXING_OFF)
+    {
+      return 0;
+    }
+    double value = (this->IndexMode == VTK_INDEXING_BY_SCALAR ? s : vMag);
+    int index = static_cast<int>(
+      (value - this->Range[0]) * this->NumberOfSources / this->Den);
+    return (index < 0 ? 0 : (index >= this->NumberOfSources ?
+                             (this->NumberOfSources - 1) : index));
+  }
+
+  // Set trans to the transformation of the glyph at x.
+  void BuildTransform(vtkTransform *trans, const double x[3],
+                      const double dataScale[3], const double v[3],
+                      double vMag) const
+  {
+    trans->Identity();
+    trans->Translate(x[0], x[1], x[2]);
+    if (this->Vectors && this->Orient && vMag > 0.0)
+    {
+      // if there is no y or z component
+      if (v[1] == 0.0 && v[2] == 0.0)
+      {
+        if (v[0] < 0) //just flip x if we need to
+        {
+          trans->RotateWXYZ(180.0, 0, 1, 0);
+        }
+      }
+      else
+      {
+        trans->RotateWXYZ(180.0, (v[0] + vMag) / 2.0, v[1] / 2.0, v[2] / 2.0);
+      }
+    }
+    if (this->Scaling)
+    {
+      double scale[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        scale[i] = (this->ScaleMode == VTK_DATA_SCALING_OFF ?
+                    this->ScaleFactor : dataScale[i] * this->ScaleFactor);
+        if (scale[i] == 0.0)
+        {
+          scale[i] = 1.0e-10;
+        }
+      }
+      trans->Scale(scale[0], scale[1], scale[2]);
+    }
+  }
+};
+
+} // end anon namespace
+
 //----------------------------------------------------------------------------
 bool vtkGlyph3D::Execute(
   vtkDataSet* input,
@@ -149,7 +301,7 @@ bool vtkGlyph3D::Execute(
   vtkDataArray *newVectors=NULL;
   vtkDataArray *newNormals=NULL;
   vtkDataArray *newTCoords = NULL;
-  double x[3], v[3], vNew[3], s = 0.0, vMag = 0.0, value, tc[3];
+  double x[3], v[3], scale[3], vMag = 0.0, tc[3];
   vtkTransform *trans = vtkTransform::New();
   vtkNew<vtkIdList> pointIdList;
   vtkIdList *cellPts;
@@ -157,7 +309,6 @@ bool vtkGlyph3D::Execute(
   vtkIdList *pts;
   vtkIdType ptIncr, cellIncr, cellId;
   int haveVectors, haveNormals, haveTCoords = 0;
-  double scalex,scaley,scalez, den;
   vtkPointData* outputPD = output->GetPointData();
   vtkCellData* outputCD = output->GetCellData();
   int numberOfSources = this->GetNumberOfInputConnections(1);
@@ -207,23 +358,6 @@ bool vtkGlyph3D::Execute(
     return 1;
   }
 
-  // Check input for consistency
-  //
-  if ( (den = this->Range[1] - this->Range[0]) == 0.0 )
-  {
-    den = 1.0;
-  }
-  if ( this->VectorMode != VTK_VECTOR_ROTATION_OFF &&
-       ((this->VectorMode == VTK_USE_VECTOR && inVectors != NULL) ||
-        (this->VectorMode == VTK_USE_NORMAL && inNormals != NULL)) )
-  {
-    haveVectors = 1;
-  }
-  else
-  {
-    haveVectors = 0;
-  }
-
   if ( (this->IndexMode == VTK_INDEXING_BY_SCALAR && !inSScalars) ||
        (this->IndexMode == VTK_INDEXING_BY_VECTOR &&
        ((!inVectors && this->VectorMode == VTK_USE_VECTOR) ||
@@ -243,6 +377,29 @@ bool vtkGlyph3D::Execute(
     }
   }
 
+  // Check input for consistency
+  //
+  GlyphSettings settings;
+  settings.Initialize(this, inSScalars, inVectors, inNormals);
+  haveVectors = settings.Vectors != NULL;
+  if (haveVectors && settings.Vectors->GetNumberOfComponents() > 3)
+  {
+    vtkErrorMacro(<<"vtkDataArray "<<settings.Vectors->GetName()
+                  <<" has more than 3 components.\n");
+    pts->Delete();
+    trans->Delete();
+    return false;
+  }
+
+  if (this->EnableSMP || this->GenerateInstances)
+  {
+    pts->Delete();
+    trans->Delete();
+    return this->ExecuteInPasses(input, sourceVector, output, inSScalars,
+                                 inVectors, inNormals, inCScalars,
+                                 inGhostLevels);
+  }
+
   // Allocate storage for output PolyData
   //
   outputPD->CopyVectorsOff();
@@ -410,7 +567,6 @@ bool vtkGlyph3D::Execute(
   cellIncr=0;
   for (inPtId=0; inPtId < numPts; inPtId++)
   {
-    scalex = scaley = scalez = 1.0;
     if ( ! (inPtId % 10000) )
     {
       this->UpdateProgress(static_cast<double>(inPtId)/numPts);
@@ -420,83 +576,10 @@ bool vtkGlyph3D::Execute(
       }
     }
 
-    // Get the scalar and vector data
-    if ( inSScalars )
-    {
-      s = inSScalars->GetComponent(inPtId, 0);
-      if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
-           this->ScaleMode == VTK_DATA_SCALING_OFF )
-      {
-        scalex = scaley = scalez = s;
-      }
-    }
-
-    if ( haveVectors )
-    {
-      vtkDataArray *array3D = this->VectorMode == VTK_USE_NORMAL? inNormals : inVectors;
-      if(array3D->GetNumberOfComponents()>3)
-      {
-        vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
-        pts->Delete();
-        trans->Delete();
-        if(newPts)
-        {
-          newPts->Delete();
-        }
-        if(newVectors)
-        {
-          newVectors->Delete();
-        }
-        return false;
-      }
-
-      v[0] = 0;
-      v[1] = 0;
-      v[2] = 0;
-      array3D->GetTuple(inPtId, v);
-      vMag = vtkMath::Norm(v);
-      if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
-      {
-        scalex = v[0];
-        scaley = v[1];
-        scalez = v[2];
-      }
-      else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
-      {
-        scalex = scaley = scalez = vMag;
-      }
-    }
-
-    // Clamp data scale if enabled
-    if ( this->Clamping )
-    {
-      scalex = (scalex < this->Range[0] ? this->Range[0] :
-                (scalex > this->Range[1] ? this->Range[1] : scalex));
-      scalex = (scalex - this->Range[0]) / den;
-      scaley = (scaley < this->Range[0] ? this->Range[0] :
-                (scaley > this->Range[1] ? this->Range[1] : scaley));
-      scaley = (scaley - this->Range[0]) / den;
-      scalez = (scalez < this->Range[0] ? this->Range[0] :
-                (scalez > this->Range[1] ? this->Range[1] : scalez));
-      scalez = (scalez - this->Range[0]) / den;
-    }
-
-    // Compute index into table of glyphs
+    // Get the scale, the vector and the index into the table of glyphs
+    int index = settings.Evaluate(inPtId, scale, v, vMag);
     if ( this->IndexMode != VTK_INDEXING_OFF )
     {
-      if ( this->IndexMode == VTK_INDEXING_BY_SCALAR )
-      {
-        value = s;
-      }
-      else
-      {
-        value = vMag;
-      }
-
-      int index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
-      index = (index < 0 ? 0 :
-              (index >= numberOfSources ? (numberOfSources-1) : index));
-
       source = this->GetSource(index, sourceVector);
       if ( source != NULL )
       {
@@ -534,9 +617,6 @@ bool vtkGlyph3D::Execute(
       continue;
     }
 
-    // Now begin copying/transforming glyph
-    trans->Identity();
-
     // Copy all topology (transformation independent)
     for (cellId=0; cellId < numSourceCells; cellId++)
     {
@@ -550,9 +630,9 @@ bool vtkGlyph3D::Execute(
       output->InsertNextCell(source->GetCellType(cellId), pts);
     }
 
-    // translate Source to Input point
+    // translate, orient and scale Source to Input point
     input->GetPoint(inPtId, x);
-    trans->Translate(x[0], x[1], x[2]);
+    settings.BuildTransform(trans, x, scale, v, vMag);
 
     if ( haveVectors )
     {
@@ -561,24 +641,6 @@ bool vtkGlyph3D::Execute(
       {
         newVectors->InsertTuple(i+ptIncr, v);
       }
-      if (this->Orient && (vMag > 0.0))
-      {
-        // if there is no y or z component
-        if ( v[1] == 0.0 && v[2] == 0.0 )
-        {
-          if (v[0] < 0) //just flip x if we need to
-          {
-            trans->RotateWXYZ(180.0,0,1,0);
-          }
-        }
-        else
-        {
-          vNew[0] = (v[0]+vMag) / 2.0;
-          vNew[1] = v[1] / 2.0;
-          vNew[2] = v[2] / 2.0;
-          trans->RotateWXYZ(180.0,vNew[0],vNew[1],vNew[2]);
-        }
-      }
     }
 
     if (haveTCoords)
@@ -590,13 +652,12 @@ bool vtkGlyph3D::Execute(
       }
     }
 
-    // determine scale factor from scalars if appropriate
     // Copy scalar value
     if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE))
     {
       for (i=0; i < numSourcePts; i++)
       {
-        newScalars->InsertTuple(i+ptIncr, &scalex); // = scaley = scalez
+        newScalars->InsertTuple(i+ptIncr, scale); // = scale[1] = scale[2]
       }
     }
     else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR))
@@ -614,35 +675,6 @@ bool vtkGlyph3D::Execute(
       }
     }
 
-    // scale data if appropriate
-    if ( this->Scaling )
-    {
-      if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
-      {
-        scalex = scaley = scalez = this->ScaleFactor;
-      }
-      else
-      {
-        scalex *= this->ScaleFactor;
-        scaley *= this->ScaleFactor;
-        scalez *= this->ScaleFactor;
-      }
-
-      if ( scalex == 0.0 )
-      {
-        scalex = 1.0e-10;
-      }
-      if ( scaley == 0.0 )
-      {
-        scaley = 1.0e-10;
-      }
-      if ( scalez == 0.0 )
-      {
-        scalez = 1.0e-10;
-      }
-      trans->Scale(scalex,scaley,scalez);
-    }
-
     // multiply points and normals by resulting matrix
     if (this->SourceTransform)
     {
@@ -732,6 +764,735 @@ bool vtkGlyph3D::Execute(
   return true;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+// The geometry of one source, with the SourceTransform applied to its points.
+struct GlyphSource
+{
+  vtkIdType NumberOfPoints;
+  std::vector<double> Points;
+  std::vector<double> Normals; // empty when the glyphs have no normals
+  vtkDataArray *TCoords;
+  // connectivity of the verts, lines, polys and strips
+  const vtkIdType *Cells[4];
+  vtkIdType NumberOfEntries[4];
+  vtkIdType NumberOfCells[4];
+};
+
+vtkCellArray *GetCellsOfType(vtkPolyData *pd, int type)
+{
+  switch (type)
+  {
+    case 0:
+      return pd->GetVerts();
+    case 1:
+      return pd->GetLines();
+    case 2:
+      return pd->GetPolys();
+    default:
+      return pd->GetStrips();
+  }
+}
+
+// Compute the source index of each input point.
+struct ComputeSourceIndices
+{
+  const GlyphSettings *Settings;
+  int *Indices;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double scale[3], v[3], vMag;
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      this->Indices[ptId] = this->Settings->Evaluate(ptId, scale, v, vMag);
+    }
+  }
+};
+
+// Fill the geometry and attributes of the glyphs at their precomputed
+// offsets in the output.
+struct GenerateGlyphs
+{
+  vtkDataSet *Input;
+  const GlyphSettings *Settings;
+  const GlyphSource *Sources;
+  const vtkIdType *GlyphPoints; // input point of each glyph
+  const int *GlyphIndices; // source of each glyph
+  const vtkIdType *PointOffsets;
+  const vtkIdType *ConnectivityOffsets[4];
+  float *Points;
+  float *Normals;
+  float *Vectors;
+  float *Scalars; // scale or vector magnitude
+  bool ScalarsAreVectorMagnitudes;
+  float *TCoords;
+  int NumberOfTCoordComponents;
+  vtkIdType *PointIds;
+  vtkIdType *Connectivity[4];
+  vtkSMPThreadLocalObject<vtkTransform> Transform;
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkTransform *trans = this->Transform.Local();
+    double x[3], scale[3], v[3], vMag, normalMatrix[4][4], tc[3];
+    for (vtkIdType g = begin; g < end; ++g)
+    {
+      vtkIdType ptId = this->GlyphPoints[g];
+      const GlyphSource &source = this->Sources[this->GlyphIndices[g]];
+      this->Settings->Evaluate(ptId, scale, v, vMag);
+      this->Input->GetPoint(ptId, x);
+      this->Settings->BuildTransform(trans, x, scale, v, vMag);
+      double (*matrix)[4] = trans->GetMatrix()->Element;
+
+      vtkIdType ptIncr = this->PointOffsets[g];
+      vtkIdType numSourcePts = source.NumberOfPoints;
+      const double *p = source.Points.empty() ? NULL : &source.Points[0];
+      float *outPt = this->Points + 3 * ptIncr;
+      for (vtkIdType i = 0; i < numSourcePts; ++i, p += 3, outPt += 3)
+      {
+        outPt[0] = static_cast<float>(
+          matrix[0][0]*p[0]+matrix[0][1]*p[1]+matrix[0][2]*p[2]+matrix[0][3]);
+        outPt[1] = static_cast<float>(
+          matrix[1][0]*p[0]+matrix[1][1]*p[1]+matrix[1][2]*p[2]+matrix[1][3]);
+        outPt[2] = static_cast<float>(
+          matrix[2][0]*p[0]+matrix[2][1]*p[1]+matrix[2][2]*p[2]+matrix[2][3]);
+      }
+
+      if (this->Normals)
+      {
+        // to transform the normals, multiply by the transposed inverse matrix
+        vtkMatrix4x4::DeepCopy(*normalMatrix, trans->GetMatrix());
+        vtkMatrix4x4::Invert(*normalMatrix, *normalMatrix);
+        vtkMatrix4x4::Transpose(*normalMatrix, *normalMatrix);
+        const double *n = numSourcePts ? &source.Normals[0] : NULL;
+        float *outN = this->Normals + 3 * ptIncr;
+        for (vtkIdType i = 0; i < numSourcePts; ++i, n += 3, outN += 3)
+        {
+          for (int j = 0; j < 3; ++j)
+          {
+            outN[j] = static_cast<float>(normalMatrix[j][0]*n[0] +
+                                         normalMatrix[j][1]*n[1] +
+                                         normalMatrix[j][2]*n[2]);
+          }
+          vtkMath::Normalize(outN);
+        }
+      }
+
+      for (vtkIdType i = ptIncr; i < ptIncr + numSourcePts; ++i)
+      {
+        if (this->Vectors)
+        {
+          for (int j = 0; j < 3; ++j)
+          {
+            this->Vectors[3 * i + j] = static_cast<float>(v[j]);
+          }
+        }
+        if (this->Scalars)
+        {
+          this->Scalars[i] = static_cast<float>(
+            this->ScalarsAreVectorMagnitudes ? vMag : scale[0]);
+        }
+        if (this->PointIds)
+        {
+          this->PointIds[i] = ptId;
+        }
+      }
+
+      if (this->TCoords)
+      {
+        int numComps = this->NumberOfTCoordComponents;
+        float *outTc = this->TCoords + numComps * ptIncr;
+        for (vtkIdType i = 0; i < numSourcePts; ++i)
+        {
+          source.TCoords->GetTuple(i, tc);
+          for (int j = 0; j < numComps; ++j)
+          {
+            *outTc++ = static_cast<float>(tc[j]);
+          }
+        }
+      }
+
+      // Copy the topology, offset to the points of the glyph.
+      for (int type = 0; type < 4; ++type)
+      {
+        const vtkIdType *cells = source.Cells[type];
+        const vtkIdType *cellsEnd = cells + source.NumberOfEntries[type];
+        vtkIdType *outCells =
+          this->Connectivity[type] + this->ConnectivityOffsets[type][g];
+        while (cells < cellsEnd)
+        {
+          vtkIdType npts = *cells++;
+          *outCells++ = npts;
+          for (vtkIdType i = 0; i < npts; ++i)
+          {
+            *outCells++ = *cells++ + ptIncr;
+          }
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// Compute the point, transformation and attributes of each instance.
+struct GenerateGlyphInstances
+{
+  vtkDataSet *Input;
+  const GlyphSettings *Settings;
+  const double *SourceMatrix; // NULL without SourceTransform
+  const vtkIdType *GlyphPoints;
+  const int *GlyphIndices;
+  float *Points;
+  double *Transforms;
+  int *SourceIndices;
+  float *Vectors;
+  float *Scalars;
+  bool ScalarsAreVectorMagnitudes;
+  vtkIdType *PointIds;
+  vtkIdType *Connectivity;
+  vtkSMPThreadLocalObject<vtkTransform> Transform;
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkTransform *trans = this->Transform.Local();
+    double x[3], scale[3], v[3], vMag;
+    for (vtkIdType g = begin; g < end; ++g)
+    {
+      vtkIdType ptId = this->GlyphPoints[g];
+      this->Settings->Evaluate(ptId, scale, v, vMag);
+      this->Input->GetPoint(ptId, x);
+      this->Settings->BuildTransform(trans, x, scale, v, vMag);
+
+      double *matrix = this->Transforms + 16 * g;
+      if (this->SourceMatrix)
+      {
+        vtkMatrix4x4::Multiply4x4(*trans->GetMatrix()->Element,
+                                  this->SourceMatrix, matrix);
+      }
+      else
+      {
+        vtkMatrix4x4::DeepCopy(matrix, trans->GetMatrix());
+      }
+
+      for (int j = 0; j < 3; ++j)
+      {
+        this->Points[3 * g + j] = static_cast<float>(x[j]);
+        if (this->Vectors)
+        {
+          this->Vectors[3 * g + j] = static_cast<float>(v[j]);
+        }
+      }
+      this->SourceIndices[g] = this->GlyphIndices[g];
+      if (this->Scalars)
+      {
+        this->Scalars[g] = static_cast<float>(
+          this->ScalarsAreVectorMagnitudes ? vMag : scale[0]);
+      }
+      if (this->PointIds)
+      {
+        this->PointIds[g] = ptId;
+      }
+      this->Connectivity[2 * g] = 1;
+      this->Connectivity[2 * g + 1] = g;
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// Run a glyph pass over [0, n), with vtkSMPTools when threaded.
+template <typename Functor>
+void RunPass(bool threaded, vtkIdType n, Functor &functor)
+{
+  if (threaded)
+  {
+    vtkSMPTools::For(0, n, functor);
+  }
+  else
+  {
+    functor(0, n);
+  }
+}
+
+void MakeRange(vtkIdList *ids, vtkIdType n)
+{
+  ids->SetNumberOfIds(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    ids->SetId(i, i);
+  }
+}
+
+} // end anon namespace
+
+//----------------------------------------------------------------------------
+// The glyphs are generated in three passes: the source index of each point
+// is computed, then the points to glyph and the output offsets of their
+// glyphs are gathered serially (IsPointVisible() may not be thread safe),
+// and finally the glyphs are filled. The first and last passes are threaded
+// when EnableSMP is on.
+bool vtkGlyph3D::ExecuteInPasses(
+  vtkDataSet* input,
+  vtkInformationVector* sourceVector,
+  vtkPolyData* output,
+  vtkDataArray *inSScalars,
+  vtkDataArray *inVectors,
+  vtkDataArray *inNormals,
+  vtkDataArray *inCScalars,
+  unsigned char *inGhostLevels)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  int numberOfSources = this->GetNumberOfInputConnections(1);
+  vtkPointData *pd = input->GetPointData();
+  vtkPointData* outputPD = output->GetPointData();
+  vtkCellData* outputCD = output->GetCellData();
+  vtkUniformGrid* inputUG = vtkUniformGrid::SafeDownCast(input);
+  bool instances = this->GenerateInstances;
+
+  GlyphSettings settings;
+  settings.Initialize(this, inSScalars, inVectors, inNormals);
+  bool haveVectors = settings.Vectors != NULL;
+
+  // Gather the sources. Without indexing, the first source is glyphed, or a
+  // line along x if there is none.
+  vtkSmartPointer<vtkPolyData> defaultSource;
+  std::vector<vtkPolyData*> sourceData;
+  if (this->IndexMode != VTK_INDEXING_OFF)
+  {
+    for (int i = 0; i < numberOfSources; ++i)
+    {
+      sourceData.push_back(this->GetSource(i, sourceVector));
+    }
+  }
+  else
+  {
+    vtkPolyData *source = this->GetSource(0, sourceVector);
+    if (!source)
+    {
+      defaultSource = vtkSmartPointer<vtkPolyData>::New();
+      vtkNew<vtkPoints> defaultPoints;
+      defaultPoints->InsertNextPoint(0, 0, 0);
+      defaultPoints->InsertNextPoint(1, 0, 0);
+      vtkNew<vtkCellArray> defaultLines;
+      defaultLines->InsertNextCell(2);
+      defaultLines->InsertCellPoint(0);
+      defaultLines->InsertCellPoint(1);
+      defaultSource->SetPoints(defaultPoints.GetPointer());
+      defaultSource->SetLines(defaultLines.GetPointer());
+      source = defaultSource;
+    }
+    sourceData.push_back(source);
+  }
+
+  bool haveNormals = !instances;
+  bool haveTCoords = !instances && this->IndexMode == VTK_INDEXING_OFF;
+  for (size_t i = 0; i < sourceData.size(); ++i)
+  {
+    if (sourceData[i])
+    {
+      haveNormals = haveNormals &&
+        sourceData[i]->GetPointData()->GetNormals() != NULL;
+      haveTCoords = haveTCoords &&
+        sourceData[i]->GetPointData()->GetTCoords() != NULL;
+    }
+  }
+
+  std::vector<GlyphSource> sources(sourceData.size());
+  for (size_t i = 0; i < sourceData.size() && !instances; ++i)
+  {
+    vtkPolyData *source = sourceData[i];
+    GlyphSource &glyphSource = sources[i];
+    glyphSource.NumberOfPoints = 0;
+    glyphSource.TCoords = NULL;
+    for (int type = 0; type < 4; ++type)
+    {
+      glyphSource.Cells[type] = NULL;
+      glyphSource.NumberOfEntries[type] = 0;
+      glyphSource.NumberOfCells[type] = 0;
+    }
+    if (!source || !source->GetPoints())
+    {
+      continue;
+    }
+
+    vtkNew<vtkPoints> sourcePts;
+    sourcePts->SetDataTypeToDouble();
+    if (this->SourceTransform)
+    {
+      this->SourceTransform->TransformPoints(source->GetPoints(),
+                                             sourcePts.GetPointer());
+    }
+    else
+    {
+      sourcePts->DeepCopy(source->GetPoints());
+    }
+    vtkIdType numSourcePts = sourcePts->GetNumberOfPoints();
+    glyphSource.NumberOfPoints = numSourcePts;
+    glyphSource.Points.resize(3 * numSourcePts);
+    for (vtkIdType j = 0; j < numSourcePts; ++j)
+    {
+      sourcePts->GetPoint(j, &glyphSource.Points[3 * j]);
+    }
+    if (haveNormals)
+    {
+      vtkDataArray *sourceNormals = source->GetPointData()->GetNormals();
+      glyphSource.Normals.resize(3 * numSourcePts);
+      for (vtkIdType j = 0; j < numSourcePts; ++j)
+      {
+        sourceNormals->GetTuple(j, &glyphSource.Normals[3 * j]);
+      }
+    }
+    if (haveTCoords)
+    {
+      glyphSource.TCoords = source->GetPointData()->GetTCoords();
+    }
+    for (int type = 0; type < 4; ++type)
+    {
+      vtkCellArray *cells = GetCellsOfType(source, type);
+      glyphSource.NumberOfCells[type] = cells->GetNumberOfCells();
+      glyphSource.NumberOfEntries[type] =
+        cells->GetNumberOfConnectivityEntries();
+      glyphSource.Cells[type] = cells->GetPointer();
+    }
+  }
+
+  // Compute the source index of each point.
+  std::vector<int> indices(numPts, 0);
+  if (this->IndexMode != VTK_INDEXING_OFF)
+  {
+    ComputeSourceIndices computeIndices = { &settings, &indices[0] };
+    RunPass(this->EnableSMP, numPts, computeIndices);
+  }
+
+  // Select the points to glyph and compute the output offsets of their
+  // glyphs.
+  std::vector<vtkIdType> glyphPts;
+  std::vector<int> glyphIndices;
+  std::vector<vtkIdType> ptOffsets(1, 0);
+  std::vector<vtkIdType> connOffsets[4];
+  vtkIdType numCells[4] = { 0, 0, 0, 0 };
+  for (int type = 0; type < 4; ++type)
+  {
+    connOffsets[type].push_back(0);
+  }
+  for (vtkIdType inPtId = 0; inPtId < numPts; ++inPtId)
+  {
+    if ( ! (inPtId % 10000) )
+    {
+      this->UpdateProgress(0.5 * inPtId / numPts);
+      if (this->GetAbortExecute())
+      {
+        break;
+      }
+    }
+    int index = indices[inPtId];
+    if (index < 0 || !sourceData[index] ||
+        (inGhostLevels &&
+         inGhostLevels[inPtId] & vtkDataSetAttributes::DUPLICATEPOINT) ||
+        (inputUG && !inputUG->IsPointVisible(inPtId)) ||
+        !this->IsPointVisible(input, inPtId))
+    {
+      continue;
+    }
+    glyphPts.push_back(inPtId);
+    glyphIndices.push_back(index);
+    if (!instances)
+    {
+      const GlyphSource &source = sources[index];
+      ptOffsets.push_back(ptOffsets.back() + source.NumberOfPoints);
+      for (int type = 0; type < 4; ++type)
+      {
+        connOffsets[type].push_back(
+          connOffsets[type].back() + source.NumberOfEntries[type]);
+        numCells[type] += source.NumberOfCells[type];
+      }
+    }
+  }
+  vtkIdType numGlyphs = static_cast<vtkIdType>(glyphPts.size());
+  vtkIdType numOutPts = instances ? numGlyphs : ptOffsets.back();
+
+  // Allocate the output. The input point data is copied only without
+  // indexing, as the serial implementation does.
+  if (this->IndexMode == VTK_INDEXING_OFF || instances)
+  {
+    outputPD->CopyVectorsOff();
+    outputPD->CopyNormalsOff();
+    outputPD->CopyTCoordsOff();
+    outputPD->CopyAllocate(pd, numOutPts);
+  }
+  else
+  {
+    pd = NULL;
+  }
+
+  vtkNew<vtkPoints> newPts;
+  newPts->SetNumberOfPoints(numOutPts);
+  float *outPts = static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0);
+
+  vtkIdTypeArray *pointIds = NULL;
+  if ( this->GeneratePointIds )
+  {
+    pointIds = vtkIdTypeArray::New();
+    pointIds->SetName(this->PointIdsName);
+    pointIds->SetNumberOfTuples(numOutPts);
+    outputPD->AddArray(pointIds);
+    pointIds->Delete();
+  }
+
+  vtkSmartPointer<vtkDataArray> newScalars;
+  vtkFloatArray *floatScalars = NULL;
+  if ( this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars )
+  {
+    newScalars.TakeReference(inCScalars->NewInstance());
+    newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
+    newScalars->SetName(inCScalars->GetName());
+  }
+  else if ( (this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars)
+  {
+    floatScalars = vtkFloatArray::New();
+    floatScalars->SetName("GlyphScale");
+    if (this->ScaleMode == VTK_SCALE_BY_SCALAR)
+    {
+      floatScalars->SetName(inSScalars->GetName());
+    }
+  }
+  else if ( (this->ColorMode == VTK_COLOR_BY_VECTOR) && haveVectors)
+  {
+    floatScalars = vtkFloatArray::New();
+    floatScalars->SetName("VectorMagnitude");
+  }
+  if (floatScalars)
+  {
+    floatScalars->SetNumberOfTuples(numOutPts);
+    newScalars.TakeReference(floatScalars);
+  }
+
+  vtkSmartPointer<vtkFloatArray> newVectors;
+  if ( haveVectors )
+  {
+    newVectors = vtkSmartPointer<vtkFloatArray>::New();
+    newVectors->SetNumberOfComponents(3);
+    newVectors->SetNumberOfTuples(numOutPts);
+    newVectors->SetName("GlyphVector");
+  }
+  vtkSmartPointer<vtkFloatArray> newNormals;
+  if ( haveNormals )
+  {
+    newNormals = vtkSmartPointer<vtkFloatArray>::New();
+    newNormals->SetNumberOfComponents(3);
+    newNormals->SetNumberOfTuples(numOutPts);
+    newNormals->SetName("Normals");
+  }
+  vtkSmartPointer<vtkFloatArray> newTCoords;
+  int numTCoordComps = 0;
+  if ( haveTCoords )
+  {
+    numTCoordComps =
+      sourceData[0]->GetPointData()->GetTCoords()->GetNumberOfComponents();
+    newTCoords = vtkSmartPointer<vtkFloatArray>::New();
+    newTCoords->SetNumberOfComponents(numTCoordComps);
+    newTCoords->SetNumberOfTuples(numOutPts);
+    newTCoords->SetName("TCoords");
+  }
+
+  vtkIdTypeArray *conn[4];
+  for (int type = 0; type < 4; ++type)
+  {
+    conn[type] = vtkIdTypeArray::New();
+  }
+  vtkSmartPointer<vtkDoubleArray> glyphTransforms;
+  vtkSmartPointer<vtkIntArray> glyphSourceIndices;
+
+  // Fill the glyphs.
+  if (instances)
+  {
+    glyphTransforms = vtkSmartPointer<vtkDoubleArray>::New();
+    glyphTransforms->SetName("GlyphTransform");
+    glyphTransforms->SetNumberOfComponents(16);
+    glyphTransforms->SetNumberOfTuples(numGlyphs);
+    glyphSourceIndices = vtkSmartPointer<vtkIntArray>::New();
+    glyphSourceIndices->SetName("GlyphSourceIndex");
+    glyphSourceIndices->SetNumberOfTuples(numGlyphs);
+    conn[0]->SetNumberOfTuples(2 * numGlyphs);
+    numCells[0] = numGlyphs;
+
+    double sourceMatrix[16];
+    if (this->SourceTransform)
+    {
+      vtkMatrix4x4::DeepCopy(sourceMatrix,
+                             this->SourceTransform->GetMatrix());
+    }
+    GenerateGlyphInstances generate;
+    generate.Input = input;
+    generate.Settings = &settings;
+    generate.SourceMatrix = this->SourceTransform ? sourceMatrix : NULL;
+    generate.GlyphPoints = numGlyphs ? &glyphPts[0] : NULL;
+    generate.GlyphIndices = numGlyphs ? &glyphIndices[0] : NULL;
+    generate.Points = outPts;
+    generate.Transforms = glyphTransforms->GetPointer(0);
+    generate.SourceIndices = glyphSourceIndices->GetPointer(0);
+    generate.Vectors = newVectors ? newVectors->GetPointer(0) : NULL;
+    generate.Scalars = floatScalars ? floatScalars->GetPointer(0) : NULL;
+    generate.ScalarsAreVectorMagnitudes =
+      this->ColorMode == VTK_COLOR_BY_VECTOR;
+    generate.PointIds = pointIds ? pointIds->GetPointer(0) : NULL;
+    generate.Connectivity = conn[0]->GetPointer(0);
+    RunPass(this->EnableSMP, numGlyphs, generate);
+  }
+  else
+  {
+    GenerateGlyphs generate;
+    generate.Input = input;
+    generate.Settings = &settings;
+    generate.Sources = sources.empty() ? NULL : &sources[0];
+    generate.GlyphPoints = numGlyphs ? &glyphPts[0] : NULL;
+    generate.GlyphIndices = numGlyphs ? &glyphIndices[0] : NULL;
+    generate.PointOffsets = &ptOffsets[0];
+    generate.Points = outPts;
+    generate.Normals = newNormals ? newNormals->GetPointer(0) : NULL;
+    generate.Vectors = newVectors ? newVectors->GetPointer(0) : NULL;
+    generate.Scalars = floatScalars ? floatScalars->GetPointer(0) : NULL;
+    generate.ScalarsAreVectorMagnitudes =
+      this->ColorMode == VTK_COLOR_BY_VECTOR;
+    generate.TCoords = newTCoords ? newTCoords->GetPointer(0) : NULL;
+    generate.NumberOfTCoordComponents = numTCoordComps;
+    generate.PointIds = pointIds ? pointIds->GetPointer(0) : NULL;
+    for (int type = 0; type < 4; ++type)
+    {
+      conn[type]->SetNumberOfTuples(connOffsets[type].back());
+      generate.ConnectivityOffsets[type] = &connOffsets[type][0];
+      generate.Connectivity[type] = conn[type]->GetPointer(0);
+    }
+    RunPass(this->EnableSMP, numGlyphs, generate);
+  }
+  this->UpdateProgress(0.75);
+
+  // Copy the coloring scalars and the point data of the glyphed points.
+  vtkNew<vtkIdList> srcIds;
+  vtkNew<vtkIdList> dstIds;
+  srcIds->SetNumberOfIds(numOutPts);
+  for (vtkIdType g = 0; g < numGlyphs; ++g)
+  {
+    vtkIdType begin = instances ? g : ptOffsets[g];
+    vtkIdType end = instances ? g + 1 : ptOffsets[g + 1];
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      srcIds->SetId(i, glyphPts[g]);
+    }
+  }
+  MakeRange(dstIds.GetPointer(), numOutPts);
+  if (newScalars && !floatScalars)
+  {
+    newScalars->InsertTuples(dstIds.GetPointer(), srcIds.GetPointer(),
+                             inCScalars);
+  }
+  if (pd)
+  {
+    outputPD->CopyData(pd, srcIds.GetPointer(), dstIds.GetPointer());
+  }
+
+  // Output cells are grouped by type, as in any polydata; the cells of a
+  // glyph get the point data of its input point.
+  if (pd && this->FillCellData)
+  {
+    vtkIdType numOutCells = numCells[0] + numCells[1] + numCells[2] +
+      numCells[3];
+    outputCD->CopyAllocate(pd, numOutCells);
+    srcIds->SetNumberOfIds(numOutCells);
+    vtkIdType cellId = 0;
+    for (int type = 0; type < 4; ++type)
+    {
+      for (vtkIdType g = 0; g < numGlyphs; ++g)
+      {
+        vtkIdType n = instances ? (type == 0 ? 1 : 0) :
+          sources[glyphIndices[g]].NumberOfCells[type];
+        for (vtkIdType i = 0; i < n; ++i)
+        {
+          srcIds->SetId(cellId++, glyphPts[g]);
+        }
+      }
+    }
+    MakeRange(dstIds.GetPointer(), numOutCells);
+    outputCD->CopyData(pd, srcIds.GetPointer(), dstIds.GetPointer());
+  }
+
+  // Update ourselves and release memory
+  //
+  output->SetPoints(newPts.GetPointer());
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkCellArray> strips;
+  vtkCellArray *cells[4] = { verts.GetPointer(), lines.GetPointer(),
+                             polys.GetPointer(), strips.GetPointer() };
+  for (int type = 0; type < 4; ++type)
+  {
+    if (numCells[type] > 0)
+    {
+      cells[type]->SetCells(numCells[type], conn[type]);
+    }
+    conn[type]->Delete();
+  }
+  if (numCells[0] > 0)
+  {
+    output->SetVerts(verts.GetPointer());
+  }
+  if (numCells[1] > 0)
+  {
+    output->SetLines(lines.GetPointer());
+  }
+  if (numCells[2] > 0)
+  {
+    output->SetPolys(polys.GetPointer());
+  }
+  if (numCells[3] > 0)
+  {
+    output->SetStrips(strips.GetPointer());
+  }
+
+  if (newScalars)
+  {
+    int idx = outputPD->AddArray(newScalars);
+    outputPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+  }
+  if (newVectors)
+  {
+    outputPD->SetVectors(newVectors);
+  }
+  if (newNormals)
+  {
+    outputPD->SetNormals(newNormals);
+  }
+  if (newTCoords)
+  {
+    outputPD->SetTCoords(newTCoords);
+  }
+  if (instances)
+  {
+    outputPD->AddArray(glyphTransforms);
+    outputPD->AddArray(glyphSourceIndices);
+  }
+  this->UpdateProgress(1.0);
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 // Specify a source object at a specified table location.
 void vtkGlyph3D::SetSourceConnection(int id, vtkAlgorithmOutput* algOutput)
@@ -890,6 +1651,9 @@ void vtkGlyph3D::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << "(none)" << endl;
   }
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "Generate Instances: "
+     << (this->GenerateInstances ? "On\n" : "Off\n");
 }
 
 int vtkGlyph3D::RequestUpdateExtent(
@@ -73,6 +73,15 @@
  * vtkAlgorithm. The first array is scalars, the next vectors, the next
  * normals and finally color scalars.
  *
+ * @warning
+ * With EnableSMP on, the glyphs are generated with vtkSMPTools: the output
+ * offsets of each glyph are computed first, then the points, normals,
+ * connectivity and attributes of all the glyphs are filled concurrently.
+ * IsPointVisible() is still called serially. With GenerateInstances on,
+ * the geometry is not replicated and the output only holds the transform
+ * and source index of each glyph; instances are generated serially unless
+ * EnableSMP is also on.
+ *
  * @sa
  * vtkTensorGlyph
 */
@@ -303,6 +312,31 @@ public:
   vtkGetObjectMacro(SourceTransform, vtkTransform);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. The output is the same as the
+   * serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
+  //@{
+  /**
+   * Turn on/off the instance output. When on, the source geometry is not
+   * copied: the output holds one vertex per glyph, at the input point, with
+   * the input point data and two point data arrays. "GlyphTransform" holds
+   * the 16 components (row major) of the matrix that maps the source points
+   * to the glyph, SourceTransform included, and "GlyphSourceIndex" the index
+   * of the glyph in the table of sources. This is meant for instanced
+   * rendering or export. Off by default.
+   */
+  vtkSetMacro(GenerateInstances, bool);
+  vtkGetMacro(GenerateInstances, bool);
+  vtkBooleanMacro(GenerateInstances, bool);
+  //@}
+
   /**
    * Overridden to include SourceTransform's MTime.
    */
@@ -334,6 +368,18 @@ protected:
                        vtkDataArray *inVectors);
   //@}
 
+  // Glyphing in passes over precomputed output offsets, called by Execute()
+  // once the input arrays are checked when EnableSMP or GenerateInstances is
+  // on. The passes are threaded only when EnableSMP is on.
+  bool ExecuteInPasses(vtkDataSet* input,
+                       vtkInformationVector* sourceVector,
+                       vtkPolyData* output,
+                       vtkDataArray *inSScalars,
+                       vtkDataArray *inVectors,
+                       vtkDataArray *inNormals,
+                       vtkDataArray *inCScalars,
+                       unsigned char *inGhostLevels);
+
   vtkPolyData **Source; // Geometry to copy to each point
   int Scaling; // Determine whether scaling of geometry is performed
   int ScaleMode; // Scale by scalar value or vector magnitude
@@ -348,6 +394,8 @@ protected:
   int FillCellData; // whether to fill output cell data
   char *PointIdsName;
   vtkTransform* SourceTransform;
+  bool EnableSMP;
+  bool GenerateInstances;
 
 private:
   vtkGlyph3D(const vtkGlyph3D&) VTK_DELETE_FUNCTION;
@@ -19,14 +19,24 @@
 #include <limits>
 #include <vector>
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkDataArray.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStructuredGrid.h"
 
 #define VTK_EPSILON 1.e-6
 
@@ -57,7 +67,7 @@ public:
   typedef std::vector<Bin> HistogramBins;
   typedef HistogramBins::iterator BinIt;
 
-  Histogram(vtkIdType size)
+  Histogram(vtkIdType size = 0)
   {
     // Construct the array of bins.
     this->Bins.assign(size + 1, this->Init);
@@ -159,6 +169,7 @@ vtkPointDataToCellData::vtkPointDataToCellData()
 {
   this->PassPointData = 0;
   this->CategoricalData = 0;
+  this->EnableSMP = false;
 }
 
 //----------------------------------------------------------------------------
@@ -232,53 +243,56 @@ int vtkPointDataToCellData::RequestData(
   output->GetCellData()->PassData(input->GetCellData());
   output->GetCellData()->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
 
-  // notice that inPD and outCD are vtkPointData and vtkCellData; respectively.
-  // It's weird, but it works.
-  outCD->InterpolateAllocate(inPD,numCells);
-
-  int abort=0;
-  vtkIdType progressInterval=numCells/20 + 1;
-  for (cellId=0; cellId < numCells && !abort; cellId++)
+  if (!this->EnableSMP || !this->InterpolateCellDataSMP(input, output))
   {
-    if ( !(cellId % progressInterval) )
+    // notice that inPD and outCD are vtkPointData and vtkCellData;
+    // respectively. It's weird, but it works.
+    outCD->InterpolateAllocate(inPD,numCells);
+
+    int abort=0;
+    vtkIdType progressInterval=numCells/20 + 1;
+    for (cellId=0; cellId < numCells && !abort; cellId++)
     {
-      this->UpdateProgress((double)cellId/numCells);
-      abort = GetAbortExecute();
-    }
+      if ( !(cellId % progressInterval) )
+      {
+        this->UpdateProgress((double)cellId/numCells);
+        abort = GetAbortExecute();
+      }
 
-    input->GetCellPoints(cellId, cellPts);
-    numPts = cellPts->GetNumberOfIds();
+      input->GetCellPoints(cellId, cellPts);
+      numPts = cellPts->GetNumberOfIds();
 
-    if (numPts == 0)
-    {
-      continue;
-    }
+      if (numPts == 0)
+      {
+        continue;
+      }
 
-    // If we aren't dealing with categorical data...
-    if (!(this->CategoricalData))
-    {
-      // ...then we simply provide each point with an equal weight value and
-      // interpolate.
-      weight = 1.0 / numPts;
-      for (ptId=0; ptId < numPts; ptId++)
+      // If we aren't dealing with categorical data...
+      if (!(this->CategoricalData))
       {
-        weights[ptId] = weight;
+        // ...then we simply provide each point with an equal weight value and
+        // interpolate.
+        weight = 1.0 / numPts;
+        for (ptId=0; ptId < numPts; ptId++)
+        {
+          weights[ptId] = weight;
+        }
+        outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
       }
-      outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
-    }
-    else
-    {
-      // ...otherwise, we populate a histogram from the scalar values at each
-      // point, and then select the bin with the most elements.
-      hist.Reset(numPts);
-      for (ptId=0; ptId < numPts; ptId++)
+      else
       {
-        pointId = cellPts->GetId(ptId);
-        hist.Fill(pointId,
-                  input->GetPointData()->GetScalars()->GetTuple1(pointId));
+        // ...otherwise, we populate a histogram from the scalar values at each
+        // point, and then select the bin with the most elements.
+        hist.Reset(numPts);
+        for (ptId=0; ptId < numPts; ptId++)
+        {
+          pointId = cellPts->GetId(ptId);
+          hist.Fill(pointId,
+                    input->GetPointData()->GetScalars()->GetTuple1(pointId));
+        }
+
+        outCD->CopyData(inPD, hist.IndexOfLargestBin(), cellId);
       }
-
-      outCD->CopyData(inPD, hist.IndexOfLargestBin(), cellId);
     }
   }
 
@@ -301,4 +315,394 @@ void vtkPointDataToCellData::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Pass Point Data: " << (this->PassPointData ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+// Points of a cell of an image, rectilinear or structured grid, computed
+// from the structured coordinates of the cell. The points are listed in the
+// order of vtkStructuredData::GetCellPoints(), or of
+// vtkStructuredGrid::GetCellPoints() which lists quad and hexahedron
+// corners in cyclic order.
+class StructuredCellPoints
+{
+public:
+  StructuredCellPoints(int dims[3], bool cyclicOrder)
+    : CyclicOrder(cyclicOrder), Empty(false)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      this->Dims[i] = dims[i];
+      this->CellDims[i] = dims[i] > 1 ? dims[i] - 1 : 1;
+      this->Empty = this->Empty || dims[i] < 1;
+    }
+  }
+
+  vtkIdType GetPoints(vtkIdType cellId, const vtkIdType *&pts,
+                      vtkIdType buffer[8]) const
+  {
+    pts = buffer;
+    if (this->Empty)
+    {
+      return 0;
+    }
+    vtkIdType loc[3], maxLoc[3];
+    loc[0] = cellId % this->CellDims[0];
+    loc[1] = (cellId / this->CellDims[0]) % this->CellDims[1];
+    loc[2] = cellId / (this->CellDims[0] * this->CellDims[1]);
+    for (int i = 0; i < 3; ++i)
+    {
+      maxLoc[i] = this->Dims[i] > 1 ? loc[i] + 1 : loc[i];
+    }
+
+    vtkIdType d01 = static_cast<vtkIdType>(this->Dims[0]) * this->Dims[1];
+    vtkIdType npts = 0;
+    for (vtkIdType k = loc[2]; k <= maxLoc[2]; ++k)
+    {
+      for (vtkIdType j = loc[1]; j <= maxLoc[1]; ++j)
+      {
+        for (vtkIdType i = loc[0]; i <= maxLoc[0]; ++i)
+        {
+          buffer[npts++] = i + j*this->Dims[0] + k*d01;
+        }
+      }
+    }
+    if (this->CyclicOrder && npts >= 4)
+    {
+      std::swap(buffer[2], buffer[3]);
+      if (npts == 8)
+      {
+        std::swap(buffer[6], buffer[7]);
+      }
+    }
+    return npts;
+  }
+
+private:
+  int Dims[3];
+  vtkIdType CellDims[3];
+  bool CyclicOrder;
+  bool Empty;
+};
+
+// Points of a cell of any other dataset.
+class DataSetCellPoints
+{
+public:
+  explicit DataSetCellPoints(vtkDataSet *input) : Input(input) {}
+
+  vtkIdType GetPoints(vtkIdType cellId, const vtkIdType *&pts,
+                      vtkIdType *vtkNotUsed(buffer)) const
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    this->Input->GetCellPoints(cellId, cellPts);
+    pts = cellPts->GetPointer(0);
+    return cellPts->GetNumberOfIds();
+  }
+
+private:
+  vtkDataSet *Input;
+  mutable vtkSMPThreadLocalObject<vtkIdList> CellPts;
+};
+
+// Average the tuples of the points of each cell, with the same weights and
+// rounding as vtkDataSetAttributes::InterpolatePoint(). Attributes
+// interpolated by nearest neighbor take the tuple of the last point, as
+// InterpolatePoint() does for equal weights. Empty cells get a null tuple.
+template <typename TopologyT, typename SrcArrayT, typename DstArrayT>
+struct AveragePointTuples
+{
+  const TopologyT *Topology;
+  SrcArrayT *Src;
+  DstArrayT *Dst;
+  bool Nearest;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DstType;
+    vtkDataArrayAccessor<SrcArrayT> s(this->Src);
+    vtkDataArrayAccessor<DstArrayT> d(this->Dst);
+    const int numComps = this->Dst->GetNumberOfComponents();
+    vtkIdType buffer[8];
+    const vtkIdType *pts;
+
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType numPts = this->Topology->GetPoints(cellId, pts, buffer);
+      if (numPts == 0)
+      {
+        for (int c = 0; c < numComps; ++c)
+        {
+          d.Set(cellId, c, static_cast<DstType>(0));
+        }
+      }
+      else if (this->Nearest)
+      {
+        for (int c = 0; c < numComps; ++c)
+        {
+          d.Set(cellId, c, static_cast<DstType>(s.Get(pts[numPts-1], c)));
+        }
+      }
+      else
+      {
+        double weight = 1.0 / numPts;
+        for (int c = 0; c < numComps; ++c)
+        {
+          double val = 0.;
+          for (vtkIdType i = 0; i < numPts; ++i)
+          {
+            val += weight * static_cast<double>(s.Get(pts[i], c));
+          }
+          DstType valT;
+          vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+          d.Set(cellId, c, valT);
+        }
+      }
+    }
+  }
+};
+
+template <typename TopologyT>
+struct AveragePointTuplesWorker
+{
+  const TopologyT *Topology;
+  vtkIdType NumberOfCells;
+  bool Nearest;
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT *src, DstArrayT *dst)
+  {
+    AveragePointTuples<TopologyT, SrcArrayT, DstArrayT> average;
+    average.Topology = this->Topology;
+    average.Src = src;
+    average.Dst = dst;
+    average.Nearest = this->Nearest;
+    vtkSMPTools::For(0, this->NumberOfCells, average);
+  }
+};
+
+// Select the point of each cell holding the majority value of the scalars.
+template <typename TopologyT>
+struct SelectMajorityPoints
+{
+  const TopologyT *Topology;
+  vtkDataArray *Scalars;
+  vtkIdType *PointIds;
+  vtkSMPThreadLocal<Histogram> Histograms;
+
+  SelectMajorityPoints(const TopologyT *topology, vtkDataArray *scalars,
+                       vtkIdType *pointIds, int maxCellSize)
+    : Topology(topology), Scalars(scalars), PointIds(pointIds),
+      Histograms(Histogram(maxCellSize))
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    Histogram &hist = this->Histograms.Local();
+    vtkIdType buffer[8];
+    const vtkIdType *pts;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType numPts = this->Topology->GetPoints(cellId, pts, buffer);
+      if (numPts == 0)
+      {
+        this->PointIds[cellId] = -1;
+        continue;
+      }
+      hist.Reset(numPts);
+      for (vtkIdType i = 0; i < numPts; ++i)
+      {
+        hist.Fill(pts[i], this->Scalars->GetComponent(pts[i], 0));
+      }
+      this->PointIds[cellId] = hist.IndexOfLargestBin();
+    }
+  }
+};
+
+// Interpolate the arrays of interpCD, allocated by InterpolateAllocate(),
+// from the matching arrays of inPD.
+template <typename TopologyT>
+bool AveragePointData(const TopologyT &topology, vtkPointData *inPD,
+                      vtkCellData *interpCD, vtkIdType numCells)
+{
+  AveragePointTuplesWorker<TopologyT> worker;
+  worker.Topology = &topology;
+  worker.NumberOfCells = numCells;
+
+  vtkNew<vtkIdList> ptIds;
+  std::vector<double> weights;
+  for (int i = 0; i < interpCD->GetNumberOfArrays(); ++i)
+  {
+    vtkAbstractArray *dstArray = interpCD->GetAbstractArray(i);
+    int attribute = interpCD->IsArrayAnAttribute(i);
+    vtkAbstractArray *srcArray = dstArray->GetName() ?
+      inPD->GetAbstractArray(dstArray->GetName()) :
+      (attribute >= 0 ? inPD->GetAbstractAttribute(attribute) : NULL);
+    if (!srcArray)
+    {
+      return false;
+    }
+    dstArray->SetNumberOfTuples(numCells);
+    worker.Nearest = attribute >= 0 && interpCD->GetCopyAttribute(
+      attribute, vtkDataSetAttributes::INTERPOLATE) == 2;
+
+    vtkDataArray *src = vtkArrayDownCast<vtkDataArray>(srcArray);
+    vtkDataArray *dst = vtkArrayDownCast<vtkDataArray>(dstArray);
+    if (src && dst &&
+        vtkArrayDispatch::Dispatch2SameValueType::Execute(src, dst, worker))
+    {
+      continue;
+    }
+
+    // Bit arrays, string arrays and other arrays the dispatch does not
+    // know go through the serial vtkAbstractArray API.
+    std::vector<double> nullTuple(dstArray->GetNumberOfComponents(), 0.0);
+    vtkIdType buffer[8];
+    const vtkIdType *pts;
+    for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+    {
+      vtkIdType numPts = topology.GetPoints(cellId, pts, buffer);
+      if (numPts == 0)
+      {
+        if (dst)
+        {
+          dst->SetTuple(cellId, &nullTuple[0]);
+        }
+      }
+      else if (worker.Nearest)
+      {
+        dstArray->InsertTuple(cellId, pts[numPts-1], srcArray);
+      }
+      else
+      {
+        ptIds->SetNumberOfIds(numPts);
+        std::copy(pts, pts + numPts, ptIds->GetPointer(0));
+        weights.assign(numPts, 1.0 / numPts);
+        dstArray->InterpolateTuple(cellId, ptIds.GetPointer(), srcArray,
+                                   &weights[0]);
+      }
+    }
+  }
+  return true;
+}
+
+// Copy to each cell the tuples of its majority point.
+template <typename TopologyT>
+void CopyMajorityPointData(const TopologyT &topology, vtkPointData *inPD,
+                           vtkCellData *interpCD, vtkIdType numCells,
+                           int maxCellSize)
+{
+  vtkNew<vtkIdList> srcIds;
+  srcIds->SetNumberOfIds(numCells);
+  SelectMajorityPoints<TopologyT> select(
+    &topology, inPD->GetScalars(), srcIds->GetPointer(0), maxCellSize);
+  vtkSMPTools::For(0, numCells, select);
+
+  // Empty cells get a null tuple.
+  vtkNew<vtkIdList> dstIds;
+  dstIds->Allocate(numCells);
+  vtkIdType numValid = 0;
+  for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+  {
+    if (srcIds->GetId(cellId) >= 0)
+    {
+      srcIds->SetId(numValid++, srcIds->GetId(cellId));
+      dstIds->InsertNextId(cellId);
+    }
+  }
+  srcIds->SetNumberOfIds(numValid);
+  for (int i = 0; i < interpCD->GetNumberOfArrays(); ++i)
+  {
+    vtkAbstractArray *array = interpCD->GetAbstractArray(i);
+    array->SetNumberOfTuples(numCells);
+    if (vtkDataArray *da = vtkArrayDownCast<vtkDataArray>(array))
+    {
+      for (int c = 0; c < da->GetNumberOfComponents(); ++c)
+      {
+        da->FillComponent(c, 0.0);
+      }
+    }
+  }
+  interpCD->CopyData(inPD, srcIds.GetPointer(), dstIds.GetPointer());
+}
+
+template <typename TopologyT>
+bool MapPointData(const TopologyT &topology, bool categorical,
+                  vtkPointData *inPD, vtkCellData *interpCD,
+                  vtkIdType numCells, int maxCellSize)
+{
+  if (categorical)
+  {
+    CopyMajorityPointData(topology, inPD, interpCD, numCells, maxCellSize);
+    return true;
+  }
+  return AveragePointData(topology, inPD, interpCD, numCells);
+}
+}
+
+//----------------------------------------------------------------------------
+bool vtkPointDataToCellData::InterpolateCellDataSMP(vtkDataSet *input,
+                                                    vtkDataSet *output)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkPointData *inPD = input->GetPointData();
+  vtkCellData *outCD = output->GetCellData();
+
+  // Allocate the interpolated arrays apart from the output, with the same
+  // copy flags, so that each of them can be matched with its point array.
+  vtkNew<vtkCellData> interpCD;
+  interpCD->CopyGlobalIdsOff();
+  interpCD->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
+  interpCD->InterpolateAllocate(inPD, numCells);
+
+  int dims[3];
+  int maxCellSize = input->GetMaxCellSize();
+  bool interpolated;
+  if (vtkImageData *image = vtkImageData::SafeDownCast(input))
+  {
+    image->GetDimensions(dims);
+    interpolated = MapPointData(StructuredCellPoints(dims, false),
+                                this->CategoricalData != 0, inPD,
+                                interpCD.GetPointer(), numCells, maxCellSize);
+  }
+  else if (vtkRectilinearGrid *rGrid = vtkRectilinearGrid::SafeDownCast(input))
+  {
+    rGrid->GetDimensions(dims);
+    interpolated = MapPointData(StructuredCellPoints(dims, false),
+                                this->CategoricalData != 0, inPD,
+                                interpCD.GetPointer(), numCells, maxCellSize);
+  }
+  else if (vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input))
+  {
+    sGrid->GetDimensions(dims);
+    interpolated = MapPointData(StructuredCellPoints(dims, true),
+                                this->CategoricalData != 0, inPD,
+                                interpCD.GetPointer(), numCells, maxCellSize);
+  }
+  else
+  {
+    interpolated = MapPointData(DataSetCellPoints(input),
+                                this->CategoricalData != 0, inPD,
+                                interpCD.GetPointer(), numCells, maxCellSize);
+  }
+  if (!interpolated)
+  {
+    return false;
+  }
+
+  // Add the arrays to the output as InterpolateAllocate() would have.
+  for (int i = 0; i < interpCD->GetNumberOfArrays(); ++i)
+  {
+    int idx = outCD->AddArray(interpCD->GetAbstractArray(i));
+    int attribute = interpCD->IsArrayAnAttribute(i);
+    if (attribute >= 0)
+    {
+      outCD->SetActiveAttribute(idx, attribute);
+    }
+  }
+  this->UpdateProgress(1.0);
+  return true;
 }
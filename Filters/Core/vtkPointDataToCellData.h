@@ -38,6 +38,8 @@
 #include "vtkFiltersCoreModule.h" // For export macro
 #include "vtkDataSetAlgorithm.h"
 
+class vtkDataSet;
+
 class VTKFILTERSCORE_EXPORT vtkPointDataToCellData : public vtkDataSetAlgorithm
 {
 public:
@@ -67,6 +69,19 @@ public:
   vtkBooleanMacro(CategoricalData,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. Cells are processed
+   * concurrently with vtkSMPTools and every data array is averaged by a
+   * kernel specialized for its type. The points of the cells of images,
+   * rectilinear and structured grids are computed from their structured
+   * coordinates. The output is the same as the serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkPointDataToCellData();
   ~vtkPointDataToCellData() VTK_OVERRIDE {}
@@ -75,8 +90,13 @@ protected:
                   vtkInformationVector** inputVector,
                   vtkInformationVector* outputVector) VTK_OVERRIDE;
 
+  // Threaded counterpart of the cell loop of RequestData(). Returns false,
+  // leaving the output untouched, if some point array cannot be handled.
+  bool InterpolateCellDataSMP(vtkDataSet *input, vtkDataSet *output);
+
   int PassPointData;
   int CategoricalData;
+  bool EnableSMP;
 private:
   vtkPointDataToCellData(const vtkPointDataToCellData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPointDataToCellData&) VTK_DELETE_FUNCTION;
@@ -16,6 +16,8 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellRegionLabeler.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkCell.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
@@ -23,14 +25,50 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinks.h"
 
 #include <algorithm> // for fill_n
+#include <vector>
 
 vtkStandardNewMacro(vtkPolyDataConnectivityFilter);
 
+namespace
+{
+
+// Flag the entities whose label is set and, if a table of the labels to
+// select is given, selected.
+struct MaskLabels
+{
+  const vtkIdType *Labels;
+  const unsigned char *Selected;
+  unsigned char *Mask;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkIdType label = this->Labels[i];
+      this->Mask[i] = (label >= 0 && (!this->Selected || this->Selected[label]));
+    }
+  }
+};
+
+void MakeRange(vtkIdList *ids, vtkIdType size)
+{
+  ids->SetNumberOfIds(size);
+  for (vtkIdType i = 0; i < size; ++i)
+  {
+    ids->SetId(i, i);
+  }
+}
+
+} // end anon namespace
+
 // Construct with default extraction mode to extract largest regions.
 vtkPolyDataConnectivityFilter::vtkPolyDataConnectivityFilter()
 {
@@ -58,6 +96,7 @@ vtkPolyDataConnectivityFilter::vtkPolyDataConnectivityFilter()
   this->VisitedPointIds = vtkIdList::New();
 
   this->OutputPointsPrecision = DEFAULT_PRECISION;
+  this->EnableSMP = false;
 }
 
 vtkPolyDataConnectivityFilter::~vtkPolyDataConnectivityFilter()
@@ -131,6 +170,11 @@ int vtkPolyDataConnectivityFilter::RequestData(
     }
   }
 
+  if ( this->EnableSMP )
+  {
+    return this->ExecuteSMP(input, output);
+  }
+
   // Build cell structure
   //
   this->Mesh = vtkPolyData::New();
@@ -563,6 +607,233 @@ int vtkPolyDataConnectivityFilter::IsScalarConnected( vtkIdType cellId )
   return 0;
 }
 
+// --------------------------------------------------------------------------
+// Label the regions with a parallel union-find, then extract the selected
+// cells and the points of all the labeled cells, as the serial traversal
+// does.
+int vtkPolyDataConnectivityFilter::ExecuteSMP(vtkPolyData *input,
+                                              vtkPolyData *output)
+{
+  vtkPoints *inPts = input->GetPoints();
+  const vtkIdType numPts = inPts->GetNumberOfPoints();
+  const vtkIdType numCells = input->GetNumberOfCells();
+  vtkPointData *pd=input->GetPointData(), *outputPD=output->GetPointData();
+  vtkCellData *cd=input->GetCellData(), *outputCD=output->GetCellData();
+
+  vtkNew<vtkCellRegionLabeler> labeler;
+  labeler->Initialize(input);
+  vtkStaticCellLinks *links = labeler->GetLinks();
+  this->UpdateProgress(0.10);
+
+  std::vector<unsigned char> connectable;
+  if ( this->InScalars )
+  {
+    connectable.resize(numCells);
+    labeler->MarkScalarConnectedCells(this->InScalars, this->ScalarRange,
+                                      this->FullScalarConnectivity != 0,
+                                      &connectable[0]);
+  }
+  const unsigned char *conn = connectable.empty() ? NULL : &connectable[0];
+
+  std::vector<vtkIdType> regionIds(numCells);
+  std::vector<unsigned char> selected;
+  this->RegionSizes->Reset();
+  if ( this->ExtractionMode != VTK_EXTRACT_POINT_SEEDED_REGIONS &&
+       this->ExtractionMode != VTK_EXTRACT_CELL_SEEDED_REGIONS &&
+       this->ExtractionMode != VTK_EXTRACT_CLOSEST_POINT_REGION )
+  {
+    vtkIdType numRegions = labeler->LabelAllRegions(conn, &regionIds[0]);
+    this->RegionSizes->SetNumberOfValues(numRegions);
+    vtkIdType *sizes = this->RegionSizes->GetPointer(0);
+    std::fill_n(sizes, numRegions, 0);
+    for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+      sizes[regionIds[cellId]]++;
+    }
+
+    if ( this->ExtractionMode == VTK_EXTRACT_SPECIFIED_REGIONS )
+    {
+      selected.resize(numRegions, 0);
+      for (vtkIdType i = 0; i < this->SpecifiedRegionIds->GetNumberOfIds(); i++)
+      {
+        vtkIdType regionId = this->SpecifiedRegionIds->GetId(i);
+        if ( regionId >= 0 && regionId < numRegions )
+        {
+          selected[regionId] = 1;
+        }
+      }
+    }
+    else if ( this->ExtractionMode == VTK_EXTRACT_LARGEST_REGION )
+    {
+      // The first of the largest regions, as in the serial traversal.
+      vtkIdType largestRegionId = 0;
+      for (vtkIdType regionId = 1; regionId < numRegions; regionId++)
+      {
+        if ( sizes[regionId] > sizes[largestRegionId] )
+        {
+          largestRegionId = regionId;
+        }
+      }
+      selected.resize(numRegions, 0);
+      selected[largestRegionId] = 1;
+    }
+  }
+  else // regions have been seeded, everything considered in same region
+  {
+    vtkNew<vtkIdList> seedCells;
+    if ( this->ExtractionMode == VTK_EXTRACT_CELL_SEEDED_REGIONS )
+    {
+      seedCells->DeepCopy(this->Seeds);
+    }
+    else
+    {
+      vtkNew<vtkIdList> seedPts;
+      if ( this->ExtractionMode == VTK_EXTRACT_POINT_SEEDED_REGIONS )
+      {
+        seedPts->DeepCopy(this->Seeds);
+      }
+      else
+      { //loop over points, find closest one
+        double minDist2 = VTK_DOUBLE_MAX, dist2, x[3];
+        vtkIdType minId = 0;
+        for (vtkIdType i = 0; i < numPts; i++)
+        {
+          inPts->GetPoint(i,x);
+          dist2 = vtkMath::Distance2BetweenPoints(x,this->ClosestPoint);
+          if ( dist2 < minDist2 )
+          {
+            minId = i;
+            minDist2 = dist2;
+          }
+        }
+        seedPts->InsertNextId(minId);
+      }
+      for (vtkIdType i = 0; i < seedPts->GetNumberOfIds(); i++)
+      {
+        vtkIdType ptId = seedPts->GetId(i);
+        if ( ptId >= 0 && ptId < numPts )
+        {
+          const vtkIdType *cells = links->GetCells(ptId);
+          vtkIdType ncells = links->GetNumberOfCells(ptId);
+          for (vtkIdType j = 0; j < ncells; j++)
+          {
+            seedCells->InsertNextId(cells[j]);
+          }
+        }
+      }
+    }
+    this->RegionSizes->InsertValue(
+      0, labeler->LabelSeededRegion(conn, seedCells.GetPointer(),
+                                    &regionIds[0]));
+  }
+  this->UpdateProgress(0.6);
+
+  // All the points of the labeled cells are extracted, even the ones of the
+  // regions that are not.
+  std::vector<vtkIdType> pointRegionIds(numPts);
+  labeler->LabelPoints(&regionIds[0], &pointRegionIds[0]);
+  std::vector<unsigned char> cellMask(numCells);
+  std::vector<unsigned char> pointMask(numPts);
+  MaskLabels maskCells = { &regionIds[0],
+                           selected.empty() ? NULL : &selected[0],
+                           &cellMask[0] };
+  vtkSMPTools::For(0, numCells, maskCells);
+  MaskLabels maskPoints = { &pointRegionIds[0], NULL, &pointMask[0] };
+  vtkSMPTools::For(0, numPts, maskPoints);
+
+  // Gather the points and their data, in input order.
+  vtkNew<vtkIdList> pointIds;
+  vtkNew<vtkIdList> range;
+  vtkCellSubsetExtractor::CompactMask(&pointMask[0], numPts,
+                                      pointIds.GetPointer());
+  const vtkIdType numNewPts = pointIds->GetNumberOfIds();
+  std::vector<vtkIdType> pointMap(numPts, -1);
+  for (vtkIdType i = 0; i < numNewPts; i++)
+  {
+    pointMap[pointIds->GetId(i)] = i;
+  }
+
+  vtkNew<vtkPoints> newPts;
+  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    newPts->SetDataType(inPts->GetDataType());
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_FLOAT);
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_DOUBLE);
+  }
+  newPts->SetNumberOfPoints(numNewPts);
+  inPts->GetData()->GetTuples(pointIds.GetPointer(), newPts->GetData());
+  output->SetPoints(newPts.GetPointer());
+
+  outputPD->CopyAllocate(pd, numNewPts);
+  MakeRange(range.GetPointer(), numNewPts);
+  outputPD->CopyData(pd, pointIds.GetPointer(), range.GetPointer());
+
+  // if coloring regions; send down new scalar data
+  if ( this->ColorRegions )
+  {
+    vtkNew<vtkIdTypeArray> newScalars;
+    newScalars->SetName("RegionId");
+    newScalars->SetNumberOfTuples(numNewPts);
+    for (vtkIdType i = 0; i < numNewPts; i++)
+    {
+      newScalars->SetValue(i, pointRegionIds[pointIds->GetId(i)]);
+    }
+    int idx = outputPD->AddArray(newScalars.GetPointer());
+    outputPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+  }
+
+  // Create output cells, in input order so that the verts, lines, polys and
+  // strips keep their relative order.
+  vtkNew<vtkIdList> cellIds;
+  vtkCellSubsetExtractor::CompactMask(&cellMask[0], numCells,
+                                      cellIds.GetPointer());
+  const vtkIdType numNewCells = cellIds->GetNumberOfIds();
+  output->Allocate(input, numNewCells);
+
+  std::vector<unsigned char> visitedPoints;
+  if ( this->MarkVisitedPointIds )
+  {
+    visitedPoints.resize(numNewPts, 0);
+  }
+  this->VisitedPointIds->Reset();
+  vtkIdType npts, *pts;
+  std::vector<vtkIdType> ids;
+  for (vtkIdType i = 0; i < numNewCells; i++)
+  {
+    vtkIdType cellId = cellIds->GetId(i);
+    input->GetCellPoints(cellId, npts, pts);
+    ids.resize(npts);
+    for (vtkIdType j = 0; j < npts; j++)
+    {
+      vtkIdType id = ids[j] = pointMap[pts[j]];
+
+      // If we asked to mark the visited point ids, mark them.
+      if ( this->MarkVisitedPointIds && !visitedPoints[id] )
+      {
+        visitedPoints[id] = 1;
+        this->VisitedPointIds->InsertNextId(id);
+      }
+    }
+    output->InsertNextCell(input->GetCellType(cellId), npts,
+                           npts > 0 ? &ids[0] : NULL);
+  }
+
+  outputCD->CopyAllocate(cd, numNewCells);
+  MakeRange(range.GetPointer(), numNewCells);
+  outputCD->CopyData(cd, cellIds.GetPointer(), range.GetPointer());
+
+  vtkDebugMacro (<< "Extracted " << this->GetNumberOfExtractedRegions()
+                 << " region(s) and " << output->GetNumberOfCells()
+                 << " cells");
+  return 1;
+}
+
 // --------------------------------------------------------------------------
 // Obtain the number of connected regions.
 int vtkPolyDataConnectivityFilter::GetNumberOfExtractedRegions()
@@ -661,4 +932,5 @@ void vtkPolyDataConnectivityFilter::PrintSelf(ostream& os, vtkIndent indent)
   }
 
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
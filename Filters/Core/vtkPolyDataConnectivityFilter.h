@@ -43,8 +43,12 @@
  * This use of ScalarConnectivity is particularly useful for selecting cells
  * for later processing.
  *
+ * The regions can be labeled with vtkSMPTools (see EnableSMP), using a
+ * parallel union-find over static cell links. The regions and their
+ * numbering are the same as the serial traversal's.
+ *
  * @sa
- * vtkConnectivityFilter
+ * vtkConnectivityFilter vtkCellRegionLabeler
 */
 
 #ifndef vtkPolyDataConnectivityFilter_h
@@ -221,6 +225,20 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded labeling of the regions. Cells are joined with
+   * a parallel union-find over static cell links, regions are numbered in
+   * order of their first cell, and the points and attributes are gathered
+   * with vtkSMPTools. The same cells are extracted in the same order as
+   * with the serial wave propagation, but the output points keep the input
+   * order instead of the traversal order. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkPolyDataConnectivityFilter();
   ~vtkPolyDataConnectivityFilter() VTK_OVERRIDE;
@@ -246,6 +264,9 @@ protected:
 
   void TraverseAndMark();
 
+  // Threaded counterpart of RequestData(), once the input is checked.
+  int ExecuteSMP(vtkPolyData *input, vtkPolyData *output);
+
   // used to support algorithm execution
   vtkDataArray *CellScalars;
   vtkIdList *NeighborCellPointIds;
@@ -265,6 +286,7 @@ protected:
 
   int MarkVisitedPointIds;
   int OutputPointsPrecision;
+  bool EnableSMP;
 
 private:
   vtkPolyDataConnectivityFilter(const vtkPolyDataConnectivityFilter&) VTK_DELETE_FUNCTION;
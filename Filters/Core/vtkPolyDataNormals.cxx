@@ -26,11 +26,562 @@
 #include "vtkPolygon.h"
 #include "vtkTriangleStrip.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
+#include "vtkUnionFind.h"
 
 #include "vtkNew.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkPolyDataNormals);
 
+#define VTK_CELL_NOT_VISITED     0
+#define VTK_CELL_VISITED         1
+
+namespace
+{
+
+typedef vtkStaticCellLinksTemplate<vtkIdType> vtkNormalsLinks;
+
+// Cells using a point in increasing order, as vtkCellLinks stores them.
+// Static links store them in decreasing order.
+void GetPointCells(vtkNormalsLinks *links, vtkIdType ptId,
+                   std::vector<vtkIdType> &cells)
+{
+  const vtkIdType *ptCells = links->GetCells(ptId);
+  cells.resize(links->GetNumberOfCells(ptId));
+  std::reverse_copy(ptCells, ptCells + cells.size(), cells.begin());
+}
+
+// Same as vtkPolyData::GetCellEdgeNeighbors() on static links.
+void GetEdgeNeighbors(vtkNormalsLinks *links, vtkIdType cellId,
+                      vtkIdType p1, vtkIdType p2,
+                      std::vector<vtkIdType> &neighbors)
+{
+  neighbors.clear();
+  const vtkIdType *cells1 = links->GetCells(p1);
+  const vtkIdType *cells2 = links->GetCells(p2);
+  const vtkIdType *cells2End = cells2 + links->GetNumberOfCells(p2);
+  for (vtkIdType i = links->GetNumberOfCells(p1) - 1; i >= 0; --i)
+  {
+    if (cells1[i] != cellId &&
+        std::find(cells2, cells2End, cells1[i]) != cells2End)
+    {
+      neighbors.push_back(cells1[i]);
+    }
+  }
+}
+
+// Join the polygons that TraverseAndOrder() may reach from each other into
+// regions that can be ordered independently.
+class LinkPolygons
+{
+public:
+  vtkPolyData *Mesh;
+  vtkNormalsLinks *Links;
+  vtkUnionFind *Sets;
+  int NonManifoldTraversal;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Neighbors;
+
+  LinkPolygons(vtkPolyData *mesh, vtkNormalsLinks *links,
+               vtkUnionFind *sets, int nonManifoldTraversal)
+    : Mesh(mesh), Links(links), Sets(sets),
+      NonManifoldTraversal(nonManifoldTraversal)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<vtkIdType> &neighbors = this->Neighbors.Local();
+    vtkIdType npts, *pts;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      for (vtkIdType j = 0; j < npts; ++j)
+      {
+        GetEdgeNeighbors(this->Links, cellId, pts[j], pts[(j + 1) % npts],
+                         neighbors);
+        if (neighbors.size() == 1 || this->NonManifoldTraversal)
+        {
+          for (size_t k = 0; k < neighbors.size(); ++k)
+          {
+            this->Sets->Union(cellId, neighbors[k]);
+          }
+        }
+      }
+    }
+  }
+};
+
+// Order the polygons of independent regions concurrently. Within a region,
+// polygons are seeded and traversed exactly as in the serial filter.
+class OrderRegions
+{
+public:
+  vtkPolyData *OldMesh;
+  vtkPolyData *NewMesh;
+  vtkNormalsLinks *Links;
+  int *Visited;
+  const vtkIdType *RegionOffsets;
+  const vtkIdType *RegionCells;
+  int FlipNormals;
+  int NonManifoldTraversal;
+  vtkSMPThreadLocal<vtkIdType> NumFlips;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Wave;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Wave2;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Neighbors;
+
+  OrderRegions(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+               vtkNormalsLinks *links, int *visited,
+               const vtkIdType *regionOffsets, const vtkIdType *regionCells,
+               int flipNormals, int nonManifoldTraversal)
+    : OldMesh(oldMesh), NewMesh(newMesh), Links(links), Visited(visited),
+      RegionOffsets(regionOffsets), RegionCells(regionCells),
+      FlipNormals(flipNormals), NonManifoldTraversal(nonManifoldTraversal),
+      NumFlips(0)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType &numFlips = this->NumFlips.Local();
+    std::vector<vtkIdType> &wave = this->Wave.Local();
+    for (vtkIdType region = begin; region < end; ++region)
+    {
+      for (vtkIdType i = this->RegionOffsets[region];
+           i < this->RegionOffsets[region + 1]; ++i)
+      {
+        vtkIdType cellId = this->RegionCells[i];
+        if (this->Visited[cellId] == VTK_CELL_NOT_VISITED)
+        {
+          if (this->FlipNormals)
+          {
+            numFlips++;
+            this->NewMesh->ReverseCell(cellId);
+          }
+          wave.clear();
+          wave.push_back(cellId);
+          this->Visited[cellId] = VTK_CELL_VISITED;
+          this->Traverse(numFlips);
+        }
+      }
+    }
+  }
+
+  // Same as vtkPolyDataNormals::TraverseAndOrder().
+  void Traverse(vtkIdType &numFlips)
+  {
+    std::vector<vtkIdType> &wave = this->Wave.Local();
+    std::vector<vtkIdType> &wave2 = this->Wave2.Local();
+    std::vector<vtkIdType> &neighbors = this->Neighbors.Local();
+    vtkIdType npts, *pts, numNeiPts, *neiPts;
+
+    while (!wave.empty())
+    {
+      for (size_t i = 0; i < wave.size(); ++i)
+      {
+        vtkIdType cellId = wave[i];
+        this->NewMesh->GetCellPoints(cellId, npts, pts);
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          vtkIdType j1 = (j + 1) % npts;
+          GetEdgeNeighbors(this->Links, cellId, pts[j], pts[j1], neighbors);
+          if (neighbors.size() != 1 && !this->NonManifoldTraversal)
+          {
+            continue;
+          }
+          for (size_t k = 0; k < neighbors.size(); ++k)
+          {
+            vtkIdType neighbor = neighbors[k];
+            if (this->Visited[neighbor] != VTK_CELL_NOT_VISITED)
+            {
+              continue;
+            }
+            this->NewMesh->GetCellPoints(neighbor, numNeiPts, neiPts);
+            vtkIdType l;
+            for (l = 0; l < numNeiPts; l++)
+            {
+              if (neiPts[l] == pts[j1])
+              {
+                break;
+              }
+            }
+            if (neiPts[(l + 1) % numNeiPts] != pts[j])
+            {
+              numFlips++;
+              this->NewMesh->ReverseCell(neighbor);
+            }
+            this->Visited[neighbor] = VTK_CELL_VISITED;
+            wave2.push_back(neighbor);
+          }
+        }
+      }
+      wave.swap(wave2);
+      wave2.clear();
+    }
+  }
+};
+
+class ComputePolyNormals
+{
+public:
+  vtkPoints *Points;
+  vtkPolyData *Mesh;
+  float *Normals;
+
+  ComputePolyNormals(vtkPoints *points, vtkPolyData *mesh, float *normals)
+    : Points(points), Mesh(mesh), Normals(normals)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts;
+    double n[3];
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      vtkPolygon::ComputeNormal(this->Points, npts, pts, n);
+      float *normal = this->Normals + 3 * cellId;
+      normal[0] = static_cast<float>(n[0]);
+      normal[1] = static_cast<float>(n[1]);
+      normal[2] = static_cast<float>(n[2]);
+    }
+  }
+};
+
+// Flag the polygons whose ordering was reversed, so that the position of a
+// point in the modified mesh follows from its position in the original one.
+class MarkReversed
+{
+public:
+  vtkPolyData *OldMesh;
+  vtkPolyData *NewMesh;
+  unsigned char *Reversed;
+
+  MarkReversed(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+               unsigned char *reversed)
+    : OldMesh(oldMesh), NewMesh(newMesh), Reversed(reversed)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *oldPts, *newPts;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->OldMesh->GetCellPoints(cellId, npts, oldPts);
+      this->NewMesh->GetCellPoints(cellId, npts, newPts);
+      this->Reversed[cellId] = !std::equal(oldPts, oldPts + npts, newPts);
+    }
+  }
+};
+
+// Base of the per point passes: locates the uses of a point in the modified
+// mesh without reading polygons other threads may be writing.
+class PointPass
+{
+public:
+  vtkPolyData *OldMesh;
+  vtkPolyData *NewMesh;
+  vtkNormalsLinks *Links;
+  const unsigned char *Reversed;
+
+  PointPass(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+            vtkNormalsLinks *links, const unsigned char *reversed)
+    : OldMesh(oldMesh), NewMesh(newMesh), Links(links), Reversed(reversed)
+  {}
+
+  // Return the point list of cellId in the modified mesh and the positions
+  // of ptId in it.
+  vtkIdType *GetUses(vtkIdType cellId, vtkIdType ptId,
+                     std::vector<vtkIdType> &uses)
+  {
+    vtkIdType npts, *oldPts, *newPts;
+    this->OldMesh->GetCellPoints(cellId, npts, oldPts);
+    this->NewMesh->GetCellPoints(cellId, npts, newPts);
+    bool reversed = this->Reversed && this->Reversed[cellId];
+    uses.clear();
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      if (oldPts[i] == ptId)
+      {
+        uses.push_back(reversed ? npts - 1 - i : i);
+      }
+    }
+    return newPts;
+  }
+};
+
+// Threaded MarkAndSplit(). A first pass counts the points each point is
+// split into, a second pass (with Map set) numbers them in point order like
+// the serial filter does and replaces the point in the polygons.
+class SplitPoints : public PointPass
+{
+public:
+  const float *PolyNormals;
+  double CosAngle;
+  vtkIdType NumPts;
+  vtkIdType *NumNewPts;
+  vtkIdType *Map;
+
+  struct Scratch
+  {
+    std::vector<vtkIdType> Cells;
+    std::vector<int> Regions;
+    std::vector<vtkIdType> Uses;
+  };
+  vtkSMPThreadLocal<Scratch> LocalScratch;
+
+  SplitPoints(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+              vtkNormalsLinks *links, const unsigned char *reversed,
+              const float *polyNormals, double cosAngle, vtkIdType numPts,
+              vtkIdType *numNewPts)
+    : PointPass(oldMesh, newMesh, links, reversed), PolyNormals(polyNormals),
+      CosAngle(cosAngle), NumPts(numPts), NumNewPts(numNewPts), Map(NULL)
+  {}
+
+  // The region of a cell is stored with its first use of the point, so that
+  // polygons using the point twice behave as in MarkAndSplit().
+  static int &Region(Scratch &scratch, vtkIdType cellId)
+  {
+    return scratch.Regions[std::find(scratch.Cells.begin(),
+      scratch.Cells.end(), cellId) - scratch.Cells.begin()];
+  }
+
+  // Given a polygon and one of its points adjacent to ptId, return the
+  // other point adjacent to ptId.
+  vtkIdType NextNeighbor(vtkIdType cellId, vtkIdType ptId, vtkIdType nei)
+  {
+    vtkIdType numPts, *pts, spot;
+    this->OldMesh->GetCellPoints(cellId, numPts, pts);
+    for (spot = 0; spot < numPts; spot++)
+    {
+      if (pts[spot] == ptId)
+      {
+        break;
+      }
+    }
+    if (spot == 0)
+    {
+      return (pts[spot+1] != nei ? pts[spot+1] : pts[numPts-1]);
+    }
+    else if (spot == (numPts-1))
+    {
+      return (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
+    }
+    return (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
+  }
+
+  // Label the regions of polygons around ptId separated by feature edges,
+  // as MarkAndSplit() does, and return their number.
+  int MarkRegions(vtkIdType ptId, Scratch &scratch)
+  {
+    GetPointCells(this->Links, ptId, scratch.Cells);
+    const std::vector<vtkIdType> &cells = scratch.Cells;
+    if (cells.size() <= 1)
+    {
+      return 1;
+    }
+    scratch.Regions.assign(cells.size(), -1);
+
+    const vtkIdType *neiCells = NULL, *neiCellsEnd = NULL;
+    int numRegions = 0;
+    for (size_t j = 0; j < cells.size(); j++)
+    {
+      if (Region(scratch, cells[j]) >= 0)
+      {
+        continue;
+      }
+      Region(scratch, cells[j]) = numRegions;
+
+      // Walk from the seed cell across both of its edges using ptId.
+      vtkIdType numPts, *pts;
+      this->OldMesh->GetCellPoints(cells[j], numPts, pts);
+      vtkIdType spot;
+      for (spot = 0; spot < numPts; spot++)
+      {
+        if (pts[spot] == ptId)
+        {
+          break;
+        }
+      }
+      vtkIdType neiPt[2];
+      if (spot == 0)
+      {
+        neiPt[0] = pts[spot+1];
+        neiPt[1] = pts[numPts-1];
+      }
+      else if (spot == (numPts-1))
+      {
+        neiPt[0] = pts[spot-1];
+        neiPt[1] = pts[0];
+      }
+      else
+      {
+        neiPt[0] = pts[spot+1];
+        neiPt[1] = pts[spot-1];
+      }
+
+      for (int i = 0; i < 2; i++)
+      {
+        vtkIdType cellId = cells[j];
+        vtkIdType nei = neiPt[i];
+        while (cellId >= 0)
+        {
+          // Edge neighbors of cellId across (ptId, nei).
+          neiCells = this->Links->GetCells(nei);
+          neiCellsEnd = neiCells + this->Links->GetNumberOfCells(nei);
+          vtkIdType neiCellId = -1;
+          int numNeighbors = 0;
+          for (size_t k = 0; k < cells.size() && numNeighbors < 2; ++k)
+          {
+            if (cells[k] != cellId &&
+                std::find(neiCells, neiCellsEnd, cells[k]) != neiCellsEnd)
+            {
+              neiCellId = cells[k];
+              numNeighbors++;
+            }
+          }
+
+          if (numNeighbors == 1 && Region(scratch, neiCellId) < 0)
+          {
+            const float *thisNormal = this->PolyNormals + 3 * cellId;
+            const float *neiNormal = this->PolyNormals + 3 * neiCellId;
+            double dot = static_cast<double>(thisNormal[0]) * neiNormal[0] +
+                         static_cast<double>(thisNormal[1]) * neiNormal[1] +
+                         static_cast<double>(thisNormal[2]) * neiNormal[2];
+            if (dot > this->CosAngle)
+            {
+              Region(scratch, neiCellId) = numRegions;
+              nei = this->NextNeighbor(neiCellId, ptId, nei);
+              cellId = neiCellId;
+            }
+            else
+            {
+              cellId = -1; //separated by edge angle
+            }
+          }
+          else
+          {
+            cellId = -1; //separated by previous visit, boundary, or non-manifold
+          }
+        }
+      }
+      numRegions++;
+    }
+    return numRegions;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    Scratch &scratch = this->LocalScratch.Local();
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      int numRegions = this->MarkRegions(ptId, scratch);
+      if (!this->Map)
+      {
+        this->NumNewPts[ptId] = numRegions - 1;
+        continue;
+      }
+      if (numRegions <= 1)
+      {
+        continue;
+      }
+
+      // Cells not in the first region use a new point.
+      vtkIdType lastId = this->NumPts + this->NumNewPts[ptId];
+      const std::vector<vtkIdType> &cells = scratch.Cells;
+      for (size_t j = 0; j < cells.size(); j++)
+      {
+        int region = Region(scratch, cells[j]);
+        if (region <= 0 || (j > 0 && cells[j] == cells[j-1]))
+        {
+          continue;
+        }
+        vtkIdType replacementPoint = lastId + region - 1;
+        this->Map[replacementPoint] = ptId;
+        vtkIdType *pts = this->GetUses(cells[j], ptId, scratch.Uses);
+        for (size_t i = 0; i < scratch.Uses.size(); ++i)
+        {
+          pts[scratch.Uses[i]] = replacementPoint;
+        }
+      }
+    }
+  }
+};
+
+// Sum the normals of the polygons using each (possibly split) point. Sums
+// are gathered per input point, in the order of the serial filter.
+class AccumulateNormals : public PointPass
+{
+public:
+  const float *PolyNormals;
+  float *Normals;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Uses;
+
+  AccumulateNormals(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+                    vtkNormalsLinks *links, const unsigned char *reversed,
+                    const float *polyNormals, float *normals)
+    : PointPass(oldMesh, newMesh, links, reversed), PolyNormals(polyNormals),
+      Normals(normals)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<vtkIdType> &uses = this->Uses.Local();
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      const vtkIdType *cells = this->Links->GetCells(ptId);
+      vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+      for (vtkIdType j = ncells - 1; j >= 0; --j)
+      {
+        if (j < ncells - 1 && cells[j] == cells[j+1])
+        {
+          continue;
+        }
+        const float *polyNormal = this->PolyNormals + 3 * cells[j];
+        vtkIdType *pts = this->GetUses(cells[j], ptId, uses);
+        for (size_t i = 0; i < uses.size(); ++i)
+        {
+          float *normal = this->Normals + 3 * pts[uses[i]];
+          normal[0] += polyNormal[0];
+          normal[1] += polyNormal[1];
+          normal[2] += polyNormal[2];
+        }
+      }
+    }
+  }
+};
+
+class NormalizeNormals
+{
+public:
+  float *Normals;
+  double FlipDirection;
+
+  NormalizeNormals(float *normals, double flipDirection)
+    : Normals(normals), FlipDirection(flipDirection)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      float *n = this->Normals + 3 * i;
+      const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) *
+        this->FlipDirection;
+      if (length != 0.0)
+      {
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+      }
+    }
+  }
+};
+
+} // end anon namespace
+
 // Construct with feature angle=30, splitting and consistency turned on,
 // flipNormals turned off, and non-manifold traversal turned on.
 vtkPolyDataNormals::vtkPolyDataNormals()
@@ -55,11 +606,11 @@ vtkPolyDataNormals::vtkPolyDataNormals()
   this->Visited = 0;
   this->PolyNormals = 0;
   this->CosAngle = 0.0;
+  this->EnableSMP = false;
+  this->Links = 0;
+  this->Reversed = 0;
 }
 
-#define VTK_CELL_NOT_VISITED     0
-#define VTK_CELL_VISITED         1
-
 // Generate normals for polygon meshes
 int vtkPolyDataNormals::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -174,7 +725,17 @@ int vtkPolyDataNormals::RequestData(
     this->OldMesh->SetPolys(inPolys);
     polys = inPolys;
   }
-  this->OldMesh->BuildLinks();
+  if ( this->EnableSMP )
+  {
+    // Static links are faster to build, and safe to query from threads.
+    this->OldMesh->BuildCells();
+    this->Links = new vtkStaticCellLinksTemplate<vtkIdType>;
+    this->Links->BuildLinks(this->OldMesh);
+  }
+  if ( !this->EnableSMP || this->AutoOrientNormals )
+  {
+    this->OldMesh->BuildLinks();
+  }
   this->UpdateProgress(0.10);
 
   pd = input->GetPointData();
@@ -304,6 +865,11 @@ int vtkPolyDataNormals::RequestData(
     leftmostPoints->Delete();
     vtkDebugMacro(<<"Reversed ordering of " << this->NumFlips << " polygons");
   } // automatically orient normals
+  else if ( this->Consistency && this->EnableSMP )
+  {
+    this->OrderPolygonsSMP(numPolys);
+    vtkDebugMacro(<<"Reversed ordering of " << this->NumFlips << " polygons");
+  }
   else
   {
     if ( this->Consistency )
@@ -346,19 +912,37 @@ int vtkPolyDataNormals::RequestData(
   this->PolyNormals->SetName("Normals");
   this->PolyNormals->SetNumberOfTuples(numPolys);
 
-  for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
-       cellId++ )
+  if ( this->EnableSMP )
   {
-    if ((cellId % 1000) == 0)
+    ComputePolyNormals functor(inPts, this->NewMesh,
+                               this->PolyNormals->GetPointer(0));
+    vtkSMPTools::For(0, numPolys, functor);
+
+    // The per point passes need to know which polygons were reversed.
+    if ( this->NumFlips > 0 &&
+         (this->Splitting || this->ComputePointNormals) )
     {
-      this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
-      if (this->GetAbortExecute())
+      this->Reversed = new unsigned char[numPolys];
+      MarkReversed marker(this->OldMesh, this->NewMesh, this->Reversed);
+      vtkSMPTools::For(0, numPolys, marker);
+    }
+  }
+  else
+  {
+    for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
+         cellId++ )
+    {
+      if ((cellId % 1000) == 0)
       {
-        break;
+        this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
+        if (this->GetAbortExecute())
+        {
+          break;
+        }
       }
+      vtkPolygon::ComputeNormal(inPts, npts, pts, n);
+      this->PolyNormals->SetTuple(cellId,n);
     }
-    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
-    this->PolyNormals->SetTuple(cellId,n);
   }
 
   // Split mesh if sharp features
@@ -373,16 +957,23 @@ int vtkPolyDataNormals::RequestData(
     // to map new points into old points.
     //
     this->Map = vtkIdList::New();
-    this->Map->SetNumberOfIds(numPts);
-    for (vtkIdType i=0; i < numPts; i++)
+    if ( this->EnableSMP )
     {
-      this->Map->SetId(i,i);
+      this->SplitPointsSMP(numPts, this->Map);
     }
-
-    for (ptId=0; ptId < numPts; ptId++)
+    else
     {
-      this->MarkAndSplit(ptId);
-    }//for all input points
+      this->Map->SetNumberOfIds(numPts);
+      for (vtkIdType i=0; i < numPts; i++)
+      {
+        this->Map->SetId(i,i);
+      }
+
+      for (ptId=0; ptId < numPts; ptId++)
+      {
+        this->MarkAndSplit(ptId);
+      }//for all input points
+    }
 
     numNewPts = this->Map->GetNumberOfIds();
 
@@ -418,11 +1009,26 @@ int vtkPolyDataNormals::RequestData(
     }
 
     newPts->SetNumberOfPoints(numNewPts);
-    for (ptId=0; ptId < numNewPts; ptId++)
+    if ( this->EnableSMP )
     {
-      oldId = this->Map->GetId(ptId);
-      newPts->SetPoint(ptId,inPts->GetPoint(oldId));
-      outPD->CopyData(pd,oldId,ptId);
+      // Gather whole arrays, which the arrays thread for large meshes.
+      vtkNew<vtkIdList> newIds;
+      newIds->SetNumberOfIds(numNewPts);
+      for (ptId=0; ptId < numNewPts; ptId++)
+      {
+        newIds->SetId(ptId,ptId);
+      }
+      inPts->GetData()->GetTuples(this->Map, newPts->GetData());
+      outPD->CopyData(pd, this->Map, newIds.GetPointer());
+    }
+    else
+    {
+      for (ptId=0; ptId < numNewPts; ptId++)
+      {
+        oldId = this->Map->GetId(ptId);
+        newPts->SetPoint(ptId,inPts->GetPoint(oldId));
+        outPD->CopyData(pd,oldId,ptId);
+      }
     }
     this->Map->Delete();
   } //splitting
@@ -459,7 +1065,13 @@ int vtkPolyDataNormals::RequestData(
 
   float *fPolyNormals = this->PolyNormals->WritePointer(0, 3 * numPolys);
 
-  if (this->ComputePointNormals)
+  if (this->ComputePointNormals && this->EnableSMP)
+  {
+    this->AccumulateNormalsSMP(numPts, fNormals);
+    NormalizeNormals normalizer(fNormals, flipDirection);
+    vtkSMPTools::For(0, numNewPts, normalizer);
+  }
+  else if (this->ComputePointNormals)
   {
     for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);
          ++cellId)
@@ -524,6 +1136,10 @@ int vtkPolyDataNormals::RequestData(
 
   this->OldMesh->Delete();
   this->NewMesh->Delete();
+  delete this->Links;
+  this->Links = 0;
+  delete [] this->Reversed;
+  this->Reversed = 0;
 
   return 1;
 }
@@ -776,5 +1392,105 @@ void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
      << (this->NonManifoldTraversal ? "On\n" : "Off\n");
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
+
+//----------------------------------------------------------------------------
+// Threaded consistent ordering. The polygons are first joined into the
+// regions a traversal can reach, then the regions are ordered concurrently.
+// Each region is seeded and traversed as by the serial filter, so the result
+// is the same.
+void vtkPolyDataNormals::OrderPolygonsSMP(vtkIdType numPolys)
+{
+  vtkUnionFind sets(numPolys);
+  LinkPolygons linker(this->OldMesh, this->Links, &sets,
+                      this->NonManifoldTraversal);
+  vtkSMPTools::For(0, numPolys, linker);
+
+  // Sort the polygons by region. Regions are numbered in the order of their
+  // smallest polygon, and keep their polygons in increasing order.
+  std::vector<vtkIdType> region(numPolys);
+  std::vector<vtkIdType> offsets(1, 0);
+  for (vtkIdType cellId = 0; cellId < numPolys; ++cellId)
+  {
+    vtkIdType root = sets.Find(cellId);
+    if (root == cellId)
+    {
+      region[cellId] = static_cast<vtkIdType>(offsets.size()) - 1;
+      offsets.push_back(0);
+    }
+    else
+    {
+      region[cellId] = region[root];
+    }
+    offsets[region[cellId] + 1]++;
+  }
+  vtkIdType numRegions = static_cast<vtkIdType>(offsets.size()) - 1;
+  for (vtkIdType i = 0; i < numRegions; ++i)
+  {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<vtkIdType> regionCells(numPolys);
+  std::vector<vtkIdType> fill(offsets.begin(), offsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numPolys; ++cellId)
+  {
+    regionCells[fill[region[cellId]]++] = cellId;
+  }
+
+  OrderRegions orderer(this->OldMesh, this->NewMesh, this->Links,
+                       this->Visited, &offsets[0], &regionCells[0],
+                       this->FlipNormals, this->NonManifoldTraversal);
+  vtkSMPTools::For(0, numRegions, orderer);
+
+  this->NumFlips = 0;
+  vtkSMPThreadLocal<vtkIdType>::iterator flips;
+  for (flips = orderer.NumFlips.begin(); flips != orderer.NumFlips.end();
+       ++flips)
+  {
+    this->NumFlips += static_cast<int>(*flips);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Threaded MarkAndSplit() for all points. Split points are numbered as by the
+// serial filter.
+void vtkPolyDataNormals::SplitPointsSMP(vtkIdType numPts, vtkIdList *map)
+{
+  std::vector<vtkIdType> numNewPts(numPts);
+  SplitPoints splitter(this->OldMesh, this->NewMesh, this->Links,
+                       this->Reversed, this->PolyNormals->GetPointer(0),
+                       this->CosAngle, numPts, &numNewPts[0]);
+  vtkSMPTools::For(0, numPts, splitter);
+
+  // Offset of the first new point of each point.
+  vtkIdType numSplits = 0;
+  for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+  {
+    vtkIdType count = numNewPts[ptId];
+    numNewPts[ptId] = numSplits;
+    numSplits += count;
+  }
+
+  map->SetNumberOfIds(numPts + numSplits);
+  vtkIdType *ids = map->GetPointer(0);
+  for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+  {
+    ids[ptId] = ptId;
+  }
+  if (numSplits > 0)
+  {
+    splitter.Map = ids;
+    vtkSMPTools::For(0, numPts, splitter);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPolyDataNormals::AccumulateNormalsSMP(vtkIdType numPts,
+                                              float *normals)
+{
+  AccumulateNormals accumulator(this->OldMesh, this->NewMesh, this->Links,
+                                this->Reversed,
+                                this->PolyNormals->GetPointer(0), normals);
+  vtkSMPTools::For(0, numPts, accumulator);
+}
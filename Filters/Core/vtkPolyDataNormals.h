@@ -63,6 +63,7 @@
 class vtkFloatArray;
 class vtkIdList;
 class vtkPolyData;
+template <typename TIds> class vtkStaticCellLinksTemplate;
 
 class VTKFILTERSCORE_EXPORT vtkPolyDataNormals : public vtkPolyDataAlgorithm
 {
@@ -163,6 +164,20 @@ public:
   vtkBooleanMacro(NonManifoldTraversal,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. Polygon normals, the splitting
+   * of sharp edges and the accumulation of point normals are computed with
+   * vtkSMPTools, using static cell links, and consistent ordering processes
+   * connected regions of polygons concurrently. The output is the same as
+   * the serial implementation's. AutoOrientNormals still orders polygons
+   * serially. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
   //@{
   /**
    * Set/get the desired precision for the output types. See the documentation
@@ -190,6 +205,7 @@ protected:
   int ComputeCellNormals;
   int NumFlips;
   int OutputPointsPrecision;
+  bool EnableSMP;
 
 private:
   vtkIdList *Wave;
@@ -201,6 +217,8 @@ private:
   int *Visited;
   vtkFloatArray *PolyNormals;
   double CosAngle;
+  vtkStaticCellLinksTemplate<vtkIdType> *Links;
+  unsigned char *Reversed;
 
   // Uses the list of cell ids (this->Wave) to propagate a wave of
   // checked and properly ordered polygons.
@@ -211,6 +229,12 @@ private:
   // separate the mesh.
   void MarkAndSplit(vtkIdType ptId);
 
+  // Threaded counterparts of TraverseAndOrder(), MarkAndSplit() and of the
+  // accumulation of point normals, working on this->Links.
+  void OrderPolygonsSMP(vtkIdType numPolys);
+  void SplitPointsSMP(vtkIdType numPts, vtkIdList *map);
+  void AccumulateNormalsSMP(vtkIdType numPts, float *normals);
+
 private:
   vtkPolyDataNormals(const vtkPolyDataNormals&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPolyDataNormals&) VTK_DELETE_FUNCTION;
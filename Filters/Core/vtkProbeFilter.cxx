@@ -17,8 +17,10 @@
 #include "vtkBoundingBox.h"
 #include "vtkCell.h"
 #include "vtkCellData.h"
+#include "vtkCellKernels.h"
 #include "vtkCharArray.h"
 #include "vtkGenericCell.h"
+#include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -26,8 +28,10 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
 #include "vtkSMPTools.h"
 #include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <algorithm>
@@ -489,97 +493,6 @@ static void GetPointIdsInRange(double rangeMin, double rangeMax, double start,
   }
 }
 
-void vtkProbeFilter::ProbeImagePointsInCell(vtkCell *cell, vtkIdType cellId,
-                                            vtkDataSet *source, int srcBlockId,
-                                            const double start[3],
-                                            const double spacing[3],
-                                            const int dim[3],
-                                            vtkPointData *outPD,
-                                            char *maskArray,
-                                            double *wtsBuff)
-{
-  vtkPointData *pd = source->GetPointData();
-  vtkCellData *cd = source->GetCellData();
-
-  // get coordinates of sampling grids
-  double cellBounds[6];
-  cell->GetBounds(cellBounds);
-
-  int idxBounds[6];
-  GetPointIdsInRange(cellBounds[0], cellBounds[1], start[0], spacing[0],
-    dim[0], idxBounds[0], idxBounds[1]);
-  GetPointIdsInRange(cellBounds[2], cellBounds[3], start[1], spacing[1],
-    dim[1], idxBounds[2], idxBounds[3]);
-  GetPointIdsInRange(cellBounds[4], cellBounds[5], start[2], spacing[2],
-    dim[2], idxBounds[4], idxBounds[5]);
-
-  if ((idxBounds[1] - idxBounds[0]) < 0 ||
-      (idxBounds[3] - idxBounds[2]) < 0 ||
-      (idxBounds[5] - idxBounds[4]) < 0)
-  {
-    return;
-  }
-
-  double cpbuf[3];
-  double dist2 = 0;
-  double *closestPoint = cpbuf;
-  if (cell->IsA("vtkCell3D"))
-  {
-    // we only care about closest point and its distance for 2D cells
-    closestPoint = NULL;
-  }
-
-  double userTol2 = this->Tolerance * this->Tolerance;
-  for (int iz=idxBounds[4]; iz<=idxBounds[5]; iz++)
-  {
-    double p[3];
-    p[2] = start[2] + iz*spacing[2];
-    for (int iy=idxBounds[2]; iy<=idxBounds[3]; iy++)
-    {
-      p[1] = start[1] + iy*spacing[1];
-      for (int ix=idxBounds[0]; ix<=idxBounds[1]; ix++)
-      {
-        // For each grid point within the cell bound, interpolate values
-        p[0] = start[0] + ix*spacing[0];
-
-        double pcoords[3];
-        int subId;
-        int inside = cell->EvaluatePosition(p, closestPoint, subId, pcoords,
-                                            dist2, wtsBuff);
-
-        // If ComputeTolerance is set, compute a tolerance proportional to the
-        // cell length. Otherwise, use the user specified absolute tolerance.
-        double tol2 = this->ComputeTolerance ?
-                      (CELL_TOLERANCE_FACTOR_SQR * cell->GetLength2()) :
-                      userTol2;
-
-        if ((inside == 1) && (dist2 <= tol2))
-        {
-          vtkIdType ptId = ix + dim[0]*(iy + dim[1]*iz);
-
-          // Interpolate the point data
-          outPD->InterpolatePoint((*this->PointList), pd, srcBlockId, ptId,
-                                  cell->PointIds, wtsBuff);
-
-          // Assign cell data
-          vtkVectorOfArrays::iterator iter;
-          for (iter = this->CellArrays->begin();
-              iter != this->CellArrays->end(); ++iter)
-          {
-            vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
-            if (inArray)
-            {
-              outPD->CopyTuple(inArray, *iter, cellId, ptId);
-            }
-          }
-
-          maskArray[ptId] = static_cast<char>(1);
-        }
-      }
-    }
-  }
-}
-
 namespace {
 
 class CellStorage
@@ -642,6 +555,58 @@ private:
   vtkGenericCell *Cells[VTK_NUMBER_OF_CELL_TYPES];
 };
 
+// Locates points in a cell through the vtkCell API.
+class CellEvaluator
+{
+public:
+  CellEvaluator(vtkCell *cell) : Cell(cell), ClosestPoint(this->Buffer)
+  {
+    if (cell->IsA("vtkCell3D"))
+    {
+      // we only care about closest point and its distance for 2D cells
+      this->ClosestPoint = NULL;
+    }
+  }
+
+  int EvaluatePosition(double x[3], double pcoords[3], double &dist2,
+                       double *weights)
+  {
+    int subId;
+    return this->Cell->EvaluatePosition(x, this->ClosestPoint, subId,
+                                        pcoords, dist2, weights);
+  }
+
+private:
+  vtkCell *Cell;
+  double *ClosestPoint;
+  double Buffer[3];
+};
+
+// Locates points in a cell supported by vtkCellKernels, reading the cell
+// points directly from the source point coordinates.
+template <typename T>
+class KernelEvaluator
+{
+public:
+  KernelEvaluator(int cellType, const T *coords, const vtkIdType *ptIds)
+    : CellType(cellType), Coords(coords), PtIds(ptIds)
+  {
+  }
+
+  int EvaluatePosition(double x[3], double pcoords[3], double &dist2,
+                       double *weights)
+  {
+    return vtkCellKernels::EvaluatePosition(this->CellType, this->Coords,
+                                            this->PtIds, x, pcoords, dist2,
+                                            weights);
+  }
+
+private:
+  int CellType;
+  const T *Coords;
+  const vtkIdType *PtIds;
+};
+
 } // anonymous namespace
 
 class vtkProbeFilter::ProbeImageDataWorklet
@@ -654,8 +619,19 @@ public:
                         int maxCellSize)
     : ProbeFilter(probeFilter), Source(source), SrcBlockId(srcBlockId),
       Start(start), Spacing(spacing), Dim(dim), OutPointData(outPD),
-      MaskArray(maskArray), MaxCellSize(maxCellSize)
+      MaskArray(maskArray), MaxCellSize(maxCellSize), FloatCoords(NULL),
+      DoubleCoords(NULL)
   {
+    // Cells of point sets are located without being copied whenever
+    // vtkCellKernels supports them.
+    vtkPointSet *pointSet = vtkPointSet::SafeDownCast(source);
+    if (pointSet)
+    {
+      this->FloatCoords =
+        vtkCellKernels::GetCoordinates<float>(pointSet->GetPoints());
+      this->DoubleCoords =
+        vtkCellKernels::GetCoordinates<double>(pointSet->GetPoints());
+    }
   }
 
   void operator()(vtkIdType cellBegin, vtkIdType cellEnd)
@@ -674,16 +650,71 @@ public:
     }
 
     CellStorage &cs = this->Cells.Local();
+    vtkIdList *ptIds = this->PointIds.Local();
+
     for (vtkIdType cellId = cellBegin; cellId < cellEnd; ++cellId)
     {
-      vtkCell *cell = cs.GetCell(this->Source, cellId);
-      this->ProbeFilter->ProbeImagePointsInCell(cell, cellId, this->Source,
-        this->SrcBlockId, this->Start, this->Spacing, this->Dim,
-        this->OutPointData, this->MaskArray, weights);
+      int cellType = this->FloatCoords || this->DoubleCoords ?
+        this->Source->GetCellType(cellId) : VTK_EMPTY_CELL;
+      if (vtkCellKernels::IsSupported(cellType))
+      {
+        this->Source->GetCellPoints(cellId, ptIds);
+        if (this->FloatCoords)
+        {
+          this->ProbeCell(cellType, cellId, ptIds, this->FloatCoords, weights);
+        }
+        else
+        {
+          this->ProbeCell(cellType, cellId, ptIds, this->DoubleCoords,
+                          weights);
+        }
+      }
+      else
+      {
+        vtkCell *cell = cs.GetCell(this->Source, cellId);
+        this->ProbeFilter->ProbeImagePointsInCell(cell, cellId, this->Source,
+          this->SrcBlockId, this->Start, this->Spacing, this->Dim,
+          this->OutPointData, this->MaskArray, weights);
+      }
     }
   }
 
+  // Probe the image points lying in the bounds of a cell, evaluator locating
+  // the points in the cell.
+  template <class Evaluator>
+  static void ProbePointsInCell(vtkProbeFilter *self, Evaluator &evaluator,
+                                vtkIdType cellId, vtkIdList *ptIds,
+                                const double cellBounds[6],
+                                vtkDataSet *source, int srcBlockId,
+                                const double start[3],
+                                const double spacing[3], const int dim[3],
+                                vtkPointData *outPD, char *maskArray,
+                                double *wtsBuff);
+
 private:
+  template <typename T>
+  void ProbeCell(int cellType, vtkIdType cellId, vtkIdList *ptIds,
+                 const T *coords, double *weights)
+  {
+    double bounds[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+                         -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+    vtkIdType numPts = ptIds->GetNumberOfIds();
+    for (vtkIdType i = 0; i < numPts; ++i)
+    {
+      const T *x = coords + 3 * ptIds->GetId(i);
+      for (int j = 0; j < 3; ++j)
+      {
+        bounds[2*j] = std::min(bounds[2*j], static_cast<double>(x[j]));
+        bounds[2*j+1] = std::max(bounds[2*j+1], static_cast<double>(x[j]));
+      }
+    }
+
+    KernelEvaluator<T> evaluator(cellType, coords, ptIds->GetPointer(0));
+    ProbePointsInCell(this->ProbeFilter, evaluator, cellId, ptIds, bounds,
+      this->Source, this->SrcBlockId, this->Start, this->Spacing, this->Dim,
+      this->OutPointData, this->MaskArray, weights);
+  }
+
   vtkProbeFilter *ProbeFilter;
   vtkDataSet *Source;
   int SrcBlockId;
@@ -693,11 +724,115 @@ private:
   vtkPointData *OutPointData;
   char *MaskArray;
   int MaxCellSize;
+  const float *FloatCoords; // source points, if vtkCellKernels reads them
+  const double *DoubleCoords;
 
   vtkSMPThreadLocal<std::vector<double> > WeightsBuffer;
   vtkSMPThreadLocal<CellStorage> Cells;
+  vtkSMPThreadLocalObject<vtkIdList> PointIds;
 };
 
+//----------------------------------------------------------------------------
+template <class Evaluator>
+void vtkProbeFilter::ProbeImageDataWorklet::ProbePointsInCell(
+  vtkProbeFilter *self, Evaluator &evaluator, vtkIdType cellId,
+  vtkIdList *ptIds, const double cellBounds[6], vtkDataSet *source,
+  int srcBlockId, const double start[3], const double spacing[3],
+  const int dim[3], vtkPointData *outPD, char *maskArray, double *wtsBuff)
+{
+  vtkPointData *pd = source->GetPointData();
+  vtkCellData *cd = source->GetCellData();
+
+  // get coordinates of sampling grids
+  int idxBounds[6];
+  GetPointIdsInRange(cellBounds[0], cellBounds[1], start[0], spacing[0],
+    dim[0], idxBounds[0], idxBounds[1]);
+  GetPointIdsInRange(cellBounds[2], cellBounds[3], start[1], spacing[1],
+    dim[1], idxBounds[2], idxBounds[3]);
+  GetPointIdsInRange(cellBounds[4], cellBounds[5], start[2], spacing[2],
+    dim[2], idxBounds[4], idxBounds[5]);
+
+  if ((idxBounds[1] - idxBounds[0]) < 0 ||
+      (idxBounds[3] - idxBounds[2]) < 0 ||
+      (idxBounds[5] - idxBounds[4]) < 0)
+  {
+    return;
+  }
+
+  // If ComputeTolerance is set, compute a tolerance proportional to the
+  // cell length. Otherwise, use the user specified absolute tolerance.
+  double length2 = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    double diff = cellBounds[2*i+1] - cellBounds[2*i];
+    length2 += diff * diff;
+  }
+  double tol2 = self->ComputeTolerance ?
+                (CELL_TOLERANCE_FACTOR_SQR * length2) :
+                (self->Tolerance * self->Tolerance);
+
+  double dist2 = 0;
+  for (int iz=idxBounds[4]; iz<=idxBounds[5]; iz++)
+  {
+    double p[3];
+    p[2] = start[2] + iz*spacing[2];
+    for (int iy=idxBounds[2]; iy<=idxBounds[3]; iy++)
+    {
+      p[1] = start[1] + iy*spacing[1];
+      for (int ix=idxBounds[0]; ix<=idxBounds[1]; ix++)
+      {
+        // For each grid point within the cell bound, interpolate values
+        p[0] = start[0] + ix*spacing[0];
+
+        double pcoords[3];
+        int inside = evaluator.EvaluatePosition(p, pcoords, dist2, wtsBuff);
+
+        if ((inside == 1) && (dist2 <= tol2))
+        {
+          vtkIdType ptId = ix + dim[0]*(iy + dim[1]*iz);
+
+          // Interpolate the point data
+          outPD->InterpolatePoint((*self->PointList), pd, srcBlockId, ptId,
+                                  ptIds, wtsBuff);
+
+          // Assign cell data
+          vtkVectorOfArrays::iterator iter;
+          for (iter = self->CellArrays->begin();
+              iter != self->CellArrays->end(); ++iter)
+          {
+            vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
+            if (inArray)
+            {
+              outPD->CopyTuple(inArray, *iter, cellId, ptId);
+            }
+          }
+
+          maskArray[ptId] = static_cast<char>(1);
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkProbeFilter::ProbeImagePointsInCell(vtkCell *cell, vtkIdType cellId,
+                                            vtkDataSet *source, int srcBlockId,
+                                            const double start[3],
+                                            const double spacing[3],
+                                            const int dim[3],
+                                            vtkPointData *outPD,
+                                            char *maskArray,
+                                            double *wtsBuff)
+{
+  double cellBounds[6];
+  cell->GetBounds(cellBounds);
+
+  CellEvaluator evaluator(cell);
+  ProbeImageDataWorklet::ProbePointsInCell(this, evaluator, cellId,
+    cell->PointIds, cellBounds, source, srcBlockId, start, spacing, dim,
+    outPD, maskArray, wtsBuff);
+}
+
 //----------------------------------------------------------------------------
 void vtkProbeFilter::ProbePointsImageData(vtkImageData *input,
   int srcIdx, vtkDataSet *source, vtkImageData *output)
@@ -53,8 +53,13 @@
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkQuadricDecimation);
 
 
@@ -88,6 +93,7 @@ vtkQuadricDecimation::vtkQuadricDecimation()
   this->TensorsWeight = 0.1;
 
   this->ActualReduction = 0.0;
+  this->EnableSMP = false;
 }
 
 //----------------------------------------------------------------------------
@@ -251,24 +257,28 @@ int vtkQuadricDecimation::RequestData(
     }
   }
 
-  vtkDebugMacro(<<"Computing Edges");
-  this->Edges->InitEdgeInsertion(numPts, 1); // storing edge id as attribute
-  this->EdgeCosts->Allocate(this->Mesh->GetPolys()->GetNumberOfCells() * 3);
-  for (i = 0; i <  this->Mesh->GetNumberOfCells(); i++)
+  // The threaded decimation finds the edges at each round
+  if (!this->EnableSMP)
   {
-    this->Mesh->GetCellPoints(i, npts, pts);
-
-    for (j = 0; j < 3; j++)
+    vtkDebugMacro(<<"Computing Edges");
+    this->Edges->InitEdgeInsertion(numPts, 1); // storing edge id as attribute
+    this->EdgeCosts->Allocate(this->Mesh->GetPolys()->GetNumberOfCells() * 3);
+    for (i = 0; i <  this->Mesh->GetNumberOfCells(); i++)
     {
-      if (this->Edges->IsEdge(pts[j], pts[(j+1)%3]) == -1)
+      this->Mesh->GetCellPoints(i, npts, pts);
+
+      for (j = 0; j < 3; j++)
       {
-        // If this edge has not been processed, get an id for it, add it to
-        // the edge list (Edges), and add its endpoints to the EndPoint1List
-        // and EndPoint2List (the 2 endpoints to different lists).
-        edgeId = this->Edges->GetNumberOfEdges();
-        this->Edges->InsertEdge(pts[j], pts[(j+1)%3], edgeId);
-        this->EndPoint1List->InsertId(edgeId, pts[j]);
-        this->EndPoint2List->InsertId(edgeId, pts[(j+1)%3]);
+        if (this->Edges->IsEdge(pts[j], pts[(j+1)%3]) == -1)
+        {
+          // If this edge has not been processed, get an id for it, add it to
+          // the edge list (Edges), and add its endpoints to the EndPoint1List
+          // and EndPoint2List (the 2 endpoints to different lists).
+          edgeId = this->Edges->GetNumberOfEdges();
+          this->Edges->InsertEdge(pts[j], pts[(j+1)%3], edgeId);
+          this->EndPoint1List->InsertId(edgeId, pts[j]);
+          this->EndPoint2List->InsertId(edgeId, pts[(j+1)%3]);
+        }
       }
     }
   }
@@ -280,90 +290,108 @@ int vtkQuadricDecimation::RequestData(
   {
     this->ComputeNumberOfComponents();
   }
-  x = new double [3+this->NumberOfComponents+this->VolumePreservation];
   this->CollapseCellIds = vtkIdList::New();
-  this->TempX = new double [3+this->NumberOfComponents+this->VolumePreservation];
-  this->TempQuad = new double[11 + 4 * this->NumberOfComponents+this->VolumePreservation];
-
-  this->TempB = new double [3 +  this->NumberOfComponents+this->VolumePreservation];
-  this->TempA = new double*[3 +  this->NumberOfComponents+this->VolumePreservation];
-  this->TempData = new double [(3 +  this->NumberOfComponents+this->VolumePreservation)*(3 +  this->NumberOfComponents+VolumePreservation)];
-  for (i = 0; i < 3 +  this->NumberOfComponents+this->VolumePreservation; i++)
+  // The threaded decimation keeps its targets and scratch space per round
+  x = NULL;
+  this->TempX = NULL;
+  this->TempQuad = NULL;
+  this->TempB = NULL;
+  this->TempA = NULL;
+  this->TempData = NULL;
+  if (!this->EnableSMP)
   {
-    this->TempA[i] = this->TempData+i*(3 +  this->NumberOfComponents+this->VolumePreservation);
+    x = new double [3+this->NumberOfComponents+this->VolumePreservation];
+    this->TempX = new double [3+this->NumberOfComponents+this->VolumePreservation];
+    this->TempQuad = new double[11 + 4 * this->NumberOfComponents+this->VolumePreservation];
+
+    this->TempB = new double [3 +  this->NumberOfComponents+this->VolumePreservation];
+    this->TempA = new double*[3 +  this->NumberOfComponents+this->VolumePreservation];
+    this->TempData = new double [(3 +  this->NumberOfComponents+this->VolumePreservation)*(3 +  this->NumberOfComponents+VolumePreservation)];
+    for (i = 0; i < 3 +  this->NumberOfComponents+this->VolumePreservation; i++)
+    {
+      this->TempA[i] = this->TempData+i*(3 +  this->NumberOfComponents+this->VolumePreservation);
+    }
+    this->TargetPoints->SetNumberOfComponents(3+this->NumberOfComponents+this->VolumePreservation);
   }
-  this->TargetPoints->SetNumberOfComponents(3+this->NumberOfComponents+this->VolumePreservation);
 
   vtkDebugMacro(<<"Computing Quadrics");
   this->InitializeQuadrics(numPts);
   this->AddBoundaryConstraints();
   this->UpdateProgress(0.15);
 
-  vtkDebugMacro(<<"Computing Costs");
-  // Compute the cost of and target point for collapsing each edge.
-  for (i = 0; i < this->Edges->GetNumberOfEdges(); i++)
+  if (this->EnableSMP)
   {
-    if (this->AttributeErrorMetric)
-    {
-      cost = this->ComputeCost2(i, x);
-    }
-    else
-    {
-      cost = this->ComputeCost(i, x);
-    }
-    this->EdgeCosts->Insert(cost, i);
-    this->TargetPoints->InsertTuple(i, x);
+    numDeletedTris = this->CollapseEdgesSMP(numTris);
+    cost = 0.0;
   }
-  this->UpdateProgress(0.20);
-
-  // Okay collapse edges until desired reduction is reached
-  this->ActualReduction = 0.0;
-  this->NumberOfEdgeCollapses = 0;
-  edgeId = this->EdgeCosts->Pop(0,cost);
-
-  int abort = 0;
-  while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
-         this->ActualReduction < this->TargetReduction )
+  else
   {
-    if ( ! (this->NumberOfEdgeCollapses % 10000) )
+    vtkDebugMacro(<<"Computing Costs");
+    // Compute the cost of and target point for collapsing each edge.
+    for (i = 0; i < this->Edges->GetNumberOfEdges(); i++)
     {
-      vtkDebugMacro(<<"Collapsing edge#" << this->NumberOfEdgeCollapses);
-      this->UpdateProgress (0.20 + 0.80*this->NumberOfEdgeCollapses/numPts);
-      abort = this->GetAbortExecute();
+      if (this->AttributeErrorMetric)
+      {
+        cost = this->ComputeCost2(i, x);
+      }
+      else
+      {
+        cost = this->ComputeCost(i, x);
+      }
+      this->EdgeCosts->Insert(cost, i);
+      this->TargetPoints->InsertTuple(i, x);
     }
+    this->UpdateProgress(0.20);
 
-    endPtIds[0] = this->EndPoint1List->GetId(edgeId);
-    endPtIds[1] = this->EndPoint2List->GetId(edgeId);
-    this->TargetPoints->GetTuple(edgeId, x);
+    // Okay collapse edges until desired reduction is reached
+    this->ActualReduction = 0.0;
+    this->NumberOfEdgeCollapses = 0;
+    edgeId = this->EdgeCosts->Pop(0,cost);
 
-    // check for a poorly placed point
-    if ( !this->IsGoodPlacement(endPtIds[0], endPtIds[1], x))
+    int abort = 0;
+    while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
+           this->ActualReduction < this->TargetReduction )
     {
-      vtkDebugMacro(<<"Poor placement detected " << edgeId << " " <<  cost);
-      // return the point to the queue but with the max cost so that
-      // when it is recomputed it will be reconsidered
-      this->EdgeCosts->Insert(VTK_DOUBLE_MAX, edgeId);
+      if ( ! (this->NumberOfEdgeCollapses % 10000) )
+      {
+        vtkDebugMacro(<<"Collapsing edge#" << this->NumberOfEdgeCollapses);
+        this->UpdateProgress (0.20 + 0.80*this->NumberOfEdgeCollapses/numPts);
+        abort = this->GetAbortExecute();
+      }
 
-      edgeId = this->EdgeCosts->Pop(0, cost);
-      continue;
-    }
+      endPtIds[0] = this->EndPoint1List->GetId(edgeId);
+      endPtIds[1] = this->EndPoint2List->GetId(edgeId);
+      this->TargetPoints->GetTuple(edgeId, x);
 
-    this->NumberOfEdgeCollapses++;
+      // check for a poorly placed point
+      if ( !this->IsGoodPlacement(endPtIds[0], endPtIds[1], x))
+      {
+        vtkDebugMacro(<<"Poor placement detected " << edgeId << " " <<  cost);
+        // return the point to the queue but with the max cost so that
+        // when it is recomputed it will be reconsidered
+        this->EdgeCosts->Insert(VTK_DOUBLE_MAX, edgeId);
+
+        edgeId = this->EdgeCosts->Pop(0, cost);
+        continue;
+      }
+
+      this->NumberOfEdgeCollapses++;
 
-    // Set the new coordinates of point0.
-    this->SetPointAttributeArray(endPtIds[0], x);
-    vtkDebugMacro(<<"Cost: " << cost << " Edge: "
-                  << endPtIds[0] << " " << endPtIds[1]);
+      // Set the new coordinates of point0.
+      this->SetPointAttributeArray(endPtIds[0], x);
+      vtkDebugMacro(<<"Cost: " << cost << " Edge: "
+                    << endPtIds[0] << " " << endPtIds[1]);
 
-    // Merge the quadrics of the two points.
-    this->AddQuadric(endPtIds[1], endPtIds[0]);
+      // Merge the quadrics of the two points.
+      this->AddQuadric(endPtIds[1], endPtIds[0]);
 
-    this->UpdateEdgeData(endPtIds[0], endPtIds[1]);
+      this->UpdateEdgeData(endPtIds[0], endPtIds[1]);
 
-    // Update the output triangles.
-    numDeletedTris += this->CollapseEdge(endPtIds[0], endPtIds[1]);
-    this->ActualReduction = (double) numDeletedTris / numTris;
-    edgeId = this->EdgeCosts->Pop(0, cost);
+      // Update the output triangles.
+      numDeletedTris += this->CollapseEdge(endPtIds[0], endPtIds[1]);
+      this->ActualReduction = (double) numDeletedTris / numTris;
+      edgeId = this->EdgeCosts->Pop(0, cost);
+    }
   }
 
   vtkDebugMacro(<<"Number Of Edge Collapses: "
@@ -824,6 +852,15 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
 
 //----------------------------------------------------------------------------
 double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
+{
+  return this->ComputeCost(this->EndPoint1List->GetId(edgeId),
+                           this->EndPoint2List->GetId(edgeId), x,
+                           this->TempQuad);
+}
+
+//----------------------------------------------------------------------------
+double vtkQuadricDecimation::ComputeCost(vtkIdType pt0Id, vtkIdType pt1Id,
+                                         double *x, double *tempQuad)
 {
   static const double errorNumber = 1e-10;
   double temp[3], A[3][3], b[3];
@@ -835,25 +872,25 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
   double v[3],  c, norm, normTemp,  temp2[3];
   double pt1[3], pt2[3];
 
-  pointIds[0] = this->EndPoint1List->GetId(edgeId);
-  pointIds[1] = this->EndPoint2List->GetId(edgeId);
+  pointIds[0] = pt0Id;
+  pointIds[1] = pt1Id;
 
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
   {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
+    tempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
       this->ErrorQuadrics[pointIds[1]].Quadric[i];
   }
 
-  A[0][0] = this->TempQuad[0];
-  A[0][1] = A[1][0] = this->TempQuad[1];
-  A[0][2] = A[2][0] = this->TempQuad[2];
-  A[1][1] = this->TempQuad[4];
-  A[1][2] = A[2][1] = this->TempQuad[5];
-  A[2][2] = this->TempQuad[7];
+  A[0][0] = tempQuad[0];
+  A[0][1] = A[1][0] = tempQuad[1];
+  A[0][2] = A[2][0] = tempQuad[2];
+  A[1][1] = tempQuad[4];
+  A[1][2] = A[2][1] = tempQuad[5];
+  A[2][2] = tempQuad[7];
 
-  b[0] = -this->TempQuad[3];
-  b[1] = -this->TempQuad[6];
-  b[2] = -this->TempQuad[8];
+  b[0] = -tempQuad[3];
+  b[1] = -tempQuad[6];
+  b[2] = -tempQuad[8];
 
   norm = vtkMath::Norm(A[0]);
   normTemp = vtkMath::Norm(A[1]);
@@ -907,7 +944,7 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
 
   // Compute the cost
   // x'*quad*x
-  index = this->TempQuad;
+  index = tempQuad;
   for (i = 0; i < 4; i++)
   {
     cost += (*index++)*newPoint[i]*newPoint[i];
@@ -923,6 +960,16 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
 
 //----------------------------------------------------------------------------
 double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
+{
+  return this->ComputeCost2(this->EndPoint1List->GetId(edgeId),
+                            this->EndPoint2List->GetId(edgeId), x,
+                            this->TempQuad, this->TempB, this->TempA);
+}
+
+//----------------------------------------------------------------------------
+double vtkQuadricDecimation::ComputeCost2(vtkIdType pt0Id, vtkIdType pt1Id,
+                                          double *x, double *tempQuad,
+                                          double *tempB, double **tempA)
 {
   // this function is so ugly because the functionality of converting an QEM
   // into a dense matrix was not extracted into a separate function and
@@ -933,34 +980,34 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
   int i, j;
   int solveOk;
 
-  pointIds[0] = this->EndPoint1List->GetId(edgeId);
-  pointIds[1] = this->EndPoint2List->GetId(edgeId);
+  pointIds[0] = pt0Id;
+  pointIds[1] = pt1Id;
 
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
   {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
+    tempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
       this->ErrorQuadrics[pointIds[1]].Quadric[i];
   }
 
   // copy the temp quad into TempA
   // converting from the sparse matrix format into a dense
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
+  tempA[0][0] = tempQuad[0];
+  tempA[0][1] = tempA[1][0] = tempQuad[1];
+  tempA[0][2] = tempA[2][0] = tempQuad[2];
+  tempA[1][1] = tempQuad[4];
+  tempA[1][2] = tempA[2][1] = tempQuad[5];
+  tempA[2][2] = tempQuad[7];
 
-  this->TempB[0] = -this->TempQuad[3];
-  this->TempB[1] = -this->TempQuad[6];
-  this->TempB[2] = -this->TempQuad[8];
+  tempB[0] = -tempQuad[3];
+  tempB[1] = -tempQuad[6];
+  tempB[2] = -tempQuad[8];
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
   {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
-    this->TempB[i] = -this->TempQuad[11+4*(i-3)+3];
+    tempA[0][i] = tempA[i][0] = tempQuad[11+4*(i-3)];
+    tempA[1][i] = tempA[i][1] = tempQuad[11+4*(i-3)+1];
+    tempA[2][i] = tempA[i][2] = tempQuad[11+4*(i-3)+2];
+    tempB[i] = -tempQuad[11+4*(i-3)+3];
   }
 
 
@@ -971,11 +1018,11 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i == j)
       {
-        this->TempA[i][j] = this->TempQuad[10];
+        tempA[i][j] = tempQuad[10];
       }
       else
       {
-        this->TempA[i][j] = 0;
+        tempA[i][j] = 0;
       }
     }
   }
@@ -986,45 +1033,45 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i >= 3)
       {
-        this->TempA[i][3 + this->NumberOfComponents] = 0;
-        this->TempA[3 + this->NumberOfComponents][i] = 0;
+        tempA[i][3 + this->NumberOfComponents] = 0;
+        tempA[3 + this->NumberOfComponents][i] = 0;
       }
       else
       {
-        this->TempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        tempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        tempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        tempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        tempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
       }
     }
     // Add constraint to b
-    this->TempB[3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + 3];
-    this->TempB[3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + 3];
+    tempB[3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + 3];
+    tempB[3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + 3];
   }
 
   for (i = 0; i < 3 + this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    x[i] = this->TempB[i];
+    x[i] = tempB[i];
   }
 
   // solve A*x = b
   // this clobers A
   // need to develop a quality of the solution test??
-  solveOk = vtkMath::SolveLinearSystem(this->TempA, x, 3 + this->NumberOfComponents + this->VolumePreservation);
+  solveOk = vtkMath::SolveLinearSystem(tempA, x, 3 + this->NumberOfComponents + this->VolumePreservation);
 
   // need to copy back into A
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
+  tempA[0][0] = tempQuad[0];
+  tempA[0][1] = tempA[1][0] = tempQuad[1];
+  tempA[0][2] = tempA[2][0] = tempQuad[2];
+  tempA[1][1] = tempQuad[4];
+  tempA[1][2] = tempA[2][1] = tempQuad[5];
+  tempA[2][2] = tempQuad[7];
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
   {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
+    tempA[0][i] = tempA[i][0] = tempQuad[11+4*(i-3)];
+    tempA[1][i] = tempA[i][1] = tempQuad[11+4*(i-3)+1];
+    tempA[2][i] = tempA[i][2] = tempQuad[11+4*(i-3)+2];
   }
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
@@ -1033,11 +1080,11 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i == j)
       {
-        this->TempA[i][j] = this->TempQuad[10];
+        tempA[i][j] = tempQuad[10];
       }
       else
       {
-        this->TempA[i][j] = 0;
+        tempA[i][j] = 0;
       }
     }
   }
@@ -1048,15 +1095,15 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i >= 3)
       {
-        this->TempA[i][3 + this->NumberOfComponents] = 0;
-        this->TempA[3 + this->NumberOfComponents][i] = 0;
+        tempA[i][3 + this->NumberOfComponents] = 0;
+        tempA[3 + this->NumberOfComponents][i] = 0;
       }
       else
       {
-        this->TempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        tempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        tempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        tempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        tempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
       }
     }
   }
@@ -1089,7 +1136,7 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
       temp2[i] = 0;
       for (j = 0; j < 3 + this->NumberOfComponents; ++j)
       {
-        temp2[i] += this->TempA[i][j]*v[j];
+        temp2[i] += tempA[i][j]*v[j];
       }
     }
 
@@ -1107,13 +1154,13 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
         temp[i] = 0;
         for (j = 0; j < 3 + this->NumberOfComponents; ++j)
         {
-          temp[i] += this->TempA[i][j]*pt1[j];
+          temp[i] += tempA[i][j]*pt1[j];
         }
       }
 
       for (i = 0; i < 3 + this->NumberOfComponents; i++)
       {
-        temp[i] = this->TempB[i] - temp[i];
+        temp[i] = tempB[i] - temp[i];
       }
 
       for (i = 0; i < 3 + this->NumberOfComponents; i++)
@@ -1147,23 +1194,267 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
   // x'*A*x - 2*b*x + d
   for (i = 0; i < 3+this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    cost += this->TempA[i][i]*x[i]*x[i];
+    cost += tempA[i][i]*x[i]*x[i];
     for (j = i+1; j < 3+this->NumberOfComponents + this->VolumePreservation; j++)
     {
-      cost += 2.0*this->TempA[i][j]*x[i]*x[j];
+      cost += 2.0*tempA[i][j]*x[i]*x[j];
     }
   }
   for (i = 0; i < 3+this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    cost -=  2.0 * this->TempB[i]*x[i];
+    cost -=  2.0 * tempB[i]*x[i];
   }
 
-  cost += this->TempQuad[9];
+  cost += tempQuad[9];
 
   return cost;
 }
 
 
+namespace
+{
+
+// An edge of the working mesh (Pt0 < Pt1), the cost of collapsing it, and
+// the index of its target point.
+struct vtkQuadricEdge
+{
+  double Cost;
+  vtkIdType Pt0;
+  vtkIdType Pt1;
+  vtkIdType Id;
+};
+
+// Ties are broken by the end points so that the order of the edges, and
+// thus the output, does not depend on the number of threads.
+bool vtkQuadricEdgeCostLess(const vtkQuadricEdge &a, const vtkQuadricEdge &b)
+{
+  return a.Cost < b.Cost || (a.Cost == b.Cost &&
+    (a.Pt0 < b.Pt0 || (a.Pt0 == b.Pt0 && a.Pt1 < b.Pt1)));
+}
+
+// List the edges of the remaining triangles from the point links: each
+// point lists the edges to its neighbors of larger id, in increasing order.
+// The first pass counts the edges of each point, the second one fills them
+// in at the given offsets.
+class vtkQuadricGatherEdges
+{
+public:
+  vtkPolyData *Mesh;
+  vtkIdType *Counts;
+  const vtkIdType *Offsets;
+  vtkQuadricEdge *Edges;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Neighbors;
+
+  vtkQuadricGatherEdges(vtkPolyData *mesh, vtkIdType *counts,
+                        const vtkIdType *offsets, vtkQuadricEdge *edges) :
+    Mesh(mesh), Counts(counts), Offsets(offsets), Edges(edges)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    std::vector<vtkIdType> &neighbors = this->Neighbors.Local();
+    unsigned short ncells;
+    vtkIdType *cells, npts, *pts;
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      neighbors.clear();
+      this->Mesh->GetPointCells(ptId, ncells, cells);
+      for (unsigned short i = 0; i < ncells; ++i)
+      {
+        this->Mesh->GetCellPoints(cells[i], npts, pts);
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          if (pts[j] > ptId)
+          {
+            neighbors.push_back(pts[j]);
+          }
+        }
+      }
+      std::sort(neighbors.begin(), neighbors.end());
+      vtkIdType numNeighbors = static_cast<vtkIdType>(
+        std::unique(neighbors.begin(), neighbors.end()) - neighbors.begin());
+      if (!this->Edges)
+      {
+        this->Counts[ptId] = numNeighbors;
+        continue;
+      }
+      vtkQuadricEdge *edge = this->Edges + this->Offsets[ptId];
+      for (vtkIdType j = 0; j < numNeighbors; ++j, ++edge)
+      {
+        edge->Pt0 = ptId;
+        edge->Pt1 = neighbors[j];
+      }
+    }
+  }
+};
+
+// Mark the points of the triangles using ptId.
+void vtkQuadricLockNeighborhood(vtkPolyData *mesh, vtkIdType ptId,
+                                std::vector<unsigned char> &locked)
+{
+  unsigned short ncells;
+  vtkIdType *cells, npts, *pts;
+  mesh->GetPointCells(ptId, ncells, cells);
+  for (unsigned short i = 0; i < ncells; ++i)
+  {
+    mesh->GetCellPoints(cells[i], npts, pts);
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      locked[pts[j]] = 1;
+    }
+  }
+  locked[ptId] = 1;
+}
+
+}
+
+//----------------------------------------------------------------------------
+// Computes the edge costs of a round in parallel
+struct vtkQuadricEdgeCostWorker
+{
+  vtkQuadricDecimation *Self;
+  vtkQuadricEdge *Edges;
+  double *Targets;
+  int Size;
+  vtkSMPThreadLocal<std::vector<double> > TempQuad;
+  vtkSMPThreadLocal<std::vector<double> > TempB;
+  vtkSMPThreadLocal<std::vector<double> > TempData;
+  vtkSMPThreadLocal<std::vector<double*> > TempA;
+
+  vtkQuadricEdgeCostWorker(vtkQuadricDecimation *self, vtkQuadricEdge *edges,
+                 double *targets) : Self(self), Edges(edges), Targets(targets)
+  {
+    this->Size = 3 + self->NumberOfComponents + self->VolumePreservation;
+  }
+
+  void Initialize()
+  {
+    this->TempQuad.Local().resize(
+      11 + 4*this->Self->NumberOfComponents + this->Self->VolumePreservation);
+    this->TempB.Local().resize(this->Size);
+    std::vector<double> &data = this->TempData.Local();
+    data.resize(this->Size * this->Size);
+    std::vector<double*> &a = this->TempA.Local();
+    a.resize(this->Size);
+    for (int i = 0; i < this->Size; ++i)
+    {
+      a[i] = &data[i * this->Size];
+    }
+  }
+
+  void operator()(vtkIdType edgeId, vtkIdType endEdgeId)
+  {
+    double *quad = &this->TempQuad.Local()[0];
+    double *b = &this->TempB.Local()[0];
+    double **a = &this->TempA.Local()[0];
+    for ( ; edgeId < endEdgeId; ++edgeId)
+    {
+      vtkQuadricEdge &edge = this->Edges[edgeId];
+      double *x = this->Targets + edgeId * this->Size;
+      edge.Id = edgeId;
+      if (this->Self->AttributeErrorMetric)
+      {
+        edge.Cost = this->Self->ComputeCost2(edge.Pt0, edge.Pt1, x, quad, b, a);
+      }
+      else
+      {
+        edge.Cost = this->Self->ComputeCost(edge.Pt0, edge.Pt1, x, quad);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+// Each round lists the edges of the remaining triangles, computes their
+// costs in parallel and sorts them. Going through the cheapest half in order
+// of cost, an edge is collapsed unless one of its end points belongs to a
+// triangle modified earlier in the round, so that the collapses of a round
+// are independent and the costs they rely on are up to date.
+vtkIdType vtkQuadricDecimation::CollapseEdgesSMP(vtkIdType numTris)
+{
+  vtkIdType numPts = this->Mesh->GetNumberOfPoints();
+  int size = 3 + this->NumberOfComponents + this->VolumePreservation;
+  std::vector<vtkIdType> counts(numPts);
+  std::vector<vtkQuadricEdge> edges;
+  std::vector<double> targets;
+  std::vector<unsigned char> locked(numPts);
+  vtkIdType numDeletedTris = 0;
+
+  this->ActualReduction = 0.0;
+  this->NumberOfEdgeCollapses = 0;
+  int abort = 0;
+  while ( !abort && numPts > 0 &&
+          this->ActualReduction < this->TargetReduction )
+  {
+    vtkQuadricGatherEdges counter(this->Mesh, &counts[0], NULL, NULL);
+    vtkSMPTools::For(0, numPts, counter);
+    vtkIdType numEdges = 0;
+    for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+    {
+      vtkIdType count = counts[ptId];
+      counts[ptId] = numEdges;
+      numEdges += count;
+    }
+    if (numEdges == 0)
+    {
+      break;
+    }
+    edges.resize(numEdges);
+    vtkQuadricGatherEdges gather(this->Mesh, NULL, &counts[0], &edges[0]);
+    vtkSMPTools::For(0, numPts, gather);
+
+    targets.resize(numEdges * size);
+    vtkQuadricEdgeCostWorker worker(this, &edges[0], &targets[0]);
+    vtkSMPTools::For(0, numEdges, worker);
+    vtkSMPTools::Sort(edges.begin(), edges.end(), vtkQuadricEdgeCostLess);
+
+    std::fill(locked.begin(), locked.end(), 0);
+    vtkIdType numCandidates = (numEdges + 1) / 2;
+    vtkIdType numCollapses = 0;
+    for (vtkIdType i = 0; i < numCandidates &&
+           this->ActualReduction < this->TargetReduction; ++i)
+    {
+      const vtkQuadricEdge &edge = edges[i];
+      if (edge.Cost >= VTK_DOUBLE_MAX)
+      {
+        break;
+      }
+      const double *x = &targets[edge.Id * size];
+      if (locked[edge.Pt0] || locked[edge.Pt1] ||
+          !this->IsGoodPlacement(edge.Pt0, edge.Pt1, x))
+      {
+        continue;
+      }
+      vtkQuadricLockNeighborhood(this->Mesh, edge.Pt0, locked);
+      vtkQuadricLockNeighborhood(this->Mesh, edge.Pt1, locked);
+
+      this->SetPointAttributeArray(edge.Pt0, x);
+      this->AddQuadric(edge.Pt1, edge.Pt0);
+      numDeletedTris += this->CollapseEdge(edge.Pt0, edge.Pt1);
+      this->ActualReduction = static_cast<double>(numDeletedTris) / numTris;
+      this->NumberOfEdgeCollapses++;
+      numCollapses++;
+    }
+    vtkDebugMacro(<<"Collapsed " << numCollapses << " of " << numEdges
+                  << " edges");
+    if (numCollapses == 0)
+    {
+      break;
+    }
+
+    this->UpdateProgress(0.20 + 0.80 *
+      std::min(1.0, this->ActualReduction / this->TargetReduction));
+    abort = this->GetAbortExecute();
+  }
+
+  return numDeletedTris;
+}
+
 int vtkQuadricDecimation::CollapseEdge(vtkIdType pt0Id, vtkIdType pt1Id)
 {
   int j, numDeleted=0;
@@ -1455,4 +1746,5 @@ void vtkQuadricDecimation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Normals Weight: " << this->NormalsWeight << "\n";
   os << indent << "TCoords Weight: " << this->TCoordsWeight << "\n";
   os << indent << "Tensors Weight: " << this->TensorsWeight << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -156,6 +156,21 @@ public:
   vtkGetMacro(ActualReduction, double);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded decimation. Instead of collapsing one edge at
+   * a time from a global priority queue, the decimation then proceeds in
+   * rounds: the costs of all the edges are computed in parallel and sorted,
+   * and edges taken from the cheapest half are collapsed in order of cost
+   * as long as their neighborhoods do not overlap those of the edges
+   * already collapsed in the round. The output is independent of the number
+   * of threads, but differs from the serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkQuadricDecimation();
   ~vtkQuadricDecimation() VTK_OVERRIDE;
@@ -198,6 +213,26 @@ protected:
   double ComputeCost2(vtkIdType edgeId, double *x);
   //@}
 
+  //@{
+  /**
+   * Same as above for the edge between pt0Id and pt1Id, using the given
+   * scratch space instead of the temporary variables, so that costs can be
+   * computed concurrently.
+   */
+  double ComputeCost(vtkIdType pt0Id, vtkIdType pt1Id, double *x,
+                     double *tempQuad);
+  double ComputeCost2(vtkIdType pt0Id, vtkIdType pt1Id, double *x,
+                      double *tempQuad, double *tempB, double **tempA);
+  //@}
+
+  /**
+   * Collapse edges in rounds of non-overlapping collapses (EnableSMP);
+   * return the number of triangles deleted.
+   */
+  vtkIdType CollapseEdgesSMP(vtkIdType numTris);
+
+  friend struct vtkQuadricEdgeCostWorker;
+
   /**
    * Find all edges that will have an endpoint change ids because of an edge
    * collapse.  p1Id and p2Id are the endpoints of the edge.  p2Id is the
@@ -247,6 +282,8 @@ protected:
   double TCoordsWeight;
   double TensorsWeight;
 
+  bool EnableSMP;
+
   int               NumberOfEdgeCollapses;
   vtkEdgeTable     *Edges;
   vtkIdList        *EndPoint1List;
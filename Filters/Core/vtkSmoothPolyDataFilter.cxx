@@ -25,10 +25,14 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTriangleFilter.h"
 
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 vtkStandardNewMacro(vtkSmoothPolyDataFilter);
 
@@ -129,6 +133,7 @@ vtkSmoothPolyDataFilter::vtkSmoothPolyDataFilter()
   this->GenerateErrorVectors = 0;
 
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = false;
 
   this->SmoothPoints = NULL;
 
@@ -279,6 +284,140 @@ template<typename T> void vtkSPDF_MovePoints(vtkSPDF_InternalParams<T>& params)
   vtkDebugWithObjectMacro(params.spdf, << "Performed " << iterationNumber << " smoothing passes");
 }
 
+// One threaded smoothing pass: every point is moved from its position in
+// Current, and written to Next. The connected vertices of point i are
+// Edges[Offsets[i]] ... Edges[Offsets[i+1]-1].
+template<typename T> class vtkSPDF_SmoothPass
+{
+public:
+  const vtkMeshVertex *Verts;
+  const vtkIdType *Offsets;
+  const vtkIdType *Edges;
+  T Factor;
+  T *Current;
+  T *Next;
+  vtkSMPThreadLocal<T> MaxDist;
+
+  vtkSPDF_SmoothPass(const vtkMeshVertex *verts, const vtkIdType *offsets,
+                     const vtkIdType *edges, T factor)
+    : Verts(verts), Offsets(offsets), Edges(edges), Factor(factor),
+      Current(NULL), Next(NULL), MaxDist(0)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    T &maxDist = this->MaxDist.Local();
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const T *x = this->Current + 3 * i;
+      T *xNew = this->Next + 3 * i;
+      const vtkIdType npts = this->Offsets[i + 1] - this->Offsets[i];
+      if (this->Verts[i].type == VTK_FIXED_VERTEX || npts == 0)
+      {
+        xNew[0] = x[0];
+        xNew[1] = x[1];
+        xNew[2] = x[2];
+        continue;
+      }
+
+      // Compute the mean (cumulated) direction vector
+      T deltaX[3] = { 0.0, 0.0, 0.0 };
+      const vtkIdType *edgeIdPtr = this->Edges + this->Offsets[i];
+      for (vtkIdType j = 0; j < npts; ++j)
+      {
+        for (unsigned short k = 0; k < 3; ++k)
+        {
+          deltaX[k] += this->Current[3 * edgeIdPtr[j] + k];
+        }
+      }
+
+      // Move the point
+      for (unsigned short k = 0; k < 3; ++k)
+      {
+        xNew[k] = x[k] + this->Factor * (deltaX[k] / npts - x[k]);
+      }
+
+      T dist = vtkMath::Norm(deltaX);
+      if (dist > maxDist)
+      {
+        maxDist = dist;
+      }
+    }
+  }
+
+  // Largest motion of the last pass. Resets the per thread maxima.
+  T ReduceMaxDist()
+  {
+    T maxDist = 0.0;
+    typename vtkSMPThreadLocal<T>::iterator iter;
+    for (iter = this->MaxDist.begin(); iter != this->MaxDist.end(); ++iter)
+    {
+      maxDist = std::max(maxDist, *iter);
+      *iter = 0.0;
+    }
+    return maxDist;
+  }
+};
+
+// Same as vtkSPDF_MovePoints() without a source, with threaded passes over
+// two buffers of points.
+template<typename T> void vtkSPDF_MovePointsSMP(
+  vtkSPDF_InternalParams<T>& params)
+{
+  // Connected vertices of all points, in compressed rows.
+  std::vector<vtkIdType> offsets(params.numPts + 1, 0);
+  for (vtkIdType i = 0; i < params.numPts; ++i)
+  {
+    vtkIdList *edges = params.vertexPtr[i].edges;
+    offsets[i + 1] = offsets[i] + (edges ? edges->GetNumberOfIds() : 0);
+  }
+  std::vector<vtkIdType> edgeIds(offsets[params.numPts] + 1);
+  for (vtkIdType i = 0; i < params.numPts; ++i)
+  {
+    vtkIdList *edges = params.vertexPtr[i].edges;
+    if (edges)
+    {
+      std::copy(edges->GetPointer(0),
+                edges->GetPointer(0) + edges->GetNumberOfIds(),
+                edgeIds.begin() + offsets[i]);
+    }
+  }
+
+  T* coords = static_cast<T*>(params.newPts->GetVoidPointer(0));
+  std::vector<T> buffer(3 * params.numPts);
+  vtkSPDF_SmoothPass<T> pass(params.vertexPtr, &offsets[0], &edgeIds[0],
+                             params.factor);
+  pass.Current = coords;
+  pass.Next = &buffer[0];
+
+  int iterationNumber = 0;
+  for (T maxDist = std::numeric_limits<T>::max();
+       maxDist > params.conv && iterationNumber < params.numberOfIterations;
+       ++iterationNumber)
+  {
+    if (iterationNumber && !(iterationNumber % 5))
+    {
+      params.spdf->UpdateProgress(0.5 + 0.5*iterationNumber / params.numberOfIterations);
+      if (params.spdf->GetAbortExecute())
+      {
+        break;
+      }
+    }
+
+    vtkSMPTools::For(0, params.numPts, pass);
+    maxDist = pass.ReduceMaxDist();
+    std::swap(pass.Current, pass.Next);
+  }
+
+  if (pass.Current != coords)
+  {
+    std::copy(pass.Current, pass.Current + 3 * params.numPts, coords);
+  }
+  params.newPts->Modified();
+
+  vtkDebugWithObjectMacro(params.spdf, << "Performed " << iterationNumber << " smoothing passes");
+}
+
 }// namespace
 
 int vtkSmoothPolyDataFilter::RequestData(
@@ -686,7 +825,14 @@ int vtkSmoothPolyDataFilter::RequestData(
                                               Verts, source, this->SmoothPoints,
                                               w, cellLocator };
 
-    vtkSPDF_MovePoints(params);
+    if (this->EnableSMP && !source)
+    {
+      vtkSPDF_MovePointsSMP(params);
+    }
+    else
+    {
+      vtkSPDF_MovePoints(params);
+    }
   }
   else
   {
@@ -695,7 +841,14 @@ int vtkSmoothPolyDataFilter::RequestData(
                                              static_cast<float>(conv), numPts, Verts,
                                              source, this->SmoothPoints, w, cellLocator };
 
-    vtkSPDF_MovePoints(params);
+    if (this->EnableSMP && !source)
+    {
+      vtkSPDF_MovePointsSMP(params);
+    }
+    else
+    {
+      vtkSPDF_MovePoints(params);
+    }
   }
 
   if ( source )
@@ -805,4 +958,5 @@ void vtkSmoothPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
   }
 
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -215,6 +215,21 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation of the smoothing iterations.
+   * The serial iteration moves each point using the positions its neighbors
+   * were already moved to during the same pass; the threaded one moves all
+   * points from the positions of the previous pass (using two buffers), so
+   * results differ slightly from the serial ones, typically by a few percent
+   * of the point motion for a relaxation factor of 0.1. Smoothing
+   * constrained to a Source is always serial. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkSmoothPolyDataFilter();
   ~vtkSmoothPolyDataFilter() VTK_OVERRIDE {}
@@ -232,6 +247,7 @@ protected:
   int GenerateErrorScalars;
   int GenerateErrorVectors;
   int OutputPointsPrecision;
+  bool EnableSMP;
 
   vtkSmoothPoints *SmoothPoints;
 private:
@@ -21,14 +21,22 @@
 #include "vtkDataSet.h"
 #include "vtkExecutive.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTransform.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkTensorGlyph);
 
 // Construct object with scaling on and scale factor 1.0. Eigenvalues are
@@ -46,6 +54,7 @@ vtkTensorGlyph::vtkTensorGlyph()
   this->ThreeGlyphs = 0;
   this->Symmetric = 0;
   this->Length = 1.0;
+  this->EnableSMP = false;
 
   this->SetNumberOfInputPorts(2);
 
@@ -160,6 +169,12 @@ int vtkTensorGlyph::RequestData(
     return 1;
   }
 
+  if (this->EnableSMP)
+  {
+    this->ExecuteSMP(input, source, inTensors, inScalars, output);
+    return 1;
+  }
+
   pts = new vtkIdType[source->GetMaxCellSize()];
   trans = vtkTransform::New();
   matrix = vtkMatrix4x4::New();
@@ -491,6 +506,425 @@ int vtkTensorGlyph::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+// Fill the glyphs of a range of input points. The glyphs of a point start
+// at a fixed offset, so that all of them are filled concurrently.
+struct GenerateTensorGlyphs
+{
+  vtkDataSet *Input;
+  vtkDataArray *Tensors;
+  vtkDataArray *Scalars; // input scalars used for coloring, if any
+  bool ColorByEigenvalues;
+  int ExtractEigenvalues;
+  int ClampScaling;
+  int ThreeGlyphs;
+  int NumberOfDirections;
+  double ScaleFactor;
+  double MaxScaleFactor;
+  double Length;
+
+  const double *SourcePoints;
+  const double *SourceNormals; // NULL without source normals
+  vtkIdType NumberOfSourcePoints;
+  // connectivity of the verts, lines, polys and strips of the source
+  const vtkIdType *SourceCells[4];
+  vtkIdType NumberOfSourceEntries[4];
+
+  float *Points;
+  float *Normals;
+  float *OutScalars;
+  vtkIdType *Connectivity[4];
+
+  vtkSMPThreadLocalObject<vtkTransform> Transform;
+  vtkSMPThreadLocalObject<vtkMatrix4x4> Matrix;
+
+  void Initialize()
+  {
+    this->Transform.Local()->PreMultiply();
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkTransform *trans = this->Transform.Local();
+    vtkMatrix4x4 *matrix = this->Matrix.Local();
+    double tensor[9], x[3], maxScale, normalMatrix[4][4];
+    double *m[3], w[3], *v[3];
+    double m0[3], m1[3], m2[3];
+    double v0[3], v1[3], v2[3];
+    double xv[3], yv[3], zv[3];
+    m[0] = m0; m[1] = m1; m[2] = m2;
+    v[0] = v0; v[1] = v1; v[2] = v2;
+    int numDirs = this->NumberOfDirections;
+    vtkIdType numSourcePts = this->NumberOfSourcePoints;
+
+    for (vtkIdType inPtId = begin; inPtId < end; ++inPtId)
+    {
+      vtkIdType ptIncr = numDirs * inPtId * numSourcePts;
+
+      // Symmetric tensor support
+      this->Tensors->GetTuple(inPtId, tensor);
+      if (this->Tensors->GetNumberOfComponents() == 6)
+      {
+        vtkMath::TensorFromSymmetricTensor(tensor);
+      }
+
+      // compute orientation vectors and scale factors from tensor
+      if (this->ExtractEigenvalues)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          for (int i = 0; i < 3; ++i)
+          {
+            m[i][j] = tensor[i+3*j];
+          }
+        }
+        vtkMath::Jacobi(m, w, v);
+
+        xv[0] = v[0][0]; xv[1] = v[1][0]; xv[2] = v[2][0];
+        yv[0] = v[0][1]; yv[1] = v[1][1]; yv[2] = v[2][1];
+        zv[0] = v[0][2]; zv[1] = v[1][2]; zv[2] = v[2][2];
+      }
+      else
+      {
+        for (int i = 0; i < 3; ++i)
+        {
+          xv[i] = tensor[i];
+          yv[i] = tensor[i+3];
+          zv[i] = tensor[i+6];
+        }
+        w[0] = vtkMath::Normalize(xv);
+        w[1] = vtkMath::Normalize(yv);
+        w[2] = vtkMath::Normalize(zv);
+      }
+
+      // compute scale factors
+      for (int i = 0; i < 3; ++i)
+      {
+        w[i] *= this->ScaleFactor;
+      }
+      if (this->ClampScaling)
+      {
+        maxScale = 0.0;
+        for (int i = 0; i < 3; ++i)
+        {
+          if (maxScale < fabs(w[i]))
+          {
+            maxScale = fabs(w[i]);
+          }
+        }
+        if (maxScale > this->MaxScaleFactor)
+        {
+          maxScale = this->MaxScaleFactor / maxScale;
+          for (int i = 0; i < 3; ++i)
+          {
+            w[i] *= maxScale; //preserve overall shape of glyph
+          }
+        }
+      }
+
+      // make sure scale is okay (non-zero)
+      maxScale = 0.0;
+      for (int i = 0; i < 3; ++i)
+      {
+        if (w[i] > maxScale)
+        {
+          maxScale = w[i];
+        }
+      }
+      if (maxScale == 0.0)
+      {
+        maxScale = 1.0;
+      }
+      for (int i = 0; i < 3; ++i)
+      {
+        if (w[i] == 0.0)
+        {
+          w[i] = maxScale * 1.0e-06;
+        }
+      }
+
+      double s = 0.0;
+      if (this->OutScalars && !this->ColorByEigenvalues)
+      {
+        s = this->Scalars->GetComponent(inPtId, 0);
+      }
+      this->Input->GetPoint(inPtId, x);
+
+      for (int dir = 0; dir < numDirs; ++dir, ptIncr += numSourcePts)
+      {
+        int eigen_dir = dir%(this->ThreeGlyphs?3:1);
+        int symmetric_dir = dir/(this->ThreeGlyphs?3:1);
+
+        trans->Identity();
+        trans->Translate(x[0], x[1], x[2]);
+
+        // normalized eigenvectors rotate object for eigen direction 0
+        matrix->Element[0][0] = xv[0];
+        matrix->Element[0][1] = yv[0];
+        matrix->Element[0][2] = zv[0];
+        matrix->Element[1][0] = xv[1];
+        matrix->Element[1][1] = yv[1];
+        matrix->Element[1][2] = zv[1];
+        matrix->Element[2][0] = xv[2];
+        matrix->Element[2][1] = yv[2];
+        matrix->Element[2][2] = zv[2];
+        trans->Concatenate(matrix);
+
+        if (eigen_dir == 1)
+        {
+          trans->RotateZ(90.0);
+        }
+        if (eigen_dir == 2)
+        {
+          trans->RotateY(-90.0);
+        }
+        if (this->ThreeGlyphs)
+        {
+          trans->Scale(w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
+        }
+        else
+        {
+          trans->Scale(w[0], w[1], w[2]);
+        }
+        // Mirror second set to the symmetric position
+        if (symmetric_dir == 1)
+        {
+          trans->Scale(-1.,1.,1.);
+        }
+        // if the eigenvalue is negative, shift to reverse direction.
+        if (w[eigen_dir] < 0 && numDirs > 1)
+        {
+          trans->Translate(-this->Length, 0., 0.);
+        }
+
+        double (*elements)[4] = trans->GetMatrix()->Element;
+        const double *p = this->SourcePoints;
+        float *outPt = this->Points + 3 * ptIncr;
+        for (vtkIdType i = 0; i < numSourcePts; ++i, p += 3, outPt += 3)
+        {
+          for (int j = 0; j < 3; ++j)
+          {
+            outPt[j] = static_cast<float>(elements[j][0]*p[0] +
+                                          elements[j][1]*p[1] +
+                                          elements[j][2]*p[2] +
+                                          elements[j][3]);
+          }
+        }
+
+        if (this->Normals)
+        {
+          // a negative determinant turns the glyph inside out: flip the
+          // normals so that they point outward.
+          if (trans->GetMatrix()->Determinant() < 0)
+          {
+            trans->Scale(-1.0,-1.0,-1.0);
+          }
+          // to transform the normals, multiply by the transposed inverse
+          vtkMatrix4x4::DeepCopy(*normalMatrix, trans->GetMatrix());
+          vtkMatrix4x4::Invert(*normalMatrix, *normalMatrix);
+          vtkMatrix4x4::Transpose(*normalMatrix, *normalMatrix);
+          const double *n = this->SourceNormals;
+          float *outN = this->Normals + 3 * ptIncr;
+          for (vtkIdType i = 0; i < numSourcePts; ++i, n += 3, outN += 3)
+          {
+            for (int j = 0; j < 3; ++j)
+            {
+              outN[j] = static_cast<float>(normalMatrix[j][0]*n[0] +
+                                           normalMatrix[j][1]*n[1] +
+                                           normalMatrix[j][2]*n[2]);
+            }
+            vtkMath::Normalize(outN);
+          }
+        }
+
+        if (this->OutScalars)
+        {
+          // If ThreeGlyphs is false we use the first (largest)
+          // eigenvalue as scalar.
+          float value = static_cast<float>(
+            this->ColorByEigenvalues ? w[eigen_dir] : s);
+          for (vtkIdType i = ptIncr; i < ptIncr + numSourcePts; ++i)
+          {
+            this->OutScalars[i] = value;
+          }
+        }
+      }
+
+      // Copy the topology: for each source cell, one cell per direction.
+      ptIncr = numDirs * inPtId * numSourcePts;
+      for (int type = 0; type < 4; ++type)
+      {
+        const vtkIdType *cells = this->SourceCells[type];
+        const vtkIdType *cellsEnd = cells + this->NumberOfSourceEntries[type];
+        vtkIdType *outCells = this->Connectivity[type] +
+          numDirs * inPtId * this->NumberOfSourceEntries[type];
+        for (; cells < cellsEnd; cells += *cells + 1)
+        {
+          vtkIdType npts = *cells;
+          for (int dir = 0; dir < numDirs; ++dir)
+          {
+            vtkIdType subIncr = ptIncr + dir*numSourcePts;
+            *outCells++ = npts;
+            for (vtkIdType i = 1; i <= npts; ++i)
+            {
+              *outCells++ = cells[i] + subIncr;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+} // end anon namespace
+
+//----------------------------------------------------------------------------
+void vtkTensorGlyph::ExecuteSMP(vtkDataSet *input, vtkPolyData *source,
+                                vtkDataArray *inTensors,
+                                vtkDataArray *inScalars, vtkPolyData *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  int numDirs = (this->ThreeGlyphs?3:1)*(this->Symmetric+1);
+  vtkPointData *outPD = output->GetPointData();
+  vtkPointData *pd = source->GetPointData();
+
+  // Gather the source geometry once, in double precision.
+  vtkIdType numSourcePts = source->GetNumberOfPoints();
+  std::vector<double> sourcePts(3 * numSourcePts + 3);
+  for (vtkIdType i = 0; i < numSourcePts; ++i)
+  {
+    source->GetPoint(i, &sourcePts[3 * i]);
+  }
+  vtkDataArray *sourceNormals = pd->GetNormals();
+  std::vector<double> sourceNormalTuples;
+  if (sourceNormals)
+  {
+    sourceNormalTuples.resize(3 * numSourcePts + 3);
+    for (vtkIdType i = 0; i < numSourcePts; ++i)
+    {
+      sourceNormals->GetTuple(i, &sourceNormalTuples[3 * i]);
+    }
+  }
+
+  vtkIdType numOutPts = numDirs * numPts * numSourcePts;
+  vtkNew<vtkPoints> newPts;
+  newPts->SetNumberOfPoints(numOutPts);
+
+  vtkSmartPointer<vtkFloatArray> newScalars;
+  bool colorByEigenvalues = this->ColorMode == COLOR_BY_EIGENVALUES;
+  if (this->ColorGlyphs && (colorByEigenvalues || inScalars))
+  {
+    newScalars = vtkSmartPointer<vtkFloatArray>::New();
+    newScalars->SetNumberOfTuples(numOutPts);
+    newScalars->SetName(colorByEigenvalues ? "MaxEigenvalue" :
+                        inScalars->GetName());
+  }
+  vtkSmartPointer<vtkFloatArray> newNormals;
+  if (sourceNormals)
+  {
+    newNormals = vtkSmartPointer<vtkFloatArray>::New();
+    newNormals->SetNumberOfComponents(3);
+    newNormals->SetName("Normals");
+    newNormals->SetNumberOfTuples(numOutPts);
+  }
+
+  GenerateTensorGlyphs generate;
+  generate.Input = input;
+  generate.Tensors = inTensors;
+  generate.Scalars = inScalars;
+  generate.ColorByEigenvalues = colorByEigenvalues;
+  generate.ExtractEigenvalues = this->ExtractEigenvalues;
+  generate.ClampScaling = this->ClampScaling;
+  generate.ThreeGlyphs = this->ThreeGlyphs;
+  generate.NumberOfDirections = numDirs;
+  generate.ScaleFactor = this->ScaleFactor;
+  generate.MaxScaleFactor = this->MaxScaleFactor;
+  generate.Length = this->Length;
+  generate.SourcePoints = &sourcePts[0];
+  generate.SourceNormals = sourceNormals ? &sourceNormalTuples[0] : NULL;
+  generate.NumberOfSourcePoints = numSourcePts;
+  generate.Points =
+    static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0);
+  generate.Normals = newNormals ? newNormals->GetPointer(0) : NULL;
+  generate.OutScalars = newScalars ? newScalars->GetPointer(0) : NULL;
+
+  vtkCellArray *sourceCells[4] = { source->GetVerts(), source->GetLines(),
+                                   source->GetPolys(), source->GetStrips() };
+  vtkSmartPointer<vtkIdTypeArray> conn[4];
+  for (int type = 0; type < 4; ++type)
+  {
+    vtkIdType numEntries = sourceCells[type]->GetNumberOfConnectivityEntries();
+    conn[type] = vtkSmartPointer<vtkIdTypeArray>::New();
+    conn[type]->SetNumberOfTuples(numDirs * numPts * numEntries);
+    generate.SourceCells[type] = sourceCells[type]->GetPointer();
+    generate.NumberOfSourceEntries[type] = numEntries;
+    generate.Connectivity[type] = conn[type]->GetPointer(0);
+  }
+
+  vtkSMPTools::For(0, numPts, generate);
+
+  // Without coloring, the source scalars are passed to each glyph.
+  if (!newScalars)
+  {
+    outPD->CopyAllOff();
+    outPD->CopyScalarsOn();
+    outPD->CopyAllocate(pd, numOutPts);
+    vtkNew<vtkIdList> srcIds;
+    vtkNew<vtkIdList> dstIds;
+    srcIds->SetNumberOfIds(numOutPts);
+    dstIds->SetNumberOfIds(numOutPts);
+    for (vtkIdType i = 0; i < numOutPts; ++i)
+    {
+      srcIds->SetId(i, i % numSourcePts);
+      dstIds->SetId(i, i);
+    }
+    outPD->CopyData(pd, srcIds.GetPointer(), dstIds.GetPointer());
+  }
+
+  output->SetPoints(newPts.GetPointer());
+  for (int type = 0; type < 4; ++type)
+  {
+    vtkIdType numCells = sourceCells[type]->GetNumberOfCells();
+    if (numCells > 0)
+    {
+      vtkNew<vtkCellArray> cells;
+      cells->SetCells(numDirs * numPts * numCells, conn[type]);
+      switch (type)
+      {
+        case 0:
+          output->SetVerts(cells.GetPointer());
+          break;
+        case 1:
+          output->SetLines(cells.GetPointer());
+          break;
+        case 2:
+          output->SetPolys(cells.GetPointer());
+          break;
+        default:
+          output->SetStrips(cells.GetPointer());
+      }
+    }
+  }
+
+  if (newScalars)
+  {
+    int idx = outPD->AddArray(newScalars);
+    outPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+  }
+  if (newNormals)
+  {
+    outPD->SetNormals(newNormals);
+  }
+  vtkDebugMacro(<<"Generated " << numPts <<" tensor glyphs");
+}
+
 //----------------------------------------------------------------------------
 void vtkTensorGlyph::SetSourceConnection(int id, vtkAlgorithmOutput* algOutput)
 {
@@ -561,4 +995,5 @@ void vtkTensorGlyph::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Three Glyphs: " << (this->ThreeGlyphs ? "On\n" : "Off\n");
   os << indent << "Symmetric: " << (this->Symmetric ? "On\n" : "Off\n");
   os << indent << "Length: " << this->Length << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
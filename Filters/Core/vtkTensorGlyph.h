@@ -231,6 +231,17 @@ public:
   vtkGetMacro(MaxScaleFactor,double);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation: the points, normals, scalars
+   * and connectivity of all the glyphs are filled concurrently with
+   * vtkSMPTools. The output is the same as the serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkTensorGlyph();
   ~vtkTensorGlyph() VTK_OVERRIDE;
@@ -239,6 +250,11 @@ protected:
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
   int FillInputPortInformation(int port, vtkInformation *info) VTK_OVERRIDE;
 
+  // Threaded glyphing, called by RequestData() once the input is checked.
+  void ExecuteSMP(vtkDataSet *input, vtkPolyData *source,
+                  vtkDataArray *inTensors, vtkDataArray *inScalars,
+                  vtkPolyData *output);
+
   int Scaling; // Determine whether scaling of geometry is performed
   double ScaleFactor; // Scale factor to use to scale geometry
   int ExtractEigenvalues; // Boolean controls eigenfunction extraction
@@ -249,6 +265,7 @@ protected:
   int ThreeGlyphs; // Boolean controls drawing 1 or 3 glyphs
   int Symmetric; // Boolean controls drawing a "mirror" of each glyph
   double Length; // Distance, in x, from the origin to the end of the glyph
+  bool EnableSMP;
 private:
   vtkTensorGlyph(const vtkTensorGlyph&) VTK_DELETE_FUNCTION;
   void operator=(const vtkTensorGlyph&) VTK_DELETE_FUNCTION;
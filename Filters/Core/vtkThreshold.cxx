@@ -16,16 +16,21 @@
 
 #include "vtkCell.h"
 #include "vtkCellData.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkMath.h"
 
 #include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkThreshold);
 
@@ -47,6 +52,7 @@ vtkThreshold::vtkThreshold()
                                vtkDataSetAttributes::SCALARS);
 
   this->UseContinuousCellRange = 0;
+  this->EnableSMP = false;
 }
 
 vtkThreshold::~vtkThreshold()
@@ -90,6 +96,38 @@ void vtkThreshold::ThresholdBetween(double lower, double upper)
   }
 }
 
+// Flags the cells whose scalars satisfy the threshold criterion.
+struct vtkThreshold::ClassifyCellsWorker
+{
+  vtkThreshold *Self;
+  vtkDataSet *Input;
+  vtkDataArray *Scalars;
+  bool UsePointScalars;
+  unsigned char *KeepCells;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  ClassifyCellsWorker(vtkThreshold *self, vtkDataSet *input,
+                      vtkDataArray *scalars, bool usePointScalars,
+                      unsigned char *keepCells)
+    : Self(self), Input(input), Scalars(scalars),
+      UsePointScalars(usePointScalars), KeepCells(keepCells)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Input->GetCellPoints(cellId, cellPts);
+      int numCellPts = static_cast<int>(cellPts->GetNumberOfIds());
+      this->KeepCells[cellId] = numCellPts > 0 &&
+        this->Self->EvaluateCellScalars(this->Scalars, this->UsePointScalars,
+                                        cellId, cellPts, numCellPts);
+    }
+  }
+};
+
 int vtkThreshold::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -133,6 +171,36 @@ int vtkThreshold::RequestData(
     return 1;
   }
 
+  // are we using pointScalars?
+  int fieldAssociation = this->GetInputArrayAssociation(0, inputVector);
+  bool usePointScalars = fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS;
+
+  if (this->EnableSMP)
+  {
+    // Classify the cells in parallel, then compact and gather the output.
+    vtkIdType numCells = input->GetNumberOfCells();
+    std::vector<unsigned char> keepCells(numCells);
+    if (numCells > 0)
+    {
+      // The first access builds the cells of polydata: keep it serial.
+      vtkNew<vtkIdList> cellIds;
+      input->GetCellPoints(0, cellIds.GetPointer());
+      ClassifyCellsWorker worker(this, input, inScalars, usePointScalars,
+                                 &keepCells[0]);
+      vtkSMPTools::For(0, numCells, worker);
+    }
+
+    vtkNew<vtkCellSubsetExtractor> extractor;
+    extractor->SetOutputPointsPrecision(this->OutputPointsPrecision);
+    extractor->ExtractMarkedCells(input,
+                                  numCells > 0 ? &keepCells[0] : NULL,
+                                  NULL, output);
+
+    vtkDebugMacro(<< "Extracted " << output->GetNumberOfCells()
+                  << " number of cells.");
+    return 1;
+  }
+
   outPD->CopyGlobalIdsOn();
   outPD->CopyAllocate(pd);
   outCD->CopyGlobalIdsOn();
@@ -176,10 +244,6 @@ int vtkThreshold::RequestData(
 
   newCellPts = vtkIdList::New();
 
-  // are we using pointScalars?
-  int fieldAssociation = this->GetInputArrayAssociation(0, inputVector);
-  bool usePointScalars = fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS;
-
   // Check that the scalars of each cell satisfy the threshold criterion
   for (cellId=0; cellId < input->GetNumberOfCells(); cellId++)
   {
@@ -187,38 +251,8 @@ int vtkThreshold::RequestData(
     cellPts = cell->GetPointIds();
     numCellPts = cell->GetNumberOfPoints();
 
-    if ( usePointScalars )
-    {
-      if (this->AllScalars)
-      {
-        keepCell = 1;
-        for ( i=0; keepCell && (i < numCellPts); i++)
-        {
-          ptId = cellPts->GetId(i);
-          keepCell = this->EvaluateComponents( inScalars, ptId );
-        }
-      }
-      else
-      {
-        if(!this->UseContinuousCellRange)
-        {
-          keepCell = 0;
-          for ( i=0; (!keepCell) && (i < numCellPts); i++)
-          {
-            ptId = cellPts->GetId(i);
-            keepCell = this->EvaluateComponents( inScalars, ptId );
-          }
-        }
-        else
-        {
-          keepCell = this->EvaluateCell(inScalars, cellPts, numCellPts);
-        }
-      }
-    }
-    else //use cell scalars
-    {
-      keepCell = this->EvaluateComponents( inScalars, cellId );
-    }
+    keepCell = this->EvaluateCellScalars(inScalars, usePointScalars, cellId,
+                                         cellPts, numCellPts);
 
     if (  numCellPts > 0 && keepCell )
     {
@@ -266,6 +300,50 @@ int vtkThreshold::RequestData(
   return 1;
 }
 
+// Check that the scalars of a cell satisfy the threshold criterion.
+int vtkThreshold::EvaluateCellScalars( vtkDataArray *scalars,
+                                       bool usePointScalars, vtkIdType cellId,
+                                       vtkIdList* cellPts, int numCellPts )
+{
+  int i, keepCell;
+  vtkIdType ptId;
+
+  if ( usePointScalars )
+  {
+    if (this->AllScalars)
+    {
+      keepCell = 1;
+      for ( i=0; keepCell && (i < numCellPts); i++)
+      {
+        ptId = cellPts->GetId(i);
+        keepCell = this->EvaluateComponents( scalars, ptId );
+      }
+    }
+    else
+    {
+      if(!this->UseContinuousCellRange)
+      {
+        keepCell = 0;
+        for ( i=0; (!keepCell) && (i < numCellPts); i++)
+        {
+          ptId = cellPts->GetId(i);
+          keepCell = this->EvaluateComponents( scalars, ptId );
+        }
+      }
+      else
+      {
+        keepCell = this->EvaluateCell(scalars, cellPts, numCellPts);
+      }
+    }
+  }
+  else //use cell scalars
+  {
+    keepCell = this->EvaluateComponents( scalars, cellId );
+  }
+
+  return keepCell;
+}
+
 int vtkThreshold::EvaluateCell( vtkDataArray *scalars,vtkIdList* cellPts, int numCellPts )
 {
   int c(0);
@@ -450,4 +528,5 @@ void vtkThreshold::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
   os << indent << "Use Continuous Cell Range: "<<this->UseContinuousCellRange<<endl;
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -183,6 +183,20 @@ public:
   int GetOutputPointsPrecision() const;
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded execution of the filter. When on, the cells
+   * are classified in parallel and the kept cells, the points they use and
+   * their attributes are compacted and gathered with vtkCellSubsetExtractor.
+   * The output holds the same cells in the same order, but its points are
+   * numbered in increasing input order instead of in order of first use.
+   * Off by default.
+   */
+  vtkSetMacro(EnableSMP,bool);
+  vtkGetMacro(EnableSMP,bool);
+  vtkBooleanMacro(EnableSMP,bool);
+  //@}
+
 protected:
   vtkThreshold();
   ~vtkThreshold() VTK_OVERRIDE;
@@ -201,6 +215,7 @@ protected:
   int    SelectedComponent;
   int OutputPointsPrecision;
   int UseContinuousCellRange;
+  bool EnableSMP;
 
   int (vtkThreshold::*ThresholdFunction)(double s);
 
@@ -212,6 +227,11 @@ protected:
   int EvaluateComponents( vtkDataArray *scalars, vtkIdType id );
   int EvaluateCell( vtkDataArray *scalars, vtkIdList* cellPts, int numCellPts );
   int EvaluateCell( vtkDataArray *scalars, int c, vtkIdList* cellPts, int numCellPts );
+  int EvaluateCellScalars( vtkDataArray *scalars, bool usePointScalars,
+                           vtkIdType cellId, vtkIdList* cellPts, int numCellPts );
+
+  // Classifies the cells in parallel when EnableSMP is on.
+  struct ClassifyCellsWorker;
 private:
   vtkThreshold(const vtkThreshold&) VTK_DELETE_FUNCTION;
   void operator=(const vtkThreshold&) VTK_DELETE_FUNCTION;
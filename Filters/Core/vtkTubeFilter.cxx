@@ -17,15 +17,23 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolyLine.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 
 vtkStandardNewMacro(vtkTubeFilter);
@@ -52,6 +60,7 @@ vtkTubeFilter::vtkTubeFilter()
   this->TextureLength = 1.0;
 
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = false;
 
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
@@ -111,18 +120,14 @@ int vtkTubeFilter::RequestData(
   vtkPoints *inPts;
   vtkIdType numPts;
   vtkIdType numLines;
-  vtkIdType numNewPts, numNewCells;
+  vtkIdType numNewPts;
   vtkPoints *newPts;
   int deleteNormals=0;
   vtkFloatArray *newNormals;
   vtkIdType i;
   double range[2], maxSpeed=0;
   vtkCellArray *newStrips;
-  vtkIdType npts=0, *pts=NULL;
-  vtkIdType offset=0;
   vtkFloatArray *newTCoords=NULL;
-  int abort=0;
-  vtkIdType inCellId;
   double oldRadius=1.0;
 
   // Check input and initialize
@@ -155,14 +160,10 @@ int vtkTubeFilter::RequestData(
     newPts->SetDataType(VTK_DOUBLE);
   }
 
-  newPts->Allocate(numNewPts);
   newNormals = vtkFloatArray::New();
   newNormals->SetName("TubeNormals");
   newNormals->SetNumberOfComponents(3);
-  newNormals->Allocate(3*numNewPts);
   newStrips = vtkCellArray::New();
-  newStrips->Allocate(newStrips->EstimateSize(1,numNewPts));
-  vtkCellArray *singlePolyline = vtkCellArray::New();
 
   // Point data: copy scalars, vectors, tcoords. Normals may be computed here.
   outPD->CopyNormalsOff();
@@ -172,34 +173,29 @@ int vtkTubeFilter::RequestData(
   {
     newTCoords = vtkFloatArray::New();
     newTCoords->SetNumberOfComponents(2);
-    newTCoords->Allocate(numNewPts);
     outPD->CopyTCoordsOff();
   }
   outPD->CopyAllocate(pd,numNewPts);
 
   int generateNormals = 0;
-  if ( !(inNormals=pd->GetNormals()) || this->UseDefaultNormal )
+  if ( this->UseDefaultNormal )
   {
     deleteNormals = 1;
     inNormals = vtkFloatArray::New();
     inNormals->SetNumberOfComponents(3);
     inNormals->SetNumberOfTuples(numPts);
-
-    if ( this->UseDefaultNormal )
+    for ( i=0; i < numPts; i++)
     {
-      for ( i=0; i < numPts; i++)
-      {
-        inNormals->SetTuple(i,this->DefaultNormal);
-      }
-    }
-    else
-    {
-      // Normal generation has been moved to lower in the function.
-      // This allows each different polylines to share vertices, but have
-      // their normals (and hence their tubes) calculated independently
-      generateNormals = 1;
+      inNormals->SetTuple(i,this->DefaultNormal);
     }
   }
+  else if ( !(inNormals=pd->GetNormals()) )
+  {
+    // The normals are generated for each polyline. This allows different
+    // polylines to share vertices, but have their normals (and hence their
+    // tubes) calculated independently
+    generateNormals = 1;
+  }
 
   // If varying width, get appropriate info.
   //
@@ -232,68 +228,16 @@ int vtkTubeFilter::RequestData(
 
   // Copy selected parts of cell data; certainly don't want normals
   //
-  numNewCells = inLines->GetNumberOfCells() * this->NumberOfSides + 2;
   outCD->CopyNormalsOff();
-  outCD->CopyAllocate(cd,numNewCells);
+  outCD->CopyAllocate(cd,inLines->GetNumberOfCells()*this->NumberOfSides+2);
 
   //  Create points along each polyline that are connected into NumberOfSides
   //  triangle strips. Texture coordinates are optionally generated.
   //
   this->Theta = 2.0*vtkMath::Pi() / this->NumberOfSides;
-  vtkPolyLine *lineNormalGenerator = vtkPolyLine::New();
-  // the line cellIds start after the last vert cellId
-  inCellId = input->GetNumberOfVerts();
-  for (inLines->InitTraversal();
-       inLines->GetNextCell(npts,pts) && !abort; inCellId++)
-  {
-    this->UpdateProgress((double)inCellId/numLines);
-    abort = this->GetAbortExecute();
-
-    // remove degenerate lines to avoid warnings
-    npts = static_cast<vtkIdType>(std::unique(pts, pts + npts, IdPointsEqual(inPts)) -
-           pts);
-    if (npts < 2)
-    {
-      continue; //skip tubing this polyline
-    }
-
-    // If necessary calculate normals, each polyline calculates its
-    // normals independently, avoiding conflicts at shared vertices.
-    if (generateNormals)
-    {
-      singlePolyline->Reset(); //avoid instantiation
-      singlePolyline->InsertNextCell(npts,pts);
-      lineNormalGenerator->GenerateSlidingNormals(inPts,singlePolyline, inNormals);
-    }
-
-    // Generate the points around the polyline. The tube is not stripped
-    // if the polyline is bad.
-    //
-    if ( !this->GeneratePoints(offset,npts,pts,inPts,newPts,pd,outPD,
-                               newNormals,inScalars,range,inVectors,
-                               maxSpeed,inNormals) )
-    {
-      vtkWarningMacro(<< "Could not generate points!");
-      continue; //skip tubing this polyline
-    }
-
-    // Generate the strips for this polyline (including caps)
-    //
-    this->GenerateStrips(offset,npts,pts,inCellId,cd,outCD,newStrips);
-
-    // Generate the texture coordinates for this polyline
-    //
-    if ( newTCoords )
-    {
-      this->GenerateTextureCoords(offset,npts,pts,inPts,inScalars,newTCoords);
-    }
-
-    // Compute the new offset for the next polyline
-    offset = this->ComputeOffset(offset,npts);
-
-  }//for all polylines
-
-  singlePolyline->Delete();
+  this->GenerateTubes(input, output, inNormals, generateNormals != 0,
+                      inScalars, range, inVectors, maxSpeed, newPts,
+                      newNormals, newTCoords, newStrips);
 
   // reset the radius to ite original value if necessary
   if (this->VaryRadius == VTK_VARY_RADIUS_BY_ABSOLUTE_SCALAR)
@@ -322,21 +266,425 @@ int vtkTubeFilter::RequestData(
 
   outPD->SetNormals(newNormals);
   newNormals->Delete();
-  lineNormalGenerator->Delete();
 
   output->Squeeze();
 
   return 1;
 }
 
+namespace {
+
+// Compute the sliding normals of one polyline into lineNormals, indexed by
+// position along the line. A point visited more than once by the polyline
+// gets the normal of its last visit, as when the normals are stored in an
+// array indexed by point id.
+void ComputeLineNormals(vtkPoints *inPts, vtkIdType npts,
+                        const vtkIdType *pts, vtkPoints *linePts,
+                        vtkCellArray *line, vtkFloatArray *normals,
+                        std::vector<std::pair<vtkIdType, vtkIdType> > &visits,
+                        float *lineNormals)
+{
+  double x[3];
+  linePts->SetNumberOfPoints(npts);
+  line->Reset();
+  line->InsertNextCell(static_cast<int>(npts));
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    inPts->GetPoint(pts[j], x);
+    linePts->SetPoint(j, x);
+    line->InsertCellPoint(j);
+  }
+  normals->SetNumberOfTuples(npts);
+  vtkPolyLine::GenerateSlidingNormals(linePts, line, normals);
+  std::copy(normals->GetPointer(0), normals->GetPointer(0) + 3 * npts,
+            lineNormals);
+
+  visits.resize(npts);
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    visits[j] = std::make_pair(pts[j], j);
+  }
+  std::sort(visits.begin(), visits.end());
+  for (vtkIdType first = 0, last = 0; first < npts; first = last + 1)
+  {
+    for (last = first; last + 1 < npts &&
+           visits[last + 1].first == visits[first].first; ++last)
+    {
+    }
+    const float *n = lineNormals + 3 * visits[last].second;
+    for (vtkIdType j = first; j < last; ++j)
+    {
+      std::copy(n, n + 3, lineNormals + 3 * visits[j].second);
+    }
+  }
+}
+
+enum TubeStatus
+{
+  TUBE_OK = 0,
+  TUBE_SKIPPED, // less than two distinct points
+  TUBE_COINCIDENT_POINTS,
+  TUBE_BAD_NORMAL,
+  TUBE_NEGATIVE_SCALAR
+};
+
+void ReportTubeStatus(vtkTubeFilter *self, int status, vtkIdType lineId)
+{
+  switch (status)
+  {
+    case TUBE_OK:
+    case TUBE_SKIPPED:
+      return;
+    case TUBE_COINCIDENT_POINTS:
+      vtkWarningWithObjectMacro(self, <<"Coincident points!");
+      break;
+    case TUBE_BAD_NORMAL:
+      vtkWarningWithObjectMacro(self, <<"Bad normal in line " << lineId);
+      break;
+    case TUBE_NEGATIVE_SCALAR:
+      vtkWarningWithObjectMacro(self,
+                                <<"Scalar value less than zero, skipping line");
+      break;
+  }
+  vtkWarningWithObjectMacro(self, << "Could not generate points!");
+}
+
+void MakeRange(vtkIdList *ids, vtkIdType n)
+{
+  ids->SetNumberOfIds(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    ids->SetId(i, i);
+  }
+}
+
+}
+
+// Generate the tube of one polyline with the helper methods of the filter.
+// PrepareLine() removes the duplicate points of the polyline and computes
+// its normals; GenerateLine() writes its tube at the offsets computed from
+// the preceding polylines. The serial loop calls both for each polyline in
+// turn; the threaded one prepares and checks every polyline concurrently,
+// computes the offsets, then generates the tubes concurrently.
+struct vtkTubeGenerator
+{
+  vtkTubeFilter *Self;
+
+  // input
+  vtkPoints *InPts;
+  vtkDataArray *InNormals; // NULL when the normals are generated
+  vtkDataArray *InScalars;
+  vtkDataArray *InVectors;
+  double Range[2];
+  double MaxSpeed;
+  const vtkIdType *Lines; // input connectivity
+  const vtkIdType *LineLocations;
+  vtkIdType FirstLineCellId;
+
+  // polylines, with the same layout as Lines
+  vtkIdType *LinePoints; // duplicates removed
+  vtkIdType *NumberOfLinePoints;
+  float *LineNormals; // NULL unless the normals are generated
+  unsigned char *Status;
+
+  // output
+  bool Generate; // whether operator() generates or prepares the tubes
+  vtkIdType *PointOffsets;
+  vtkIdType *StripOffsets;
+  vtkIdType *ConnectivityOffsets;
+  vtkPoints *NewPts;
+  float *NewNormals;
+  float *NewTCoords;
+  vtkIdType *PointSourceIds;
+  vtkIdType *Strips;
+  vtkIdType *CellSourceIds;
+
+  vtkSMPThreadLocalObject<vtkPoints> LinePts;
+  vtkSMPThreadLocalObject<vtkCellArray> Line;
+  vtkSMPThreadLocalObject<vtkFloatArray> Normals;
+  vtkSMPThreadLocal<std::vector<std::pair<vtkIdType, vtkIdType> > > Visits;
+
+  void Initialize()
+  {
+    this->LinePts.Local()->SetDataTypeToDouble();
+    this->Normals.Local()->SetNumberOfComponents(3);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType lineId = begin; lineId < end; ++lineId)
+    {
+      if (!this->Generate)
+      {
+        this->PrepareLine(lineId, true);
+      }
+      else if (this->Status[lineId] == TUBE_OK)
+      {
+        this->GenerateLine(lineId);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+  const vtkIdType *GetLinePoints(vtkIdType lineId)
+  {
+    return this->LinePoints + this->LineLocations[lineId] + 1;
+  }
+
+  const float *GetLineNormals(vtkIdType lineId)
+  {
+    return this->LineNormals ?
+      this->LineNormals + 3 * (this->LineLocations[lineId] + 1) : NULL;
+  }
+
+  // Remove the duplicate points of a polyline and generate its normals.
+  // When check is set, also check that the polyline can be tubed.
+  void PrepareLine(vtkIdType lineId, bool check)
+  {
+    // remove degenerate lines to avoid warnings
+    vtkIdType loc = this->LineLocations[lineId];
+    vtkIdType *pts = this->LinePoints + loc + 1;
+    std::copy(this->Lines + loc + 1,
+              this->Lines + loc + 1 + this->Lines[loc], pts);
+    vtkIdType npts = static_cast<vtkIdType>(
+      std::unique(pts, pts + this->Lines[loc],
+                  IdPointsEqual(this->InPts)) - pts);
+    this->NumberOfLinePoints[lineId] = npts;
+    if (npts < 2)
+    {
+      this->Status[lineId] = TUBE_SKIPPED;
+      return;
+    }
+
+    // Each polyline calculates its normals independently, avoiding
+    // conflicts at shared vertices.
+    if (this->LineNormals)
+    {
+      ComputeLineNormals(this->InPts, npts, pts, this->LinePts.Local(),
+                         this->Line.Local(), this->Normals.Local(),
+                         this->Visits.Local(),
+                         this->LineNormals + 3 * (loc + 1));
+    }
+    this->Status[lineId] = TUBE_OK;
+    if (check)
+    {
+      this->Status[lineId] = static_cast<unsigned char>(
+        this->Self->GeneratePoints(0, npts, pts, this->InPts, NULL, NULL, NULL,
+                                   this->InScalars, this->Range,
+                                   this->InVectors, this->MaxSpeed,
+                                   this->InNormals, this->GetLineNormals(lineId)));
+    }
+  }
+
+  // Write the points, strips and texture coordinates of a prepared polyline
+  // at its output offsets, and return its status.
+  int GenerateLine(vtkIdType lineId)
+  {
+    const vtkIdType *pts = this->GetLinePoints(lineId);
+    vtkIdType npts = this->NumberOfLinePoints[lineId];
+    vtkIdType offset = this->PointOffsets[lineId];
+    int status = this->Self->GeneratePoints(
+      offset, npts, pts, this->InPts, this->NewPts, this->NewNormals,
+      this->PointSourceIds, this->InScalars, this->Range, this->InVectors,
+      this->MaxSpeed, this->InNormals, this->GetLineNormals(lineId));
+    if (status != TUBE_OK)
+    {
+      return status;
+    }
+    this->Self->GenerateStrips(
+      offset, npts, this->FirstLineCellId + lineId,
+      this->Strips + this->ConnectivityOffsets[lineId],
+      this->CellSourceIds + this->StripOffsets[lineId]);
+    if (this->NewTCoords)
+    {
+      this->Self->GenerateTextureCoords(offset, npts, pts, this->InPts,
+                                        this->InScalars, this->NewTCoords);
+    }
+    return TUBE_OK;
+  }
+
+  // Compute the output offsets of the polyline following lineId.
+  void AdvanceOffsets(vtkIdType lineId)
+  {
+    vtkIdType numPts = 0, numStrips = 0, connSize = 0;
+    if (this->Status[lineId] == TUBE_OK)
+    {
+      numPts = this->Self->ComputeOffset(0, this->NumberOfLinePoints[lineId]);
+      numStrips = this->Self->ComputeNumberOfStrips(
+        this->NumberOfLinePoints[lineId], connSize);
+    }
+    this->PointOffsets[lineId + 1] = this->PointOffsets[lineId] + numPts;
+    this->StripOffsets[lineId + 1] = this->StripOffsets[lineId] + numStrips;
+    this->ConnectivityOffsets[lineId + 1] =
+      this->ConnectivityOffsets[lineId] + connSize;
+  }
+};
+
+void vtkTubeFilter::GenerateTubes(vtkPolyData *input,
+                                  vtkPolyData *output,
+                                  vtkDataArray *inNormals,
+                                  bool generateNormals,
+                                  vtkDataArray *inScalars, double range[2],
+                                  vtkDataArray *inVectors, double maxSpeed,
+                                  vtkPoints *newPts,
+                                  vtkFloatArray *newNormals,
+                                  vtkFloatArray *newTCoords,
+                                  vtkCellArray *newStrips)
+{
+  vtkCellArray *inLines = input->GetLines();
+  vtkIdType numLines = inLines->GetNumberOfCells();
+  vtkIdType numEntries = inLines->GetNumberOfConnectivityEntries();
+  const vtkIdType *lines = inLines->GetPointer();
+
+  std::vector<vtkIdType> lineLocations(numLines);
+  for (vtkIdType lineId = 0, loc = 0; lineId < numLines; ++lineId)
+  {
+    lineLocations[lineId] = loc;
+    loc += lines[loc] + 1;
+  }
+  std::vector<vtkIdType> linePoints(numEntries);
+  std::vector<vtkIdType> numLinePoints(numLines);
+  std::vector<float> lineNormals(generateNormals ? 3 * numEntries : 0);
+  std::vector<unsigned char> status(numLines);
+  std::vector<vtkIdType> ptOffsets(numLines + 1, 0);
+  std::vector<vtkIdType> stripOffsets(numLines + 1, 0);
+  std::vector<vtkIdType> connOffsets(numLines + 1, 0);
+
+  vtkTubeGenerator generator;
+  generator.Self = this;
+  generator.InPts = input->GetPoints();
+  generator.InNormals = generateNormals ? NULL : inNormals;
+  generator.InScalars = inScalars;
+  generator.InVectors = inVectors;
+  generator.Range[0] = range[0];
+  generator.Range[1] = range[1];
+  generator.MaxSpeed = maxSpeed;
+  generator.Lines = lines;
+  generator.LineLocations = numLines ? &lineLocations[0] : NULL;
+  // the line cellIds start after the last vert cellId
+  generator.FirstLineCellId = input->GetNumberOfVerts();
+  generator.LinePoints = numEntries ? &linePoints[0] : NULL;
+  generator.NumberOfLinePoints = numLines ? &numLinePoints[0] : NULL;
+  generator.LineNormals = generateNormals ? &lineNormals[0] : NULL;
+  generator.Status = numLines ? &status[0] : NULL;
+  generator.PointOffsets = &ptOffsets[0];
+  generator.StripOffsets = &stripOffsets[0];
+  generator.ConnectivityOffsets = &connOffsets[0];
+
+  // Size the output: exactly once the polylines are checked when threaded,
+  // for the polylines with their duplicate points otherwise.
+  vtkIdType numNewPts = 0, numNewStrips = 0, connSize = 0;
+  if (this->EnableSMP)
+  {
+    generator.Generate = false;
+    vtkSMPTools::For(0, numLines, generator);
+    this->UpdateProgress(0.4);
+    for (vtkIdType lineId = 0; lineId < numLines; ++lineId)
+    {
+      ReportTubeStatus(this, status[lineId], lineId);
+      generator.AdvanceOffsets(lineId);
+    }
+    numNewPts = ptOffsets[numLines];
+    numNewStrips = stripOffsets[numLines];
+    connSize = connOffsets[numLines];
+  }
+  else
+  {
+    for (vtkIdType lineId = 0; lineId < numLines; ++lineId)
+    {
+      vtkIdType npts = lines[lineLocations[lineId]], lineConnSize;
+      numNewPts = this->ComputeOffset(numNewPts, npts);
+      numNewStrips += this->ComputeNumberOfStrips(npts, lineConnSize);
+      connSize += lineConnSize;
+    }
+  }
+  newPts->SetNumberOfPoints(numNewPts);
+  newNormals->SetNumberOfTuples(numNewPts);
+  if (newTCoords)
+  {
+    newTCoords->SetNumberOfTuples(numNewPts);
+  }
+  vtkNew<vtkIdTypeArray> strips;
+  strips->SetNumberOfTuples(connSize);
+  vtkNew<vtkIdList> pointSourceIds;
+  pointSourceIds->SetNumberOfIds(numNewPts);
+  vtkNew<vtkIdList> cellSourceIds;
+  cellSourceIds->SetNumberOfIds(numNewStrips);
+
+  generator.Generate = true;
+  generator.NewPts = newPts;
+  generator.NewNormals = newNormals->GetPointer(0);
+  generator.NewTCoords = newTCoords ? newTCoords->GetPointer(0) : NULL;
+  generator.PointSourceIds = pointSourceIds->GetPointer(0);
+  generator.Strips = strips->GetPointer(0);
+  generator.CellSourceIds = cellSourceIds->GetPointer(0);
+  if (this->EnableSMP)
+  {
+    vtkSMPTools::For(0, numLines, generator);
+    this->UpdateProgress(0.8);
+  }
+  else
+  {
+    generator.Initialize();
+    int abort = 0;
+    vtkIdType lineId;
+    for (lineId = 0; lineId < numLines && !abort; ++lineId)
+    {
+      this->UpdateProgress(static_cast<double>(lineId) / numLines);
+      abort = this->GetAbortExecute();
+
+      generator.PrepareLine(lineId, false);
+      if (status[lineId] == TUBE_OK)
+      {
+        status[lineId] =
+          static_cast<unsigned char>(generator.GenerateLine(lineId));
+      }
+      ReportTubeStatus(this, status[lineId], lineId);
+      generator.AdvanceOffsets(lineId);
+    }
+
+    // Drop the room left for duplicate points and skipped polylines.
+    numNewPts = ptOffsets[lineId];
+    numNewStrips = stripOffsets[lineId];
+    newPts->SetNumberOfPoints(numNewPts);
+    newNormals->SetNumberOfTuples(numNewPts);
+    if (newTCoords)
+    {
+      newTCoords->SetNumberOfTuples(numNewPts);
+    }
+    strips->SetNumberOfTuples(connOffsets[lineId]);
+    pointSourceIds->SetNumberOfIds(numNewPts);
+    cellSourceIds->SetNumberOfIds(numNewStrips);
+  }
+
+  newStrips->SetCells(numNewStrips, strips.GetPointer());
+
+  // Copy the point and cell data of the polylines.
+  vtkNew<vtkIdList> dstIds;
+  MakeRange(dstIds.GetPointer(), numNewPts);
+  output->GetPointData()->CopyData(input->GetPointData(),
+                                   pointSourceIds.GetPointer(),
+                                   dstIds.GetPointer());
+  MakeRange(dstIds.GetPointer(), numNewStrips);
+  output->GetCellData()->CopyData(input->GetCellData(),
+                                  cellSourceIds.GetPointer(),
+                                  dstIds.GetPointer());
+}
+
+// Generate the points of the tube of a polyline from offset on, or only
+// check that the polyline can be tubed when newPts is NULL.
 int vtkTubeFilter::GeneratePoints(vtkIdType offset,
-                                  vtkIdType npts, vtkIdType *pts,
+                                  vtkIdType npts, const vtkIdType *pts,
                                   vtkPoints *inPts, vtkPoints *newPts,
-                                  vtkPointData *pd, vtkPointData *outPD,
-                                  vtkFloatArray *newNormals,
-                                  vtkDataArray *inScalars, double range[2],
+                                  float *newNormals, vtkIdType *pointSourceIds,
+                                  vtkDataArray *inScalars,
+                                  const double range[2],
                                   vtkDataArray *inVectors, double maxSpeed,
-                                  vtkDataArray *inNormals)
+                                  vtkDataArray *inNormals,
+                                  const float *lineNormals)
 {
   vtkIdType j;
   int i, k;
@@ -347,7 +695,6 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
   double startCapNorm[3], endCapNorm[3];
   double n[3];
   double s[3];
-  //double bevelAngle;
   double w[3];
   double nP[3];
   double sFactor=1.0;
@@ -395,12 +742,21 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
       }
     }
 
-    inNormals->GetTuple(pts[j], n);
+    if (lineNormals)
+    {
+      for (i=0; i<3; i++)
+      {
+        n[i] = lineNormals[3*j+i];
+      }
+    }
+    else
+    {
+      inNormals->GetTuple(pts[j], n);
+    }
 
     if ( vtkMath::Normalize(sNext) == 0.0 )
     {
-      vtkWarningMacro(<<"Coincident points!");
-      return 0;
+      return TUBE_COINCIDENT_POINTS;
     }
 
     for (i=0; i<3; i++)
@@ -410,36 +766,14 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
     // if s is zero then just use sPrev cross n
     if (vtkMath::Normalize(s) == 0.0)
     {
-      vtkDebugMacro(<< "Using alternate bevel vector");
       vtkMath::Cross(sPrev,n,s);
-      if (vtkMath::Normalize(s) == 0.0)
-      {
-        vtkDebugMacro(<< "Using alternate bevel vector");
-      }
+      vtkMath::Normalize(s);
     }
 
-/*    if ( (bevelAngle = vtkMath::Dot(sNext,sPrev)) > 1.0 )
-      {
-      bevelAngle = 1.0;
-      }
-    if ( bevelAngle < -1.0 )
-      {
-      bevelAngle = -1.0;
-      }
-    bevelAngle = acos((double)bevelAngle) / 2.0; //(0->90 degrees)
-    if ( (bevelAngle = cos(bevelAngle)) == 0.0 )
-      {
-      bevelAngle = 1.0;
-      }
-
-    bevelAngle = this->Radius / bevelAngle; //keep tube constant radius
-*/
     vtkMath::Cross(s,n,w);
     if ( vtkMath::Normalize(w) == 0.0)
     {
-      vtkWarningMacro(<<"Bad normal s = " <<s[0]<<" "<<s[1]<<" "<< s[2]
-                      << " n = " << n[0] << " " << n[1] << " " << n[2]);
-      return 0;
+      return TUBE_BAD_NORMAL;
     }
 
     vtkMath::Cross(w,s,nP); //create orthogonal coordinate system
@@ -454,8 +788,9 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
     }
     else if ( inVectors && this->VaryRadius == VTK_VARY_RADIUS_BY_VECTOR )
     {
-      sFactor =
-        sqrt((double)maxSpeed/vtkMath::Norm(inVectors->GetTuple(pts[j])));
+      double v[3];
+      inVectors->GetTuple(pts[j], v);
+      sFactor = sqrt(maxSpeed/vtkMath::Norm(v));
       if ( sFactor > this->RadiusFactor )
       {
         sFactor = this->RadiusFactor;
@@ -467,11 +802,15 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
       sFactor = inScalars->GetComponent(pts[j],0);
       if (sFactor < 0.0)
       {
-        vtkWarningMacro(<<"Scalar value less than zero, skipping line");
-        return 0;
+        return TUBE_NEGATIVE_SCALAR;
       }
     }
 
+    if (!newPts)
+    {
+      continue;
+    }
+
     //create points around line
     if (this->SidesShareVertices)
     {
@@ -482,10 +821,10 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
           normal[i] = w[i]*cos((double)k*this->Theta) +
             nP[i]*sin((double)k*this->Theta);
           s[i] = p[i] + this->Radius * sFactor * normal[i];
+          newNormals[3*ptId+i] = static_cast<float>(normal[i]);
         }
-        newPts->InsertPoint(ptId,s);
-        newNormals->InsertTuple(ptId,normal);
-        outPD->CopyData(pd,pts[j],ptId);
+        newPts->SetPoint(ptId,s);
+        pointSourceIds[ptId] = pts[j];
         ptId++;
       }//for each side
     }
@@ -509,20 +848,20 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
           n_left[i]  = w[i]*cos((double)(k+0.5)*this->Theta) +
             nP[i]*sin((double)(k+0.5)*this->Theta);
           s[i] = p[i] + this->Radius * sFactor * normal[i];
+          newNormals[3*ptId+i] = static_cast<float>(n_right[i]);
+          newNormals[3*ptId+3+i] = static_cast<float>(n_left[i]);
         }
-        newPts->InsertPoint(ptId,s);
-        newNormals->InsertTuple(ptId,n_right);
-        outPD->CopyData(pd,pts[j],ptId);
-        newPts->InsertPoint(ptId+1,s);
-        newNormals->InsertTuple(ptId+1,n_left);
-        outPD->CopyData(pd,pts[j],ptId+1);
+        newPts->SetPoint(ptId,s);
+        pointSourceIds[ptId] = pts[j];
+        newPts->SetPoint(ptId+1,s);
+        pointSourceIds[ptId+1] = pts[j];
         ptId += 2;
       }//for each side
     }//else separate vertices
   }//for all points in polyline
 
   //Produce end points for cap. They are placed at tail end of points.
-  if (this->Capping)
+  if (newPts && this->Capping)
   {
     int numCapSides = this->NumberOfSides;
     int capIncr = 1;
@@ -536,13 +875,16 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
     for (k=0; k < numCapSides; k+=capIncr)
     {
       newPts->GetPoint(offset+k,s);
-      newPts->InsertPoint(ptId,s);
-      newNormals->InsertTuple(ptId,startCapNorm);
-      outPD->CopyData(pd,pts[0],ptId);
+      newPts->SetPoint(ptId,s);
+      for (i=0; i<3; i++)
+      {
+        newNormals[3*ptId+i] = static_cast<float>(startCapNorm[i]);
+      }
+      pointSourceIds[ptId] = pts[0];
       ptId++;
     }
     //the end cap
-    int endOffset = offset + (npts-1)*this->NumberOfSides;
+    vtkIdType endOffset = offset + (npts-1)*this->NumberOfSides;
     if ( ! this->SidesShareVertices )
     {
       endOffset = offset + 2*(npts-1)*this->NumberOfSides;
@@ -550,112 +892,97 @@ int vtkTubeFilter::GeneratePoints(vtkIdType offset,
     for (k=0; k < numCapSides; k+=capIncr)
     {
       newPts->GetPoint(endOffset+k,s);
-      newPts->InsertPoint(ptId,s);
-      newNormals->InsertTuple(ptId,endCapNorm);
-      outPD->CopyData(pd,pts[npts-1],ptId);
+      newPts->SetPoint(ptId,s);
+      for (i=0; i<3; i++)
+      {
+        newNormals[3*ptId+i] = static_cast<float>(endCapNorm[i]);
+      }
+      pointSourceIds[ptId] = pts[npts-1];
       ptId++;
     }
   }//if capping
 
-  return 1;
+  return TUBE_OK;
 }
 
+// Generate the strips of the tube of a polyline into strips, and the input
+// cell of each strip into cellSourceIds.
 void vtkTubeFilter::GenerateStrips(vtkIdType offset, vtkIdType npts,
-                                   vtkIdType* vtkNotUsed(pts),
-                                   vtkIdType inCellId,
-                                   vtkCellData *cd, vtkCellData *outCD,
-                                   vtkCellArray *newStrips)
+                                   vtkIdType inCellId, vtkIdType *strips,
+                                   vtkIdType *cellSourceIds)
 {
-  vtkIdType i, outCellId;
+  vtkIdType i;
   int k;
   int i1, i2, i3;
 
-  if (this->SidesShareVertices)
+  for (k=this->Offset; k<(this->NumberOfSides+this->Offset);
+       k+=this->OnRatio)
   {
-    for (k=this->Offset; k<(this->NumberOfSides+this->Offset);
-         k+=this->OnRatio)
+    if (this->SidesShareVertices)
     {
       i1 = k % this->NumberOfSides;
       i2 = (k+1) % this->NumberOfSides;
-      outCellId = newStrips->InsertNextCell(npts*2);
-      outCD->CopyData(cd,inCellId,outCellId);
-      for (i=0; i < npts; i++)
-      {
-        i3 = i*this->NumberOfSides;
-        newStrips->InsertCellPoint(offset+i2+i3);
-        newStrips->InsertCellPoint(offset+i1+i3);
-      }
-    } //for each side of the tube
-  }
-  else
-  {
-    for (k=this->Offset; k<(this->NumberOfSides+this->Offset);
-         k+=this->OnRatio)
+    }
+    else
     {
       i1 = 2*(k % this->NumberOfSides) + 1;
       i2 = 2*((k+1) % this->NumberOfSides);
-      outCellId = newStrips->InsertNextCell(npts*2);
-      outCD->CopyData(cd,inCellId,outCellId);
-      for (i=0; i < npts; i++)
-      {
-        i3 = i*2*this->NumberOfSides;
-        newStrips->InsertCellPoint(offset+i2+i3);
-        newStrips->InsertCellPoint(offset+i1+i3);
-      }
-    } //for each side of the tube
-  }
+    }
+    *cellSourceIds++ = inCellId;
+    *strips++ = npts*2;
+    for (i=0; i < npts; i++)
+    {
+      i3 = i*this->NumberOfSides*(this->SidesShareVertices ? 1 : 2);
+      *strips++ = offset+i2+i3;
+      *strips++ = offset+i1+i3;
+    }
+  } //for each side of the tube
 
   // Take care of capping. The caps are n-sided polygons that can be
   // easily triangle stripped.
   if (this->Capping)
   {
     vtkIdType startIdx = offset + npts*this->NumberOfSides;
-    vtkIdType idx;
-
     if ( ! this->SidesShareVertices )
     {
       startIdx = offset + 2*npts*this->NumberOfSides;
     }
 
     //The start cap
-    outCellId = newStrips->InsertNextCell(this->NumberOfSides);
-    outCD->CopyData(cd,inCellId,outCellId);
-    newStrips->InsertCellPoint(startIdx);
-    newStrips->InsertCellPoint(startIdx+1);
+    *cellSourceIds++ = inCellId;
+    *strips++ = this->NumberOfSides;
+    *strips++ = startIdx;
+    *strips++ = startIdx+1;
     for (i1=this->NumberOfSides-1, i2=2, k=0; k<(this->NumberOfSides-2); k++)
     {
       if ( (k%2) )
       {
-        idx = startIdx + i2;
-        newStrips->InsertCellPoint(idx);
+        *strips++ = startIdx + i2;
         i2++;
       }
       else
       {
-        idx = startIdx + i1;
-        newStrips->InsertCellPoint(idx);
+        *strips++ = startIdx + i1;
         i1--;
       }
     }
 
     //The end cap - reversed order to be consistent with normal
     startIdx += this->NumberOfSides;
-    outCellId = newStrips->InsertNextCell(this->NumberOfSides);
-    outCD->CopyData(cd,inCellId,outCellId);
-    newStrips->InsertCellPoint(startIdx);
-    newStrips->InsertCellPoint(startIdx+this->NumberOfSides-1);
+    *cellSourceIds++ = inCellId;
+    *strips++ = this->NumberOfSides;
+    *strips++ = startIdx;
+    *strips++ = startIdx+this->NumberOfSides-1;
     for (i1=this->NumberOfSides-2, i2=1, k=0; k<(this->NumberOfSides-2); k++)
     {
       if ( (k%2) )
       {
-        idx = startIdx + i1;
-        newStrips->InsertCellPoint(idx);
+        *strips++ = startIdx + i1;
         i1--;
       }
       else
       {
-        idx = startIdx + i2;
-        newStrips->InsertCellPoint(idx);
+        *strips++ = startIdx + i2;
         i2++;
       }
     }
@@ -663,10 +990,11 @@ void vtkTubeFilter::GenerateStrips(vtkIdType offset, vtkIdType npts,
 }
 
 void vtkTubeFilter::GenerateTextureCoords(vtkIdType offset,
-                                          vtkIdType npts, vtkIdType *pts,
+                                          vtkIdType npts,
+                                          const vtkIdType *pts,
                                           vtkPoints *inPts,
                                           vtkDataArray *inScalars,
-                                          vtkFloatArray *newTCoords)
+                                          float *newTCoords)
 {
   vtkIdType i;
   int k;
@@ -678,60 +1006,48 @@ void vtkTubeFilter::GenerateTextureCoords(vtkIdType offset,
     numSides = 2 * this->NumberOfSides;
   }
 
-  double s0, s;
+  float *tcoords = newTCoords + 2 * offset;
   if ( this->GenerateTCoords == VTK_TCOORDS_FROM_SCALARS )
   {
-    s0 = inScalars->GetTuple1(pts[0]);
+    double s0 = inScalars->GetComponent(pts[0], 0);
     for (i=0; i < npts; i++)
     {
-      s = inScalars->GetTuple1(pts[i]);
+      double s = inScalars->GetComponent(pts[i], 0);
       tc = (s - s0) / this->TextureLength;
       for ( k=0; k < numSides; k++)
       {
-        double tcy = static_cast<double>(k) / (numSides - 1);
-        newTCoords->InsertTuple2(offset + i * numSides + k, tc, tcy);
+        *tcoords++ = static_cast<float>(tc);
+        *tcoords++ = static_cast<float>(
+          static_cast<double>(k) / (numSides - 1));
       }
     }
   }
-  else if ( this->GenerateTCoords == VTK_TCOORDS_FROM_LENGTH )
+  else
   {
-    double xPrev[3], x[3], len=0.0;
-    inPts->GetPoint(pts[0],xPrev);
-    for (i=0; i < npts; i++)
+    double xPrev[3], x[3], length=0.0, len=0.0;
+    if ( this->GenerateTCoords == VTK_TCOORDS_FROM_NORMALIZED_LENGTH )
     {
-      inPts->GetPoint(pts[i],x);
-      len += sqrt(vtkMath::Distance2BetweenPoints(x, xPrev));
-      tc = len / this->TextureLength;
-      for ( k=0; k < numSides; k++)
+      inPts->GetPoint(pts[0],xPrev);
+      for (i=0; i < npts; i++)
       {
-        double tcy = static_cast<double>(k) / (numSides - 1);
-        newTCoords->InsertTuple2(offset + i * numSides + k, tc, tcy);
+        inPts->GetPoint(pts[i],x);
+        length += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
+        xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
       }
-
-      xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
-    }
-  }
-  else if ( this->GenerateTCoords == VTK_TCOORDS_FROM_NORMALIZED_LENGTH )
-  {
-    double xPrev[3], x[3], length=0.0, len=0.0;
-    inPts->GetPoint(pts[0],xPrev);
-    for (i=0; i < npts; i++)
-    {
-      inPts->GetPoint(pts[i],x);
-      length += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
-      xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
     }
 
     inPts->GetPoint(pts[0],xPrev);
     for (i=0; i < npts; i++)
     {
       inPts->GetPoint(pts[i],x);
-      len += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
-      tc = len / length;
+      len += sqrt(vtkMath::Distance2BetweenPoints(x, xPrev));
+      tc = (this->GenerateTCoords == VTK_TCOORDS_FROM_LENGTH ?
+            len / this->TextureLength : len / length);
       for ( k=0; k < numSides; k++)
       {
-        double tcy = static_cast<double>(k) / (numSides - 1);
-        newTCoords->InsertTuple2(offset + i * numSides + k, tc, tcy);
+        *tcoords++ = static_cast<float>(tc);
+        *tcoords++ = static_cast<float>(
+          static_cast<double>(k) / (numSides - 1));
       }
       xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
     }
@@ -741,18 +1057,19 @@ void vtkTubeFilter::GenerateTextureCoords(vtkIdType offset,
   if ( this->Capping )
   {
     int ik;
-    vtkIdType startIdx = offset + npts*numSides;
 
     //start cap
     for (ik=0; ik < this->NumberOfSides; ik++)
     {
-      newTCoords->InsertTuple2(startIdx+ik,0.0,0.0);
+      *tcoords++ = 0.0f;
+      *tcoords++ = 0.0f;
     }
 
     //end cap
     for (ik=0; ik < this->NumberOfSides; ik++)
     {
-      newTCoords->InsertTuple2(startIdx+this->NumberOfSides+ik,tc,0.0);
+      *tcoords++ = static_cast<float>(tc);
+      *tcoords++ = 0.0f;
     }
   }
 }
@@ -777,6 +1094,28 @@ vtkIdType vtkTubeFilter::ComputeOffset(vtkIdType offset, vtkIdType npts)
   return offset;
 }
 
+// Compute the number of strips in this tube and the size of their
+// connectivity
+vtkIdType vtkTubeFilter::ComputeNumberOfStrips(vtkIdType npts,
+                                               vtkIdType &connSize)
+{
+  vtkIdType numStrips = 0;
+  for (int k = this->Offset; k < this->NumberOfSides + this->Offset;
+       k += this->OnRatio)
+  {
+    ++numStrips;
+  }
+  connSize = numStrips * (2 * npts + 1);
+
+  if ( this->Capping )
+  {
+    numStrips += 2;
+    connSize += 2 * (this->NumberOfSides + 1);
+  }
+
+  return numStrips;
+}
+
 // Description:
 // Return the method of varying tube radius descriptive character string.
 const char *vtkTubeFilter::GetVaryRadiusAsString(void)
@@ -845,4 +1184,5 @@ void vtkTubeFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Texture Length: " << this->TextureLength << endl;
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << endl;
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
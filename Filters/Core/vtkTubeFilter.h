@@ -73,6 +73,7 @@ class vtkDataArray;
 class vtkFloatArray;
 class vtkPointData;
 class vtkPoints;
+class vtkPolyData;
 
 class VTKFILTERSCORE_EXPORT vtkTubeFilter : public vtkPolyDataAlgorithm
 {
@@ -229,6 +230,19 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. The output size of each
+   * polyline is computed first, then the points, normals, texture
+   * coordinates and strips of all the tubes are generated concurrently
+   * with vtkSMPTools. The output is the same as the serial one. Off by
+   * default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkTubeFilter();
   ~vtkTubeFilter() VTK_OVERRIDE {}
@@ -250,23 +264,40 @@ protected:
   int OutputPointsPrecision;
   double TextureLength; //this length is mapped to [0,1) texture space
 
-  // Helper methods
-  int GeneratePoints(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                     vtkPoints *inPts, vtkPoints *newPts,
-                     vtkPointData *pd, vtkPointData *outPD,
-                     vtkFloatArray *newNormals, vtkDataArray *inScalars,
-                     double range[2], vtkDataArray *inVectors, double maxNorm,
-                     vtkDataArray *inNormals);
-  void GenerateStrips(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                      vtkIdType inCellId, vtkCellData *cd, vtkCellData *outCD,
-                      vtkCellArray *newStrips);
-  void GenerateTextureCoords(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                             vtkPoints *inPts, vtkDataArray *inScalars,
-                            vtkFloatArray *newTCoords);
+  // Helper methods. They write the tube of one polyline at the given
+  // output offsets, and are called concurrently when EnableSMP is on.
+  // GeneratePoints() returns 0 when the tube could be generated, or why the
+  // polyline is skipped. Without output points, it only checks the polyline.
+  // The normals of the polyline are taken from lineNormals, indexed by
+  // position along the line, or else from inNormals.
+  int GeneratePoints(vtkIdType offset, vtkIdType npts, const vtkIdType *pts,
+                     vtkPoints *inPts, vtkPoints *newPts, float *newNormals,
+                     vtkIdType *pointSourceIds, vtkDataArray *inScalars,
+                     const double range[2], vtkDataArray *inVectors,
+                     double maxNorm, vtkDataArray *inNormals,
+                     const float *lineNormals);
+  void GenerateStrips(vtkIdType offset, vtkIdType npts, vtkIdType inCellId,
+                      vtkIdType *strips, vtkIdType *cellSourceIds);
+  void GenerateTextureCoords(vtkIdType offset, vtkIdType npts,
+                             const vtkIdType *pts, vtkPoints *inPts,
+                             vtkDataArray *inScalars, float *newTCoords);
   vtkIdType ComputeOffset(vtkIdType offset,vtkIdType npts);
+  vtkIdType ComputeNumberOfStrips(vtkIdType npts, vtkIdType &connSize);
+
+  // Tube every polyline of the input, serially or with vtkSMPTools. The
+  // output arrays are allocated by RequestData() and sized here.
+  void GenerateTubes(vtkPolyData *input, vtkPolyData *output,
+                     vtkDataArray *inNormals,
+                     bool generateNormals, vtkDataArray *inScalars,
+                     double range[2], vtkDataArray *inVectors,
+                     double maxSpeed, vtkPoints *newPts,
+                     vtkFloatArray *newNormals, vtkFloatArray *newTCoords,
+                     vtkCellArray *newStrips);
+  friend struct vtkTubeGenerator;
 
   // Helper data members
   double Theta;
+  bool EnableSMP;
 
 private:
   vtkTubeFilter(const vtkTubeFilter&) VTK_DELETE_FUNCTION;
@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkUnionFind.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkUnionFind
+ * @brief   disjoint sets of ids joined by several threads
+ *
+ * vtkUnionFind is an internal helper of the threaded paths of
+ * vtkPolyDataNormals and vtkCellRegionLabeler. Each set is a tree of
+ * atomic parent ids. Roots are linked under smaller roots, so the root of a
+ * set is its smallest id. Find() does not lock and halves the path it
+ * walks; Union() links the roots in a critical section, since vtkAtomic has
+ * no compare-and-swap.
+ *
+ * @warning
+ *  This file is not installed. Do not include it in a header file.
+*/
+
+#ifndef vtkUnionFind_h
+#define vtkUnionFind_h
+
+#include "vtkAtomicTypes.h"
+#include "vtkSimpleCriticalSection.h"
+#include "vtkSMPTools.h"
+
+class vtkUnionFind
+{
+public:
+  /**
+   * Put each id of [0, size) in a set of its own.
+   */
+  vtkUnionFind(vtkIdType size)
+  {
+    this->Parent = new vtkAtomicIdType[size > 0 ? size : 1];
+    vtkSMPTools::For(0, size, *this);
+  }
+
+  ~vtkUnionFind()
+  {
+    delete [] this->Parent;
+  }
+
+  /**
+   * Return the root of the set holding id. Concurrent calls only shorten
+   * the paths to a root: a parent never points past an ancestor.
+   */
+  vtkIdType Find(vtkIdType id)
+  {
+    vtkIdType p = this->Parent[id].load();
+    while (p != id)
+    {
+      // Path halving: the grand parent is an ancestor as well.
+      vtkIdType gp = this->Parent[p].load();
+      if (gp != p)
+      {
+        this->Parent[id].store(gp);
+      }
+      id = gp;
+      p = this->Parent[id].load();
+    }
+    return id;
+  }
+
+  /**
+   * Join the sets holding a and b.
+   */
+  void Union(vtkIdType a, vtkIdType b)
+  {
+    a = this->Find(a);
+    b = this->Find(b);
+    if (a == b)
+    {
+      return;
+    }
+    // Only the lock holder links roots, so the roots found under the lock
+    // stay roots until they are linked.
+    this->Lock.Lock();
+    a = this->Find(a);
+    b = this->Find(b);
+    if (a != b)
+    {
+      if (a < b)
+      {
+        this->Parent[b].store(a);
+      }
+      else
+      {
+        this->Parent[a].store(b);
+      }
+    }
+    this->Lock.Unlock();
+  }
+
+  // Reset the ids of [begin, end) to sets of their own.
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      this->Parent[id].store(id);
+    }
+  }
+
+private:
+  vtkAtomicIdType *Parent;
+  vtkSimpleCriticalSection Lock;
+
+  vtkUnionFind(const vtkUnionFind&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkUnionFind&) VTK_DELETE_FUNCTION;
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkUnionFind.h
@@ -24,9 +24,12 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkWindowedSincPolyDataFilter);
 
 // Construct object with number of iterations 20; passband .1;
@@ -64,6 +67,156 @@ typedef struct _vtkMeshVertex
   vtkIdList *edges; // connected edges (list of connected point ids)
 } vtkMeshVertex, *vtkMeshVertexPtr;
 
+namespace
+{
+
+// The smoothing iterations read the vertices connected to each point from
+// compressed rows: the neighbors of point i are
+// Edges[Offsets[i]] ... Edges[Offsets[i+1]-1].
+struct vtkSmoothingStencils
+{
+  const vtkMeshVertex *Verts;
+  const vtkIdType *Offsets;
+  const vtkIdType *Edges;
+};
+
+// First iteration: x1 = x0 - 0.5 L(x0) and x3 = c0 x0 + c1 x1.
+class vtkWindowedSincFirstPass
+{
+public:
+  vtkSmoothingStencils Stencils;
+  const float *X0;
+  float *X1;
+  float *X3;
+  double C0;
+  double C1;
+
+  vtkWindowedSincFirstPass(const vtkSmoothingStencils &stencils,
+                           const float *x0, float *x1, float *x3,
+                           double c0, double c1)
+    : Stencils(stencils), X0(x0), X1(x1), X3(x3), C0(c0), C1(c1)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3], y[3], deltaX[3];
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const vtkIdType *edges = this->Stencils.Edges + this->Stencils.Offsets[i];
+      const vtkIdType npts = this->Stencils.Offsets[i+1] -
+        this->Stencils.Offsets[i];
+      const float *x0 = this->X0 + 3*i;
+      if (npts == 0)
+      {
+        // point is not allowed to move, just use the old point...
+        // (zero out the Laplacian)
+        for (int k = 0; k < 3; k++)
+        {
+          this->X1[3*i+k] = 0.0f;
+          this->X3[3*i+k] = x0[k];
+        }
+        continue;
+      }
+
+      // calculate the negative of the laplacian
+      deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+      for (int k = 0; k < 3; k++)
+      {
+        x[k] = x0[k];
+      }
+      for (vtkIdType j = 0; j < npts; j++)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          y[k] = this->X0[3*edges[j]+k];
+          deltaX[k] += (x[k] - y[k]) / npts;
+        }
+      }
+      for (int k = 0; k < 3; k++)
+      {
+        deltaX[k] = x[k] - 0.5*deltaX[k];
+        this->X1[3*i+k] = static_cast<float>(deltaX[k]);
+      }
+
+      for (int k = 0; k < 3; k++)
+      {
+        this->X3[3*i+k] = (this->Stencils.Verts[i].type == VTK_FIXED_VERTEX ?
+          x0[k] : static_cast<float>(this->C0*x[k] + this->C1*deltaX[k]));
+      }
+    }
+  }
+};
+
+// Following iterations: x2 = (x1 - x0) + (x1 - L(x1)) and x3 += cj x2.
+// Points that cannot move already have x1 = 0 from the previous pass, so
+// only x2 is zeroed for them.
+class vtkWindowedSincPass
+{
+public:
+  vtkSmoothingStencils Stencils;
+  const float *X0;
+  const float *X1;
+  float *X2;
+  float *X3;
+  double C;
+
+  vtkWindowedSincPass(const vtkSmoothingStencils &stencils, const float *x0,
+                      const float *x1, float *x2, float *x3, double c)
+    : Stencils(stencils), X0(x0), X1(x1), X2(x2), X3(x3), C(c)
+  {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double p_x1[3], y[3], deltaX[3];
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const vtkIdType *edges = this->Stencils.Edges + this->Stencils.Offsets[i];
+      const vtkIdType npts = this->Stencils.Offsets[i+1] -
+        this->Stencils.Offsets[i];
+      if (npts == 0)
+      {
+        this->X2[3*i] = this->X2[3*i+1] = this->X2[3*i+2] = 0.0f;
+        continue;
+      }
+
+      // calculate the negative laplacian of x1
+      deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+      for (int k = 0; k < 3; k++)
+      {
+        p_x1[k] = this->X1[3*i+k];
+      }
+      for (vtkIdType j = 0; j < npts; j++)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          y[k] = this->X1[3*edges[j]+k];
+          deltaX[k] += (p_x1[k] - y[k]) / npts;
+        }
+      }
+
+      // Taubin:  x2 = (x1 - x0) + (x1 - x2)
+      for (int k = 0; k < 3; k++)
+      {
+        deltaX[k] = p_x1[k] - static_cast<double>(this->X0[3*i+k]) +
+          p_x1[k] - deltaX[k];
+        this->X2[3*i+k] = static_cast<float>(deltaX[k]);
+      }
+
+      // smooth the vertex (x3 = x3 + cj x2)
+      if (this->Stencils.Verts[i].type != VTK_FIXED_VERTEX)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          this->X3[3*i+k] = static_cast<float>(this->X3[3*i+k] +
+                                               this->C * deltaX[k]);
+        }
+      }
+    }
+  }
+};
+
+} // end anon namespace
+
 int vtkWindowedSincPolyDataFilter::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -84,7 +237,6 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   vtkIdType npts = 0;
   vtkIdType *pts = 0;
   vtkIdType p1, p2;
-  double x[3], y[3], deltaX[3], xNew[3];
   double x1[3], x2[3], x3[3], l1[3], l2[3];
   double CosFeatureAngle; //Cosine of angle between adjacent polys
   double CosEdgeAngle; // Cosine of angle between adjacent edges
@@ -98,7 +250,7 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   vtkMeshVertexPtr Verts;
 
   // variables specific to windowed sinc interpolation
-  double theta_pb, k_pb, sigma, p_x0[3], p_x1[3], p_x3[3];
+  double theta_pb, k_pb, sigma;
   double *w, *c, *cprime;
   int zero, one, two, three;
 
@@ -428,6 +580,27 @@ int vtkWindowedSincPolyDataFilter::RequestData(
                 << numFEdges << " feature edge vertices\n\t"
                 << numBEdges << " boundary edge vertices\n\t"
                 << numFixed << " fixed vertices\n\t");
+
+  // Gather the connected vertices into compressed rows for the iterations.
+  std::vector<vtkIdType> stencilOffsets(numPts+1, 0);
+  for (i=0; i<numPts; i++)
+  {
+    stencilOffsets[i+1] = stencilOffsets[i] +
+      (Verts[i].edges != NULL ? Verts[i].edges->GetNumberOfIds() : 0);
+  }
+  std::vector<vtkIdType> stencilEdges(stencilOffsets[numPts] + 1);
+  for (i=0; i<numPts; i++)
+  {
+    if ( Verts[i].edges != NULL )
+    {
+      std::copy(Verts[i].edges->GetPointer(0),
+                Verts[i].edges->GetPointer(0) +
+                  Verts[i].edges->GetNumberOfIds(),
+                stencilEdges.begin() + stencilOffsets[i]);
+    }
+  }
+  vtkSmoothingStencils stencils = {
+    Verts, &stencilOffsets[0], &stencilEdges[0] };
 //
 // Perform Windowed Sinc function interpolation
 //
@@ -490,9 +663,6 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   c = new double[this->NumberOfIterations+1];
   cprime = new double[this->NumberOfIterations+1];
 
-  double zerovector[3];
-  zerovector[0] = zerovector[1] = zerovector[2] = 0.0;
-
   //
   // Calculate the weights and the Chebychev coefficients c.
   //
@@ -578,54 +748,18 @@ int vtkWindowedSincPolyDataFilter::RequestData(
     vtkErrorMacro(<< "An optimal offset for the smoothing filter could not be found.  Unpredictable smoothing/shrinkage may result.");
   }
 
-  // first iteration
-  for (i=0; i<numPts; i++)
+  // The iterations below are computed for all points concurrently. Each one
+  // only reads the positions computed by the previous ones.
+  float *ptsData[4];
+  for (i=0; i<4; i++)
   {
-    if ( Verts[i].edges != NULL &&
-         (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
-    {
-      // point is allowed to move
-      newPts[zero]->GetPoint(i, x); //use current points
-      deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-
-      // calculate the negative of the laplacian
-      for (j=0; j<npts; j++) //for all connected points
-      {
-        newPts[zero]->GetPoint(Verts[i].edges->GetId(j), y);
-        for (k=0; k<3; k++)
-        {
-          deltaX[k] += (x[k] - y[k]) / npts;
-        }
-      }
-      // newPts[one] = newPts[zero] - 0.5 newPts[one]
-      for (k=0; k<3; k++)
-      {
-        deltaX[k] = x[k] - 0.5*deltaX[k];
-      }
-      newPts[one]->SetPoint(i, deltaX);
+    ptsData[i] = static_cast<float*>(newPts[i]->GetVoidPointer(0));
+  }
 
-      // calculate newPts[three] = c0 newPts[zero] + c1 newPts[one]
-      for (k=0; k < 3; k++)
-      {
-        deltaX[k] = c[0]*x[k] + c[1]*deltaX[k];
-      }
-      if (Verts[i].type == VTK_FIXED_VERTEX)
-      {
-        newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-      }
-      else
-      {
-        newPts[three]->SetPoint(i, deltaX);
-      }
-    }//if can move point
-    else
-    {
-      // point is not allowed to move, just use the old point...
-      // (zero out the Laplacian)
-      newPts[one]->SetPoint(i, zerovector);
-      newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-    }
-  }//for all points
+  // first iteration
+  vtkWindowedSincFirstPass firstPass(stencils, ptsData[zero], ptsData[one],
+                                     ptsData[three], c[0], c[1]);
+  vtkSMPTools::For(0, numPts, firstPass);
 
   // for the rest of the iterations
   for ( iterationNumber=2;
@@ -641,53 +775,10 @@ int vtkWindowedSincPolyDataFilter::RequestData(
       }
     }
 
-    for (i=0; i<numPts; i++)
-    {
-      if ( Verts[i].edges != NULL &&
-           (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
-      {
-        // point is allowed to move
-        newPts[zero]->GetPoint(i, p_x0); //use current points
-        newPts[one]->GetPoint(i, p_x1);
-
-        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-
-        // calculate the negative laplacian of x1
-        for (j=0; j<npts; j++)
-        {
-          newPts[one]->GetPoint(Verts[i].edges->GetId(j), y);
-          for (k=0; k<3; k++)
-          {
-            deltaX[k] += (p_x1[k] - y[k]) / npts;
-          }
-        }//for all connected points
-
-        // Taubin:  x2 = (x1 - x0) + (x1 - x2)
-        for (k=0; k<3; k++)
-        {
-          deltaX[k] = p_x1[k] - p_x0[k] + p_x1[k] - deltaX[k];
-        }
-        newPts[two]->SetPoint(i, deltaX);
-
-        // smooth the vertex (x3 = x3 + cj x2)
-        newPts[three]->GetPoint(i, p_x3);
-        for (k=0;k<3;k++)
-        {
-          xNew[k] = p_x3[k] + c[iterationNumber] * deltaX[k];
-        }
-        if (Verts[i].type != VTK_FIXED_VERTEX)
-        {
-          newPts[three]->SetPoint(i,xNew);
-        }
-      }//if can move point
-      else
-      {
-        // point is not allowed to move, just use the old point...
-        // (zero out the Laplacian)
-        newPts[one]->SetPoint(i, zerovector);
-        newPts[two]->SetPoint(i, zerovector);
-      }
-    }//for all points
+    vtkWindowedSincPass pass(stencils, ptsData[zero], ptsData[one],
+                             ptsData[two], ptsData[three],
+                             c[iterationNumber]);
+    vtkSMPTools::For(0, numPts, pass);
 
     // update the pointers. three is always three. all other pointers
     // shift by one and wrap.
@@ -703,6 +794,7 @@ int vtkWindowedSincPolyDataFilter::RequestData(
 
   // set zero to three so the correct set of positions is outputted
   zero = three;
+  newPts[zero]->Modified();
 
   delete [] w;
   delete [] c;
@@ -26,6 +26,12 @@
  *    composed of these cells.  If the cell list is empty when vtkExtractCells
  *    executes, it will set up the ugrid, point and cell arrays, with no points,
  *    cells or data.
+ *
+ *    The cells, the points they use and their attributes are compacted and
+ *    copied in parallel by vtkCellSubsetExtractor. Cells and points keep
+ *    their input order. When the input is a vtkUnstructuredGrid whose cells
+ *    are all listed and whose points are all used, it is deep copied
+ *    instead.
 */
 
 #ifndef vtkExtractCells_h
@@ -77,20 +83,8 @@ protected:
 
 private:
 
-  void Copy(vtkDataSet *input, vtkUnstructuredGrid *output);
-  static vtkIdType findInSortedList(vtkIdList *idList, vtkIdType id);
-  vtkIdList *reMapPointIds(vtkDataSet *grid);
-
-  void CopyCellsDataSet(vtkIdList *ptMap, vtkDataSet *input,
-                        vtkUnstructuredGrid *output);
-  void CopyCellsUnstructuredGrid(vtkIdList *ptMap, vtkDataSet *input,
-                                 vtkUnstructuredGrid *output);
-
   vtkExtractCellsSTLCloak *CellList;
 
-  vtkIdType SubSetUGridCellArraySize;
-  char InputIsUgrid;
-
   vtkExtractCells(const vtkExtractCells&) VTK_DELETE_FUNCTION;
   void operator=(const vtkExtractCells&) VTK_DELETE_FUNCTION;
 };
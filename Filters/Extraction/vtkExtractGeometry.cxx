@@ -14,20 +14,19 @@
 =========================================================================*/
 #include "vtkExtractGeometry.h"
 
-#include "vtkCell.h"
-#include "vtkCellData.h"
-#include "vtkCellIterator.h"
-#include "vtkFloatArray.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkIdList.h"
 #include "vtkImplicitFunction.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
-#include "vtkPointData.h"
-#include "vtkSmartPointer.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkExtractGeometry);
 vtkCxxSetObjectMacro(vtkExtractGeometry,ImplicitFunction,vtkImplicitFunction);
 
@@ -68,6 +67,63 @@ vtkMTimeType vtkExtractGeometry::GetMTime()
   return mTime;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+// Flags the cells to extract from the number of their points flagged inside
+// the implicit function.
+struct ClassifyCells
+{
+  vtkDataSet *Input;
+  const unsigned char *InsidePoints;
+  unsigned char *KeepCells;
+  bool BoundaryCells;
+  bool OnlyBoundaryCells;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  ClassifyCells(vtkDataSet *input, const unsigned char *insidePoints,
+                unsigned char *keepCells, bool boundaryCells,
+                bool onlyBoundaryCells)
+    : Input(input), InsidePoints(insidePoints), KeepCells(keepCells),
+      BoundaryCells(boundaryCells), OnlyBoundaryCells(onlyBoundaryCells)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Input->GetCellPoints(cellId, cellPts);
+      vtkIdType numCellPts = cellPts->GetNumberOfIds();
+      vtkIdType npts = 0;
+      for (vtkIdType i = 0; i < numCellPts; ++i)
+      {
+        npts += this->InsidePoints[cellPts->GetId(i)];
+      }
+
+      bool keepCell;
+      if (!this->BoundaryCells)
+      {
+        // cells completely inside
+        keepCell = !this->OnlyBoundaryCells && npts == numCellPts;
+      }
+      else if (this->OnlyBoundaryCells)
+      {
+        keepCell = npts > 0 && npts != numCellPts;
+      }
+      else
+      {
+        keepCell = npts > 0;
+      }
+      this->KeepCells[cellId] = keepCell;
+    }
+  }
+};
+
+} // end anon namespace
+
 //----------------------------------------------------------------------------
 int vtkExtractGeometry::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -84,24 +140,9 @@ int vtkExtractGeometry::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  // May be NULL, check before dereferencing.
-  vtkUnstructuredGrid *gridInput = vtkUnstructuredGrid::SafeDownCast(input);
-
-  vtkIdType ptId, numPts, numCells, i, newCellId, newId, *pointMap;
-  vtkSmartPointer<vtkCellIterator> cellIter =
-      vtkSmartPointer<vtkCellIterator>::Take(input->NewCellIterator());
-  vtkIdList *pointIdList;
-  int cellType;
-  vtkIdType numCellPts;
+  vtkIdType ptId, numPts, numCells;
   double x[3];
   double multiplier;
-  vtkPoints *newPts;
-  vtkIdList *newCellPts;
-  vtkPointData *pd = input->GetPointData();
-  vtkCellData *cd = input->GetCellData();
-  vtkPointData *outputPD = output->GetPointData();
-  vtkCellData *outputCD = output->GetCellData();
-  int npts;
 
   vtkDebugMacro(<< "Extracting geometry");
 
@@ -111,14 +152,6 @@ int vtkExtractGeometry::RequestData(
     return 1;
   }
 
-  // As this filter is doing a subsetting operation, set the Copy Tuple flag
-  // for GlobalIds array so that, if present, it will be copied to the output.
-  outputPD->CopyGlobalIdsOn();
-  outputCD->CopyGlobalIdsOn();
-
-  newCellPts = vtkIdList::New();
-  newCellPts->Allocate(VTK_CELL_SIZE);
-
   if ( this->ExtractInside )
   {
     multiplier = 1.0;
@@ -128,163 +161,45 @@ int vtkExtractGeometry::RequestData(
     multiplier = -1.0;
   }
 
-  // Loop over all points determining whether they are inside the
-  // implicit function. Copy the points and point data if they are.
+  // Loop over all points determining whether they are inside the implicit
+  // function. Implicit functions are not required to be thread safe, so
+  // this pass is serial. Points on the function count as inside when
+  // extracting boundary cells.
   //
   numPts = input->GetNumberOfPoints();
   numCells = input->GetNumberOfCells();
-  pointMap = new vtkIdType[numPts]; // maps old point ids into new
-  for (i=0; i < numPts; i++)
+  std::vector<unsigned char> insidePoints(numPts);
+  for ( ptId=0; ptId < numPts; ptId++ )
   {
-    pointMap[i] = -1;
-  }
-
-  output->Allocate(numCells/4); //allocate storage for geometry/topology
-  newPts = vtkPoints::New();
-  newPts->Allocate(numPts/4,numPts);
-  outputPD->CopyAllocate(pd);
-  outputCD->CopyAllocate(cd);
-  vtkFloatArray *newScalars = NULL;
-
-  if ( ! this->ExtractBoundaryCells )
-  {
-    for ( ptId=0; ptId < numPts; ptId++ )
-    {
-      input->GetPoint(ptId, x);
-      if ( (this->ImplicitFunction->FunctionValue(x)*multiplier) < 0.0 )
-      {
-        newId = newPts->InsertNextPoint(x);
-        pointMap[ptId] = newId;
-        outputPD->CopyData(pd,ptId,newId);
-      }
-    }
-  }
-  else
-  {
-    // To extract boundary cells, we have to create supplemental information
-    double val;
-    newScalars = vtkFloatArray::New();
-    newScalars->SetNumberOfValues(numPts);
-
-    for (ptId=0; ptId < numPts; ptId++ )
-    {
-      input->GetPoint(ptId, x);
-      val = this->ImplicitFunction->FunctionValue(x) * multiplier;
-      newScalars->SetValue(ptId, val);
-    }
+    input->GetPoint(ptId, x);
+    double val = this->ImplicitFunction->FunctionValue(x) * multiplier;
+    insidePoints[ptId] = this->ExtractBoundaryCells ? val <= 0.0 : val < 0.0;
   }
 
   // Now loop over all cells to see whether they are inside implicit
   // function (or on boundary if ExtractBoundaryCells is on).
   //
-  for (cellIter->InitTraversal(); !cellIter->IsDoneWithTraversal();
-       cellIter->GoToNextCell())
-  {
-    cellType = cellIter->GetCellType();
-    numCellPts = cellIter->GetNumberOfPoints();
-    pointIdList = cellIter->GetPointIds();
-
-    newCellPts->Reset();
-    if ( ! this->ExtractBoundaryCells ) //requires less work
-    {
-      for ( npts=0, i=0; i < numCellPts; i++, npts++)
-      {
-        ptId = pointIdList->GetId(i);
-        if ( pointMap[ptId] < 0 )
-        {
-          break; //this cell won't be inserted
-        }
-        else
-        {
-          newCellPts->InsertId(i,pointMap[ptId]);
-        }
-      }
-    } //if don't want to extract boundary cells
-
-    else //want boundary cells
-    {
-      for ( npts=0, i=0; i < numCellPts; i++ )
-      {
-        ptId = pointIdList->GetId(i);
-        if ( newScalars->GetValue(ptId) <= 0.0 )
-        {
-          npts++;
-        }
-      }
-      int extraction_condition = 0;
-      if ( this->ExtractOnlyBoundaryCells )
-      {
-        if ( ( npts > 0 ) && ( npts != numCellPts ) )
-        {
-          extraction_condition = 1;
-        }
-      }
-      else
-      {
-        if ( npts > 0 )
-        {
-          extraction_condition = 1;
-        }
-      }
-      if ( extraction_condition )
-      {
-        for ( i=0; i < numCellPts; i++ )
-        {
-          ptId = pointIdList->GetId(i);
-          if ( pointMap[ptId] < 0 )
-          {
-            input->GetPoint(ptId, x);
-            newId = newPts->InsertNextPoint(x);
-            pointMap[ptId] = newId;
-            outputPD->CopyData(pd,ptId,newId);
-          }
-          newCellPts->InsertId(i,pointMap[ptId]);
-        }
-      }//a boundary or interior cell
-    }//if mapping boundary cells
-
-    int extraction_condition = 0;
-    if ( this->ExtractOnlyBoundaryCells )
-    {
-      if ( npts != numCellPts && (this->ExtractBoundaryCells && npts > 0) )
-      {
-        extraction_condition = 1;
-      }
-    }
-    else
-    {
-      if ( npts >= numCellPts || (this->ExtractBoundaryCells && npts > 0) )
-      {
-        extraction_condition = 1;
-      }
-    }
-    if ( extraction_condition )
-    {
-      // special handling for polyhedron cells
-      if (gridInput && cellType == VTK_POLYHEDRON)
-      {
-        newCellPts->Reset();
-        gridInput->GetFaceStream(cellIter->GetCellId(), newCellPts);
-        vtkUnstructuredGrid::ConvertFaceStreamPointIds(newCellPts, pointMap);
-      }
-      newCellId = output->InsertNextCell(cellType,newCellPts);
-      outputCD->CopyData(cd, cellIter->GetCellId(), newCellId);
-    }
-  }//for all cells
-
-  // Update ourselves and release memory
-  //
-  delete [] pointMap;
-  newCellPts->Delete();
-  output->SetPoints(newPts);
-  newPts->Delete();
-
-  if ( this->ExtractBoundaryCells )
+  std::vector<unsigned char> keepCells(numCells);
+  if ( numCells > 0 )
   {
-    newScalars->Delete();
+    // The first access builds the cells of polydata: keep it serial.
+    vtkNew<vtkIdList> cellPts;
+    input->GetCellPoints(0, cellPts.GetPointer());
+    ClassifyCells classify(input, numPts > 0 ? &insidePoints[0] : NULL,
+                           &keepCells[0], this->ExtractBoundaryCells != 0,
+                           this->ExtractOnlyBoundaryCells != 0);
+    vtkSMPTools::For(0, numCells, classify);
   }
 
-  output->Squeeze();
+  // Copy the cells and the points they use, and all inside points when
+  // extracting only the cells completely inside. As this filter is doing a
+  // subsetting operation, GlobalIds arrays are copied to the output.
+  vtkNew<vtkCellSubsetExtractor> extractor;
+  extractor->SetOutputPointsPrecision(vtkAlgorithm::SINGLE_PRECISION);
+  extractor->ExtractMarkedCells(
+    input, numCells > 0 ? &keepCells[0] : NULL,
+    (numPts > 0 && !this->ExtractBoundaryCells) ? &insidePoints[0] : NULL,
+    output);
 
   return 1;
 }
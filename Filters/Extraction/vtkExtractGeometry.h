@@ -28,6 +28,10 @@
  * region.) An option exists to extract cells that are neither inside or
  * outside (i.e., boundary).
  *
+ * The implicit function is evaluated serially. The cells are then
+ * classified in parallel, and the output is compacted and gathered with
+ * vtkCellSubsetExtractor; cells and points keep their input order.
+ *
  * A more efficient version of this filter is available for vtkPolyData input.
  * See vtkExtractPolyDataGeometry.
  *
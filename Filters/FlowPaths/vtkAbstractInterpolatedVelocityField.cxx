@@ -14,11 +14,13 @@
 =========================================================================*/
 #include "vtkAbstractInterpolatedVelocityField.h"
 
+#include "vtkCellKernels.h"
 #include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkDataSet.h"
 #include "vtkDataArray.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
 #include "vtkGenericCell.h"
 #include "vtkObjectFactory.h"
 
@@ -213,6 +215,32 @@ bool vtkAbstractInterpolatedVelocityField::CheckPCoords(double pcoords [3])
   return true;
 }
 
+//---------------------------------------------------------------------------
+// Evaluate x in the cached cell. Cells of point sets supported by
+// vtkCellKernels are evaluated straight from the dataset points; vtkCell is
+// still used to get the distance to surface cells the point is not inside.
+static int EvaluateCachedCell(vtkDataSet *dataset, vtkGenericCell *cell,
+                              bool surface, double x[3], double closest[3],
+                              int &subId, double pcoords[3], double &dist2,
+                              double *weights)
+{
+  vtkPointSet *pointSet = vtkPointSet::SafeDownCast(dataset);
+  int cellType = cell->GetCellType();
+  if (pointSet && vtkCellKernels::IsSupported(cellType) &&
+      vtkCellKernels::IsSupported(pointSet->GetPoints()))
+  {
+    int ret = vtkCellKernels::EvaluatePosition(cellType,
+      pointSet->GetPoints(), cell->PointIds->GetPointer(0), x, pcoords,
+      dist2, weights);
+    if (ret == 1 || !surface)
+    {
+      subId = 0;
+      return ret;
+    }
+  }
+  return cell->EvaluatePosition(x, closest, subId, pcoords, dist2, weights);
+}
+
 //---------------------------------------------------------------------------
 bool vtkAbstractInterpolatedVelocityField::FindAndUpdateCell(vtkDataSet* dataset, double* x)
 {
@@ -239,8 +267,9 @@ bool vtkAbstractInterpolatedVelocityField::FindAndUpdateCell(vtkDataSet* dataset
     {
       // Use cache cell only if point is inside
       // or , with surface , not far and in pccords
-      int ret = this->GenCell->EvaluatePosition
-          (x, closest, this->LastSubId, this->LastPCoords, dist2, this->Weights);
+      int ret = EvaluateCachedCell(dataset, this->GenCell,
+        this->SurfaceDataset, x, closest, this->LastSubId,
+        this->LastPCoords, dist2, this->Weights);
       if (ret == -1
           || (ret == 0 && !this->SurfaceDataset)
           || (this->SurfaceDataset && (dist2 > tol2 || !this->CheckPCoords(this->LastPCoords))))
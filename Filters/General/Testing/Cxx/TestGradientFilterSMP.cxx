@@ -0,0 +1,310 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGradientFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkGradientFilter.
+// .SECTION Description
+// Compute the gradient, divergence, vorticity and Q-criterion of point and
+// cell fields of image data, rectilinear grids, structured grids,
+// unstructured grids and polydata, with and without EnableSMP and the
+// faster approximation. Both modes must produce the same arrays.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGradientFilter.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+
+// A smooth vector field, a float scalar and an integer scalar on the points
+// and on the cells.
+void AddFields(vtkDataSetAttributes *attributes, vtkIdType num,
+               vtkDataSet *ds, bool points)
+{
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkIntArray> labels;
+  labels->SetName("Labels");
+  for (vtkIdType i = 0; i < num; ++i)
+  {
+    double x[3];
+    if (points)
+    {
+      ds->GetPoint(i, x);
+    }
+    else
+    {
+      x[0] = 0.1 * (i % 17);
+      x[1] = 0.2 * (i % 5);
+      x[2] = 0.05 * (i % 11);
+    }
+    vectors->InsertNextTuple3(sin(x[0]) + x[1] * x[2], x[0] * x[0] - x[2],
+                              cos(x[1]) * x[0]);
+    scalars->InsertNextValue(static_cast<float>(x[0] * x[1] + 2.0 * x[2]));
+    labels->InsertNextValue(static_cast<int>(10.0 * (x[0] + x[1] - x[2])));
+  }
+  attributes->SetVectors(vectors.GetPointer());
+  attributes->SetScalars(scalars.GetPointer());
+  attributes->AddArray(labels.GetPointer());
+}
+
+void AddFields(vtkDataSet *ds)
+{
+  AddFields(ds->GetPointData(), ds->GetNumberOfPoints(), ds, true);
+  AddFields(ds->GetCellData(), ds->GetNumberOfCells(), ds, false);
+}
+
+vtkSmartPointer<vtkImageData> MakeImage(int nx, int ny, int nz)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(2, nx + 1, -1, ny - 2, 0, nz - 1);
+  image->SetOrigin(0.5, -1.0, 0.25);
+  image->SetSpacing(0.3, 0.2, 0.45);
+  return image;
+}
+
+vtkSmartPointer<vtkRectilinearGrid> MakeRectilinearGrid(int n)
+{
+  vtkSmartPointer<vtkRectilinearGrid> grid =
+    vtkSmartPointer<vtkRectilinearGrid>::New();
+  grid->SetDimensions(n, n + 1, n + 2);
+  vtkNew<vtkDoubleArray> coords[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < n + i; ++j)
+    {
+      coords[i]->InsertNextValue(0.1 * j + 0.05 * j * j);
+    }
+  }
+  grid->SetXCoordinates(coords[0].GetPointer());
+  grid->SetYCoordinates(coords[1].GetPointer());
+  grid->SetZCoordinates(coords[2].GetPointer());
+  return grid;
+}
+
+vtkSmartPointer<vtkStructuredGrid> MakeStructuredGrid(int nx, int ny, int nz)
+{
+  vtkNew<vtkPoints> points;
+  for (int k = 0; k < nz; ++k)
+  {
+    for (int j = 0; j < ny; ++j)
+    {
+      for (int i = 0; i < nx; ++i)
+      {
+        double r = 1.0 + 0.2 * i, theta = 0.15 * j;
+        points->InsertNextPoint(r * cos(theta), r * sin(theta),
+                                0.3 * k + 0.05 * i);
+      }
+    }
+  }
+  vtkSmartPointer<vtkStructuredGrid> grid =
+    vtkSmartPointer<vtkStructuredGrid>::New();
+  grid->SetDimensions(nx, ny, nz);
+  grid->SetPoints(points.GetPointer());
+  return grid;
+}
+
+// Hexahedra and tetrahedra of a structured grid.
+vtkSmartPointer<vtkUnstructuredGrid> MakeUnstructuredGrid(int n)
+{
+  vtkSmartPointer<vtkStructuredGrid> grid = MakeStructuredGrid(n, n, n);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedralize;
+  tetrahedralize->SetInputData(grid);
+  vtkNew<vtkAppendFilter> append;
+  append->AddInputData(grid);
+  append->AddInputConnection(tetrahedralize->GetOutputPort());
+  append->MergePointsOn();
+  append->Update();
+  return append->GetOutput();
+}
+
+// A warped grid of triangles, a polyline, vertices and a degenerate
+// triangle.
+vtkSmartPointer<vtkPolyData> MakePolyData(int n)
+{
+  vtkNew<vtkPoints> points;
+  for (int j = 0; j < n; ++j)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      points->InsertNextPoint(0.2 * i, 0.15 * j, 0.1 * sin(0.5 * i * j));
+    }
+  }
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j < n - 1; ++j)
+  {
+    for (int i = 0; i < n - 1; ++i)
+    {
+      vtkIdType p0 = j * n + i;
+      vtkIdType tri0[3] = { p0, p0 + 1, p0 + n + 1 };
+      vtkIdType tri1[3] = { p0, p0 + n + 1, p0 + n };
+      polys->InsertNextCell(3, tri0);
+      polys->InsertNextCell(3, tri1);
+    }
+  }
+  vtkIdType degenerate[3] = { 1, 2, 1 };
+  polys->InsertNextCell(3, degenerate);
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(n);
+  for (int i = 0; i < n; ++i)
+  {
+    lines->InsertCellPoint(i * n + i);
+  }
+  vtkNew<vtkCellArray> verts;
+  for (int i = 0; i < n; i += 3)
+  {
+    verts->InsertNextCell(1);
+    verts->InsertCellPoint(n * (n - 1) + i);
+  }
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetVerts(verts.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+  polyData->SetPolys(polys.GetPointer());
+  return polyData;
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b, const char *name)
+{
+  if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+      a->GetDataType() != b->GetDataType())
+  {
+    cerr << "Array " << name << " differs in size or type" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a->GetNumberOfComponents(); ++c)
+    {
+      double va = a->GetComponent(i, c);
+      double vb = b->GetComponent(i, c);
+      if (fabs(va - vb) > 1.0e-6 * (1.0 + fabs(vb)))
+      {
+        cerr << "Array " << name << " differs at " << i << ": " << va
+             << " instead of " << vb << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameAttributes(vtkDataSetAttributes *a, vtkDataSetAttributes *b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    cerr << a->GetNumberOfArrays() << " arrays instead of "
+         << b->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int i = 0; i < b->GetNumberOfArrays(); ++i)
+  {
+    const char *name = b->GetArrayName(i);
+    if (!SameArrays(a->GetArray(name), b->GetArray(name), name))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+vtkSmartPointer<vtkDataSet> Gradient(vtkDataSet *input, int association,
+                                     const char *name, bool faster, bool smp)
+{
+  bool vector = strcmp(name, "Vectors") == 0;
+  vtkNew<vtkGradientFilter> filter;
+  filter->SetInputData(input);
+  filter->SetInputScalars(association, name);
+  filter->SetFasterApproximation(faster);
+  filter->SetComputeDivergence(vector);
+  filter->SetComputeVorticity(vector);
+  filter->SetComputeQCriterion(vector);
+  filter->SetEnableSMP(smp);
+  filter->Update();
+  return filter->GetOutput();
+}
+
+// The cell gradients of 2D structured data sets are not computed.
+bool TestDataSet(vtkDataSet *input, const char *datasetName,
+                 bool cellGradients)
+{
+  const char *names[3] = { "Vectors", "Scalars", "Labels" };
+  const int associations[2] = { vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                                vtkDataObject::FIELD_ASSOCIATION_CELLS };
+  bool res = true;
+  for (int a = 0; a < (cellGradients ? 2 : 1); ++a)
+  {
+    for (int n = 0; n < 3; ++n)
+    {
+      for (int faster = 0; faster < 2; ++faster)
+      {
+        vtkSmartPointer<vtkDataSet> serial =
+          Gradient(input, associations[a], names[n], faster != 0, false);
+        vtkSmartPointer<vtkDataSet> threaded =
+          Gradient(input, associations[a], names[n], faster != 0, true);
+        if (!SameAttributes(threaded->GetPointData(),
+                            serial->GetPointData()) ||
+            !SameAttributes(threaded->GetCellData(), serial->GetCellData()))
+        {
+          cerr << "Gradient of " << (a ? "cell " : "point ") << names[n]
+               << (faster ? " (faster)" : "") << " failed for "
+               << datasetName << endl;
+          res = false;
+        }
+      }
+    }
+  }
+  return res;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestGradientFilterSMP(int, char *[])
+{
+  vtkSmartPointer<vtkDataSet> inputs[] = {
+    MakeImage(9, 7, 6), MakeImage(8, 6, 1), MakeRectilinearGrid(6),
+    MakeStructuredGrid(7, 6, 5), MakeStructuredGrid(6, 8, 1),
+    MakeUnstructuredGrid(5), MakePolyData(8) };
+  const char *names[] = { "3D image", "2D image", "rectilinear grid",
+                          "3D structured grid", "2D structured grid",
+                          "unstructured grid", "polydata" };
+  bool res = true;
+  for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(char *)); ++i)
+  {
+    AddFields(inputs[i]);
+    res = TestDataSet(inputs[i], names[i], i != 1 && i != 4) && res;
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,6 +25,7 @@
 #include "vtkCellDataToPointData.h"
 #include "vtkDataArray.h"
 #include "vtkDataSet.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -35,8 +36,13 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinks.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkStructuredData.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 
@@ -85,7 +91,7 @@ namespace
   void ComputePointGradientsUG(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence);
+    data_type* divergence, bool enableSMP);
 
   int GetCellParametricData(
     vtkIdType pointId, double pointCoord[3], vtkCell *cell, int & subId,
@@ -95,14 +101,14 @@ namespace
   void ComputeCellGradientsUG(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence);
+    data_type* divergence, bool enableSMP);
 
   // Functions for image data and structured grids
   template<class Grid, class data_type>
   void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
                           int numberOfInputComponents, int fieldAssociation,
                           data_type* vorticity, data_type* qCriterion,
-                          data_type* divergence);
+                          data_type* divergence, bool enableSMP);
 
   bool vtkGradientFilterHasArray(vtkFieldData *fieldData,
                                  vtkDataArray *array)
@@ -150,6 +156,7 @@ vtkGradientFilter::vtkGradientFilter()
   this->ComputeDivergence = 0;
   this->ComputeVorticity = 0;
   this->ComputeQCriterion = 0;
+  this->EnableSMP = false;
   this->SetInputScalars(vtkDataObject::FIELD_ASSOCIATION_POINTS_THEN_CELLS,
                         vtkDataSetAttributes::SCALARS);
 }
@@ -181,6 +188,7 @@ void vtkGradientFilter::PrintSelf(ostream &os, vtkIndent indent)
   os << indent << "ComputeDivergence:"  << this->ComputeDivergence << endl;
   os << indent << "ComputeVorticity:" << this->ComputeVorticity << endl;
   os << indent << "ComputeQCriterion:" << this->ComputeQCriterion << endl;
+  os << indent << "EnableSMP:" << this->EnableSMP << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -412,7 +420,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                            (qCriterion == NULL ? NULL :
                             static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                            (divergence == NULL ? NULL :
-                            static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                            static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                           this->EnableSMP));
       }
       if(gradients)
       {
@@ -480,7 +489,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
             (qCriterion == NULL ? NULL :
              static_cast<VTK_TT *>(cellQCriterion->GetVoidPointer(0))),
             (divergence == NULL ? NULL :
-             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0)))));
+             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0))),
+            this->EnableSMP));
       }
 
       // We need to convert cell Array to points Array.
@@ -507,6 +517,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
       vtkNew<vtkCellDataToPointData> cd2pd;
       cd2pd->SetInputData(dummy);
       cd2pd->PassCellDataOff();
+      cd2pd->SetEnableSMP(this->EnableSMP);
       cd2pd->Update();
 
       // Set the gradients array in the output and cleanup.
@@ -543,6 +554,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     vtkNew<vtkCellDataToPointData> cd2pd;
     cd2pd->SetInputData(dummy);
     cd2pd->PassCellDataOff();
+    cd2pd->SetEnableSMP(this->EnableSMP);
     cd2pd->Update();
     vtkDataArray *pointScalars
       = cd2pd->GetOutput()->GetPointData()->GetScalars();
@@ -561,7 +573,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                          (qCriterion == NULL ? NULL :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == NULL ? NULL :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         this->EnableSMP));
     }
 
     if(gradients)
@@ -666,7 +679,8 @@ int vtkGradientFilter::ComputeRegularGridGradient(
                          (qCriterion == NULL ? NULL :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == NULL ? NULL :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         this->EnableSMP));
 
     }
   }
@@ -685,7 +699,8 @@ int vtkGradientFilter::ComputeRegularGridGradient(
                          (qCriterion == NULL ? NULL :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == NULL ? NULL :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         this->EnableSMP));
     }
   }
   else if(vtkRectilinearGrid* rectilinearGrid = vtkRectilinearGrid::SafeDownCast(output))
@@ -703,7 +718,8 @@ int vtkGradientFilter::ComputeRegularGridGradient(
                          (qCriterion == NULL ? NULL :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == NULL ? NULL :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         this->EnableSMP));
 
     }
   }
@@ -755,12 +771,239 @@ int vtkGradientFilter::ComputeRegularGridGradient(
 
 namespace {
 //-----------------------------------------------------------------------------
+  // Whether the threaded unstructured code handles the data set: the cells
+  // of polydata and unstructured grids can be evaluated from several threads
+  // and have static links.
+  bool CanComputeGradientsUGSMP(vtkDataSet *structure)
+  {
+    int type = structure->GetDataObjectType();
+    return type == VTK_POLY_DATA || type == VTK_UNSTRUCTURED_GRID;
+  }
+
+//-----------------------------------------------------------------------------
+  // Evaluate the derivatives of the field at each corner of the cells
+  // [begin, end), once for all the points using the corner. Corners at
+  // which GetCellParametricData() rejects the cell are marked invalid.
   template<class data_type>
-  void ComputePointGradientsUG(
+  class CellCornerDerivatives
+  {
+  public:
+    vtkDataSet *Structure;
+    const data_type *Array;
+    int NumberOfInputComponents;
+    const vtkIdType *Offsets; // first corner of each cell
+    vtkIdType *CornerPoints;
+    char *Valid;
+    data_type *Derivatives; // 3*NumberOfInputComponents per corner
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocal<std::vector<double> > Values;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      vtkGenericCell *cell = this->Cell.Local();
+      std::vector<double> &values = this->Values.Local();
+      int numberOfInputComponents = this->NumberOfInputComponents;
+      for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+        this->Structure->GetCell(cellId, cell);
+        int numberOfCellPoints = cell->GetNumberOfPoints();
+        if (static_cast<size_t>(numberOfCellPoints) > values.size())
+        {
+          values.resize(numberOfCellPoints);
+        }
+        vtkIdType corner = this->Offsets[cellId];
+        for (int k = 0; k < numberOfCellPoints; k++, corner++)
+        {
+          vtkIdType pointId = cell->GetPointId(k);
+          this->CornerPoints[corner] = pointId;
+          double pointcoords[3];
+          this->Structure->GetPoint(pointId, pointcoords);
+          int subId;
+          double parametricCoord[3];
+          this->Valid[corner] = static_cast<char>(GetCellParametricData(
+            pointId, pointcoords, cell, subId, parametricCoord));
+          if (!this->Valid[corner])
+          {
+            continue;
+          }
+          data_type *d = this->Derivatives + corner*3*numberOfInputComponents;
+          for(int inputComponent=0;inputComponent<numberOfInputComponents;
+              inputComponent++)
+          {
+            for (int i = 0; i < numberOfCellPoints; i++)
+            {
+              values[i] = static_cast<double>(
+                this->Array[cell->GetPointId(i)*numberOfInputComponents+
+                            inputComponent]);
+            }
+            double derivative[3];
+            cell->Derivatives(subId, parametricCoord, &values[0], 1,
+                              derivative);
+            d[inputComponent*3] = static_cast<data_type>(derivative[0]);
+            d[inputComponent*3+1] = static_cast<data_type>(derivative[1]);
+            d[inputComponent*3+2] = static_cast<data_type>(derivative[2]);
+          }
+        }
+      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  // Average the corner derivatives of the cells using the points
+  // [begin, end) the way ComputePointGradientsUG() does.
+  template<class data_type>
+  class GatherPointGradients
+  {
+  public:
+    vtkStaticCellLinks *Links;
+    const vtkIdType *Offsets;
+    const vtkIdType *CornerPoints;
+    const char *Valid;
+    const data_type *Derivatives;
+    int NumberOfInputComponents;
+    data_type *Gradients;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    data_type *Divergence;
+    vtkSMPThreadLocal<std::vector<data_type> > G;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      int numberOfOutputComponents = 3*this->NumberOfInputComponents;
+      std::vector<data_type> &g = this->G.Local();
+      g.resize(numberOfOutputComponents);
+      for (vtkIdType point = begin; point < end; point++)
+      {
+        for(int i=0;i<numberOfOutputComponents;i++)
+        {
+          g[i] = 0;
+        }
+
+        // The links list the cells in decreasing id order: accumulate
+        // backwards to add the derivatives in the serial order.
+        const vtkIdType *cells = this->Links->GetCells(point);
+        vtkIdType numCellNeighbors = this->Links->GetNumberOfCells(point);
+        for (vtkIdType neighbor = numCellNeighbors-1; neighbor >= 0; neighbor--)
+        {
+          vtkIdType corner = this->Offsets[cells[neighbor]];
+          vtkIdType lastCorner = this->Offsets[cells[neighbor]+1];
+          while (corner < lastCorner && this->CornerPoints[corner] != point)
+          {
+            corner++;
+          }
+          if (corner < lastCorner && this->Valid[corner])
+          {
+            const data_type *d =
+              this->Derivatives + corner*numberOfOutputComponents;
+            for(int i=0;i<numberOfOutputComponents;i++)
+            {
+              g[i] += d[i];
+            }
+          }
+        }
+
+        if (numCellNeighbors > 0)
+        {
+          for(int i=0;i<numberOfOutputComponents;i++)
+          {
+            g[i] /= numCellNeighbors;
+          }
+        }
+
+        if(this->Vorticity)
+        {
+          ComputeVorticityFromGradient(&g[0], this->Vorticity+3*point);
+        }
+        if(this->QCriterion)
+        {
+          ComputeQCriterionFromGradient(&g[0], this->QCriterion+point);
+        }
+        if(this->Divergence)
+        {
+          ComputeDivergenceFromGradient(&g[0], this->Divergence+point);
+        }
+        if(this->Gradients)
+        {
+          for(int i=0;i<numberOfOutputComponents;i++)
+          {
+            this->Gradients[point*numberOfOutputComponents+i] = g[i];
+          }
+        }
+      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  // Threaded ComputePointGradientsUG(): the derivatives are evaluated once
+  // per cell corner, then gathered per point over static links.
+  template<class data_type>
+  void ComputePointGradientsUGSMP(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
     data_type* divergence)
   {
+    vtkIdType numcells = structure->GetNumberOfCells();
+    if (numcells > 0)
+    {
+      // GetCell(cellId, vtkGenericCell*) is thread safe once GetCell() has
+      // built the cells.
+      structure->GetCell(0);
+    }
+    vtkNew<vtkIdList> cellPoints;
+    std::vector<vtkIdType> offsets(numcells+1);
+    offsets[0] = 0;
+    for (vtkIdType cellid = 0; cellid < numcells; cellid++)
+    {
+      structure->GetCellPoints(cellid, cellPoints.GetPointer());
+      offsets[cellid+1] = offsets[cellid] + cellPoints->GetNumberOfIds();
+    }
+    vtkIdType numCorners = offsets[numcells];
+    std::vector<vtkIdType> cornerPoints(numCorners);
+    std::vector<char> valid(numCorners);
+    std::vector<data_type> derivatives(numCorners*3*numberOfInputComponents);
+
+    CellCornerDerivatives<data_type> evaluate;
+    evaluate.Structure = structure;
+    evaluate.Array = array;
+    evaluate.NumberOfInputComponents = numberOfInputComponents;
+    evaluate.Offsets = &offsets[0];
+    evaluate.CornerPoints = numCorners ? &cornerPoints[0] : NULL;
+    evaluate.Valid = numCorners ? &valid[0] : NULL;
+    evaluate.Derivatives = numCorners ? &derivatives[0] : NULL;
+    vtkSMPTools::For(0, numcells, evaluate);
+
+    vtkNew<vtkStaticCellLinks> links;
+    links->BuildLinks(structure);
+
+    GatherPointGradients<data_type> gather;
+    gather.Links = links.GetPointer();
+    gather.Offsets = evaluate.Offsets;
+    gather.CornerPoints = evaluate.CornerPoints;
+    gather.Valid = evaluate.Valid;
+    gather.Derivatives = evaluate.Derivatives;
+    gather.NumberOfInputComponents = numberOfInputComponents;
+    gather.Gradients = gradients;
+    gather.Vorticity = vorticity;
+    gather.QCriterion = qCriterion;
+    gather.Divergence = divergence;
+    vtkSMPTools::For(0, structure->GetNumberOfPoints(), gather);
+  }
+
+//-----------------------------------------------------------------------------
+  template<class data_type>
+  void ComputePointGradientsUG(
+    vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
+    data_type* divergence, bool enableSMP)
+  {
+    if (enableSMP && CanComputeGradientsUGSMP(structure))
+    {
+      ComputePointGradientsUGSMP(structure, array, gradients,
+                                 numberOfInputComponents, vorticity,
+                                 qCriterion, divergence);
+      return;
+    }
+
     vtkNew<vtkIdList> currentPoint;
     currentPoint->SetNumberOfIds(1);
     vtkNew<vtkIdList> cellsOnPoint;
@@ -881,108 +1124,189 @@ namespace {
   }
 
 //-----------------------------------------------------------------------------
+  // Gradients of the cells [begin, end) at their parametric center.
   template<class data_type>
-    void ComputeCellGradientsUG(
-      vtkDataSet *structure, data_type *array, data_type *gradients,
-      int numberOfInputComponents, data_type* vorticity,
-      data_type* qCriterion, data_type* divergence)
+  class CellGradientsUG
   {
-    vtkIdType numcells = structure->GetNumberOfCells();
-    std::vector<double> values(8);
-    std::vector<data_type> cellGradients(3*numberOfInputComponents);
-    for (vtkIdType cellid = 0; cellid < numcells; cellid++)
+  public:
+    vtkDataSet *Structure;
+    const data_type *Array;
+    int NumberOfInputComponents;
+    data_type *Gradients;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    data_type *Divergence;
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocal<std::vector<double> > Values;
+    vtkSMPThreadLocal<std::vector<data_type> > CellGradients;
+
+    void operator()(vtkIdType begin, vtkIdType end)
     {
-      vtkCell *cell = structure->GetCell(cellid);
-
-      int subId;
-      double cellCenter[3];
-      subId = cell->GetParametricCenter(cellCenter);
-
-      int numpoints = cell->GetNumberOfPoints();
-      if(static_cast<size_t>(numpoints) > values.size())
+      vtkGenericCell *cell = this->Cell.Local();
+      std::vector<double> &values = this->Values.Local();
+      std::vector<data_type> &cellGradients = this->CellGradients.Local();
+      int numberOfInputComponents = this->NumberOfInputComponents;
+      cellGradients.resize(3*numberOfInputComponents);
+      if (values.size() < 8)
       {
-        values.resize(numpoints);
+        values.resize(8);
       }
-      double derivative[3];
-      for(int inputComponent=0;inputComponent<numberOfInputComponents;
-          inputComponent++)
+      for (vtkIdType cellid = begin; cellid < end; cellid++)
       {
-        for (int i = 0; i < numpoints; i++)
+        this->Structure->GetCell(cellid, cell);
+
+        int subId;
+        double cellCenter[3];
+        subId = cell->GetParametricCenter(cellCenter);
+
+        int numpoints = cell->GetNumberOfPoints();
+        if(static_cast<size_t>(numpoints) > values.size())
         {
-          values[i] = static_cast<double>(
-            array[cell->GetPointId(i)*numberOfInputComponents+inputComponent]);
+          values.resize(numpoints);
         }
+        double derivative[3];
+        for(int inputComponent=0;inputComponent<numberOfInputComponents;
+            inputComponent++)
+        {
+          for (int i = 0; i < numpoints; i++)
+          {
+            values[i] = static_cast<double>(
+              this->Array[cell->GetPointId(i)*numberOfInputComponents+
+                          inputComponent]);
+          }
 
-        cell->Derivatives(subId, cellCenter, &values[0], 1, derivative);
-        cellGradients[inputComponent*3] =
-          static_cast<data_type>(derivative[0]);
-        cellGradients[inputComponent*3+1] =
-          static_cast<data_type>(derivative[1]);
-        cellGradients[inputComponent*3+2] =
-          static_cast<data_type>(derivative[2]);
-      }
-      if(gradients)
-      {
-        for(int i=0;i<3*numberOfInputComponents;i++)
+          cell->Derivatives(subId, cellCenter, &values[0], 1, derivative);
+          cellGradients[inputComponent*3] =
+            static_cast<data_type>(derivative[0]);
+          cellGradients[inputComponent*3+1] =
+            static_cast<data_type>(derivative[1]);
+          cellGradients[inputComponent*3+2] =
+            static_cast<data_type>(derivative[2]);
+        }
+        if(this->Gradients)
         {
-          gradients[cellid*3*numberOfInputComponents+i] = cellGradients[i];
+          for(int i=0;i<3*numberOfInputComponents;i++)
+          {
+            this->Gradients[cellid*3*numberOfInputComponents+i] =
+              cellGradients[i];
+          }
+        }
+        if(this->Vorticity)
+        {
+          ComputeVorticityFromGradient(&cellGradients[0],
+                                       this->Vorticity+3*cellid);
+        }
+        if(this->QCriterion)
+        {
+          ComputeQCriterionFromGradient(&cellGradients[0],
+                                        this->QCriterion+cellid);
+        }
+        if(this->Divergence)
+        {
+          ComputeDivergenceFromGradient(&cellGradients[0],
+                                        this->Divergence+cellid);
         }
       }
-      if(vorticity)
-      {
-        ComputeVorticityFromGradient(&cellGradients[0], vorticity+3*cellid);
-      }
-      if(qCriterion)
-      {
-        ComputeQCriterionFromGradient(&cellGradients[0], qCriterion+cellid);
-      }
-      if(divergence)
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  template<class data_type>
+    void ComputeCellGradientsUG(
+      vtkDataSet *structure, data_type *array, data_type *gradients,
+      int numberOfInputComponents, data_type* vorticity,
+      data_type* qCriterion, data_type* divergence, bool enableSMP)
+  {
+    vtkIdType numcells = structure->GetNumberOfCells();
+    CellGradientsUG<data_type> cellGradients;
+    cellGradients.Structure = structure;
+    cellGradients.Array = array;
+    cellGradients.NumberOfInputComponents = numberOfInputComponents;
+    cellGradients.Gradients = gradients;
+    cellGradients.Vorticity = vorticity;
+    cellGradients.QCriterion = qCriterion;
+    cellGradients.Divergence = divergence;
+    if (enableSMP && CanComputeGradientsUGSMP(structure))
+    {
+      if (numcells > 0)
       {
-        ComputeDivergenceFromGradient(&cellGradients[0], divergence+cellid);
+        // GetCell(cellId, vtkGenericCell*) is thread safe once GetCell() has
+        // built the cells.
+        structure->GetCell(0);
       }
+      vtkSMPTools::For(0, numcells, cellGradients);
+    }
+    else
+    {
+      cellGradients(0, numcells);
     }
   }
 
 //-----------------------------------------------------------------------------
-  template<class Grid, class data_type>
-  void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
-                          int numberOfInputComponents, int fieldAssociation,
-                          data_type* vorticity, data_type* qCriterion,
-                          data_type* divergence)
+  // Finite differences over the rows [beginRow, endRow) of an image,
+  // rectilinear or structured grid, a row being the entities along i. The
+  // coordinates of the entities are taken from CellCenters when it is set,
+  // which is needed to process cell data from several threads.
+  template<class data_type>
+  class StructuredGradients
   {
-    int idx, idx2, inputComponent;
-    double xp[3], xm[3], factor;
-    xp[0] = xp[1] = xp[2] = xm[0] = xm[1] = xm[2] = factor = 0;
-    double xxi, yxi, zxi, xeta, yeta, zeta, xzeta, yzeta, zzeta;
-    yxi = zxi = xeta = yeta = zeta = xzeta = yzeta = zzeta = 0;
-    double aj, xix, xiy, xiz, etax, etay, etaz, zetax, zetay, zetaz;
-    xix = xiy = xiz = etax = etay = etaz = zetax = zetay = zetaz = 0;
-    // for finite differencing -- the values on the "plus" side and
-    // "minus" side of the point to be computed at
-    std::vector<double> plusvalues(numberOfInputComponents);
-    std::vector<double> minusvalues(numberOfInputComponents);
-
-    std::vector<double> dValuesdXi(numberOfInputComponents);
-    std::vector<double> dValuesdEta(numberOfInputComponents);
-    std::vector<double> dValuesdZeta(numberOfInputComponents);
-    std::vector<data_type> localGradients(numberOfInputComponents*3);
-
-    int dims[3];
-    output->GetDimensions(dims);
-    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+  public:
+    vtkDataSet *Output;
+    const data_type *Array;
+    int NumberOfInputComponents;
+    int FieldAssociation;
+    int Dims[3];
+    const double *CellCenters;
+    data_type *Gradients;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    data_type *Divergence;
+
+    void GetCoordinate(vtkIdType index, double coords[3]) const
     {
-      // reduce the dimensions by 1 for cells
-      for(int i=0;i<3;i++)
+      if (this->CellCenters)
+      {
+        const double *center = this->CellCenters + 3*index;
+        coords[0] = center[0];
+        coords[1] = center[1];
+        coords[2] = center[2];
+      }
+      else
       {
-        dims[i]--;
+        GetGridEntityCoordinate(this->Output, this->FieldAssociation, index,
+                                coords);
       }
     }
-    int ijsize = dims[0]*dims[1];
 
-    for (int k=0; k<dims[2]; k++)
+    void operator()(vtkIdType beginRow, vtkIdType endRow) const
     {
-      for (int j=0; j<dims[1]; j++)
+      const data_type *array = this->Array;
+      int numberOfInputComponents = this->NumberOfInputComponents;
+      const int *dims = this->Dims;
+      vtkIdType idx, idx2;
+      int inputComponent;
+      double xp[3], xm[3], factor;
+      xp[0] = xp[1] = xp[2] = xm[0] = xm[1] = xm[2] = factor = 0;
+      double xxi, yxi, zxi, xeta, yeta, zeta, xzeta, yzeta, zzeta;
+      yxi = zxi = xeta = yeta = zeta = xzeta = yzeta = zzeta = 0;
+      double aj, xix, xiy, xiz, etax, etay, etaz, zetax, zetay, zetaz;
+      xix = xiy = xiz = etax = etay = etaz = zetax = zetay = zetaz = 0;
+      // for finite differencing -- the values on the "plus" side and
+      // "minus" side of the point to be computed at
+      std::vector<double> plusvalues(numberOfInputComponents);
+      std::vector<double> minusvalues(numberOfInputComponents);
+
+      std::vector<double> dValuesdXi(numberOfInputComponents);
+      std::vector<double> dValuesdEta(numberOfInputComponents);
+      std::vector<double> dValuesdZeta(numberOfInputComponents);
+      std::vector<data_type> localGradients(numberOfInputComponents*3);
+
+      vtkIdType ijsize = static_cast<vtkIdType>(dims[0])*dims[1];
+
+      for (vtkIdType row=beginRow; row<endRow; row++)
       {
+        int j = static_cast<int>(row % dims[1]);
+        int k = static_cast<int>(row / dims[1]);
         for (int i=0; i<dims[0]; i++)
         {
           //  Xi derivatives.
@@ -1005,8 +1329,8 @@ namespace {
             factor = 1.0;
             idx = (i+1) + j*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1019,8 +1343,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i-1 + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1033,8 +1357,8 @@ namespace {
             factor = 0.5;
             idx = (i+1) + j*dims[0] + k*ijsize;
             idx2 = (i-1) + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1072,8 +1396,8 @@ namespace {
             factor = 1.0;
             idx = i + (j+1)*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1086,8 +1410,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1100,8 +1424,8 @@ namespace {
             factor = 0.5;
             idx = i + (j+1)*dims[0] + k*ijsize;
             idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1139,8 +1463,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + (k+1)*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1153,8 +1477,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1167,8 +1491,8 @@ namespace {
             factor = 0.5;
             idx = i + j*dims[0] + (k+1)*ijsize;
             idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            this->GetCoordinate(idx, xp);
+            this->GetCoordinate(idx2, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
@@ -1230,28 +1554,331 @@ namespace {
               zetaz*dValuesdZeta[inputComponent]);
           }
 
-          if(gradients)
+          if(this->Gradients)
           {
             for(int ii=0;ii<3*numberOfInputComponents;ii++)
             {
-              gradients[idx*numberOfInputComponents*3+ii] = localGradients[ii];
+              this->Gradients[idx*numberOfInputComponents*3+ii] =
+                localGradients[ii];
             }
           }
-          if(vorticity)
+          if(this->Vorticity)
+          {
+            ComputeVorticityFromGradient(&localGradients[0],
+                                         this->Vorticity+3*idx);
+          }
+          if(this->QCriterion)
+          {
+            ComputeQCriterionFromGradient(&localGradients[0],
+                                          this->QCriterion+idx);
+          }
+          if(this->Divergence)
+          {
+            ComputeDivergenceFromGradient(&localGradients[0],
+                                          this->Divergence+idx);
+          }        }
+      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  // Centers of the hexahedra [begin, end) of a 3D structured grid, computed
+  // as vtkHexahedron evaluates its parametric center: the average of the
+  // points in the order of vtkStructuredGrid::GetCell().
+  class StructuredCellCenters
+  {
+  public:
+    vtkStructuredGrid *Grid;
+    int Dims[3];
+    double *Centers;
+    vtkSMPThreadLocalObject<vtkIdList> PointIds;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      static const int order[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+      vtkIdList *pointIds = this->PointIds.Local();
+      for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+        vtkStructuredData::GetCellPoints(cellId, pointIds, VTK_XYZ_GRID,
+                                         this->Dims);
+        double *center = this->Centers + 3*cellId;
+        center[0] = center[1] = center[2] = 0.0;
+        for (int i = 0; i < 8; i++)
+        {
+          double x[3];
+          this->Grid->GetPoint(pointIds->GetId(order[i]), x);
+          center[0] += x[0] * 0.125;
+          center[1] += x[1] * 0.125;
+          center[2] += x[2] * 0.125;
+        }
+      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  // Finite differences along one axis of an image or rectilinear grid: the
+  // neighbors of each entity, the difference factor and the distance used
+  // by the Jacobian. An axis with a single entity has no differences.
+  struct AxisStencil
+  {
+    std::vector<vtkIdType> Plus;
+    std::vector<vtkIdType> Minus;
+    std::vector<double> Factor;
+    std::vector<double> Delta;
+
+    void Build(const std::vector<double> &coords, int numEntities)
+    {
+      this->Plus.resize(numEntities);
+      this->Minus.resize(numEntities);
+      this->Factor.resize(numEntities);
+      this->Delta.resize(numEntities);
+      for (int i = 0; i < numEntities; i++)
+      {
+        if (numEntities == 1)
+        {
+          this->Plus[i] = this->Minus[i] = 0;
+          this->Factor[i] = this->Delta[i] = 1.0;
+          continue;
+        }
+        this->Plus[i] = i < numEntities-1 ? i+1 : i;
+        this->Minus[i] = i > 0 ? i-1 : i;
+        this->Factor[i] = (i == 0 || i == numEntities-1) ? 1.0 : 0.5;
+        this->Delta[i] = this->Factor[i] *
+          (coords[this->Plus[i]] - coords[this->Minus[i]]);
+      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  // Finite differences over the rows [beginRow, endRow) of an image or
+  // rectilinear grid. The Jacobian of these grids is diagonal: each
+  // derivative only involves the neighbors along its own axis, and the
+  // metrics reduce to the terms StructuredGradients computes for them.
+  template<class data_type>
+  class SeparableGradients
+  {
+  public:
+    const data_type *Array;
+    int NumberOfInputComponents;
+    int Dims[3];
+    AxisStencil Axes[3];
+    data_type *Gradients;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    data_type *Divergence;
+
+    void operator()(vtkIdType beginRow, vtkIdType endRow) const
+    {
+      int numberOfInputComponents = this->NumberOfInputComponents;
+      int numberOfOutputComponents = 3*numberOfInputComponents;
+      std::vector<data_type> localGradients(numberOfOutputComponents);
+      const AxisStencil &x = this->Axes[0];
+      const AxisStencil &y = this->Axes[1];
+      const AxisStencil &z = this->Axes[2];
+      const vtkIdType dimX = this->Dims[0];
+      const vtkIdType dimY = this->Dims[1];
+
+      for (vtkIdType row = beginRow; row < endRow; row++)
+      {
+        int j = static_cast<int>(row % dimY);
+        int k = static_cast<int>(row / dimY);
+        vtkIdType rowStart = row*dimX;
+        const data_type *yp =
+          this->Array + (y.Plus[j] + k*dimY)*dimX*numberOfInputComponents;
+        const data_type *ym =
+          this->Array + (y.Minus[j] + k*dimY)*dimX*numberOfInputComponents;
+        const data_type *zp =
+          this->Array + (j + z.Plus[k]*dimY)*dimX*numberOfInputComponents;
+        const data_type *zm =
+          this->Array + (j + z.Minus[k]*dimY)*dimX*numberOfInputComponents;
+        const double yeta = y.Delta[j];
+        const double zzeta = z.Delta[k];
+        for (vtkIdType i = 0; i < dimX; i++)
+        {
+          const double xxi = x.Delta[i];
+          double aj = xxi*yeta*zzeta;
+          if (aj != 0.0)
           {
-            ComputeVorticityFromGradient(&localGradients[0], vorticity+3*idx);
+            aj = 1. / aj;
           }
-          if(qCriterion)
+          const double xix = aj*(yeta*zzeta);
+          const double etay = aj*(xxi*zzeta);
+          const double zetaz = aj*(xxi*yeta);
+
+          const data_type *xp =
+            this->Array + (rowStart+x.Plus[i])*numberOfInputComponents;
+          const data_type *xm =
+            this->Array + (rowStart+x.Minus[i])*numberOfInputComponents;
+          vtkIdType offset = i*numberOfInputComponents;
+          for (int c = 0; c < numberOfInputComponents; c++)
           {
-            ComputeQCriterionFromGradient(&localGradients[0], qCriterion+idx);
+            double dValuesdXi = x.Factor[i] *
+              (static_cast<double>(xp[c]) - static_cast<double>(xm[c]));
+            double dValuesdEta = y.Factor[j] *
+              (static_cast<double>(yp[offset+c]) -
+               static_cast<double>(ym[offset+c]));
+            double dValuesdZeta = z.Factor[k] *
+              (static_cast<double>(zp[offset+c]) -
+               static_cast<double>(zm[offset+c]));
+            localGradients[3*c] = static_cast<data_type>(xix*dValuesdXi);
+            localGradients[3*c+1] = static_cast<data_type>(etay*dValuesdEta);
+            localGradients[3*c+2] = static_cast<data_type>(zetaz*dValuesdZeta);
           }
-          if(divergence)
+
+          vtkIdType idx = rowStart + i;
+          if(this->Gradients)
           {
-            ComputeDivergenceFromGradient(&localGradients[0], divergence+idx);
+            data_type *g = this->Gradients + idx*numberOfOutputComponents;
+            for (int ii = 0; ii < numberOfOutputComponents; ii++)
+            {
+              g[ii] = localGradients[ii];
+            }
+          }
+          if(this->Vorticity)
+          {
+            ComputeVorticityFromGradient(&localGradients[0],
+                                         this->Vorticity+3*idx);
+          }
+          if(this->QCriterion)
+          {
+            ComputeQCriterionFromGradient(&localGradients[0],
+                                          this->QCriterion+idx);
+          }
+          if(this->Divergence)
+          {
+            ComputeDivergenceFromGradient(&localGradients[0],
+                                          this->Divergence+idx);
           }
         }
       }
     }
+  };
+
+//-----------------------------------------------------------------------------
+  // Coordinates of the points along one axis of an image or rectilinear
+  // grid.
+  void GetAxisCoordinates(vtkImageData *image, int axis,
+                          std::vector<double> &coords)
+  {
+    int *extent = image->GetExtent();
+    double origin = image->GetOrigin()[axis];
+    double spacing = image->GetSpacing()[axis];
+    coords.resize(extent[2*axis+1] - extent[2*axis] + 1);
+    for (size_t i = 0; i < coords.size(); i++)
+    {
+      coords[i] = origin + (extent[2*axis] + static_cast<int>(i))*spacing;
+    }
+  }
+
+  void GetAxisCoordinates(vtkRectilinearGrid *grid, int axis,
+                          std::vector<double> &coords)
+  {
+    vtkDataArray *axisCoords = axis == 0 ? grid->GetXCoordinates() :
+      (axis == 1 ? grid->GetYCoordinates() : grid->GetZCoordinates());
+    coords.resize(grid->GetDimensions()[axis]);
+    for (size_t i = 0; i < coords.size(); i++)
+    {
+      coords[i] = axisCoords->GetComponent(static_cast<vtkIdType>(i), 0);
+    }
+  }
+
+//-----------------------------------------------------------------------------
+  // Threaded finite differences on image data and rectilinear grids.
+  template<class Grid, class data_type>
+  void ComputeGradientsSGSMP(Grid grid,
+                             const StructuredGradients<data_type> &sg,
+                             vtkIdType numRows)
+  {
+    SeparableGradients<data_type> separable;
+    separable.Array = sg.Array;
+    separable.NumberOfInputComponents = sg.NumberOfInputComponents;
+    separable.Gradients = sg.Gradients;
+    separable.Vorticity = sg.Vorticity;
+    separable.QCriterion = sg.QCriterion;
+    separable.Divergence = sg.Divergence;
+    for (int axis = 0; axis < 3; axis++)
+    {
+      separable.Dims[axis] = sg.Dims[axis];
+      std::vector<double> coords;
+      GetAxisCoordinates(grid, axis, coords);
+      if (sg.FieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+      {
+        // cell centers, as the pixels and voxels evaluate them
+        for (int i = 0; i < sg.Dims[axis]; i++)
+        {
+          coords[i] = coords[i] + 0.5 * (coords[i+1] - coords[i]);
+        }
+      }
+      separable.Axes[axis].Build(coords, sg.Dims[axis]);
+    }
+    vtkSMPTools::For(0, numRows, separable);
+  }
+
+//-----------------------------------------------------------------------------
+  // Threaded finite differences on structured grids.
+  template<class data_type>
+  void ComputeGradientsSGSMP(vtkStructuredGrid *grid,
+                             const StructuredGradients<data_type> &sg,
+                             vtkIdType numRows)
+  {
+    StructuredGradients<data_type> threaded = sg;
+    std::vector<double> centers;
+    if (sg.FieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+    {
+      // only 3D grids have cell gradients
+      StructuredCellCenters cellCenters;
+      cellCenters.Grid = grid;
+      grid->GetDimensions(cellCenters.Dims);
+      vtkIdType numCells = grid->GetNumberOfCells();
+      centers.resize(3*numCells);
+      cellCenters.Centers = numCells ? &centers[0] : NULL;
+      vtkSMPTools::For(0, numCells, cellCenters);
+      threaded.CellCenters = cellCenters.Centers;
+    }
+    vtkSMPTools::For(0, numRows, threaded);
+  }
+
+//-----------------------------------------------------------------------------
+  template<class Grid, class data_type>
+  void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
+                          int numberOfInputComponents, int fieldAssociation,
+                          data_type* vorticity, data_type* qCriterion,
+                          data_type* divergence, bool enableSMP)
+  {
+    StructuredGradients<data_type> sg;
+    sg.Output = output;
+    sg.Array = array;
+    sg.NumberOfInputComponents = numberOfInputComponents;
+    sg.FieldAssociation = fieldAssociation;
+    sg.CellCenters = NULL;
+    sg.Gradients = gradients;
+    sg.Vorticity = vorticity;
+    sg.QCriterion = qCriterion;
+    sg.Divergence = divergence;
+
+    output->GetDimensions(sg.Dims);
+    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+    {
+      // reduce the dimensions by 1 for cells
+      for(int i=0;i<3;i++)
+      {
+        sg.Dims[i]--;
+      }
+    }
+    if (sg.Dims[0] <= 0 || sg.Dims[1] <= 0 || sg.Dims[2] <= 0)
+    {
+      return;
+    }
+    vtkIdType numRows = static_cast<vtkIdType>(sg.Dims[1])*sg.Dims[2];
+
+    if (enableSMP)
+    {
+      ComputeGradientsSGSMP(output, sg, numRows);
+    }
+    else
+    {
+      sg(0, numRows);
+    }
   }
 
 } // end anonymous namespace
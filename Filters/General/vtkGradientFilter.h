@@ -161,6 +161,21 @@ public:
   vtkBooleanMacro(ComputeQCriterion, int);
   //@}
 
+  //@{
+  /**
+   * Compute the gradients, and the quantities derived from them, with
+   * vtkSMPTools. Point gradients of polydata and unstructured grids are
+   * gathered over static cell links from derivatives evaluated once per
+   * cell corner, cell gradients are computed per cell, and image data and
+   * rectilinear grids use separable finite differences. Structured grids
+   * run the serial finite differences over rows in parallel. The default
+   * is off.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkGradientFilter();
   ~vtkGradientFilter() VTK_OVERRIDE;
@@ -252,6 +267,11 @@ protected:
    */
   int ComputeVorticity;
 
+  /**
+   * Flag to compute the gradients with vtkSMPTools.
+   */
+  bool EnableSMP;
+
 private:
   vtkGradientFilter(const vtkGradientFilter &) VTK_DELETE_FUNCTION;
   void operator=(const vtkGradientFilter &) VTK_DELETE_FUNCTION;
@@ -0,0 +1,367 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTubeAndRibbonFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test the threaded execution of vtkTubeFilter and vtkRibbonFilter.
+// .SECTION Description
+// Sweep a set of streamline-like polylines with and without EnableSMP for
+// the radius, capping, texture coordinate and normal modes of both
+// filters. Both modes must produce the same points, cells and attributes.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCommand.h"
+#include "vtkDoubleArray.h"
+#include "vtkIntArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRibbonFilter.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestErrorObserver.h"
+#include "vtkTubeFilter.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// Helical polylines carrying point scalars, vectors and normals and a cell
+// field. Some polylines repeat a point, go back to their first point or
+// share points with the previous polyline. When degenerate is set, a few
+// polylines have a single point or repeat a point consecutively.
+vtkSmartPointer<vtkPolyData> MakeLines(int numLines, int numSegments,
+                                       bool degenerate)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkIntArray> field;
+  field->SetName("Field");
+
+  vtkIdType vertId = points->InsertNextPoint(0.0, 0.0, 0.0);
+  scalars->InsertNextValue(0.0);
+  vectors->InsertNextTuple3(1.0, 0.0, 0.0);
+  normals->InsertNextTuple3(0.0, 0.0, 1.0);
+  verts->InsertNextCell(1, &vertId);
+  field->InsertNextValue(-1);
+
+  for (int l = 0; l < numLines; ++l)
+  {
+    random->Next();
+    double x0 = 10.0 * random->GetValue();
+    random->Next();
+    double y0 = 10.0 * random->GetValue();
+    int npts = numSegments + 1 + l % 5;
+    vtkIdType first = points->GetNumberOfPoints();
+    std::vector<vtkIdType> ids;
+    if (l % 7 == 3)
+    {
+      ids.push_back(first - 1); // shared with the previous line
+    }
+    for (int i = 0; i < npts; ++i)
+    {
+      random->Next();
+      double r = random->GetValue();
+      double t = 0.3 * i;
+      vtkIdType id = points->InsertNextPoint(
+        x0 + cos(t) + 0.05 * r, y0 + sin(t), 0.2 * t);
+      scalars->InsertNextValue(0.1 + r + 0.01 * i);
+      vectors->InsertNextTuple3(-sin(t), cos(t), 0.2 + r);
+      normals->InsertNextTuple3(cos(t), sin(t), 0.0);
+      ids.push_back(id);
+      if (degenerate && l % 4 == 1 && i == npts / 2)
+      {
+        ids.push_back(id); // consecutive repeated point
+      }
+    }
+    if (l % 6 == 2)
+    {
+      ids.push_back(first + 1); // revisit a point
+    }
+    if (l % 9 == 5)
+    {
+      ids.push_back(first); // closed loop
+    }
+    lines->InsertNextCell(static_cast<vtkIdType>(ids.size()), &ids[0]);
+    field->InsertNextValue(l);
+    if (degenerate && l % 11 == 7)
+    {
+      vtkIdType single = first;
+      lines->InsertNextCell(1, &single);
+      field->InsertNextValue(-l);
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetVerts(verts.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+  polyData->GetPointData()->SetScalars(scalars.GetPointer());
+  polyData->GetPointData()->SetVectors(vectors.GetPointer());
+  polyData->GetPointData()->SetNormals(normals.GetPointer());
+  polyData->GetCellData()->AddArray(field.GetPointer());
+  return polyData;
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b, const char *name)
+{
+  if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents())
+  {
+    cerr << "Array " << name << " differs in size" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a->GetNumberOfComponents(); ++c)
+    {
+      if (a->GetComponent(i, c) != b->GetComponent(i, c))
+      {
+        cerr << "Array " << name << " differs at " << i << ": "
+             << a->GetComponent(i, c) << " instead of "
+             << b->GetComponent(i, c) << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameAttributes(vtkDataSetAttributes *a, vtkDataSetAttributes *b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    cerr << a->GetNumberOfArrays() << " arrays instead of "
+         << b->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int i = 0; i < b->GetNumberOfArrays(); ++i)
+  {
+    const char *name = b->GetArrayName(i) ? b->GetArrayName(i) : "unnamed";
+    if (!SameArrays(a->GetArray(i), b->GetArray(i), name))
+    {
+      return false;
+    }
+  }
+  for (int i = 0; i < vtkDataSetAttributes::NUM_ATTRIBUTES; ++i)
+  {
+    if ((a->GetAttribute(i) == NULL) != (b->GetAttribute(i) == NULL))
+    {
+      cerr << "Attribute " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameCells(vtkCellArray *a, vtkCellArray *b)
+{
+  if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      a->GetNumberOfConnectivityEntries() !=
+      b->GetNumberOfConnectivityEntries())
+  {
+    cerr << a->GetNumberOfCells() << " cells instead of "
+         << b->GetNumberOfCells() << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfConnectivityEntries(); ++i)
+  {
+    if (a->GetPointer()[i] != b->GetPointer()[i])
+    {
+      cerr << "Connectivity differs at " << i << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  return a->GetNumberOfPoints() > 0 &&
+    SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData(),
+               "Points") &&
+    SameCells(a->GetStrips(), b->GetStrips()) &&
+    SameAttributes(a->GetPointData(), b->GetPointData()) &&
+    SameAttributes(a->GetCellData(), b->GetCellData());
+}
+
+struct TubeMode
+{
+  const char *Name;
+  int VaryRadius;
+  int SidesShareVertices;
+  int Capping;
+  int OnRatio;
+  int Offset;
+  int GenerateTCoords;
+  int Normals; // 0: input normals, 1: generated, 2: default normal
+};
+
+const TubeMode TubeModes[] = {
+  { "default", VTK_VARY_RADIUS_OFF, 1, 0, 1, 0, VTK_TCOORDS_OFF, 0 },
+  { "capped, generated normals", VTK_VARY_RADIUS_OFF, 1, 1, 1, 0,
+    VTK_TCOORDS_OFF, 1 },
+  { "by scalar, separate sides", VTK_VARY_RADIUS_BY_SCALAR, 0, 1, 1, 0,
+    VTK_TCOORDS_FROM_SCALARS, 0 },
+  { "by vector, on ratio", VTK_VARY_RADIUS_BY_VECTOR, 1, 1, 3, 1,
+    VTK_TCOORDS_FROM_LENGTH, 1 },
+  { "by absolute scalar", VTK_VARY_RADIUS_BY_ABSOLUTE_SCALAR, 0, 0, 2, 1,
+    VTK_TCOORDS_FROM_NORMALIZED_LENGTH, 2 },
+  { "by scalar, default normal", VTK_VARY_RADIUS_BY_SCALAR, 0, 1, 1, 0,
+    VTK_TCOORDS_FROM_NORMALIZED_LENGTH, 2 }
+};
+
+vtkSmartPointer<vtkPolyData> Tube(vtkPolyData *lines, const TubeMode &mode,
+                                  bool smp)
+{
+  // The serial filter removes the repeated points of the input lines.
+  vtkNew<vtkPolyData> input;
+  input->DeepCopy(lines);
+  if (mode.Normals == 1)
+  {
+    input->GetPointData()->SetNormals(NULL);
+  }
+  vtkNew<vtkTubeFilter> tube;
+  tube->SetInputData(input.GetPointer());
+  tube->SetRadius(0.1);
+  tube->SetNumberOfSides(6);
+  tube->SetVaryRadius(mode.VaryRadius);
+  tube->SetSidesShareVertices(mode.SidesShareVertices);
+  tube->SetCapping(mode.Capping);
+  tube->SetOnRatio(mode.OnRatio);
+  tube->SetOffset(mode.Offset);
+  tube->SetGenerateTCoords(mode.GenerateTCoords);
+  tube->SetUseDefaultNormal(mode.Normals == 2);
+  tube->SetEnableSMP(smp);
+  tube->Update();
+  return tube->GetOutput();
+}
+
+vtkSmartPointer<vtkPolyData> Ribbon(vtkPolyData *lines, int mode, bool smp)
+{
+  vtkNew<vtkPolyData> input;
+  input->DeepCopy(lines);
+  if (mode & 1)
+  {
+    input->GetPointData()->SetNormals(NULL);
+  }
+  vtkNew<vtkRibbonFilter> ribbon;
+  ribbon->SetInputData(input.GetPointer());
+  ribbon->SetWidth(0.1);
+  ribbon->SetAngle((mode & 2) ? 30.0 : 0.0);
+  ribbon->SetVaryWidth((mode & 4) != 0);
+  ribbon->SetUseDefaultNormal((mode & 8) != 0);
+  ribbon->SetGenerateTCoords(mode / 16);
+  ribbon->SetEnableSMP(smp);
+  ribbon->Update();
+  return ribbon->GetOutput();
+}
+
+// A polyline that turns back on itself has no bevel vector at the turn.
+// Both modes ribbon it with the alternate vector and warn about it.
+bool TestAlternateBevel()
+{
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(0.0, 0.0, 0.0);
+  points->InsertNextPoint(1.0, 0.0, 0.0);
+  points->InsertNextPoint(0.5, 0.0, 0.0);
+  vtkNew<vtkDoubleArray> normals;
+  normals->SetNumberOfComponents(3);
+  for (int i = 0; i < 3; ++i)
+  {
+    normals->InsertNextTuple3(0.0, 0.0, 1.0);
+  }
+  vtkIdType ids[3] = { 0, 1, 2 };
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(3, ids);
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+  input->SetLines(lines.GetPointer());
+  input->GetPointData()->SetNormals(normals.GetPointer());
+
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  for (int smp = 0; smp < 2; ++smp)
+  {
+    vtkNew<vtkTest::ErrorObserver> observer;
+    vtkNew<vtkRibbonFilter> ribbon;
+    ribbon->AddObserver(vtkCommand::WarningEvent, observer.GetPointer());
+    ribbon->SetInputData(input.GetPointer());
+    ribbon->SetEnableSMP(smp != 0);
+    ribbon->Update();
+    if (observer->CheckWarningMessage("Using alternate bevel vector"))
+    {
+      return false;
+    }
+    outputs[smp] = ribbon->GetOutput();
+  }
+  return outputs[0]->GetNumberOfPoints() == 6 &&
+    SameOutputs(outputs[1], outputs[0]);
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+int TestTubeAndRibbonFilterSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> lines = MakeLines(200, 20, true);
+
+  bool res = true;
+  int numModes = static_cast<int>(sizeof(TubeModes) / sizeof(TubeMode));
+  for (int i = 0; i < numModes; ++i)
+  {
+    vtkSmartPointer<vtkPolyData> serial = Tube(lines, TubeModes[i], false);
+    vtkSmartPointer<vtkPolyData> threaded = Tube(lines, TubeModes[i], true);
+    if (!SameOutputs(threaded, serial))
+    {
+      cerr << "TubeFilter failed in mode " << TubeModes[i].Name << endl;
+      res = false;
+    }
+  }
+
+  // The serial ribbon filter does not remove repeated points, and keeps the
+  // points of the polylines it fails to ribbon.
+  lines = MakeLines(200, 20, false);
+  for (int mode = 0; mode < 64; ++mode)
+  {
+    vtkSmartPointer<vtkPolyData> serial = Ribbon(lines, mode, false);
+    vtkSmartPointer<vtkPolyData> threaded = Ribbon(lines, mode, true);
+    if (!SameOutputs(threaded, serial))
+    {
+      cerr << "RibbonFilter failed in mode " << mode << endl;
+      res = false;
+    }
+  }
+
+  if (!TestAlternateBevel())
+  {
+    cerr << "RibbonFilter failed on a polyline turning back" << endl;
+    res = false;
+  }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
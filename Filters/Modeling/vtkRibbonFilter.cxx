@@ -17,14 +17,24 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkPolyLine.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 vtkStandardNewMacro(vtkRibbonFilter);
 
@@ -45,6 +55,8 @@ vtkRibbonFilter::vtkRibbonFilter()
   this->GenerateTCoords = 0;
   this->TextureLength = 1.0;
 
+  this->EnableSMP = false;
+
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
                                vtkDataSetAttributes::SCALARS);
@@ -85,18 +97,14 @@ int vtkRibbonFilter::RequestData(
   vtkPoints *inPts;
   vtkIdType numPts;
   vtkIdType numLines;
-  vtkIdType numNewPts, numNewCells;
+  vtkIdType numNewPts;
   vtkPoints *newPts;
   int deleteNormals=0;
   vtkFloatArray *newNormals;
   vtkIdType i;
   double range[2];
   vtkCellArray *newStrips;
-  vtkIdType npts=0, *pts=NULL;
-  vtkIdType offset=0;
   vtkFloatArray *newTCoords=NULL;
-  int abort=0;
-  vtkIdType inCellId;
 
   // Check input and initialize
   //
@@ -113,13 +121,9 @@ int vtkRibbonFilter::RequestData(
   // Create the geometry and topology
   numNewPts = 2 * numPts;
   newPts = vtkPoints::New();
-  newPts->Allocate(numNewPts);
   newNormals = vtkFloatArray::New();
   newNormals->SetNumberOfComponents(3);
-  newNormals->Allocate(3*numNewPts);
   newStrips = vtkCellArray::New();
-  newStrips->Allocate(newStrips->EstimateSize(1,numNewPts));
-  vtkCellArray *singlePolyline = vtkCellArray::New();
 
   // Point data: copy scalars, vectors, tcoords. Normals may be computed here.
   outPD->CopyNormalsOff();
@@ -129,35 +133,30 @@ int vtkRibbonFilter::RequestData(
   {
     newTCoords = vtkFloatArray::New();
     newTCoords->SetNumberOfComponents(2);
-    newTCoords->Allocate(numNewPts);
     outPD->CopyTCoordsOff();
   }
   outPD->CopyAllocate(pd,numNewPts);
 
   int generateNormals = 0;
   inNormals = this->GetInputArrayToProcess(1,inputVector);
-  if ( !inNormals || this->UseDefaultNormal )
+  if ( this->UseDefaultNormal )
   {
     deleteNormals = 1;
     inNormals = vtkFloatArray::New();
     inNormals->SetNumberOfComponents(3);
     inNormals->SetNumberOfTuples(numPts);
-
-    if ( this->UseDefaultNormal )
+    for ( i=0; i < numPts; i++)
     {
-      for ( i=0; i < numPts; i++)
-      {
-        inNormals->SetTuple(i,this->DefaultNormal);
-      }
-    }
-    else
-    {
-      // Normal generation has been moved to lower in the function.
-      // This allows each different polylines to share vertices, but have
-      // their normals (and hence their ribbons) calculated independently
-      generateNormals = 1;
+      inNormals->SetTuple(i,this->DefaultNormal);
     }
   }
+  else if ( !inNormals )
+  {
+    // The normals are generated for each polyline. This allows different
+    // polylines to share vertices, but have their normals (and hence their
+    // ribbons) calculated independently
+    generateNormals = 1;
+  }
 
   // If varying width, get appropriate info.
   //
@@ -173,68 +172,16 @@ int vtkRibbonFilter::RequestData(
 
   // Copy selected parts of cell data; certainly don't want normals
   //
-  numNewCells = inLines->GetNumberOfCells();
   outCD->CopyNormalsOff();
-  outCD->CopyAllocate(cd,numNewCells);
+  outCD->CopyAllocate(cd,numLines);
 
   //  Create points along each polyline that are connected into NumberOfSides
   //  triangle strips. Texture coordinates are optionally generated.
   //
   this->Theta = vtkMath::RadiansFromDegrees( this->Angle );
-  vtkPolyLine *lineNormalGenerator = vtkPolyLine::New();
-  for (inCellId=0, inLines->InitTraversal();
-       inLines->GetNextCell(npts,pts) && !abort; inCellId++)
-  {
-    this->UpdateProgress((double)inCellId/numLines);
-    abort = this->GetAbortExecute();
-
-    if (npts < 2)
-    {
-      vtkWarningMacro(<< "Less than two points in line!");
-      continue; //skip tubing this polyline
-    }
-
-    // If necessary calculate normals, each polyline calculates its
-    // normals independently, avoiding conflicts at shared vertices.
-    if (generateNormals)
-    {
-      singlePolyline->Reset(); //avoid instantiation
-      singlePolyline->InsertNextCell(npts,pts);
-      if ( !lineNormalGenerator->GenerateSlidingNormals(inPts,singlePolyline,
-                                                        inNormals) )
-      {
-        vtkWarningMacro(<< "No normals for line!");
-        continue; //skip tubing this polyline
-      }
-    }
-
-    // Generate the points around the polyline. The strip is not created
-    // if the polyline is bad.
-    //
-    if ( !this->GeneratePoints(offset,npts,pts,inPts,newPts,pd,outPD,
-                               newNormals,inScalars,range,inNormals) )
-    {
-      vtkWarningMacro(<< "Could not generate points!");
-      continue; //skip ribboning this polyline
-    }
-
-    // Generate the strip for this polyline
-    //
-    this->GenerateStrip(offset,npts,pts,inCellId,cd,outCD,newStrips);
-
-    // Generate the texture coordinates for this polyline
-    //
-    if ( newTCoords )
-    {
-      this->GenerateTextureCoords(offset,npts,pts,inPts,inScalars,newTCoords);
-    }
-
-    // Compute the new offset for the next polyline
-    offset = this->ComputeOffset(offset,npts);
-
-  }//for all polylines
-
-  singlePolyline->Delete();
+  this->GenerateRibbons(input, output, inNormals, generateNormals != 0,
+                        inScalars, range, newPts, newNormals, newTCoords,
+                        newStrips);
 
   // Update ourselves
   //
@@ -257,20 +204,402 @@ int vtkRibbonFilter::RequestData(
 
   outPD->SetNormals(newNormals);
   newNormals->Delete();
-  lineNormalGenerator->Delete();
 
   output->Squeeze();
 
   return 1;
 }
 
+namespace {
+
+// Compute the sliding normals of one polyline into lineNormals, indexed by
+// position along the line. A point visited more than once by the polyline
+// gets the normal of its last visit, as when the normals are stored in an
+// array indexed by point id.
+void ComputeLineNormals(vtkPoints *inPts, vtkIdType npts,
+                        const vtkIdType *pts, vtkPoints *linePts,
+                        vtkCellArray *line, vtkFloatArray *normals,
+                        std::vector<std::pair<vtkIdType, vtkIdType> > &visits,
+                        float *lineNormals)
+{
+  double x[3];
+  linePts->SetNumberOfPoints(npts);
+  line->Reset();
+  line->InsertNextCell(static_cast<int>(npts));
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    inPts->GetPoint(pts[j], x);
+    linePts->SetPoint(j, x);
+    line->InsertCellPoint(j);
+  }
+  normals->SetNumberOfTuples(npts);
+  vtkPolyLine::GenerateSlidingNormals(linePts, line, normals);
+  std::copy(normals->GetPointer(0), normals->GetPointer(0) + 3 * npts,
+            lineNormals);
+
+  visits.resize(npts);
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    visits[j] = std::make_pair(pts[j], j);
+  }
+  std::sort(visits.begin(), visits.end());
+  for (vtkIdType first = 0, last = 0; first < npts; first = last + 1)
+  {
+    for (last = first; last + 1 < npts &&
+           visits[last + 1].first == visits[first].first; ++last)
+    {
+    }
+    const float *n = lineNormals + 3 * visits[last].second;
+    for (vtkIdType j = first; j < last; ++j)
+    {
+      std::copy(n, n + 3, lineNormals + 3 * visits[j].second);
+    }
+  }
+}
+
+// The ribbon of a polyline is generated when its status is at most
+// RIBBON_ALTERNATE_BEVEL.
+enum RibbonStatus
+{
+  RIBBON_OK = 0,
+  RIBBON_ALTERNATE_BEVEL,
+  RIBBON_TOO_SHORT,
+  RIBBON_COINCIDENT_POINTS,
+  RIBBON_BAD_NORMAL
+};
+
+bool IsRibbonGenerated(int status)
+{
+  return status <= RIBBON_ALTERNATE_BEVEL;
+}
+
+void ReportRibbonStatus(vtkRibbonFilter *self, int status, vtkIdType lineId)
+{
+  switch (status)
+  {
+    case RIBBON_ALTERNATE_BEVEL:
+      vtkWarningWithObjectMacro(self, << "Using alternate bevel vector");
+      break;
+    case RIBBON_TOO_SHORT:
+      vtkWarningWithObjectMacro(self, << "Less than two points in line!");
+      break;
+    case RIBBON_COINCIDENT_POINTS:
+      vtkWarningWithObjectMacro(self, <<"Coincident points!");
+      vtkWarningWithObjectMacro(self, << "Could not generate points!");
+      break;
+    case RIBBON_BAD_NORMAL:
+      vtkWarningWithObjectMacro(self, <<"Bad normal in line " << lineId);
+      vtkWarningWithObjectMacro(self, << "Could not generate points!");
+      break;
+  }
+}
+
+void MakeRange(vtkIdList *ids, vtkIdType n)
+{
+  ids->SetNumberOfIds(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    ids->SetId(i, i);
+  }
+}
+
+}
+
+// Generate the ribbon of one polyline with the helper methods of the
+// filter. PrepareLine() computes the normals of the polyline; GenerateLine()
+// writes its ribbon at the offsets computed from the preceding polylines.
+// The serial loop calls both for each polyline in turn; the threaded one
+// prepares and checks every polyline concurrently, computes the offsets,
+// then generates the ribbons concurrently.
+struct vtkRibbonGenerator
+{
+  vtkRibbonFilter *Self;
+
+  // input
+  vtkPoints *InPts;
+  vtkDataArray *InNormals; // NULL when the normals are generated
+  vtkDataArray *InScalars;
+  double Range[2];
+  const vtkIdType *Lines; // input connectivity
+  const vtkIdType *LineLocations;
+
+  // polylines
+  float *LineNormals; // same layout as Lines, NULL without generation
+  unsigned char *Status;
+
+  // output
+  bool Generate; // whether operator() generates or prepares the ribbons
+  vtkIdType *PointOffsets;
+  vtkIdType *StripOffsets;
+  vtkIdType *ConnectivityOffsets;
+  vtkPoints *NewPts;
+  float *NewNormals;
+  float *NewTCoords;
+  vtkIdType *PointSourceIds;
+  vtkIdType *Strips;
+  vtkIdType *CellSourceIds;
+
+  vtkSMPThreadLocalObject<vtkPoints> LinePts;
+  vtkSMPThreadLocalObject<vtkCellArray> Line;
+  vtkSMPThreadLocalObject<vtkFloatArray> Normals;
+  vtkSMPThreadLocal<std::vector<std::pair<vtkIdType, vtkIdType> > > Visits;
+
+  void Initialize()
+  {
+    this->LinePts.Local()->SetDataTypeToDouble();
+    this->Normals.Local()->SetNumberOfComponents(3);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType lineId = begin; lineId < end; ++lineId)
+    {
+      if (!this->Generate)
+      {
+        this->PrepareLine(lineId, true);
+      }
+      else if (IsRibbonGenerated(this->Status[lineId]))
+      {
+        this->GenerateLine(lineId);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+  const float *GetLineNormals(vtkIdType lineId)
+  {
+    return this->LineNormals ?
+      this->LineNormals + 3 * (this->LineLocations[lineId] + 1) : NULL;
+  }
+
+  // Generate the normals of a polyline. When check is set, also check that
+  // the polyline can be ribboned.
+  void PrepareLine(vtkIdType lineId, bool check)
+  {
+    vtkIdType loc = this->LineLocations[lineId];
+    vtkIdType npts = this->Lines[loc];
+    const vtkIdType *pts = this->Lines + loc + 1;
+    if (npts < 2)
+    {
+      this->Status[lineId] = RIBBON_TOO_SHORT;
+      return;
+    }
+
+    // Each polyline calculates its normals independently, avoiding
+    // conflicts at shared vertices.
+    if (this->LineNormals)
+    {
+      ComputeLineNormals(this->InPts, npts, pts, this->LinePts.Local(),
+                         this->Line.Local(), this->Normals.Local(),
+                         this->Visits.Local(),
+                         this->LineNormals + 3 * (loc + 1));
+    }
+    this->Status[lineId] = RIBBON_OK;
+    if (check)
+    {
+      this->Status[lineId] = static_cast<unsigned char>(
+        this->Self->GeneratePoints(0, npts, pts, this->InPts, NULL, NULL, NULL,
+                                   this->InScalars, this->Range,
+                                   this->InNormals, this->GetLineNormals(lineId)));
+    }
+  }
+
+  // Write the points, strip and texture coordinates of a prepared polyline
+  // at its output offsets, and return its status.
+  int GenerateLine(vtkIdType lineId)
+  {
+    vtkIdType loc = this->LineLocations[lineId];
+    vtkIdType npts = this->Lines[loc];
+    const vtkIdType *pts = this->Lines + loc + 1;
+    vtkIdType offset = this->PointOffsets[lineId];
+    int status = this->Self->GeneratePoints(
+      offset, npts, pts, this->InPts, this->NewPts, this->NewNormals,
+      this->PointSourceIds, this->InScalars, this->Range, this->InNormals,
+      this->GetLineNormals(lineId));
+    if (!IsRibbonGenerated(status))
+    {
+      return status;
+    }
+    this->Self->GenerateStrip(
+      offset, npts, lineId, this->Strips + this->ConnectivityOffsets[lineId],
+      this->CellSourceIds + this->StripOffsets[lineId]);
+    if (this->NewTCoords)
+    {
+      this->Self->GenerateTextureCoords(offset, npts, pts, this->InPts,
+                                        this->InScalars, this->NewTCoords);
+    }
+    return status;
+  }
+
+  // Compute the output offsets of the polyline following lineId.
+  void AdvanceOffsets(vtkIdType lineId)
+  {
+    vtkIdType numPts = 0;
+    if (IsRibbonGenerated(this->Status[lineId]))
+    {
+      numPts = this->Self->ComputeOffset(0, this->Lines[
+                                           this->LineLocations[lineId]]);
+    }
+    this->PointOffsets[lineId + 1] = this->PointOffsets[lineId] + numPts;
+    this->StripOffsets[lineId + 1] =
+      this->StripOffsets[lineId] + (numPts ? 1 : 0);
+    this->ConnectivityOffsets[lineId + 1] =
+      this->ConnectivityOffsets[lineId] + (numPts ? numPts + 1 : 0);
+  }
+};
+
+void vtkRibbonFilter::GenerateRibbons(vtkPolyData *input,
+                                      vtkPolyData *output,
+                                      vtkDataArray *inNormals,
+                                      bool generateNormals,
+                                      vtkDataArray *inScalars,
+                                      double range[2], vtkPoints *newPts,
+                                      vtkFloatArray *newNormals,
+                                      vtkFloatArray *newTCoords,
+                                      vtkCellArray *newStrips)
+{
+  vtkCellArray *inLines = input->GetLines();
+  vtkIdType numLines = inLines->GetNumberOfCells();
+  vtkIdType numEntries = inLines->GetNumberOfConnectivityEntries();
+  const vtkIdType *lines = inLines->GetPointer();
+
+  std::vector<vtkIdType> lineLocations(numLines);
+  for (vtkIdType lineId = 0, loc = 0; lineId < numLines; ++lineId)
+  {
+    lineLocations[lineId] = loc;
+    loc += lines[loc] + 1;
+  }
+  std::vector<float> lineNormals(generateNormals ? 3 * numEntries : 0);
+  std::vector<unsigned char> status(numLines);
+  std::vector<vtkIdType> ptOffsets(numLines + 1, 0);
+  std::vector<vtkIdType> stripOffsets(numLines + 1, 0);
+  std::vector<vtkIdType> connOffsets(numLines + 1, 0);
+
+  vtkRibbonGenerator generator;
+  generator.Self = this;
+  generator.InPts = input->GetPoints();
+  generator.InNormals = generateNormals ? NULL : inNormals;
+  generator.InScalars = inScalars;
+  generator.Range[0] = range[0];
+  generator.Range[1] = range[1];
+  generator.Lines = lines;
+  generator.LineLocations = numLines ? &lineLocations[0] : NULL;
+  generator.LineNormals = generateNormals ? &lineNormals[0] : NULL;
+  generator.Status = numLines ? &status[0] : NULL;
+  generator.PointOffsets = &ptOffsets[0];
+  generator.StripOffsets = &stripOffsets[0];
+  generator.ConnectivityOffsets = &connOffsets[0];
+
+  // Size the output: exactly once the polylines are checked when threaded,
+  // for every polyline otherwise.
+  vtkIdType numNewPts = 0, numNewStrips = 0, connSize = 0;
+  if (this->EnableSMP)
+  {
+    generator.Generate = false;
+    vtkSMPTools::For(0, numLines, generator);
+    this->UpdateProgress(0.4);
+    for (vtkIdType lineId = 0; lineId < numLines; ++lineId)
+    {
+      ReportRibbonStatus(this, status[lineId], lineId);
+      generator.AdvanceOffsets(lineId);
+    }
+    numNewPts = ptOffsets[numLines];
+    numNewStrips = stripOffsets[numLines];
+    connSize = connOffsets[numLines];
+  }
+  else
+  {
+    numNewPts = this->ComputeOffset(0, numEntries - numLines);
+    numNewStrips = numLines;
+    connSize = numNewPts + numLines;
+  }
+  newPts->SetNumberOfPoints(numNewPts);
+  newNormals->SetNumberOfTuples(numNewPts);
+  if (newTCoords)
+  {
+    newTCoords->SetNumberOfTuples(numNewPts);
+  }
+  vtkNew<vtkIdTypeArray> strips;
+  strips->SetNumberOfTuples(connSize);
+  vtkNew<vtkIdList> pointSourceIds;
+  pointSourceIds->SetNumberOfIds(numNewPts);
+  vtkNew<vtkIdList> cellSourceIds;
+  cellSourceIds->SetNumberOfIds(numNewStrips);
+
+  generator.Generate = true;
+  generator.NewPts = newPts;
+  generator.NewNormals = newNormals->GetPointer(0);
+  generator.NewTCoords = newTCoords ? newTCoords->GetPointer(0) : NULL;
+  generator.PointSourceIds = pointSourceIds->GetPointer(0);
+  generator.Strips = strips->GetPointer(0);
+  generator.CellSourceIds = cellSourceIds->GetPointer(0);
+  if (this->EnableSMP)
+  {
+    vtkSMPTools::For(0, numLines, generator);
+    this->UpdateProgress(0.8);
+  }
+  else
+  {
+    generator.Initialize();
+    int abort = 0;
+    vtkIdType lineId;
+    for (lineId = 0; lineId < numLines && !abort; ++lineId)
+    {
+      this->UpdateProgress(static_cast<double>(lineId) / numLines);
+      abort = this->GetAbortExecute();
+
+      generator.PrepareLine(lineId, false);
+      if (status[lineId] == RIBBON_OK)
+      {
+        status[lineId] =
+          static_cast<unsigned char>(generator.GenerateLine(lineId));
+      }
+      ReportRibbonStatus(this, status[lineId], lineId);
+      generator.AdvanceOffsets(lineId);
+    }
+
+    // Drop the room left for skipped polylines.
+    numNewPts = ptOffsets[lineId];
+    numNewStrips = stripOffsets[lineId];
+    newPts->SetNumberOfPoints(numNewPts);
+    newNormals->SetNumberOfTuples(numNewPts);
+    if (newTCoords)
+    {
+      newTCoords->SetNumberOfTuples(numNewPts);
+    }
+    strips->SetNumberOfTuples(connOffsets[lineId]);
+    pointSourceIds->SetNumberOfIds(numNewPts);
+    cellSourceIds->SetNumberOfIds(numNewStrips);
+  }
+
+  newStrips->SetCells(numNewStrips, strips.GetPointer());
+
+  // Copy the point and cell data of the polylines.
+  vtkNew<vtkIdList> dstIds;
+  MakeRange(dstIds.GetPointer(), numNewPts);
+  output->GetPointData()->CopyData(input->GetPointData(),
+                                   pointSourceIds.GetPointer(),
+                                   dstIds.GetPointer());
+  MakeRange(dstIds.GetPointer(), numNewStrips);
+  output->GetCellData()->CopyData(input->GetCellData(),
+                                  cellSourceIds.GetPointer(),
+                                  dstIds.GetPointer());
+}
+
+// Generate the points of the ribbon of a polyline from offset on, or only
+// check that the polyline can be ribboned when newPts is NULL.
 int vtkRibbonFilter::GeneratePoints(vtkIdType offset,
-                                  vtkIdType npts, vtkIdType *pts,
-                                  vtkPoints *inPts, vtkPoints *newPts,
-                                  vtkPointData *pd, vtkPointData *outPD,
-                                  vtkFloatArray *newNormals,
-                                  vtkDataArray *inScalars, double range[2],
-                                  vtkDataArray *inNormals)
+                                    vtkIdType npts, const vtkIdType *pts,
+                                    vtkPoints *inPts, vtkPoints *newPts,
+                                    float *newNormals,
+                                    vtkIdType *pointSourceIds,
+                                    vtkDataArray *inScalars,
+                                    const double range[2],
+                                    vtkDataArray *inNormals,
+                                    const float *lineNormals)
 {
   vtkIdType j;
   int i;
@@ -280,11 +609,11 @@ int vtkRibbonFilter::GeneratePoints(vtkIdType offset,
   double sPrev[3];
   double n[3];
   double s[3], sp[3], sm[3], v[3];
-  //double bevelAngle;
   double w[3];
   double nP[3];
   double sFactor=1.0;
   vtkIdType ptId=offset;
+  int status = RIBBON_OK;
 
   // Use "averaged" segment to create beveled effect.
   // Watch out for first and last points.
@@ -323,12 +652,21 @@ int vtkRibbonFilter::GeneratePoints(vtkIdType offset,
       }
     }
 
-    inNormals->GetTuple(pts[j], n);
+    if (lineNormals)
+    {
+      for (i=0; i<3; i++)
+      {
+        n[i] = lineNormals[3*j+i];
+      }
+    }
+    else
+    {
+      inNormals->GetTuple(pts[j], n);
+    }
 
     if ( vtkMath::Normalize(sNext) == 0.0 )
     {
-      vtkWarningMacro(<<"Coincident points!");
-      return 0;
+      return RIBBON_COINCIDENT_POINTS;
     }
 
     for (i=0; i<3; i++)
@@ -338,41 +676,25 @@ int vtkRibbonFilter::GeneratePoints(vtkIdType offset,
     // if s is zero then just use sPrev cross n
     if (vtkMath::Normalize(s) == 0.0)
     {
-      vtkWarningMacro(<< "Using alternate bevel vector");
+      status = RIBBON_ALTERNATE_BEVEL;
       vtkMath::Cross(sPrev,n,s);
-      if (vtkMath::Normalize(s) == 0.0)
-      {
-        vtkWarningMacro(<< "Using alternate bevel vector");
-      }
+      vtkMath::Normalize(s);
     }
-/*
-    if ( (bevelAngle = vtkMath::Dot(sNext,sPrev)) > 1.0 )
-      {
-      bevelAngle = 1.0;
-      }
-    if ( bevelAngle < -1.0 )
-      {
-      bevelAngle = -1.0;
-      }
-    bevelAngle = acos((double)bevelAngle) / 2.0; //(0->90 degrees)
-    if ( (bevelAngle = cos(bevelAngle)) == 0.0 )
-      {
-      bevelAngle = 1.0;
-      }
 
-    bevelAngle = this->Width / bevelAngle; //keep ribbon constant width
-*/
     vtkMath::Cross(s,n,w);
     if ( vtkMath::Normalize(w) == 0.0)
     {
-      vtkWarningMacro(<<"Bad normal s = " <<s[0]<<" "<<s[1]<<" "<< s[2]
-                      << " n = " << n[0] << " " << n[1] << " " << n[2]);
-      return 0;
+      return RIBBON_BAD_NORMAL;
     }
 
     vtkMath::Cross(w,s,nP); //create orthogonal coordinate system
     vtkMath::Normalize(nP);
 
+    if (!newPts)
+    {
+      continue;
+    }
+
     // Compute a scale factor based on scalars or vectors
     if ( inScalars && this->VaryWidth ) // varying by scalar values
     {
@@ -386,92 +708,68 @@ int vtkRibbonFilter::GeneratePoints(vtkIdType offset,
       v[i] = (w[i]*cos(this->Theta) + nP[i]*sin(this->Theta));
       sp[i] = p[i] + this->Width * sFactor * v[i];
       sm[i] = p[i] - this->Width * sFactor * v[i];
+      newNormals[3*ptId+i] = static_cast<float>(nP[i]);
+      newNormals[3*ptId+3+i] = static_cast<float>(nP[i]);
     }
-    newPts->InsertPoint(ptId,sm);
-    newNormals->InsertTuple(ptId,nP);
-    outPD->CopyData(pd,pts[j],ptId);
-    ptId++;
-    newPts->InsertPoint(ptId,sp);
-    newNormals->InsertTuple(ptId,nP);
-    outPD->CopyData(pd,pts[j],ptId);
-    ptId++;
+    newPts->SetPoint(ptId,sm);
+    pointSourceIds[ptId] = pts[j];
+    newPts->SetPoint(ptId+1,sp);
+    pointSourceIds[ptId+1] = pts[j];
+    ptId += 2;
   }//for all points in polyline
 
-  return 1;
+  return status;
 }
 
+// Generate the strip of the ribbon of a polyline, and record its input cell.
 void vtkRibbonFilter::GenerateStrip(vtkIdType offset, vtkIdType npts,
-                                    vtkIdType* vtkNotUsed(pts),
-                                    vtkIdType inCellId,
-                                    vtkCellData *cd, vtkCellData *outCD,
-                                    vtkCellArray *newStrips)
+                                    vtkIdType inCellId, vtkIdType *strip,
+                                    vtkIdType *cellSourceId)
 {
-  vtkIdType i, idx, outCellId;
-
-  outCellId = newStrips->InsertNextCell(npts*2);
-  outCD->CopyData(cd,inCellId,outCellId);
-  for (i=0; i < npts; i++)
+  *cellSourceId = inCellId;
+  *strip++ = npts*2;
+  for (vtkIdType i=0; i < 2*npts; i++)
   {
-    idx = 2*i;
-    newStrips->InsertCellPoint(offset+idx);
-    newStrips->InsertCellPoint(offset+idx+1);
+    *strip++ = offset+i;
   }
 }
 
 void vtkRibbonFilter::GenerateTextureCoords(vtkIdType offset,
-                                            vtkIdType npts, vtkIdType *pts,
+                                            vtkIdType npts,
+                                            const vtkIdType *pts,
                                             vtkPoints *inPts,
                                             vtkDataArray *inScalars,
-                                            vtkFloatArray *newTCoords)
+                                            float *newTCoords)
 {
   vtkIdType i;
-  int k;
   double tc;
+  float *tcoords = newTCoords + 2 * offset;
 
-  double s0, s;
   //The first texture coordinate is always 0.
-  for ( k=0; k < 2; k++)
-  {
-    newTCoords->InsertTuple2(offset+k,0.0,0.0);
-  }
-  if ( this->GenerateTCoords == VTK_TCOORDS_FROM_SCALARS && inScalars)
+  std::fill(tcoords, tcoords + 4, 0.0f);
+  if ( this->GenerateTCoords == VTK_TCOORDS_FROM_SCALARS )
   {
-    s0 = inScalars->GetTuple1(pts[0]);
+    double s0 = inScalars->GetComponent(pts[0], 0);
     for (i=1; i < npts; i++)
     {
-      s = inScalars->GetTuple1(pts[i]);
+      double s = inScalars->GetComponent(pts[i], 0);
       tc = (s - s0) / this->TextureLength;
-      for ( k=0; k < 2; k++)
-      {
-        newTCoords->InsertTuple2(offset+i*2+k,tc,0.0);
-      }
+      tcoords[4*i] = tcoords[4*i+2] = static_cast<float>(tc);
+      tcoords[4*i+1] = tcoords[4*i+3] = 0.0f;
     }
   }
-  else if ( this->GenerateTCoords == VTK_TCOORDS_FROM_LENGTH )
+  else
   {
-    double xPrev[3], x[3], len=0.0;
-    inPts->GetPoint(pts[0],xPrev);
-    for (i=1; i < npts; i++)
+    double xPrev[3], x[3], length=0.0, len=0.0;
+    if ( this->GenerateTCoords == VTK_TCOORDS_FROM_NORMALIZED_LENGTH )
     {
-      inPts->GetPoint(pts[i],x);
-      len += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
-      tc = len / this->TextureLength;
-      for ( k=0; k < 2; k++)
+      inPts->GetPoint(pts[0],xPrev);
+      for (i=1; i < npts; i++)
       {
-        newTCoords->InsertTuple2(offset+i*2+k,tc,0.0);
+        inPts->GetPoint(pts[i],x);
+        length += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
+        xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
       }
-      xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
-    }
-  }
-  else if ( this->GenerateTCoords == VTK_TCOORDS_FROM_NORMALIZED_LENGTH )
-  {
-    double xPrev[3], x[3], length=0.0, len=0.0;
-    inPts->GetPoint(pts[0],xPrev);
-    for (i=1; i < npts; i++)
-    {
-      inPts->GetPoint(pts[i],x);
-      length += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
-      xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
     }
 
     inPts->GetPoint(pts[0],xPrev);
@@ -479,11 +777,10 @@ void vtkRibbonFilter::GenerateTextureCoords(vtkIdType offset,
     {
       inPts->GetPoint(pts[i],x);
       len += sqrt(vtkMath::Distance2BetweenPoints(x,xPrev));
-      tc = len / length;
-      for ( k=0; k < 2; k++)
-      {
-        newTCoords->InsertTuple2(offset+i*2+k,tc,0.0);
-      }
+      tc = (this->GenerateTCoords == VTK_TCOORDS_FROM_LENGTH ?
+            len / this->TextureLength : len / length);
+      tcoords[4*i] = tcoords[4*i+2] = static_cast<float>(tc);
+      tcoords[4*i+1] = tcoords[4*i+3] = 0.0f;
       xPrev[0]=x[0]; xPrev[1]=x[1]; xPrev[2]=x[2];
     }
   }
@@ -535,5 +832,6 @@ void vtkRibbonFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Generate TCoords: "
      << this->GetGenerateTCoordsAsString() << endl;
   os << indent << "Texture Length: " << this->TextureLength << endl;
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
@@ -50,6 +50,7 @@ class vtkDataArray;
 class vtkFloatArray;
 class vtkPointData;
 class vtkPoints;
+class vtkPolyData;
 
 class VTKFILTERSMODELING_EXPORT vtkRibbonFilter : public vtkPolyDataAlgorithm
 {
@@ -149,6 +150,18 @@ public:
   vtkGetMacro(TextureLength,double);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded implementation. The normals of every polyline
+   * are computed concurrently with vtkSMPTools, then each ribbon is written
+   * at an offset computed from the number of points of the preceding
+   * polylines. The output is the same as the serial one. Off by default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkRibbonFilter();
   ~vtkRibbonFilter() VTK_OVERRIDE;
@@ -163,22 +176,36 @@ protected:
   int GenerateTCoords; //control texture coordinate generation
   double TextureLength; //this length is mapped to [0,1) texture space
 
-  // Helper methods
-  int GeneratePoints(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                     vtkPoints *inPts, vtkPoints *newPts,
-                     vtkPointData *pd, vtkPointData *outPD,
-                     vtkFloatArray *newNormals, vtkDataArray *inScalars,
-                     double range[2], vtkDataArray *inNormals);
-  void GenerateStrip(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                     vtkIdType inCellId, vtkCellData *cd, vtkCellData *outCD,
-                     vtkCellArray *newStrips);
-  void GenerateTextureCoords(vtkIdType offset, vtkIdType npts, vtkIdType *pts,
-                             vtkPoints *inPts, vtkDataArray *inScalars,
-                             vtkFloatArray *newTCoords);
+  // Helper methods. They write the ribbon of one polyline at the given
+  // output offsets, and are called concurrently when EnableSMP is on.
+  // GeneratePoints() returns a status telling whether the ribbon was
+  // generated, possibly with a warning, or why the polyline is skipped.
+  // Without output points, it only checks the polyline. The normals of the polyline are taken from lineNormals,
+  // indexed by position along the line, or else from inNormals.
+  int GeneratePoints(vtkIdType offset, vtkIdType npts, const vtkIdType *pts,
+                     vtkPoints *inPts, vtkPoints *newPts, float *newNormals,
+                     vtkIdType *pointSourceIds, vtkDataArray *inScalars,
+                     const double range[2], vtkDataArray *inNormals,
+                     const float *lineNormals);
+  void GenerateStrip(vtkIdType offset, vtkIdType npts, vtkIdType inCellId,
+                     vtkIdType *strip, vtkIdType *cellSourceId);
+  void GenerateTextureCoords(vtkIdType offset, vtkIdType npts,
+                             const vtkIdType *pts, vtkPoints *inPts,
+                             vtkDataArray *inScalars, float *newTCoords);
   vtkIdType ComputeOffset(vtkIdType offset,vtkIdType npts);
 
+  // Ribbon every polyline of the input, serially or with vtkSMPTools. The
+  // output arrays are allocated by RequestData() and sized here.
+  void GenerateRibbons(vtkPolyData *input, vtkPolyData *output,
+                       vtkDataArray *inNormals, bool generateNormals,
+                       vtkDataArray *inScalars, double range[2],
+                       vtkPoints *newPts, vtkFloatArray *newNormals,
+                       vtkFloatArray *newTCoords, vtkCellArray *newStrips);
+  friend struct vtkRibbonGenerator;
+
   // Helper data members
   double Theta;
+  bool EnableSMP;
 
 private:
   vtkRibbonFilter(const vtkRibbonFilter&) VTK_DELETE_FUNCTION;
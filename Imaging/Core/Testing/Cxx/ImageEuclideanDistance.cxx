@@ -0,0 +1,170 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageEuclideanDistance.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the Felzenszwalb algorithm of vtkImageEuclideanDistance with
+// Saito's algorithm and with a brute force search, and check that the
+// feature map points to a feature at the computed distance.
+
+#include "vtkSmartPointer.h"
+#include "vtkImageEuclideanDistance.h"
+#include "vtkImageData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+vtkSmartPointer<vtkImageData> MakeImage(
+  int nx, int ny, int nz, const double spacing[3], double fill)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(nx*1000 + ny*10 + nz);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(2, nx + 1, -3, ny - 4, 0, nz - 1);
+  image->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  vtkIdType n = static_cast<vtkIdType>(nx)*ny*nz;
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    random->Next();
+    ptr[i] = (random->GetValue() < fill ? 0 : 1);
+  }
+  return image;
+}
+
+double SquaredDistance(
+  const int dims[3], const double spacing[3], vtkIdType a, vtkIdType b)
+{
+  double d2 = 0.0;
+  for (int j = 0; j < 3; j++)
+  {
+    double d = ((a % dims[j]) - (b % dims[j]))*spacing[j];
+    d2 += d*d;
+    a /= dims[j];
+    b /= dims[j];
+  }
+  return d2;
+}
+
+int TestImage(vtkImageData *image, int anisotropy)
+{
+  vtkSmartPointer<vtkImageEuclideanDistance> saito =
+    vtkSmartPointer<vtkImageEuclideanDistance>::New();
+  saito->SetInputData(image);
+  saito->SetAlgorithmToSaito();
+  saito->SetConsiderAnisotropy(anisotropy);
+  saito->Update();
+
+  vtkSmartPointer<vtkImageEuclideanDistance> fast =
+    vtkSmartPointer<vtkImageEuclideanDistance>::New();
+  fast->SetInputData(image);
+  fast->SetAlgorithmToFelzenszwalb();
+  fast->SetConsiderAnisotropy(anisotropy);
+  fast->GenerateFeatureMapOn();
+  fast->Update();
+
+  int dims[3];
+  image->GetDimensions(dims);
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  if (anisotropy)
+  {
+    image->GetSpacing(spacing);
+  }
+
+  const unsigned char *inPtr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  const double *saitoPtr =
+    static_cast<double *>(saito->GetOutput()->GetScalarPointer());
+  const double *fastPtr =
+    static_cast<double *>(fast->GetOutput()->GetScalarPointer());
+  vtkIdTypeArray *featureMap = vtkIdTypeArray::SafeDownCast(
+    fast->GetOutput()->GetPointData()->GetArray("FeatureMap"));
+  if (!featureMap)
+  {
+    cerr << "No feature map was generated\n";
+    return 1;
+  }
+
+  vtkIdType n = image->GetNumberOfPoints();
+  std::vector<vtkIdType> features;
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    if (inPtr[i] == 0)
+    {
+      features.push_back(i);
+    }
+  }
+
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    double best = VTK_DOUBLE_MAX;
+    for (size_t j = 0; j < features.size(); j++)
+    {
+      double d2 = SquaredDistance(dims, spacing, i, features[j]);
+      best = (d2 < best ? d2 : best);
+    }
+
+    double tol = 1e-9*(best + 1.0);
+    vtkIdType feature = featureMap->GetValue(i);
+    if (fabs(fastPtr[i] - best) > tol ||
+        fabs(fastPtr[i] - saitoPtr[i]) > tol)
+    {
+      cerr << "Distance at point " << i << " is " << fastPtr[i]
+           << ", expected " << best << " (Saito " << saitoPtr[i] << ")\n";
+      return 1;
+    }
+    if (feature < 0 || feature >= n || inPtr[feature] != 0 ||
+        fabs(SquaredDistance(dims, spacing, i, feature) - best) > tol)
+    {
+      cerr << "Feature map at point " << i << " gives " << feature << "\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+} // end anonymous namespace
+
+int ImageEuclideanDistance(int, char *[])
+{
+  int rval = 0;
+
+  const double isotropic[3] = { 1.0, 1.0, 1.0 };
+  const double anisotropic[3] = { 0.5, 1.25, 2.0 };
+
+  vtkSmartPointer<vtkImageData> images[4] = {
+    MakeImage(23, 17, 11, isotropic, 0.02),
+    MakeImage(23, 17, 11, anisotropic, 0.002),
+    MakeImage(64, 48, 1, anisotropic, 0.01),
+    MakeImage(1, 9, 37, anisotropic, 0.05)
+  };
+
+  for (int i = 0; i < 4; i++)
+  {
+    for (int anisotropy = 0; anisotropy < 2; anisotropy++)
+    {
+      rval |= TestImage(images[i], anisotropy);
+    }
+  }
+
+  return rval;
+}
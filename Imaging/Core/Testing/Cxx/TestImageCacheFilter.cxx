@@ -0,0 +1,166 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageCacheFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkImageCacheFilter satisfies requests from one cached image
+// or from several cached images, that it discards the least recently used
+// images to stay within its limits, and that it keeps count of its hits,
+// partial hits, misses and evictions.
+
+#include "vtkSmartPointer.h"
+#include "vtkImageCacheFilter.h"
+#include "vtkImageData.h"
+#include "vtkRTAnalyticSource.h"
+
+namespace {
+
+// update the cache for the extent, and compare with the reference
+int CheckExtent(vtkImageCacheFilter *cache, vtkImageData *reference,
+                const int extent[6])
+{
+  cache->UpdateExtent(extent);
+  vtkImageData *output = cache->GetOutput();
+
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    for (int j = extent[2]; j <= extent[3]; j++)
+    {
+      for (int i = extent[0]; i <= extent[1]; i++)
+      {
+        double value = output->GetScalarComponentAsDouble(i, j, k, 0);
+        double expected = reference->GetScalarComponentAsDouble(i, j, k, 0);
+        if (value != expected)
+        {
+          cerr << "Value at (" << i << ", " << j << ", " << k << ") is "
+               << value << ", expected " << expected << "\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int CheckStatistics(vtkImageCacheFilter *cache, const char *name,
+                    int hits, int partialHits, int misses, int evictions)
+{
+  if (cache->GetNumberOfCacheHits() != hits ||
+      cache->GetNumberOfPartialCacheHits() != partialHits ||
+      cache->GetNumberOfCacheMisses() != misses ||
+      cache->GetNumberOfCacheEvictions() != evictions)
+  {
+    cerr << name << ": got " << cache->GetNumberOfCacheHits() << " hits, "
+         << cache->GetNumberOfPartialCacheHits() << " partial hits, "
+         << cache->GetNumberOfCacheMisses() << " misses, "
+         << cache->GetNumberOfCacheEvictions() << " evictions, expected "
+         << hits << ", " << partialHits << ", " << misses << ", "
+         << evictions << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+} // end anonymous namespace
+
+int TestImageCacheFilter(int, char *[])
+{
+  int rval = 0;
+
+  // the cache input, which generates only the requested extent
+  vtkSmartPointer<vtkRTAnalyticSource> source =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  source->SetWholeExtent(0, 63, 0, 63, 0, 31);
+
+  vtkSmartPointer<vtkRTAnalyticSource> referenceSource =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  referenceSource->SetWholeExtent(0, 63, 0, 63, 0, 31);
+  referenceSource->Update();
+  vtkImageData *reference = referenceSource->GetOutput();
+
+  vtkSmartPointer<vtkImageCacheFilter> cache =
+    vtkSmartPointer<vtkImageCacheFilter>::New();
+  cache->SetInputConnection(source->GetOutputPort());
+  cache->SetCacheSize(4);
+
+  // slabs and sub-extents of the slabs
+  const int slabA[6] = { 0, 63, 0, 63, 0, 9 };
+  const int slabB[6] = { 0, 63, 0, 63, 10, 19 };
+  const int slabC[6] = { 0, 63, 0, 63, 20, 29 };
+  const int insideA[6] = { 10, 20, 5, 30, 2, 5 };
+  const int acrossAB[6] = { 5, 40, 0, 63, 5, 15 };
+  const int unionAB[6] = { 0, 63, 0, 63, 0, 19 };
+  const int beyondAB[6] = { 0, 63, 0, 63, 0, 25 };
+
+  // an extent within one cached image is a hit
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckExtent(cache, reference, insideA);
+  rval |= CheckStatistics(cache, "One image", 2, 0, 1, 0);
+
+  // an extent that is covered by two cached images is a partial hit
+  rval |= CheckExtent(cache, reference, slabB);
+  rval |= CheckExtent(cache, reference, acrossAB);
+  rval |= CheckExtent(cache, reference, unionAB);
+  rval |= CheckStatistics(cache, "Two images", 2, 2, 2, 0);
+
+  // an extent that is not covered is a miss, and the new image replaces
+  // the cached images that it contains
+  unsigned long slabSize = cache->GetCacheMemorySize()/2;
+  rval |= CheckExtent(cache, reference, beyondAB);
+  rval |= CheckExtent(cache, reference, unionAB);
+  rval |= CheckStatistics(cache, "Replace", 3, 2, 3, 0);
+  if (cache->GetCacheMemorySize() > 3*slabSize)
+  {
+    cerr << "Cache uses " << cache->GetCacheMemorySize() << " KiB\n";
+    rval |= 1;
+  }
+
+  // with a memory limit for two slabs, the least recently used is evicted
+  cache->SetCacheMemoryLimit(2*slabSize + slabSize/2);
+  rval |= CheckStatistics(cache, "Memory limit", 3, 2, 3, 1);
+
+  // the input still has the large extent, so make it generate new data
+  source->Modified();
+  cache->ResetCacheStatistics();
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckExtent(cache, reference, slabB);
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckExtent(cache, reference, slabC);
+  rval |= CheckStatistics(cache, "LRU", 1, 0, 3, 1);
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckExtent(cache, reference, slabB);
+  rval |= CheckStatistics(cache, "LRU", 2, 0, 4, 2);
+  if (cache->GetCacheMemorySize() > cache->GetCacheMemoryLimit())
+  {
+    cerr << "Cache uses " << cache->GetCacheMemorySize() << " KiB\n";
+    rval |= 1;
+  }
+
+  // the number of images is limited by the cache size
+  cache->SetCacheSize(1);
+  rval |= CheckStatistics(cache, "Cache size", 2, 0, 4, 3);
+  rval |= CheckExtent(cache, reference, slabB);
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckStatistics(cache, "Cache size", 3, 0, 5, 4);
+
+  // modifying the input invalidates the cache
+  source->SetMaximum(100.0);
+  referenceSource->SetMaximum(100.0);
+  referenceSource->Update();
+  cache->ResetCacheStatistics();
+  rval |= CheckExtent(cache, reference, slabA);
+  rval |= CheckStatistics(cache, "Modified", 0, 0, 1, 0);
+
+  return rval;
+}
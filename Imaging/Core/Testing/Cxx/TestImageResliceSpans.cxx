@@ -0,0 +1,327 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageResliceSpans.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the span interpolation of vtkImageInterpolator with point
+// interpolation, and compare the output of vtkImageReslice for oblique
+// and permuted transforms (including the fixed-point path for 8-bit and
+// 16-bit data) with point interpolation.
+
+#include "vtkSmartPointer.h"
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageInterpolator.h"
+#include "vtkImageReslice.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+#include "vtkTransform.h"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+vtkSmartPointer<vtkImageData> MakeImage(
+  int scalarType, int numComps, const int extent[6])
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(scalarType*10 + numComps);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(const_cast<int *>(extent));
+  image->AllocateScalars(scalarType, numComps);
+
+  double range[2] = { 0.0, 255.0 };
+  if (scalarType == VTK_SHORT || scalarType == VTK_UNSIGNED_SHORT)
+  {
+    range[0] = image->GetScalarTypeMin();
+    range[1] = image->GetScalarTypeMax();
+  }
+  else if (scalarType == VTK_FLOAT || scalarType == VTK_DOUBLE)
+  {
+    range[0] = -1000.0;
+    range[1] = 1000.0;
+  }
+
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    for (int c = 0; c < numComps; c++)
+    {
+      random->Next();
+      double v = range[0] + (range[1] - range[0])*random->GetValue();
+      if (scalarType != VTK_FLOAT && scalarType != VTK_DOUBLE)
+      {
+        v = floor(v);
+      }
+      scalars->SetComponent(i, c, v);
+    }
+  }
+
+  return image;
+}
+
+// get the tolerance for interpolated values, relative to the data range
+double GetTolerance(vtkImageData *image)
+{
+  double range[2];
+  image->GetPointData()->GetScalars()->GetRange(range, -1);
+  return 1e-4*(range[1] - range[0]);
+}
+
+// compare InterpolateSpanIJK with InterpolateIJK
+int TestSpans(vtkImageData *image, int mode, int border)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(mode*10 + border);
+
+  vtkSmartPointer<vtkImageInterpolator> interpolator =
+    vtkSmartPointer<vtkImageInterpolator>::New();
+  interpolator->SetInterpolationMode(mode);
+  interpolator->SetBorderMode(border);
+  interpolator->Initialize(image);
+  interpolator->Update();
+
+  int extent[6];
+  image->GetExtent(extent);
+  int nc = interpolator->GetNumberOfComponents();
+  double tol = GetTolerance(image);
+
+  const int n = 150;
+  std::vector<double> span(n*nc);
+  std::vector<float> fspan(n*nc);
+  std::vector<double> value(nc);
+  std::vector<float> fvalue(nc);
+
+  for (int trial = 0; trial < 40; trial++)
+  {
+    // use small, large, negative and zero steps, and start outside of
+    // the extent to check the border modes
+    double point[3];
+    double delta[3];
+    for (int j = 0; j < 3; j++)
+    {
+      double size = extent[2*j+1] - extent[2*j] + 1;
+      random->Next();
+      point[j] = extent[2*j] - 2.0 + random->GetValue()*(size + 4.0);
+      random->Next();
+      delta[j] = (random->GetValue() - 0.5)*(trial < 30 ? 0.5 : 20.0);
+      if (trial % 10 == 0)
+      {
+        delta[j] = (j == 0 ? 1.0 : 0.0);
+      }
+    }
+    float fpoint[3] = {
+      static_cast<float>(point[0]),
+      static_cast<float>(point[1]),
+      static_cast<float>(point[2]) };
+    float fdelta[3] = {
+      static_cast<float>(delta[0]),
+      static_cast<float>(delta[1]),
+      static_cast<float>(delta[2]) };
+
+    interpolator->InterpolateSpanIJK(point, delta, &span[0], n);
+    interpolator->InterpolateSpanIJK(fpoint, fdelta, &fspan[0], n);
+
+    for (int i = 0; i < n; i++)
+    {
+      double p[3];
+      float fp[3];
+      for (int j = 0; j < 3; j++)
+      {
+        p[j] = point[j] + i*delta[j];
+        fp[j] = fpoint[j] + i*fdelta[j];
+      }
+      interpolator->InterpolateIJK(p, &value[0]);
+      interpolator->InterpolateIJK(fp, &fvalue[0]);
+
+      // for float, the precision of the position decreases with magnitude
+      double pmax = 0.0;
+      for (int j = 0; j < 3; j++)
+      {
+        pmax = (fabs(p[j]) > pmax ? fabs(p[j]) : pmax);
+      }
+      double ftol = tol*(1.0 + pmax*FLT_EPSILON*1e4);
+
+      for (int c = 0; c < nc; c++)
+      {
+        if (fabs(span[i*nc + c] - value[c]) > tol ||
+            fabs(fspan[i*nc + c] - fvalue[c]) > ftol)
+        {
+          cerr << "Span interpolation of " << image->GetScalarTypeAsString()
+               << " with mode " << mode << " and border " << border
+               << " gives " << span[i*nc + c] << " (float "
+               << fspan[i*nc + c] << ") at (" << p[0] << ", " << p[1]
+               << ", " << p[2] << "), expected " << value[c] << " (float "
+               << fvalue[c] << ")\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+// compare the output of vtkImageReslice with point interpolation
+int TestReslice(vtkImageData *image, int mode, vtkTransform *transform,
+                bool optimize)
+{
+  vtkSmartPointer<vtkImageReslice> reslice =
+    vtkSmartPointer<vtkImageReslice>::New();
+  reslice->SetInputData(image);
+  reslice->SetInterpolationMode(mode);
+  reslice->SetResliceAxes(transform->GetMatrix());
+  reslice->SetOptimization(optimize);
+  reslice->SetOutputSpacing(0.75, 0.5, 1.0);
+  reslice->SetOutputOrigin(-2.0, -3.0, -1.0);
+  reslice->SetOutputExtent(0, 37, 0, 31, 0, 7);
+  reslice->SetBackgroundLevel(1.0);
+  reslice->Update();
+  vtkImageData *output = reslice->GetOutput();
+
+  vtkSmartPointer<vtkImageInterpolator> interpolator =
+    vtkSmartPointer<vtkImageInterpolator>::New();
+  interpolator->SetInterpolationMode(mode);
+  interpolator->Initialize(image);
+  interpolator->Update();
+
+  int extent[6];
+  image->GetExtent(extent);
+  int nc = interpolator->GetNumberOfComponents();
+  bool isInteger = (image->GetScalarType() != VTK_FLOAT &&
+                    image->GetScalarType() != VTK_DOUBLE);
+  double tol = GetTolerance(image) + (isInteger ? 1.0 : 0.0);
+  std::vector<double> value(nc);
+
+  vtkMatrix4x4 *matrix = transform->GetMatrix();
+  int outExt[6];
+  output->GetExtent(outExt);
+  for (int k = outExt[4]; k <= outExt[5]; k++)
+  {
+    for (int j = outExt[2]; j <= outExt[3]; j++)
+    {
+      for (int i = outExt[0]; i <= outExt[1]; i++)
+      {
+        double x[4] = { -2.0 + 0.75*i, -3.0 + 0.5*j, -1.0 + k, 1.0 };
+        double p[4];
+        matrix->MultiplyPoint(x, p);
+
+        // the reslice border extends the bounds by half a voxel, skip
+        // points that are within rounding error of the bounds
+        bool inside = true;
+        bool near = false;
+        for (int l = 0; l < 3; l++)
+        {
+          double lo = extent[2*l] - 0.5;
+          double hi = extent[2*l+1] + 0.5;
+          inside &= (p[l] >= lo && p[l] <= hi);
+          near |= (fabs(p[l] - lo) < 1e-6 || fabs(p[l] - hi) < 1e-6);
+        }
+        if (near)
+        {
+          continue;
+        }
+
+        if (inside)
+        {
+          interpolator->InterpolateIJK(p, &value[0]);
+        }
+        for (int c = 0; c < nc; c++)
+        {
+          double expected = (inside ? value[c] : 1.0);
+          if (isInteger)
+          {
+            expected = floor(expected + 0.5);
+            expected = (expected > output->GetScalarTypeMin() ?
+                        expected : output->GetScalarTypeMin());
+            expected = (expected < output->GetScalarTypeMax() ?
+                        expected : output->GetScalarTypeMax());
+          }
+          double result = output->GetScalarComponentAsDouble(i, j, k, c);
+          if (fabs(result - expected) > tol)
+          {
+            cerr << "Reslice of " << image->GetScalarTypeAsString()
+                 << " with mode " << mode << " and optimization "
+                 << optimize << " gives " << result << " at (" << i << ", "
+                 << j << ", " << k << "), expected " << expected << "\n";
+            return 1;
+          }
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+} // end anonymous namespace
+
+int TestImageResliceSpans(int, char *[])
+{
+  int rval = 0;
+
+  const int scalarTypes[5] = {
+    VTK_UNSIGNED_CHAR, VTK_SIGNED_CHAR, VTK_SHORT, VTK_UNSIGNED_SHORT,
+    VTK_FLOAT };
+  const int extent[6] = { 2, 13, -3, 6, 4, 8 };
+  const int thinExtent[6] = { 0, 19, 0, 15, 3, 3 };
+
+  for (int t = 0; t < 5; t++)
+  {
+    vtkSmartPointer<vtkImageData> image =
+      MakeImage(scalarTypes[t], 1 + 2*(t % 2), extent);
+    vtkSmartPointer<vtkImageData> thinImage =
+      MakeImage(scalarTypes[t], 1, thinExtent);
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+      for (int border = 0; border < 3; border++)
+      {
+        rval |= TestSpans(image, mode, border);
+        rval |= TestSpans(thinImage, mode, border);
+      }
+    }
+
+    // a permutation with scaling, a permutation that reverses the rows,
+    // and an oblique transform
+    vtkSmartPointer<vtkTransform> transforms[3];
+    for (int i = 0; i < 3; i++)
+    {
+      transforms[i] = vtkSmartPointer<vtkTransform>::New();
+      transforms[i]->PostMultiply();
+      transforms[i]->Translate(4.3, 1.2, 5.6);
+    }
+    transforms[1]->RotateZ(180.0);
+    transforms[1]->RotateX(90.0);
+    transforms[1]->Translate(10.0, -1.0, 1.0);
+    transforms[2]->RotateWXYZ(30.0, 1.0, 2.0, 3.0);
+    transforms[2]->Translate(3.0, 0.0, 0.0);
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        rval |= TestReslice(image, mode, transforms[i], true);
+        rval |= TestReslice(image, mode, transforms[i], false);
+      }
+    }
+  }
+
+  return rval;
+}
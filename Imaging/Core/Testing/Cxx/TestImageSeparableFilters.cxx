@@ -0,0 +1,539 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageSeparableFilters.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the filters that use separable kernels (gaussian smoothing,
+// separable convolution, gradient and sobel) with a direct computation
+// of the sum over the neighborhood of each voxel.
+
+#include "vtkSmartPointer.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkImageGaussianSmooth.h"
+#include "vtkImageGradient.h"
+#include "vtkImageSeparableConvolution.h"
+#include "vtkImageSobel3D.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const int ImageExtent[6] = { -3, 20, 2, 18, 0, 10 };
+const int UpdateExtent[6] = { -1, 16, 2, 12, 3, 9 };
+
+vtkSmartPointer<vtkImageData> MakeImage(int scalarType, int numComps)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(scalarType*10 + numComps);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(const_cast<int *>(ImageExtent));
+  image->SetSpacing(1.0, 0.5, 2.0);
+  image->AllocateScalars(scalarType, numComps);
+
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    for (int c = 0; c < numComps; c++)
+    {
+      random->Next();
+      scalars->SetComponent(i, c, static_cast<int>(random->GetValue()*200));
+    }
+  }
+
+  return image;
+}
+
+// The weights of a 1D kernel at one position, with the kernel cut off at
+// the boundaries and normalized, or with the boundaries replicated.
+std::vector<double> ClipKernel(const std::vector<double>& kernel, int idx,
+                               int axis, bool replicate)
+{
+  int middle = static_cast<int>(kernel.size()/2);
+  int lo = ImageExtent[2*axis];
+  int hi = ImageExtent[2*axis + 1];
+  std::vector<double> weights(hi - lo + 1, 0.0);
+  double sum = 0.0;
+  for (size_t k = 0; k < kernel.size(); k++)
+  {
+    int j = idx + static_cast<int>(k) - middle;
+    if (replicate)
+    {
+      j = (j < lo ? lo : (j > hi ? hi : j));
+    }
+    if (j >= lo && j <= hi)
+    {
+      weights[j - lo] += kernel[k];
+      sum += kernel[k];
+    }
+  }
+  if (!replicate)
+  {
+    for (size_t k = 0; k < weights.size(); k++)
+    {
+      weights[k] /= sum;
+    }
+  }
+  return weights;
+}
+
+// Apply a sum of separable kernels at one voxel.
+double ApplyKernels(vtkImageData *image, int c, const int ijk[3],
+                    const std::vector<double> kernels[][3], int numTerms,
+                    bool replicate)
+{
+  double result = 0.0;
+  for (int t = 0; t < numTerms; t++)
+  {
+    std::vector<double> w[3];
+    for (int j = 0; j < 3; j++)
+    {
+      w[j] = ClipKernel(kernels[t][j], ijk[j], j, replicate);
+    }
+    for (size_t k2 = 0; k2 < w[2].size(); k2++)
+    {
+      for (size_t k1 = 0; k1 < w[1].size(); k1++)
+      {
+        double w12 = w[2][k2]*w[1][k1];
+        if (w12 == 0.0)
+        {
+          continue;
+        }
+        for (size_t k0 = 0; k0 < w[0].size(); k0++)
+        {
+          if (w[0][k0] != 0.0)
+          {
+            result += w12*w[0][k0]*image->GetScalarComponentAsDouble(
+              ImageExtent[0] + static_cast<int>(k0),
+              ImageExtent[2] + static_cast<int>(k1),
+              ImageExtent[4] + static_cast<int>(k2), c);
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+// Compare the output with the expected value at each voxel of the
+// update extent.
+int CheckOutput(const char *name, vtkImageData *image, vtkImageData *output,
+                int numComps, const std::vector<double> kernels[][3],
+                int numTerms, bool replicate, double tol, bool truncate)
+{
+  int ijk[3];
+  for (ijk[2] = UpdateExtent[4]; ijk[2] <= UpdateExtent[5]; ijk[2]++)
+  {
+    for (ijk[1] = UpdateExtent[2]; ijk[1] <= UpdateExtent[3]; ijk[1]++)
+    {
+      for (ijk[0] = UpdateExtent[0]; ijk[0] <= UpdateExtent[1]; ijk[0]++)
+      {
+        for (int c = 0; c < numComps; c++)
+        {
+          double expected = ApplyKernels(
+            image, c, ijk, kernels, numTerms, replicate);
+          if (truncate)
+          {
+            expected = floor(expected);
+          }
+          double value = output->GetScalarComponentAsDouble(
+            ijk[0], ijk[1], ijk[2], c);
+          if (fabs(value - expected) > tol)
+          {
+            cerr << name << " on " << image->GetScalarTypeAsString()
+                 << " gives " << value << " at (" << ijk[0] << ", "
+                 << ijk[1] << ", " << ijk[2] << ") component " << c
+                 << ", expected " << expected << "\n";
+            return 1;
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// The gaussian before its normalization, evaluated as the filter does.
+std::vector<double> GaussianExp(double sigma, int radius)
+{
+  std::vector<double> kernel(2*radius + 1);
+  for (int i = -radius; i <= radius; i++)
+  {
+    kernel[i + radius] =
+      exp(- (static_cast<double>(i*i)) / (sigma * sigma * 2.0));
+  }
+  return kernel;
+}
+
+std::vector<double> Gaussian(double sigma, int radius)
+{
+  std::vector<double> kernel = GaussianExp(sigma, radius);
+  double sum = 0.0;
+  for (size_t i = 0; i < kernel.size(); i++)
+  {
+    sum += kernel[i];
+  }
+  for (size_t i = 0; i < kernel.size(); i++)
+  {
+    kernel[i] /= sum;
+  }
+  return kernel;
+}
+
+// Smooth along Z, then Y, then X, and truncate the result of each pass as
+// the filter did when it stored each pass in an image of the input type.
+double SmoothByPasses(vtkImageData *image, int c, const int ijk[3],
+                      const std::vector<double> kernels[3], int axis)
+{
+  std::vector<double> w = ClipKernel(kernels[axis], ijk[axis], axis, false);
+  double sum = 0.0;
+  for (size_t k = 0; k < w.size(); k++)
+  {
+    if (w[k] == 0.0)
+    {
+      continue;
+    }
+    int pos[3] = { ijk[0], ijk[1], ijk[2] };
+    pos[axis] = ImageExtent[2*axis] + static_cast<int>(k);
+    double value = (axis == 2 ?
+      image->GetScalarComponentAsDouble(pos[0], pos[1], pos[2], c) :
+      SmoothByPasses(image, c, pos, kernels, axis + 1));
+    sum += w[k]*value;
+  }
+  return floor(sum);
+}
+
+int CheckPasses(vtkImageData *image, vtkImageData *output,
+                const std::vector<double> kernels[3])
+{
+  int ijk[3];
+  for (ijk[2] = UpdateExtent[4]; ijk[2] <= UpdateExtent[5]; ijk[2]++)
+  {
+    for (ijk[1] = UpdateExtent[2]; ijk[1] <= UpdateExtent[3]; ijk[1]++)
+    {
+      for (ijk[0] = UpdateExtent[0]; ijk[0] <= UpdateExtent[1]; ijk[0]++)
+      {
+        for (int c = 0; c < image->GetNumberOfScalarComponents(); c++)
+        {
+          double expected = SmoothByPasses(image, c, ijk, kernels, 0);
+          double value = output->GetScalarComponentAsDouble(
+            ijk[0], ijk[1], ijk[2], c);
+          if (value != expected)
+          {
+            cerr << "vtkImageGaussianSmooth on "
+                 << image->GetScalarTypeAsString() << " gives " << value
+                 << " at (" << ijk[0] << ", " << ijk[1] << ", " << ijk[2]
+                 << ") component " << c << ", expected " << expected
+                 << " from separate passes\n";
+            return 1;
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int TestGaussian(vtkImageData *image, bool smp, bool keepPrecision)
+{
+  const double sigmas[3] = { 1.5, 1.0, 2.0 };
+  const double factors[3] = { 2.0, 1.5, 2.5 };
+
+  vtkSmartPointer<vtkImageGaussianSmooth> smooth =
+    vtkSmartPointer<vtkImageGaussianSmooth>::New();
+  smooth->SetInputData(image);
+  smooth->SetStandardDeviations(sigmas[0], sigmas[1], sigmas[2]);
+  smooth->SetRadiusFactors(factors[0], factors[1], factors[2]);
+  smooth->SetKeepIntermediatePrecision(keepPrecision);
+  smooth->SetEnableSMP(smp);
+  smooth->UpdateExtent(const_cast<int *>(UpdateExtent));
+
+  std::vector<double> kernels[1][3];
+  for (int j = 0; j < 3; j++)
+  {
+    kernels[0][j] = GaussianExp(sigmas[j],
+                                static_cast<int>(sigmas[j]*factors[j]));
+  }
+
+  // by default, integer results are truncated after each pass
+  bool isFloat = (image->GetScalarType() == VTK_FLOAT ||
+                  image->GetScalarType() == VTK_DOUBLE);
+  if (!isFloat && !keepPrecision)
+  {
+    return CheckPasses(image, smooth->GetOutput(), kernels[0]);
+  }
+
+  // otherwise only the output is truncated, so allow for the rounding error
+  return CheckOutput("vtkImageGaussianSmooth", image, smooth->GetOutput(),
+                     image->GetNumberOfScalarComponents(), kernels, 1,
+                     false, (isFloat ? 1e-4 : 1.0), !isFloat);
+}
+
+int TestRecursiveGaussian(vtkImageData *image)
+{
+  // compare with a convolution that replicates the boundary, like the
+  // recursive filter does, with a kernel that is long enough to not be
+  // cut off
+  const double sigmas[3] = { 2.0, 1.5, 3.0 };
+  vtkSmartPointer<vtkImageSeparableConvolution> smooth =
+    vtkSmartPointer<vtkImageSeparableConvolution>::New();
+  smooth->SetInputData(image);
+  for (int j = 0; j < 3; j++)
+  {
+    std::vector<double> kernel = Gaussian(sigmas[j], 40);
+    vtkSmartPointer<vtkFloatArray> array =
+      vtkSmartPointer<vtkFloatArray>::New();
+    for (size_t i = 0; i < kernel.size(); i++)
+    {
+      array->InsertNextValue(static_cast<float>(kernel[i]));
+    }
+    if (j == 0) { smooth->SetXKernel(array); }
+    if (j == 1) { smooth->SetYKernel(array); }
+    if (j == 2) { smooth->SetZKernel(array); }
+  }
+  smooth->Update();
+
+  vtkSmartPointer<vtkImageGaussianSmooth> recursive =
+    vtkSmartPointer<vtkImageGaussianSmooth>::New();
+  recursive->SetInputData(image);
+  recursive->SetStandardDeviations(2.0, 1.5, 3.0);
+  recursive->SetAlgorithmToRecursive();
+  recursive->Update();
+
+  // the result must not depend on the requested extent
+  vtkSmartPointer<vtkImageGaussianSmooth> partial =
+    vtkSmartPointer<vtkImageGaussianSmooth>::New();
+  partial->SetInputData(image);
+  partial->SetStandardDeviations(2.0, 1.5, 3.0);
+  partial->SetAlgorithmToRecursive();
+  partial->UpdateExtent(const_cast<int *>(UpdateExtent));
+
+  int ijk[3];
+  for (ijk[2] = UpdateExtent[4]; ijk[2] <= UpdateExtent[5]; ijk[2]++)
+  {
+    for (ijk[1] = UpdateExtent[2]; ijk[1] <= UpdateExtent[3]; ijk[1]++)
+    {
+      for (ijk[0] = UpdateExtent[0]; ijk[0] <= UpdateExtent[1]; ijk[0]++)
+      {
+        double expected = smooth->GetOutput()->GetScalarComponentAsDouble(
+          ijk[0], ijk[1], ijk[2], 0);
+        double value = recursive->GetOutput()->GetScalarComponentAsDouble(
+          ijk[0], ijk[1], ijk[2], 0);
+        double value2 = partial->GetOutput()->GetScalarComponentAsDouble(
+          ijk[0], ijk[1], ijk[2], 0);
+        // the recursive filter is only an approximation of the gaussian
+        if (fabs(value - expected) > 1.0 || fabs(value - value2) > 1e-9)
+        {
+          cerr << "Recursive vtkImageGaussianSmooth gives " << value
+               << " (partial " << value2 << ") at (" << ijk[0] << ", "
+               << ijk[1] << ", " << ijk[2] << "), expected " << expected
+               << "\n";
+          return 1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int TestSeparableConvolution(vtkImageData *image, bool smp)
+{
+  // an asymmetric kernel and a kernel that is larger than the image
+  const float xk[5] = { 0.5f, -1.0f, 0.25f, 2.0f, 1.0f };
+  std::vector<double> kernels[1][3];
+  vtkSmartPointer<vtkFloatArray> arrays[3];
+  for (int j = 0; j < 3; j++)
+  {
+    arrays[j] = vtkSmartPointer<vtkFloatArray>::New();
+  }
+  for (int i = 0; i < 5; i++)
+  {
+    arrays[0]->InsertNextValue(xk[i]);
+    kernels[0][0].insert(kernels[0][0].begin(), xk[i]);
+  }
+  for (int i = 0; i < 41; i++)
+  {
+    double v = 1.0/(1.0 + (i - 20)*(i - 20));
+    arrays[1]->InsertNextValue(static_cast<float>(v));
+    kernels[0][1].push_back(static_cast<float>(v));
+  }
+  kernels[0][2].push_back(1.0);
+
+  vtkSmartPointer<vtkImageSeparableConvolution> convolve =
+    vtkSmartPointer<vtkImageSeparableConvolution>::New();
+  convolve->SetInputData(image);
+  convolve->SetXKernel(arrays[0]);
+  convolve->SetYKernel(arrays[1]);
+  convolve->SetEnableSMP(smp);
+  convolve->UpdateExtent(const_cast<int *>(UpdateExtent));
+
+  return CheckOutput("vtkImageSeparableConvolution", image,
+                     convolve->GetOutput(), 1, kernels, 1, true, 1e-3, false);
+}
+
+int TestGradient(vtkImageData *image, int dimensionality, bool smp)
+{
+  vtkSmartPointer<vtkImageGradient> gradient =
+    vtkSmartPointer<vtkImageGradient>::New();
+  gradient->SetInputData(image);
+  gradient->SetDimensionality(dimensionality);
+  gradient->SetEnableSMP(smp);
+  gradient->UpdateExtent(const_cast<int *>(UpdateExtent));
+
+  double spacing[3];
+  image->GetSpacing(spacing);
+  std::vector<double> kernels[3][3];
+  for (int c = 0; c < 3; c++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      if (j == c)
+      {
+        kernels[c][j].push_back(-0.5/spacing[j]);
+        kernels[c][j].push_back(0.0);
+        kernels[c][j].push_back(0.5/spacing[j]);
+      }
+      else
+      {
+        kernels[c][j].push_back(1.0);
+      }
+    }
+  }
+
+  int rval = 0;
+  vtkSmartPointer<vtkImageData> component =
+    vtkSmartPointer<vtkImageData>::New();
+  for (int c = 0; c < dimensionality && !rval; c++)
+  {
+    component->SetExtent(const_cast<int *>(UpdateExtent));
+    component->AllocateScalars(VTK_DOUBLE, 1);
+    int ijk[3];
+    for (ijk[2] = UpdateExtent[4]; ijk[2] <= UpdateExtent[5]; ijk[2]++)
+    {
+      for (ijk[1] = UpdateExtent[2]; ijk[1] <= UpdateExtent[3]; ijk[1]++)
+      {
+        for (ijk[0] = UpdateExtent[0]; ijk[0] <= UpdateExtent[1]; ijk[0]++)
+        {
+          component->SetScalarComponentFromDouble(
+            ijk[0], ijk[1], ijk[2], 0,
+            gradient->GetOutput()->GetScalarComponentAsDouble(
+              ijk[0], ijk[1], ijk[2], c));
+        }
+      }
+    }
+    rval = CheckOutput("vtkImageGradient", image, component, 1,
+                       kernels + c, 1, true, 1e-9, false);
+  }
+  return rval;
+}
+
+int TestSobel(vtkImageData *image, bool smp)
+{
+  vtkSmartPointer<vtkImageSobel3D> sobel =
+    vtkSmartPointer<vtkImageSobel3D>::New();
+  sobel->SetInputData(image);
+  sobel->SetEnableSMP(smp);
+  sobel->UpdateExtent(const_cast<int *>(UpdateExtent));
+
+  // the sobel kernel as the sum of four separable terms, one for the
+  // center, edges and corners, of the neighborhood in the smoothed plane
+  double spacing[3];
+  image->GetSpacing(spacing);
+  const double planeWeights[4] = { 2.0, 1.0, 1.0, 0.586 };
+  const double planeKernels[4][2][3] = {
+    { { 0, 1, 0 }, { 0, 1, 0 } },
+    { { 1, 0, 1 }, { 0, 1, 0 } },
+    { { 0, 1, 0 }, { 1, 0, 1 } },
+    { { 1, 0, 1 }, { 1, 0, 1 } } };
+
+  int rval = 0;
+  vtkSmartPointer<vtkImageData> component =
+    vtkSmartPointer<vtkImageData>::New();
+  for (int c = 0; c < 3 && !rval; c++)
+  {
+    std::vector<double> kernels[4][3];
+    for (int t = 0; t < 4; t++)
+    {
+      int k = 0;
+      for (int j = 0; j < 3; j++)
+      {
+        if (j == c)
+        {
+          double d = 0.060445/spacing[j]*planeWeights[t];
+          kernels[t][j].push_back(-d);
+          kernels[t][j].push_back(0.0);
+          kernels[t][j].push_back(d);
+        }
+        else
+        {
+          kernels[t][j].assign(planeKernels[t][k], planeKernels[t][k] + 3);
+          k++;
+        }
+      }
+    }
+
+    component->SetExtent(const_cast<int *>(UpdateExtent));
+    component->AllocateScalars(VTK_DOUBLE, 1);
+    int ijk[3];
+    for (ijk[2] = UpdateExtent[4]; ijk[2] <= UpdateExtent[5]; ijk[2]++)
+    {
+      for (ijk[1] = UpdateExtent[2]; ijk[1] <= UpdateExtent[3]; ijk[1]++)
+      {
+        for (ijk[0] = UpdateExtent[0]; ijk[0] <= UpdateExtent[1]; ijk[0]++)
+        {
+          component->SetScalarComponentFromDouble(
+            ijk[0], ijk[1], ijk[2], 0,
+            sobel->GetOutput()->GetScalarComponentAsDouble(
+              ijk[0], ijk[1], ijk[2], c));
+        }
+      }
+    }
+    rval = CheckOutput("vtkImageSobel3D", image, component, 1,
+                       kernels, 4, true, 1e-9, false);
+  }
+  return rval;
+}
+
+} // end anonymous namespace
+
+int TestImageSeparableFilters(int, char *[])
+{
+  int rval = 0;
+
+  const int scalarTypes[3] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT };
+
+  for (int t = 0; t < 3; t++)
+  {
+    vtkSmartPointer<vtkImageData> image = MakeImage(scalarTypes[t], 1);
+    vtkSmartPointer<vtkImageData> color = MakeImage(scalarTypes[t], 3);
+    for (int smp = 0; smp < 2; smp++)
+    {
+      rval |= TestGaussian(image, smp != 0, false);
+      rval |= TestGaussian(image, smp != 0, true);
+      rval |= TestGaussian(color, smp != 0, false);
+      rval |= TestSeparableConvolution(image, smp != 0);
+      rval |= TestGradient(image, 2 + smp, smp != 0);
+      rval |= TestSobel(image, smp != 0);
+    }
+  }
+
+  vtkSmartPointer<vtkImageData> image = MakeImage(VTK_DOUBLE, 1);
+  rval |= TestRecursiveGaussian(image);
+
+  return rval;
+}
@@ -0,0 +1,220 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataToImageStencilSlices.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check the slice-by-slice scan conversion of vtkPolyDataToImageStencil
+// for a surface (as polygons and as strips) and for contours, and check
+// that updating part of the extent gives the same slices as a full update.
+
+#include "vtkSmartPointer.h"
+#include "vtkCellArray.h"
+#include "vtkImageStencilData.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataToImageStencil.h"
+#include "vtkSphereSource.h"
+#include "vtkStripper.h"
+
+#include <cmath>
+
+namespace {
+
+const double Center[3] = { 0.3, 0.2, 0.1 };
+const double Radius = 10.0;
+const int Resolution = 48;
+
+vtkSmartPointer<vtkPolyDataToImageStencil> MakeStencil(
+  vtkPolyData *input, double zspacing)
+{
+  vtkSmartPointer<vtkPolyDataToImageStencil> stencil =
+    vtkSmartPointer<vtkPolyDataToImageStencil>::New();
+  stencil->SetInputData(input);
+  stencil->SetOutputSpacing(0.5, 0.5, zspacing);
+  stencil->SetOutputOrigin(-12.0, -12.0, -12.0*fabs(zspacing)/zspacing);
+  stencil->SetOutputWholeExtent(0, 47, 0, 47, 0, 23);
+  return stencil;
+}
+
+// the stencil must contain the inscribed sphere, and must be within the
+// circumscribed sphere, for the voxels that aren't too close to either
+int CheckSphere(vtkImageStencilData *data, const char *name)
+{
+  double rmin = Radius*cos(vtkMath::Pi()/Resolution) - 0.01;
+  double rmax = Radius + 0.01;
+  double spacing[3];
+  double origin[3];
+  int extent[6];
+  data->GetSpacing(spacing);
+  data->GetOrigin(origin);
+  data->GetExtent(extent);
+
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    for (int j = extent[2]; j <= extent[3]; j++)
+    {
+      for (int i = extent[0]; i <= extent[1]; i++)
+      {
+        double x = origin[0] + i*spacing[0] - Center[0];
+        double y = origin[1] + j*spacing[1] - Center[1];
+        double z = origin[2] + k*spacing[2] - Center[2];
+        double r = sqrt(x*x + y*y + z*z);
+        bool inside = (data->IsInside(i, j, k) != 0);
+        if ((r < rmin && !inside) || (r > rmax && inside))
+        {
+          cerr << name << ": voxel (" << i << ", " << j << ", " << k
+               << ") at radius " << r << " is "
+               << (inside ? "inside" : "outside") << "\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+// compare two stencils over the extent of the second
+int CompareStencils(vtkImageStencilData *data1, vtkImageStencilData *data2,
+                    const char *name)
+{
+  int extent[6];
+  data2->GetExtent(extent);
+
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    for (int j = extent[2]; j <= extent[3]; j++)
+    {
+      for (int i = extent[0]; i <= extent[1]; i++)
+      {
+        if (data1->IsInside(i, j, k) != data2->IsInside(i, j, k))
+        {
+          cerr << name << ": stencils differ at (" << i << ", " << j
+               << ", " << k << ")\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+// make circular contours of the sphere at the slice positions, plus a
+// contour that crosses several slices and must be ignored
+vtkSmartPointer<vtkPolyData> MakeContours(double zspacing)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+
+  for (int k = 0; k < 24; k++)
+  {
+    double z = -12.0 + k*zspacing;
+    double dz = z - Center[2];
+    if (fabs(dz) >= Radius)
+    {
+      continue;
+    }
+    double r = sqrt(Radius*Radius - dz*dz);
+    vtkIdType firstId = points->GetNumberOfPoints();
+    lines->InsertNextCell(Resolution + 1);
+    for (int i = 0; i < Resolution; i++)
+    {
+      double theta = 2.0*vtkMath::Pi()*i/Resolution;
+      lines->InsertCellPoint(points->InsertNextPoint(
+        Center[0] + r*cos(theta), Center[1] + r*sin(theta), z));
+    }
+    lines->InsertCellPoint(firstId);
+  }
+
+  // a large tilted square that crosses several slices
+  double z = -12.0 + 10.0*zspacing;
+  double dz = 3.0*zspacing;
+  vtkIdType firstId = points->GetNumberOfPoints();
+  lines->InsertNextCell(5);
+  lines->InsertCellPoint(points->InsertNextPoint(-11.0, -11.0, z));
+  lines->InsertCellPoint(points->InsertNextPoint(11.0, -11.0, z));
+  lines->InsertCellPoint(points->InsertNextPoint(11.0, 11.0, z + dz));
+  lines->InsertCellPoint(points->InsertNextPoint(-11.0, 11.0, z + dz));
+  lines->InsertCellPoint(firstId);
+
+  vtkSmartPointer<vtkPolyData> contours = vtkSmartPointer<vtkPolyData>::New();
+  contours->SetPoints(points);
+  contours->SetLines(lines);
+  return contours;
+}
+
+} // end anonymous namespace
+
+int TestPolyDataToImageStencilSlices(int, char *[])
+{
+  int rval = 0;
+
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetCenter(Center[0], Center[1], Center[2]);
+  sphere->SetRadius(Radius);
+  sphere->SetThetaResolution(Resolution);
+  sphere->SetPhiResolution(Resolution);
+  sphere->Update();
+
+  vtkSmartPointer<vtkStripper> stripper =
+    vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputConnection(sphere->GetOutputPort());
+  stripper->Update();
+
+  // the surface as polygons, as strips, and with reversed slice order
+  vtkSmartPointer<vtkPolyDataToImageStencil> polyStencil =
+    MakeStencil(sphere->GetOutput(), 1.0);
+  polyStencil->Update();
+  rval |= CheckSphere(polyStencil->GetOutput(), "Polys");
+
+  vtkSmartPointer<vtkPolyDataToImageStencil> stripStencil =
+    MakeStencil(stripper->GetOutput(), 1.0);
+  stripStencil->Update();
+  rval |= CompareStencils(
+    polyStencil->GetOutput(), stripStencil->GetOutput(), "Strips");
+
+  vtkSmartPointer<vtkPolyDataToImageStencil> reverseStencil =
+    MakeStencil(sphere->GetOutput(), -1.0);
+  reverseStencil->Update();
+  rval |= CheckSphere(reverseStencil->GetOutput(), "Reversed");
+
+  // the contours are cross sections of the sphere, so the same check applies
+  vtkSmartPointer<vtkPolyDataToImageStencil> contourStencil =
+    MakeStencil(MakeContours(1.0), 1.0);
+  contourStencil->Update();
+  rval |= CheckSphere(contourStencil->GetOutput(), "Contours");
+
+  // update a few slices, including slices outside the data
+  const int updateExtents[3][6] = {
+    { 0, 47, 0, 47, 7, 9 },
+    { 5, 40, 10, 30, 11, 11 },
+    { 0, 47, 0, 47, 21, 23 } };
+  for (int i = 0; i < 3; i++)
+  {
+    vtkSmartPointer<vtkPolyDataToImageStencil> partStencil =
+      MakeStencil(sphere->GetOutput(), 1.0);
+    partStencil->UpdateExtent(updateExtents[i]);
+    rval |= CompareStencils(
+      polyStencil->GetOutput(), partStencil->GetOutput(), "Partial");
+
+    partStencil->SetInputData(MakeContours(1.0));
+    partStencil->UpdateExtent(updateExtents[i]);
+    rval |= CompareStencils(
+      contourStencil->GetOutput(), partStencil->GetOutput(),
+      "Partial contours");
+  }
+
+  return rval;
+}
@@ -36,6 +36,25 @@ struct vtkInterpolateNOP
     F *outPtr, int n);
 };
 
+// interpolate a span one point at a time
+template<class F>
+void vtkInterpolateSpanByPoint(
+  void (*interpolate)(vtkInterpolationInfo *, const F [3], F *),
+  vtkInterpolationInfo *info, const F point[3], const F delta[3],
+  F *outPtr, int n)
+{
+  int numscalars = info->NumberOfComponents;
+  for (int i = 0; i < n; i++)
+  {
+    F p[3];
+    p[0] = point[0] + i*delta[0];
+    p[1] = point[1] + i*delta[1];
+    p[2] = point[2] + i*delta[2];
+    interpolate(info, p, outPtr);
+    outPtr += numscalars;
+  }
+}
+
 template<class F>
 void vtkInterpolateNOP<F>::InterpolationFunc(
   vtkInterpolationInfo *, const F [3], F *)
@@ -87,6 +106,8 @@ vtkAbstractImageInterpolator::vtkAbstractImageInterpolator()
     &(vtkInterpolateNOP<double>::RowInterpolationFunc);
   this->RowInterpolationFuncFloat =
     &(vtkInterpolateNOP<float>::RowInterpolationFunc);
+  this->SpanInterpolationFuncDouble = NULL;
+  this->SpanInterpolationFuncFloat = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -294,6 +315,8 @@ void vtkAbstractImageInterpolator::Update()
       &(vtkInterpolateNOP<double>::RowInterpolationFunc);
     this->RowInterpolationFuncFloat =
       &(vtkInterpolateNOP<float>::RowInterpolationFunc);
+    this->SpanInterpolationFuncDouble = NULL;
+    this->SpanInterpolationFuncFloat = NULL;
 
     return;
   }
@@ -370,6 +393,42 @@ void vtkAbstractImageInterpolator::Update()
   this->GetInterpolationFunc(&this->InterpolationFuncFloat);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncDouble);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncFloat);
+  this->SpanInterpolationFuncDouble = NULL;
+  this->SpanInterpolationFuncFloat = NULL;
+  this->GetSpanInterpolationFunc(&this->SpanInterpolationFuncDouble);
+  this->GetSpanInterpolationFunc(&this->SpanInterpolationFuncFloat);
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::InterpolateSpanIJK(
+  const double point[3], const double delta[3], double *value, int n)
+{
+  if (this->SpanInterpolationFuncDouble)
+  {
+    this->SpanInterpolationFuncDouble(
+      this->InterpolationInfo, point, delta, value, n);
+  }
+  else
+  {
+    vtkInterpolateSpanByPoint(this->InterpolationFuncDouble,
+      this->InterpolationInfo, point, delta, value, n);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::InterpolateSpanIJK(
+  const float point[3], const float delta[3], float *value, int n)
+{
+  if (this->SpanInterpolationFuncFloat)
+  {
+    this->SpanInterpolationFuncFloat(
+      this->InterpolationInfo, point, delta, value, n);
+  }
+  else
+  {
+    vtkInterpolateSpanByPoint(this->InterpolationFuncFloat,
+      this->InterpolationInfo, point, delta, value, n);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -454,6 +513,20 @@ void vtkAbstractImageInterpolator::GetRowInterpolationFunc(
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetSpanInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const double [3], const double [3],
+            double *, int))
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetSpanInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const float [3], const float [3],
+            float *, int))
+{
+}
+
 //----------------------------------------------------------------------------
 void vtkAbstractImageInterpolator::PrecomputeWeightsForExtent(
   const double [16], const int [6], int [6], vtkInterpolationWeights *&)
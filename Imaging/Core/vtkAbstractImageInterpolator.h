@@ -145,6 +145,20 @@ public:
   void InterpolateIJK(const float point[3], float *value);
   //@}
 
+  //@{
+  /**
+   * Interpolate n samples along a line in structured coords, at the points
+   * point + i*delta for i = 0 to n - 1.  The result is the same as calling
+   * InterpolateIJK for each point, but interpolators that provide a span
+   * function can compute the coefficients for all of the samples together.
+   * All of the points must pass CheckBoundsIJK.
+   */
+  void InterpolateSpanIJK(
+    const double point[3], const double delta[3], double *value, int n);
+  void InterpolateSpanIJK(
+    const float point[3], const float delta[3], float *value, int n);
+  //@}
+
   //@{
   /**
    * Check an x,y,z point to see if it is within the bounds for the
@@ -298,6 +312,22 @@ protected:
       vtkInterpolationWeights *, int, int, int, float *, int));
   //@}
 
+  //@{
+  /**
+   * Get the span interpolation functions.  The default implementation
+   * sets them to NULL, and InterpolateSpanIJK will call the interpolation
+   * function for each point instead.
+   */
+  virtual void GetSpanInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double [3], const double [3],
+      double *, int));
+  virtual void GetSpanInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float [3], const float [3],
+      float *, int));
+  //@}
+
   vtkDataArray *Scalars;
   double StructuredBoundsDouble[6];
   float StructuredBoundsFloat[6];
@@ -325,6 +355,13 @@ protected:
     vtkInterpolationWeights *weights, int idX, int idY, int idZ,
     float *outPtr, int n);
 
+  void (*SpanInterpolationFuncDouble)(
+    vtkInterpolationInfo *info, const double point[3],
+    const double delta[3], double *outPtr, int n);
+  void (*SpanInterpolationFuncFloat)(
+    vtkInterpolationInfo *info, const float point[3],
+    const float delta[3], float *outPtr, int n);
+
 private:
 
   vtkAbstractImageInterpolator(const vtkAbstractImageInterpolator&) VTK_DELETE_FUNCTION;
@@ -48,6 +48,7 @@ void vtkImageCacheFilter::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "CacheSize: " << this->GetCacheSize() << endl;
+  os << indent << "CacheMemoryLimit: " << this->GetCacheMemoryLimit() << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -73,6 +74,100 @@ int vtkImageCacheFilter::GetCacheSize()
   return 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkImageCacheFilter::SetCacheMemoryLimit(unsigned long limit)
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    csddp->SetCacheMemoryLimit(limit);
+  }
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkImageCacheFilter::GetCacheMemoryLimit()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetCacheMemoryLimit();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkImageCacheFilter::GetCacheMemorySize()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetCacheMemorySize();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageCacheFilter::GetNumberOfCacheHits()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetNumberOfCacheHits();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageCacheFilter::GetNumberOfPartialCacheHits()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetNumberOfPartialCacheHits();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageCacheFilter::GetNumberOfCacheMisses()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetNumberOfCacheMisses();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageCacheFilter::GetNumberOfCacheEvictions()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    return csddp->GetNumberOfCacheEvictions();
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageCacheFilter::ResetCacheStatistics()
+{
+  vtkCachedStreamingDemandDrivenPipeline *csddp =
+    vtkCachedStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (csddp)
+  {
+    csddp->ResetCacheStatistics();
+  }
+}
+
 //----------------------------------------------------------------------------
 // This method simply copies by reference the input data to the output.
 void vtkImageCacheFilter::ExecuteData(vtkDataObject *)
@@ -20,7 +20,12 @@
  * vtkImageCacheFilter keep a number of vtkImageDataObjects from previous
  * updates to satisfy future updates without needing to update the input.  It
  * does not change the data at all.  It just makes the pipeline more
- * efficient at the expense of using extra memory.
+ * efficient at the expense of using extra memory.  A request can be
+ * satisfied by one cached image that contains the requested extent, or by
+ * several cached images that cover it together.  The least recently used
+ * images are discarded when the cache exceeds its size or memory limit.
+ * @sa
+ * vtkCachedStreamingDemandDrivenPipeline
 */
 
 #ifndef vtkImageCacheFilter_h
@@ -47,6 +52,34 @@ public:
   int GetCacheSize();
   //@}
 
+  //@{
+  /**
+   * The maximum amount of memory, in kibibytes (1024 bytes), that can be
+   * used by the cached images.  The default is zero, for no limit.
+   */
+  void SetCacheMemoryLimit(unsigned long limit);
+  unsigned long GetCacheMemoryLimit();
+  //@}
+
+  /**
+   * Get the memory, in kibibytes (1024 bytes), used by the cached images.
+   */
+  unsigned long GetCacheMemorySize();
+
+  //@{
+  /**
+   * Get the number of updates that were satisfied by one cached image
+   * (hits), that were assembled from several cached images (partial hits),
+   * and that required the input to be updated (misses), and the number of
+   * cached images that were discarded to stay within the limits.
+   */
+  vtkIdType GetNumberOfCacheHits();
+  vtkIdType GetNumberOfPartialCacheHits();
+  vtkIdType GetNumberOfCacheMisses();
+  vtkIdType GetNumberOfCacheEvictions();
+  void ResetCacheStatistics();
+  //@}
+
 protected:
   vtkImageCacheFilter();
   ~vtkImageCacheFilter() VTK_OVERRIDE;
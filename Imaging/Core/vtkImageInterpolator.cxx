@@ -510,9 +510,526 @@ void vtkImageInterpolatorGetInterpolationFunc(
   }
 }
 
+//----------------------------------------------------------------------------
+// Interpolation of spans of samples along a line
+
+// The span functions work on blocks of samples.  For each block, the
+// indices and weights along each axis are computed first, with loops that
+// the compiler can vectorize, and then a second loop gathers the input
+// values.  The indices are relative to the extent.
+const int vtkImageNLCSpanBlockSize = 64;
+
+//----------------------------------------------------------------------------
+// Within a block, the positions are computed relative to the start of the
+// block with float arithmetic.  The block size is limited so that these
+// relative positions are less than 256, which keeps the precision of the
+// fractional offsets at least as good as that of vtkInterpolationMath::Floor
+// (which is 2^-16).
+template<class F>
+int vtkImageNLCSpanBlock(const F delta[3])
+{
+  F dmax = 0;
+  for (int j = 0; j < 3; j++)
+  {
+    F d = (delta[j] >= 0 ? delta[j] : -delta[j]);
+    dmax = (d > dmax ? d : dmax);
+  }
+  int blockSize = vtkImageNLCSpanBlockSize;
+  if (dmax*blockSize > 256)
+  {
+    blockSize = static_cast<int>(256/dmax);
+    blockSize = (blockSize > 1 ? blockSize : 1);
+  }
+  return blockSize;
+}
+
+//----------------------------------------------------------------------------
+// Apply the border mode to a block of indices.
+inline void vtkImageNLCSpanBorder(
+  int border, int minExt, int maxExt, int *idx, int m)
+{
+  switch (border)
+  {
+    case VTK_IMAGE_BORDER_REPEAT:
+      for (int i = 0; i < m; i++)
+      {
+        idx[i] = vtkInterpolationMath::Wrap(idx[i], minExt, maxExt);
+      }
+      break;
+
+    case VTK_IMAGE_BORDER_MIRROR:
+      for (int i = 0; i < m; i++)
+      {
+        idx[i] = vtkInterpolationMath::Mirror(idx[i], minExt, maxExt);
+      }
+      break;
+
+    default:
+      for (int i = 0; i < m; i++)
+      {
+        idx[i] = vtkInterpolationMath::Clamp(idx[i], minExt, maxExt);
+      }
+      break;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Compute the kernel indices and weights along one axis for a block of
+// samples at positions p + i*d, for i in [i0, i0 + m).  The kernel size is
+// 1 for nearest-neighbor, 2 for linear, and 4 for cubic interpolation, and
+// is returned.
+template<class F>
+int vtkImageNLCSpanAxis(
+  int interpMode, int border, int minExt, int maxExt,
+  F p, F d, int i0, int m,
+  int idx[4][vtkImageNLCSpanBlockSize], F w[4][vtkImageNLCSpanBlockSize])
+{
+  int kernelSize = 1;
+
+  if (interpMode == VTK_NEAREST_INTERPOLATION)
+  {
+    for (int i = 0; i < m; i++)
+    {
+      idx[0][i] = vtkInterpolationMath::Round(p + (i0 + i)*d);
+    }
+  }
+  else if (interpMode == VTK_CUBIC_INTERPOLATION && minExt == maxExt)
+  {
+    // a single slice, so cubic interpolation needs a single sample
+    for (int i = 0; i < m; i++)
+    {
+      idx[0][i] = minExt;
+      w[0][i] = 1;
+    }
+  }
+  else
+  {
+    // the floor is done with an int conversion, which can be vectorized
+    // (the positions are small and relative to the start of the block)
+    float start;
+    int startId = vtkInterpolationMath::Floor(p + i0*d, start);
+    float step = static_cast<float>(d);
+    kernelSize = (interpMode == VTK_LINEAR_INTERPOLATION ? 2 : 4);
+    for (int i = 0; i < m; i++)
+    {
+      float x = start + i*step;
+      int id0 = static_cast<int>(x);
+      id0 -= (x < id0);
+      F f = x - id0;
+      id0 += startId;
+      if (kernelSize == 2)
+      {
+        idx[0][i] = id0;
+        idx[1][i] = id0 + (f != 0);
+        w[0][i] = 1 - f;
+        w[1][i] = f;
+      }
+      else
+      {
+        idx[0][i] = id0 - 1;
+        idx[1][i] = id0;
+        idx[2][i] = id0 + 1;
+        idx[3][i] = id0 + 2;
+        F g[4];
+        vtkTricubicInterpWeights(g, f);
+        w[0][i] = g[0];
+        w[1][i] = g[1];
+        w[2][i] = g[2];
+        w[3][i] = g[3];
+      }
+    }
+  }
+
+  for (int l = 0; l < kernelSize; l++)
+  {
+    vtkImageNLCSpanBorder(border, minExt, maxExt, idx[l], m);
+  }
+
+  return kernelSize;
+}
+
+//----------------------------------------------------------------------------
+template<class F, class T>
+struct vtkImageNLCSpanInterpolate
+{
+  static void Nearest(
+    vtkInterpolationInfo *info, const F point[3], const F delta[3],
+    F *outPtr, int n);
+
+  static void Trilinear(
+    vtkInterpolationInfo *info, const F point[3], const F delta[3],
+    F *outPtr, int n);
+
+  static void Tricubic(
+    vtkInterpolationInfo *info, const F point[3], const F delta[3],
+    F *outPtr, int n);
+};
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCSpanInterpolate<F, T>::Nearest(
+  vtkInterpolationInfo *info, const F point[3], const F delta[3],
+  F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  int idx[3][4][vtkImageNLCSpanBlockSize];
+  F w[3][4][vtkImageNLCSpanBlockSize];
+
+  int blockSize = vtkImageNLCSpanBlock(delta);
+  for (int i0 = 0; i0 < n; i0 += blockSize)
+  {
+    int m = n - i0;
+    m = (m < blockSize ? m : blockSize);
+    for (int j = 0; j < 3; j++)
+    {
+      vtkImageNLCSpanAxis(
+        VTK_NEAREST_INTERPOLATION, info->BorderMode, inExt[2*j],
+        inExt[2*j+1], point[j], delta[j], i0, m, idx[j], w[j]);
+    }
+
+    for (int i = 0; i < m; i++)
+    {
+      const T *tmpPtr = inPtr + (idx[0][0][i]*inInc[0] +
+                                 idx[1][0][i]*inInc[1] +
+                                 idx[2][0][i]*inInc[2]);
+      int c = numscalars;
+      do
+      {
+        *outPtr++ = *tmpPtr++;
+      }
+      while (--c);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCSpanInterpolate<F, T>::Trilinear(
+  vtkInterpolationInfo *info, const F point[3], const F delta[3],
+  F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  int idx[3][4][vtkImageNLCSpanBlockSize];
+  F w[3][4][vtkImageNLCSpanBlockSize];
+
+  int blockSize = vtkImageNLCSpanBlock(delta);
+  for (int i0 = 0; i0 < n; i0 += blockSize)
+  {
+    int m = n - i0;
+    m = (m < blockSize ? m : blockSize);
+    for (int j = 0; j < 3; j++)
+    {
+      vtkImageNLCSpanAxis(
+        VTK_LINEAR_INTERPOLATION, info->BorderMode, inExt[2*j],
+        inExt[2*j+1], point[j], delta[j], i0, m, idx[j], w[j]);
+    }
+
+    // the same arithmetic as vtkImageNLCInterpolate::Trilinear
+    for (int i = 0; i < m; i++)
+    {
+      vtkIdType factY0 = idx[1][0][i]*inInc[1];
+      vtkIdType factY1 = idx[1][1][i]*inInc[1];
+      vtkIdType factZ0 = idx[2][0][i]*inInc[2];
+      vtkIdType factZ1 = idx[2][1][i]*inInc[2];
+
+      vtkIdType i00 = factY0 + factZ0;
+      vtkIdType i01 = factY0 + factZ1;
+      vtkIdType i10 = factY1 + factZ0;
+      vtkIdType i11 = factY1 + factZ1;
+
+      F rx = w[0][0][i];
+      F fx = w[0][1][i];
+      F ry = w[1][0][i];
+      F fy = w[1][1][i];
+      F rz = w[2][0][i];
+      F fz = w[2][1][i];
+
+      F ryrz = ry*rz;
+      F fyrz = fy*rz;
+      F ryfz = ry*fz;
+      F fyfz = fy*fz;
+
+      const T *inPtr0 = inPtr + idx[0][0][i]*inInc[0];
+      const T *inPtr1 = inPtr + idx[0][1][i]*inInc[0];
+
+      int c = numscalars;
+      do
+      {
+        *outPtr++ = (rx*(ryrz*inPtr0[i00] + ryfz*inPtr0[i01] +
+                         fyrz*inPtr0[i10] + fyfz*inPtr0[i11]) +
+                     fx*(ryrz*inPtr1[i00] + ryfz*inPtr1[i01] +
+                         fyrz*inPtr1[i10] + fyfz*inPtr1[i11]));
+        inPtr0++;
+        inPtr1++;
+      }
+      while (--c);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCSpanInterpolate<F, T>::Tricubic(
+  vtkInterpolationInfo *info, const F point[3], const F delta[3],
+  F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  int idx[3][4][vtkImageNLCSpanBlockSize];
+  F w[3][4][vtkImageNLCSpanBlockSize];
+
+  int blockSize = vtkImageNLCSpanBlock(delta);
+  for (int i0 = 0; i0 < n; i0 += blockSize)
+  {
+    int m = n - i0;
+    m = (m < blockSize ? m : blockSize);
+    int stepX = vtkImageNLCSpanAxis(
+      VTK_CUBIC_INTERPOLATION, info->BorderMode, inExt[0], inExt[1],
+      point[0], delta[0], i0, m, idx[0], w[0]);
+    int stepY = vtkImageNLCSpanAxis(
+      VTK_CUBIC_INTERPOLATION, info->BorderMode, inExt[2], inExt[3],
+      point[1], delta[1], i0, m, idx[1], w[1]);
+    int stepZ = vtkImageNLCSpanAxis(
+      VTK_CUBIC_INTERPOLATION, info->BorderMode, inExt[4], inExt[5],
+      point[2], delta[2], i0, m, idx[2], w[2]);
+
+    // the x loop is unrolled, so pad the x kernel to four samples
+    for (int l = stepX; l < 4; l++)
+    {
+      for (int i = 0; i < m; i++)
+      {
+        idx[0][l][i] = idx[0][0][i];
+        w[0][l][i] = 0;
+      }
+    }
+
+    for (int i = 0; i < m; i++)
+    {
+      F fX0 = w[0][0][i];
+      F fX1 = w[0][1][i];
+      F fX2 = w[0][2][i];
+      F fX3 = w[0][3][i];
+      vtkIdType iX0 = idx[0][0][i]*inInc[0];
+      vtkIdType iX1 = idx[0][1][i]*inInc[0];
+      vtkIdType iX2 = idx[0][2][i]*inInc[0];
+      vtkIdType iX3 = idx[0][3][i]*inInc[0];
+
+      const T *inPtr0 = inPtr;
+      int c = numscalars;
+      do
+      {
+        F val = 0;
+        for (int k = 0; k < stepZ; k++)
+        {
+          F fz = w[2][k][i];
+          vtkIdType iz = idx[2][k][i]*inInc[2];
+          for (int j = 0; j < stepY; j++)
+          {
+            F fzy = fz*w[1][j][i];
+            const T *tmpPtr = inPtr0 + (iz + idx[1][j][i]*inInc[1]);
+            val += fzy*(fX0*tmpPtr[iX0] +
+                        fX1*tmpPtr[iX1] +
+                        fX2*tmpPtr[iX2] +
+                        fX3*tmpPtr[iX3]);
+          }
+        }
+        *outPtr++ = val;
+        inPtr0++;
+      }
+      while (--c);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Get the span interpolation function for the specified data types
+template<class F>
+void vtkImageInterpolatorGetSpanInterpolationFunc(
+  void (**interpolate)(vtkInterpolationInfo *, const F [3], const F [3],
+                       F *, int),
+  int dataType, int interpolationMode)
+{
+  switch (interpolationMode)
+  {
+    case VTK_NEAREST_INTERPOLATION:
+      switch (dataType)
+      {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCSpanInterpolate<F, VTK_TT>::Nearest)
+          );
+        default:
+          *interpolate = 0;
+      }
+      break;
+    case VTK_LINEAR_INTERPOLATION:
+      switch (dataType)
+      {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCSpanInterpolate<F, VTK_TT>::Trilinear)
+          );
+        default:
+          *interpolate = 0;
+      }
+      break;
+    case VTK_CUBIC_INTERPOLATION:
+      switch (dataType)
+      {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCSpanInterpolate<F, VTK_TT>::Tricubic)
+          );
+        default:
+          *interpolate = 0;
+      }
+      break;
+  }
+}
+
 //----------------------------------------------------------------------------
 // Interpolation for precomputed weights
 
+// When the output row is parallel to the input rows, the row can be
+// interpolated by first combining the input rows that surround it into
+// a single row, and then interpolating along that row.  The combination
+// is done with loops over contiguous memory that the compiler can
+// vectorize, and replaces the gathers of the Y and Z neighbors of each
+// sample.  The result is only computed if this will save work, i.e. if
+// the span of the input row is not longer than the kernel footprint of
+// the output row, otherwise the return value is false.
+template <class F, class T>
+bool vtkImageNLCCombineRows(
+  vtkInterpolationWeights *weights, int idX, int idY, int idZ,
+  F *outPtr, int n)
+{
+  F *workPtr = static_cast<F *>(weights->Workspace);
+  if (workPtr == 0)
+  {
+    return false;
+  }
+
+  int stepX = weights->KernelSize[0];
+  int stepY = weights->KernelSize[1];
+  int stepZ = weights->KernelSize[2];
+  const F *fX = static_cast<F *>(weights->Weights[0]) + idX*stepX;
+  const F *fY = static_cast<F *>(weights->Weights[1]) + idY*stepY;
+  const F *fZ = static_cast<F *>(weights->Weights[2]) + idZ*stepZ;
+  const vtkIdType *iX = weights->Positions[0] + idX*stepX;
+  const vtkIdType *iY = weights->Positions[1] + idY*stepY;
+  const vtkIdType *iZ = weights->Positions[2] + idZ*stepZ;
+  int numscalars = weights->NumberOfComponents;
+
+  // find the span of the input row
+  int m = n*stepX;
+  vtkIdType minPos = iX[0];
+  vtkIdType maxPos = iX[0];
+  for (int i = 1; i < m; i++)
+  {
+    minPos = (iX[i] < minPos ? iX[i] : minPos);
+    maxPos = (iX[i] > maxPos ? iX[i] : maxPos);
+  }
+  vtkIdType count = maxPos - minPos + numscalars;
+  if (count > static_cast<vtkIdType>(m)*numscalars)
+  {
+    return false;
+  }
+
+  // combine the input rows
+  const T *inPtr = static_cast<const T *>(weights->Pointer) + minPos;
+  bool first = true;
+  for (int k = 0; k < stepZ; k++)
+  {
+    for (int j = 0; j < stepY; j++)
+    {
+      F f = fZ[k]*fY[j];
+      if (first || f != 0)
+      {
+        const T *rowPtr = inPtr + iZ[k] + iY[j];
+        if (first)
+        {
+          for (vtkIdType i = 0; i < count; i++)
+          {
+            workPtr[i] = f*rowPtr[i];
+          }
+          first = false;
+        }
+        else
+        {
+          for (vtkIdType i = 0; i < count; i++)
+          {
+            workPtr[i] += f*rowPtr[i];
+          }
+        }
+      }
+    }
+  }
+
+  // interpolate along the combined row
+  if (stepX == 1)
+  {
+    for (int i = n; i > 0; --i)
+    {
+      const F *tmpPtr = workPtr + (*iX++ - minPos);
+      int c = numscalars;
+      do
+      {
+        *outPtr++ = *tmpPtr++;
+      }
+      while (--c);
+    }
+  }
+  else if (stepX == 2)
+  {
+    for (int i = n; i > 0; --i)
+    {
+      const F *tmpPtr0 = workPtr + (iX[0] - minPos);
+      const F *tmpPtr1 = workPtr + (iX[1] - minPos);
+      F rx = fX[0];
+      F fx = fX[1];
+      iX += 2;
+      fX += 2;
+      int c = numscalars;
+      do
+      {
+        *outPtr++ = rx*(*tmpPtr0++) + fx*(*tmpPtr1++);
+      }
+      while (--c);
+    }
+  }
+  else
+  {
+    for (int i = n; i > 0; --i)
+    {
+      for (int c = 0; c < numscalars; c++)
+      {
+        F result = 0;
+        for (int l = 0; l < stepX; l++)
+        {
+          result += fX[l]*workPtr[iX[l] - minPos + c];
+        }
+        *outPtr++ = result;
+      }
+      iX += stepX;
+      fX += stepX;
+    }
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
 template <class F, class T>
 struct vtkImageNLCRowInterpolate
 {
@@ -565,6 +1082,11 @@ void vtkImageNLCRowInterpolate<F, T>::Trilinear(
   vtkInterpolationWeights *weights, int idX, int idY, int idZ,
   F *outPtr, int n)
 {
+  if (vtkImageNLCCombineRows<F, T>(weights, idX, idY, idZ, outPtr, n))
+  {
+    return;
+  }
+
   int stepX = weights->KernelSize[0];
   int stepY = weights->KernelSize[1];
   int stepZ = weights->KernelSize[2];
@@ -726,6 +1248,11 @@ void vtkImageNLCRowInterpolate<F, T>::Tricubic(
   vtkInterpolationWeights *weights, int idX, int idY, int idZ,
   F *outPtr, int n)
 {
+  if (vtkImageNLCCombineRows<F, T>(weights, idX, idY, idZ, outPtr, n))
+  {
+    return;
+  }
+
   int stepX = weights->KernelSize[0];
   int stepY = weights->KernelSize[1];
   int stepZ = weights->KernelSize[2];
@@ -1009,12 +1536,11 @@ void vtkImageInterpolatorPrecomputeWeights(
             F gg[4] = { 0, 0, 0, 0 };
             for (int ll = 0; ll < 4; ll++)
             {
-              int rIdx = inId[ll] - minExt;
-              gg[rIdx] += g[ll];
+              gg[inId[ll]] += g[ll];
             }
             for (int jj = 0; jj < step; jj++)
             {
-              positions[step*i + jj] = minExt + jj;
+              positions[step*i + jj] = jj*inInc;
               constants[step*i + jj] = gg[jj];
             }
           }
@@ -1045,6 +1571,15 @@ void vtkImageInterpolatorPrecomputeWeights(
     }
   }
 
+  // the rows can be combined before interpolation if the output rows are
+  // parallel to the input rows (see vtkImageNLCCombineRows)
+  if (interpMode != VTK_NEAREST_INTERPOLATION && newmat[0] != 0)
+  {
+    vtkIdType size = weights->Increments[0];
+    size *= weights->Extent[1] - weights->Extent[0] + 1;
+    weights->Workspace = new F[size];
+  }
+
   if (!validClip)
   {
     // output extent doesn't itersect input extent
@@ -1091,6 +1626,24 @@ void vtkImageInterpolator::GetRowInterpolationFunc(
     func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
 }
 
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetSpanInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const double [3], const double [3],
+                double *, int))
+{
+  vtkImageInterpolatorGetSpanInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetSpanInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const float [3], const float [3],
+                float *, int))
+{
+  vtkImageInterpolatorGetSpanInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageInterpolator::PrecomputeWeightsForExtent(
   const double matrix[16], const int extent[6], int newExtent[6],
@@ -1117,5 +1670,15 @@ void vtkImageInterpolator::PrecomputeWeightsForExtent(
 void vtkImageInterpolator::FreePrecomputedWeights(
   vtkInterpolationWeights *&weights)
 {
+  if (weights->WeightType == VTK_FLOAT)
+  {
+    delete [] static_cast<float *>(weights->Workspace);
+  }
+  else
+  {
+    delete [] static_cast<double *>(weights->Workspace);
+  }
+  weights->Workspace = 0;
+
   this->Superclass::FreePrecomputedWeights(weights);
 }
@@ -130,6 +130,20 @@ protected:
       vtkInterpolationWeights *, int, int, int, float *, int)) VTK_OVERRIDE;
   //@}
 
+  //@{
+  /**
+   * Get the span interpolation functions.
+   */
+  void GetSpanInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double [3], const double [3],
+      double *, int)) VTK_OVERRIDE;
+  void GetSpanInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float [3], const float [3],
+      float *, int)) VTK_OVERRIDE;
+  //@}
+
   int InterpolationMode;
 
 private:
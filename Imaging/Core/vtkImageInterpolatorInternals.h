@@ -43,10 +43,11 @@ struct vtkInterpolationWeights : public vtkInterpolationInfo
   int WeightExtent[6];
   int KernelSize[3];
   int WeightType; // VTK_FLOAT or VTK_DOUBLE
+  void *Workspace; // scratch space for the row interpolation, or NULL
 
   // partial copy contstructor from superclass
   vtkInterpolationWeights(const vtkInterpolationInfo &info) :
-    vtkInterpolationInfo(info) {}
+    vtkInterpolationInfo(info), Workspace(0) {}
 };
 
 // The internal math functions for the interpolators
@@ -2008,6 +2008,9 @@ void vtkImageResliceExecute(vtkImageReslice *self,
 
   bool rescaleScalars = (scalarShift != 0.0 || scalarScale != 1.0);
 
+  // can each segment of a row be interpolated with one call?
+  bool interpolateSpans = (!newtrans && !perspective && nsamples <= 1);
+
   // is nearest neighbor optimization possible?
   bool optimizeNearest = 0;
   if (interpolationMode == VTK_NEAREST_INTERPOLATION &&
@@ -2177,7 +2180,10 @@ void vtkImageResliceExecute(vtkImageReslice *self,
                 // do the interpolation
                 sampleCount++;
                 isInBounds = 1;
-                interpolator->InterpolateIJK(inPoint, tmpPtr);
+                if (!interpolateSpans)
+                {
+                  interpolator->InterpolateIJK(inPoint, tmpPtr);
+                }
                 tmpPtr += inComponents;
               }
             }
@@ -2199,6 +2205,17 @@ void vtkImageResliceExecute(vtkImageReslice *self,
 
           if (wasInBounds)
           {
+            if (interpolateSpans)
+            {
+              F inPoint[3];
+              inPoint[0] = inPoint1[0] + startIdX*xAxis[0];
+              inPoint[1] = inPoint1[1] + startIdX*xAxis[1];
+              inPoint[2] = inPoint1[2] + startIdX*xAxis[2];
+              interpolator->InterpolateSpanIJK(
+                inPoint, xAxis, tmpPtr - inComponents*(idX - startIdX),
+                numpixels);
+            }
+
             if (outputStencil)
             {
               outputStencil->InsertNextExtent(startIdX, endIdX, idY, idZ);
@@ -2592,6 +2609,347 @@ void vtkGetSummationFunc(
   }
 }
 
+//----------------------------------------------------------------------------
+// Fixed-point trilinear interpolation for 8-bit and 16-bit data.  The
+// weights for each kernel are quantized so that they sum to exactly one,
+// which means that the result never leaves the range of the input type and
+// differs from floating-point interpolation by at most one.  The number of
+// fraction bits in each weight is chosen so that the sums cannot overflow.
+
+template<class T, int Size = sizeof(T)>
+struct vtkImageResliceFixedPointTraits;
+
+template<class T>
+struct vtkImageResliceFixedPointTraits<T, 1>
+{
+  typedef int SumType;
+  static const int Bits = 11;
+};
+
+template<class T>
+struct vtkImageResliceFixedPointTraits<T, 2>
+{
+  typedef vtkTypeInt64 SumType;
+  static const int Bits = 20;
+};
+
+// The fixed-point x weights, and a workspace for combining the rows
+struct vtkImageResliceFixedWeights
+{
+  int *WeightsX;
+  void *Workspace;
+};
+
+template<class F, class T>
+struct vtkImageResliceFixedPoint
+{
+  typedef typename vtkImageResliceFixedPointTraits<T>::SumType SumType;
+  static const int Bits = vtkImageResliceFixedPointTraits<T>::Bits;
+
+  static vtkImageResliceFixedWeights *NewWeights(
+    vtkInterpolationWeights *weights);
+
+  static void DeleteWeights(
+    vtkImageResliceFixedWeights *fixed, vtkInterpolationWeights *weights);
+
+  static void Trilinear(
+    void *&outPtr, int idX, int idY, int idZ, int numscalars, int n,
+    vtkInterpolationWeights *weights, vtkImageResliceFixedWeights *fixed);
+};
+
+//----------------------------------------------------------------------------
+template<class F, class T>
+vtkImageResliceFixedWeights *vtkImageResliceFixedPoint<F, T>::NewWeights(
+  vtkInterpolationWeights *weights)
+{
+  int step = weights->KernelSize[0];
+  int minX = weights->WeightExtent[0];
+  int maxX = weights->WeightExtent[1];
+  const F *fX = static_cast<F *>(weights->Weights[0]);
+  int *fixedX = new int[step*(maxX - minX + 1)];
+  fixedX -= step*minX;
+
+  const F one = static_cast<F>(1 << Bits);
+  for (int i = minX; i <= maxX; i++)
+  {
+    if (step == 1)
+    {
+      fixedX[i] = (1 << Bits);
+    }
+    else
+    {
+      int q = static_cast<int>(fX[2*i + 1]*one + static_cast<F>(0.5));
+      fixedX[2*i] = (1 << Bits) - q;
+      fixedX[2*i + 1] = q;
+    }
+  }
+
+  vtkImageResliceFixedWeights *fixed = new vtkImageResliceFixedWeights;
+  fixed->WeightsX = fixedX;
+  fixed->Workspace = 0;
+
+  // the interpolator only provides a workspace if the output rows are
+  // parallel to the input rows, and so do we
+  if (weights->Workspace)
+  {
+    vtkIdType size = weights->Increments[0];
+    size *= weights->Extent[1] - weights->Extent[0] + 1;
+    fixed->Workspace = new SumType[size];
+  }
+
+  return fixed;
+}
+
+//----------------------------------------------------------------------------
+template<class F, class T>
+void vtkImageResliceFixedPoint<F, T>::DeleteWeights(
+  vtkImageResliceFixedWeights *fixed, vtkInterpolationWeights *weights)
+{
+  delete [] (fixed->WeightsX +
+             weights->KernelSize[0]*weights->WeightExtent[0]);
+  delete [] static_cast<SumType *>(fixed->Workspace);
+  delete fixed;
+}
+
+//----------------------------------------------------------------------------
+template<class F, class T>
+void vtkImageResliceFixedPoint<F, T>::Trilinear(
+  void *&outPtr0, int idX, int idY, int idZ, int numscalars, int n,
+  vtkInterpolationWeights *weights, vtkImageResliceFixedWeights *fixed)
+{
+  int stepX = weights->KernelSize[0];
+  int stepY = weights->KernelSize[1];
+  int stepZ = weights->KernelSize[2];
+  idX *= stepX;
+  idY *= stepY;
+  idZ *= stepZ;
+  const int *qX = fixed->WeightsX + idX;
+  const F *fY = static_cast<F *>(weights->Weights[1]) + idY;
+  const F *fZ = static_cast<F *>(weights->Weights[2]) + idZ;
+  const vtkIdType *iX = weights->Positions[0] + idX;
+  const vtkIdType *iY = weights->Positions[1] + idY;
+  const vtkIdType *iZ = weights->Positions[2] + idZ;
+  const T *inPtr = static_cast<const T *>(weights->Pointer);
+  T *outPtr = static_cast<T *>(outPtr0);
+
+  // the offsets for the 2x2 kernel in y and z
+  vtkIdType offsets[4];
+  offsets[0] = iY[0] + iZ[0];
+  offsets[1] = offsets[0];
+  offsets[2] = offsets[0];
+  offsets[3] = offsets[0];
+
+  F ry = static_cast<F>(1);
+  F fy = static_cast<F>(0);
+  F rz = static_cast<F>(1);
+  F fz = static_cast<F>(0);
+
+  if (stepY == 2)
+  {
+    offsets[2] = iY[1] + iZ[0];
+    offsets[3] = offsets[2];
+    ry = fY[0];
+    fy = fY[1];
+  }
+
+  if (stepZ == 2)
+  {
+    offsets[1] = iY[0] + iZ[1];
+    offsets[3] = offsets[1];
+    rz = fZ[0];
+    fz = fZ[1];
+  }
+
+  if (stepY + stepZ == 4)
+  {
+    offsets[3] = iY[1] + iZ[1];
+  }
+
+  // convert the y and z weights to fixed point, and add the rounding
+  // error to the largest weight so that the sum is exactly one
+  F w[4] = { ry*rz, ry*fz, fy*rz, fy*fz };
+  const F one = static_cast<F>(1 << Bits);
+  int q[4];
+  int sum = 0;
+  int kmax = 0;
+  for (int k = 0; k < 4; k++)
+  {
+    q[k] = static_cast<int>(w[k]*one + static_cast<F>(0.5));
+    sum += q[k];
+    kmax = (w[k] > w[kmax] ? k : kmax);
+  }
+  q[kmax] += (1 << Bits) - sum;
+
+  // if the output row is parallel to the input rows, then the rows can
+  // be combined before interpolating along x
+  vtkIdType minPos = 0;
+  vtkIdType count = 0;
+  SumType *workPtr = static_cast<SumType *>(fixed->Workspace);
+  if (workPtr)
+  {
+    int m = n*stepX;
+    minPos = iX[0];
+    vtkIdType maxPos = iX[0];
+    for (int i = 1; i < m; i++)
+    {
+      minPos = (iX[i] < minPos ? iX[i] : minPos);
+      maxPos = (iX[i] > maxPos ? iX[i] : maxPos);
+    }
+    count = maxPos - minPos + numscalars;
+    if (count > static_cast<vtkIdType>(m)*numscalars)
+    {
+      workPtr = 0;
+    }
+  }
+
+  if (workPtr)
+  {
+    bool first = true;
+    for (int k = 0; k < 4; k++)
+    {
+      if (q[k] != 0)
+      {
+        const T *rowPtr = inPtr + minPos + offsets[k];
+        SumType f = q[k];
+        if (first)
+        {
+          for (vtkIdType i = 0; i < count; i++)
+          {
+            workPtr[i] = f*rowPtr[i];
+          }
+          first = false;
+        }
+        else
+        {
+          for (vtkIdType i = 0; i < count; i++)
+          {
+            workPtr[i] += f*rowPtr[i];
+          }
+        }
+      }
+    }
+
+    if (stepX == 1)
+    {
+      const SumType half = static_cast<SumType>(1) << (Bits - 1);
+      for (int i = n; i > 0; --i)
+      {
+        const SumType *tmpPtr = workPtr + (*iX++ - minPos);
+        int c = numscalars;
+        do
+        {
+          *outPtr++ = static_cast<T>((*tmpPtr++ + half) >> Bits);
+        }
+        while (--c);
+      }
+    }
+    else
+    {
+      const SumType half = static_cast<SumType>(1) << (2*Bits - 1);
+      for (int i = n; i > 0; --i)
+      {
+        const SumType *tmpPtr0 = workPtr + (iX[0] - minPos);
+        const SumType *tmpPtr1 = workPtr + (iX[1] - minPos);
+        SumType rx = qX[0];
+        SumType fx = qX[1];
+        iX += 2;
+        qX += 2;
+        int c = numscalars;
+        do
+        {
+          SumType s = rx*(*tmpPtr0++) + fx*(*tmpPtr1++);
+          *outPtr++ = static_cast<T>((s + half) >> (2*Bits));
+        }
+        while (--c);
+      }
+    }
+  }
+  else if (stepX == 1)
+  {
+    const SumType half = static_cast<SumType>(1) << (Bits - 1);
+    for (int i = n; i > 0; --i)
+    {
+      const T *inPtr0 = inPtr + *iX++;
+      int c = numscalars;
+      do
+      {
+        SumType s = (q[0]*static_cast<SumType>(inPtr0[offsets[0]]) +
+                     q[1]*static_cast<SumType>(inPtr0[offsets[1]]) +
+                     q[2]*static_cast<SumType>(inPtr0[offsets[2]]) +
+                     q[3]*static_cast<SumType>(inPtr0[offsets[3]]));
+        *outPtr++ = static_cast<T>((s + half) >> Bits);
+        inPtr0++;
+      }
+      while (--c);
+    }
+  }
+  else
+  {
+    const SumType half = static_cast<SumType>(1) << (2*Bits - 1);
+    for (int i = n; i > 0; --i)
+    {
+      const T *inPtr0 = inPtr + iX[0];
+      const T *inPtr1 = inPtr + iX[1];
+      SumType rx = qX[0];
+      SumType fx = qX[1];
+      iX += 2;
+      qX += 2;
+      int c = numscalars;
+      do
+      {
+        SumType s0 = (q[0]*static_cast<SumType>(inPtr0[offsets[0]]) +
+                      q[1]*static_cast<SumType>(inPtr0[offsets[1]]) +
+                      q[2]*static_cast<SumType>(inPtr0[offsets[2]]) +
+                      q[3]*static_cast<SumType>(inPtr0[offsets[3]]));
+        SumType s1 = (q[0]*static_cast<SumType>(inPtr1[offsets[0]]) +
+                      q[1]*static_cast<SumType>(inPtr1[offsets[1]]) +
+                      q[2]*static_cast<SumType>(inPtr1[offsets[2]]) +
+                      q[3]*static_cast<SumType>(inPtr1[offsets[3]]));
+        *outPtr++ = static_cast<T>((rx*s0 + fx*s1 + half) >> (2*Bits));
+        inPtr0++;
+        inPtr1++;
+      }
+      while (--c);
+    }
+  }
+
+  outPtr0 = outPtr;
+}
+
+//----------------------------------------------------------------------------
+// get the fixed-point functions for 8-bit and 16-bit integer types,
+// or set them to NULL for other types
+template<class F>
+void vtkGetFixedPointFuncs(
+  void (**summation)(void *&outPtr, int idX, int idY, int idZ, int numscalars,
+                     int n, vtkInterpolationWeights *weights,
+                     vtkImageResliceFixedWeights *fixed),
+  vtkImageResliceFixedWeights *(**newweights)(vtkInterpolationWeights *),
+  void (**deleteweights)(vtkImageResliceFixedWeights *,
+                         vtkInterpolationWeights *),
+  int scalarType)
+{
+  switch (scalarType)
+  {
+#define vtkFixedPointCase(typeN, type) \
+    case typeN: \
+      *summation = &(vtkImageResliceFixedPoint<F, type>::Trilinear); \
+      *newweights = &(vtkImageResliceFixedPoint<F, type>::NewWeights); \
+      *deleteweights = &(vtkImageResliceFixedPoint<F, type>::DeleteWeights); \
+      break
+    vtkFixedPointCase(VTK_CHAR, char);
+    vtkFixedPointCase(VTK_SIGNED_CHAR, signed char);
+    vtkFixedPointCase(VTK_UNSIGNED_CHAR, unsigned char);
+    vtkFixedPointCase(VTK_SHORT, short);
+    vtkFixedPointCase(VTK_UNSIGNED_SHORT, unsigned short);
+#undef vtkFixedPointCase
+    default:
+      *summation = 0;
+      *newweights = 0;
+      *deleteweights = 0;
+  }
+}
+
 //----------------------------------------------------------------------------
 template<class F>
 struct vtkImageResliceRowComp
@@ -2843,6 +3201,23 @@ void vtkReslicePermuteExecute(vtkImageReslice *self,
     doConversion = false;
   }
 
+  // if fixedsummation is set, fixed-point linear interpolation will be used
+  void (*fixedsummation)(void *&out, int idX, int idY, int idZ,
+                         int numscalars, int n,
+                         vtkInterpolationWeights *weights,
+                         vtkImageResliceFixedWeights *fixed) = 0;
+  vtkImageResliceFixedWeights *(*newweights)(vtkInterpolationWeights *) = 0;
+  void (*deleteweights)(vtkImageResliceFixedWeights *,
+                        vtkInterpolationWeights *) = 0;
+  if (interpolationMode == VTK_LINEAR_INTERPOLATION &&
+      inputScalarType == scalarType && !convertScalars && !rescaleScalars &&
+      nsamples == 1)
+  {
+    vtkGetFixedPointFuncs<F>(
+      &fixedsummation, &newweights, &deleteweights, scalarType);
+    doConversion = (fixedsummation == 0);
+  }
+
   // useful information from the interpolator
   int inComponents = interpolator->GetNumberOfComponents();
 
@@ -2851,6 +3226,11 @@ void vtkReslicePermuteExecute(vtkImageReslice *self,
   vtkInterpolationWeights *weights;
   interpolator->PrecomputeWeightsForExtent(
     *newmat, extent, clipExt, weights);
+  vtkImageResliceFixedWeights *fixedWeights = 0;
+  if (fixedsummation)
+  {
+    fixedWeights = newweights(weights);
+  }
 
   // get type-specific functions
   void (*summation)(void *&out, int idX, int idY, int idZ, int numscalars,
@@ -3015,6 +3395,12 @@ void vtkReslicePermuteExecute(vtkImageReslice *self,
             conversion(outPtr, floatPtr, inComponents, span);
           }
         }
+        else if (fixedsummation)
+        {
+          // fixed-point path for linear interpolation of integer data
+          fixedsummation(outPtr, idX, idY, idZ, inComponents, span,
+                         weights, fixedWeights);
+        }
         else
         {
           // fast path for when no conversion is necessary
@@ -3074,6 +3460,11 @@ void vtkReslicePermuteExecute(vtkImageReslice *self,
     delete [] floatSumPtr;
   }
 
+  if (fixedWeights)
+  {
+    deleteweights(fixedWeights, weights);
+  }
+
   interpolator->FreePrecomputedWeights(weights);
 }
 
@@ -0,0 +1,173 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageFFTPlan.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the transforms of vtkImageFFTPlan with a direct evaluation of
+// the DFT for power of two, mixed radix, small prime and large prime
+// (Bluestein) lengths, and check that the inverse undoes the forward
+// transform.
+
+#include "vtkImageFFTPlan.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+void NaiveDFT(const std::vector<vtkImageComplex> &in,
+              std::vector<vtkImageComplex> &out, int sign)
+{
+  int n = static_cast<int>(in.size());
+  out.resize(n);
+  for (int k = 0; k < n; ++k)
+  {
+    double re = 0.0;
+    double im = 0.0;
+    for (int j = 0; j < n; ++j)
+    {
+      // reduce j*k first to keep the angle accurate for large n
+      double angle = -sign * 2.0 * vtkMath::Pi() *
+        static_cast<double>((static_cast<long long>(j) * k) % n) / n;
+      double c = cos(angle);
+      double s = sin(angle);
+      re += in[j].Real * c - in[j].Imag * s;
+      im += in[j].Real * s + in[j].Imag * c;
+    }
+    out[k].Real = re;
+    out[k].Imag = im;
+  }
+}
+
+double MaxError(const std::vector<vtkImageComplex> &a,
+                const std::vector<vtkImageComplex> &b)
+{
+  double error = 0.0;
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    error = std::max(error, fabs(a[i].Real - b[i].Real));
+    error = std::max(error, fabs(a[i].Imag - b[i].Imag));
+  }
+  return error;
+}
+
+bool TestSize(vtkImageFFTPlan *plan, int n)
+{
+  std::vector<vtkImageComplex> in(n), expected, out(n), back(n);
+  std::vector<double> real(n);
+  for (int i = 0; i < n; ++i)
+  {
+    in[i].Real = vtkMath::Random(-1.0, 1.0);
+    in[i].Imag = vtkMath::Random(-1.0, 1.0);
+    real[i] = in[i].Real;
+  }
+
+  plan->SetSize(n);
+  std::vector<vtkImageComplex> work(plan->GetWorkSize() + 1);
+
+  // The error of a DFT sum grows like n; allow for it.
+  double tol = 1e-10 * n;
+  bool success = true;
+
+  NaiveDFT(in, expected, 1);
+  plan->ExecuteForward(&in[0], &out[0], &work[0]);
+  double error = MaxError(out, expected);
+  if (error > tol)
+  {
+    cerr << "Forward transform of length " << n << " is off by "
+         << error << endl;
+    success = false;
+  }
+
+  plan->ExecuteInverse(&out[0], &back[0], &work[0]);
+  error = MaxError(back, in);
+  if (error > tol)
+  {
+    cerr << "Round trip of length " << n << " is off by " << error << endl;
+    success = false;
+  }
+
+  NaiveDFT(in, expected, -1);
+  plan->ExecuteInverse(&in[0], &out[0], &work[0]);
+  for (int k = 0; k < n; ++k)
+  {
+    expected[k].Real /= n;
+    expected[k].Imag /= n;
+  }
+  error = MaxError(out, expected);
+  if (error > tol)
+  {
+    cerr << "Inverse transform of length " << n << " is off by "
+         << error << endl;
+    success = false;
+  }
+
+  std::vector<vtkImageComplex> realIn(n);
+  for (int i = 0; i < n; ++i)
+  {
+    realIn[i].Real = real[i];
+    realIn[i].Imag = 0.0;
+  }
+  NaiveDFT(realIn, expected, 1);
+  plan->ExecuteReal(&real[0], &out[0], &work[0]);
+  error = MaxError(out, expected);
+  if (error > tol)
+  {
+    cerr << "Real transform of length " << n << " is off by "
+         << error << endl;
+    success = false;
+  }
+
+  return success;
+}
+
+}
+
+int TestImageFFTPlan(int, char *[])
+{
+  // Power of two lengths, lengths made of the radix 2, 3, 4 and 5
+  // butterflies, small primes of the generic butterfly, and primes (alone
+  // or as a factor) above VTK_FFT_MAX_GENERIC_RADIX that use Bluestein.
+  static const int sizes[] = {
+    1, 2, 4, 16, 256, 1024,
+    6, 12, 30, 60, 100, 360, 1000,
+    3, 5, 7, 13, 17, 31, 49, 91, 286,
+    37, 101, 257, 1009, 74, 202, 3*101
+  };
+  const int numSizes = static_cast<int>(sizeof(sizes)/sizeof(sizes[0]));
+
+  vtkMath::RandomSeed(1234);
+  vtkNew<vtkImageFFTPlan> plan;
+  int rval = 0;
+  for (int i = 0; i < numSizes; ++i)
+  {
+    if (!TestSize(plan.GetPointer(), sizes[i]))
+    {
+      rval = 1;
+    }
+  }
+
+  // Resizing a plan must replace everything computed for the old size.
+  for (int i = numSizes - 1; i >= 0; --i)
+  {
+    if (!TestSize(plan.GetPointer(), sizes[i]))
+    {
+      rval = 1;
+    }
+  }
+
+  return rval;
+}
@@ -0,0 +1,597 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageFFTPlan.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageFFTPlan.h"
+
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+
+#include <cmath>
+
+vtkStandardNewMacro(vtkImageFFTPlan);
+
+// Prime factors larger than this are handled with Bluestein's algorithm
+// instead of a generic O(n^2) butterfly.
+#define VTK_FFT_MAX_GENERIC_RADIX 31
+
+//----------------------------------------------------------------------------
+vtkImageFFTPlan::vtkImageFFTPlan()
+{
+  this->Size = 0;
+  this->WorkSize = 0;
+  this->NumberOfFactors = 0;
+  this->Factors = NULL;
+  this->Twiddles = NULL;
+  this->Chirp = NULL;
+  this->ChirpSpectrum = NULL;
+  this->BluesteinPlan = NULL;
+  this->HalfPlan = NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkImageFFTPlan::~vtkImageFFTPlan()
+{
+  this->Initialize(0, false);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Size: " << this->Size << "\n";
+  os << indent << "WorkSize: " << this->WorkSize << "\n";
+  os << indent << "Factors:";
+  for (int i = 0; i < this->NumberOfFactors; ++i)
+  {
+    os << " " << this->Factors[i];
+  }
+  os << "\n";
+  os << indent << "Bluestein: " << (this->BluesteinPlan ? "On\n" : "Off\n");
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::SetSize(int n)
+{
+  if (n < 0)
+  {
+    n = 0;
+  }
+  if (n != this->Size)
+  {
+    this->Initialize(n, true);
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+// Build the plan.  The real transform needs a plan of half the size, but
+// that plan only has to do complex transforms (real = false).
+void vtkImageFFTPlan::Initialize(int n, bool real)
+{
+  delete [] this->Factors;
+  delete [] this->Twiddles;
+  delete [] this->Chirp;
+  delete [] this->ChirpSpectrum;
+  this->Factors = NULL;
+  this->Twiddles = NULL;
+  this->Chirp = NULL;
+  this->ChirpSpectrum = NULL;
+  this->NumberOfFactors = 0;
+  if (this->BluesteinPlan)
+  {
+    this->BluesteinPlan->Delete();
+    this->BluesteinPlan = NULL;
+  }
+  if (this->HalfPlan)
+  {
+    this->HalfPlan->Delete();
+    this->HalfPlan = NULL;
+  }
+  this->Size = n;
+  this->WorkSize = 0;
+  if (n <= 0)
+  {
+    return;
+  }
+
+  // The twiddle factors, computed directly (not by recurrence) so that
+  // the round off error does not grow with n.
+  this->Twiddles = new vtkImageComplex[n];
+  double angle = -2.0 * vtkMath::Pi() / n;
+  for (int k = 0; k < n; ++k)
+  {
+    this->Twiddles[k].Real = cos(angle * k);
+    this->Twiddles[k].Imag = sin(angle * k);
+  }
+
+  // Factor n, taking out fours first since they make the fastest stages.
+  int factors[32];
+  int numFactors = 0;
+  int rest = n;
+  while (rest % 4 == 0)
+  {
+    factors[numFactors++] = 4;
+    rest /= 4;
+  }
+  int p = 2;
+  bool largePrime = false;
+  while (rest > 1)
+  {
+    if (p * p > rest)
+    {
+      p = rest;
+    }
+    if (rest % p == 0)
+    {
+      if (p > VTK_FFT_MAX_GENERIC_RADIX)
+      {
+        largePrime = true;
+        break;
+      }
+      factors[numFactors++] = p;
+      rest /= p;
+    }
+    else
+    {
+      p += (p == 2 ? 1 : 2);
+    }
+  }
+
+  if (largePrime)
+  {
+    // Bluestein's algorithm: express the DFT as a convolution with a
+    // chirp, and compute the convolution with a power of two FFT.
+    int m = 1;
+    while (m < 2*n - 1)
+    {
+      m *= 2;
+    }
+    this->BluesteinPlan = vtkImageFFTPlan::New();
+    this->BluesteinPlan->Initialize(m, false);
+
+    this->Chirp = new vtkImageComplex[n];
+    long long n2 = 2*static_cast<long long>(n);
+    for (long long k = 0; k < n; ++k)
+    {
+      // reduce k^2 modulo 2n to keep the angle small and accurate
+      double a = -vtkMath::Pi() * static_cast<double>((k*k) % n2) / n;
+      this->Chirp[k].Real = cos(a);
+      this->Chirp[k].Imag = sin(a);
+    }
+
+    vtkImageComplex *b = new vtkImageComplex[m];
+    vtkImageComplex *work = new vtkImageComplex[m];
+    for (int k = 0; k < m; ++k)
+    {
+      b[k].Real = 0.0;
+      b[k].Imag = 0.0;
+    }
+    for (int k = 0; k < n; ++k)
+    {
+      vtkImageComplexConjugate(this->Chirp[k], b[k]);
+      if (k > 0)
+      {
+        b[m - k] = b[k];
+      }
+    }
+    this->ChirpSpectrum = new vtkImageComplex[m];
+    this->BluesteinPlan->Execute(b, this->ChirpSpectrum, work, 1);
+    delete [] b;
+    delete [] work;
+
+    this->WorkSize = 3*m;
+  }
+  else
+  {
+    this->NumberOfFactors = numFactors;
+    this->Factors = new int[numFactors];
+    for (int i = 0; i < numFactors; ++i)
+    {
+      this->Factors[i] = factors[i];
+    }
+    this->WorkSize = n;
+  }
+
+  if (real)
+  {
+    int realWorkSize = n + this->WorkSize;
+    if (n % 2 == 0)
+    {
+      this->HalfPlan = vtkImageFFTPlan::New();
+      this->HalfPlan->Initialize(n/2, false);
+      realWorkSize = n + this->HalfPlan->WorkSize;
+    }
+    if (realWorkSize > this->WorkSize)
+    {
+      this->WorkSize = realWorkSize;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::ExecuteForward(const vtkImageComplex *in,
+                                     vtkImageComplex *out,
+                                     vtkImageComplex *work)
+{
+  this->Execute(in, out, work, 1);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::ExecuteInverse(const vtkImageComplex *in,
+                                     vtkImageComplex *out,
+                                     vtkImageComplex *work)
+{
+  this->Execute(in, out, work, -1);
+  int n = this->Size;
+  double scale = 1.0/n;
+  for (int k = 0; k < n; ++k)
+  {
+    out[k].Real *= scale;
+    out[k].Imag *= scale;
+  }
+}
+
+//----------------------------------------------------------------------------
+// The spectrum of n = 2h real values is computed from the transform of the
+// h complex values z[k] = x[2k] + i x[2k+1], then completed by symmetry.
+void vtkImageFFTPlan::ExecuteReal(const double *in, vtkImageComplex *out,
+                                  vtkImageComplex *work)
+{
+  int n = this->Size;
+  if (!this->HalfPlan)
+  {
+    // odd length, use a complex transform
+    for (int k = 0; k < n; ++k)
+    {
+      work[k].Real = in[k];
+      work[k].Imag = 0.0;
+    }
+    this->Execute(work, out, work + n, 1);
+    return;
+  }
+
+  int h = n/2;
+  vtkImageComplex *z = work;
+  vtkImageComplex *zHat = work + h;
+  for (int k = 0; k < h; ++k)
+  {
+    z[k].Real = in[2*k];
+    z[k].Imag = in[2*k + 1];
+  }
+  this->HalfPlan->Execute(z, zHat, work + n, 1);
+
+  const vtkImageComplex *w = this->Twiddles;
+  for (int k = 0; k <= h; ++k)
+  {
+    const vtkImageComplex& a = zHat[k < h ? k : 0];
+    const vtkImageComplex& b = zHat[k > 0 ? h - k : 0];
+    // even part (a + conj(b))/2 and odd part (a - conj(b))/(2i)
+    double er = 0.5*(a.Real + b.Real);
+    double ei = 0.5*(a.Imag - b.Imag);
+    double dr = 0.5*(a.Imag + b.Imag);
+    double di = -0.5*(a.Real - b.Real);
+    out[k].Real = er + w[k].Real*dr - w[k].Imag*di;
+    out[k].Imag = ei + w[k].Real*di + w[k].Imag*dr;
+    if (k > 0 && k < h)
+    {
+      out[n - k].Real = out[k].Real;
+      out[n - k].Imag = -out[k].Imag;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Unscaled transform, forward for sign = 1 and inverse for sign = -1.
+void vtkImageFFTPlan::Execute(const vtkImageComplex *in, vtkImageComplex *out,
+                              vtkImageComplex *work, int sign)
+{
+  if (this->Size == 1)
+  {
+    out[0] = in[0];
+  }
+  else if (this->BluesteinPlan)
+  {
+    this->ExecuteBluestein(in, out, work, sign);
+  }
+  else if (this->Size > 1)
+  {
+    this->ExecuteStockham(in, out, work, sign);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Bluestein: X[k] = c[k] sum_j (x[j] c[j]) conj(c[k-j]), with the chirp
+// c[k] = exp(-pi i k^2/n).  The inverse uses the conjugate chirp, whose
+// spectrum is conj(C[-j]).
+void vtkImageFFTPlan::ExecuteBluestein(const vtkImageComplex *in,
+                                       vtkImageComplex *out,
+                                       vtkImageComplex *work, int sign)
+{
+  int n = this->Size;
+  int m = this->BluesteinPlan->Size;
+  vtkImageComplex *a = work;
+  vtkImageComplex *aHat = work + m;
+  vtkImageComplex *subWork = work + 2*m;
+  const vtkImageComplex *c = this->Chirp;
+  const vtkImageComplex *cHat = this->ChirpSpectrum;
+
+  for (int k = 0; k < n; ++k)
+  {
+    double cr = c[k].Real;
+    double ci = sign*c[k].Imag;
+    a[k].Real = in[k].Real*cr - in[k].Imag*ci;
+    a[k].Imag = in[k].Real*ci + in[k].Imag*cr;
+  }
+  for (int k = n; k < m; ++k)
+  {
+    a[k].Real = 0.0;
+    a[k].Imag = 0.0;
+  }
+
+  this->BluesteinPlan->Execute(a, aHat, subWork, 1);
+
+  double scale = 1.0/m;
+  for (int k = 0; k < m; ++k)
+  {
+    const vtkImageComplex& s = (sign > 0 ? cHat[k] : cHat[(m - k) & (m - 1)]);
+    double sr = s.Real*scale;
+    double si = sign*s.Imag*scale;
+    double ar = aHat[k].Real;
+    double ai = aHat[k].Imag;
+    aHat[k].Real = ar*sr - ai*si;
+    aHat[k].Imag = ar*si + ai*sr;
+  }
+
+  this->BluesteinPlan->Execute(aHat, a, subWork, -1);
+
+  for (int k = 0; k < n; ++k)
+  {
+    double cr = c[k].Real;
+    double ci = sign*c[k].Imag;
+    out[k].Real = a[k].Real*cr - a[k].Imag*ci;
+    out[k].Imag = a[k].Real*ci + a[k].Imag*cr;
+  }
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+
+// One stage of a self-sorting (Stockham) FFT.  The n/r butterflies read
+// their inputs with a stride of n/r and write their outputs with a
+// stride of ns, the product of the radices of the previous stages.  The
+// inner loop is over t, for which both the reads and the writes are
+// contiguous, and the twiddle of input q is w^(q*t*n/(ns*r)).
+template <int R>
+struct vtkImageFFTButterfly;
+
+template <>
+struct vtkImageFFTButterfly<2>
+{
+  static void Compute(vtkImageComplex *a, int)
+  {
+    vtkImageComplex t = a[1];
+    vtkImageComplexSubtract(a[0], t, a[1]);
+    vtkImageComplexAdd(a[0], t, a[0]);
+  }
+};
+
+template <>
+struct vtkImageFFTButterfly<3>
+{
+  static void Compute(vtkImageComplex *a, int sign)
+  {
+    const double s = sign*0.86602540378443864676; // sqrt(3)/2
+    double sr = a[1].Real + a[2].Real;
+    double si = a[1].Imag + a[2].Imag;
+    double tr = a[0].Real - 0.5*sr;
+    double ti = a[0].Imag - 0.5*si;
+    // -i*s*(a1 - a2)
+    double ur = s*(a[1].Imag - a[2].Imag);
+    double ui = -s*(a[1].Real - a[2].Real);
+    a[0].Real += sr;
+    a[0].Imag += si;
+    a[1].Real = tr + ur;
+    a[1].Imag = ti + ui;
+    a[2].Real = tr - ur;
+    a[2].Imag = ti - ui;
+  }
+};
+
+template <>
+struct vtkImageFFTButterfly<4>
+{
+  static void Compute(vtkImageComplex *a, int sign)
+  {
+    double t0r = a[0].Real + a[2].Real;
+    double t0i = a[0].Imag + a[2].Imag;
+    double t1r = a[0].Real - a[2].Real;
+    double t1i = a[0].Imag - a[2].Imag;
+    double t2r = a[1].Real + a[3].Real;
+    double t2i = a[1].Imag + a[3].Imag;
+    // -i*sign*(a1 - a3)
+    double t3r = sign*(a[1].Imag - a[3].Imag);
+    double t3i = -sign*(a[1].Real - a[3].Real);
+    a[0].Real = t0r + t2r;
+    a[0].Imag = t0i + t2i;
+    a[1].Real = t1r + t3r;
+    a[1].Imag = t1i + t3i;
+    a[2].Real = t0r - t2r;
+    a[2].Imag = t0i - t2i;
+    a[3].Real = t1r - t3r;
+    a[3].Imag = t1i - t3i;
+  }
+};
+
+template <>
+struct vtkImageFFTButterfly<5>
+{
+  static void Compute(vtkImageComplex *a, int sign)
+  {
+    const double c1 = 0.30901699437494742410;  // cos(2 pi/5)
+    const double c2 = -0.80901699437494742410; // cos(4 pi/5)
+    const double s1 = sign*0.95105651629515357212; // sin(2 pi/5)
+    const double s2 = sign*0.58778525229247312917; // sin(4 pi/5)
+    double b1r = a[1].Real + a[4].Real;
+    double b1i = a[1].Imag + a[4].Imag;
+    double b2r = a[2].Real + a[3].Real;
+    double b2i = a[2].Imag + a[3].Imag;
+    double d1r = a[1].Real - a[4].Real;
+    double d1i = a[1].Imag - a[4].Imag;
+    double d2r = a[2].Real - a[3].Real;
+    double d2i = a[2].Imag - a[3].Imag;
+    double e1r = a[0].Real + c1*b1r + c2*b2r;
+    double e1i = a[0].Imag + c1*b1i + c2*b2i;
+    double e2r = a[0].Real + c2*b1r + c1*b2r;
+    double e2i = a[0].Imag + c2*b1i + c1*b2i;
+    // -i*(s1*d1 + s2*d2) and -i*(s2*d1 - s1*d2)
+    double f1r = s1*d1i + s2*d2i;
+    double f1i = -(s1*d1r + s2*d2r);
+    double f2r = s2*d1i - s1*d2i;
+    double f2i = -(s2*d1r - s1*d2r);
+    a[0].Real += b1r + b2r;
+    a[0].Imag += b1i + b2i;
+    a[1].Real = e1r + f1r;
+    a[1].Imag = e1i + f1i;
+    a[4].Real = e1r - f1r;
+    a[4].Imag = e1i - f1i;
+    a[2].Real = e2r + f2r;
+    a[2].Imag = e2i + f2i;
+    a[3].Real = e2r - f2r;
+    a[3].Imag = e2i - f2i;
+  }
+};
+
+template <int R>
+void vtkImageFFTStage(const vtkImageComplex *in, vtkImageComplex *out,
+                      const vtkImageComplex *w, int n, int ns, int sign)
+{
+  int stride = n/R;
+  int step = n/(ns*R);
+  int numBlocks = n/(ns*R);
+  vtkImageComplex a[R];
+  for (int b = 0; b < numBlocks; ++b)
+  {
+    const vtkImageComplex *ip = in + b*ns;
+    vtkImageComplex *op = out + b*ns*R;
+    for (int t = 0; t < ns; ++t)
+    {
+      a[0] = ip[t];
+      for (int q = 1; q < R; ++q)
+      {
+        const vtkImageComplex& x = ip[t + q*stride];
+        const vtkImageComplex& f = w[q*t*step];
+        double fi = sign*f.Imag;
+        a[q].Real = x.Real*f.Real - x.Imag*fi;
+        a[q].Imag = x.Real*fi + x.Imag*f.Real;
+      }
+      vtkImageFFTButterfly<R>::Compute(a, sign);
+      for (int q = 0; q < R; ++q)
+      {
+        op[t + q*ns] = a[q];
+      }
+    }
+  }
+}
+
+// A stage for any other (small, prime) radix, where the butterfly is a
+// direct DFT of size r that uses w^(n/r) as its root of unity.
+void vtkImageFFTStageGeneric(const vtkImageComplex *in, vtkImageComplex *out,
+                             const vtkImageComplex *w, int n, int ns, int r,
+                             int sign)
+{
+  int stride = n/r;
+  int step = n/(ns*r);
+  int numBlocks = n/(ns*r);
+  vtkImageComplex a[VTK_FFT_MAX_GENERIC_RADIX];
+  for (int b = 0; b < numBlocks; ++b)
+  {
+    const vtkImageComplex *ip = in + b*ns;
+    vtkImageComplex *op = out + b*ns*r;
+    for (int t = 0; t < ns; ++t)
+    {
+      a[0] = ip[t];
+      for (int q = 1; q < r; ++q)
+      {
+        const vtkImageComplex& x = ip[t + q*stride];
+        const vtkImageComplex& f = w[q*t*step];
+        double fi = sign*f.Imag;
+        a[q].Real = x.Real*f.Real - x.Imag*fi;
+        a[q].Imag = x.Real*fi + x.Imag*f.Real;
+      }
+      for (int k = 0; k < r; ++k)
+      {
+        double sr = a[0].Real;
+        double si = a[0].Imag;
+        int e = 0;
+        for (int q = 1; q < r; ++q)
+        {
+          e += k;
+          if (e >= r)
+          {
+            e -= r;
+          }
+          const vtkImageComplex& f = w[e*stride];
+          double fi = sign*f.Imag;
+          sr += a[q].Real*f.Real - a[q].Imag*fi;
+          si += a[q].Real*fi + a[q].Imag*f.Real;
+        }
+        op[t + k*ns].Real = sr;
+        op[t + k*ns].Imag = si;
+      }
+    }
+  }
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::ExecuteStockham(const vtkImageComplex *in,
+                                      vtkImageComplex *out,
+                                      vtkImageComplex *work, int sign)
+{
+  int n = this->Size;
+  int numStages = this->NumberOfFactors;
+  const vtkImageComplex *w = this->Twiddles;
+
+  // alternate between out and work so that the last stage writes to out
+  const vtkImageComplex *src = in;
+  int ns = 1;
+  for (int s = 0; s < numStages; ++s)
+  {
+    vtkImageComplex *dst = (((numStages - 1 - s) % 2) == 0 ? out : work);
+    int r = this->Factors[s];
+    switch (r)
+    {
+      case 2:
+        vtkImageFFTStage<2>(src, dst, w, n, ns, sign);
+        break;
+      case 3:
+        vtkImageFFTStage<3>(src, dst, w, n, ns, sign);
+        break;
+      case 4:
+        vtkImageFFTStage<4>(src, dst, w, n, ns, sign);
+        break;
+      case 5:
+        vtkImageFFTStage<5>(src, dst, w, n, ns, sign);
+        break;
+      default:
+        vtkImageFFTStageGeneric(src, dst, w, n, ns, r, sign);
+        break;
+    }
+    ns *= r;
+    src = dst;
+  }
+}
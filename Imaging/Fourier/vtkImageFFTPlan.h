@@ -0,0 +1,120 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageFFTPlan.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkImageFFTPlan
+ * @brief   Precomputed one dimensional FFT of a fixed length.
+ *
+ * vtkImageFFTPlan holds everything that depends only on the length of a
+ * transform: the factorization of the length, a table of twiddle factors,
+ * and, for lengths with a large prime factor, the chirp and its spectrum
+ * used by Bluestein's algorithm.  Once SetSize() has been called, the
+ * Execute methods only read the plan, so a single plan can be shared by
+ * all the threads of a filter as long as each thread supplies its own
+ * work buffer of GetWorkSize() complex values.
+ *
+ * The transforms are computed with a self-sorting (Stockham) mixed radix
+ * algorithm that has dedicated butterflies for radix 2, 3, 4 and 5 and a
+ * generic butterfly for other small primes, so any length is supported in
+ * O(N log N).  ExecuteReal() computes the spectrum of real valued data of
+ * even length with a transform of half the length.
+ *
+ * @sa
+ * vtkImageFourierFilter vtkImageFFT vtkImageRFFT vtkTableFFT
+*/
+
+#ifndef vtkImageFFTPlan_h
+#define vtkImageFFTPlan_h
+
+#include "vtkImagingFourierModule.h" // For export macro
+#include "vtkObject.h"
+#include "vtkImageFourierFilter.h" // For vtkImageComplex
+
+class VTKIMAGINGFOURIER_EXPORT vtkImageFFTPlan : public vtkObject
+{
+public:
+  static vtkImageFFTPlan *New();
+  vtkTypeMacro(vtkImageFFTPlan,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Set the length of the transforms.  This computes the factorization
+   * and the twiddle factors, and does nothing if the length is unchanged.
+   * It must not be called while other threads are executing the plan.
+   */
+  void SetSize(int n);
+  vtkGetMacro(Size,int);
+
+  /**
+   * The number of complex values that must be provided as the work
+   * buffer of the Execute methods.
+   */
+  vtkGetMacro(WorkSize,int);
+
+  /**
+   * Compute the forward transform of the complex array "in" and store
+   * it in "out", which must not overlap "in".  The input is not modified.
+   * The inverse transform is scaled by 1/N, like vtkImageRFFT.
+   */
+  void ExecuteForward(const vtkImageComplex *in, vtkImageComplex *out,
+                      vtkImageComplex *work);
+  void ExecuteInverse(const vtkImageComplex *in, vtkImageComplex *out,
+                      vtkImageComplex *work);
+
+  /**
+   * Compute the forward transform of N real values.  All N values of
+   * the (Hermitian) spectrum are stored in "out".
+   */
+  void ExecuteReal(const double *in, vtkImageComplex *out,
+                   vtkImageComplex *work);
+
+protected:
+  vtkImageFFTPlan();
+  ~vtkImageFFTPlan() VTK_OVERRIDE;
+
+  void Initialize(int n, bool real);
+  void Execute(const vtkImageComplex *in, vtkImageComplex *out,
+               vtkImageComplex *work, int sign);
+  void ExecuteStockham(const vtkImageComplex *in, vtkImageComplex *out,
+                       vtkImageComplex *work, int sign);
+  void ExecuteBluestein(const vtkImageComplex *in, vtkImageComplex *out,
+                        vtkImageComplex *work, int sign);
+
+  int Size;
+  int WorkSize;
+
+  // The radix of each stage of the transform.
+  int NumberOfFactors;
+  int *Factors;
+
+  // exp(-2 pi i k / Size) for k in [0, Size).
+  vtkImageComplex *Twiddles;
+
+  // Bluestein: exp(-pi i k^2 / Size) for k in [0, Size) and the spectrum
+  // of its conjugate, padded to the length of the sub plan.
+  vtkImageComplex *Chirp;
+  vtkImageComplex *ChirpSpectrum;
+  vtkImageFFTPlan *BluesteinPlan;
+
+  // Real transforms of even length: a plan of half the length.
+  vtkImageFFTPlan *HalfPlan;
+
+private:
+  vtkImageFFTPlan(const vtkImageFFTPlan&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkImageFFTPlan&) VTK_DELETE_FUNCTION;
+};
+
+#endif
+
+// VTK-HeaderTest-Exclude: vtkImageFFTPlan.h
@@ -85,6 +85,8 @@ typedef struct{
 
 /******************* End of COMPLEX number stuff ********************/
 
+class vtkImageFFTPlan;
+
 class VTKIMAGINGFOURIER_EXPORT vtkImageFourierFilter : public vtkImageDecomposeFilter
 {
 public:
@@ -95,36 +97,40 @@ public:
 
   /**
    * This function calculates the whole fft of an array.
-   * The contents of the input array are changed.
-   * (It is engineered for no decimation)
+   * The input array is not modified, and must not be the output array.
    */
   void ExecuteFft(vtkImageComplex *in, vtkImageComplex *out, int N);
 
 
   /**
-   * This function calculates the whole fft of an array.
-   * The contents of the input array are changed.
-   * (It is engineered for no decimation)
+   * This function calculates the whole inverse fft of an array,
+   * scaled by 1/N.  The input array is not modified, and must not be
+   * the output array.
    */
   void ExecuteRfft(vtkImageComplex *in, vtkImageComplex *out, int N);
 
+  /**
+   * The plan for the axis of the current iteration.  It is set up
+   * before the threads are started, and is shared by all of them.
+   */
+  vtkImageFFTPlan *GetPlan() { return this->Plan; }
+
 protected:
-  vtkImageFourierFilter() {}
-  ~vtkImageFourierFilter()VTK_OVERRIDE {}
+  vtkImageFourierFilter();
+  ~vtkImageFourierFilter() VTK_OVERRIDE;
 
-  void ExecuteFftStep2(vtkImageComplex *p_in, vtkImageComplex *p_out,
-                       int N, int bsize, int fb);
-  void ExecuteFftStepN(vtkImageComplex *p_in, vtkImageComplex *p_out,
-                       int N, int bsize, int n, int fb);
   void ExecuteFftForwardBackward(vtkImageComplex *in, vtkImageComplex *out,
                                  int N, int fb);
 
   /**
-   * Override to change extent splitting rules.
+   * Override to prepare the plan for the axis of each iteration and to
+   * change extent splitting rules.
    */
-  int RequestData(vtkInformation* request,
-                  vtkInformationVector** inputVector,
-                  vtkInformationVector* outputVector) VTK_OVERRIDE;
+  int IterativeRequestData(vtkInformation* request,
+                           vtkInformationVector** inputVector,
+                           vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  vtkImageFFTPlan *Plan;
 
 private:
   vtkImageFourierFilter(const vtkImageFourierFilter&) VTK_DELETE_FUNCTION;
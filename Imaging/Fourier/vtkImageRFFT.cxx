@@ -15,12 +15,14 @@
 #include "vtkImageRFFT.h"
 
 #include "vtkImageData.h"
+#include "vtkImageFFTPlan.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
-#include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageRFFT);
 
@@ -60,15 +62,14 @@ int vtkImageRFFT::IterativeRequestUpdateExtent(
 
 //----------------------------------------------------------------------------
 // This templated execute method handles any type input, but the output
-// is always doubles.
+// is always doubles.  Like vtkImageFFT, it transforms batches of rows.
 template <class T>
 void vtkImageRFFTExecute(vtkImageRFFT *self,
                          vtkImageData *inData, int inExt[6], T *inPtr,
                          vtkImageData *outData, int outExt[6], double *outPtr,
                          int id)
 {
-  vtkImageComplex *inComplex;
-  vtkImageComplex *outComplex;
+  const int batchSize = 8;
   vtkImageComplex *pComplex;
   //
   int inMin0, inMax0;
@@ -80,6 +81,7 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
   double *outPtr0, *outPtr1, *outPtr2;
   //
   int idx0, idx1, idx2, inSize0, numberOfComponents;
+  int batch, numberInBatch;
   unsigned long count = 0;
   unsigned long target;
   double startProgress;
@@ -103,9 +105,20 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
     return;
   }
 
-  // Allocate the arrays of complex numbers
-  inComplex = new vtkImageComplex[inSize0];
-  outComplex = new vtkImageComplex[inSize0];
+  // The plan is normally prepared for this axis before the threads start
+  vtkImageFFTPlan *plan = self->GetPlan();
+  vtkSmartPointer<vtkImageFFTPlan> tmpPlan;
+  if (plan->GetSize() != inSize0)
+  {
+    tmpPlan = vtkSmartPointer<vtkImageFFTPlan>::New();
+    tmpPlan->SetSize(inSize0);
+    plan = tmpPlan;
+  }
+
+  // Allocate the arrays for a batch of rows
+  std::vector<vtkImageComplex> inComplex(batchSize*inSize0);
+  std::vector<vtkImageComplex> outComplex(batchSize*inSize0);
+  std::vector<vtkImageComplex> work(plan->GetWorkSize() + 1);
 
   target = static_cast<unsigned long>((outMax2-outMin2+1)*(outMax1-outMin1+1)
                                       * self->GetNumberOfIterations() / 50.0);
@@ -118,62 +131,76 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
   {
     inPtr1 = inPtr2;
     outPtr1 = outPtr2;
-    for (idx1 = outMin1; !self->AbortExecute && idx1 <= outMax1; ++idx1)
+    for (idx1 = outMin1; !self->AbortExecute && idx1 <= outMax1;
+         idx1 += batchSize)
     {
-      if (!id)
+      numberInBatch = outMax1 - idx1 + 1;
+      if (numberInBatch > batchSize)
       {
-        if (!(count%target))
-        {
-          self->UpdateProgress(count/(50.0*target) + startProgress);
-        }
-        count++;
+        numberInBatch = batchSize;
       }
-      // copy into complex numbers
+
+      // copy the batch into the row buffers
       inPtr0 = inPtr1;
-      pComplex = inComplex;
-      for (idx0 = inMin0; idx0 <= inMax0; ++idx0)
+      for (idx0 = 0; idx0 < inSize0; ++idx0)
       {
-        pComplex->Real = static_cast<double>(*inPtr0);
-        pComplex->Imag = 0.0;
-        if (numberOfComponents > 1)
-        { // yes we have an imaginary input
-          pComplex->Imag = static_cast<double>(inPtr0[1]);;
+        T *tmpPtr = inPtr0;
+        for (batch = 0; batch < numberInBatch; ++batch)
+        {
+          pComplex = &inComplex[batch*inSize0 + idx0];
+          pComplex->Real = static_cast<double>(*tmpPtr);
+          pComplex->Imag = 0.0;
+          if (numberOfComponents > 1)
+          { // yes we have an imaginary input
+            pComplex->Imag = static_cast<double>(tmpPtr[1]);
+          }
+          tmpPtr += inInc1;
         }
         inPtr0 += inInc0;
-        ++pComplex;
       }
 
       // Call the method that performs the RFFT
-      self->ExecuteRfft(inComplex, outComplex, inSize0);
+      for (batch = 0; batch < numberInBatch; ++batch)
+      {
+        if (!id)
+        {
+          if (!(count%target))
+          {
+            self->UpdateProgress(count/(50.0*target) + startProgress);
+          }
+          count++;
+        }
+        plan->ExecuteInverse(&inComplex[batch*inSize0],
+                             &outComplex[batch*inSize0], &work[0]);
+      }
 
       // copy into output
       outPtr0 = outPtr1;
-      pComplex = outComplex + (outMin0 - inMin0);
       for (idx0 = outMin0; idx0 <= outMax0; ++idx0)
       {
-        *outPtr0 = static_cast<double>(pComplex->Real);
-        outPtr0[1] = static_cast<double>(pComplex->Imag);
+        double *tmpPtr = outPtr0;
+        pComplex = &outComplex[idx0 - inMin0];
+        for (batch = 0; batch < numberInBatch; ++batch)
+        {
+          tmpPtr[0] = pComplex->Real;
+          tmpPtr[1] = pComplex->Imag;
+          tmpPtr += outInc1;
+          pComplex += inSize0;
+        }
         outPtr0 += outInc0;
-        ++pComplex;
       }
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
+      inPtr1 += numberInBatch*inInc1;
+      outPtr1 += numberInBatch*outInc1;
     }
     inPtr2 += inInc2;
     outPtr2 += outInc2;
   }
-
-  delete [] inComplex;
-  delete [] outComplex;
 }
 
 
-
-
 //----------------------------------------------------------------------------
 // This method is passed input and output Datas, and executes the RFFT
 // algorithm to fill the output from the input.
-// Not threaded yet.
 void vtkImageRFFT::ThreadedRequestData(
   vtkInformation* vtkNotUsed( request ),
   vtkInformationVector** inputVector,
@@ -23,10 +23,9 @@
 #include "vtkTableFFT.h"
 
 #include "vtkDataArray.h"
-#include "vtkImageData.h"
-#include "vtkImageFFT.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageFFTPlan.h"
 #include "vtkObjectFactory.h"
-#include "vtkPointData.h"
 #include "vtkTable.h"
 
 #include "vtkSmartPointer.h"
@@ -34,6 +33,7 @@
   vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
 
 #include <cstring>
+#include <vector>
 
 #include <vtksys/SystemTools.hxx>
 using namespace vtksys;
@@ -44,10 +44,12 @@ vtkStandardNewMacro(vtkTableFFT);
 //-----------------------------------------------------------------------------
 vtkTableFFT::vtkTableFFT()
 {
+  this->Plan = vtkImageFFTPlan::New();
 }
 
 vtkTableFFT::~vtkTableFFT()
 {
+  this->Plan->Delete();
 }
 
 void vtkTableFFT::PrintSelf(ostream &os, vtkIndent indent)
@@ -99,17 +101,34 @@ int vtkTableFFT::RequestData(vtkInformation *vtkNotUsed(request),
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkDataArray> vtkTableFFT::DoFFT(vtkDataArray *input)
 {
-  // Build an image data containing the input data.
-  VTK_CREATE(vtkImageData, imgInput);
-  imgInput->SetDimensions(input->GetNumberOfTuples(), 1, 1);
-  imgInput->SetScalarType(input->GetDataType(), input->GetInformation());
-  imgInput->GetPointData()->SetScalars(input);
+  vtkIdType numTuples = input->GetNumberOfTuples();
+  int n = static_cast<int>(numTuples);
 
-  // Compute the FFT
-  VTK_CREATE(vtkImageFFT, fft);
-  fft->SetInputData(imgInput);
-  fft->Update();
+  // Copy the column, the plan is only rebuilt if the length changed.
+  std::vector<double> values(numTuples + 1);
+  for (vtkIdType i = 0; i < numTuples; i++)
+  {
+    values[i] = input->GetComponent(i, 0);
+  }
+  this->Plan->SetSize(n);
+
+  // Compute the FFT, the output holds (real, imaginary) pairs.
+  VTK_CREATE(vtkDoubleArray, output);
+  output->SetNumberOfComponents(2);
+  output->SetNumberOfTuples(numTuples);
+  if (n > 0)
+  {
+    std::vector<vtkImageComplex> spectrum(n);
+    std::vector<vtkImageComplex> work(this->Plan->GetWorkSize() + 1);
+    this->Plan->ExecuteReal(&values[0], &spectrum[0], &work[0]);
+    double *outPtr = output->GetPointer(0);
+    for (int k = 0; k < n; k++)
+    {
+      outPtr[2*k] = spectrum[k].Real;
+      outPtr[2*k + 1] = spectrum[k].Imag;
+    }
+  }
 
   // Return the result
-  return vtkSmartPointer<vtkDataArray>(fft->GetOutput()->GetPointData()->GetScalars());
+  return output;
 }
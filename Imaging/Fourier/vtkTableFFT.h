@@ -27,12 +27,13 @@
  *
  *
  * vtkTableFFT performs the Fast Fourier Transform on the columns of a table.
- * Internally, it shoves each column into an image data and then uses
- * vtkImageFFT to perform the actual FFT.
+ * Internally, it uses the same vtkImageFFTPlan as vtkImageFFT to perform
+ * the actual FFT, and reuses it for all the columns of the same length.
+ * Since the columns are real valued, a real-to-complex transform is used.
  *
  *
  * @sa
- * vtkImageFFT
+ * vtkImageFFT vtkImageFFTPlan
  *
 */
 
@@ -43,6 +44,8 @@
 #include "vtkImagingFourierModule.h" // For export macro
 #include "vtkSmartPointer.h"    // For internal method.
 
+class vtkImageFFTPlan;
+
 class VTKIMAGINGFOURIER_EXPORT vtkTableFFT : public vtkTableAlgorithm
 {
 public:
@@ -63,6 +66,8 @@ protected:
    */
   virtual vtkSmartPointer<vtkDataArray> DoFFT(vtkDataArray *input);
 
+  vtkImageFFTPlan *Plan;
+
 private:
   vtkTableFFT(const vtkTableFFT &) VTK_DELETE_FUNCTION;
   void operator=(const vtkTableFFT &) VTK_DELETE_FUNCTION;
@@ -14,13 +14,19 @@
 =========================================================================*/
 #include "vtkImageEuclideanDistance.h"
 
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageEuclideanDistance);
 
@@ -32,6 +38,7 @@ vtkImageEuclideanDistance::vtkImageEuclideanDistance()
   this->Initialize = 1;
   this->ConsiderAnisotropy = 1;
   this->Algorithm = VTK_EDT_SAITO;
+  this->GenerateFeatureMap = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -203,7 +210,8 @@ static void vtkImageEuclideanDistanceExecuteSaito(vtkImageEuclideanDistance *sel
   inSize0 = outMax0 - outMin0 + 1;
   maxDist = self->GetMaximumDistance();
 
-  buff= static_cast<double *>(calloc(outMax0+1,sizeof(double)));
+  // the buffers are indexed by idx0, which starts at outMin0
+  buff= static_cast<double *>(calloc(inSize0,sizeof(double))) - outMin0;
 
   // precompute sq[]. Anisotropy is handled here by using Spacing information
   sq = static_cast<double *>(calloc(inSize0*2+2,sizeof(double)));
@@ -354,7 +362,7 @@ static void vtkImageEuclideanDistanceExecuteSaito(vtkImageEuclideanDistance *sel
     }
   }
 
-  free(buff);
+  free(buff + outMin0);
   free(sq);
 }
 
@@ -389,8 +397,9 @@ static void vtkImageEuclideanDistanceExecuteSaitoCached(
   inSize0 = outMax0 - outMin0 + 1;
   maxDist = self->GetMaximumDistance();
 
-  buff= static_cast<double *>(calloc(outMax0+1,sizeof(double)));
-  temp= static_cast<double *>(calloc(outMax0+1,sizeof(double)));
+  // the buffers are indexed by idx0, which starts at outMin0
+  buff= static_cast<double *>(calloc(inSize0,sizeof(double))) - outMin0;
+  temp= static_cast<double *>(calloc(inSize0,sizeof(double))) - outMin0;
 
   // precompute sq[]. Anisotropy is handled here by using Spacing information
   sq = static_cast<double *>(calloc(inSize0*2+2,sizeof(double)));
@@ -478,7 +487,7 @@ static void vtkImageEuclideanDistanceExecuteSaitoCached(
 
         // forward scan
         a=0; buffer=buff[ outMin0 ];
-        outPtr0 = temp ;
+        outPtr0 = temp + outMin0;
         outPtr0 ++;
 
         for (idx0 = outMin0+1; idx0 <= outMax0; ++idx0)
@@ -550,15 +559,288 @@ static void vtkImageEuclideanDistanceExecuteSaitoCached(
     }
   }
 
-  free(buff);
-  free(temp);
+  free(buff + outMin0);
+  free(temp + outMin0);
   free(sq);
 }
+//----------------------------------------------------------------------------
+// Execute Felzenszwalb's algorithm.
+//
+// P.F. Felzenszwalb and D.P. Huttenlocher. Distance Transforms of Sampled
+// Functions. Theory of Computing, 8(19). pp. 415--428, 2012.
+//
+// Each row is transformed independently by computing the lower envelope of
+// the parabolas f(q) + w*(x-q)^2, so the rows are split among the threads.
+//
+namespace {
+
+// The rows are gathered in batches of neighboring rows so that the strided
+// axes are read and written a cache line at a time.
+const int vtkEDTBatchSize = 8;
+
+struct vtkEDTRowBuffers
+{
+  std::vector<double> F;
+  std::vector<double> G;
+  std::vector<double> Z;
+  std::vector<int> V;
+  std::vector<vtkIdType> Feature;
+};
+
+class vtkEDTFelzenszwalbFunctor
+{
+public:
+  double *OutPtr;
+  vtkIdType *FeaturePtr;
+  int Size0;
+  int Size1;
+  vtkIdType Inc0;
+  vtkIdType Inc1;
+  vtkIdType Inc2;
+  double Weight;
+  bool Binary;
+
+  vtkSMPThreadLocal<vtkEDTRowBuffers> Buffers;
+
+  // The number of batches in each slice.
+  vtkIdType GetBatchesPerSlice()
+  {
+    return (this->Size1 + vtkEDTBatchSize - 1)/vtkEDTBatchSize;
+  }
+
+  void Initialize()
+  {
+    vtkEDTRowBuffers& b = this->Buffers.Local();
+    b.F.resize(this->Size0*vtkEDTBatchSize);
+    b.G.resize(this->Size0);
+    b.Z.resize(this->Size0 + 1);
+    b.V.resize(this->Size0);
+    if (this->FeaturePtr)
+    {
+      b.Feature.resize(this->Size0*vtkEDTBatchSize);
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkEDTRowBuffers& b = this->Buffers.Local();
+    vtkIdType batchesPerSlice = this->GetBatchesPerSlice();
+    int n = this->Size0;
+    double *f = &b.F[0];
+    vtkIdType *feature = (this->FeaturePtr ? &b.Feature[0] : 0);
+
+    for (vtkIdType batch = begin; batch < end; batch++)
+    {
+      int idx1 = static_cast<int>(batch % batchesPerSlice)*vtkEDTBatchSize;
+      int count = this->Size1 - idx1;
+      count = (count < vtkEDTBatchSize ? count : vtkEDTBatchSize);
+      vtkIdType offset = idx1*this->Inc1 +
+                         (batch / batchesPerSlice)*this->Inc2;
+
+      // Gather the rows, each row is contiguous in the buffer
+      for (int q = 0; q < n; q++)
+      {
+        const double *outPtr = this->OutPtr + offset + q*this->Inc0;
+        for (int r = 0; r < count; r++)
+        {
+          f[r*n + q] = outPtr[r*this->Inc1];
+        }
+      }
+      if (feature)
+      {
+        for (int q = 0; q < n; q++)
+        {
+          const vtkIdType *featurePtr =
+            this->FeaturePtr + offset + q*this->Inc0;
+          for (int r = 0; r < count; r++)
+          {
+            feature[r*n + q] = featurePtr[r*this->Inc1];
+          }
+        }
+      }
+
+      for (int r = 0; r < count; r++)
+      {
+        if (this->Binary)
+        {
+          this->ExecuteBinaryRow(offset + r*this->Inc1, f + r*n,
+                                 (feature ? feature + r*n : 0));
+        }
+        else
+        {
+          this->ExecuteRow(offset + r*this->Inc1, f + r*n,
+                           &b.G[0], &b.Z[0], &b.V[0],
+                           (feature ? feature + r*n : 0));
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  // For the first axis of an initialized image, every value is either zero
+  // or MaximumDistance, and the envelope is given by the nearest zero on
+  // either side, which is found with a forward and a backward scan.
+  void ExecuteBinaryRow(vtkIdType offset, double *f, vtkIdType *feature)
+  {
+    int n = this->Size0;
+    double w = this->Weight;
+
+    for (int x = 0, last = -1; x < n; x++)
+    {
+      if (f[x] == 0)
+      {
+        last = x;
+      }
+      else if (last >= 0 && w*(x - last)*(x - last) < f[x])
+      {
+        f[x] = w*(x - last)*(x - last);
+        if (feature)
+        {
+          feature[x] = feature[last];
+        }
+      }
+    }
+    for (int x = n - 1, last = -1; x >= 0; x--)
+    {
+      if (f[x] == 0)
+      {
+        last = x;
+      }
+      else if (last >= 0 && w*(x - last)*(x - last) < f[x])
+      {
+        f[x] = w*(x - last)*(x - last);
+        if (feature)
+        {
+          feature[x] = feature[last];
+        }
+      }
+    }
+
+    double *outPtr = this->OutPtr + offset;
+    for (int x = 0; x < n; x++)
+    {
+      outPtr[x*this->Inc0] = f[x];
+    }
+    if (feature)
+    {
+      vtkIdType *featurePtr = this->FeaturePtr + offset;
+      for (int x = 0; x < n; x++)
+      {
+        featurePtr[x*this->Inc0] = feature[x];
+      }
+    }
+  }
+
+  // Compute the lower envelope of the parabolas w*(x-q)^2 + f[q] and
+  // write it to the output row at the given offset.
+  void ExecuteRow(vtkIdType offset, const double *f, double *g,
+                  double *z, int *v, const vtkIdType *feature)
+  {
+    int n = this->Size0;
+    double w = this->Weight;
+
+    // v[] holds the roots of the parabolas that form the envelope, and
+    // z[] the boundaries between them.  Infinite values are skipped.
+    int k = -1;
+    for (int q = 0; q < n; q++)
+    {
+      if (!(f[q] <= VTK_DOUBLE_MAX))
+      {
+        continue;
+      }
+      g[q] = f[q] + w*q*q;
+      double s = 0.0;
+      while (k >= 0)
+      {
+        int p = v[k];
+        s = (g[q] - g[p])/(2*w*(q - p));
+        if (s > z[k])
+        {
+          break;
+        }
+        k--;
+      }
+      k++;
+      v[k] = q;
+      z[k] = (k == 0 ? -VTK_DOUBLE_MAX : s);
+    }
+
+    if (k < 0)
+    {
+      // nothing to propagate along this row
+      return;
+    }
+    z[k + 1] = VTK_DOUBLE_MAX;
+
+    double *outPtr = this->OutPtr + offset;
+    vtkIdType *featurePtr = (feature ? this->FeaturePtr + offset : 0);
+    k = 0;
+    for (int x = 0; x < n; x++)
+    {
+      while (z[k + 1] < x)
+      {
+        k++;
+      }
+      int p = v[k];
+      outPtr[x*this->Inc0] = w*(x - p)*(x - p) + f[p];
+      if (featurePtr)
+      {
+        featurePtr[x*this->Inc0] = feature[p];
+      }
+    }
+  }
+};
+
+} // end anonymous namespace
+
+static void vtkImageEuclideanDistanceExecuteFelzenszwalb(
+  vtkImageEuclideanDistance *self,
+  vtkImageData *outData, int outExt[6], double *outPtr,
+  vtkIdType *featurePtr )
+{
+  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
+  vtkIdType outInc0, outInc1, outInc2;
+
+  self->PermuteExtent(outExt, outMin0,outMax0,outMin1,outMax1,outMin2,outMax2);
+  self->PermuteIncrements(outData->GetIncrements(), outInc0, outInc1, outInc2);
+
+  double spacing = 1.0;
+  if ( self->GetConsiderAnisotropy() )
+  {
+    spacing = outData->GetSpacing()[ self->GetIteration() ];
+  }
+
+  vtkEDTFelzenszwalbFunctor functor;
+  functor.OutPtr = outPtr;
+  functor.FeaturePtr = featurePtr;
+  functor.Size0 = outMax0 - outMin0 + 1;
+  functor.Size1 = outMax1 - outMin1 + 1;
+  functor.Inc0 = outInc0;
+  functor.Inc1 = outInc1;
+  functor.Inc2 = outInc2;
+  functor.Weight = spacing*spacing;
+  functor.Binary = (self->GetIteration() == 0 && self->GetInitialize());
+
+  vtkIdType numBatches =
+    functor.GetBatchesPerSlice()*(outMax2 - outMin2 + 1);
+  vtkSMPTools::For(0, numBatches, functor);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageEuclideanDistance::AllocateOutputScalars(vtkImageData *outData,
                                                       int outExt[6],
                                                       vtkInformation* outInfo)
 {
+  // the intermediate outputs do not get their spacing from the executive,
+  // and the spacing is needed when ConsiderAnisotropy is on
+  if (outInfo->Has(vtkDataObject::SPACING()))
+  {
+    outData->SetSpacing(outInfo->Get(vtkDataObject::SPACING()));
+  }
   outData->SetExtent(outExt);
   outData->AllocateScalars(outInfo);
 }
@@ -651,6 +933,36 @@ int vtkImageEuclideanDistance::IterativeRequestData(
       }
   }
 
+  // The feature map is passed from one iteration to the next.
+  vtkIdType *featurePtr = 0;
+  if (this->GenerateFeatureMap &&
+      this->GetAlgorithm() == VTK_EDT_FELZENSZWALB)
+  {
+    vtkIdType numPts = outData->GetNumberOfPoints();
+    vtkSmartPointer<vtkIdTypeArray> featureMap;
+    if (this->GetIteration() != 0)
+    {
+      featureMap = vtkIdTypeArray::SafeDownCast(
+        inData->GetPointData()->GetArray("FeatureMap"));
+    }
+    if (!featureMap || featureMap->GetNumberOfTuples() != numPts)
+    {
+      featureMap = vtkSmartPointer<vtkIdTypeArray>::New();
+      featureMap->SetName("FeatureMap");
+      featureMap->SetNumberOfValues(numPts);
+      for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+      {
+        featureMap->SetValue(ptId, ptId);
+      }
+    }
+    outData->GetPointData()->AddArray(featureMap);
+    featurePtr = featureMap->GetPointer(0);
+  }
+  else
+  {
+    outData->GetPointData()->RemoveArray("FeatureMap");
+  }
+
   // Call the specific algorithms.
   switch( this->GetAlgorithm() )
   {
@@ -662,6 +974,11 @@ int vtkImageEuclideanDistance::IterativeRequestData(
       vtkImageEuclideanDistanceExecuteSaitoCached( this, outData, outExt,
                                                    static_cast<double *>(outPtr) );
       break;
+    case VTK_EDT_FELZENSZWALB:
+      vtkImageEuclideanDistanceExecuteFelzenszwalb( this, outData, outExt,
+                                                    static_cast<double *>(outPtr),
+                                                    featurePtr );
+      break;
     default:
       vtkErrorMacro(<< "Execute: Unknown Algorithm");
   }
@@ -690,8 +1007,15 @@ void vtkImageEuclideanDistance::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << "Saito\n";
   }
+  else if ( this->Algorithm == VTK_EDT_FELZENSZWALB )
+  {
+    os << "Felzenszwalb\n";
+  }
   else
   {
     os << "Saito Cached\n";
   }
+
+  os << indent << "Generate Feature Map: "
+     << (this->GenerateFeatureMap ? "On\n" : "Off\n");
 }
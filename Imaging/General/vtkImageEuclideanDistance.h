@@ -31,6 +31,14 @@
  * slow it very significantly. In that case, one should use
  * ::SetAlgorithmToSaitoCached() instead for better performance.
  *
+ * For large images, ::SetAlgorithmToFelzenszwalb() computes the same
+ * distance map in linear time per axis by taking the lower envelope of
+ * the parabolas rooted at each voxel of a row, and processes the rows of
+ * each axis in parallel with vtkSMPTools.  With Initialize off, it gives
+ * the exact lower envelope of the input values rather than only propagating
+ * the zeros along the first axis.  This algorithm can also produce a
+ * feature transform, see GenerateFeatureMap.
+ *
  * References:
  *
  * T. Saito and J.I. Toriwaki. New algorithms for Euclidean distance
@@ -40,6 +48,9 @@
  * O. Cuisenaire. Distance Transformation: fast algorithms and applications
  * to medical image processing. PhD Thesis, Universite catholique de Louvain,
  * October 1999. http://ltswww.epfl.ch/~cuisenai/papers/oc_thesis.pdf
+ *
+ * P.F. Felzenszwalb and D.P. Huttenlocher. Distance Transforms of Sampled
+ * Functions. Theory of Computing, 8(19). pp. 415--428, 2012.
 */
 
 #ifndef vtkImageEuclideanDistance_h
@@ -50,6 +61,7 @@
 
 #define VTK_EDT_SAITO_CACHED 0
 #define VTK_EDT_SAITO 1
+#define VTK_EDT_FELZENSZWALB 2
 
 class VTKIMAGINGGENERAL_EXPORT vtkImageEuclideanDistance : public vtkImageDecomposeFilter
 {
@@ -94,7 +106,7 @@ public:
    * Selects a Euclidean DT algorithm.
    * 1. Saito
    * 2. Saito-cached
-   * More algorithms will be added later on.
+   * 3. Felzenszwalb
    */
   vtkSetMacro(Algorithm, int);
   vtkGetMacro(Algorithm, int);
@@ -102,6 +114,21 @@ public:
     { this->SetAlgorithm(VTK_EDT_SAITO); }
   void SetAlgorithmToSaitoCached ()
     { this->SetAlgorithm(VTK_EDT_SAITO_CACHED); }
+  void SetAlgorithmToFelzenszwalb ()
+    { this->SetAlgorithm(VTK_EDT_FELZENSZWALB); }
+  //@}
+
+  //@{
+  /**
+   * Add a vtkIdTypeArray called "FeatureMap" to the output point data
+   * that gives, for each point, the id of the point whose input value
+   * produced its distance (with Initialize on, this is the nearest
+   * zero-valued voxel).  This is only supported by the Felzenszwalb
+   * algorithm and is off by default.
+   */
+  vtkSetMacro(GenerateFeatureMap, int);
+  vtkGetMacro(GenerateFeatureMap, int);
+  vtkBooleanMacro(GenerateFeatureMap, int);
   //@}
 
   int IterativeRequestData(vtkInformation*,
@@ -116,6 +143,7 @@ protected:
   int Initialize;
   int ConsiderAnisotropy;
   int Algorithm;
+  int GenerateFeatureMap;
 
   // Replaces "EnlargeOutputUpdateExtent"
   virtual void AllocateOutputScalars(vtkImageData *outData,
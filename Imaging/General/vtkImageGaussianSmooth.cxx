@@ -18,9 +18,13 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkImageSeparableFilterInternals.h"
 
 #include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageGaussianSmooth);
 
@@ -28,6 +32,8 @@ vtkStandardNewMacro(vtkImageGaussianSmooth);
 vtkImageGaussianSmooth::vtkImageGaussianSmooth()
 {
   this->Dimensionality = 3; // note: this overrides Standard deviation.
+  this->Algorithm = vtkImageGaussianSmooth::Convolution;
+  this->KeepIntermediatePrecision = false;
   this->StandardDeviations[0] = 2.0;
   this->StandardDeviations[1] = 2.0;
   this->StandardDeviations[2] = 2.0;
@@ -52,6 +58,11 @@ void vtkImageGaussianSmooth::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Dimensionality: " << this->Dimensionality << "\n";
 
+  os << indent << "Algorithm: " << this->GetAlgorithmAsString() << "\n";
+
+  os << indent << "KeepIntermediatePrecision: "
+     << (this->KeepIntermediatePrecision ? "On\n" : "Off\n");
+
   os << indent << "RadiusFactors: ( "
      << this->RadiusFactors[0] << ", "
      << this->RadiusFactors[1] << ", "
@@ -63,6 +74,19 @@ void vtkImageGaussianSmooth::PrintSelf(ostream& os, vtkIndent indent)
      << this->StandardDeviations[2] << " )\n";
 }
 
+//----------------------------------------------------------------------------
+const char *vtkImageGaussianSmooth::GetAlgorithmAsString()
+{
+  switch (this->Algorithm)
+  {
+    case vtkImageGaussianSmooth::Convolution:
+      return "Convolution";
+    case vtkImageGaussianSmooth::Recursive:
+      return "Recursive";
+  }
+  return "";
+}
+
 //----------------------------------------------------------------------------
 void vtkImageGaussianSmooth::ComputeKernel(double *kernel, int min, int max,
                                            double std)
@@ -125,6 +149,17 @@ void vtkImageGaussianSmooth::InternalRequestUpdateExtent(int *inExt,
   // Expand filtered axes
   for (idx = 0; idx < this->Dimensionality; ++idx)
   {
+    // the recursive filter needs the whole input along the filtered axes
+    if (this->Algorithm == vtkImageGaussianSmooth::Recursive)
+    {
+      if (this->StandardDeviations[idx] > 0.0)
+      {
+        inExt[idx*2] = wholeExtent[idx*2];
+        inExt[idx*2+1] = wholeExtent[idx*2+1];
+      }
+      continue;
+    }
+
     radius = static_cast<int>(this->StandardDeviations[idx]
                               * this->RadiusFactors[idx]);
     inExt[idx*2] -= radius;
@@ -142,323 +177,348 @@ void vtkImageGaussianSmooth::InternalRequestUpdateExtent(int *inExt,
 }
 
 //----------------------------------------------------------------------------
-// For a given position along the convolution axis, this method loops over
-// all other axes, and performs the convolution. Boundary conditions handled
-// previously.
-template <class T>
-void
-vtkImageGaussianSmoothExecute(vtkImageGaussianSmooth *self, int axis,
-                              double *kernel, int kernelSize,
-                              vtkImageData *inData, T *inPtrC,
-                              vtkImageData *outData, int outExt[6],
-                              T *outPtrC, int *pcycle, int target,
-                              int *pcount, int total)
+// The working type for the computations, double precision is used unless
+// the data is single precision.
+template<class T>
+struct vtkImageGaussianSmoothWorkType
 {
-  int maxC, max0 = 0, max1 = 0;
-  int idxC, idx0, idx1, idxK;
-  vtkIdType inIncs[3], outIncs[3];
-  vtkIdType inInc0 = 0, inInc1 = 0, inIncK, outInc0 = 0, outInc1 = 0;
-  T *outPtr1, *outPtr0;
-  T *inPtr1, *inPtr0, *inPtrK;
-  double *ptrK, sum;
+  typedef double Type;
+};
 
-  // I am counting on the fact that tight loops (component on outside)
-  // is more important than cache misses from shuffled access.
+template<>
+struct vtkImageGaussianSmoothWorkType<float>
+{
+  typedef float Type;
+};
 
-  // Do the correct shuffling of the axes (increments, extents)
+//----------------------------------------------------------------------------
+// Convolve all components of a block of the image.
+template <class T>
+void vtkImageGaussianSmoothExecute(vtkImageGaussianSmooth *self,
+                                   const vtkImageSeparableKernel kernels[3],
+                                   vtkImageData *inData, T *inPtr,
+                                   vtkImageData *outData, int outExt[6],
+                                   T *outPtr, int id)
+{
+  typedef typename vtkImageGaussianSmoothWorkType<T>::Type W;
+
+  vtkIdType inIncs[3], outIncs[3];
   inData->GetIncrements(inIncs);
   outData->GetIncrements(outIncs);
-  inIncK = inIncs[axis];
-  maxC = outData->GetNumberOfScalarComponents();
-  switch (axis)
-  {
-    case 0:
-      inInc0 = inIncs[1];  inInc1 = inIncs[2];
-      outInc0 = outIncs[1];  outInc1 = outIncs[2];
-      max0 = outExt[3] - outExt[2] + 1;   max1 = outExt[5] - outExt[4] + 1;
-      break;
-    case 1:
-      inInc0 = inIncs[0];  inInc1 = inIncs[2];
-      outInc0 = outIncs[0];  outInc1 = outIncs[2];
-      max0 = outExt[1] - outExt[0] + 1;   max1 = outExt[5] - outExt[4] + 1;
-      break;
-    case 2:
-      inInc0 = inIncs[0];  inInc1 = inIncs[1];
-      outInc0 = outIncs[0];  outInc1 = outIncs[1];
-      max0 = outExt[1] - outExt[0] + 1;   max1 = outExt[3] - outExt[2] + 1;
-      break;
-  }
+  int numComps = outData->GetNumberOfScalarComponents();
 
-  for (idxC = 0; idxC < maxC; ++idxC)
+  vtkImageSeparableFilter<W> filter(kernels);
+  filter.SetAlgorithm(self, (id == 0));
+  filter.SetConvertIntermediates(!self->GetKeepIntermediatePrecision());
+  for (int c = 0; c < numComps; c++)
   {
-    inPtr1 = inPtrC;
-    outPtr1 = outPtrC;
-    for (idx1 = 0; !self->AbortExecute && idx1 < max1; ++idx1)
-    {
-      inPtr0 = inPtr1;
-      outPtr0 = outPtr1;
-      for (idx0 = 0; idx0 < max0; ++idx0)
-      {
-        inPtrK = inPtr0;
-        ptrK = kernel;
-        sum = 0.0;
-        // too bad this short loop has to be the inner most loop
-        for (idxK = 0; idxK < kernelSize; ++idxK)
-        {
-          sum += *ptrK * static_cast<double>(*inPtrK);
-          ++ptrK;
-          inPtrK += inIncK;
-        }
-        *outPtr0 = static_cast<T>(sum);
-        inPtr0 += inInc0;
-        outPtr0 += outInc0;
-      }
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
-      // we finished a row ... do we update ???
-      if (total)
-      { // yes this is the main thread
-        *pcycle += max0;
-        if (*pcycle > target)
-        { // yes
-          *pcycle -= target;
-          *pcount += target;
-          self->UpdateProgress(static_cast<double>(*pcount) /
-                               static_cast<double>(total));
-          //fprintf(stderr, "count: %d, total: %d, progress: %f\n",
-          //*pcount, total, (double)(*pcount) / (double)total);
-        }
-      }
-    }
-
-    ++inPtrC;
-    ++outPtrC;
+    filter.Execute(inPtr + c, inData->GetExtent(), inIncs,
+                   outPtr + c, outExt, outIncs, false);
   }
 }
 
 //----------------------------------------------------------------------------
-template <class T>
-size_t vtkImageGaussianSmoothGetTypeSize(T*)
+// This method builds the kernels for the block and smooths it along all
+// of the axes at once.
+void vtkImageGaussianSmooth::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *vtkNotUsed(outputVector),
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int outExt[6], int id)
 {
-  return sizeof(T);
-}
+  // this filter expects that input is the same type as output.
+  if (inData[0][0]->GetScalarType() != outData[0]->GetScalarType())
+  {
+    vtkErrorMacro("Execute: input ScalarType, "
+                  << inData[0][0]->GetScalarType()
+                  << ", must match out ScalarType "
+                  << outData[0]->GetScalarType());
+    return;
+  }
 
-//----------------------------------------------------------------------------
-// This method convolves over one axis. It loops over the convolved axis,
-// and handles boundary conditions.
-void vtkImageGaussianSmooth::ExecuteAxis(int axis,
-                                         vtkImageData *inData, int inExt[6],
-                                         vtkImageData *outData, int outExt[6],
-                                         int *pcycle, int target,
-                                         int *pcount, int total,
-                                         vtkInformation *inInfo)
-{
-  int idxA, max;
-  int wholeExtent[6], wholeMax, wholeMin;
-  double *kernel;
-  // previousClip and currentClip rembers that the previous was not clipped
-  // keeps from recomputing kernels for center pixels.
-  int kernelSize = 0;
-  int kernelLeftClip, kernelRightClip;
-  int previousClipped, currentClipped;
-  int radius, size;
-  void *inPtr;
-  void *outPtr;
-  int coords[3];
-  vtkIdType outIncs[3], outIncA;
-
-  // Get the correct starting pointer of the output
-  outPtr = outData->GetScalarPointerForExtent(outExt);
-  outData->GetIncrements(outIncs);
-  outIncA = outIncs[axis];
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  int wholeExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
 
-  // trick to account for the scalar type of the output(used to be only float)
-  switch (outData->GetScalarType())
+  // the kernels are cut off at the boundaries of the whole extent, and
+  // the weights of each sample are normalized over the samples they use,
+  // so the gaussian is passed as ComputeKernel() evaluates it before its
+  // normalization
+  vtkImageSeparableKernel kernels[3];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    int outMin = outExt[2*axis];
+    int outMax = outExt[2*axis + 1];
+    if (axis >= this->Dimensionality)
+    {
+      kernels[axis].SetIdentity(outMin, outMax);
+      continue;
+    }
+    int radius = static_cast<int>(this->StandardDeviations[axis]
+                                  * this->RadiusFactors[axis]);
+    double sigma = this->StandardDeviations[axis];
+    std::vector<double> kernel(2*radius + 1, 1.0);
+    for (int x = -radius; x <= radius && sigma != 0.0; ++x)
+    {
+      kernel[x + radius] =
+        exp(- (static_cast<double>(x*x)) / (sigma * sigma * 2.0));
+    }
+    kernels[axis].SetKernel(&kernel[0], 2*radius + 1, radius,
+                            outMin, outMax,
+                            wholeExt[2*axis], wholeExt[2*axis + 1],
+                            vtkImageSeparableKernel::Renormalize);
+  }
+
+  void *inPtr = inData[0][0]->GetScalarPointer();
+  void *outPtr = outData[0]->GetScalarPointerForExtent(outExt);
+
+  switch (inData[0][0]->GetScalarType())
   {
     vtkTemplateMacro(
-      outIncA *= static_cast<vtkIdType>(
-        vtkImageGaussianSmoothGetTypeSize(static_cast<VTK_TT*>(0)))
+      vtkImageGaussianSmoothExecute(this, kernels,
+                                    inData[0][0], static_cast<VTK_TT*>(inPtr),
+                                    outData[0], outExt,
+                                    static_cast<VTK_TT*>(outPtr), id)
       );
     default:
       vtkErrorMacro("Unknown scalar type");
       return;
   }
+}
 
-  // Determine default starting position of input
-  coords[0] = inExt[0];
-  coords[1] = inExt[2];
-  coords[2] = inExt[4];
+//----------------------------------------------------------------------------
+namespace {
 
-  // get whole extent for boundary checking ...
-  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
-  wholeMin = wholeExtent[axis*2];
-  wholeMax = wholeExtent[axis*2+1];
-
-  // allocate memory for the kernel
-  radius = static_cast<int>(this->StandardDeviations[axis]
-                            * this->RadiusFactors[axis]);
-  size = 2*radius + 1;
-  kernel = new double[size];
-
-  // loop over the convolution axis
-  previousClipped = currentClipped = 1;
-  max = outExt[axis*2+1];
-  for (idxA = outExt[axis*2]; idxA <= max; ++idxA)
+// Apply the recursive filter along Z for each XZ plane of the input, and
+// keep the slices of the output extent.
+template<class T, class W>
+class vtkGaussianSmoothRecursiveZ
+{
+public:
+  const T *InPtr;
+  vtkIdType InIncs[3];
+  W *Buffer;
+  int Size[3];
+  int OutMin2;
+  int OutSize2;
+  const vtkImageRecursiveGaussian *Gaussian;
+
+  vtkSMPThreadLocal<std::vector<W> > Planes;
+
+  void Initialize()
   {
-    // left boundary condition
-    coords[axis] = idxA - radius;
-    kernelLeftClip = wholeMin - coords[axis];
-    if (kernelLeftClip > 0)
-    { // front of kernel is cut off ("kernelStart" samples)
-      coords[axis] += kernelLeftClip;
-    }
-    else
-    {
-      kernelLeftClip = 0;
-    }
-    // Right boundary condition
-    kernelRightClip = (idxA + radius) - wholeMax;
-    if (kernelRightClip < 0)
+    std::vector<W>& plane = this->Planes.Local();
+    plane.resize((this->Size[2] + 4)*static_cast<size_t>(this->Size[0]));
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int n0 = this->Size[0];
+    int n2 = this->Size[2];
+    W *plane = &this->Planes.Local()[0];
+    W *work = plane + n2*static_cast<size_t>(n0);
+
+    for (vtkIdType idx1 = begin; idx1 < end; idx1++)
     {
-      kernelRightClip = 0;
+      const T *inPtr = this->InPtr + idx1*this->InIncs[1];
+      for (int idx2 = 0; idx2 < n2; idx2++)
+      {
+        vtkImageSeparableFilterLoad(plane + idx2*n0, inPtr, this->InIncs[0],
+                                    n0, static_cast<W>(1), true);
+        inPtr += this->InIncs[2];
+      }
+
+      this->Gaussian->Filter(plane, n2, n0, n0, work);
+
+      for (int idx2 = 0; idx2 < this->OutSize2; idx2++)
+      {
+        const W *row = plane + (this->OutMin2 + idx2)*static_cast<size_t>(n0);
+        W *outRow = this->Buffer + (idx2*static_cast<vtkIdType>(this->Size[1])
+                                    + idx1)*n0;
+        for (int idx0 = 0; idx0 < n0; idx0++)
+        {
+          outRow[idx0] = row[idx0];
+        }
+      }
     }
+  }
 
-    // We can only use previous kernel if it is not clipped and new
-    // kernel is also not clipped.
-    currentClipped = kernelLeftClip + kernelRightClip;
-    if (currentClipped || previousClipped)
+  void Reduce()
+  {
+  }
+};
+
+// Apply the recursive filter along Y and then X for each slice of the
+// buffer, and store the output extent.
+template<class T, class W>
+class vtkGaussianSmoothRecursiveXY
+{
+public:
+  W *Buffer;
+  int Size[2];
+  int OutMin[2];
+  int OutSize[2];
+  T *OutPtr;
+  vtkIdType OutIncs[3];
+  const vtkImageRecursiveGaussian *Gaussians;
+
+  vtkSMPThreadLocal<std::vector<W> > Work;
+
+  void Initialize()
+  {
+    std::vector<W>& work = this->Work.Local();
+    work.resize(4*static_cast<size_t>(this->Size[0]));
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int n0 = this->Size[0];
+    int n1 = this->Size[1];
+    W *work = &this->Work.Local()[0];
+
+    for (vtkIdType idx2 = begin; idx2 < end; idx2++)
     {
-      this->ComputeKernel(kernel, -radius+kernelLeftClip,
-                          radius-kernelRightClip,
-                          static_cast<double>(this->StandardDeviations[axis]));
-      kernelSize = size - kernelLeftClip - kernelRightClip;
+      W *plane = this->Buffer + idx2*n1*static_cast<vtkIdType>(n0);
+      this->Gaussians[1].Filter(plane, n1, n0, n0, work);
+
+      for (int idx1 = 0; idx1 < this->OutSize[1]; idx1++)
+      {
+        W *row = plane + (this->OutMin[1] + idx1)*static_cast<size_t>(n0);
+        this->Gaussians[0].Filter(row, n0, 1, 1, work);
+        vtkImageSeparableFilterStore(
+          this->OutPtr + idx1*this->OutIncs[1] + idx2*this->OutIncs[2],
+          this->OutIncs[0], row + this->OutMin[0], this->OutSize[0], false);
+      }
     }
-    previousClipped = currentClipped;
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+// Smooth all components with the recursive filter.  The passes along each
+// axis are parallelized over the other axes.
+template<class T>
+void vtkImageGaussianSmoothRecursive(vtkImageGaussianSmooth *self,
+                                     const vtkImageRecursiveGaussian g[3],
+                                     vtkImageData *inData, int inExt[6],
+                                     vtkImageData *outData, int outExt[6])
+{
+  typedef typename vtkImageGaussianSmoothWorkType<T>::Type W;
+
+  int inSize[3], outSize[3], outMin[3];
+  for (int i = 0; i < 3; i++)
+  {
+    inSize[i] = inExt[2*i + 1] - inExt[2*i] + 1;
+    outSize[i] = outExt[2*i + 1] - outExt[2*i] + 1;
+    outMin[i] = outExt[2*i] - inExt[2*i];
+  }
 
-    /* now do the convolution on the rest of the axes */
-    inPtr = inData->GetScalarPointer(coords);
-    switch (inData->GetScalarType())
+  // a buffer for the input extent, except along Z where it is reduced to
+  // the output extent after the first pass
+  std::vector<W> buffer(static_cast<size_t>(inSize[0])*inSize[1]*outSize[2]);
+
+  int numComps = outData->GetNumberOfScalarComponents();
+  for (int c = 0; c < numComps && !self->AbortExecute; c++)
+  {
+    vtkGaussianSmoothRecursiveZ<T, W> passZ;
+    passZ.InPtr = static_cast<T *>(inData->GetScalarPointerForExtent(inExt));
+    passZ.InPtr += c;
+    inData->GetIncrements(passZ.InIncs);
+    passZ.Buffer = &buffer[0];
+    for (int i = 0; i < 3; i++)
     {
-      vtkTemplateMacro(
-        vtkImageGaussianSmoothExecute(this, axis, kernel, kernelSize,
-                                      inData, static_cast<VTK_TT*>(inPtr),
-                                      outData, outExt,
-                                      static_cast<VTK_TT*>(outPtr),
-                                      pcycle, target, pcount, total)
-        );
-      default:
-        vtkErrorMacro("Unknown scalar type");
-        return;
+      passZ.Size[i] = inSize[i];
     }
-    outPtr = static_cast<void *>(
-      static_cast<unsigned char *>(outPtr) + outIncA);
+    passZ.OutMin2 = outMin[2];
+    passZ.OutSize2 = outSize[2];
+    passZ.Gaussian = &g[2];
+    vtkSMPTools::For(0, inSize[1], passZ);
+    self->UpdateProgress((c + 0.5)/numComps);
+
+    vtkGaussianSmoothRecursiveXY<T, W> passXY;
+    passXY.Buffer = &buffer[0];
+    passXY.Size[0] = inSize[0];
+    passXY.Size[1] = inSize[1];
+    passXY.OutMin[0] = outMin[0];
+    passXY.OutMin[1] = outMin[1];
+    passXY.OutSize[0] = outSize[0];
+    passXY.OutSize[1] = outSize[1];
+    passXY.OutPtr = static_cast<T *>(
+      outData->GetScalarPointerForExtent(outExt));
+    passXY.OutPtr += c;
+    outData->GetIncrements(passXY.OutIncs);
+    passXY.Gaussians = g;
+    vtkSMPTools::For(0, outSize[2], passXY);
+    self->UpdateProgress((c + 1.0)/numComps);
   }
-
-  // get rid of temporary kernel
-  delete [] kernel;
 }
 
+} // end anonymous namespace
+
 //----------------------------------------------------------------------------
-// This method decomposes the gaussian and smooths along each axis.
-void vtkImageGaussianSmooth::ThreadedRequestData(
-  vtkInformation *vtkNotUsed(request),
+int vtkImageGaussianSmooth::RequestData(
+  vtkInformation *request,
   vtkInformationVector **inputVector,
-  vtkInformationVector *outputVector,
-  vtkImageData ***inData,
-  vtkImageData **outData,
-  int outExt[6], int id)
+  vtkInformationVector *outputVector)
 {
-  int inExt[6];
-  int target, count, total, cycle;
-
-  // for feed back, determine line target to get 50 progress update
-  // update is called every target lines. Progress is computed from
-  // the number of pixels processed so far.
-  count = 0; target = 0; total = 0; cycle = 0;
-  if (id == 0)
+  if (this->Algorithm != vtkImageGaussianSmooth::Recursive)
   {
-    // determine the number of pixels.
-    total = this->Dimensionality * (outExt[1] - outExt[0] + 1)
-      * (outExt[3] - outExt[2] + 1) * (outExt[5] - outExt[4] + 1)
-      * inData[0][0]->GetNumberOfScalarComponents();
-    // pixels per update (50 updates)
-    target = total / 50;
+    return this->Superclass::RequestData(request, inputVector, outputVector);
   }
 
-  // this filter expects that input is the same type as output.
-  if (inData[0][0]->GetScalarType() != outData[0]->GetScalarType())
+  // the recursive filter is not split into blocks, since every block
+  // would need the whole input, instead each pass is done in parallel
+  this->PrepareImageData(inputVector, outputVector, 0, 0);
+
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkImageData *outData = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  if (inData->GetScalarType() != outData->GetScalarType())
   {
     vtkErrorMacro("Execute: input ScalarType, "
-                  << inData[0][0]->GetScalarType()
+                  << inData->GetScalarType()
                   << ", must match out ScalarType "
-                  << outData[0]->GetScalarType());
-    return;
+                  << outData->GetScalarType());
+    return 1;
   }
 
-  // Decompose
-  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
-  vtkInformation *outInfo = outputVector->GetInformationObject(0);
-  int wholeExt[6];
+  int outExt[6], inExt[6], wholeExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), outExt);
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
-  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
+  for (int i = 0; i < 6; i++)
+  {
+    inExt[i] = outExt[i];
+  }
   this->InternalRequestUpdateExtent(inExt, wholeExt);
+  if (outExt[0] > outExt[1] || outExt[2] > outExt[3] || outExt[4] > outExt[5])
+  {
+    return 1;
+  }
 
-  switch (this->Dimensionality)
+  vtkImageRecursiveGaussian gaussians[3];
+  for (int axis = 0; axis < this->Dimensionality && axis < 3; axis++)
   {
-    case 1:
-      this->ExecuteAxis(0, inData[0][0], inExt, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      break;
-    case 2:
-      int tempExt[6];
-      vtkImageData *tempData;
-      // compute intermediate extent
-      tempExt[0] = inExt[0];  tempExt[1] = inExt[1];
-      tempExt[2] = outExt[2];  tempExt[3] = outExt[3];
-      tempExt[4] = inExt[4];  tempExt[5] = inExt[5];
-      // create a temp data for intermediate results
-      tempData = vtkImageData::New();
-      tempData->SetExtent(tempExt);
-      tempData->AllocateScalars(inData[0][0]->GetScalarType(),
-                                inData[0][0]->GetNumberOfScalarComponents());
-      this->ExecuteAxis(1, inData[0][0], inExt, tempData, tempExt,
-                        &cycle, target, &count, total, inInfo);
-      this->ExecuteAxis(0, tempData, tempExt, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      // release temporary data
-      tempData->Delete();
-      break;
-    case 3:
-      // we do z first because it is most likely smallest
-      int temp0Ext[6], temp1Ext[6];
-      vtkImageData *temp0Data, *temp1Data;
-      // compute intermediate extents
-      temp0Ext[0] = inExt[0];  temp0Ext[1] = inExt[1];
-      temp0Ext[2] = inExt[2];  temp0Ext[3] = inExt[3];
-      temp0Ext[4] = outExt[4];  temp0Ext[5] = outExt[5];
-
-      temp1Ext[0] = inExt[0];  temp1Ext[1] = inExt[1];
-      temp1Ext[2] = outExt[2];  temp1Ext[3] = outExt[3];
-      temp1Ext[4] = outExt[4];  temp1Ext[5] = outExt[5];
-
-      // create a temp data for intermediate results
-      temp0Data = vtkImageData::New();
-      temp0Data->SetExtent(temp0Ext);
-      temp0Data->AllocateScalars(inData[0][0]->GetScalarType(),
-                                 inData[0][0]->GetNumberOfScalarComponents());
-
-      temp1Data = vtkImageData::New();
-      temp1Data->SetExtent(temp1Ext);
-      temp1Data->AllocateScalars(inData[0][0]->GetScalarType(),
-                                 inData[0][0]->GetNumberOfScalarComponents());
-      this->ExecuteAxis(2, inData[0][0], inExt, temp0Data, temp0Ext,
-                        &cycle, target, &count, total, inInfo);
-      this->ExecuteAxis(1, temp0Data, temp0Ext, temp1Data, temp1Ext,
-                        &cycle, target, &count, total, inInfo);
-      temp0Data->Delete();
-      this->ExecuteAxis(0, temp1Data, temp1Ext, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      temp1Data->Delete();
-      break;
+    gaussians[axis].SetStandardDeviation(this->StandardDeviations[axis]);
   }
+
+  switch (inData->GetScalarType())
+  {
+    vtkTemplateMacro(
+      vtkImageGaussianSmoothRecursive<VTK_TT>(
+        this, gaussians, inData, inExt, outData, outExt));
+    default:
+      vtkErrorMacro("Unknown scalar type");
+      return 1;
+  }
+
+  return 1;
 }
@@ -18,6 +18,10 @@
  *
  * vtkImageGaussianSmooth implements a convolution of the input image
  * with a gaussian. Supports from one to three dimensional convolutions.
+ * The convolution along all axes is done in a single sweep through the
+ * data, so no intermediate images are needed.  For large standard
+ * deviations, the recursive algorithm of Young and van Vliet can be
+ * used instead, its cost does not depend on the standard deviation.
 */
 
 #ifndef vtkImageGaussianSmooth_h
@@ -84,21 +88,59 @@ public:
   vtkGetMacro(Dimensionality, int);
   //@}
 
+  enum AlgorithmEnum
+  {
+    Convolution = 0,
+    Recursive = 1
+  };
+
+  //@{
+  /**
+   * Set the algorithm.  The default, Convolution, uses a gaussian kernel
+   * that is cut off at RadiusFactors times the standard deviation.  The
+   * Recursive algorithm approximates the gaussian with a recursive filter
+   * that is not cut off, and whose cost does not depend on the standard
+   * deviation.  Since its output depends on the whole input, the Recursive
+   * algorithm requests the whole extent of the input along the smoothed
+   * axes, and it ignores the RadiusFactors.
+   */
+  vtkSetClampMacro(Algorithm, int, Convolution, Recursive);
+  void SetAlgorithmToConvolution() { this->SetAlgorithm(Convolution); }
+  void SetAlgorithmToRecursive() { this->SetAlgorithm(Recursive); }
+  vtkGetMacro(Algorithm, int);
+  const char *GetAlgorithmAsString();
+  //@}
+
+  //@{
+  /**
+   * When off (the default), the convolution along each axis is converted
+   * to the scalar type before the next axis is smoothed, which gives the
+   * same results as the separate passes of earlier versions.  When on,
+   * the intermediate results keep the precision of the computation (float
+   * for float data, double otherwise), which is more accurate for integer
+   * data.  The Recursive algorithm always keeps this precision.
+   */
+  vtkSetMacro(KeepIntermediatePrecision, bool);
+  vtkGetMacro(KeepIntermediatePrecision, bool);
+  vtkBooleanMacro(KeepIntermediatePrecision, bool);
+  //@}
+
 protected:
   vtkImageGaussianSmooth();
   ~vtkImageGaussianSmooth() VTK_OVERRIDE;
 
   int Dimensionality;
+  int Algorithm;
+  bool KeepIntermediatePrecision;
   double StandardDeviations[3];
   double RadiusFactors[3];
 
   void ComputeKernel(double *kernel, int min, int max, double std);
   int RequestUpdateExtent (vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
   void InternalRequestUpdateExtent(int *, int*);
-  void ExecuteAxis(int axis, vtkImageData *inData, int inExt[6],
-                   vtkImageData *outData, int outExt[6],
-                   int *pcycle, int target, int *pcount, int total,
-                   vtkInformation *inInfo);
+  int RequestData(vtkInformation *request,
+                  vtkInformationVector **inputVector,
+                  vtkInformationVector *outputVector) VTK_OVERRIDE;
   void ThreadedRequestData(vtkInformation *request,
                            vtkInformationVector **inputVector,
                            vtkInformationVector *outputVector,
@@ -21,6 +21,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkImageSeparableFilterInternals.h"
 
 #include <cmath>
 #include <sstream>
@@ -137,108 +138,52 @@ int vtkImageGradient::RequestUpdateExtent(vtkInformation*,
 //----------------------------------------------------------------------------
 // This execute method handles boundaries.
 // it handles boundaries. Pixels are just replicated to get values
-// out of extent.
+// out of extent.  Each component of the gradient is computed by
+// filtering the input along one axis.
 template <class T>
 void vtkImageGradientExecute(vtkImageGradient *self,
-                             vtkImageData *inData, T *inPtr,
-                             vtkImageData *outData, double *outPtr,
+                             vtkImageData *inData, vtkDataArray *inArray,
+                             T *inPtr, vtkImageData *outData, double *outPtr,
                              int outExt[6], int id)
 {
-  int idxX, idxY, idxZ;
-  int maxX, maxY, maxZ;
-  vtkIdType inIncX, inIncY, inIncZ;
-  vtkIdType outIncX, outIncY, outIncZ;
-  unsigned long count = 0;
-  unsigned long target;
-  int axesNum;
-  int *inExt = inData->GetExtent();
-  int *wholeExtent;
-  vtkIdType inIncs[3];
-  double r[3], d;
-  int useZMin, useZMax, useYMin, useYMax, useXMin, useXMax;
-
-  // find the region to loop over
-  maxX = outExt[1] - outExt[0];
-  maxY = outExt[3] - outExt[2];
-  maxZ = outExt[5] - outExt[4];
-  target = static_cast<unsigned long>((maxZ+1)*(maxY+1)/50.0);
-  target++;
-
   // Get the dimensionality of the gradient.
-  axesNum = self->GetDimensionality();
+  int axesNum = self->GetDimensionality();
 
   // Get increments to march through data
-  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
-  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+  vtkIdType inIncs[3], outIncs[3];
+  inData->GetIncrements(inArray, inIncs);
+  outData->GetIncrements(outIncs);
 
   // The data spacing is important for computing the gradient.
   // central differences (2 * ratio).
-  // Negative because below we have (min - max) for dx ...
+  double r[3];
   inData->GetSpacing(r);
-  r[0] = -0.5 / r[0];
-  r[1] = -0.5 / r[1];
-  r[2] = -0.5 / r[2];
 
-  // get some other info we need
-  inData->GetIncrements(inIncs);
-  wholeExtent = inData->GetExtent();
+  // Pixels outside of the input extent are replicated
+  int *inExt = inData->GetExtent();
+  vtkImageSeparableKernel kernels[3];
 
-  // Move the pointer to the correct starting position.
-  inPtr += (outExt[0]-inExt[0])*inIncs[0] +
-           (outExt[2]-inExt[2])*inIncs[1] +
-           (outExt[4]-inExt[4])*inIncs[2];
+  vtkImageSeparableFilter<double> filter(kernels);
+  filter.SetAlgorithm(self, (id == 0));
 
-  // Loop through output pixels
-  for (idxZ = 0; idxZ <= maxZ; idxZ++)
+  for (int axis = 0; axis < axesNum; axis++)
   {
-    useZMin = ((idxZ + outExt[4]) <= wholeExtent[4]) ? 0 : -inIncs[2];
-    useZMax = ((idxZ + outExt[4]) >= wholeExtent[5]) ? 0 : inIncs[2];
-    for (idxY = 0; !self->AbortExecute && idxY <= maxY; idxY++)
+    for (int j = 0; j < 3; j++)
     {
-      if (!id)
+      if (j == axis)
       {
-        if (!(count%target))
-        {
-          self->UpdateProgress(count/(50.0*target));
-        }
-        count++;
+        double kernel[3] = { -0.5/r[j], 0.0, 0.5/r[j] };
+        kernels[j].SetKernel(kernel, 3, 1, outExt[2*j], outExt[2*j + 1],
+                             inExt[2*j], inExt[2*j + 1],
+                             vtkImageSeparableKernel::Replicate);
       }
-      useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-      useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-      for (idxX = 0; idxX <= maxX; idxX++)
+      else
       {
-        useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-        useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-        // do X axis
-        d = static_cast<double>(inPtr[useXMin]);
-        d -= static_cast<double>(inPtr[useXMax]);
-        d *= r[0]; // multiply by the data spacing
-        *outPtr = d;
-        outPtr++;
-
-        // do y axis
-        d = static_cast<double>(inPtr[useYMin]);
-        d -= static_cast<double>(inPtr[useYMax]);
-        d *= r[1]; // multiply by the data spacing
-        *outPtr = d;
-        outPtr++;
-        if (axesNum == 3)
-        {
-          // do z axis
-          d = static_cast<double>(inPtr[useZMin]);
-          d -= static_cast<double>(inPtr[useZMax]);
-          d *= r[2]; // multiply by the data spacing
-          *outPtr = d;
-          outPtr++;
-        }
-        inPtr++;
+        kernels[j].SetIdentity(outExt[2*j], outExt[2*j + 1]);
       }
-      outPtr += outIncY;
-      inPtr += inIncY;
     }
-    outPtr += outIncZ;
-    inPtr += inIncZ;
+    filter.Execute(inPtr, inExt, inIncs, outPtr + axis, outExt, outIncs,
+                   false);
   }
 }
 
@@ -346,7 +291,8 @@ void vtkImageGradient::ThreadedRequestData(vtkInformation*,
   switch(inputArray->GetDataType())
   {
     vtkTemplateMacro(
-      vtkImageGradientExecute(this, input, static_cast<VTK_TT*>(inPtr),
+      vtkImageGradientExecute(this, input, inputArray,
+                              static_cast<VTK_TT*>(inPtr),
                               output, outPtr, outExt, threadId)
       );
     default:
@@ -0,0 +1,686 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageRankFilterInternals.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkImageRankFilterInternals
+ * @brief   sliding window rank statistics for neighborhood filters
+ *
+ * These templates compute rank statistics (median, minimum, maximum) over
+ * a neighborhood that slides along the rows of an image.  The neighborhood
+ * is stored as a set of runs along the X axis, so moving to the next voxel
+ * of a row only removes the first voxel and adds the one past the end of
+ * each run, instead of visiting the whole neighborhood.
+ *
+ * The values in the window are kept in a multi-level histogram for 8 and
+ * 16 bit types (each level has 16 times the bins of the one above, so a
+ * rank query visits at most 16 bins per level) and in a sorted array for
+ * the other types, which is updated by merging after each step.
+ *
+ * This is used by vtkImageMedian3D, vtkImageRange3D,
+ * vtkImageContinuousDilate3D and vtkImageContinuousErode3D.
+*/
+
+#ifndef vtkImageRankFilterInternals_h
+#define vtkImageRankFilterInternals_h
+
+#include "vtkType.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// The footprint of a neighborhood, as runs along X.  Each run is given by
+// its offset along Y and Z and its first and last offset along X, all
+// relative to the center voxel.
+class vtkImageRankKernel
+{
+public:
+  struct Run
+  {
+    int Offset1;
+    int Offset2;
+    int Begin0;
+    int End0;
+  };
+
+  std::vector<Run> Runs;
+
+  // A rectangular neighborhood.
+  void SetBox(const int size[3], const int middle[3])
+  {
+    this->Runs.clear();
+    if (size[0] <= 0)
+    {
+      return;
+    }
+    for (int i2 = 0; i2 < size[2]; i2++)
+    {
+      for (int i1 = 0; i1 < size[1]; i1++)
+      {
+        Run run = { i1 - middle[1], i2 - middle[2],
+                    -middle[0], size[0] - 1 - middle[0] };
+        this->Runs.push_back(run);
+      }
+    }
+  }
+
+  // A neighborhood given by the non-zero voxels of a mask.
+  void SetMask(const unsigned char *mask, const vtkIdType maskInc[3],
+               const int size[3], const int middle[3])
+  {
+    this->Runs.clear();
+    for (int i2 = 0; i2 < size[2]; i2++)
+    {
+      for (int i1 = 0; i1 < size[1]; i1++)
+      {
+        const unsigned char *maskPtr = mask + i1*maskInc[1] + i2*maskInc[2];
+        int i0 = 0;
+        while (i0 < size[0])
+        {
+          if (maskPtr[i0*maskInc[0]])
+          {
+            Run run = { i1 - middle[1], i2 - middle[2], i0 - middle[0], 0 };
+            while (i0 < size[0] && maskPtr[i0*maskInc[0]])
+            {
+              i0++;
+            }
+            run.End0 = i0 - 1 - middle[0];
+            this->Runs.push_back(run);
+          }
+          i0++;
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// A window of 8 or 16 bit values, stored as a histogram with several
+// levels.  A bin of one level counts the values of 16 bins of the next.
+template<class T>
+class vtkImageRankHistogram
+{
+public:
+  enum { NumberOfLevels = 2*sizeof(T) };
+
+  void Initialize(const vtkImageRankKernel *)
+  {
+    int size = 0;
+    for (int l = 0; l < NumberOfLevels; l++)
+    {
+      this->Start[l] = size;
+      size += (16 << 4*l);
+    }
+    this->Bins.assign(size, 0);
+    this->Count = 0;
+  }
+
+  void Add(int, T v)
+  {
+    int b = vtkImageRankHistogram::GetBin(v);
+    for (int l = NumberOfLevels - 1; l >= 0; l--)
+    {
+      this->Bins[this->Start[l] + b]++;
+      b >>= 4;
+    }
+    this->Count++;
+  }
+
+  void Remove(int, T v)
+  {
+    int b = vtkImageRankHistogram::GetBin(v);
+    for (int l = NumberOfLevels - 1; l >= 0; l--)
+    {
+      this->Bins[this->Start[l] + b]--;
+      b >>= 4;
+    }
+    this->Count--;
+  }
+
+  // The histogram is always up to date.
+  void Commit() {}
+
+  // The histogram must be emptied by removing its values, since clearing
+  // all the bins would cost more than the row itself.
+  bool NeedsRemoval() const { return true; }
+  void Clear() {}
+
+  int GetCount() const { return this->Count; }
+
+  // Get the value of rank k, starting at zero.
+  T GetRank(int k) const
+  {
+    int b = 0;
+    for (int l = 0; l < NumberOfLevels; l++)
+    {
+      const int *bins = &this->Bins[this->Start[l]];
+      b *= 16;
+      while (k >= bins[b])
+      {
+        k -= bins[b];
+        b++;
+      }
+    }
+    return static_cast<T>(b + std::numeric_limits<T>::min());
+  }
+
+  T GetMinimum() const { return this->GetRank(0); }
+  T GetMaximum() const { return this->GetRank(this->Count - 1); }
+
+private:
+  static int GetBin(T v)
+  {
+    return static_cast<int>(v) - static_cast<int>(std::numeric_limits<T>::min());
+  }
+
+  std::vector<int> Bins;
+  int Start[NumberOfLevels];
+  int Count;
+};
+
+//----------------------------------------------------------------------------
+// A window of values of any type, stored in a sorted array.  The values
+// added and removed during a step are sorted and then merged with the
+// array.  NaN values are ignored.
+template<class T>
+class vtkImageRankSortedWindow
+{
+public:
+  void Initialize(const vtkImageRankKernel *)
+  {
+    this->Clear();
+  }
+
+  void Add(int, T v)
+  {
+    if (v == v)
+    {
+      this->Added.push_back(v);
+    }
+  }
+
+  void Remove(int, T v)
+  {
+    if (v == v)
+    {
+      this->Removed.push_back(v);
+    }
+  }
+
+  void Commit()
+  {
+    if (this->Added.empty() && this->Removed.empty())
+    {
+      return;
+    }
+    std::sort(this->Added.begin(), this->Added.end());
+    std::sort(this->Removed.begin(), this->Removed.end());
+
+    this->Merged.clear();
+    size_t a = 0;
+    size_t r = 0;
+    size_t na = this->Added.size();
+    size_t nr = this->Removed.size();
+    size_t nv = this->Values.size();
+    for (size_t v = 0; v < nv; v++)
+    {
+      T value = this->Values[v];
+      if (r < nr && !(this->Removed[r] < value) &&
+          !(value < this->Removed[r]))
+      {
+        // the removed values are all in the window
+        r++;
+        continue;
+      }
+      while (a < na && this->Added[a] < value)
+      {
+        this->Merged.push_back(this->Added[a++]);
+      }
+      this->Merged.push_back(value);
+    }
+    while (a < na)
+    {
+      this->Merged.push_back(this->Added[a++]);
+    }
+
+    this->Values.swap(this->Merged);
+    this->Added.clear();
+    this->Removed.clear();
+  }
+
+  bool NeedsRemoval() const { return false; }
+
+  void Clear()
+  {
+    this->Values.clear();
+    this->Added.clear();
+    this->Removed.clear();
+  }
+
+  int GetCount() const { return static_cast<int>(this->Values.size()); }
+  T GetRank(int k) const { return this->Values[k]; }
+  T GetMinimum() const { return this->Values.front(); }
+  T GetMaximum() const { return this->Values.back(); }
+
+private:
+  std::vector<T> Values;
+  std::vector<T> Merged;
+  std::vector<T> Added;
+  std::vector<T> Removed;
+};
+
+//----------------------------------------------------------------------------
+// A window that only gives the minimum and maximum, for types that are
+// too large for a histogram.  The values of each run of the kernel enter
+// and leave the window in order, so each run keeps a queue of the values
+// that can still become its minimum or maximum (van Herk's method), and
+// the window minimum and maximum are found from the fronts of the queues.
+template<class T>
+class vtkImageRankExtremaWindow
+{
+public:
+  void Initialize(const vtkImageRankKernel *kernel)
+  {
+    size_t numRuns = kernel->Runs.size();
+    this->Queues.resize(numRuns);
+    int start = 0;
+    for (size_t i = 0; i < numRuns; i++)
+    {
+      const vtkImageRankKernel::Run& run = kernel->Runs[i];
+      Queue& q = this->Queues[i];
+      q.Start = start;
+      q.Size = run.End0 - run.Begin0 + 1;
+      q.Reset();
+      start += q.Size;
+    }
+    this->MinValues.resize(start);
+    this->MaxValues.resize(start);
+    this->Active.clear();
+    this->Count = 0;
+  }
+
+  void Add(int run, T v)
+  {
+    if (!(v == v))
+    {
+      return;
+    }
+    Queue& q = this->Queues[run];
+    if (!q.IsActive)
+    {
+      q.IsActive = true;
+      this->Active.push_back(run);
+    }
+    T *minValues = &this->MinValues[q.Start];
+    while (q.MinCount > 0 && v < minValues[q.Wrap(q.MinHead + q.MinCount - 1)])
+    {
+      q.MinCount--;
+    }
+    minValues[q.Wrap(q.MinHead + q.MinCount++)] = v;
+    T *maxValues = &this->MaxValues[q.Start];
+    while (q.MaxCount > 0 && maxValues[q.Wrap(q.MaxHead + q.MaxCount - 1)] < v)
+    {
+      q.MaxCount--;
+    }
+    maxValues[q.Wrap(q.MaxHead + q.MaxCount++)] = v;
+    this->Count++;
+  }
+
+  void Remove(int run, T v)
+  {
+    if (!(v == v))
+    {
+      return;
+    }
+    Queue& q = this->Queues[run];
+    if (!(this->MinValues[q.Start + q.MinHead] < v))
+    {
+      q.MinHead = q.Wrap(q.MinHead + 1);
+      q.MinCount--;
+    }
+    if (!(v < this->MaxValues[q.Start + q.MaxHead]))
+    {
+      q.MaxHead = q.Wrap(q.MaxHead + 1);
+      q.MaxCount--;
+    }
+    this->Count--;
+  }
+
+  void Commit() {}
+
+  bool NeedsRemoval() const { return false; }
+
+  void Clear()
+  {
+    for (size_t i = 0; i < this->Active.size(); i++)
+    {
+      this->Queues[this->Active[i]].Reset();
+    }
+    this->Active.clear();
+    this->Count = 0;
+  }
+
+  int GetCount() const { return this->Count; }
+
+  T GetMinimum() const
+  {
+    T m = T();
+    bool first = true;
+    for (size_t i = 0; i < this->Active.size(); i++)
+    {
+      const Queue& q = this->Queues[this->Active[i]];
+      if (q.MinCount > 0)
+      {
+        T v = this->MinValues[q.Start + q.MinHead];
+        m = (first || v < m ? v : m);
+        first = false;
+      }
+    }
+    return m;
+  }
+
+  T GetMaximum() const
+  {
+    T m = T();
+    bool first = true;
+    for (size_t i = 0; i < this->Active.size(); i++)
+    {
+      const Queue& q = this->Queues[this->Active[i]];
+      if (q.MaxCount > 0)
+      {
+        T v = this->MaxValues[q.Start + q.MaxHead];
+        m = (first || m < v ? v : m);
+        first = false;
+      }
+    }
+    return m;
+  }
+
+private:
+  // The queues are ring buffers with the length of the run.
+  struct Queue
+  {
+    int Start;
+    int Size;
+    int MinHead;
+    int MinCount;
+    int MaxHead;
+    int MaxCount;
+    bool IsActive;
+
+    int Wrap(int i) const { return (i < this->Size ? i : i - this->Size); }
+
+    void Reset()
+    {
+      this->MinHead = this->MinCount = 0;
+      this->MaxHead = this->MaxCount = 0;
+      this->IsActive = false;
+    }
+  };
+
+  std::vector<Queue> Queues;
+  std::vector<T> MinValues;
+  std::vector<T> MaxValues;
+  std::vector<int> Active;
+  int Count;
+};
+
+//----------------------------------------------------------------------------
+// Choose the window for each scalar type.  Histograms are used for the
+// 8 and 16 bit types, otherwise the window depends on whether ranks other
+// than the minimum and maximum are needed.
+template<class T>
+struct vtkImageRankWindow
+{
+  typedef vtkImageRankSortedWindow<T> Type;
+  typedef vtkImageRankExtremaWindow<T> ExtremaType;
+};
+
+#define vtkImageRankHistogramWindowMacro(T) \
+template<> struct vtkImageRankWindow<T> \
+{ \
+  typedef vtkImageRankHistogram<T> Type; \
+  typedef vtkImageRankHistogram<T> ExtremaType; \
+}
+
+vtkImageRankHistogramWindowMacro(char);
+vtkImageRankHistogramWindowMacro(signed char);
+vtkImageRankHistogramWindowMacro(unsigned char);
+vtkImageRankHistogramWindowMacro(short);
+vtkImageRankHistogramWindowMacro(unsigned short);
+
+#undef vtkImageRankHistogramWindowMacro
+
+//----------------------------------------------------------------------------
+// The operations that give the output value from the window and the value
+// of the center voxel.
+template<class T>
+struct vtkImageRankMedian
+{
+  typedef typename vtkImageRankWindow<T>::Type WindowType;
+  typedef T OutputType;
+  template<class W>
+  T operator()(const W& window, T center) const
+  {
+    int n = window.GetCount();
+    if (n == 0)
+    {
+      return center;
+    }
+    T m = window.GetRank(n/2);
+    if (n % 2 == 0)
+    {
+      // for an even count, average the two middle values
+      T low = window.GetRank(n/2 - 1);
+      m = low + (m - low)/2;
+    }
+    return m;
+  }
+};
+
+template<class T>
+struct vtkImageRankMinimum
+{
+  typedef typename vtkImageRankWindow<T>::ExtremaType WindowType;
+  typedef T OutputType;
+  template<class W>
+  T operator()(const W& window, T center) const
+  {
+    if (window.GetCount() == 0)
+    {
+      return center;
+    }
+    T m = window.GetMinimum();
+    return (center < m ? center : m);
+  }
+};
+
+template<class T>
+struct vtkImageRankMaximum
+{
+  typedef typename vtkImageRankWindow<T>::ExtremaType WindowType;
+  typedef T OutputType;
+  template<class W>
+  T operator()(const W& window, T center) const
+  {
+    if (window.GetCount() == 0)
+    {
+      return center;
+    }
+    T m = window.GetMaximum();
+    return (center > m ? center : m);
+  }
+};
+
+template<class T>
+struct vtkImageRankRange
+{
+  typedef typename vtkImageRankWindow<T>::ExtremaType WindowType;
+  typedef float OutputType;
+  template<class W>
+  float operator()(const W& window, T center) const
+  {
+    if (window.GetCount() == 0)
+    {
+      return 0.0f;
+    }
+    T low = window.GetMinimum();
+    T high = window.GetMaximum();
+    low = (center < low ? center : low);
+    high = (center > high ? center : high);
+    return static_cast<float>(high - low);
+  }
+};
+
+//----------------------------------------------------------------------------
+// Apply a rank operation to the rows of one component of an image.
+template<class T, class TOp>
+class vtkImageRankRowFilter
+{
+public:
+  typedef typename TOp::WindowType WindowType;
+  typedef typename TOp::OutputType OutputType;
+
+  // The input pointer is for the first voxel of "extent", and the
+  // neighborhoods are clipped by "bounds".
+  vtkImageRankRowFilter(const vtkImageRankKernel *kernel, const T *inPtr,
+                        const int extent[6], const vtkIdType increments[3],
+                        const int bounds[6])
+    : Kernel(kernel), Pointer(inPtr)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      this->Extent[2*i] = extent[2*i];
+      this->Bounds[2*i] = bounds[2*i];
+      this->Bounds[2*i + 1] = bounds[2*i + 1];
+      this->Increments[i] = increments[i];
+    }
+    this->Window.Initialize(kernel);
+  }
+
+  // Compute the row of output voxels from min0 to max0 at (idx1, idx2).
+  void Execute(int min0, int max0, int idx1, int idx2,
+               OutputType *outPtr, vtkIdType outInc0)
+  {
+    // Find the runs that intersect the bounds for this row
+    this->RowOffsets.clear();
+    this->RowRuns.clear();
+    size_t numRuns = this->Kernel->Runs.size();
+    for (size_t i = 0; i < numRuns; i++)
+    {
+      const vtkImageRankKernel::Run& run = this->Kernel->Runs[i];
+      int i1 = idx1 + run.Offset1;
+      int i2 = idx2 + run.Offset2;
+      if (i1 >= this->Bounds[2] && i1 <= this->Bounds[3] &&
+          i2 >= this->Bounds[4] && i2 <= this->Bounds[5])
+      {
+        this->RowOffsets.push_back(
+          (i1 - this->Extent[2])*this->Increments[1] +
+          (i2 - this->Extent[4])*this->Increments[2]);
+        this->RowRuns.push_back(static_cast<int>(i));
+      }
+    }
+    numRuns = this->RowRuns.size();
+
+    const T *centerPtr = this->Pointer +
+      (idx1 - this->Extent[2])*this->Increments[1] +
+      (idx2 - this->Extent[4])*this->Increments[2];
+
+    for (int idx0 = min0; idx0 <= max0; idx0++)
+    {
+      for (size_t i = 0; i < numRuns; i++)
+      {
+        int r = this->RowRuns[i];
+        const vtkImageRankKernel::Run& run = this->Kernel->Runs[r];
+        const T *rowPtr = this->Pointer + this->RowOffsets[i];
+        if (idx0 == min0)
+        {
+          this->AddRange(r, rowPtr, idx0 + run.Begin0, idx0 + run.End0);
+        }
+        else
+        {
+          int j = idx0 - 1 + run.Begin0;
+          if (j >= this->Bounds[0] && j <= this->Bounds[1])
+          {
+            this->Window.Remove(r, rowPtr[(j - this->Extent[0])*
+                                          this->Increments[0]]);
+          }
+          j = idx0 + run.End0;
+          if (j >= this->Bounds[0] && j <= this->Bounds[1])
+          {
+            this->Window.Add(r, rowPtr[(j - this->Extent[0])*
+                                       this->Increments[0]]);
+          }
+        }
+      }
+      this->Window.Commit();
+
+      *outPtr = this->Operation(this->Window,
+        centerPtr[(idx0 - this->Extent[0])*this->Increments[0]]);
+      outPtr += outInc0;
+    }
+
+    // Empty the window for the next row
+    if (this->Window.NeedsRemoval())
+    {
+      for (size_t i = 0; i < numRuns; i++)
+      {
+        int r = this->RowRuns[i];
+        const vtkImageRankKernel::Run& run = this->Kernel->Runs[r];
+        this->RemoveRange(r, this->Pointer + this->RowOffsets[i],
+                          max0 + run.Begin0, max0 + run.End0);
+      }
+    }
+    this->Window.Clear();
+  }
+
+private:
+  void ClipRange(int& j0, int& j1)
+  {
+    j0 = (j0 > this->Bounds[0] ? j0 : this->Bounds[0]);
+    j1 = (j1 < this->Bounds[1] ? j1 : this->Bounds[1]);
+  }
+
+  void AddRange(int r, const T *rowPtr, int j0, int j1)
+  {
+    this->ClipRange(j0, j1);
+    for (int j = j0; j <= j1; j++)
+    {
+      this->Window.Add(r, rowPtr[(j - this->Extent[0])*this->Increments[0]]);
+    }
+  }
+
+  void RemoveRange(int r, const T *rowPtr, int j0, int j1)
+  {
+    this->ClipRange(j0, j1);
+    for (int j = j0; j <= j1; j++)
+    {
+      this->Window.Remove(r, rowPtr[(j - this->Extent[0])*this->Increments[0]]);
+    }
+  }
+
+  const vtkImageRankKernel *Kernel;
+  const T *Pointer;
+  int Extent[6];
+  int Bounds[6];
+  vtkIdType Increments[3];
+  TOp Operation;
+  WindowType Window;
+  std::vector<vtkIdType> RowOffsets;
+  std::vector<int> RowRuns;
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageRankFilterInternals.h
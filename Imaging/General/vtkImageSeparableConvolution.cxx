@@ -20,6 +20,9 @@
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkImageSeparableFilterInternals.h"
+
+#include <vector>
 
 vtkStandardNewMacro(vtkImageSeparableConvolution);
 vtkCxxSetObjectMacro(vtkImageSeparableConvolution,XKernel,vtkFloatArray);
@@ -27,64 +30,6 @@ vtkCxxSetObjectMacro(vtkImageSeparableConvolution,YKernel,vtkFloatArray);
 vtkCxxSetObjectMacro(vtkImageSeparableConvolution,ZKernel,vtkFloatArray);
 
 
-// Actually do the convolution
-static void ExecuteConvolve (float* kernel, int kernelSize, float* image, float* outImage, int imageSize )
-{
-
-  // Consider the kernel to be centered at (int) ( (kernelSize - 1 ) / 2.0 )
-
-  int center = static_cast<int>((kernelSize - 1) / 2.0);
-  int i, j, k, kStart, iStart, iEnd, count;
-
-  for ( i = 0; i < imageSize; ++i )
-  {
-    outImage[i] = 0.0;
-
-//    iStart = i - center;
-//    if ( iStart < 0 )
-//      {
-//      iStart = 0;
-//      }
-
-//    iEnd = i + center;
-//    if ( iEnd > imageSize - 1 )
-//      {
-//      iEnd = imageSize - 1;
-//      }
-
-    // Handle padding
-    iStart = i - center;
-    k = kernelSize - 1;
-    while ( iStart < 0 )
-    {
-      outImage[i] += image[0] * kernel[k];
-      ++iStart;
-      --k;
-    }
-
-    iEnd = i + center;
-    k = 0;
-    while ( iEnd > imageSize - 1 )
-    {
-      outImage[i] += image[imageSize - 1] * kernel[k];
-      ++k;
-      --iEnd;
-    }
-
-
-    kStart = center + i;
-    if ( kStart > kernelSize - 1 )
-    {
-      kStart = kernelSize - 1;
-    }
-    count = iEnd - iStart + 1;
-    for ( j = 0; j < count; ++j )
-    {
-      outImage[i] += image[j+iStart] * kernel[kStart-j];
-    }
-  }
-}
-
 // Description:
 // Overload standard modified time function. If kernel arrays are modified,
 // then this object is modified as well.
@@ -103,9 +48,9 @@ vtkMTimeType vtkImageSeparableConvolution::GetMTime()
     kTime = this->YKernel->GetMTime();
     mTime = kTime > mTime ? kTime : mTime;
   }
-  if ( this->YKernel )
+  if ( this->ZKernel )
   {
-    kTime = this->YKernel->GetMTime();
+    kTime = this->ZKernel->GetMTime();
     mTime = kTime > mTime ? kTime : mTime;
   }
   return mTime;
@@ -136,254 +81,162 @@ int vtkImageSeparableConvolution::IterativeRequestInformation(
 }
 
 //----------------------------------------------------------------------------
-// This method tells the superclass that the whole input array is needed
-// to compute any output region.
-
-int vtkImageSeparableConvolution::IterativeRequestUpdateExtent(
-  vtkInformation* input, vtkInformation* output)
-{
-  int *wholeExtent =
-    input->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT());
-
-  vtkFloatArray* KernelArray = NULL;
-  switch ( this->GetIteration() )
-  {
-    case 0:
-      KernelArray = this->GetXKernel();
-      break;
-    case 1:
-      KernelArray = this->GetYKernel();
-      break;
-    case 2:
-      KernelArray = this->GetZKernel();
-      break;
-  }
-  int kernelSize = 0;
-  if ( KernelArray )
-  {
-    kernelSize = KernelArray->GetNumberOfTuples();
-    kernelSize = static_cast<int>((kernelSize - 1) / 2.0);
-  }
-
-  int* outExt = output->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT());
-
-  // Assumes that the input update extent has been initialized to output ...
-  int inExt[6];
-  memcpy(inExt, outExt, 6 * sizeof(int));
-  inExt[this->Iteration * 2] = outExt[this->Iteration * 2] - kernelSize;
-  if ( inExt[this->Iteration * 2] < wholeExtent[this->Iteration * 2] )
-  {
-    inExt[this->Iteration * 2] = wholeExtent[this->Iteration * 2];
-  }
-
-  inExt[this->Iteration * 2 + 1] =
-    outExt[this->Iteration * 2 + 1] + kernelSize;
-  if ( inExt[this->Iteration * 2 + 1] > wholeExtent[this->Iteration * 2 + 1] )
-  {
-    inExt[this->Iteration * 2 + 1] = wholeExtent[this->Iteration * 2 + 1];
-  }
-
-  input->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),inExt,6);
-
-  return 1;
-}
-
-template <class T>
-void vtkImageSeparableConvolutionExecute ( vtkImageSeparableConvolution* self,
-                                           vtkImageData* inData,
-                                           vtkImageData* outData,
-                                           T* vtkNotUsed ( dummy ),
-                                           int* inExt,
-                                           int* outExt)
+// The input must be expanded by half of the kernel size along each axis.
+int vtkImageSeparableConvolution::RequestUpdateExtent(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
 {
-  T *inPtr0, *inPtr1, *inPtr2;
-  float *outPtr0, *outPtr1, *outPtr2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  int inMin0, inMax0, inMin1, inMax1, inMin2, inMax2;
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int idx0, idx1, idx2;
-  int i;
-  unsigned long count = 0;
-  unsigned long target;
-
-  // Reorder axes (the in and out extents are assumed to be the same)
-  // (see intercept cache update)
-  self->PermuteExtent(outExt, outMin0, outMax0, outMin1, outMax1, outMin2, outMax2);
-  self->PermuteExtent(inExt, inMin0, inMax0, inMin1, inMax1, inMin2, inMax2);
-  self->PermuteIncrements(inData->GetIncrements(), inInc0, inInc1, inInc2);
-  self->PermuteIncrements(outData->GetIncrements(), outInc0, outInc1, outInc2);
-
-  target = static_cast<unsigned long>(
-    (inMax2-inMin2+1)*(inMax1-inMin1+1)/50.0);
-  target++;
-
-  vtkFloatArray* KernelArray = NULL;
-  switch ( self->GetIteration() )
-  {
-    case 0:
-      KernelArray = self->GetXKernel();
-      break;
-    case 1:
-      KernelArray = self->GetYKernel();
-      break;
-    case 2:
-      KernelArray = self->GetZKernel();
-      break;
-  }
-  int kernelSize = 0;
-  float* kernel = NULL;
-
-  if ( KernelArray )
-  {
-    // Allocate the arrays
-    kernelSize = KernelArray->GetNumberOfTuples();
-    kernel = new float[kernelSize];
-    // Copy the kernel
-    for ( i = 0; i < kernelSize; i++ )
-    {
-      kernel[i] = KernelArray->GetValue ( i );
-    }
-  }
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
 
-  int imageSize = inMax0 + 1;
-  float* image = new float[imageSize];
-  float* outImage = new float[imageSize];
-  float* imagePtr;
+  int wholeExtent[6], inExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
 
+  vtkFloatArray* kernels[3] = {
+    this->XKernel, this->YKernel, this->ZKernel };
 
-  // loop over all the extra axes
-  inPtr2 = static_cast<T *>(inData->GetScalarPointerForExtent(inExt));
-  outPtr2 = static_cast<float *>(outData->GetScalarPointerForExtent(outExt));
-  for (idx2 = inMin2; idx2 <= inMax2; ++idx2)
+  for (int axis = 0; axis < this->Dimensionality && axis < 3; axis++)
   {
-    inPtr1 = inPtr2;
-    outPtr1 = outPtr2;
-    for (idx1 = inMin1; !self->AbortExecute && idx1 <= inMax1; ++idx1)
+    if (kernels[axis])
     {
-      if (!(count%target))
-      {
-        self->UpdateProgress(count/(50.0*target));
-      }
-      count++;
-      inPtr0 = inPtr1;
-      imagePtr = image;
-      for (idx0 = inMin0; idx0 <= inMax0; ++idx0)
-      {
-        *imagePtr = static_cast<float>(*inPtr0);
-        inPtr0 += inInc0;
-        ++imagePtr;
-      }
+      int kernelSize = kernels[axis]->GetNumberOfTuples();
+      kernelSize = static_cast<int>((kernelSize - 1) / 2.0);
 
-      // Call the method that performs the convolution
-      if ( kernel )
-      {
-        ExecuteConvolve ( kernel, kernelSize, image, outImage, imageSize );
-        imagePtr = outImage;
-      }
-      else
+      inExt[axis*2] -= kernelSize;
+      if ( inExt[axis*2] < wholeExtent[axis*2] )
       {
-        // If we don't have a kernel, just copy to the output
-        imagePtr = image;
+        inExt[axis*2] = wholeExtent[axis*2];
       }
 
-      // Copy to output, be aware that we only copy to the extent that was asked for
-      outPtr0 = outPtr1;
-      imagePtr = imagePtr + (outMin0 - inMin0);
-      for (idx0 = outMin0; idx0 <= outMax0; ++idx0)
+      inExt[axis*2 + 1] += kernelSize;
+      if ( inExt[axis*2 + 1] > wholeExtent[axis*2 + 1] )
       {
-        *outPtr0 = (*imagePtr);
-        outPtr0 += outInc0;
-        ++imagePtr;
+        inExt[axis*2 + 1] = wholeExtent[axis*2 + 1];
       }
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
     }
-    inPtr2 += inInc2;
-    outPtr2 += outInc2;
   }
 
-  delete [] image;
-  delete [] outImage;
-  delete [] kernel;
-}
-
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),inExt,6);
 
+  return 1;
+}
 
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageSeparableConvolutionExecute ( vtkImageSeparableConvolution* self,
+                                           const vtkImageSeparableKernel kernels[3],
+                                           vtkImageData* inData, T* inPtr,
+                                           vtkImageData* outData, float* outPtr,
+                                           int* outExt, int id)
+{
+  vtkIdType inIncs[3], outIncs[3];
+  inData->GetIncrements(inIncs);
+  outData->GetIncrements(outIncs);
+
+  vtkImageSeparableFilter<float> filter(kernels);
+  filter.SetAlgorithm(self, (id == 0));
+  filter.Execute(inPtr, inData->GetExtent(), inIncs,
+                 outPtr, outExt, outIncs, false);
+}
 
 //----------------------------------------------------------------------------
-// This is written as a 1D execute method, but is called several times.
-int vtkImageSeparableConvolution::IterativeRequestData(
-  vtkInformation* vtkNotUsed( request ),
+int vtkImageSeparableConvolution::RequestData(
+  vtkInformation* request,
   vtkInformationVector** inputVector,
   vtkInformationVector* outputVector)
 {
-  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
-  vtkImageData *inData = vtkImageData::SafeDownCast(
-    inInfo->Get(vtkDataObject::DATA_OBJECT()));
-  vtkInformation *outInfo = outputVector->GetInformationObject(0);
-  vtkImageData *outData = vtkImageData::SafeDownCast(
-    outInfo->Get(vtkDataObject::DATA_OBJECT()));
-
-  outData->SetExtent(outInfo->Get(
-                       vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()));
-  outData->AllocateScalars(outInfo);
+  vtkFloatArray* kernels[3] = {
+    this->XKernel, this->YKernel, this->ZKernel };
+  const char *names[3] = { "XKernel", "YKernel", "ZKernel" };
 
-  if ( XKernel )
-  {
-    // Check for a filter of odd length
-    if ( 1 - ( XKernel->GetNumberOfTuples() % 2 ) )
-    {
-      vtkErrorMacro ( << "Execute:  XKernel must have odd length" );
-      return 1;
-    }
-  }
-  if ( YKernel )
+  for (int axis = 0; axis < 3; axis++)
   {
     // Check for a filter of odd length
-    if ( 1 - ( YKernel->GetNumberOfTuples() % 2 ) )
+    if ( kernels[axis] && 1 - ( kernels[axis]->GetNumberOfTuples() % 2 ) )
     {
-      vtkErrorMacro ( << "Execute:  YKernel must have odd length" );
-      return 1;
-    }
-  }
-  if ( ZKernel )
-  {
-    // Check for a filter of odd length
-    if ( 1 - ( ZKernel->GetNumberOfTuples() % 2 ) )
-    {
-      vtkErrorMacro ( << "Execute:  ZKernel must have odd length" );
+      vtkErrorMacro ( << "Execute:  " << names[axis]
+                      << " must have odd length" );
       return 1;
     }
   }
 
+  vtkImageData *inData = vtkImageData::GetData(inputVector[0]);
   if (inData->GetNumberOfScalarComponents() != 1)
   {
     vtkErrorMacro(<< "ImageSeparableConvolution only works on 1 component input for the moment.");
     return 1;
   }
 
+  // Skip the per-axis iterations of the superclass
+  return this->vtkThreadedImageAlgorithm::RequestData(
+    request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+// Convolve a block of the image along all three axes.
+void vtkImageSeparableConvolution::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *vtkNotUsed(outputVector),
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int outExt[6], int id)
+{
   // this filter expects that the output be floats.
-  if (outData->GetScalarType() != VTK_FLOAT)
+  if (outData[0]->GetScalarType() != VTK_FLOAT)
   {
     vtkErrorMacro(<< "Execute: Output must be be type float.");
-    return 1;
+    return;
   }
 
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  int wholeExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+
+  // The kernels are applied as convolutions (not correlations), and
+  // the edges of the image are replicated
+  vtkFloatArray* kernelArrays[3] = {
+    this->XKernel, this->YKernel, this->ZKernel };
+  vtkImageSeparableKernel kernels[3];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    int outMin = outExt[2*axis];
+    int outMax = outExt[2*axis + 1];
+    vtkFloatArray *kernelArray = kernelArrays[axis];
+    if (axis >= this->Dimensionality || !kernelArray)
+    {
+      kernels[axis].SetIdentity(outMin, outMax);
+      continue;
+    }
+    int kernelSize = kernelArray->GetNumberOfTuples();
+    std::vector<double> kernel(kernelSize);
+    for (int i = 0; i < kernelSize; i++)
+    {
+      kernel[i] = kernelArray->GetValue(kernelSize - i - 1);
+    }
+    kernels[axis].SetKernel(&kernel[0], kernelSize, (kernelSize - 1)/2,
+                            outMin, outMax,
+                            wholeExt[2*axis], wholeExt[2*axis + 1],
+                            vtkImageSeparableKernel::Replicate);
+  }
+
+  void *inPtr = inData[0][0]->GetScalarPointer();
+  float *outPtr = static_cast<float *>(
+    outData[0]->GetScalarPointerForExtent(outExt));
+
   // choose which templated function to call.
-  switch (inData->GetScalarType())
+  switch (inData[0][0]->GetScalarType())
   {
     vtkTemplateMacro(
       vtkImageSeparableConvolutionExecute(
-        this, inData, outData, static_cast<VTK_TT*>(0),
-        inInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT()),
-        outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT())));
+        this, kernels, inData[0][0], static_cast<VTK_TT*>(inPtr),
+        outData[0], outPtr, outExt, id));
     default:
       vtkErrorMacro(<< "Execute: Unknown ScalarType");
-      return 1;
+      return;
   }
-
-  return 1;
 }
 
 void vtkImageSeparableConvolution::PrintSelf(ostream& os, vtkIndent indent)
@@ -23,7 +23,8 @@
  * that dimension is skipped.  This filter is designed to efficiently
  * convolve separable filters that can be decomposed into 1 or more 1D
  * convolutions.  It also handles arbitrarly large kernel sizes, and
- * uses edge replication to handle boundaries.
+ * uses edge replication to handle boundaries.  The three convolutions
+ * are done in a single multi-threaded sweep through the data.
 */
 
 #ifndef vtkImageSeparableConvolution_h
@@ -73,14 +74,21 @@ protected:
   vtkFloatArray* YKernel;
   vtkFloatArray* ZKernel;
 
-  int IterativeRequestData(vtkInformation*,
-                                   vtkInformationVector**,
-                                   vtkInformationVector*) VTK_OVERRIDE;
-
   int IterativeRequestInformation(vtkInformation* in,
                                           vtkInformation* out) VTK_OVERRIDE;
-  int IterativeRequestUpdateExtent(vtkInformation* in,
-                                           vtkInformation* out) VTK_OVERRIDE;
+
+  // All axes are convolved in one pass, instead of one iteration per axis.
+  int RequestUpdateExtent(vtkInformation*,
+                          vtkInformationVector**,
+                          vtkInformationVector*) VTK_OVERRIDE;
+  int RequestData(vtkInformation*,
+                  vtkInformationVector**,
+                  vtkInformationVector*) VTK_OVERRIDE;
+  void ThreadedRequestData(vtkInformation *request,
+                           vtkInformationVector **inputVector,
+                           vtkInformationVector *outputVector,
+                           vtkImageData ***inData, vtkImageData **outData,
+                           int outExt[6], int id) VTK_OVERRIDE;
 
 private:
   vtkImageSeparableConvolution(const vtkImageSeparableConvolution&) VTK_DELETE_FUNCTION;
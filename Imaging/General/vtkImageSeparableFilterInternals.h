@@ -0,0 +1,727 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageSeparableFilterInternals.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkImageSeparableFilterInternals
+ * @brief   fused separable filtering of image blocks
+ *
+ * These templates apply a separable filter, i.e. one 1D filter along each
+ * axis, to a block of an image in a single sweep.  The Z filter is applied
+ * while the input rows are read, the Y filter combines a small ring of these
+ * rows, and the X filter is applied to each row just before it is written,
+ * so the intermediate results never leave a few rows of working memory.
+ * The inner loops run along contiguous rows of the working type so that the
+ * compiler can vectorize them.
+ *
+ * The 1D filters store the weights for each output sample, so that the
+ * handling of the image boundary (replication or renormalization) is folded
+ * into the weights instead of being checked in the inner loops.
+ *
+ * The recursive gaussian of Young and van Vliet, with the boundary
+ * conditions of Triggs and Sdika, is also provided for filters whose cost
+ * must not depend on the standard deviation.
+ *
+ * This is used by vtkImageGaussianSmooth, vtkImageSeparableConvolution,
+ * vtkImageGradient and vtkImageSobel3D.
+*/
+
+#ifndef vtkImageSeparableFilterInternals_h
+#define vtkImageSeparableFilterInternals_h
+
+#include "vtkAlgorithm.h"
+
+#include <cmath>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// A 1D filter along one axis, with the weights for each output sample.
+class vtkImageSeparableKernel
+{
+public:
+  enum BoundaryEnum
+  {
+    Replicate = 0,
+    Renormalize = 1
+  };
+
+  vtkImageSeparableKernel()
+  {
+    this->SetIdentity(0, -1);
+  }
+
+  // Pass the input through unchanged.
+  void SetIdentity(int outMin, int outMax)
+  {
+    int n = (outMax >= outMin ? outMax - outMin + 1 : 0);
+    this->Identity = true;
+    this->InputMin = outMin;
+    this->InputMax = outMax;
+    this->MaxSize = 1;
+    this->InteriorBegin = 0;
+    this->InteriorEnd = n;
+    this->Weights.assign(1, 1.0);
+    this->Starts.resize(n);
+    this->Sizes.assign(n, 1);
+    this->Offsets.assign(n, 0);
+    for (int i = 0; i < n; i++)
+    {
+      this->Starts[i] = outMin + i;
+    }
+  }
+
+  // Set the weights, where kernel[middle] is applied to the input sample at
+  // the position of the output sample.  Samples outside of the bounds are
+  // either replicated from the nearest bound, or dropped.  With
+  // Renormalize, the weights of each output sample are divided by their
+  // sum, as if the kernel had been normalized over the samples it uses.
+  void SetKernel(const double *kernel, int size, int middle,
+                 int outMin, int outMax, int boundMin, int boundMax,
+                 int boundary)
+  {
+    int n = (outMax >= outMin ? outMax - outMin + 1 : 0);
+    this->Identity = false;
+    this->Starts.resize(n);
+    this->Sizes.resize(n);
+    this->Offsets.resize(n);
+    this->InputMin = VTK_INT_MAX;
+    this->InputMax = VTK_INT_MIN;
+    this->MaxSize = 0;
+    this->InteriorBegin = n;
+    this->InteriorEnd = n;
+
+    double total = 0.0;
+    for (int k = 0; k < size; k++)
+    {
+      total += kernel[k];
+    }
+    this->Weights.assign(kernel, kernel + size);
+    if (boundary == Renormalize && total != 0.0)
+    {
+      for (int k = 0; k < size; k++)
+      {
+        this->Weights[k] /= total;
+      }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+      int first = outMin + i - middle;
+      int last = first + size - 1;
+      int start = first;
+      int count = size;
+      int offset = 0;
+
+      if (first < boundMin || last > boundMax)
+      {
+        // the kernel crosses the boundary, so it needs its own weights
+        int lo = (first > boundMin ? first : boundMin);
+        int hi = (last < boundMax ? last : boundMax);
+        if (boundary == Replicate)
+        {
+          lo = (lo < boundMax ? lo : boundMax);
+          hi = (hi > boundMin ? hi : boundMin);
+        }
+        offset = static_cast<int>(this->Weights.size());
+        start = lo;
+        count = (hi >= lo ? hi - lo + 1 : 0);
+        this->Weights.resize(offset + count, 0.0);
+        double *weights = &this->Weights[offset];
+        double sum = 0.0;
+        for (int k = 0; k < size; k++)
+        {
+          int j = first + k;
+          if (boundary == Replicate)
+          {
+            j = (j > boundMin ? j : boundMin);
+            j = (j < boundMax ? j : boundMax);
+          }
+          if (j >= lo && j <= hi)
+          {
+            weights[j - lo] += kernel[k];
+            sum += kernel[k];
+          }
+        }
+        if (boundary == Renormalize && sum != 0.0)
+        {
+          for (int k = 0; k < count; k++)
+          {
+            weights[k] /= sum;
+          }
+        }
+      }
+      else
+      {
+        // keep track of the samples that use the full kernel
+        if (this->InteriorBegin == n)
+        {
+          this->InteriorBegin = i;
+        }
+        this->InteriorEnd = i + 1;
+      }
+
+      this->Starts[i] = start;
+      this->Sizes[i] = count;
+      this->Offsets[i] = offset;
+      if (count > 0)
+      {
+        this->InputMin = (start < this->InputMin ? start : this->InputMin);
+        this->InputMax = (start + count - 1 > this->InputMax ?
+                          start + count - 1 : this->InputMax);
+      }
+      this->MaxSize = (count > this->MaxSize ? count : this->MaxSize);
+    }
+
+    if (this->InputMin > this->InputMax)
+    {
+      this->InputMin = outMin;
+      this->InputMax = outMin - 1;
+    }
+  }
+
+  bool IsIdentity() const { return this->Identity; }
+
+  // The range of input samples used by the filter.
+  int GetInputMin() const { return this->InputMin; }
+  int GetInputMax() const { return this->InputMax; }
+
+  // The largest number of weights used for an output sample.
+  int GetMaxSize() const { return this->MaxSize; }
+
+  // The first input sample, the number of weights, and the weights for
+  // output sample "i", counted from the first output sample.
+  int GetStart(int i) const { return this->Starts[i]; }
+  int GetSize(int i) const { return this->Sizes[i]; }
+  const double *GetWeights(int i) const
+  {
+    return &this->Weights[this->Offsets[i]];
+  }
+
+  // The output samples that use the full kernel, counted from the
+  // first output sample.
+  int GetInteriorBegin() const { return this->InteriorBegin; }
+  int GetInteriorEnd() const { return this->InteriorEnd; }
+
+private:
+  bool Identity;
+  int InputMin;
+  int InputMax;
+  int MaxSize;
+  int InteriorBegin;
+  int InteriorEnd;
+  std::vector<double> Weights;
+  std::vector<int> Starts;
+  std::vector<int> Sizes;
+  std::vector<int> Offsets;
+};
+
+//----------------------------------------------------------------------------
+// Helpers for the inner loops, the contiguous case is separated so that
+// it can be vectorized.
+template<class W, class T>
+void vtkImageSeparableFilterLoad(
+  W *row, const T *inPtr, vtkIdType inc, int n, W weight, bool first)
+{
+  if (inc == 1)
+  {
+    if (first)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        row[i] = weight*static_cast<W>(inPtr[i]);
+      }
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        row[i] += weight*static_cast<W>(inPtr[i]);
+      }
+    }
+  }
+  else
+  {
+    if (first)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        row[i] = weight*static_cast<W>(inPtr[i*inc]);
+      }
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        row[i] += weight*static_cast<W>(inPtr[i*inc]);
+      }
+    }
+  }
+}
+
+template<class W>
+void vtkImageSeparableFilterAxpy(
+  W *row, const W *inPtr, int n, W weight, bool first)
+{
+  if (first)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      row[i] = weight*inPtr[i];
+    }
+  }
+  else
+  {
+    for (int i = 0; i < n; i++)
+    {
+      row[i] += weight*inPtr[i];
+    }
+  }
+}
+
+// Convert a row to the type T and back, as if it had been stored in an
+// image of that type.
+template<class T, class W>
+void vtkImageSeparableFilterConvert(W *row, int n)
+{
+  for (int i = 0; i < n; i++)
+  {
+    row[i] = static_cast<W>(static_cast<T>(row[i]));
+  }
+}
+
+template<class W, class T>
+void vtkImageSeparableFilterStore(
+  T *outPtr, vtkIdType inc, const W *row, int n, bool accumulate)
+{
+  if (accumulate)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      outPtr[i*inc] += static_cast<T>(row[i]);
+    }
+  }
+  else if (inc == 1)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      outPtr[i] = static_cast<T>(row[i]);
+    }
+  }
+  else
+  {
+    for (int i = 0; i < n; i++)
+    {
+      outPtr[i*inc] = static_cast<T>(row[i]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Apply the three filters to one component of a block.  The computation is
+// done in the working type W, and the result is converted to the output
+// type (or added to the output, for filters that are a sum of separable
+// terms).
+template<class W>
+class vtkImageSeparableFilter
+{
+public:
+  vtkImageSeparableFilter(const vtkImageSeparableKernel kernels[3])
+    : Kernels(kernels), Algorithm(0), ReportProgress(false),
+      ConvertIntermediates(false) {}
+
+  // Check AbortExecute on the algorithm, and report the progress if
+  // requested (this should only be done by one of the threads).
+  void SetAlgorithm(vtkAlgorithm *algorithm, bool reportProgress)
+  {
+    this->Algorithm = algorithm;
+    this->ReportProgress = reportProgress;
+  }
+
+  // Convert the results of the Z and Y filters to the output type, as
+  // filters that store each pass in an image of that type do.
+  void SetConvertIntermediates(bool convert)
+  {
+    this->ConvertIntermediates = convert;
+  }
+
+  // The pointers are to the first sample of the given extents, and the
+  // output extent must be the one used for the kernels.
+  template<class TIn, class TOut>
+  void Execute(const TIn *inPtr, const int inExt[6], const vtkIdType inInc[3],
+               TOut *outPtr, const int outExt[6], const vtkIdType outInc[3],
+               bool accumulate);
+
+private:
+  void FilterRow(W *outRow, const W *inRow, int n) const;
+
+  const vtkImageSeparableKernel *Kernels;
+  vtkAlgorithm *Algorithm;
+  bool ReportProgress;
+  bool ConvertIntermediates;
+};
+
+//----------------------------------------------------------------------------
+template<class W>
+void vtkImageSeparableFilter<W>::FilterRow(
+  W *outRow, const W *inRow, int n) const
+{
+  const vtkImageSeparableKernel& kernel = this->Kernels[0];
+  int inMin = kernel.GetInputMin();
+  int begin = kernel.GetInteriorBegin();
+  int end = kernel.GetInteriorEnd();
+
+  // the samples near the boundary have their own weights
+  for (int i = 0; i < n; i++)
+  {
+    if (i == begin)
+    {
+      i = end;
+      if (i >= n)
+      {
+        break;
+      }
+    }
+    const double *weights = kernel.GetWeights(i);
+    const W *inPtr = inRow + (kernel.GetStart(i) - inMin);
+    W sum = 0;
+    for (int k = 0; k < kernel.GetSize(i); k++)
+    {
+      sum += static_cast<W>(weights[k])*inPtr[k];
+    }
+    outRow[i] = sum;
+  }
+
+  // the interior samples all use the same weights
+  if (begin < end)
+  {
+    const double *weights = kernel.GetWeights(begin);
+    const W *inPtr = inRow + (kernel.GetStart(begin) - inMin);
+    for (int k = 0; k < kernel.GetSize(begin); k++)
+    {
+      vtkImageSeparableFilterAxpy(outRow + begin, inPtr + k, end - begin,
+                                  static_cast<W>(weights[k]), (k == 0));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template<class W>
+template<class TIn, class TOut>
+void vtkImageSeparableFilter<W>::Execute(
+  const TIn *inPtr, const int inExt[6], const vtkIdType inInc[3],
+  TOut *outPtr, const int outExt[6], const vtkIdType outInc[3],
+  bool accumulate)
+{
+  const vtkImageSeparableKernel& kernelX = this->Kernels[0];
+  const vtkImageSeparableKernel& kernelY = this->Kernels[1];
+  const vtkImageSeparableKernel& kernelZ = this->Kernels[2];
+
+  int nx = outExt[1] - outExt[0] + 1;
+  int ny = outExt[3] - outExt[2] + 1;
+  int nz = outExt[5] - outExt[4] + 1;
+  int inMinX = kernelX.GetInputMin();
+  int inMinY = kernelY.GetInputMin();
+  int nxIn = kernelX.GetInputMax() - inMinX + 1;
+  if (nx <= 0 || ny <= 0 || nz <= 0 || nxIn <= 0)
+  {
+    return;
+  }
+
+  // a ring of rows filtered along Z, then rows filtered along Y and X
+  int ringSize = kernelY.GetMaxSize();
+  ringSize = (ringSize > 0 ? ringSize : 1);
+  std::vector<W> buffer((ringSize + 2)*static_cast<size_t>(nxIn));
+  W *ring = &buffer[0];
+  W *rowY = ring + ringSize*static_cast<size_t>(nxIn);
+  W *rowX = rowY + nxIn;
+
+  const TIn *inPtrX = inPtr + (inMinX - inExt[0])*inInc[0];
+
+  vtkIdType target = static_cast<vtkIdType>(ny)*nz/50 + 1;
+  vtkIdType count = 0;
+
+  for (int iz = 0; iz < nz; iz++)
+  {
+    int startZ = kernelZ.GetStart(iz);
+    int sizeZ = kernelZ.GetSize(iz);
+    const double *weightsZ = kernelZ.GetWeights(iz);
+    int nextY = inMinY;
+
+    for (int iy = 0; iy < ny; iy++)
+    {
+      if (this->Algorithm)
+      {
+        if (this->Algorithm->AbortExecute)
+        {
+          return;
+        }
+        if (this->ReportProgress && (count % target) == 0)
+        {
+          this->Algorithm->UpdateProgress(count/(50.0*target));
+        }
+        count++;
+      }
+
+      int startY = kernelY.GetStart(iy);
+      int sizeY = kernelY.GetSize(iy);
+      const double *weightsY = kernelY.GetWeights(iy);
+
+      // read the input rows that are needed, filtering along Z
+      int endY = startY + sizeY;
+      for (int y = (nextY > startY ? nextY : startY); y < endY; y++)
+      {
+        W *row = ring + ((y - inMinY) % ringSize)*static_cast<size_t>(nxIn);
+        const TIn *inPtrZ = inPtrX + (y - inExt[2])*inInc[1] +
+                            (startZ - inExt[4])*inInc[2];
+        for (int k = 0; k < sizeZ; k++)
+        {
+          vtkImageSeparableFilterLoad(row, inPtrZ, inInc[0], nxIn,
+                                      static_cast<W>(weightsZ[k]), (k == 0));
+          inPtrZ += inInc[2];
+        }
+        if (sizeZ == 0)
+        {
+          vtkImageSeparableFilterLoad(row, inPtrZ, inInc[0], nxIn,
+                                      static_cast<W>(0), true);
+        }
+        if (this->ConvertIntermediates && !kernelZ.IsIdentity())
+        {
+          vtkImageSeparableFilterConvert<TOut>(row, nxIn);
+        }
+      }
+      nextY = (endY > nextY ? endY : nextY);
+
+      // filter along Y
+      const W *filteredY = rowY;
+      if (kernelY.IsIdentity())
+      {
+        filteredY = ring + ((startY - inMinY) % ringSize)*
+                           static_cast<size_t>(nxIn);
+      }
+      else
+      {
+        for (int k = 0; k < sizeY; k++)
+        {
+          const W *row = ring + ((startY + k - inMinY) % ringSize)*
+                                static_cast<size_t>(nxIn);
+          vtkImageSeparableFilterAxpy(rowY, row, nxIn,
+                                      static_cast<W>(weightsY[k]), (k == 0));
+        }
+        if (sizeY == 0)
+        {
+          vtkImageSeparableFilterAxpy(rowY, ring, nxIn,
+                                      static_cast<W>(0), true);
+        }
+        if (this->ConvertIntermediates)
+        {
+          vtkImageSeparableFilterConvert<TOut>(rowY, nxIn);
+        }
+      }
+
+      // filter along X
+      const W *filteredX = filteredY;
+      if (!kernelX.IsIdentity())
+      {
+        this->FilterRow(rowX, filteredY, nx);
+        filteredX = rowX;
+      }
+
+      vtkImageSeparableFilterStore(
+        outPtr + iy*outInc[1] + iz*outInc[2], outInc[0], filteredX, nx,
+        accumulate);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// The third-order recursive gaussian of Young and van Vliet, "Recursive
+// implementation of the Gaussian filter", Signal Processing 44:139-151,
+// 1995, with the poles of van Vliet, Young and Verbeek, "Recursive Gaussian
+// derivative filters", ICPR 1998, and with the
+// boundary conditions of Triggs and Sdika, "Boundary conditions for
+// Young-van Vliet recursive filtering", IEEE Trans. Signal Processing
+// 54:2365-2367, 2006, which give the same result as replicating the
+// boundary samples to infinity.
+class vtkImageRecursiveGaussian
+{
+public:
+  vtkImageRecursiveGaussian()
+  {
+    this->SetStandardDeviation(0.0);
+  }
+
+  // A standard deviation of zero leaves the data unchanged.
+  void SetStandardDeviation(double sigma)
+  {
+    this->Identity = (sigma <= 0.0);
+
+    // The poles are scaled by the parameter q, which is found by bisection
+    // such that the variance of the filter is exactly sigma^2.
+    double qmin = 0.0;
+    double qmax = 2.0*sigma + 2.0;
+    for (int i = 0; i < 64; i++)
+    {
+      double q = 0.5*(qmin + qmax);
+      double c[3];
+      vtkImageRecursiveGaussian::ComputeCoefficients(q, c);
+      // the variance of the causal filter, from its cumulants
+      double b = 1.0 - (c[0] + c[1] + c[2]);
+      double d1 = c[0] + 2.0*c[1] + 3.0*c[2];
+      double d2 = 2.0*c[1] + 6.0*c[2];
+      double var = (d1 + d2)/b + (d1/b)*(d1/b);
+      if (2.0*var < sigma*sigma)
+      {
+        qmin = q;
+      }
+      else
+      {
+        qmax = q;
+      }
+    }
+
+    double c[3];
+    vtkImageRecursiveGaussian::ComputeCoefficients(0.5*(qmin + qmax), c);
+    double a1 = c[0];
+    double a2 = c[1];
+    double a3 = c[2];
+    double b = 1.0 - (a1 + a2 + a3);
+
+    this->A[0] = a1;
+    this->A[1] = a2;
+    this->A[2] = a3;
+    this->B = b;
+
+    // the matrix of Triggs and Sdika, scaled for the normalized filter
+    double s = b/((1.0 + a1 - a2 + a3)*(1.0 - a1 - a2 - a3)*
+                  (1.0 + a2 + (a1 - a3)*a3));
+    double *m = this->M;
+    m[0] = s*(-a3*a1 + 1.0 - a3*a3 - a2);
+    m[1] = s*(a3 + a1)*(a2 + a3*a1);
+    m[2] = s*a3*(a1 + a3*a2);
+    m[3] = s*(a1 + a3*a2);
+    m[4] = -s*(a2 - 1.0)*(a2 + a3*a1);
+    m[5] = -s*a3*(a3*a1 + a3*a3 + a2 - 1.0);
+    m[6] = s*(a3*a1 + a2 + a1*a1 - a2*a2);
+    m[7] = s*(a1*a2 + a3*a2*a2 - a1*a3*a3 - a3*a3*a3 - a3*a2 + a3);
+    m[8] = s*a3*(a1 + a3*a2);
+  }
+
+  bool IsIdentity() const { return this->Identity; }
+
+  // Filter "lanes" lines of length "n" in place.  The lines are interleaved,
+  // with sample "j" of line "l" at data[j*step + l], so the loops over the
+  // lines can be vectorized.  The work space must hold 4*lanes values.
+  template<class W>
+  void Filter(W *data, int n, vtkIdType step, int lanes, W *work) const;
+
+private:
+  // The coefficients of the causal filter for the parameter q, from the
+  // poles d = 1.40098 +/- 1.00236i and d = 1.85132 raised to the power 1/q.
+  static void ComputeCoefficients(double q, double c[3])
+  {
+    double r = pow(1.40098*1.40098 + 1.00236*1.00236, -0.5/q);
+    double theta = atan2(1.00236, 1.40098)/q;
+    double re = r*cos(theta);
+    double r3 = pow(1.85132, -1.0/q);
+    c[0] = 2.0*re + r3;
+    c[1] = -(r*r + 2.0*re*r3);
+    c[2] = r*r*r3;
+  }
+
+  bool Identity;
+  double A[3];
+  double B;
+  double M[9];
+};
+
+//----------------------------------------------------------------------------
+template<class W>
+void vtkImageRecursiveGaussian::Filter(
+  W *data, int n, vtkIdType step, int lanes, W *work) const
+{
+  if (this->Identity || n <= 1)
+  {
+    return;
+  }
+
+  const W a1 = static_cast<W>(this->A[0]);
+  const W a2 = static_cast<W>(this->A[1]);
+  const W a3 = static_cast<W>(this->A[2]);
+  const W b = static_cast<W>(this->B);
+
+  // the first and last samples, which are replicated beyond the ends
+  W *first = work;
+  W *last = work + lanes;
+  W *next1 = work + 2*lanes;
+  W *next2 = work + 3*lanes;
+  for (int l = 0; l < lanes; l++)
+  {
+    first[l] = data[l];
+    last[l] = data[(n - 1)*step + l];
+  }
+
+  // causal pass, starting from the steady state for the first sample
+  for (int j = 0; j < n; j++)
+  {
+    W *d = data + j*step;
+    const W *d1 = (j >= 1 ? d - step : first);
+    const W *d2 = (j >= 2 ? d - 2*step : first);
+    const W *d3 = (j >= 3 ? d - 3*step : first);
+    for (int l = 0; l < lanes; l++)
+    {
+      d[l] = b*d[l] + a1*d1[l] + a2*d2[l] + a3*d3[l];
+    }
+  }
+
+  // initialize the anti-causal pass from the last three causal outputs
+  {
+    W *d = data + (n - 1)*step;
+    const W *d1 = d - step;
+    const W *d2 = (n >= 3 ? d - 2*step : first);
+    const W m0 = static_cast<W>(this->M[0]);
+    const W m1 = static_cast<W>(this->M[1]);
+    const W m2 = static_cast<W>(this->M[2]);
+    const W m3 = static_cast<W>(this->M[3]);
+    const W m4 = static_cast<W>(this->M[4]);
+    const W m5 = static_cast<W>(this->M[5]);
+    const W m6 = static_cast<W>(this->M[6]);
+    const W m7 = static_cast<W>(this->M[7]);
+    const W m8 = static_cast<W>(this->M[8]);
+    for (int l = 0; l < lanes; l++)
+    {
+      W u = last[l];
+      W e0 = d[l] - u;
+      W e1 = d1[l] - u;
+      W e2 = d2[l] - u;
+      d[l] = m0*e0 + m1*e1 + m2*e2 + u;
+      next1[l] = m3*e0 + m4*e1 + m5*e2 + u;
+      next2[l] = m6*e0 + m7*e1 + m8*e2 + u;
+    }
+  }
+
+  // anti-causal pass
+  for (int j = n - 2; j >= 0; j--)
+  {
+    W *d = data + j*step;
+    const W *d1 = d + step;
+    const W *d2 = (j + 2 < n ? d + 2*step : next1);
+    const W *d3 = (j + 3 < n ? d + 3*step : (j + 3 == n ? next1 : next2));
+    for (int l = 0; l < lanes; l++)
+    {
+      d[l] = b*d[l] + a1*d1[l] + a2*d2[l] + a3*d3[l];
+    }
+  }
+}
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageSeparableFilterInternals.h
@@ -19,6 +19,7 @@
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkImageSeparableFilterInternals.h"
 
 #include <cmath>
 
@@ -59,143 +60,59 @@ int vtkImageSobel3D::RequestInformation (vtkInformation *request,
 // This execute method handles boundaries.
 // it handles boundaries. Pixels are just replicated to get values
 // out of extent.
+// Each component is a derivative along one axis, smoothed over the other
+// two axes with weights of 2 at the center, 1 at the edges and 0.586 at
+// the corners.  This is the sum of two separable filters: the product of
+// [0.707, 1.414, 0.707] along both axes, and the product of [1, 0, 1] and
+// [0.086, 0, 0.086] which adds the rest of the corner weights.
 template <class T>
 void vtkImageSobel3DExecute(vtkImageSobel3D *self,
                             vtkImageData *inData, T *inPtr,
                             vtkImageData *outData, int *outExt,
                             double *outPtr, int id, vtkInformation *inInfo)
 {
-  double r0, r1, r2, *r;
-  // For looping though output (and input) pixels.
-  int min0, max0, min1, max1, min2, max2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType outInc0, outInc1, outInc2;
-  double *outPtr0, *outPtr1, *outPtr2, *outPtrV;
-  vtkIdType inInc0, inInc1, inInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  // For sobel function convolution (Left Right incs for each axis)
-  vtkIdType inInc0L, inInc0R, inInc1L, inInc1R, inInc2L, inInc2R;
-  T *inPtrL, *inPtrR;
-  double sum;
   // Boundary of input image
-  int inWholeMin0, inWholeMax0, inWholeMin1, inWholeMax1;
-  int inWholeMin2, inWholeMax2;
   int inWholeExt[6];
-  unsigned long count = 0;
-  unsigned long target;
-
-  // Get boundary information
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inWholeExt);
-  inWholeMin0 = inWholeExt[0];
-  inWholeMax0 = inWholeExt[1];
-  inWholeMin1 = inWholeExt[2];
-  inWholeMax1 = inWholeExt[3];
-  inWholeMin2 = inWholeExt[4];
-  inWholeMax2 = inWholeExt[5];
 
   // Get information to march through data (skip component)
-  inData->GetIncrements(inInc0, inInc1, inInc2);
-  outData->GetIncrements(outInc0, outInc1, outInc2);
-  min0 = outExt[0];   max0 = outExt[1];
-  min1 = outExt[2];   max1 = outExt[3];
-  min2 = outExt[4];   max2 = outExt[5];
-
-  // We want the input pixel to correspond to output
-  inPtr = static_cast<T *>(inData->GetScalarPointer(min0,min1,min2));
+  vtkIdType inIncs[3], outIncs[3];
+  inData->GetIncrements(inIncs);
+  outData->GetIncrements(outIncs);
 
   // The data spacing is important for computing the gradient.
   // Scale so it has the same range as gradient.
-  r = inData->GetSpacing();
-  r0 = 0.060445 / r[0];
-  r1 = 0.060445 / r[1];
-  r2 = 0.060445 / r[2];
-
-  target = static_cast<unsigned long>((max2-min2+1)*(max1-min1+1)/50.0);
-  target++;
-
-  // loop through pixels of output
-  outPtr2 = outPtr;
-  inPtr2 = inPtr;
-  for (outIdx2 = min2; outIdx2 <= max2; ++outIdx2)
-  {
-    inInc2L = (outIdx2 == inWholeMin2) ? 0 : -inInc2;
-    inInc2R = (outIdx2 == inWholeMax2) ? 0 : inInc2;
+  double *r = inData->GetSpacing();
+
+  const double s = sqrt(0.5);
+  const double smooth[2][3] = {
+    { s, 2.0*s, s }, { 1.0, 0.0, 1.0 } };
+  const double corner[2][3] = {
+    { s, 2.0*s, s }, { 0.086, 0.0, 0.086 } };
+
+  vtkImageSeparableKernel kernels[3];
+  vtkImageSeparableFilter<double> filter(kernels);
+  filter.SetAlgorithm(self, (id == 0));
 
-    outPtr1 = outPtr2;
-    inPtr1 = inPtr2;
-    for (outIdx1 = min1; !self->AbortExecute && outIdx1 <= max1; ++outIdx1)
+  for (int axis = 0; axis < 3; axis++)
+  {
+    for (int term = 0; term < 2; term++)
     {
-      if (!id)
+      for (int j = 0; j < 3; j++)
       {
-        if (!(count%target))
+        double derivative[3] = { -0.060445/r[j], 0.0, 0.060445/r[j] };
+        const double *kernel = derivative;
+        if (j != axis)
         {
-          self->UpdateProgress(count/(50.0*target));
+          kernel = (j == (axis + 1) % 3 ? smooth[term] : corner[term]);
         }
-        count++;
-      }
-      inInc1L = (outIdx1 == inWholeMin1) ? 0 : -inInc1;
-      inInc1R = (outIdx1 == inWholeMax1) ? 0 : inInc1;
-
-      outPtr0 = outPtr1;
-      inPtr0 = inPtr1;
-      for (outIdx0 = min0; outIdx0 <= max0; ++outIdx0)
-      {
-        inInc0L = (outIdx0 == inWholeMin0) ? 0 : -inInc0;
-        inInc0R = (outIdx0 == inWholeMax0) ? 0 : inInc0;
-
-        // compute vector.
-        outPtrV = outPtr0;
-        // 12 Plane
-        inPtrL = inPtr0 + inInc0L;
-        inPtrR = inPtr0 + inInc0R;
-        sum = 2.0 * (*inPtrR - *inPtrL);
-        sum += static_cast<double>(inPtrR[inInc1L] + inPtrR[inInc1R]
-                + inPtrR[inInc2L] + inPtrR[inInc2R]);
-        sum += static_cast<double>(0.586 * (inPtrR[inInc1L+inInc2L] + inPtrR[inInc1L+inInc2R]
-                         + inPtrR[inInc1R+inInc2L] + inPtrR[inInc1R+inInc2R]));
-        sum -= static_cast<double>(inPtrL[inInc1L] + inPtrL[inInc1R]
-                + inPtrL[inInc2L] + inPtrL[inInc2R]);
-        sum -= static_cast<double>(0.586 * (inPtrL[inInc1L+inInc2L] + inPtrL[inInc1L+inInc2R]
-                         + inPtrL[inInc1R+inInc2L] + inPtrL[inInc1R+inInc2R]));
-        *outPtrV = sum * r0;
-        ++outPtrV;
-        // 02 Plane
-        inPtrL = inPtr0 + inInc1L;
-        inPtrR = inPtr0 + inInc1R;
-        sum = 2.0 * (*inPtrR - *inPtrL);
-        sum += static_cast<double>(inPtrR[inInc0L] + inPtrR[inInc0R]
-                + inPtrR[inInc2L] + inPtrR[inInc2R]);
-        sum += static_cast<double>(0.586 * (inPtrR[inInc0L+inInc2L] + inPtrR[inInc0L+inInc2R]
-                         + inPtrR[inInc0R+inInc2L] + inPtrR[inInc0R+inInc2R]));
-        sum -= static_cast<double>(inPtrL[inInc0L] + inPtrL[inInc0R]
-                + inPtrL[inInc2L] + inPtrL[inInc2R]);
-        sum -= static_cast<double>(0.586 * (inPtrL[inInc0L+inInc2L] + inPtrL[inInc0L+inInc2R]
-                         + inPtrL[inInc0R+inInc2L] + inPtrL[inInc0R+inInc2R]));
-        *outPtrV = sum * r1;
-        ++outPtrV;
-        // 01 Plane
-        inPtrL = inPtr0 + inInc2L;
-        inPtrR = inPtr0 + inInc2R;
-        sum = 2.0 * (*inPtrR - *inPtrL);
-        sum += static_cast<double>(inPtrR[inInc0L] + inPtrR[inInc0R]
-                + inPtrR[inInc1L] + inPtrR[inInc1R]);
-        sum += static_cast<double>(0.586 * (inPtrR[inInc0L+inInc1L] + inPtrR[inInc0L+inInc1R]
-                         + inPtrR[inInc0R+inInc1L] + inPtrR[inInc0R+inInc1R]));
-        sum -= static_cast<double>(inPtrL[inInc0L] + inPtrL[inInc0R]
-                + inPtrL[inInc1L] + inPtrL[inInc1R]);
-        sum -= static_cast<double>(0.586 * (inPtrL[inInc0L+inInc1L] + inPtrL[inInc0L+inInc1R]
-                         + inPtrL[inInc0R+inInc1L] + inPtrL[inInc0R+inInc1R]));
-        *outPtrV = static_cast<double>(sum * r2);
-        ++outPtrV;
-
-        outPtr0 += outInc0;
-        inPtr0 += inInc0;
+        kernels[j].SetKernel(kernel, 3, 1, outExt[2*j], outExt[2*j + 1],
+                             inWholeExt[2*j], inWholeExt[2*j + 1],
+                             vtkImageSeparableKernel::Replicate);
       }
-      outPtr1 += outInc1;
-      inPtr1 += inInc1;
+      filter.Execute(inPtr, inData->GetExtent(), inIncs,
+                     outPtr + axis, outExt, outIncs, (term == 1));
     }
-    outPtr2 += outInc2;
-    inPtr2 += inInc2;
   }
 }
 
@@ -213,13 +130,10 @@ void vtkImageSobel3D::ThreadedRequestData(
   int outExt[6], int id)
 {
   void *inPtr, *outPtr;
-  int inExt[6], wholeExt[6];
 
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
-  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
-  this->InternalRequestUpdateExtent(inExt, outExt, wholeExt);
 
-  inPtr = inData[0][0]->GetScalarPointerForExtent(inExt);
+  inPtr = inData[0][0]->GetScalarPointer();
   outPtr = outData[0]->GetScalarPointerForExtent(outExt);
 
   // this filter cannot handle multi component input.
@@ -0,0 +1,201 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageConnectivityFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Test that the union-find labeling of vtkImageConnectivityFilter gives
+// exactly the same output as the serial flood fill.
+
+#include "vtkSmartPointer.h"
+#include "vtkImageConnectivityFilter.h"
+#include "vtkImageData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPoints.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkUnsignedCharArray.h"
+
+namespace {
+
+vtkSmartPointer<vtkImageData> MakeImage(int nx, int ny, int nz, double fill)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(nx*1000 + ny*10 + nz);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, nx - 1, 0, ny - 1, 0, nz - 1);
+  image->SetSpacing(1.0, 1.0, 1.0);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  vtkIdType n = static_cast<vtkIdType>(nx)*ny*nz;
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    random->Next();
+    ptr[i] = (random->GetValue() < fill ? 1 : 0);
+  }
+  return image;
+}
+
+bool CompareArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  vtkIdType n = a->GetNumberOfTuples()*a->GetNumberOfComponents();
+  if (b->GetNumberOfTuples()*b->GetNumberOfComponents() != n)
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    if (a->GetComponent(i/a->GetNumberOfComponents(),
+                        i%a->GetNumberOfComponents()) !=
+        b->GetComponent(i/b->GetNumberOfComponents(),
+                        i%b->GetNumberOfComponents()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+int CompareFilters(
+  vtkImageData *image, vtkPolyData *seeds, int extractionMode,
+  int labelMode, int scalarType, bool extents, vtkIdType minSize,
+  const int *updateExtent)
+{
+  vtkSmartPointer<vtkImageConnectivityFilter> filters[2];
+  for (int i = 0; i < 2; i++)
+  {
+    filters[i] = vtkSmartPointer<vtkImageConnectivityFilter>::New();
+    filters[i]->SetInputData(image);
+    filters[i]->SetScalarRange(1, 1);
+    if (seeds)
+    {
+      filters[i]->SetSeedData(seeds);
+    }
+    filters[i]->SetExtractionMode(extractionMode);
+    filters[i]->SetLabelMode(labelMode);
+    filters[i]->SetLabelScalarType(scalarType);
+    filters[i]->SetGenerateRegionExtents(extents);
+    filters[i]->SetSizeRange(minSize, VTK_ID_MAX);
+    filters[i]->SetEnableSMP(i == 1);
+    if (updateExtent)
+    {
+      filters[i]->UpdateExtent(updateExtent);
+    }
+    else
+    {
+      filters[i]->Update();
+    }
+  }
+
+  vtkImageData *serial = filters[0]->GetOutput();
+  vtkImageData *parallel = filters[1]->GetOutput();
+
+  int rval = 0;
+  if (!CompareArrays(serial->GetPointData()->GetScalars(),
+                     parallel->GetPointData()->GetScalars()))
+  {
+    cerr << "Labels differ";
+    rval = 1;
+  }
+  else if (
+    !CompareArrays(filters[0]->GetExtractedRegionLabels(),
+                   filters[1]->GetExtractedRegionLabels()) ||
+    !CompareArrays(filters[0]->GetExtractedRegionSizes(),
+                   filters[1]->GetExtractedRegionSizes()) ||
+    !CompareArrays(filters[0]->GetExtractedRegionSeedIds(),
+                   filters[1]->GetExtractedRegionSeedIds()) ||
+    !CompareArrays(filters[0]->GetExtractedRegionExtents(),
+                   filters[1]->GetExtractedRegionExtents()))
+  {
+    cerr << "Region information differs";
+    rval = 1;
+  }
+
+  if (rval)
+  {
+    int dims[3];
+    image->GetDimensions(dims);
+    cerr << " for image " << dims[0] << "x" << dims[1] << "x" << dims[2]
+         << ", seeds " << (seeds != 0)
+         << ", extraction mode " << extractionMode
+         << ", label mode " << labelMode
+         << ", scalar type " << scalarType
+         << ", extents " << extents
+         << ", min size " << minSize
+         << ", update extent " << (updateExtent != 0) << "\n";
+  }
+
+  return rval;
+}
+
+} // end anonymous namespace
+
+int TestImageConnectivityFilterSMP(int, char *[])
+{
+  int rval = 0;
+
+  // seeds, some in the background and some in the same region
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> scalars =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  for (int i = 0; i < 40; i++)
+  {
+    points->InsertNextPoint((i*7) % 31, (i*11) % 29, (i*5) % 13);
+    scalars->InsertNextValue(static_cast<unsigned char>(i % 5));
+  }
+  vtkSmartPointer<vtkPolyData> seeds = vtkSmartPointer<vtkPolyData>::New();
+  seeds->SetPoints(points);
+  seeds->GetPointData()->SetScalars(scalars);
+
+  const int scalarTypes[2] = { VTK_UNSIGNED_CHAR, VTK_INT };
+  const int updateExtent[6] = { 3, 20, 2, 25, 1, 9 };
+
+  // the fill fractions give many small regions and a few large ones
+  vtkSmartPointer<vtkImageData> images[3] = {
+    MakeImage(31, 29, 13, 0.35),
+    MakeImage(31, 29, 13, 0.6),
+    MakeImage(64, 57, 1, 0.55)
+  };
+
+  for (int im = 0; im < 3; im++)
+  {
+    for (int s = 0; s < 2; s++)
+    {
+      vtkPolyData *seedData = (s ? seeds.GetPointer() : 0);
+      for (int em = 0; em < 3; em++)
+      {
+        for (int lm = 0; lm < 3; lm++)
+        {
+          for (int st = 0; st < 2; st++)
+          {
+            for (int ex = 0; ex < 2; ex++)
+            {
+              rval |= CompareFilters(
+                images[im], seedData, em, lm, scalarTypes[st], ex != 0,
+                1 + 3*ex, 0);
+            }
+          }
+        }
+      }
+      rval |= CompareFilters(
+        images[im], seedData, vtkImageConnectivityFilter::AllRegions,
+        vtkImageConnectivityFilter::SizeRank, VTK_UNSIGNED_CHAR, true, 1,
+        (images[im]->GetDimensions()[2] > 1 ? updateExtent : 0));
+    }
+  }
+
+  return rval;
+}
@@ -0,0 +1,246 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageRankFilters.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the output of the neighborhood rank filters (median, range,
+// dilate and erode) with a direct computation over each neighborhood.
+
+#include "vtkSmartPointer.h"
+#include "vtkDataArray.h"
+#include "vtkImageContinuousDilate3D.h"
+#include "vtkImageContinuousErode3D.h"
+#include "vtkImageData.h"
+#include "vtkImageMedian3D.h"
+#include "vtkImageRange3D.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+enum { Median = 0, Range, Dilate, Erode };
+
+const int ImageExtent[6] = { 3, 24, -2, 16, 1, 9 };
+
+vtkSmartPointer<vtkImageData> MakeImage(int scalarType, int numComps)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(scalarType*10 + numComps);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(const_cast<int *>(ImageExtent));
+  image->AllocateScalars(scalarType, numComps);
+
+  // use a limited set of values for many repeated values
+  double range[2];
+  range[0] = image->GetScalarTypeMin();
+  range[1] = image->GetScalarTypeMax();
+  if (scalarType == VTK_FLOAT || scalarType == VTK_DOUBLE)
+  {
+    range[0] = -100.0;
+    range[1] = 100.0;
+  }
+  else if (scalarType == VTK_INT)
+  {
+    range[0] = -1e6;
+    range[1] = 1e6;
+  }
+
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    for (int c = 0; c < numComps; c++)
+    {
+      random->Next();
+      double v = range[0] + (range[1] - range[0])*
+        static_cast<int>(random->GetValue()*40.0)/39.0;
+      scalars->SetComponent(i, c, v);
+    }
+  }
+
+  return image;
+}
+
+bool InMask(int filter, const int size[3], const int idx[3])
+{
+  if (filter == Median)
+  {
+    return true;
+  }
+  // the footprint of vtkImageEllipsoidSource
+  double s = 0.0;
+  for (int j = 0; j < 3; j++)
+  {
+    double center = static_cast<float>(size[j] - 1)*0.5;
+    double radius = static_cast<float>(size[j])*0.5;
+    double t = (idx[j] - center)/radius;
+    s += t*t;
+  }
+  return (s <= 1.0);
+}
+
+template<class T>
+double ComputeReference(int filter, vtkImageData *image, const int size[3],
+                        const int ijk[3], int c)
+{
+  T center = static_cast<T *>(
+    image->GetScalarPointer(ijk[0], ijk[1], ijk[2]))[c];
+  std::vector<T> values;
+  int idx[3];
+  for (idx[2] = 0; idx[2] < size[2]; idx[2]++)
+  {
+    for (idx[1] = 0; idx[1] < size[1]; idx[1]++)
+    {
+      for (idx[0] = 0; idx[0] < size[0]; idx[0]++)
+      {
+        int p[3];
+        bool inside = true;
+        for (int j = 0; j < 3; j++)
+        {
+          p[j] = ijk[j] + idx[j] - size[j]/2;
+          inside &= (p[j] >= ImageExtent[2*j] && p[j] <= ImageExtent[2*j+1]);
+        }
+        if (inside && InMask(filter, size, idx))
+        {
+          values.push_back(static_cast<T *>(
+            image->GetScalarPointer(p[0], p[1], p[2]))[c]);
+        }
+      }
+    }
+  }
+
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  if (filter == Median)
+  {
+    T m = values[n/2];
+    if (n % 2 == 0)
+    {
+      T low = values[n/2 - 1];
+      m = low + (m - low)/2;
+    }
+    return m;
+  }
+
+  values.push_back(center);
+  std::sort(values.begin(), values.end());
+  if (filter == Range)
+  {
+    return static_cast<float>(values.back() - values.front());
+  }
+  return (filter == Dilate ? values.back() : values.front());
+}
+
+int TestFilter(int filter, vtkImageData *image, const int size[3],
+               bool smp)
+{
+  vtkSmartPointer<vtkImageSpatialAlgorithm> algorithm;
+  if (filter == Median)
+  {
+    vtkImageMedian3D *f = vtkImageMedian3D::New();
+    f->SetKernelSize(size[0], size[1], size[2]);
+    algorithm.TakeReference(f);
+  }
+  else if (filter == Range)
+  {
+    vtkImageRange3D *f = vtkImageRange3D::New();
+    f->SetKernelSize(size[0], size[1], size[2]);
+    algorithm.TakeReference(f);
+  }
+  else if (filter == Dilate)
+  {
+    vtkImageContinuousDilate3D *f = vtkImageContinuousDilate3D::New();
+    f->SetKernelSize(size[0], size[1], size[2]);
+    algorithm.TakeReference(f);
+  }
+  else
+  {
+    vtkImageContinuousErode3D *f = vtkImageContinuousErode3D::New();
+    f->SetKernelSize(size[0], size[1], size[2]);
+    algorithm.TakeReference(f);
+  }
+  algorithm->SetInputData(image);
+  algorithm->SetEnableSMP(smp);
+
+  // update only part of the image to check the neighborhood clipping
+  int updateExtent[6] = { 3, 21, 0, 16, 1, 5 };
+  algorithm->UpdateExtent(updateExtent);
+  vtkImageData *output = algorithm->GetOutput();
+
+  int numComps = image->GetNumberOfScalarComponents();
+  int ijk[3];
+  for (ijk[2] = updateExtent[4]; ijk[2] <= updateExtent[5]; ijk[2]++)
+  {
+    for (ijk[1] = updateExtent[2]; ijk[1] <= updateExtent[3]; ijk[1]++)
+    {
+      for (ijk[0] = updateExtent[0]; ijk[0] <= updateExtent[1]; ijk[0]++)
+      {
+        for (int c = 0; c < numComps; c++)
+        {
+          double expected = 0.0;
+          switch (image->GetScalarType())
+          {
+            vtkTemplateMacro(
+              expected = ComputeReference<VTK_TT>(
+                filter, image, size, ijk, c));
+          }
+          double value = output->GetScalarComponentAsDouble(
+            ijk[0], ijk[1], ijk[2], c);
+          if (value != expected)
+          {
+            cerr << algorithm->GetClassName() << " with kernel "
+                 << size[0] << "x" << size[1] << "x" << size[2]
+                 << " on " << image->GetScalarTypeAsString()
+                 << " gives " << value << " at (" << ijk[0] << ", "
+                 << ijk[1] << ", " << ijk[2] << "), expected "
+                 << expected << "\n";
+            return 1;
+          }
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+} // end anonymous namespace
+
+int TestImageRankFilters(int, char *[])
+{
+  int rval = 0;
+
+  const int scalarTypes[5] = {
+    VTK_UNSIGNED_CHAR, VTK_SIGNED_CHAR, VTK_SHORT, VTK_INT, VTK_FLOAT };
+  const int sizes[4][3] = {
+    { 1, 1, 1 }, { 3, 3, 3 }, { 4, 5, 2 }, { 7, 7, 1 } };
+
+  for (int t = 0; t < 5; t++)
+  {
+    vtkSmartPointer<vtkImageData> image =
+      MakeImage(scalarTypes[t], 1 + (t % 2));
+    for (int filter = Median; filter <= Erode; filter++)
+    {
+      for (int k = 0; k < 4; k++)
+      {
+        rval |= TestFilter(filter, image, sizes[k], (k == 1));
+      }
+    }
+  }
+
+  return rval;
+}
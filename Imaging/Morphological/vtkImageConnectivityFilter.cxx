@@ -56,6 +56,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPoints.h"
 #include "vtkIdTypeArray.h"
+#include "vtkSMPTools.h"
 #include "vtkIntArray.h"
 #include "vtkImageStencilData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
@@ -93,6 +94,8 @@ vtkImageConnectivityFilter::vtkImageConnectivityFilter()
 
   this->GenerateRegionExtents = 0;
 
+  this->EnableSMP = false;
+
   this->ExtractedRegionLabels = vtkIdTypeArray::New();
   this->ExtractedRegionSizes = vtkIdTypeArray::New();
   this->ExtractedRegionSeedIds = vtkIdTypeArray::New();
@@ -300,8 +303,8 @@ protected:
   static void AddRegion(
     vtkImageData *outData, OT *outPtr, vtkImageStencilData *stencil,
     int extent[6], vtkIdType sizeRange[2], vtkICF::RegionVector& regionInfo,
-    vtkIdType voxelCount, vtkIdType regionId, int regionExtent[6],
-    int extractionMode);
+    vtkIdType voxelCount, vtkIdType regionId, const int regionExtent[6],
+    int extractionMode, vtkIdType component = -1);
 
   // Fill the ExtractedRegionSizes and ExtractedRegionLabels arrays.
   static void GenerateRegionArrays(
@@ -346,6 +349,15 @@ protected:
     OT *outPtr, unsigned char *maskPtr, int extent[6],
     vtkICF::RegionVector& regionInfo);
 
+  // Execute method that finds all components in parallel, and then
+  // produces the same regions as SeededExecute and SeedlessExecute.
+  template <class OT>
+  static void ParallelExecute(
+    vtkImageConnectivityFilter *self,
+    vtkImageData *outData, vtkDataSet *seedData, vtkImageStencilData *stencil,
+    OT *outPtr, unsigned char *maskPtr, int extent[6],
+    vtkICF::RegionVector& regionInfo);
+
 public:
   // Create a bit mask from the input
   template<class IT>
@@ -406,18 +418,20 @@ private:
 };
 
 //----------------------------------------------------------------------------
-// region struct: size and id
+// region struct: size and id, and the component for parallel execution
 struct vtkICF::Region
 {
-  Region(vtkIdType s, vtkIdType i, const int e[6]) : size(s), id(i) {
+  Region(vtkIdType s, vtkIdType i, const int e[6], vtkIdType c = -1)
+    : size(s), id(i), component(c) {
     extent[0] = e[0]; extent[1] = e[1]; extent[2] = e[2];
     extent[3] = e[3]; extent[4] = e[4]; extent[5] = e[5]; }
-  Region() : size(0), id(0) {
+  Region() : size(0), id(0), component(-1) {
     extent[0] = extent[1] = extent[2] = 0;
     extent[3] = extent[4] = extent[5] = 0; }
 
   vtkIdType size;
   vtkIdType id;
+  vtkIdType component;
   int extent[6];
 };
 
@@ -598,6 +612,12 @@ void vtkICF::PruneAllButLargest(
     regionInfo[1] = *largest;
     regionInfo.erase(regionInfo.begin()+2, regionInfo.end());
 
+    // a null outPtr means that only the list is to be modified
+    if (outPtr == 0)
+    {
+      return;
+    }
+
     // remove all other regions from the output
     vtkImageStencilIterator<OT> iter(outData, stencil, outExt);
     for (; !iter.IsAtEnd(); iter.NextSpan())
@@ -645,6 +665,12 @@ void vtkICF::PruneSmallestRegion(
     OT t = std::distance(regionInfo.begin(), smallest);
     regionInfo.erase(smallest);
 
+    // a null outPtr means that only the list is to be modified
+    if (outPtr == 0)
+    {
+      return;
+    }
+
     // remove the corresponding region from the output
     vtkImageStencilIterator<OT> iter(outData, stencil, outExt);
     for (; !iter.IsAtEnd(); iter.NextSpan())
@@ -702,6 +728,12 @@ void vtkICF::PruneBySize(
     // resize regionInfo
     regionInfo.resize(m);
 
+    // a null outPtr means that only the list is to be modified
+    if (outPtr == 0)
+    {
+      return;
+    }
+
     // clip the extent with the output extent
     int outExt[6];
     outData->GetExtent(outExt);
@@ -828,10 +860,11 @@ template<class OT>
 void vtkICF::AddRegion(
   vtkImageData *outData, OT *outPtr, vtkImageStencilData *stencil,
   int extent[6], vtkIdType sizeRange[2], vtkICF::RegionVector& regionInfo,
-  vtkIdType voxelCount, vtkIdType regionId, int regionExtent[6],
-  int extractionMode)
+  vtkIdType voxelCount, vtkIdType regionId, const int regionExtent[6],
+  int extractionMode, vtkIdType component)
 {
-  regionInfo.push_back(vtkICF::Region(voxelCount, regionId, regionExtent));
+  regionInfo.push_back(
+    vtkICF::Region(voxelCount, regionId, regionExtent, component));
   // check if the label value has reached its maximum, and if so,
   // remove some of the regions
   if (regionInfo.size() > static_cast<size_t>(vtkTypeTraits<OT>::Max()))
@@ -1333,10 +1366,22 @@ void vtkICF::SeedlessExecute(
               static_cast<OT>(regionInfo.size()) == vtkTypeTraits<OT>::Max())
           {
             // smallest region is definitely the one we just added
-            vtkIdType outOffset = (xIdx*outInc[0] +
-                                   yIdx*outInc[1] +
-                                   zIdx*outInc[2]);
-            outPtr[outOffset] = 0;
+            if (outLimits == 0)
+            {
+              vtkIdType outOffset = (xIdx*outInc[0] +
+                                     yIdx*outInc[1] +
+                                     zIdx*outInc[2]);
+              outPtr[outOffset] = 0;
+            }
+            else if (xIdx >= outLimits[0] && xIdx <= outLimits[1] &&
+                     yIdx >= outLimits[2] && yIdx <= outLimits[3] &&
+                     zIdx >= outLimits[4] && zIdx <= outLimits[5])
+            {
+              vtkIdType outOffset = ((xIdx - outLimits[0])*outInc[0] +
+                                     (yIdx - outLimits[2])*outInc[1] +
+                                     (zIdx - outLimits[4])*outInc[2]);
+              outPtr[outOffset] = 0;
+            }
           }
           else
           {
@@ -1350,6 +1395,480 @@ void vtkICF::SeedlessExecute(
   }
 }
 
+//----------------------------------------------------------------------------
+// The parallel algorithm works on the runs of unmasked voxels along x.
+// The runs are stored row by row (a row is a given y and z), so that
+// their indices follow the raster order of their first voxels.
+struct vtkICFRuns
+{
+  int RowLength;
+  int NumberOfRowsPerSlice;
+  vtkIdType NumberOfRows;
+  // the runs of row t are in [RowOffsets[t], RowOffsets[t+1])
+  std::vector<vtkIdType> RowOffsets;
+  // first and last x index of each run
+  std::vector<int> Runs;
+  // union-find forest, and later the component of each run
+  std::vector<vtkIdType> Parent;
+
+  // Find the runs in a row of the bitmask and return how many were
+  // found, the runs are stored only if "runs" is not null.
+  static int ScanRow(
+    const unsigned char *maskPtr, vtkIdType bitOffset, int n, int *runs)
+  {
+    int count = 0;
+    bool inRun = false;
+    for (int x = 0; x < n; x++)
+    {
+      vtkIdType b = bitOffset + x;
+      bool unmasked = (((maskPtr[b >> 3] >> (b & 0x7)) & 1) == 0);
+      if (unmasked != inRun)
+      {
+        if (unmasked)
+        {
+          if (runs) { runs[2*count] = x; }
+        }
+        else
+        {
+          if (runs) { runs[2*count + 1] = x - 1; }
+          count++;
+        }
+        inRun = unmasked;
+      }
+    }
+    if (inRun)
+    {
+      if (runs) { runs[2*count + 1] = n - 1; }
+      count++;
+    }
+    return count;
+  }
+
+  // Find the root of a run, with path halving.
+  vtkIdType Find(vtkIdType i)
+  {
+    vtkIdType *parent = &this->Parent[0];
+    while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+
+  // Join two trees.  The root with the lower index is kept, so that
+  // the final roots do not depend on the order of the merges.
+  void Union(vtkIdType i, vtkIdType j)
+  {
+    i = this->Find(i);
+    j = this->Find(j);
+    if (i < j)
+    {
+      this->Parent[j] = i;
+    }
+    else if (j < i)
+    {
+      this->Parent[i] = j;
+    }
+  }
+
+  // Join the runs of row t and row u that touch each other.
+  void MergeRows(vtkIdType t, vtkIdType u)
+  {
+    vtkIdType i = this->RowOffsets[t];
+    vtkIdType iEnd = this->RowOffsets[t + 1];
+    vtkIdType j = this->RowOffsets[u];
+    vtkIdType jEnd = this->RowOffsets[u + 1];
+    while (i < iEnd && j < jEnd)
+    {
+      const int *a = &this->Runs[2*i];
+      const int *b = &this->Runs[2*j];
+      if (a[0] <= b[1] && b[0] <= a[1])
+      {
+        this->Union(i, j);
+      }
+      if (a[1] < b[1])
+      {
+        i++;
+      }
+      else
+      {
+        j++;
+      }
+    }
+  }
+
+  // Join row t with its neighbors at y-1 and z-1, if they are not
+  // before row t0.
+  void MergeWithPrevious(vtkIdType t, vtkIdType t0)
+  {
+    if (t % this->NumberOfRowsPerSlice != 0 && t - 1 >= t0)
+    {
+      this->MergeRows(t, t - 1);
+    }
+    if (t - this->NumberOfRowsPerSlice >= t0)
+    {
+      this->MergeRows(t, t - this->NumberOfRowsPerSlice);
+    }
+  }
+
+  // Find the runs in the given range of rows.
+  struct CountFunctor
+  {
+    vtkICFRuns *Runs;
+    const unsigned char *Mask;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      int n = this->Runs->RowLength;
+      for (vtkIdType t = begin; t < end; t++)
+      {
+        this->Runs->RowOffsets[t + 1] = vtkICFRuns::ScanRow(
+          this->Mask, t*n, n, 0);
+      }
+    }
+  };
+
+  struct FillFunctor
+  {
+    vtkICFRuns *Runs;
+    const unsigned char *Mask;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      int n = this->Runs->RowLength;
+      for (vtkIdType t = begin; t < end; t++)
+      {
+        vtkIdType r = this->Runs->RowOffsets[t];
+        vtkIdType rEnd = this->Runs->RowOffsets[t + 1];
+        if (r != rEnd)
+        {
+          vtkICFRuns::ScanRow(this->Mask, t*n, n, &this->Runs->Runs[2*r]);
+        }
+        for (; r < rEnd; r++)
+        {
+          this->Runs->Parent[r] = r;
+        }
+      }
+    }
+  };
+
+  // Do the union-find within each slab, the slabs touch disjoint runs.
+  struct SlabFunctor
+  {
+    vtkICFRuns *Runs;
+    vtkIdType RowsPerSlab;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      for (vtkIdType slab = begin; slab < end; slab++)
+      {
+        vtkIdType t0 = slab*this->RowsPerSlab;
+        vtkIdType t1 = t0 + this->RowsPerSlab;
+        t1 = (t1 < this->Runs->NumberOfRows ? t1 : this->Runs->NumberOfRows);
+        for (vtkIdType t = t0; t < t1; t++)
+        {
+          this->Runs->MergeWithPrevious(t, t0);
+        }
+      }
+    }
+  };
+};
+
+//----------------------------------------------------------------------------
+// Write the labels of the components into the output.
+template<class OT>
+struct vtkICFWriteFunctor
+{
+  vtkICFRuns *Runs;
+  const OT *Labels;
+  OT *OutPtr;
+  vtkIdType *OutInc;
+  int *Limits;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int *lim = this->Limits;
+    int ny = this->Runs->NumberOfRowsPerSlice;
+    for (vtkIdType t = begin; t < end; t++)
+    {
+      int y = static_cast<int>(t % ny);
+      int z = static_cast<int>(t / ny);
+      if (y < lim[2] || y > lim[3] || z < lim[4] || z > lim[5])
+      {
+        continue;
+      }
+      OT *rowPtr = this->OutPtr + ((y - lim[2])*this->OutInc[1] +
+                                   (z - lim[4])*this->OutInc[2]);
+      vtkIdType rEnd = this->Runs->RowOffsets[t + 1];
+      for (vtkIdType r = this->Runs->RowOffsets[t]; r < rEnd; r++)
+      {
+        OT label = this->Labels[this->Runs->Parent[r]];
+        int x0 = this->Runs->Runs[2*r];
+        int x1 = this->Runs->Runs[2*r + 1];
+        x0 = (x0 > lim[0] ? x0 : lim[0]);
+        x1 = (x1 < lim[1] ? x1 : lim[1]);
+        if (label != 0)
+        {
+          for (int x = x0; x <= x1; x++)
+          {
+            rowPtr[(x - lim[0])*this->OutInc[0]] = label;
+          }
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class OT>
+void vtkICF::ParallelExecute(
+  vtkImageConnectivityFilter *self,
+  vtkImageData *outData, vtkDataSet *seedData, vtkImageStencilData *stencil,
+  OT *outPtr, unsigned char *maskPtr, int extent[6],
+  vtkICF::RegionVector& regionInfo)
+{
+  // Get execution parameters
+  int extractionMode = self->GetExtractionMode();
+  vtkIdType sizeRange[2];
+  self->GetSizeRange(sizeRange);
+  bool generateExtents = (self->GetGenerateRegionExtents() != 0);
+
+  vtkIdType outInc[3];
+  outData->GetIncrements(outInc);
+
+  int outExt[6];
+  outData->GetExtent(outExt);
+
+  int maxIdx[3];
+  int *outLimits = vtkICF::ZeroBaseExtent(extent, outExt, maxIdx);
+  int limits[6] = { 0, maxIdx[0], 0, maxIdx[1], 0, maxIdx[2] };
+  if (outLimits)
+  {
+    for (int k = 0; k < 6; k++)
+    {
+      limits[k] = outLimits[k];
+    }
+  }
+
+  // First pass: find the runs in each row, in parallel.
+  vtkICFRuns runs;
+  runs.RowLength = maxIdx[0] + 1;
+  runs.NumberOfRowsPerSlice = maxIdx[1] + 1;
+  runs.NumberOfRows =
+    static_cast<vtkIdType>(maxIdx[1] + 1)*(maxIdx[2] + 1);
+  vtkIdType numRows = runs.NumberOfRows;
+  runs.RowOffsets.resize(numRows + 1);
+  runs.RowOffsets[0] = 0;
+
+  vtkICFRuns::CountFunctor counter = { &runs, maskPtr };
+  vtkSMPTools::For(0, numRows, counter);
+  for (vtkIdType t = 0; t < numRows; t++)
+  {
+    runs.RowOffsets[t + 1] += runs.RowOffsets[t];
+  }
+  vtkIdType numRuns = runs.RowOffsets[numRows];
+  runs.Runs.resize(2*numRuns + 2);
+  runs.Parent.resize(numRuns + 1);
+
+  vtkICFRuns::FillFunctor filler = { &runs, maskPtr };
+  vtkSMPTools::For(0, numRows, filler);
+
+  // Second pass: union-find within slabs of whole slices (or of rows,
+  // for 2D images), then merge across the slab boundaries.
+  const vtkIdType targetSlabs = 64;
+  vtkIdType rowsPerSlab;
+  if (maxIdx[2] > 0)
+  {
+    vtkIdType slices = (maxIdx[2] + targetSlabs) / targetSlabs;
+    rowsPerSlab = slices*runs.NumberOfRowsPerSlice;
+  }
+  else
+  {
+    rowsPerSlab = (numRows + targetSlabs - 1) / targetSlabs;
+  }
+  vtkIdType numSlabs = (numRows + rowsPerSlab - 1) / rowsPerSlab;
+
+  vtkICFRuns::SlabFunctor slabber = { &runs, rowsPerSlab };
+  vtkSMPTools::For(0, numSlabs, 1, slabber);
+
+  for (vtkIdType slab = 1; slab < numSlabs; slab++)
+  {
+    vtkIdType t0 = slab*rowsPerSlab;
+    vtkIdType t1 = t0 + runs.NumberOfRowsPerSlice;
+    t1 = (t1 < t0 + rowsPerSlab ? t1 : t0 + rowsPerSlab);
+    t1 = (t1 < numRows ? t1 : numRows);
+    for (vtkIdType t = t0; t < t1; t++)
+    {
+      // rows that were already merged within the slab are harmless
+      runs.MergeWithPrevious(t, 0);
+    }
+  }
+
+  // Number the components in the raster order of their first voxels,
+  // which is the order in which the serial fill discovers them.  The
+  // root of each tree is its first run, so every other run of the tree
+  // comes after it and finds the component number in its parent.
+  std::vector<vtkIdType> componentSizes;
+  std::vector<int> componentExtents;
+  std::vector<int> componentStarts;
+  vtkIdType *parent = (numRuns > 0 ? &runs.Parent[0] : 0);
+  for (vtkIdType t = 0; t < numRows; t++)
+  {
+    int y = static_cast<int>(t % runs.NumberOfRowsPerSlice);
+    int z = static_cast<int>(t / runs.NumberOfRowsPerSlice);
+    vtkIdType rEnd = runs.RowOffsets[t + 1];
+    for (vtkIdType r = runs.RowOffsets[t]; r < rEnd; r++)
+    {
+      int x0 = runs.Runs[2*r];
+      int x1 = runs.Runs[2*r + 1];
+      vtkIdType c;
+      if (parent[r] == r)
+      {
+        c = static_cast<vtkIdType>(componentSizes.size());
+        componentSizes.push_back(0);
+        int e[6] = { x0, x1, y, y, z, z };
+        componentExtents.insert(componentExtents.end(), e, e + 6);
+        int p[3] = { x0, y, z };
+        componentStarts.insert(componentStarts.end(), p, p + 3);
+      }
+      else
+      {
+        c = parent[parent[r]];
+        int *e = &componentExtents[6*c];
+        e[0] = (x0 < e[0] ? x0 : e[0]);
+        e[1] = (x1 > e[1] ? x1 : e[1]);
+        e[2] = (y < e[2] ? y : e[2]);
+        e[3] = (y > e[3] ? y : e[3]);
+        e[5] = z;
+      }
+      parent[r] = c;
+      componentSizes[c] += x1 - x0 + 1;
+    }
+  }
+
+  vtkIdType numComponents = static_cast<vtkIdType>(componentSizes.size());
+  std::vector<char> used(numComponents + 1, 0);
+
+  // The regions are added in the same order as with the serial fill,
+  // so that the labels and any pruning of regions are identical.
+  // Nothing is written to the output until all regions are known.
+  OT *noOutput = 0;
+
+  if (seedData)
+  {
+    double spacing[3];
+    double origin[3];
+    outData->GetOrigin(origin);
+    outData->GetSpacing(spacing);
+
+    vtkIdType nPoints = seedData->GetNumberOfPoints();
+    vtkDataArray *scalars = seedData->GetPointData()->GetScalars();
+
+    for (vtkIdType i = 0; i < nPoints; i++)
+    {
+      if (scalars && scalars->GetComponent(i, 0) == 0)
+      {
+        continue;
+      }
+
+      double point[3];
+      seedData->GetPoint(i, point);
+      int idx[3];
+      bool outOfBounds = false;
+
+      // convert point from data coords to image index
+      for (int j = 0; j < 3; j++)
+      {
+        idx[j] = vtkMath::Floor((point[j] - origin[j])/spacing[j] + 0.5);
+        idx[j] -= extent[2*j];
+        outOfBounds |= (idx[j] < 0 || idx[j] > maxIdx[j]);
+      }
+
+      if (outOfBounds)
+      {
+        continue;
+      }
+
+      // search the row for the run that contains the seed
+      vtkIdType t = static_cast<vtkIdType>(idx[2])*runs.NumberOfRowsPerSlice
+        + idx[1];
+      vtkIdType lo = runs.RowOffsets[t];
+      vtkIdType hi = runs.RowOffsets[t + 1];
+      while (lo < hi)
+      {
+        vtkIdType mid = (lo + hi)/2;
+        if (runs.Runs[2*mid + 1] < idx[0])
+        {
+          lo = mid + 1;
+        }
+        else
+        {
+          hi = mid;
+        }
+      }
+      if (lo == runs.RowOffsets[t + 1] || runs.Runs[2*lo] > idx[0])
+      {
+        continue;
+      }
+
+      vtkIdType c = parent[lo];
+      if (used[c])
+      {
+        continue;
+      }
+      used[c] = 1;
+
+      int seedExtent[6] = { idx[0], idx[0], idx[1], idx[1], idx[2], idx[2] };
+      const int *regionExtent =
+        (generateExtents ? &componentExtents[6*c] : seedExtent);
+      vtkICF::AddRegion(
+        outData, noOutput, stencil, extent, sizeRange, regionInfo,
+        componentSizes[c], i, regionExtent, extractionMode, c);
+    }
+  }
+
+  if (!seedData ||
+      extractionMode == vtkImageConnectivityFilter::AllRegions)
+  {
+    for (vtkIdType c = 0; c < numComponents; c++)
+    {
+      if (used[c])
+      {
+        continue;
+      }
+      used[c] = 1;
+
+      vtkIdType voxelCount = componentSizes[c];
+      if (voxelCount == 1 &&
+          static_cast<OT>(regionInfo.size()) == vtkTypeTraits<OT>::Max())
+      {
+        // the serial fill discards this region immediately
+        continue;
+      }
+
+      const int *p = &componentStarts[3*c];
+      int seedExtent[6] = { p[0], p[0], p[1], p[1], p[2], p[2] };
+      const int *regionExtent =
+        (generateExtents ? &componentExtents[6*c] : seedExtent);
+      vtkICF::AddRegion(
+        outData, noOutput, stencil, extent, sizeRange, regionInfo,
+        voxelCount, -1, regionExtent, extractionMode, c);
+    }
+  }
+
+  // Third pass: write the label of each region into the output.
+  std::vector<OT> labels(numComponents + 1, 0);
+  for (size_t i = 1; i < regionInfo.size(); i++)
+  {
+    labels[regionInfo[i].component] = static_cast<OT>(i);
+  }
+
+  vtkICFWriteFunctor<OT> writer =
+    { &runs, &labels[0], outPtr, outInc, limits };
+  vtkSMPTools::For(0, numRows, writer);
+}
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 template <class OT>
@@ -1367,19 +1886,33 @@ void vtkICF::ExecuteOutput(
   if (seedData)
   {
     seedScalars = seedData->GetPointData()->GetScalars();
-    vtkICF::SeededExecute(
+  }
+
+  if (self->GetEnableSMP())
+  {
+    // find all the regions at once, seeded or not
+    vtkICF::ParallelExecute(
       self, outData, seedData, stencil, outPtr, maskPtr,
       extent, regionInfo);
   }
-
-  // if no seeds, or if AllRegions selected, search for all regions
-  int extractionMode = self->GetExtractionMode();
-  if (!seedData ||
-      extractionMode == vtkImageConnectivityFilter::AllRegions)
+  else
   {
-    vtkICF::SeedlessExecute(
-      self, outData, stencil, outPtr, maskPtr, extent,
-      regionInfo);
+    if (seedData)
+    {
+      vtkICF::SeededExecute(
+        self, outData, seedData, stencil, outPtr, maskPtr,
+        extent, regionInfo);
+    }
+
+    // if no seeds, or if AllRegions selected, search for all regions
+    int extractionMode = self->GetExtractionMode();
+    if (!seedData ||
+        extractionMode == vtkImageConnectivityFilter::AllRegions)
+    {
+      vtkICF::SeedlessExecute(
+        self, outData, stencil, outPtr, maskPtr, extent,
+        regionInfo);
+    }
   }
 
   // do final relabelling and other bookkeeping
@@ -1591,6 +2124,9 @@ void vtkImageConnectivityFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "GenerateRegionExtents: "
      << (this->GenerateRegionExtents ? "On\n" : "Off\n");
 
+  os << indent << "EnableSMP: "
+     << (this->EnableSMP ? "On\n" : "Off\n");
+
   os << indent << "SeedConnection: "
      << this->GetSeedConnection() << "\n";
 
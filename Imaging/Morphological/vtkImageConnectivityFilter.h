@@ -86,6 +86,12 @@
  * is called.  These extents can be useful for cropping the output
  * of the filter.
  *
+ * By default, the regions are found with a serial flood fill.  For large
+ * volumes, EnableSMPOn() selects a multithreaded two-pass algorithm that
+ * labels the runs of voxels in slabs of the image with union-find, and
+ * then merges the labels across the slab boundaries.  Both algorithms
+ * produce identical output.
+ *
  * @sa
  * vtkConnectivityFilter, vtkPolyDataConnectivityFilter
 */
@@ -293,6 +299,18 @@ public:
   vtkGetMacro(ActiveComponent, int);
   //@}
 
+  //@{
+  /**
+   * Use vtkSMPTools to find the connected regions in parallel, with a
+   * union-find over the runs of voxels in each slab of the image.  The
+   * labels, the region order, and all of the region information are
+   * identical to those of the serial flood fill.  The default is Off.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
 protected:
   vtkImageConnectivityFilter();
   ~vtkImageConnectivityFilter() VTK_OVERRIDE;
@@ -306,6 +324,7 @@ protected:
   int ActiveComponent;
   int LabelScalarType;
   int GenerateRegionExtents;
+  bool EnableSMP;
 
   vtkIdTypeArray *ExtractedRegionLabels;
   vtkIdTypeArray *ExtractedRegionSizes;
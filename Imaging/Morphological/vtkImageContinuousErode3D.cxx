@@ -17,6 +17,7 @@
 #include "vtkDataArray.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
+#include "vtkImageRankFilterInternals.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
@@ -106,95 +107,53 @@ void vtkImageContinuousErode3D::SetKernelSize(int size0, int size1, int size2)
 }
 
 //----------------------------------------------------------------------------
-// This templated function executes the filter on any region,
-// whether it needs boundary checking or not.
-// If the filter needs to be faster, the function could be duplicated
-// for strictly center (no boundary ) processing.
+// This templated function executes the filter on any region, whether it
+// needs boundary checking or not.  The minimum is kept in a window that
+// slides along the rows, see vtkImageRankFilterInternals.h.
 template <class T>
 void vtkImageContinuousErode3DExecute(vtkImageContinuousErode3D *self,
                                       vtkImageData *mask,
                                       vtkImageData *inData, T *inPtr,
                                       vtkImageData *outData,
                                       int *outExt, T *outPtr, int id,
-                                      vtkDataArray *inArray,
                                       vtkInformation *inInfo)
 {
-  int *kernelMiddle, *kernelSize;
-  // For looping though output (and input) pixels.
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  T *outPtr0, *outPtr1, *outPtr2;
-  int numComps, outIdxC;
-  // For looping through hood pixels
-  int hoodMin0, hoodMax0, hoodMin1, hoodMax1, hoodMin2, hoodMax2;
-  int hoodIdx0, hoodIdx1, hoodIdx2;
-  T *hoodPtr0, *hoodPtr1, *hoodPtr2;
-  // For looping through the mask.
-  unsigned char *maskPtr, *maskPtr0, *maskPtr1, *maskPtr2;
-  vtkIdType maskInc0, maskInc1, maskInc2;
-  // The extent of the whole input image
-  int inImageMin0, inImageMin1, inImageMin2;
-  int inImageMax0, inImageMax1, inImageMax2;
+  vtkIdType inInc[3], outInc[3], maskInc[3];
   int inImageExt[6];
-  // to compute the range
-  T pixelMin;
   unsigned long count = 0;
   unsigned long target;
-  int *inExt = inData->GetExtent();
 
   // Get information to march through data
-  inData->GetIncrements(inInc0, inInc1, inInc2);
+  inData->GetIncrements(inInc);
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inImageExt);
-  inImageMin0 = inImageExt[0];
-  inImageMax0 = inImageExt[1];
-  inImageMin1 = inImageExt[2];
-  inImageMax1 = inImageExt[3];
-  inImageMin2 = inImageExt[4];
-  inImageMax2 = inImageExt[5];
-  outData->GetIncrements(outInc0, outInc1, outInc2);
-  outMin0 = outExt[0];   outMax0 = outExt[1];
-  outMin1 = outExt[2];   outMax1 = outExt[3];
-  outMin2 = outExt[4];   outMax2 = outExt[5];
-  numComps = outData->GetNumberOfScalarComponents();
+  outData->GetIncrements(outInc);
+  int numComps = outData->GetNumberOfScalarComponents();
 
-  // Get ivars of this object (easier than making friends)
-  kernelSize = self->GetKernelSize();
-  kernelMiddle = self->GetKernelMiddle();
-  hoodMin0 = - kernelMiddle[0];
-  hoodMin1 = - kernelMiddle[1];
-  hoodMin2 = - kernelMiddle[2];
-  hoodMax0 = hoodMin0 + kernelSize[0] - 1;
-  hoodMax1 = hoodMin1 + kernelSize[1] - 1;
-  hoodMax2 = hoodMin2 + kernelSize[2] - 1;
+  // The neighborhood is given by the mask
+  mask->GetIncrements(maskInc);
+  vtkImageRankKernel kernel;
+  kernel.SetMask(static_cast<unsigned char *>(mask->GetScalarPointer()),
+                 maskInc, self->GetKernelSize(), self->GetKernelMiddle());
 
-  // Setup mask info
-  maskPtr = static_cast<unsigned char *>(mask->GetScalarPointer());
-  mask->GetIncrements(maskInc0, maskInc1, maskInc2);
-
-  // in and out should be marching through corresponding pixels.
-  inPtr = static_cast<T *>(inArray->GetVoidPointer((outMin0-inExt[0])*inInc0 +
-                                                   (outMin1-inExt[2])*inInc1 +
-                                                   (outMin2-inExt[4])*inInc2));
-
-  target = static_cast<unsigned long>(numComps*(outMax2-outMin2+1)*
-                                      (outMax1-outMin1+1)/50.0);
+  target = static_cast<unsigned long>(numComps*(outExt[5]-outExt[4]+1)*
+                                      (outExt[3]-outExt[2]+1)/50.0);
   target++;
 
+  typedef vtkImageRankRowFilter<T, vtkImageRankMinimum<T> > RowFilter;
+
   // loop through components
-  for (outIdxC = 0; outIdxC < numComps; ++outIdxC)
+  for (int outIdxC = 0; outIdxC < numComps; ++outIdxC)
   {
-    // loop through pixels of output
-    outPtr2 = outPtr;
-    inPtr2 = inPtr;
-    for (outIdx2 = outMin2; outIdx2 <= outMax2; ++outIdx2)
+    RowFilter rowFilter(
+      &kernel, inPtr + outIdxC, inData->GetExtent(), inInc, inImageExt);
+
+    // loop through rows of output
+    T *outPtr2 = outPtr + outIdxC;
+    for (int outIdx2 = outExt[4]; outIdx2 <= outExt[5]; ++outIdx2)
     {
-      outPtr1 = outPtr2;
-      inPtr1 = inPtr2;
-      for (outIdx1 = outMin1;
-           !self->AbortExecute && outIdx1 <= outMax1; ++outIdx1)
+      T *outPtr1 = outPtr2;
+      for (int outIdx1 = outExt[2];
+           !self->AbortExecute && outIdx1 <= outExt[3]; ++outIdx1)
       {
         if (!id)
         {
@@ -204,68 +163,12 @@ void vtkImageContinuousErode3DExecute(vtkImageContinuousErode3D *self,
           }
           count++;
         }
-        outPtr0 = outPtr1;
-        inPtr0 = inPtr1;
-        for (outIdx0 = outMin0; outIdx0 <= outMax0; ++outIdx0)
-        {
-
-          // Find min
-          pixelMin = *inPtr0;
-          // loop through neighborhood pixels
-          // as sort of a hack to handle boundaries,
-          // input pointer will be marching through data that does not exist.
-          hoodPtr2 = inPtr0 - kernelMiddle[0] * inInc0
-            - kernelMiddle[1] * inInc1 - kernelMiddle[2] * inInc2;
-          maskPtr2 = maskPtr;
-          for (hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
-          {
-            hoodPtr1 = hoodPtr2;
-            maskPtr1 = maskPtr2;
-            for (hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1; ++hoodIdx1)
-            {
-              hoodPtr0 = hoodPtr1;
-              maskPtr0 = maskPtr1;
-              for (hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
-              {
-                // A quick but rather expensive way to handle boundaries
-                if ( outIdx0 + hoodIdx0 >= inImageMin0 &&
-                     outIdx0 + hoodIdx0 <= inImageMax0 &&
-                     outIdx1 + hoodIdx1 >= inImageMin1 &&
-                     outIdx1 + hoodIdx1 <= inImageMax1 &&
-                     outIdx2 + hoodIdx2 >= inImageMin2 &&
-                     outIdx2 + hoodIdx2 <= inImageMax2)
-                {
-                  if (*maskPtr0)
-                  {
-                    if (*hoodPtr0 < pixelMin)
-                    {
-                      pixelMin = *hoodPtr0;
-                    }
-                  }
-                }
-
-                hoodPtr0 += inInc0;
-                maskPtr0 += maskInc0;
-              }
-              hoodPtr1 += inInc1;
-              maskPtr1 += maskInc1;
-            }
-            hoodPtr2 += inInc2;
-            maskPtr2 += maskInc2;
-          }
-          *outPtr0 = pixelMin;
-
-          inPtr0 += inInc0;
-          outPtr0 += outInc0;
-        }
-        inPtr1 += inInc1;
-        outPtr1 += outInc1;
+        rowFilter.Execute(outExt[0], outExt[1], outIdx1, outIdx2,
+                          outPtr1, outInc[0]);
+        outPtr1 += outInc[1];
       }
-      inPtr2 += inInc2;
-      outPtr2 += outInc2;
+      outPtr2 += outInc[2];
     }
-    ++inPtr;
-    ++outPtr;
   }
 }
 
@@ -289,17 +192,13 @@ void vtkImageContinuousErode3D::ThreadedRequestData(
     return;
   }
 
-  int inExt[6], wholeExt[6];
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
-  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
-  this->InternalRequestUpdateExtent(inExt,outExt,wholeExt);
   void *inPtr;
   void *outPtr = outData[0]->GetScalarPointerForExtent(outExt);
   vtkImageData *mask;
 
   vtkDataArray *inArray = this->GetInputArrayToProcess(0,inputVector);
 
-  // The inPtr is reset anyway, so just get the id 0 pointer.
   inPtr = inArray->GetVoidPointer(0);
 
   // Error checking on mask
@@ -327,7 +226,6 @@ void vtkImageContinuousErode3D::ThreadedRequestData(
                                        static_cast<VTK_TT *>(inPtr),
                                        outData[0], outExt,
                                        static_cast<VTK_TT *>(outPtr),id,
-                                       inArray,
                                        inInfo));
     default:
       vtkErrorMacro(<< "Execute: Unknown ScalarType");
@@ -62,6 +62,7 @@ POSSIBILITY OF SUCH DAMAGES.
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkSMPTools.h"
 
 #include <map>
 #include <vector>
@@ -284,81 +285,34 @@ bool EdgeLocator::InterpolateEdge(
 } // end anonymous namespace
 
 //----------------------------------------------------------------------------
-// Select contours within slice z
-void vtkPolyDataToImageStencil::PolyDataSelector(
-  vtkPolyData *input, vtkPolyData *output, double z, double thickness)
-{
-  vtkPoints *points = input->GetPoints();
-  vtkCellArray *lines = input->GetLines();
-  vtkPoints *newPoints = vtkPoints::New();
-  newPoints->SetDataType(points->GetDataType());
-  newPoints->Allocate(333);
-  vtkCellArray *newLines = vtkCellArray::New();
-  newLines->Allocate(1000);
-
-  double minz = z - 0.5*thickness;
-  double maxz = z + 0.5*thickness;
-
-  // use a map to avoid adding duplicate points
-  std::map<vtkIdType, vtkIdType> pointLocator;
+// Helper functions for cutting the polydata, and for sorting the cells
+// into bins according to the slices they intersect.
+namespace {
 
-  vtkIdType loc = 0;
-  vtkIdType numCells = lines->GetNumberOfCells();
-  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+// Get the range of z values for the points of a cell
+void GetCellZRange(
+  vtkPoints *points, vtkIdType npts, const vtkIdType *ptIds,
+  double zrange[2])
+{
+  zrange[0] = VTK_DOUBLE_MAX;
+  zrange[1] = -VTK_DOUBLE_MAX;
+  for (vtkIdType i = 0; i < npts; i++)
   {
-    // check if all points in cell are within the slice
-    vtkIdType npts, *ptIds;
-    lines->GetCell(loc, npts, ptIds);
-    loc += npts + 1;
-    vtkIdType i;
-    for (i = 0; i < npts; i++)
-    {
-      double point[3];
-      points->GetPoint(ptIds[i], point);
-      if (point[2] < minz || point[2] >= maxz)
-      {
-        break;
-      }
-    }
-    if (i < npts)
-    {
-      continue;
-    }
-    newLines->InsertNextCell(npts);
-    for (i = 0; i < npts; i++)
-    {
-      vtkIdType oldId = ptIds[i];
-      std::map<vtkIdType, vtkIdType>::iterator iter =
-        pointLocator.lower_bound(oldId);
-      vtkIdType ptId = 0;
-      if (iter == pointLocator.end() || iter->first != oldId)
-      {
-        double point[3];
-        points->GetPoint(oldId, point);
-        ptId = newPoints->InsertNextPoint(point);
-        pointLocator.insert(iter, std::make_pair(oldId, ptId));
-      }
-      else
-      {
-        ptId = iter->second;
-      }
-      newLines->InsertCellPoint(ptId);
-    }
+    double point[3];
+    points->GetPoint(ptIds[i], point);
+    zrange[0] = (point[2] < zrange[0] ? point[2] : zrange[0]);
+    zrange[1] = (point[2] > zrange[1] ? point[2] : zrange[1]);
   }
-
-  output->SetPoints(newPoints);
-  output->SetLines(newLines);
-  newPoints->Delete();
-  newLines->Delete();
 }
 
-//----------------------------------------------------------------------------
-void vtkPolyDataToImageStencil::PolyDataCutter(
-  vtkPolyData *input, vtkPolyData *output, double z)
+// The cells are identified by their location in the cell array, and if
+// there are two cell arrays (polys and strips), then the cells from the
+// second array are stored as -(loc + 1).
+void CutCells(
+  vtkPoints *points, vtkCellArray *cellArrays[2],
+  const vtkIdType *cellLocs, vtkIdType numCells,
+  vtkPolyData *output, double z)
 {
-  vtkPoints *points = input->GetPoints();
-  vtkCellArray *inputPolys = input->GetPolys();
-  vtkCellArray *inputStrips = input->GetStrips();
   vtkPoints *newPoints = vtkPoints::New();
   newPoints->SetDataType(points->GetDataType());
   newPoints->Allocate(333);
@@ -369,27 +323,23 @@ void vtkPolyDataToImageStencil::PolyDataCutter(
   EdgeLocator edgeLocator;
 
   // Go through all cells and clip them.
-  vtkIdType numPolys = input->GetNumberOfPolys();
-  vtkIdType numStrips = input->GetNumberOfStrips();
-  vtkIdType numCells = numPolys + numStrips;
-
-  vtkIdType loc = 0;
-  vtkCellArray *cellArray = inputPolys;
   for (vtkIdType cellId = 0; cellId < numCells; cellId++)
   {
-    // switch to strips when polys are done
-    if (cellId == numPolys)
-    {
-      loc = 0;
-      cellArray = inputStrips;
-    }
+    vtkIdType loc = cellLocs[cellId];
+    bool isStrip = (loc < 0);
 
     vtkIdType npts, *ptIds;
-    cellArray->GetCell(loc, npts, ptIds);
-    loc += npts + 1;
+    if (isStrip)
+    {
+      cellArrays[1]->GetCell(-(loc + 1), npts, ptIds);
+    }
+    else
+    {
+      cellArrays[0]->GetCell(loc, npts, ptIds);
+    }
 
     vtkIdType numSubCells = 1;
-    if (cellArray == inputStrips)
+    if (isStrip)
     {
       numSubCells = npts - 2;
       npts = 3;
@@ -451,47 +401,260 @@ void vtkPolyDataToImageStencil::PolyDataCutter(
   newLines->Delete();
 }
 
-//----------------------------------------------------------------------------
-void vtkPolyDataToImageStencil::ThreadedExecute(
-  vtkImageStencilData *data,
-  int extent[6],
-  int threadId)
+// Select the lines that are within the slice at z
+void SelectCells(
+  vtkPoints *points, vtkCellArray *lines,
+  const vtkIdType *cellLocs, vtkIdType numCells,
+  vtkPolyData *output, double z, double thickness)
 {
-  // Description of algorithm:
-  // 1) cut the polydata at each z slice to create polylines
-  // 2) find all "loose ends" and connect them to make polygons
-  //    (if the input polydata is closed, there will be no loose ends)
-  // 3) go through all line segments, and for each integer y value on
-  //    a line segment, store the x value at that point in a bucket
-  // 4) for each z integer index, find all the stored x values
-  //    and use them to create one z slice of the vtkStencilData
+  vtkPoints *newPoints = vtkPoints::New();
+  newPoints->SetDataType(points->GetDataType());
+  newPoints->Allocate(333);
+  vtkCellArray *newLines = vtkCellArray::New();
+  newLines->Allocate(1000);
 
-  // the spacing and origin of the generated stencil
-  double *spacing = data->GetSpacing();
-  double *origin = data->GetOrigin();
+  double minz = z - 0.5*thickness;
+  double maxz = z + 0.5*thickness;
 
-  // if we have no data then return
-  if (!this->GetInput()->GetNumberOfPoints())
+  // use a map to avoid adding duplicate points
+  std::map<vtkIdType, vtkIdType> pointLocator;
+
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
   {
-    return;
+    // check if all points in cell are within the slice
+    vtkIdType npts, *ptIds;
+    lines->GetCell(cellLocs[cellId], npts, ptIds);
+    vtkIdType i;
+    for (i = 0; i < npts; i++)
+    {
+      double point[3];
+      points->GetPoint(ptIds[i], point);
+      if (point[2] < minz || point[2] >= maxz)
+      {
+        break;
+      }
+    }
+    if (i < npts)
+    {
+      continue;
+    }
+    newLines->InsertNextCell(npts);
+    for (i = 0; i < npts; i++)
+    {
+      vtkIdType oldId = ptIds[i];
+      std::map<vtkIdType, vtkIdType>::iterator iter =
+        pointLocator.lower_bound(oldId);
+      vtkIdType ptId = 0;
+      if (iter == pointLocator.end() || iter->first != oldId)
+      {
+        double point[3];
+        points->GetPoint(oldId, point);
+        ptId = newPoints->InsertNextPoint(point);
+        pointLocator.insert(iter, std::make_pair(oldId, ptId));
+      }
+      else
+      {
+        ptId = iter->second;
+      }
+      newLines->InsertCellPoint(ptId);
+    }
+  }
+
+  output->SetPoints(newPoints);
+  output->SetLines(newLines);
+  newPoints->Delete();
+  newLines->Delete();
+}
+
+// Get the locations of all cells in one or two cell arrays
+void GetAllCells(
+  vtkCellArray *cellArrays[2], std::vector<vtkIdType> &cellLocs)
+{
+  for (int a = 0; a < 2; a++)
+  {
+    if (cellArrays[a])
+    {
+      vtkIdType npts, *ptIds;
+      vtkIdType size = cellArrays[a]->GetNumberOfConnectivityEntries();
+      for (vtkIdType loc = 0; loc < size; loc += npts + 1)
+      {
+        cellArrays[a]->GetCell(loc, npts, ptIds);
+        cellLocs.push_back(a == 0 ? loc : -(loc + 1));
+      }
+    }
+  }
+}
+
+// The cells are sorted into bins, one bin per z slice, so that each
+// slice only has to visit the cells that might intersect it.  Once they
+// are built, the bins are only read, and are shared by all the threads.
+class SliceCellBins
+{
+public:
+  // Build the bins for the slices in zExtent, where slice k is at
+  // z = origin + k*spacing.  For contours, a cell is only put into the
+  // bins for the slabs (of thickness "spacing") that might contain it.
+  void Build(vtkPoints *points, vtkCellArray *cellArrays[2],
+             const int zExtent[2], double origin, double spacing,
+             bool contours);
+
+  // Get the cells for slice idxZ (see CutCells for the cell encoding)
+  const vtkIdType *GetCells(int idxZ, vtkIdType &numCells) const
+  {
+    size_t i = static_cast<size_t>(idxZ - this->ZMin);
+    numCells = this->Offsets[i + 1] - this->Offsets[i];
+    return (numCells > 0 ? &this->Cells[this->Offsets[i]] : 0);
+  }
+
+private:
+  int ZMin;
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Cells;
+};
+
+void SliceCellBins::Build(
+  vtkPoints *points, vtkCellArray *cellArrays[2], const int zExtent[2],
+  double origin, double spacing, bool contours)
+{
+  std::vector<vtkIdType> cellLocs;
+  GetAllCells(cellArrays, cellLocs);
+  size_t numCells = cellLocs.size();
+
+  // compute the range of slices for each cell
+  std::vector<int> sliceRanges(2*numCells);
+  for (size_t cellId = 0; cellId < numCells; cellId++)
+  {
+    vtkIdType loc = cellLocs[cellId];
+    vtkIdType npts, *ptIds;
+    if (loc < 0)
+    {
+      cellArrays[1]->GetCell(-(loc + 1), npts, ptIds);
+    }
+    else
+    {
+      cellArrays[0]->GetCell(loc, npts, ptIds);
+    }
+
+    double zrange[2];
+    GetCellZRange(points, npts, ptIds, zrange);
+    double t0 = (zrange[0] - origin)/spacing;
+    double t1 = (zrange[1] - origin)/spacing;
+    if (t0 > t1)
+    {
+      double tmp = t0;
+      t0 = t1;
+      t1 = tmp;
+    }
+    if (contours)
+    {
+      // a contour that is thicker than a slab cannot be selected
+      t0 -= 0.5;
+      t1 += 0.5;
+      if (t1 - t0 > 2.0)
+      {
+        t1 = t0 - 1.0;
+      }
+    }
+
+    // the range is conservative, the cutter will reject extra cells
+    int k0 = zExtent[0];
+    int k1 = zExtent[0] - 1;
+    if (npts > 0 && t0 <= zExtent[1] + 1.0 && t1 >= zExtent[0] - 1.0)
+    {
+      k0 = vtkMath::Floor(t0 > zExtent[0] ? t0 : zExtent[0]);
+      k1 = vtkMath::Ceil(t1 < zExtent[1] ? t1 : zExtent[1]);
+    }
+    sliceRanges[2*cellId] = k0;
+    sliceRanges[2*cellId + 1] = k1;
+  }
+
+  // count the cells in each bin, and compute the offset to each bin
+  this->ZMin = zExtent[0];
+  size_t numBins = static_cast<size_t>(zExtent[1] - zExtent[0] + 1);
+  this->Offsets.assign(numBins + 1, 0);
+  for (size_t cellId = 0; cellId < numCells; cellId++)
+  {
+    for (int k = sliceRanges[2*cellId]; k <= sliceRanges[2*cellId + 1]; k++)
+    {
+      this->Offsets[k - this->ZMin + 1]++;
+    }
+  }
+  for (size_t i = 0; i < numBins; i++)
+  {
+    this->Offsets[i + 1] += this->Offsets[i];
+  }
+
+  // fill the bins, the cells in each bin stay in their original order
+  this->Cells.resize(this->Offsets[numBins]);
+  std::vector<vtkIdType> next(this->Offsets.begin(), this->Offsets.end() - 1);
+  for (size_t cellId = 0; cellId < numCells; cellId++)
+  {
+    for (int k = sliceRanges[2*cellId]; k <= sliceRanges[2*cellId + 1]; k++)
+    {
+      this->Cells[next[k - this->ZMin]++] = cellLocs[cellId];
+    }
+  }
+}
+
+// The functor that processes a range of slices.  Each call has its own
+// raster and slice polydata, and the stencil rows for each slice are
+// only written by the call that owns the slice.
+class SliceFunctor
+{
+public:
+  SliceFunctor(vtkPolyDataToImageStencil *self, vtkImageStencilData *data,
+               const int extent[6], vtkPoints *points,
+               vtkCellArray *cellArrays[2], bool contours,
+               const SliceCellBins *bins, bool reportProgress) :
+    Self(self), Data(data), Points(points), Contours(contours),
+    Bins(bins), ReportProgress(reportProgress)
+  {
+    for (int i = 0; i < 6; i++)
+    {
+      this->Extent[i] = extent[i];
+    }
+    this->CellArrays[0] = cellArrays[0];
+    this->CellArrays[1] = cellArrays[1];
   }
 
+  void operator()(vtkIdType begin, vtkIdType end);
+
+private:
+  vtkPolyDataToImageStencil *Self;
+  vtkImageStencilData *Data;
+  int Extent[6];
+  vtkPoints *Points;
+  vtkCellArray *CellArrays[2];
+  bool Contours;
+  const SliceCellBins *Bins;
+  bool ReportProgress;
+};
+
+void SliceFunctor::operator()(vtkIdType begin, vtkIdType end)
+{
+  vtkImageStencilData *data = this->Data;
+  const int *extent = this->Extent;
+
+  // only the range that starts at the first slice reports progress
+  bool reportProgress = (this->ReportProgress && begin == extent[4]);
+
+  // the spacing and origin of the generated stencil
+  double *spacing = data->GetSpacing();
+  double *origin = data->GetOrigin();
+
   // Only divide once
   double invspacing[3];
   invspacing[0] = 1.0/spacing[0];
   invspacing[1] = 1.0/spacing[1];
   invspacing[2] = 1.0/spacing[2];
 
-  // get the input data
-  vtkPolyData *input = this->GetInput();
-
   // the output produced by cutting the polydata with the Z plane
   vtkPolyData *slice = vtkPolyData::New();
 
   // This raster stores all line segments by recording all "x"
   // positions on the surface for each y integer position.
   vtkImageStencilRaster raster(&extent[2]);
-  raster.SetTolerance(this->Tolerance);
+  raster.SetTolerance(this->Self->GetTolerance());
 
   // The extent for one slice of the image
   int sliceExtent[6];
@@ -500,11 +663,12 @@ void vtkPolyDataToImageStencil::ThreadedExecute(
   sliceExtent[4] = extent[4]; sliceExtent[5] = extent[4];
 
   // Loop through the slices
-  for (int idxZ = extent[4]; idxZ <= extent[5]; idxZ++)
+  for (int idxZ = static_cast<int>(begin); idxZ < end; idxZ++)
   {
-    if (threadId == 0)
+    if (reportProgress)
     {
-      this->UpdateProgress((idxZ - extent[4])*1.0/(extent[5] - extent[4] + 1));
+      this->Self->UpdateProgress(
+        (idxZ - extent[4])*1.0/(extent[5] - extent[4] + 1));
     }
 
     double z = idxZ*spacing[2] + origin[2];
@@ -512,15 +676,18 @@ void vtkPolyDataToImageStencil::ThreadedExecute(
     slice->PrepareForNewData();
     raster.PrepareForNewData();
 
-    // Step 1: Cut the data into slices
-    if (input->GetNumberOfPolys() > 0 || input->GetNumberOfStrips() > 0)
+    // Step 1: Cut the data into slices, using only the cells in the bin
+    vtkIdType numCells;
+    const vtkIdType *cellLocs = this->Bins->GetCells(idxZ, numCells);
+    if (!this->Contours)
     {
-      this->PolyDataCutter(input, slice, z);
+      CutCells(this->Points, this->CellArrays, cellLocs, numCells, slice, z);
     }
     else
     {
       // if no polys, select polylines instead
-      this->PolyDataSelector(input, slice, z, spacing[2]);
+      SelectCells(this->Points, this->CellArrays[0], cellLocs, numCells,
+                  slice, z, spacing[2]);
     }
 
     if (!slice->GetNumberOfLines())
@@ -768,6 +935,83 @@ void vtkPolyDataToImageStencil::ThreadedExecute(
   slice->Delete();
 }
 
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+// Select contours within slice z
+void vtkPolyDataToImageStencil::PolyDataSelector(
+  vtkPolyData *input, vtkPolyData *output, double z, double thickness)
+{
+  vtkCellArray *cellArrays[2] = { input->GetLines(), 0 };
+  std::vector<vtkIdType> cellLocs;
+  GetAllCells(cellArrays, cellLocs);
+
+  SelectCells(input->GetPoints(), cellArrays[0],
+              (cellLocs.empty() ? 0 : &cellLocs[0]),
+              static_cast<vtkIdType>(cellLocs.size()),
+              output, z, thickness);
+}
+
+//----------------------------------------------------------------------------
+void vtkPolyDataToImageStencil::PolyDataCutter(
+  vtkPolyData *input, vtkPolyData *output, double z)
+{
+  vtkCellArray *cellArrays[2] = { input->GetPolys(), input->GetStrips() };
+  std::vector<vtkIdType> cellLocs;
+  GetAllCells(cellArrays, cellLocs);
+
+  CutCells(input->GetPoints(), cellArrays,
+           (cellLocs.empty() ? 0 : &cellLocs[0]),
+           static_cast<vtkIdType>(cellLocs.size()),
+           output, z);
+}
+
+//----------------------------------------------------------------------------
+void vtkPolyDataToImageStencil::ThreadedExecute(
+  vtkImageStencilData *data,
+  int extent[6],
+  int threadId)
+{
+  // Description of algorithm:
+  // 1) cut the polydata at each z slice to create polylines
+  // 2) find all "loose ends" and connect them to make polygons
+  //    (if the input polydata is closed, there will be no loose ends)
+  // 3) go through all line segments, and for each integer y value on
+  //    a line segment, store the x value at that point in a bucket
+  // 4) for each z integer index, find all the stored x values
+  //    and use them to create one z slice of the vtkStencilData
+  // The slices are independent, so they are done in parallel with
+  // vtkSMPTools, after the cells have been sorted into bins by slice.
+
+  // if we have no data then return
+  vtkPolyData *input = this->GetInput();
+  if (!input->GetNumberOfPoints() || extent[4] > extent[5])
+  {
+    return;
+  }
+
+  // cut the polys and strips, or select the lines if there are no polys
+  bool contours = (input->GetNumberOfPolys() == 0 &&
+                   input->GetNumberOfStrips() == 0);
+  vtkCellArray *cellArrays[2] = { input->GetPolys(), input->GetStrips() };
+  if (contours)
+  {
+    cellArrays[0] = input->GetLines();
+    cellArrays[1] = 0;
+  }
+
+  // sort the cells into bins, one bin per slice
+  double *spacing = data->GetSpacing();
+  double *origin = data->GetOrigin();
+  SliceCellBins bins;
+  bins.Build(input->GetPoints(), cellArrays, &extent[4],
+             origin[2], spacing[2], contours);
+
+  SliceFunctor functor(this, data, extent, input->GetPoints(), cellArrays,
+                       contours, &bins, (threadId == 0));
+  vtkSMPTools::For(extent[4], extent[5] + 1, functor);
+}
+
 //----------------------------------------------------------------------------
 int vtkPolyDataToImageStencil::RequestData(
   vtkInformation *request,
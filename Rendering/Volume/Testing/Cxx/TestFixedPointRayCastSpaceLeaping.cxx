@@ -0,0 +1,267 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFixedPointRayCastSpaceLeaping.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkFixedPointVolumeRayCastMapper gives the same image with
+// and without HierarchicalSpaceLeaping, for composite (with and without
+// shading and gradient opacity), MIP and MinIP, from several directions,
+// and after the transfer functions change so that the min/max pyramid is
+// updated. The images are rendered with CreateCanonicalView(), which does
+// not need an on-screen window.
+
+#include "vtkSmartPointer.h"
+#include "vtkColorTransferFunction.h"
+#include "vtkFixedPointVolumeRayCastMapper.h"
+#include "vtkImageData.h"
+#include "vtkPiecewiseFunction.h"
+#include "vtkVolume.h"
+#include "vtkVolumeMapper.h"
+#include "vtkVolumeProperty.h"
+
+#include <cstring>
+
+namespace {
+
+// a sparse volume: a few boxes of different values in an empty volume,
+// so that rays cross large empty regions between them, or the inverse
+// of that volume for MinIP
+vtkSmartPointer<vtkImageData> MakeVolume(bool invert)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(70, 52, 45);
+  image->SetSpacing(1.0, 1.0, 1.5);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
+  const int boxes[3][6] = {
+    { 5, 14, 30, 41, 3, 10 }, { 33, 50, 6, 19, 18, 29 },
+    { 55, 61, 38, 47, 36, 41 } };
+  const int values[3] = { 100, 150, 200 };
+
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  for (int k = 0; k < 45; k++)
+  {
+    for (int j = 0; j < 52; j++)
+    {
+      for (int i = 0; i < 70; i++)
+      {
+        int v = 10;
+        for (int b = 0; b < 3; b++)
+        {
+          if (i >= boxes[b][0] && i <= boxes[b][1] &&
+              j >= boxes[b][2] && j <= boxes[b][3] &&
+              k >= boxes[b][4] && k <= boxes[b][5])
+          {
+            v = values[b] + 20*((i + 2*j + 3*k) % 3);
+          }
+        }
+        *ptr++ = static_cast<unsigned char>(invert ? 255 - v : v);
+      }
+    }
+  }
+
+  return image;
+}
+
+vtkSmartPointer<vtkImageData> Render(
+  vtkFixedPointVolumeRayCastMapper *mapper, vtkVolume *volume,
+  int blendMode, int direction, int hierarchical)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(120, 100, 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+
+  const double directions[3][3] = {
+    { 0.3, -0.4, 1.0 }, { -1.0, 0.2, -0.3 }, { 0.1, 1.0, 0.05 } };
+  double viewUp[3] = { 0.0, 0.2, 1.0 };
+  if (direction == 0)
+  {
+    viewUp[1] = 1.0;
+    viewUp[2] = 0.2;
+  }
+  mapper->SetHierarchicalSpaceLeaping(hierarchical);
+  mapper->CreateCanonicalView(volume, image, blendMode,
+                              const_cast<double *>(directions[direction]),
+                              viewUp);
+  return image;
+}
+
+// render with the min/max pyramid, and check that it was built
+vtkSmartPointer<vtkImageData> RenderWithPyramid(
+  vtkFixedPointVolumeRayCastMapper *mapper, vtkVolume *volume,
+  int blendMode, int direction, const char *name, int *rval)
+{
+  vtkSmartPointer<vtkImageData> image =
+    Render(mapper, volume, blendMode, direction, 1);
+  if (mapper->GetNumberOfSpaceLeapingLevels() != 6)
+  {
+    cerr << name << ": the min/max pyramid has "
+         << mapper->GetNumberOfSpaceLeapingLevels() << " levels\n";
+    *rval |= 1;
+  }
+  return image;
+}
+
+// render with and without the min/max pyramid and compare, with the
+// pyramid first to use the pyramid of the previous render
+int CompareImages(vtkFixedPointVolumeRayCastMapper *mapper,
+                  vtkVolume *volume, int blendMode, const char *name,
+                  bool hierarchicalFirst = false)
+{
+  int rval = 0;
+  for (int d = 0; d < 3; d++)
+  {
+    vtkSmartPointer<vtkImageData> image;
+    if (hierarchicalFirst && d == 0)
+    {
+      image = RenderWithPyramid(mapper, volume, blendMode, d, name, &rval);
+    }
+
+    vtkSmartPointer<vtkImageData> reference =
+      Render(mapper, volume, blendMode, d, 0);
+    if (mapper->GetNumberOfSpaceLeapingLevels() != 0)
+    {
+      cerr << name << ": the min/max pyramid was built while off\n";
+      rval |= 1;
+    }
+
+    double range[2];
+    reference->GetScalarRange(range);
+    if (range[1] == 0.0)
+    {
+      cerr << name << ": the image is empty\n";
+      rval |= 1;
+    }
+
+    if (!image)
+    {
+      image = RenderWithPyramid(mapper, volume, blendMode, d, name, &rval);
+    }
+
+    if (memcmp(reference->GetScalarPointer(), image->GetScalarPointer(),
+               120*100*3))
+    {
+      cerr << name << ": images differ for direction " << d << "\n";
+      rval |= 1;
+    }
+  }
+  return rval;
+}
+
+} // end anonymous namespace
+
+int TestFixedPointRayCastSpaceLeaping(int, char *[])
+{
+  int rval = 0;
+
+  vtkSmartPointer<vtkImageData> data = MakeVolume(false);
+  vtkSmartPointer<vtkImageData> invertedData = MakeVolume(true);
+
+  vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> mapper =
+    vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+  mapper->SetInputData(data);
+  mapper->SetIntermixIntersectingGeometry(0);
+
+  vtkSmartPointer<vtkPiecewiseFunction> opacity =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  opacity->AddPoint(0.0, 0.0);
+  opacity->AddPoint(90.0, 0.0);
+  opacity->AddPoint(100.0, 0.3);
+  opacity->AddPoint(255.0, 0.3);
+
+  vtkSmartPointer<vtkPiecewiseFunction> gradientOpacity =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  gradientOpacity->AddPoint(0.0, 0.2);
+  gradientOpacity->AddPoint(30.0, 1.0);
+
+  vtkSmartPointer<vtkColorTransferFunction> color =
+    vtkSmartPointer<vtkColorTransferFunction>::New();
+  color->AddRGBPoint(0.0, 1.0, 0.5, 0.0);
+  color->AddRGBPoint(255.0, 1.0, 1.0, 1.0);
+
+  vtkSmartPointer<vtkVolumeProperty> property =
+    vtkSmartPointer<vtkVolumeProperty>::New();
+  property->SetScalarOpacity(opacity);
+  property->SetColor(color);
+
+  vtkSmartPointer<vtkVolume> volume = vtkSmartPointer<vtkVolume>::New();
+  volume->SetMapper(mapper);
+  volume->SetProperty(property);
+
+  // composite, then with shading, then with gradient opacity, with
+  // nearest and linear interpolation
+  for (int mode = 0; mode < 6; mode++)
+  {
+    const char *names[6] = {
+      "Composite", "Shaded", "Gradient opacity",
+      "Nearest composite", "Nearest shaded", "Nearest gradient opacity" };
+    property->SetShade(mode % 3 == 1);
+    property->SetGradientOpacity(
+      mode % 3 == 2 ? gradientOpacity.GetPointer() : 0);
+    property->SetInterpolationType(mode < 3 ? VTK_LINEAR_INTERPOLATION :
+                                   VTK_NEAREST_INTERPOLATION);
+    rval |= CompareImages(mapper, volume, vtkVolumeMapper::COMPOSITE_BLEND,
+                          names[mode]);
+  }
+
+  // MIP, and MinIP of the inverted volume, with and without cropping
+  vtkSmartPointer<vtkPiecewiseFunction> flatOpacity =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  flatOpacity->AddPoint(0.0, 0.5);
+  flatOpacity->AddPoint(255.0, 0.5);
+
+  property->SetShade(0);
+  property->SetGradientOpacity(0);
+  mapper->SetCroppingRegionPlanes(3.0, 60.0, 4.0, 45.0, 5.0, 60.0);
+  for (int mode = 0; mode < 6; mode++)
+  {
+    const char *names[6] = {
+      "MIP", "Nearest MIP", "Cropped MIP",
+      "MinIP", "Nearest MinIP", "Cropped MinIP" };
+    int blendMode = (mode < 3 ? vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND :
+                     vtkVolumeMapper::MINIMUM_INTENSITY_BLEND);
+    mapper->SetInputData(mode < 3 ? data : invertedData);
+    property->SetScalarOpacity(mode < 3 ? opacity : flatOpacity);
+    property->SetInterpolationType(mode % 3 == 1 ?
+                                   VTK_NEAREST_INTERPOLATION :
+                                   VTK_LINEAR_INTERPOLATION);
+    mapper->SetCropping(mode % 3 == 2);
+    rval |= CompareImages(mapper, volume, blendMode, names[mode]);
+  }
+  mapper->SetInputData(data);
+  property->SetScalarOpacity(opacity);
+  mapper->SetCropping(0);
+
+  // show only the last box, then reveal the other boxes one at a time, so
+  // that only the flags of the min/max volume change and the pyramid is
+  // updated rather than rebuilt
+  property->SetInterpolationTypeToLinear();
+  const double thresholds[3] = { 190.0, 140.0, 90.0 };
+  for (int i = 0; i < 3; i++)
+  {
+    opacity->RemoveAllPoints();
+    opacity->AddPoint(0.0, 0.0);
+    opacity->AddPoint(thresholds[i], 0.0);
+    opacity->AddPoint(thresholds[i] + 10.0, 0.5);
+    opacity->AddPoint(255.0, 0.5);
+    if (i == 0)
+    {
+      Render(mapper, volume, vtkVolumeMapper::COMPOSITE_BLEND, 0, 1);
+      continue;
+    }
+    rval |= CompareImages(mapper, volume, vtkVolumeMapper::COMPOSITE_BLEND,
+                          "Updated composite", true);
+  }
+
+  return rval;
+}
@@ -0,0 +1,220 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFixedPointRayCastTiles.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkFixedPointVolumeRayCastMapper gives the same image when it
+// renders tiles with vtkSMPTools as when it interleaves rows among the
+// threads of the multithreader, for composite (with and without shading
+// and gradient opacity), MIP and MinIP. The images are rendered with
+// CreateCanonicalView(), which does not need an on-screen window.
+
+#include "vtkSmartPointer.h"
+#include "vtkColorTransferFunction.h"
+#include "vtkFixedPointVolumeRayCastMapper.h"
+#include "vtkImageData.h"
+#include "vtkPiecewiseFunction.h"
+#include "vtkVolume.h"
+#include "vtkVolumeMapper.h"
+#include "vtkVolumeProperty.h"
+
+#include <cstring>
+
+namespace {
+
+// a sparse volume: two boxes in an empty volume, so that most of the
+// tiles are empty. The boxes start just after a 4x4x4 block boundary, so
+// that the blocks of the min/max volume fit them closely.
+vtkSmartPointer<vtkImageData> MakeVolume()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(64, 48, 40);
+  image->SetSpacing(1.0, 1.0, 1.5);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
+  const int boxes[2][6] = {
+    { 13, 22, 9, 18, 5, 14 }, { 37, 50, 25, 38, 21, 30 } };
+
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  for (int k = 0; k < 40; k++)
+  {
+    for (int j = 0; j < 48; j++)
+    {
+      for (int i = 0; i < 64; i++)
+      {
+        int v = 0;
+        for (int b = 0; b < 2; b++)
+        {
+          if (i >= boxes[b][0] && i <= boxes[b][1] &&
+              j >= boxes[b][2] && j <= boxes[b][3] &&
+              k >= boxes[b][4] && k <= boxes[b][5])
+          {
+            v = 150 + 50*((i + 2*j + 3*k) % 3);
+          }
+        }
+        *ptr++ = static_cast<unsigned char>(v);
+      }
+    }
+  }
+
+  return image;
+}
+
+vtkSmartPointer<vtkImageData> Render(
+  vtkFixedPointVolumeRayCastMapper *mapper, vtkVolume *volume,
+  int blendMode, int enableSMP, int tileSize)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(150, 130, 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+
+  double direction[3] = { 0.3, -0.4, 1.0 };
+  double viewUp[3] = { 0.0, 1.0, 0.2 };
+  mapper->SetEnableSMP(enableSMP);
+  mapper->SetTileSize(tileSize);
+  mapper->CreateCanonicalView(volume, image, blendMode, direction, viewUp);
+  return image;
+}
+
+int CompareImages(vtkImageData *image1, vtkImageData *image2,
+                  const char *name, int tileSize)
+{
+  size_t n = 150*130*3;
+  if (memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), n))
+  {
+    cerr << name << ": images differ with tile size " << tileSize << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+int CheckStatistics(vtkFixedPointVolumeRayCastMapper *mapper,
+                    const char *name, bool expectEmpty)
+{
+  int total = 0;
+  for (int i = 0; i < mapper->GetNumberOfTileThreads(); i++)
+  {
+    total += mapper->GetNumberOfTilesForThread(i);
+  }
+
+  int numTiles = mapper->GetNumberOfTiles();
+  int numEmpty = mapper->GetNumberOfEmptyTiles();
+  if (numTiles == 0 || total != numTiles || numEmpty >= numTiles ||
+      (expectEmpty ? numEmpty == 0 : numEmpty != 0))
+  {
+    cerr << name << ": " << numTiles << " tiles, " << numEmpty
+         << " empty tiles, " << total << " tiles rendered by "
+         << mapper->GetNumberOfTileThreads() << " threads\n";
+    return 1;
+  }
+  return 0;
+}
+
+} // end anonymous namespace
+
+int TestFixedPointRayCastTiles(int, char *[])
+{
+  int rval = 0;
+
+  vtkSmartPointer<vtkImageData> data = MakeVolume();
+
+  vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> mapper =
+    vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+  mapper->SetInputData(data);
+  mapper->SetIntermixIntersectingGeometry(0);
+
+  vtkSmartPointer<vtkPiecewiseFunction> opacity =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  opacity->AddPoint(0.0, 0.0);
+  opacity->AddPoint(40.0, 0.0);
+  opacity->AddPoint(50.0, 0.8);
+  opacity->AddPoint(255.0, 0.8);
+
+  vtkSmartPointer<vtkPiecewiseFunction> gradientOpacity =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  gradientOpacity->AddPoint(0.0, 0.2);
+  gradientOpacity->AddPoint(30.0, 1.0);
+
+  vtkSmartPointer<vtkColorTransferFunction> color =
+    vtkSmartPointer<vtkColorTransferFunction>::New();
+  color->AddRGBPoint(0.0, 1.0, 0.5, 0.0);
+  color->AddRGBPoint(255.0, 1.0, 1.0, 1.0);
+
+  vtkSmartPointer<vtkVolumeProperty> property =
+    vtkSmartPointer<vtkVolumeProperty>::New();
+  property->SetScalarOpacity(opacity);
+  property->SetColor(color);
+
+  vtkSmartPointer<vtkVolume> volume = vtkSmartPointer<vtkVolume>::New();
+  volume->SetMapper(mapper);
+  volume->SetProperty(property);
+
+  const int tileSizes[3] = { 4, 16, 32 };
+
+  // composite, then with shading, then with gradient opacity, with
+  // nearest and linear interpolation
+  for (int mode = 0; mode < 6; mode++)
+  {
+    const char *names[6] = {
+      "Composite", "Shaded", "Gradient opacity",
+      "Nearest composite", "Nearest shaded", "Nearest gradient opacity" };
+    property->SetShade(mode % 3 == 1);
+    property->SetGradientOpacity(
+      mode % 3 == 2 ? gradientOpacity.GetPointer() : 0);
+    property->SetInterpolationType(mode < 3 ? VTK_LINEAR_INTERPOLATION :
+                                   VTK_NEAREST_INTERPOLATION);
+
+    vtkSmartPointer<vtkImageData> reference = Render(
+      mapper, volume, vtkVolumeMapper::COMPOSITE_BLEND, 0, 32);
+
+    double range[2];
+    reference->GetScalarRange(range);
+    if (range[1] == 0.0)
+    {
+      cerr << names[mode] << ": the image is empty\n";
+      rval |= 1;
+    }
+
+    for (int t = 0; t < 3; t++)
+    {
+      vtkSmartPointer<vtkImageData> image = Render(
+        mapper, volume, vtkVolumeMapper::COMPOSITE_BLEND, 1, tileSizes[t]);
+      rval |= CompareImages(reference, image, names[mode], tileSizes[t]);
+      rval |= CheckStatistics(mapper, names[mode], true);
+    }
+  }
+
+  // no tiles are skipped for MIP and MinIP
+  property->SetShade(0);
+  property->SetGradientOpacity(0);
+  property->SetInterpolationTypeToLinear();
+  const int blendModes[2] = {
+    vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND,
+    vtkVolumeMapper::MINIMUM_INTENSITY_BLEND };
+  const char *blendNames[2] = { "MIP", "MinIP" };
+  for (int b = 0; b < 2; b++)
+  {
+    vtkSmartPointer<vtkImageData> reference = Render(
+      mapper, volume, blendModes[b], 0, 32);
+
+    for (int t = 0; t < 3; t++)
+    {
+      vtkSmartPointer<vtkImageData> image = Render(
+        mapper, volume, blendModes[b], 1, tileSizes[t]);
+      rval |= CompareImages(reference, image, blendNames[b], tileSizes[t]);
+      rval |= CheckStatistics(mapper, blendNames[b], false);
+    }
+  }
+
+  return rval;
+}
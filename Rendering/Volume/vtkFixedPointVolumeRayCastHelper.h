@@ -706,6 +706,13 @@
                                         mapper->GetCroppingRegionFlags() != 0x2000 );           \
                                                                                                 \
   components = (components < 4) ? components : 4;                                               \
+                                                                                                \
+  int workBounds[4];                                                                            \
+  int rowStep;                                                                                  \
+  int rowStart, rowEnd;                                                                         \
+  int reportProgress =                                                                          \
+    mapper->GetWorkBounds( threadID, threadCount, workBounds, &rowStep );                       \
+                                                                                                \
   unsigned short *colorTable[4];                                                                \
   unsigned short *scalarOpacityTable[4];                                                        \
                                                                                                 \
@@ -814,22 +821,22 @@
   vtkIdType dDHinc = dim[0]*dirOffset + dirOffset;
 
 #define VTKKWRCHelper_OuterInitialization()                             \
-    if ( j%threadCount != threadID )                                    \
+    if ( reportProgress )                                               \
     {                                                                 \
-      continue;                                                         \
-    }                                                                 \
-     if ( !threadID )                                                   \
-     {                                                                 \
       if ( renWin->CheckAbortStatus() )                                 \
       {                                                               \
         break;                                                          \
       }                                                               \
-     }                                                                 \
+    }                                                                 \
     else if ( renWin->GetAbortRender() )                                \
     {                                                                 \
       break;                                                            \
     }                                                                 \
-    imagePtr = image + 4*(j*imageMemorySize[0] + rowBounds[j*2]);
+    rowStart = ( rowBounds[j*2] > workBounds[0] ) ?                     \
+      ( rowBounds[j*2] ) : ( workBounds[0] );                           \
+    rowEnd = ( rowBounds[j*2+1] < workBounds[1] ) ?                     \
+      ( rowBounds[j*2+1] ) : ( workBounds[1] );                         \
+    imagePtr = image + 4*(j*imageMemorySize[0] + rowStart);
 
 #define VTKKWRCHelper_InnerInitialization()             \
   unsigned int   numSteps;                              \
@@ -985,30 +992,30 @@
 
 #define VTKKWRCHelper_InitializationAndLoopStartNN()            \
   VTKKWRCHelper_InitializeVariables();                          \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
 #define VTKKWRCHelper_InitializationAndLoopStartGONN()          \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesGO();                        \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
 #define VTKKWRCHelper_InitializationAndLoopStartShadeNN()       \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesShade();                     \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
@@ -1016,20 +1023,20 @@
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesGO();                        \
   VTKKWRCHelper_InitializeVariablesShade();                     \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
 #define VTKKWRCHelper_InitializationAndLoopStartTrilin()        \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
@@ -1038,10 +1045,10 @@
   VTKKWRCHelper_InitializeVariablesGO();                        \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesGO();                  \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
@@ -1050,10 +1057,10 @@
   VTKKWRCHelper_InitializeVariablesShade();                     \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesShade();               \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
@@ -1064,17 +1071,17 @@
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesShade();               \
   VTKKWRCHelper_InitializeTrilinVariablesGO();                  \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  for ( j = workBounds[2]; j <= workBounds[3]; j += rowStep )   \
   {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
-    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
+    for ( i = rowStart; i <= rowEnd; i++ )                      \
     {                                                         \
       VTKKWRCHelper_InnerInitialization();
 
 #define VTKKWRCHelper_IncrementAndLoopEnd()                                             \
       imagePtr+=4;                                                                      \
       }                                                                                 \
-    if ( (j/threadCount)%8 == 7 && threadID == 0)                                       \
+    if ( reportProgress && ((j-workBounds[2])/rowStep)%8 == 7 )                         \
     {                                                                                 \
       double fargs[1];                                                                  \
       fargs[0] = static_cast<double>(j)/static_cast<float>(imageInUseSize[1]-1);        \
@@ -1114,6 +1121,21 @@
   mmpos[2] = 0;                                 \
   int mmvalid[4] = {0,0,0,0};
 
+// Leap over the samples that follow sample k in a region that can be
+// skipped, stopping before the last sample so that the loop still ends
+// the way it would have without the leap.
+#define VTKKWRCHelper_SpaceLeap( LEAP )                         \
+  if ( k + 2 < numSteps )                                       \
+  {                                                           \
+    unsigned int leapSteps = (LEAP);                            \
+    if ( leapSteps > numSteps - 2 - k )                         \
+    {                                                         \
+      leapSteps = numSteps - 2 - k;                             \
+    }                                                         \
+    mapper->FixedPointLeap( pos, dir, leapSteps );              \
+    k += leapSteps;                                             \
+  }
+
 #define VTKKWRCHelper_SpaceLeapCheck()                          \
   if ( pos[0] >> VTKKW_FPMM_SHIFT != mmpos[0] ||                \
        pos[1] >> VTKKW_FPMM_SHIFT != mmpos[1] ||                \
@@ -1127,6 +1149,8 @@
                                                                 \
   if ( !mmvalid )                                               \
   {                                                           \
+    VTKKWRCHelper_SpaceLeap(                                    \
+      mapper->ComputeSpaceLeap( pos, dir ) );                   \
     continue;                                                   \
   }
 
@@ -1144,6 +1168,8 @@
                                                                         \
   if ( !mmvalid )                                                       \
   {                                                                   \
+    VTKKWRCHelper_SpaceLeap(                                            \
+      mapper->ComputeMIPSpaceLeap( pos, dir, MAXIDX, FLIP ) );          \
     continue;                                                           \
   }
 
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkFixedPointVolumeRayCastMapper.h"
 
+#include "vtkAtomicTypes.h"
 #include "vtkCamera.h"
 #include "vtkColorTransferFunction.h"
 #include "vtkDataArray.h"
@@ -37,6 +38,8 @@
 #include "vtkPointData.h"
 #include "vtkRenderWindow.h"
 #include "vtkRenderer.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTimerLog.h"
 #include "vtkTransform.h"
 #include "vtkVolumeProperty.h"
@@ -47,6 +50,8 @@
 
 #include <exception>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 vtkStandardNewMacro(vtkFixedPointVolumeRayCastMapper);
 vtkCxxSetObjectMacro(vtkFixedPointVolumeRayCastMapper, RayCastImage, vtkFixedPointRayCastImage);
@@ -63,6 +68,254 @@ vtkCxxSetObjectMacro(vtkFixedPointVolumeRayCastMapper, RayCastImage, vtkFixedPoi
   B[1] = A[0]*M[1]  + A[1]*M[5]  + A[2]*M[9]; \
   B[2] = A[0]*M[2]  + A[1]*M[6]  + A[2]*M[10]
 
+//----------------------------------------------------------------------------
+// A min/max pyramid over the 4x4x4 blocks of the min/max volume. Level 0
+// has one node per block, and each node of the next level covers 2x2x2
+// nodes of the level below. A node stores the smallest min and the largest
+// max of the flagged blocks that it covers, so a node with no flagged
+// blocks has min > max. Only the first component is used.
+class vtkFixedPointVolumeRayCastMapperMinMaxTree
+{
+public:
+  // Bring the pyramid up to date with the min/max volume. Only the nodes
+  // above the blocks that changed are recomputed, unless the size changed.
+  void Update( const unsigned short *minMaxVolume, const int size[4] );
+
+  void Clear() { this->Levels.clear(); }
+
+  int GetNumberOfLevels() { return static_cast<int>(this->Levels.size()); }
+
+  // The number of steps along the ray that stay within the largest node
+  // around pos that can be skipped, or zero if the block at pos can't be
+  // skipped. The mode is 0 for composite, 1 for MIP, 2 for MinIP.
+  unsigned int ComputeLeap( const unsigned int pos[3],
+                            const unsigned int dir[3],
+                            int mode, unsigned short maxIdx );
+
+  vtkTimeStamp UpdateTime;
+
+protected:
+  struct Level
+  {
+    int Size[3];
+    std::vector<unsigned short> MinMax;
+  };
+
+  bool IsSkippable( const Level &level, const unsigned int idx[3],
+                    int mode, unsigned short maxIdx )
+  {
+    vtkIdType i = 2*((idx[2]*static_cast<vtkIdType>(level.Size[1]) +
+                      idx[1])*level.Size[0] + idx[0]);
+    const unsigned short *mm = &level.MinMax[i];
+    switch ( mode )
+    {
+      case 0:
+        return ( mm[0] > mm[1] );
+      case 1:
+        return ( mm[1] <= maxIdx );
+      default:
+        return ( mm[0] >= maxIdx );
+    }
+  }
+
+  std::vector<Level> Levels;
+};
+
+void vtkFixedPointVolumeRayCastMapperMinMaxTree::Update(
+  const unsigned short *minMaxVolume, const int size[4] )
+{
+  bool rebuild = ( this->Levels.empty() ||
+                   this->Levels[0].Size[0] != size[0] ||
+                   this->Levels[0].Size[1] != size[1] ||
+                   this->Levels[0].Size[2] != size[2] );
+
+  if ( rebuild )
+  {
+    this->Levels.clear();
+    int s[3] = { size[0], size[1], size[2] };
+    for (;;)
+    {
+      Level level;
+      level.Size[0] = s[0];
+      level.Size[1] = s[1];
+      level.Size[2] = s[2];
+      level.MinMax.resize(2*static_cast<size_t>(s[0])*s[1]*s[2]);
+      this->Levels.push_back(level);
+      if ( s[0] == 1 && s[1] == 1 && s[2] == 1 )
+      {
+        break;
+      }
+      s[0] = (s[0] + 1)/2;
+      s[1] = (s[1] + 1)/2;
+      s[2] = (s[2] + 1)/2;
+    }
+  }
+
+  // Level 0 comes straight from the min/max volume
+  Level &base = this->Levels[0];
+  size_t numBlocks =
+    static_cast<size_t>(size[0])*size[1]*size[2];
+  std::vector<unsigned char> changed(numBlocks, 0);
+  bool anyChanged = false;
+  for ( size_t i = 0; i < numBlocks; i++ )
+  {
+    const unsigned short *mm = minMaxVolume + 3*size[3]*i;
+    unsigned short lo = 0xffff;
+    unsigned short hi = 0;
+    if ( mm[2]&0x00ff )
+    {
+      lo = mm[0];
+      hi = mm[1];
+    }
+    if ( rebuild || base.MinMax[2*i] != lo || base.MinMax[2*i+1] != hi )
+    {
+      base.MinMax[2*i] = lo;
+      base.MinMax[2*i+1] = hi;
+      changed[i] = 1;
+      anyChanged = true;
+    }
+  }
+
+  // Recompute the parents of the nodes that changed, level by level
+  for ( size_t l = 1; l < this->Levels.size() && anyChanged; l++ )
+  {
+    const Level &child = this->Levels[l-1];
+    Level &parent = this->Levels[l];
+    std::vector<unsigned char> dirty(
+      static_cast<size_t>(parent.Size[0])*parent.Size[1]*parent.Size[2], 0);
+
+    size_t i = 0;
+    for ( int z = 0; z < child.Size[2]; z++ )
+    {
+      for ( int y = 0; y < child.Size[1]; y++ )
+      {
+        for ( int x = 0; x < child.Size[0]; x++, i++ )
+        {
+          if ( changed[i] )
+          {
+            dirty[((z/2)*static_cast<size_t>(parent.Size[1]) + y/2)*
+                  parent.Size[0] + x/2] = 1;
+          }
+        }
+      }
+    }
+
+    anyChanged = false;
+    i = 0;
+    for ( int z = 0; z < parent.Size[2]; z++ )
+    {
+      for ( int y = 0; y < parent.Size[1]; y++ )
+      {
+        for ( int x = 0; x < parent.Size[0]; x++, i++ )
+        {
+          if ( !dirty[i] )
+          {
+            continue;
+          }
+          dirty[i] = 0;
+
+          unsigned short lo = 0xffff;
+          unsigned short hi = 0;
+          int zEnd = (2*z+2 < child.Size[2])?(2*z+2):(child.Size[2]);
+          int yEnd = (2*y+2 < child.Size[1])?(2*y+2):(child.Size[1]);
+          int xEnd = (2*x+2 < child.Size[0])?(2*x+2):(child.Size[0]);
+          for ( int cz = 2*z; cz < zEnd; cz++ )
+          {
+            for ( int cy = 2*y; cy < yEnd; cy++ )
+            {
+              for ( int cx = 2*x; cx < xEnd; cx++ )
+              {
+                const unsigned short *mm = &child.MinMax[
+                  2*((cz*static_cast<size_t>(child.Size[1]) + cy)*
+                     child.Size[0] + cx)];
+                lo = (mm[0] < lo)?(mm[0]):(lo);
+                hi = (mm[1] > hi)?(mm[1]):(hi);
+              }
+            }
+          }
+
+          if ( rebuild || parent.MinMax[2*i] != lo ||
+               parent.MinMax[2*i+1] != hi )
+          {
+            parent.MinMax[2*i] = lo;
+            parent.MinMax[2*i+1] = hi;
+            dirty[i] = 1;
+            anyChanged = true;
+          }
+        }
+      }
+    }
+
+    changed.swap(dirty);
+  }
+
+  this->UpdateTime.Modified();
+}
+
+unsigned int vtkFixedPointVolumeRayCastMapperMinMaxTree::ComputeLeap(
+  const unsigned int pos[3], const unsigned int dir[3],
+  int mode, unsigned short maxIdx )
+{
+  if ( this->Levels.empty() )
+  {
+    return 0;
+  }
+
+  unsigned int idx[3];
+  for ( int i = 0; i < 3; i++ )
+  {
+    idx[i] = pos[i] >> VTKKW_FPMM_SHIFT;
+    if ( idx[i] >= static_cast<unsigned int>(this->Levels[0].Size[i]) )
+    {
+      return 0;
+    }
+  }
+
+  if ( !this->IsSkippable( this->Levels[0], idx, mode, maxIdx ) )
+  {
+    return 0;
+  }
+
+  // Climb while the parent can be skipped as a whole
+  int l = 0;
+  while ( l + 1 < static_cast<int>(this->Levels.size()) )
+  {
+    unsigned int parentIdx[3] = { idx[0] >> 1, idx[1] >> 1, idx[2] >> 1 };
+    if ( !this->IsSkippable( this->Levels[l+1], parentIdx, mode, maxIdx ) )
+    {
+      break;
+    }
+    idx[0] = parentIdx[0];
+    idx[1] = parentIdx[1];
+    idx[2] = parentIdx[2];
+    l++;
+  }
+
+  // The number of steps that keep every coordinate inside the node. The
+  // bounds are computed in 64 bits since the top node may be as large as
+  // the whole fixed point range.
+  int shift = VTKKW_FPMM_SHIFT + l;
+  unsigned int steps = VTK_UNSIGNED_INT_MAX;
+  for ( int i = 0; i < 3; i++ )
+  {
+    unsigned int d = dir[i]&0x7fffffff;
+    if ( d == 0 )
+    {
+      continue;
+    }
+    vtkTypeUInt64 p = pos[i];
+    vtkTypeUInt64 lo = static_cast<vtkTypeUInt64>(idx[i]) << shift;
+    vtkTypeUInt64 hi = lo + (static_cast<vtkTypeUInt64>(1) << shift) - 1;
+    vtkTypeUInt64 n = ( (dir[i]&0x80000000) ? (hi - p) : (p - lo) )/d;
+    if ( n < steps )
+    {
+      steps = static_cast<unsigned int>(n);
+    }
+  }
+
+  return steps;
+}
+
 
 //----------------------------------------------------------------------------
 template <class T>
@@ -621,6 +874,17 @@ vtkFixedPointVolumeRayCastMapper::vtkFixedPointVolumeRayCastMapper()
   this->RowBounds              = NULL;
   this->OldRowBounds           = NULL;
 
+  this->EnableSMP              = 0;
+  this->TileSize               = 32;
+  this->ActiveTileSize         = 0;
+  this->NumberOfTiles          = 0;
+  this->NumberOfEmptyTiles     = 0;
+  this->NumberOfTileThreads    = 0;
+  this->TilesPerThread         = NULL;
+
+  this->HierarchicalSpaceLeaping = 1;
+  this->MinMaxTree = new vtkFixedPointVolumeRayCastMapperMinMaxTree;
+
   this->RenderTimeTable        = NULL;
   this->RenderVolumeTable      = NULL;
   this->RenderRendererTable    = NULL;
@@ -765,6 +1029,9 @@ vtkFixedPointVolumeRayCastMapper::~vtkFixedPointVolumeRayCastMapper()
 
   delete [] this->RowBounds;
   delete [] this->OldRowBounds;
+  delete [] this->TilesPerThread;
+
+  delete this->MinMaxTree;
 
   int i;
   if ( this->GradientNormal )
@@ -967,6 +1234,48 @@ int vtkFixedPointVolumeRayCastMapper::GetNumberOfThreads()
   return 0;
 }
 
+int vtkFixedPointVolumeRayCastMapper::GetNumberOfTilesForThread( int thread )
+{
+  if ( thread < 0 || thread >= this->NumberOfTileThreads )
+  {
+    return 0;
+  }
+  return this->TilesPerThread[thread];
+}
+
+// With the multithreader, each thread renders every threadCount'th row of
+// the image. With tiles, each work item is one tile and the rows are not
+// interleaved. Progress and abort checks are done by the first thread of
+// the multithreader, or by RenderTiles() in between tiles.
+int vtkFixedPointVolumeRayCastMapper::GetWorkBounds( int item, int numItems,
+                                                     int bounds[4],
+                                                     int *rowStep )
+{
+  int inUseSize[2];
+  this->RayCastImage->GetImageInUseSize( inUseSize );
+
+  if ( this->ActiveTileSize > 0 )
+  {
+    int tileSize = this->ActiveTileSize;
+    int tilesX = (inUseSize[0] + tileSize - 1)/tileSize;
+    bounds[0] = (item % tilesX)*tileSize;
+    bounds[1] = bounds[0] + tileSize - 1;
+    bounds[1] = (bounds[1] < inUseSize[0]-1)?(bounds[1]):(inUseSize[0]-1);
+    bounds[2] = (item / tilesX)*tileSize;
+    bounds[3] = bounds[2] + tileSize - 1;
+    bounds[3] = (bounds[3] < inUseSize[1]-1)?(bounds[3]):(inUseSize[1]-1);
+    *rowStep = 1;
+    return 0;
+  }
+
+  bounds[0] = 0;
+  bounds[1] = inUseSize[0] - 1;
+  bounds[2] = item;
+  bounds[3] = inUseSize[1] - 1;
+  *rowStep = numItems;
+  return ( item == 0 );
+}
+
 //----------------------------------------------------------------------------
 // This method should be called after UpdateColorTables since it
 // relies on some information (shift and scale) computed in that method,
@@ -1068,6 +1377,47 @@ void vtkFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol )
   }
 }
 
+//----------------------------------------------------------------------------
+// This method should be called after UpdateMinMaxVolume. The pyramid is
+// brought up to date whenever the space leaping filter has rebuilt the
+// min/max values or the flags since the last update.
+void vtkFixedPointVolumeRayCastMapper::UpdateMinMaxTree()
+{
+  if ( !this->HierarchicalSpaceLeaping || !this->MinMaxVolume )
+  {
+    this->MinMaxTree->Clear();
+    return;
+  }
+
+  if ( this->MinMaxTree->GetNumberOfLevels() &&
+       this->MinMaxTree->UpdateTime.GetMTime() >
+       this->SpaceLeapFilter->GetLastMinMaxFlagTime() &&
+       this->MinMaxTree->UpdateTime.GetMTime() >
+       this->SpaceLeapFilter->GetLastMinMaxBuildTime() )
+  {
+    return;
+  }
+
+  this->MinMaxTree->Update( this->MinMaxVolume, this->MinMaxVolumeSize );
+}
+
+int vtkFixedPointVolumeRayCastMapper::GetNumberOfSpaceLeapingLevels()
+{
+  return this->MinMaxTree->GetNumberOfLevels();
+}
+
+unsigned int vtkFixedPointVolumeRayCastMapper::ComputeSpaceLeap(
+  unsigned int pos[3], unsigned int dir[3] )
+{
+  return this->MinMaxTree->ComputeLeap( pos, dir, 0, 0 );
+}
+
+unsigned int vtkFixedPointVolumeRayCastMapper::ComputeMIPSpaceLeap(
+  unsigned int pos[3], unsigned int dir[3], unsigned short maxIdx, int flip )
+{
+  return this->MinMaxTree->ComputeLeap( pos, dir, (flip ? 2 : 1), maxIdx );
+}
+
 //----------------------------------------------------------------------------
 void vtkFixedPointVolumeRayCastMapper::UpdateCroppingRegions()
 {
@@ -1247,6 +1597,7 @@ void vtkFixedPointVolumeRayCastMapper::PerVolumeInitialization( vtkRenderer *ren
   // Calls SpaceLeapFilter for a multi-threaded optimized computation of the
   // min-max structure.
   this->UpdateMinMaxVolume( vol );
+  this->UpdateMinMaxTree();
 
 }
 
@@ -1290,12 +1641,330 @@ void vtkFixedPointVolumeRayCastMapper::RenderSubVolume()
   // Set the number of threads to use for ray casting,
   // then set the execution method and do it.
   this->InvokeEvent( vtkCommand::VolumeMapperRenderStartEvent, NULL );
-  this->Threader->SetSingleMethod( FixedPointVolumeRayCastMapper_CastRays,
-                                   (void *)this);
-  this->Threader->SingleMethodExecute();
+  if ( this->EnableSMP )
+  {
+    this->RenderTiles();
+  }
+  else
+  {
+    this->Threader->SetSingleMethod( FixedPointVolumeRayCastMapper_CastRays,
+                                     (void *)this);
+    this->Threader->SingleMethodExecute();
+  }
   this->InvokeEvent( vtkCommand::VolumeMapperRenderEndEvent, NULL );
 }
 
+// This functor renders a range of tiles for vtkSMPTools::For. The tiles
+// are handed out one at a time, so that threads that get cheap tiles take
+// more of them. Tiles that are empty according to the mask are cleared.
+// The thread that called RenderTiles() checks for abort and reports
+// progress, since the render window must not be polled by other threads.
+class vtkFixedPointVolumeRayCastMapperTileFunctor
+{
+public:
+  vtkFixedPointVolumeRayCastMapper *Mapper;
+  const unsigned char *Mask;
+  int NumberOfTiles;
+  int ProgressStep;
+  int NextProgress;
+  vtkMultiThreaderIDType MainThread;
+  vtkAtomicInt32 TilesDone;
+  vtkSMPThreadLocal<int> TileCount;
+  vtkSMPThreadLocal<int> EmptyTileCount;
+
+  void Initialize()
+  {
+    this->TileCount.Local() = 0;
+    this->EmptyTileCount.Local() = 0;
+  }
+
+  void operator()( vtkIdType begin, vtkIdType end )
+  {
+    vtkRenderWindow *renWin = this->Mapper->RenderWindow;
+    bool isMainThread = ( vtkMultiThreader::ThreadsEqual(
+      this->MainThread, vtkMultiThreader::GetCurrentThreadID() ) != 0 );
+
+    for ( vtkIdType tile = begin; tile < end; tile++ )
+    {
+      if ( renWin->GetAbortRender() )
+      {
+        return;
+      }
+
+      if ( this->Mask && !this->Mask[tile] )
+      {
+        this->ClearTile( static_cast<int>(tile) );
+        this->EmptyTileCount.Local()++;
+      }
+      else
+      {
+        this->Mapper->CastRays( static_cast<int>(tile), this->NumberOfTiles );
+      }
+      this->TileCount.Local()++;
+
+      int done = ++this->TilesDone;
+      if ( isMainThread )
+      {
+        if ( renWin->CheckAbortStatus() )
+        {
+          return;
+        }
+        if ( done >= this->NextProgress )
+        {
+          this->NextProgress = done + this->ProgressStep;
+          double fargs[1];
+          fargs[0] = static_cast<double>(done)/this->NumberOfTiles;
+          this->Mapper->InvokeEvent(
+            vtkCommand::VolumeMapperRenderProgressEvent, fargs );
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    vtkFixedPointVolumeRayCastMapper *mapper = this->Mapper;
+    delete [] mapper->TilesPerThread;
+    mapper->TilesPerThread = NULL;
+    mapper->NumberOfTileThreads = 0;
+    mapper->NumberOfEmptyTiles = 0;
+
+    int numThreads = 0;
+    vtkSMPThreadLocal<int>::iterator iter;
+    for ( iter = this->TileCount.begin(); iter != this->TileCount.end(); ++iter )
+    {
+      numThreads++;
+    }
+    for ( iter = this->EmptyTileCount.begin();
+          iter != this->EmptyTileCount.end(); ++iter )
+    {
+      mapper->NumberOfEmptyTiles += *iter;
+    }
+
+    if ( numThreads > 0 )
+    {
+      mapper->TilesPerThread = new int [numThreads];
+      mapper->NumberOfTileThreads = numThreads;
+      int i = 0;
+      for ( iter = this->TileCount.begin(); iter != this->TileCount.end(); ++iter )
+      {
+        mapper->TilesPerThread[i++] = *iter;
+      }
+    }
+  }
+
+  // Clear the part of the tile that is within the row bounds, this is
+  // what the rays would have produced
+  void ClearTile( int tile )
+  {
+    int bounds[4];
+    int rowStep;
+    this->Mapper->GetWorkBounds( tile, this->NumberOfTiles, bounds, &rowStep );
+
+    int memorySize[2];
+    this->Mapper->RayCastImage->GetImageMemorySize( memorySize );
+    unsigned short *image = this->Mapper->RayCastImage->GetImage();
+    const int *rowBounds = this->Mapper->RowBounds;
+
+    for ( int j = bounds[2]; j <= bounds[3]; j++ )
+    {
+      int start = (rowBounds[j*2] > bounds[0])?(rowBounds[j*2]):(bounds[0]);
+      int stop = (rowBounds[j*2+1] < bounds[1])?(rowBounds[j*2+1]):(bounds[1]);
+      if ( start <= stop )
+      {
+        memset( image + 4*(j*memorySize[0] + start), 0,
+                4*(stop - start + 1)*sizeof(unsigned short) );
+      }
+    }
+  }
+};
+
+// Render the image as tiles with vtkSMPTools instead of the multithreader
+void vtkFixedPointVolumeRayCastMapper::RenderTiles()
+{
+  int inUseSize[2];
+  this->RayCastImage->GetImageInUseSize( inUseSize );
+
+  int tileSize = this->TileSize;
+  int tilesX = (inUseSize[0] + tileSize - 1)/tileSize;
+  int tilesY = (inUseSize[1] + tileSize - 1)/tileSize;
+  int numTiles = tilesX*tilesY;
+
+  // Rays that only pass through blocks with a cleared min/max flag give
+  // zero for composite blending, so the tiles that no visible block
+  // projects onto can be cleared instead of ray cast. This does not hold
+  // for MIP, which always finds a maximum.
+  std::vector<unsigned char> tileMask;
+  const unsigned char *mask = NULL;
+  if ( numTiles > 0 && this->BlendMode == vtkVolumeMapper::COMPOSITE_BLEND )
+  {
+    tileMask.resize( numTiles, 0 );
+    if ( this->ComputeTileMask( tileSize, tilesX, tilesY, &tileMask[0] ) )
+    {
+      mask = &tileMask[0];
+    }
+  }
+
+  vtkFixedPointVolumeRayCastMapperTileFunctor functor;
+  functor.Mapper = this;
+  functor.Mask = mask;
+  functor.NumberOfTiles = numTiles;
+  functor.ProgressStep = (numTiles > 64)?(numTiles/64):(1);
+  functor.NextProgress = functor.ProgressStep;
+  functor.MainThread = vtkMultiThreader::GetCurrentThreadID();
+  functor.TilesDone = 0;
+
+  this->ActiveTileSize = tileSize;
+  vtkSMPTools::For( 0, numTiles, 1, functor );
+  this->ActiveTileSize = 0;
+
+  this->NumberOfTiles = numTiles;
+}
+
+// Mark the tiles that are overlapped by the projection of a block of the
+// min/max volume that has its flag set. Consecutive blocks along x are
+// projected together to keep the number of projections low.
+int vtkFixedPointVolumeRayCastMapper::ComputeTileMask( int tileSize,
+                                                       int tilesX,
+                                                       int tilesY,
+                                                       unsigned char *mask )
+{
+  // Only the rays for one component or dependent components check the
+  // flags, the rays for independent components visit every sample
+  if ( !this->MinMaxVolume || !this->CurrentScalars ||
+       ( this->CurrentScalars->GetNumberOfComponents() > 1 &&
+         this->Volume->GetProperty()->GetIndependentComponents() ) )
+  {
+    return 0;
+  }
+
+  float voxelsToViewMatrix[16];
+  for ( int j = 0; j < 4; j++ )
+  {
+    for ( int i = 0; i < 4; i++ )
+    {
+      voxelsToViewMatrix[j*4+i] =
+        static_cast<float>(this->VoxelsToViewMatrix->GetElement(j,i));
+    }
+  }
+
+  int viewportSize[2];
+  int origin[2];
+  this->RayCastImage->GetImageViewportSize( viewportSize );
+  this->RayCastImage->GetImageOrigin( origin );
+
+  const int *size = this->MinMaxVolumeSize;
+  const int blockSize = 1 << (VTKKW_FPMM_SHIFT - VTKKW_FP_SHIFT);
+
+  for ( int z = 0; z < size[2]; z++ )
+  {
+    for ( int y = 0; y < size[1]; y++ )
+    {
+      vtkIdType rowOffset = (static_cast<vtkIdType>(z)*size[1] + y)*size[0];
+      int x = 0;
+      while ( x < size[0] )
+      {
+        // Find the next run of blocks with the flag set
+        while ( x < size[0] &&
+                !(this->MinMaxVolume[3*size[3]*(rowOffset + x) + 2] & 0x00ff) )
+        {
+          x++;
+        }
+        if ( x >= size[0] )
+        {
+          break;
+        }
+        int xStart = x;
+        while ( x < size[0] &&
+                (this->MinMaxVolume[3*size[3]*(rowOffset + x) + 2] & 0x00ff) )
+        {
+          x++;
+        }
+
+        float bounds[6];
+        bounds[0] = static_cast<float>(xStart*blockSize);
+        bounds[1] = static_cast<float>(x*blockSize);
+        bounds[2] = static_cast<float>(y*blockSize);
+        bounds[3] = static_cast<float>((y+1)*blockSize);
+        bounds[4] = static_cast<float>(z*blockSize);
+        bounds[5] = static_cast<float>((z+1)*blockSize);
+
+        float minX = VTK_FLOAT_MAX;
+        float minY = VTK_FLOAT_MAX;
+        float maxX = -VTK_FLOAT_MAX;
+        float maxY = -VTK_FLOAT_MAX;
+        for ( int corner = 0; corner < 8; corner++ )
+        {
+          float voxelPoint[3];
+          float viewPoint[4];
+          voxelPoint[0] = bounds[corner & 1];
+          voxelPoint[1] = bounds[2 + ((corner >> 1) & 1)];
+          voxelPoint[2] = bounds[4 + ((corner >> 2) & 1)];
+
+          // A block that is behind the camera or clipped by the near or
+          // far plane does not have a useful projection
+          const float *m = voxelsToViewMatrix;
+          viewPoint[3] = voxelPoint[0]*m[12] + voxelPoint[1]*m[13] +
+                         voxelPoint[2]*m[14] + m[15];
+          if ( viewPoint[3] <= 0.0 )
+          {
+            return 0;
+          }
+          vtkVRCMultiplyPointMacro( voxelPoint, viewPoint,
+                                    voxelsToViewMatrix );
+          if ( viewPoint[2] < 0.001 || viewPoint[2] > 0.9999 )
+          {
+            return 0;
+          }
+
+          minX = (viewPoint[0]<minX)?(viewPoint[0]):(minX);
+          minY = (viewPoint[1]<minY)?(viewPoint[1]):(minY);
+          maxX = (viewPoint[0]>maxX)?(viewPoint[0]):(maxX);
+          maxY = (viewPoint[1]>maxY)?(viewPoint[1]):(maxY);
+        }
+
+        // Convert to pixels, where pixel i has its ray at i + 0.5, and
+        // add a pixel on each side for rounding
+        minX = (minX + 1.0f)*0.5f*viewportSize[0] - origin[0] - 1.5f;
+        maxX = (maxX + 1.0f)*0.5f*viewportSize[0] - origin[0] + 0.5f;
+        minY = (minY + 1.0f)*0.5f*viewportSize[1] - origin[1] - 1.5f;
+        maxY = (maxY + 1.0f)*0.5f*viewportSize[1] - origin[1] + 0.5f;
+
+        // Keep the values in range for the conversion to int
+        float limitX = static_cast<float>((tilesX + 1)*tileSize);
+        float limitY = static_cast<float>((tilesY + 1)*tileSize);
+        minX = (minX > -tileSize)?((minX < limitX)?(minX):(limitX)):(-tileSize);
+        maxX = (maxX > -tileSize)?((maxX < limitX)?(maxX):(limitX)):(-tileSize);
+        minY = (minY > -tileSize)?((minY < limitY)?(minY):(limitY)):(-tileSize);
+        maxY = (maxY > -tileSize)?((maxY < limitY)?(maxY):(limitY)):(-tileSize);
+
+        int tileBounds[4];
+        tileBounds[0] = vtkMath::Floor( minX/tileSize );
+        tileBounds[1] = vtkMath::Floor( maxX/tileSize );
+        tileBounds[2] = vtkMath::Floor( minY/tileSize );
+        tileBounds[3] = vtkMath::Floor( maxY/tileSize );
+        if ( tileBounds[1] < 0 || tileBounds[0] >= tilesX ||
+             tileBounds[3] < 0 || tileBounds[2] >= tilesY )
+        {
+          continue;
+        }
+        tileBounds[0] = (tileBounds[0] > 0)?(tileBounds[0]):(0);
+        tileBounds[1] = (tileBounds[1] < tilesX-1)?(tileBounds[1]):(tilesX-1);
+        tileBounds[2] = (tileBounds[2] > 0)?(tileBounds[2]):(0);
+        tileBounds[3] = (tileBounds[3] < tilesY-1)?(tileBounds[3]):(tilesY-1);
+
+        for ( int ty = tileBounds[2]; ty <= tileBounds[3]; ty++ )
+        {
+          memset( mask + ty*tilesX + tileBounds[0], 1,
+                  tileBounds[1] - tileBounds[0] + 1 );
+        }
+      }
+    }
+  }
+
+  return 1;
+}
+
 // This method displays the image that has been created
 void vtkFixedPointVolumeRayCastMapper::DisplayRenderedImage( vtkRenderer *ren,
                                                              vtkVolume   *vol )
@@ -1542,40 +2211,47 @@ VTK_THREAD_RETURN_TYPE FixedPointVolumeRayCastMapper_CastRays( void *arg )
     return VTK_THREAD_RETURN_VALUE;
   }
 
-  vtkVolume *vol = me->GetVolume();
+  me->CastRays( threadID, threadCount );
 
-  if ( me->GetBlendMode() == vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND ||
-       me->GetBlendMode() == vtkVolumeMapper::MINIMUM_INTENSITY_BLEND )
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Cast the rays for one work item with the helper for the current
+// blend mode and the shading / gradient opacity settings
+void vtkFixedPointVolumeRayCastMapper::CastRays( int item, int numItems )
+{
+  vtkVolume *vol = this->Volume;
+
+  if ( this->GetBlendMode() == vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND ||
+       this->GetBlendMode() == vtkVolumeMapper::MINIMUM_INTENSITY_BLEND )
   {
-    me->GetMIPHelper()->GenerateImage( threadID, threadCount, vol, me );
+    this->GetMIPHelper()->GenerateImage( item, numItems, vol, this );
   }
   else
   {
-    if ( me->GetShadingRequired() == 0 )
+    if ( this->GetShadingRequired() == 0 )
     {
-      if ( me->GetGradientOpacityRequired() == 0 )
+      if ( this->GetGradientOpacityRequired() == 0 )
       {
-        me->GetCompositeHelper()->GenerateImage( threadID, threadCount, vol, me );
+        this->GetCompositeHelper()->GenerateImage( item, numItems, vol, this );
       }
       else
       {
-        me->GetCompositeGOHelper()->GenerateImage( threadID, threadCount, vol, me );
+        this->GetCompositeGOHelper()->GenerateImage( item, numItems, vol, this );
       }
     }
     else
     {
-      if ( me->GetGradientOpacityRequired() == 0 )
+      if ( this->GetGradientOpacityRequired() == 0 )
       {
-        me->GetCompositeShadeHelper()->GenerateImage( threadID, threadCount, vol, me );
+        this->GetCompositeShadeHelper()->GenerateImage( item, numItems, vol, this );
       }
       else
       {
-        me->GetCompositeGOShadeHelper()->GenerateImage( threadID, threadCount, vol, me );
+        this->GetCompositeGOShadeHelper()->GenerateImage( item, numItems, vol, this );
       }
     }
   }
-
-  return VTK_THREAD_RETURN_VALUE;
 }
 
 // Create an image into the vtkImageData argmument. Used generally for
@@ -3391,6 +4067,10 @@ void vtkFixedPointVolumeRayCastMapper::PrintSelf(ostream& os, vtkIndent indent)
     << (this->LockSampleDistanceToInputSpacing ? "On\n" : "Off\n");
   os << indent << "Intermix Intersecting Geometry: "
     << (this->IntermixIntersectingGeometry ? "On\n" : "Off\n");
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "TileSize: " << this->TileSize << endl;
+  os << indent << "HierarchicalSpaceLeaping: "
+     << (this->HierarchicalSpaceLeaping ? "On\n" : "Off\n");
   os << indent << "Final Color Window: " << this->FinalColorWindow << endl;
   os << indent << "Final Color Level: " << this->FinalColorLevel << endl;
   os << indent << "Space leaping filter: " << this->SpaceLeapFilter << endl;
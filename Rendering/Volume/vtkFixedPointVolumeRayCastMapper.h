@@ -21,7 +21,8 @@
  * composite or MIP rendering, and can be intermixed with geometric data.
  * Space leaping is used to speed up the rendering process. In addition,
  * calculation are performed in 15 bit fixed point precision. This mapper
- * is threaded, and will interleave scan lines across processors.
+ * is threaded, and will interleave scan lines across processors, or
+ * with EnableSMP on, will hand out image tiles through vtkSMPTools.
  *
  * WARNING: This ray caster may not produce consistent results when
  * the number of threads exceeds 1. The class warns if the number of
@@ -52,7 +53,8 @@
  * third unsigned short which is both the maximum gradient opacity in
  * the neighborhood (an unsigned char) and the flag that is filled
  * in for the current lookup tables to indicate whether this region
- * can be skipped.
+ * can be skipped. With HierarchicalSpaceLeaping on, a pyramid of these
+ * blocks lets a ray leap over a large empty region in one step.
  *
  * @sa
  * vtkVolumeMapper
@@ -91,6 +93,7 @@ class vtkFiniteDifferenceGradientEstimator;
 class vtkRayCastImageDisplayHelper;
 class vtkFixedPointRayCastImage;
 class vtkDataArray;
+class vtkFixedPointVolumeRayCastMapperMinMaxTree;
 
 // Forward declaration needed for use by friend declaration below.
 VTK_THREAD_RETURN_TYPE FixedPointVolumeRayCastMapper_CastRays( void *arg );
@@ -194,6 +197,56 @@ public:
   int GetNumberOfThreads();
   //@}
 
+  //@{
+  /**
+   * If EnableSMP is on, the image is divided into square tiles of
+   * TileSize pixels that are handed out one at a time through vtkSMPTools,
+   * instead of interleaving the rows among the threads of the
+   * vtkMultiThreader. For composite blending, tiles that do not overlap
+   * the projection of any visible block of the min/max volume are cleared
+   * without casting rays. The image is the same either way. Off by default.
+   */
+  vtkSetClampMacro( EnableSMP, int, 0, 1 );
+  vtkGetMacro( EnableSMP, int );
+  vtkBooleanMacro( EnableSMP, int );
+  vtkSetClampMacro( TileSize, int, 4, 256 );
+  vtkGetMacro( TileSize, int );
+  //@}
+
+  //@{
+  /**
+   * Statistics for the last image rendered with EnableSMP on: the number
+   * of tiles, the number of tiles that were skipped because they were
+   * empty, and the number of tiles that each thread rendered (skipped
+   * tiles included).
+   */
+  vtkGetMacro( NumberOfTiles, int );
+  vtkGetMacro( NumberOfEmptyTiles, int );
+  int GetNumberOfTileThreads() { return this->NumberOfTileThreads; }
+  int GetNumberOfTilesForThread( int thread );
+  //@}
+
+  //@{
+  /**
+   * If HierarchicalSpaceLeaping is on, a min/max pyramid is built over the
+   * blocks of the min/max volume, and a ray that enters a block that can
+   * be skipped leaps to the end of the largest skippable region around it
+   * instead of stepping through it one sample at a time. The pyramid is
+   * updated incrementally when the transfer functions change. It is used
+   * for composite, MIP and MinIP, but not for independent components. The
+   * image is the same either way. On by default.
+   */
+  vtkSetClampMacro( HierarchicalSpaceLeaping, int, 0, 1 );
+  vtkGetMacro( HierarchicalSpaceLeaping, int );
+  vtkBooleanMacro( HierarchicalSpaceLeaping, int );
+  //@}
+
+  /**
+   * The number of levels in the min/max pyramid built for the last render,
+   * or zero if HierarchicalSpaceLeaping is off.
+   */
+  int GetNumberOfSpaceLeapingLevels();
+
   //@{
   /**
    * If IntermixIntersectingGeometry is turned on, the zbuffer will be
@@ -235,6 +288,11 @@ public:
   void ShiftVectorDown( unsigned int in[3], unsigned int out[3] );
   int CheckMinMaxVolumeFlag( unsigned int pos[3], int c );
   int CheckMIPMinMaxVolumeFlag( unsigned int pos[3], int c, unsigned short maxIdx, int flip );
+  void FixedPointLeap( unsigned int position[3], unsigned int increment[3],
+                       unsigned int steps );
+  unsigned int ComputeSpaceLeap( unsigned int pos[3], unsigned int dir[3] );
+  unsigned int ComputeMIPSpaceLeap( unsigned int pos[3], unsigned int dir[3],
+                                    unsigned short maxIdx, int flip );
 
   void LookupColorUC( unsigned short *colorTable,
                       unsigned short *scalarOpacityTable,
@@ -286,6 +344,15 @@ public:
 
   void InitializeRayInfo( vtkVolume *vol );
 
+  /**
+   * WARNING: INTERNAL METHOD - NOT INTENDED FOR GENERAL USE
+   * Get the part of the image that the ray cast helpers must render for
+   * work item "item" out of "numItems": rows bounds[2] to bounds[3] in
+   * steps of rowStep, clipped to columns bounds[0] to bounds[1]. Returns 1
+   * if this work item must check for abort and report progress.
+   */
+  int GetWorkBounds( int item, int numItems, int bounds[4], int *rowStep );
+
   int ShouldUseNearestNeighborInterpolation( vtkVolume *vol );
 
   //@{
@@ -397,9 +464,29 @@ protected:
 
   friend VTK_THREAD_RETURN_TYPE FixedPointVolumeRayCastMapper_CastRays( void *arg );
   friend VTK_THREAD_RETURN_TYPE vtkFPVRCMSwitchOnDataType( void *arg );
+  friend class vtkFixedPointVolumeRayCastMapperTileFunctor;
+
+  // Cast the rays for one work item, with the helper for the blend mode
+  void CastRays( int item, int numItems );
+
+  // Render the image tile by tile with vtkSMPTools
+  void RenderTiles();
+
+  // Mark the tiles that the visible blocks of the min/max volume project
+  // onto, returns 0 if no tiles can be skipped
+  int ComputeTileMask( int tileSize, int tilesX, int tilesY,
+                       unsigned char *mask );
 
   vtkMultiThreader  *Threader;
 
+  int                EnableSMP;
+  int                TileSize;
+  int                ActiveTileSize;
+  int                NumberOfTiles;
+  int                NumberOfEmptyTiles;
+  int                NumberOfTileThreads;
+  int               *TilesPerThread;
+
   vtkMatrix4x4   *PerspectiveMatrix;
   vtkMatrix4x4   *ViewToWorldMatrix;
   vtkMatrix4x4   *ViewToVoxelsMatrix;
@@ -537,9 +624,14 @@ protected:
   vtkVolumeRayCastSpaceLeapingImageFilter * SpaceLeapFilter;
 
   void            UpdateMinMaxVolume( vtkVolume *vol );
+  void            UpdateMinMaxTree();
   void            FillInMaxGradientMagnitudes( int fullDim[3],
                                                int smallDim[3] );
 
+  // Min/max pyramid used to leap over large empty regions
+  int             HierarchicalSpaceLeaping;
+  vtkFixedPointVolumeRayCastMapperMinMaxTree *MinMaxTree;
+
   float FinalColorWindow;
   float FinalColorLevel;
 
@@ -619,6 +711,35 @@ inline void vtkFixedPointVolumeRayCastMapper::FixedPointIncrement( unsigned int
 }
 
 
+// Same as calling FixedPointIncrement() steps times
+inline void vtkFixedPointVolumeRayCastMapper::FixedPointLeap( unsigned int position[3], unsigned int increment[3], unsigned int steps )
+{
+  if ( increment[0]&0x80000000 )
+  {
+    position[0] += steps*(increment[0]&0x7fffffff);
+  }
+  else
+  {
+    position[0] -= steps*increment[0];
+  }
+  if ( increment[1]&0x80000000 )
+  {
+    position[1] += steps*(increment[1]&0x7fffffff);
+  }
+  else
+  {
+    position[1] -= steps*increment[1];
+  }
+  if ( increment[2]&0x80000000 )
+  {
+    position[2] += steps*(increment[2]&0x7fffffff);
+  }
+  else
+  {
+    position[2] -= steps*increment[2];
+  }
+}
+
 inline void vtkFixedPointVolumeRayCastMapper::GetFloatTripleFromPointer( float v[3], float *ptr )
 {
   v[0] = *(ptr);